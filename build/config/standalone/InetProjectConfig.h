@@ -0,0 +1,38 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Inet Layer project configuration for standalone builds on Linux and OS X.
+ *
+ */
+#ifndef INETPROJECTCONFIG_H
+#define INETPROJECTCONFIG_H
+
+// Cache the results of DNS resolution and share concurrent lookups of the same host name.
+#define INET_CONFIG_ENABLE_DNS_CACHE 1
+
+// Each lookup made by the DNS cache with the platform resolver takes a resolver object of its own.
+#define INET_CONFIG_NUM_DNS_RESOLVERS 8
+
+#if INET_CONFIG_ENABLE_UDP_ENDPOINT
+// Build the UDP DNS client, so that it can be exercised by the DNS tests.
+#define INET_CONFIG_ENABLE_DNS_CLIENT 1
+#endif
+
+#endif /* INETPROJECTCONFIG_H */
@@ -36,11 +36,47 @@
 
 #define WEAVE_CONFIG_EVENT_LOGGING_EXTERNAL_EVENT_SUPPORT 1
 
+// Offer LZ4 compression when uploading the event log over BDX
+#define WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION 1
+
 #define WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE 300
 
+// Exercise the publisher's encoded data element cache
+#define WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE 4
+
+// Track dirty paths of the publisher's trait instances in bitmaps
+#define WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS 4
+
+// Track pending update paths of the client's trait instances in bitmaps
+#define WDM_UPDATE_NUM_PENDING_PATH_BITMAPS 4
+
+// Send only changed paths to subscribers resuming from a recent version
+#define WDM_PUBLISHER_CHANGE_JOURNAL_SIZE 8
+
+// Allow applying notify data lists on worker threads
+#define WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT 2
+
 // Uncomment this for a large Tunnel MTU.
 //#define WEAVE_CONFIG_TUNNEL_INTERFACE_MTU                           (9000)
 
+// Stop reading from the tunnel interface while the Service connection is backed up
+#define WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK (16 * 1024)
+
+// Cache next hop decisions for packets read from the tunnel interface
+#define WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE 16
+
+// Keep up to 8 BDX blocks in flight when the peer supports windowed transfers
+#define WEAVE_CONFIG_BDX_WINDOW_SIZE 8
+
+// Persist BDX download progress so interrupted downloads can resume
+#define WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT 1
+
+// Refresh the resolved service directory in the background every hour
+#define WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS 3600
+
+// Race outbound connections across the resolved addresses of a peer
+#define WEAVE_CONFIG_CONNECT_RACING 1
+
 // Max number of Bindings per WeaveExchangeManager
 #define WEAVE_CONFIG_MAX_BINDINGS 8
 
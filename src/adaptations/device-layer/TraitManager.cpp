@@ -534,6 +534,13 @@ WEAVE_ERROR TraitCatalogImpl<T>::Add(const ResourceIdentifier & resId, const uin
         PropertyPathHandle basePathHandle, T * traitInstance, TraitDataHandle & traitHandle)
 {
     uint8_t freeIndex = kMaxEntries;
+    WEAVE_ERROR err;
+
+    err = traitInstance->GetSchemaEngine()->BuildPropertyTreeIndex();
+    if (err != WEAVE_NO_ERROR)
+    {
+        return err;
+    }
 
     // Search the catalog...
     for (uint8_t i = 0; i < kMaxEntries; i++)
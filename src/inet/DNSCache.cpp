@@ -0,0 +1,454 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements DNSCache, the object that caches the results of
+ *      Domain Name System (DNS) resolution in InetLayer and shares lookups
+ *      in progress between concurrent requests.
+ *
+ */
+
+#include <InetLayer/InetLayer.h>
+
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Support/logging/WeaveLogging.h>
+
+#include <string.h>
+#include <strings.h>
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+
+namespace nl {
+namespace Inet {
+
+void DNSCache::Init(InetLayer *inet)
+{
+    mInet = inet;
+    mUseCounter = 0;
+    Shutdown();
+}
+
+/**
+ *  Forget all cached resolutions. Lookups in progress are left to complete.
+ */
+void DNSCache::Clear(void)
+{
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        if (mEntries[i].State == DNSCacheEntry::kState_Resolved)
+            mEntries[i].State = DNSCacheEntry::kState_Free;
+    }
+}
+
+/**
+ *  Forget all entries. Must only be called once all lookups have been canceled.
+ */
+void DNSCache::Shutdown(void)
+{
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        mEntries[i].State = DNSCacheEntry::kState_Free;
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+        mEntries[i].QueryFlags = 0;
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+    }
+}
+
+/**
+ *  Resolve a host name on behalf of a DNSResolver object, using the cache.
+ *
+ *  If the host name was resolved recently, the request is answered from the cache before this method returns.
+ *  Otherwise the request waits on a lookup of the host name, sharing it with any other requests for the same
+ *  host name and address family.
+ *
+ *  The resolver is released when the request is answered, or when an error is returned.
+ */
+INET_ERROR DNSCache::Resolve(DNSResolver &resolver, const char *hostName, uint16_t hostNameLen, uint8_t options,
+                             uint8_t maxAddrs, IPAddress *addrArray,
+                             DNSResolver::OnResolveCompleteFunct onComplete, void *appState)
+{
+    INET_ERROR err = INET_NO_ERROR;
+    uint8_t addrFamily = GetAddrFamily(options);
+    DNSCacheEntry *entry;
+
+    VerifyOrExit(DNSResolver::AreOptionsValid(options), err = INET_ERROR_BAD_ARGS);
+
+    resolver.AppState = appState;
+    resolver.AddrArray = addrArray;
+    resolver.MaxAddrs = maxAddrs;
+    resolver.NumAddrs = 0;
+    resolver.DNSOptions = options;
+    resolver.OnComplete = onComplete;
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
+    resolver.mState = DNSResolver::kState_Active;
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
+
+    entry = Find(hostName, hostNameLen, addrFamily);
+
+    // If no lookup of the host name is in progress, and its resolution isn't cached, start a lookup.
+    if (entry == NULL)
+    {
+        entry = NewEntry(hostName, hostNameLen, addrFamily);
+        VerifyOrExit(entry != NULL, err = INET_ERROR_NO_MEMORY);
+
+        // Wait on the lookup before starting it, as it may complete immediately.
+        resolver.mCacheEntry = entry;
+
+        err = StartLookup(*entry);
+        if (err != INET_NO_ERROR)
+        {
+            resolver.mCacheEntry = NULL;
+            entry->State = DNSCacheEntry::kState_Free;
+        }
+    }
+
+    // Otherwise, if a lookup is in progress, wait on it.
+    else if (entry->State == DNSCacheEntry::kState_Pending)
+    {
+        resolver.mCacheEntry = entry;
+    }
+
+    // Otherwise answer the request from the cache.
+    else
+    {
+        entry->LastUse = ++mUseCounter;
+        Deliver(resolver, *entry);
+    }
+
+exit:
+    if (err != INET_NO_ERROR)
+        resolver.Release();
+
+    return err;
+}
+
+/**
+ *  Find the entry for a host name and address family, if a lookup of it is in progress or its resolution has not
+ *  expired.
+ */
+DNSCacheEntry *DNSCache::Find(const char *hostName, uint16_t hostNameLen, uint8_t addrFamily)
+{
+    const uint64_t now = Weave::System::Layer::GetClock_MonotonicMS();
+
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        DNSCacheEntry &entry = mEntries[i];
+
+        if (entry.State == DNSCacheEntry::kState_Free || entry.AddrFamily != addrFamily)
+            continue;
+
+        if (entry.State == DNSCacheEntry::kState_Resolved && entry.ExpiryTimeMS <= now)
+            continue;
+
+        // Host names are case-insensitive.
+        if (strncasecmp(entry.HostName, hostName, hostNameLen) == 0 && entry.HostName[hostNameLen] == 0)
+            return &entry;
+    }
+
+    return NULL;
+}
+
+/**
+ *  Allocate an entry for the lookup of a host name, replacing an unused or expired entry if there is one, or else
+ *  the least recently used resolution.
+ *
+ *  @return The entry, in the pending state, or NULL if all entries have lookups in progress.
+ */
+DNSCacheEntry *DNSCache::NewEntry(const char *hostName, uint16_t hostNameLen, uint8_t addrFamily)
+{
+    const uint64_t now = Weave::System::Layer::GetClock_MonotonicMS();
+    DNSCacheEntry *entry = NULL;
+
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        DNSCacheEntry &candidate = mEntries[i];
+
+        if (candidate.State == DNSCacheEntry::kState_Pending || candidate.State == DNSCacheEntry::kState_Completing)
+            continue;
+
+        if (candidate.State == DNSCacheEntry::kState_Free || candidate.ExpiryTimeMS <= now)
+        {
+            entry = &candidate;
+            break;
+        }
+
+        if (entry == NULL || (int32_t)(candidate.LastUse - entry->LastUse) < 0)
+            entry = &candidate;
+    }
+
+    if (entry != NULL)
+    {
+        memcpy(entry->HostName, hostName, hostNameLen);
+        entry->HostName[hostNameLen] = 0;
+        entry->AddrFamily = addrFamily;
+        entry->State = DNSCacheEntry::kState_Pending;
+        entry->Result = INET_NO_ERROR;
+        entry->NumAddrs = 0;
+        entry->LastUse = ++mUseCounter;
+    }
+    else
+    {
+        WeaveLogError(Inet, "DNS cache FULL");
+    }
+
+    return entry;
+}
+
+INET_ERROR DNSCache::StartLookup(DNSCacheEntry &entry)
+{
+    INET_ERROR err = INET_NO_ERROR;
+    DNSResolver *lookup;
+    uint8_t options;
+
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+    // If name servers have been configured, query them directly.
+    if (mInet->mDNSClient.HasServers())
+        ExitNow(err = mInet->mDNSClient.StartQuery(entry));
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
+    // Otherwise perform the lookup with the platform resolver, using a resolver object of its own so that it is
+    // unaffected by the requests waiting on it being canceled.
+    lookup = DNSResolver::sPool.TryCreate(*mInet->mSystemLayer);
+    if (lookup == NULL)
+    {
+        WeaveLogError(Inet, "%s resolver pool FULL", "DNS");
+        ExitNow(err = INET_ERROR_NO_MEMORY);
+    }
+
+    lookup->InitInetLayerBasis(*mInet);
+    lookup->mCacheEntry = NULL;
+
+    // When looking up both address families, ask for them in preferred order so that at least one address of each
+    // is kept if they don't all fit.
+    options = entry.AddrFamily;
+    if (options == kDNSOption_AddrFamily_Any)
+        options = kDNSOption_AddrFamily_IPv6Preferred;
+
+    err = mInet->StartResolve(*lookup, entry.HostName, strlen(entry.HostName), options,
+                              INET_CONFIG_DNS_CACHE_MAX_ADDRS, entry.Addrs, HandleLookupComplete, this);
+
+exit:
+    return err;
+}
+
+void DNSCache::HandleLookupComplete(void *appState, INET_ERROR err, uint8_t addrCount, IPAddress *addrArray)
+{
+    DNSCache *cache = static_cast<DNSCache *>(appState);
+    uint32_t ttlSecs;
+
+    // The platform resolver was handed the address array of the entry being looked up.
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        DNSCacheEntry &entry = cache->mEntries[i];
+
+        if (entry.Addrs != addrArray || entry.State != DNSCacheEntry::kState_Pending)
+            continue;
+
+        // The platform resolvers don't report the time-to-live of the records. Transient failures are reported to
+        // the requests waiting on the lookup, but not cached.
+        if (err == INET_NO_ERROR)
+            ttlSecs = INET_CONFIG_DNS_CACHE_DEFAULT_TTL_SECS;
+        else if (err == INET_ERROR_HOST_NOT_FOUND)
+            ttlSecs = INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS;
+        else
+            ttlSecs = 0;
+
+        cache->Complete(entry, err, addrCount, ttlSecs);
+        break;
+    }
+}
+
+/**
+ *  Record the result of the lookup of an entry and answer the requests waiting on it.
+ *
+ *  @param[in]  entry       The entry that was looked up. Its addresses must already be in place.
+ *  @param[in]  err         The result of the lookup.
+ *  @param[in]  numAddrs    The number of addresses found.
+ *  @param[in]  ttlSecs     The time, in seconds, for which the result may be cached. If 0, the result is only
+ *                          reported to the requests waiting on the lookup.
+ */
+void DNSCache::Complete(DNSCacheEntry &entry, INET_ERROR err, uint8_t numAddrs, uint32_t ttlSecs)
+{
+    if (err == INET_NO_ERROR && numAddrs == 0)
+        err = INET_ERROR_HOST_NOT_FOUND;
+
+    entry.Result = err;
+    entry.NumAddrs = (err == INET_NO_ERROR) ? ::nl::Weave::min(numAddrs, (uint8_t)INET_CONFIG_DNS_CACHE_MAX_ADDRS) : 0;
+    entry.LastUse = ++mUseCounter;
+
+    // While the waiting requests are answered, the entry can't be replaced, and any new request for the host name
+    // made from a completion callback is answered immediately rather than waiting.
+    entry.State = DNSCacheEntry::kState_Completing;
+
+    for (size_t i = 0; i < DNSResolver::sPool.Size(); i++)
+    {
+        DNSResolver *resolver = DNSResolver::sPool.Get(*mInet->mSystemLayer, i);
+
+        if (resolver != NULL && resolver->mCacheEntry == &entry)
+            Deliver(*resolver, entry);
+    }
+
+    ttlSecs = ::nl::Weave::min(ttlSecs, (uint32_t)INET_CONFIG_DNS_CACHE_MAX_TTL_SECS);
+
+    entry.State = DNSCacheEntry::kState_Resolved;
+    entry.ExpiryTimeMS = Weave::System::Layer::GetClock_MonotonicMS() + ttlSecs * 1000ULL;
+}
+
+/**
+ *  Answer a request with the resolution held by a cache entry, and release its resolver.
+ */
+void DNSCache::Deliver(DNSResolver &resolver, const DNSCacheEntry &entry)
+{
+    DNSResolver::OnResolveCompleteFunct onComplete = resolver.OnComplete;
+    void *appState = resolver.AppState;
+    IPAddress *addrArray = resolver.AddrArray;
+    INET_ERROR err = entry.Result;
+    uint8_t numAddrs = 0;
+
+    if (err == INET_NO_ERROR)
+    {
+        numAddrs = CopyAddresses(entry, resolver.DNSOptions, resolver.MaxAddrs, addrArray);
+        if (numAddrs == 0)
+            err = INET_ERROR_HOST_NOT_FOUND;
+    }
+
+    // Release the resolver before calling the application, which may cancel the request or make another from the
+    // callback.
+    resolver.mCacheEntry = NULL;
+    resolver.Release();
+
+    if (onComplete != NULL)
+        onComplete(appState, err, numAddrs, addrArray);
+}
+
+/**
+ *  Return the address family looked up for a request with the given #DNSOptions.
+ *
+ *  Requests that accept both IPv4 and IPv6 addresses share a lookup of both, and differ only in the order in
+ *  which the addresses are returned to them.
+ */
+uint8_t DNSCache::GetAddrFamily(uint8_t options)
+{
+#if INET_CONFIG_ENABLE_IPV4
+    switch (options & kDNSOption_AddrFamily_Mask)
+    {
+    case kDNSOption_AddrFamily_IPv4Only:
+        return kDNSOption_AddrFamily_IPv4Only;
+    case kDNSOption_AddrFamily_IPv6Only:
+        return kDNSOption_AddrFamily_IPv6Only;
+    default:
+        return kDNSOption_AddrFamily_Any;
+    }
+#else // INET_CONFIG_ENABLE_IPV4
+    return kDNSOption_AddrFamily_IPv6Only;
+#endif // INET_CONFIG_ENABLE_IPV4
+}
+
+static inline bool IsAddressOfType(const IPAddress &addr, IPAddressType type)
+{
+    return type == kIPAddressType_Any || addr.Type() == type;
+}
+
+/**
+ *  Copy the addresses of a cache entry into a request's address array, ordered according to the address family
+ *  option of the request.
+ *
+ *  As with the platform resolver, when the addresses don't all fit, at least one address of the secondary family
+ *  is returned, if there is one.
+ *
+ *  @return The number of addresses copied.
+ */
+uint8_t DNSCache::CopyAddresses(const DNSCacheEntry &entry, uint8_t options, uint8_t maxAddrs, IPAddress *addrArray)
+{
+    uint8_t numAddrs = 0;
+
+#if INET_CONFIG_ENABLE_IPV4
+
+    IPAddressType primaryType, secondaryType;
+    uint8_t numPrimaryAddrs = 0, numSecondaryAddrs = 0;
+
+    switch (options & kDNSOption_AddrFamily_Mask)
+    {
+    case kDNSOption_AddrFamily_IPv4Only:
+        primaryType = kIPAddressType_IPv4;
+        secondaryType = kIPAddressType_Unknown;
+        break;
+    case kDNSOption_AddrFamily_IPv4Preferred:
+        primaryType = kIPAddressType_IPv4;
+        secondaryType = kIPAddressType_IPv6;
+        break;
+    case kDNSOption_AddrFamily_IPv6Only:
+        primaryType = kIPAddressType_IPv6;
+        secondaryType = kIPAddressType_Unknown;
+        break;
+    case kDNSOption_AddrFamily_IPv6Preferred:
+        primaryType = kIPAddressType_IPv6;
+        secondaryType = kIPAddressType_IPv4;
+        break;
+    default:
+        primaryType = kIPAddressType_Any;
+        secondaryType = kIPAddressType_Unknown;
+        break;
+    }
+
+    for (uint8_t i = 0; i < entry.NumAddrs; i++)
+    {
+        if (IsAddressOfType(entry.Addrs[i], primaryType))
+            numPrimaryAddrs++;
+        else if (secondaryType != kIPAddressType_Unknown && IsAddressOfType(entry.Addrs[i], secondaryType))
+            numSecondaryAddrs++;
+    }
+
+    if (numPrimaryAddrs + numSecondaryAddrs > maxAddrs && maxAddrs > 1 && numPrimaryAddrs > 0 && numSecondaryAddrs > 0)
+    {
+        numPrimaryAddrs = ::nl::Weave::min(numPrimaryAddrs, (uint8_t)(maxAddrs - 1));
+    }
+
+    for (uint8_t i = 0; i < entry.NumAddrs && numAddrs < maxAddrs && numPrimaryAddrs > 0; i++)
+    {
+        if (IsAddressOfType(entry.Addrs[i], primaryType))
+        {
+            addrArray[numAddrs++] = entry.Addrs[i];
+            numPrimaryAddrs--;
+        }
+    }
+
+    for (uint8_t i = 0; i < entry.NumAddrs && numAddrs < maxAddrs && numSecondaryAddrs > 0; i++)
+    {
+        if (IsAddressOfType(entry.Addrs[i], secondaryType))
+        {
+            addrArray[numAddrs++] = entry.Addrs[i];
+            numSecondaryAddrs--;
+        }
+    }
+
+#else // INET_CONFIG_ENABLE_IPV4
+
+    for (uint8_t i = 0; i < entry.NumAddrs && numAddrs < maxAddrs; i++)
+        addrArray[numAddrs++] = entry.Addrs[i];
+
+#endif // INET_CONFIG_ENABLE_IPV4
+
+    return numAddrs;
+}
+
+} // namespace Inet
+} // namespace nl
+
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
@@ -0,0 +1,119 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines DNSCache, the object that caches the results of
+ *      Domain Name System (DNS) resolution in InetLayer and shares lookups
+ *      in progress between concurrent requests.
+ *
+ */
+
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <InetLayer/DNSResolver.h>
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+
+namespace nl {
+namespace Inet {
+
+/**
+ *  @struct DNSCacheEntry
+ *
+ *  @brief
+ *    The cached resolution of a host name for one address family, or the
+ *    lookup in progress for it.
+ *
+ */
+struct DNSCacheEntry
+{
+    /// States of a DNS cache entry.
+    enum
+    {
+        kState_Free                     = 0,    ///< The entry is unused.
+        kState_Pending                  = 1,    ///< A lookup of the host name is in progress.
+        kState_Completing               = 2,    ///< The requests waiting on a lookup are being answered.
+        kState_Resolved                 = 3,    ///< The entry holds the result of a lookup, until it expires.
+    };
+
+    char HostName[NL_DNS_HOSTNAME_MAX_LEN + 1];         /**< The host name, NUL-terminated. */
+    IPAddress Addrs[INET_CONFIG_DNS_CACHE_MAX_ADDRS];   /**< The addresses of the host, in the order they were returned. */
+    uint64_t ExpiryTimeMS;                              /**< The monotonic time at which a resolved entry expires. */
+    uint32_t LastUse;                                   /**< Use counter value at the last use, for LRU replacement. */
+    INET_ERROR Result;                                  /**< The result of the lookup. */
+    uint8_t NumAddrs;                                   /**< The number of entries in Addrs. */
+    uint8_t AddrFamily;                                 /**< The address family looked up, as a #DNSOptions value. */
+    uint8_t State;                                      /**< The state of the entry. */
+
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+    // State of the lookup when it is performed by the DNS client.
+    uint64_t QueryDeadlineMS;                           /**< The monotonic time at which the current attempt times out. */
+    uint32_t QueryTTL;                                  /**< The smallest time-to-live of the records received. */
+    uint16_t QueryIds[2];                               /**< The identifiers of the A and AAAA queries. */
+    uint8_t QueryFlags;                                 /**< The queries yet to be answered. */
+    uint8_t QueryAttempts;                              /**< The number of times the queries have been sent. */
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+};
+
+/**
+ *  @class DNSCache
+ *
+ *  @brief
+ *    This is an internal class to InetLayer that caches the results of
+ *    host name resolution, positive and negative, for their time-to-live,
+ *    and lets concurrent requests for the same host name share a single
+ *    lookup. There is no public interface available for the application
+ *    layer.
+ *
+ */
+class DNSCache
+{
+    friend class InetLayer;
+    friend class DNSClient;
+
+private:
+    InetLayer *mInet;
+    DNSCacheEntry mEntries[INET_CONFIG_DNS_CACHE_SIZE];
+    uint32_t mUseCounter;
+
+    void Init(InetLayer *inet);
+    void Clear(void);
+    void Shutdown(void);
+
+    INET_ERROR Resolve(DNSResolver &resolver, const char *hostName, uint16_t hostNameLen, uint8_t options,
+            uint8_t maxAddrs, IPAddress *addrArray,
+            DNSResolver::OnResolveCompleteFunct onComplete, void *appState);
+
+    DNSCacheEntry *Find(const char *hostName, uint16_t hostNameLen, uint8_t addrFamily);
+    DNSCacheEntry *NewEntry(const char *hostName, uint16_t hostNameLen, uint8_t addrFamily);
+    INET_ERROR StartLookup(DNSCacheEntry &entry);
+    void Complete(DNSCacheEntry &entry, INET_ERROR err, uint8_t numAddrs, uint32_t ttlSecs);
+    void Deliver(DNSResolver &resolver, const DNSCacheEntry &entry);
+
+    static void HandleLookupComplete(void *appState, INET_ERROR err, uint8_t addrCount, IPAddress *addrArray);
+    static uint8_t GetAddrFamily(uint8_t options);
+    static uint8_t CopyAddresses(const DNSCacheEntry &entry, uint8_t options, uint8_t maxAddrs, IPAddress *addrArray);
+};
+
+} // namespace Inet
+} // namespace nl
+
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+#endif // !defined(DNSCACHE_H)
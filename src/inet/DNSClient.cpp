@@ -0,0 +1,664 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements DNSClient, the object that resolves host names by
+ *      querying Domain Name System (DNS) servers directly over UDP.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <InetLayer/InetLayer.h>
+
+#include <Weave/Core/WeaveEncoding.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Support/RandUtils.h>
+#include <Weave/Support/logging/WeaveLogging.h>
+
+#include <ctype.h>
+#include <string.h>
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+
+namespace nl {
+namespace Inet {
+
+using Weave::System::PacketBuffer;
+using namespace nl::Weave::Encoding;
+
+// DNS message constants, per RFC 1035 and RFC 3596.
+enum
+{
+    kDNSHeaderLength                = 12,
+
+    kDNSFlag_Response               = 0x8000,
+    kDNSFlag_RecursionDesired       = 0x0100,
+    kDNSFlags_ResponseCodeMask      = 0x000F,
+
+    kDNSResponseCode_NoError        = 0,
+    kDNSResponseCode_ServerFailure  = 2,
+    kDNSResponseCode_NameError      = 3,
+
+    kDNSType_A                      = 1,
+    kDNSType_CNAME                  = 5,
+    kDNSType_SOA                    = 6,
+    kDNSType_AAAA                   = 28,
+    kDNSClass_IN                    = 1,
+
+    kDNSMaxLabelLength              = 63,
+    kDNSMaxNamePointers             = 16,
+};
+
+void DNSClient::Init(InetLayer *inet)
+{
+    mInet = inet;
+    mIPv6EndPoint = NULL;
+#if INET_CONFIG_ENABLE_IPV4
+    mIPv4EndPoint = NULL;
+#endif // INET_CONFIG_ENABLE_IPV4
+    mServerPort = 0;
+    mNumServers = 0;
+}
+
+void DNSClient::Shutdown(void)
+{
+    mInet->mSystemLayer->CancelTimer(HandleTimeout, this);
+
+    if (mIPv6EndPoint != NULL)
+    {
+        mIPv6EndPoint->Free();
+        mIPv6EndPoint = NULL;
+    }
+
+#if INET_CONFIG_ENABLE_IPV4
+    if (mIPv4EndPoint != NULL)
+    {
+        mIPv4EndPoint->Free();
+        mIPv4EndPoint = NULL;
+    }
+#endif // INET_CONFIG_ENABLE_IPV4
+
+    mNumServers = 0;
+}
+
+/**
+ *  Set the name servers to query. Queries in progress are retried with the new servers.
+ */
+INET_ERROR DNSClient::SetServers(uint8_t numServers, const IPAddress *serverAddrs, uint16_t serverPort)
+{
+    INET_ERROR err = INET_NO_ERROR;
+
+    VerifyOrExit(numServers <= INET_CONFIG_DNS_CLIENT_MAX_SERVERS, err = INET_ERROR_BAD_ARGS);
+    VerifyOrExit(numServers == 0 || (serverAddrs != NULL && serverPort != 0), err = INET_ERROR_BAD_ARGS);
+
+    for (uint8_t i = 0; i < numServers; i++)
+    {
+#if INET_CONFIG_ENABLE_IPV4
+        VerifyOrExit(serverAddrs[i].Type() == kIPAddressType_IPv4 || serverAddrs[i].Type() == kIPAddressType_IPv6,
+                     err = INET_ERROR_BAD_ARGS);
+#else // INET_CONFIG_ENABLE_IPV4
+        VerifyOrExit(serverAddrs[i].Type() == kIPAddressType_IPv6, err = INET_ERROR_BAD_ARGS);
+#endif // INET_CONFIG_ENABLE_IPV4
+    }
+
+    for (uint8_t i = 0; i < numServers; i++)
+        mServers[i] = serverAddrs[i];
+
+    mNumServers = numServers;
+    mServerPort = serverPort;
+
+exit:
+    return err;
+}
+
+/**
+ *  Start querying the name servers for the addresses of a cache entry's host name.
+ *
+ *  On success, the cache is notified of the result by a call to DNSCache::Complete() once the queries have been
+ *  answered or have timed out.
+ */
+INET_ERROR DNSClient::StartQuery(DNSCacheEntry &entry)
+{
+    INET_ERROR err = INET_NO_ERROR;
+
+#if INET_CONFIG_ENABLE_IPV4
+    switch (entry.AddrFamily)
+    {
+    case kDNSOption_AddrFamily_IPv4Only:
+        entry.QueryFlags = kQueryFlag_A;
+        break;
+    case kDNSOption_AddrFamily_IPv6Only:
+        entry.QueryFlags = kQueryFlag_AAAA;
+        break;
+    default:
+        entry.QueryFlags = kQueryFlag_A | kQueryFlag_AAAA;
+        break;
+    }
+#else // INET_CONFIG_ENABLE_IPV4
+    entry.QueryFlags = kQueryFlag_AAAA;
+#endif // INET_CONFIG_ENABLE_IPV4
+
+    entry.QueryIds[0] = Weave::GetRandU16();
+    entry.QueryIds[1] = Weave::GetRandU16();
+    entry.QueryAttempts = 0;
+    entry.QueryTTL = UINT32_MAX;
+    entry.NumAddrs = 0;
+
+    // Move on to the next server if the queries can't be sent to one, e.g. because its address family has no route.
+    do
+    {
+        err = SendQueries(entry);
+    } while (err != INET_NO_ERROR && entry.QueryAttempts < INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS);
+
+    if (err == INET_NO_ERROR)
+        ArmTimer();
+    else
+        entry.QueryFlags = 0;
+
+    return err;
+}
+
+/**
+ *  Send the queries of an entry yet to be answered to the next name server in turn.
+ */
+INET_ERROR DNSClient::SendQueries(DNSCacheEntry &entry)
+{
+    INET_ERROR err = INET_NO_ERROR;
+    const IPAddress &serverAddr = mServers[entry.QueryAttempts % mNumServers];
+    UDPEndPoint *endPoint;
+
+    entry.QueryAttempts++;
+    entry.QueryDeadlineMS = Weave::System::Layer::GetClock_MonotonicMS() + INET_CONFIG_DNS_CLIENT_TIMEOUT_MSECS;
+
+    err = GetEndPoint(serverAddr, endPoint);
+    SuccessOrExit(err);
+
+    if (entry.QueryFlags & kQueryFlag_A)
+    {
+        err = SendQuery(endPoint, serverAddr, entry.HostName, entry.QueryIds[0], kDNSType_A);
+        SuccessOrExit(err);
+    }
+
+    if (entry.QueryFlags & kQueryFlag_AAAA)
+    {
+        err = SendQuery(endPoint, serverAddr, entry.HostName, entry.QueryIds[1], kDNSType_AAAA);
+        SuccessOrExit(err);
+    }
+
+exit:
+    return err;
+}
+
+/**
+ *  Encode a dotted host name as a sequence of DNS labels.
+ */
+static INET_ERROR EncodeName(const char *hostName, uint8_t *&p, const uint8_t *end)
+{
+    INET_ERROR err = INET_NO_ERROR;
+
+    while (*hostName != 0)
+    {
+        const char *dot = strchr(hostName, '.');
+        size_t labelLen = (dot != NULL) ? (size_t)(dot - hostName) : strlen(hostName);
+
+        VerifyOrExit(labelLen > 0, err = INET_ERROR_BAD_ARGS);
+        VerifyOrExit(labelLen <= kDNSMaxLabelLength, err = INET_ERROR_HOST_NAME_TOO_LONG);
+        VerifyOrExit((size_t)(end - p) > labelLen + 1, err = INET_ERROR_HOST_NAME_TOO_LONG);
+
+        *p++ = (uint8_t)labelLen;
+        memcpy(p, hostName, labelLen);
+        p += labelLen;
+
+        // A trailing dot denotes the root.
+        hostName += labelLen;
+        if (*hostName == '.')
+            hostName++;
+    }
+
+    VerifyOrExit(p < end, err = INET_ERROR_HOST_NAME_TOO_LONG);
+    *p++ = 0;
+
+exit:
+    return err;
+}
+
+INET_ERROR DNSClient::SendQuery(UDPEndPoint *endPoint, const IPAddress &serverAddr, const char *hostName, uint16_t id,
+                                uint16_t type)
+{
+    INET_ERROR err = INET_NO_ERROR;
+    PacketBuffer *msg = PacketBuffer::New();
+    uint8_t *p;
+    const uint8_t *end;
+
+    VerifyOrExit(msg != NULL, err = INET_ERROR_NO_MEMORY);
+
+    p = msg->Start();
+    end = p + msg->AvailableDataLength();
+    VerifyOrExit(end - p >= kDNSHeaderLength + 4, err = INET_ERROR_NO_MEMORY);
+
+    BigEndian::Write16(p, id);
+    BigEndian::Write16(p, kDNSFlag_RecursionDesired);
+    BigEndian::Write16(p, 1); // QDCOUNT
+    BigEndian::Write16(p, 0); // ANCOUNT
+    BigEndian::Write16(p, 0); // NSCOUNT
+    BigEndian::Write16(p, 0); // ARCOUNT
+
+    err = EncodeName(hostName, p, end - 4);
+    SuccessOrExit(err);
+
+    BigEndian::Write16(p, type);
+    BigEndian::Write16(p, kDNSClass_IN);
+
+    msg->SetDataLength((uint16_t)(p - msg->Start()));
+
+    err = endPoint->SendTo(serverAddr, mServerPort, msg);
+    msg = NULL;
+
+exit:
+    if (msg != NULL)
+        PacketBuffer::Free(msg);
+
+    return err;
+}
+
+/**
+ *  Get the end point from which queries are sent to a name server, creating it on first use.
+ */
+INET_ERROR DNSClient::GetEndPoint(const IPAddress &serverAddr, UDPEndPoint *&endPoint)
+{
+    INET_ERROR err = INET_NO_ERROR;
+    const IPAddressType addrType = serverAddr.Type();
+    UDPEndPoint **slot = &mIPv6EndPoint;
+
+#if INET_CONFIG_ENABLE_IPV4
+    if (addrType == kIPAddressType_IPv4)
+        slot = &mIPv4EndPoint;
+#endif // INET_CONFIG_ENABLE_IPV4
+
+    if (*slot == NULL)
+    {
+        err = mInet->NewUDPEndPoint(slot);
+        SuccessOrExit(err);
+
+        (*slot)->AppState = this;
+        (*slot)->OnMessageReceived = reinterpret_cast<IPEndPointBasis::OnMessageReceivedFunct>(HandleMessageReceived);
+
+        err = (*slot)->Bind(addrType, IPAddress::Any, 0);
+        if (err == INET_NO_ERROR)
+            err = (*slot)->Listen();
+
+        if (err != INET_NO_ERROR)
+        {
+            (*slot)->Free();
+            *slot = NULL;
+            ExitNow();
+        }
+    }
+
+    endPoint = *slot;
+
+exit:
+    return err;
+}
+
+/**
+ *  Resend the unanswered queries of an entry to the next name server, or fail the lookup if it has been attempted
+ *  too many times.
+ *
+ *  @param[in]  entry   The entry being looked up.
+ *  @param[in]  err     The error to report if no attempts remain.
+ */
+void DNSClient::Retry(DNSCacheEntry &entry, INET_ERROR err)
+{
+    while (mNumServers > 0 && entry.QueryAttempts < INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS)
+    {
+        if (SendQueries(entry) == INET_NO_ERROR)
+            return;
+    }
+
+    // Report whatever addresses were received, but don't cache a partial result.
+    if (entry.NumAddrs > 0)
+        Finish(entry, INET_NO_ERROR, 0);
+    else
+        Finish(entry, err, 0);
+}
+
+void DNSClient::Finish(DNSCacheEntry &entry, INET_ERROR err, uint32_t ttlSecs)
+{
+    entry.QueryFlags = 0;
+
+    mInet->mDNSCache.Complete(entry, err, entry.NumAddrs, ttlSecs);
+}
+
+/**
+ *  Skip over a possibly compressed domain name in a DNS message.
+ */
+static bool SkipName(const uint8_t *msg, uint16_t msgLen, uint16_t &offset)
+{
+    while (offset < msgLen)
+    {
+        const uint8_t labelLen = msg[offset];
+
+        if ((labelLen & 0xC0) == 0xC0)
+        {
+            offset += 2;
+            return offset <= msgLen;
+        }
+
+        if ((labelLen & 0xC0) != 0)
+            return false;
+
+        offset += 1 + labelLen;
+        if (labelLen == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ *  Compare a possibly compressed domain name in a DNS message with a dotted host name, ignoring case.
+ */
+static bool MatchName(const uint8_t *msg, uint16_t msgLen, uint16_t offset, const char *hostName)
+{
+    const char *p = hostName;
+    uint8_t numPointers = 0;
+
+    while (offset < msgLen)
+    {
+        const uint8_t labelLen = msg[offset];
+
+        if ((labelLen & 0xC0) == 0xC0)
+        {
+            if (offset + 1 >= msgLen || ++numPointers > kDNSMaxNamePointers)
+                return false;
+            offset = (uint16_t)(((labelLen & 0x3F) << 8) | msg[offset + 1]);
+            continue;
+        }
+
+        if ((labelLen & 0xC0) != 0)
+            return false;
+        offset++;
+
+        if (labelLen == 0)
+            return *p == 0 || (p[0] == '.' && p[1] == 0);
+
+        if (p != hostName && *p++ != '.')
+            return false;
+
+        if (offset + labelLen > msgLen)
+            return false;
+
+        for (uint8_t i = 0; i < labelLen; i++, p++, offset++)
+        {
+            if (*p == 0 || tolower((unsigned char)*p) != tolower(msg[offset]))
+                return false;
+        }
+    }
+
+    return false;
+}
+
+/**
+ *  Process a response from a name server, recording the addresses it holds in the entry whose query it answers.
+ *  Responses that don't answer a query in progress, or are malformed, are ignored.
+ */
+void DNSClient::HandleResponse(const uint8_t *msg, uint16_t msgLen, const IPPacketInfo &pktInfo)
+{
+    DNSCacheEntry *entry = NULL;
+    uint16_t id, flags, numAnswers, numAuthorities, qType, qClass;
+    uint16_t offset = kDNSHeaderLength;
+    uint16_t nameOffset;
+    uint8_t queryFlag = 0;
+    uint8_t prevNumAddrs = 0;
+    uint8_t numAddrs = 0;
+    uint32_t negativeTTL = INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS;
+    bool haveSOA = false;
+
+    VerifyOrExit(IsServer(pktInfo.SrcAddress, pktInfo.SrcPort), /* no-op */);
+    VerifyOrExit(msgLen >= kDNSHeaderLength, /* no-op */);
+
+    id = BigEndian::Get16(msg);
+    flags = BigEndian::Get16(msg + 2);
+    numAnswers = BigEndian::Get16(msg + 6);
+    numAuthorities = BigEndian::Get16(msg + 8);
+
+    VerifyOrExit((flags & kDNSFlag_Response) != 0, /* no-op */);
+    VerifyOrExit(BigEndian::Get16(msg + 4) == 1, /* no-op */);
+
+    // The response must repeat the question.
+    nameOffset = offset;
+    VerifyOrExit(SkipName(msg, msgLen, offset) && offset + 4 <= msgLen, /* no-op */);
+    qType = BigEndian::Get16(msg + offset);
+    qClass = BigEndian::Get16(msg + offset + 2);
+    offset += 4;
+
+    VerifyOrExit(qClass == kDNSClass_IN, /* no-op */);
+
+    // Find the lookup the response answers.
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE && entry == NULL; i++)
+    {
+        DNSCacheEntry &candidate = mInet->mDNSCache.mEntries[i];
+
+        if (candidate.State != DNSCacheEntry::kState_Pending || candidate.QueryFlags == 0)
+            continue;
+
+        if (qType == kDNSType_A && (candidate.QueryFlags & kQueryFlag_A) && candidate.QueryIds[0] == id)
+            queryFlag = kQueryFlag_A;
+        else if (qType == kDNSType_AAAA && (candidate.QueryFlags & kQueryFlag_AAAA) && candidate.QueryIds[1] == id)
+            queryFlag = kQueryFlag_AAAA;
+        else
+            continue;
+
+        if (MatchName(msg, msgLen, nameOffset, candidate.HostName))
+            entry = &candidate;
+    }
+
+    VerifyOrExit(entry != NULL, /* no-op */);
+    prevNumAddrs = entry->NumAddrs;
+
+    switch (flags & kDNSFlags_ResponseCodeMask)
+    {
+    case kDNSResponseCode_NoError:
+    case kDNSResponseCode_NameError:
+        break;
+
+    case kDNSResponseCode_ServerFailure:
+        Retry(*entry, INET_ERROR_DNS_TRY_AGAIN);
+        return;
+
+    default:
+        Retry(*entry, INET_ERROR_DNS_NO_RECOVERY);
+        return;
+    }
+
+    // Collect the addresses in the answer section. Records are not required to be in any particular order, so the
+    // owner names of the records aren't checked against the CNAME chain; the question has already been matched.
+    for (uint16_t i = 0; i < numAnswers; i++)
+    {
+        uint16_t type, rrClass, dataLen;
+        uint32_t ttl;
+
+        VerifyOrExit(SkipName(msg, msgLen, offset) && offset + 10 <= msgLen, /* no-op */);
+        type = BigEndian::Get16(msg + offset);
+        rrClass = BigEndian::Get16(msg + offset + 2);
+        ttl = BigEndian::Get32(msg + offset + 4);
+        dataLen = BigEndian::Get16(msg + offset + 8);
+        offset += 10;
+        VerifyOrExit(offset + dataLen <= msgLen, /* no-op */);
+
+        if (rrClass == kDNSClass_IN && (type == kDNSType_A || type == kDNSType_AAAA || type == kDNSType_CNAME))
+        {
+            const uint8_t *data = msg + offset;
+            IPAddress addr;
+            bool haveAddr = false;
+
+#if INET_CONFIG_ENABLE_IPV4
+            if (type == kDNSType_A && qType == kDNSType_A && dataLen == 4)
+            {
+                addr.Addr[0] = 0;
+                addr.Addr[1] = 0;
+                addr.Addr[2] = BigEndian::HostSwap32(0xFFFF);
+                memcpy(&addr.Addr[3], data, 4);
+                haveAddr = true;
+            }
+#endif // INET_CONFIG_ENABLE_IPV4
+
+            if (type == kDNSType_AAAA && qType == kDNSType_AAAA && dataLen == 16)
+            {
+                IPAddress::ReadAddress(data, addr);
+                haveAddr = true;
+            }
+
+            if (haveAddr)
+            {
+                if (entry->NumAddrs < INET_CONFIG_DNS_CACHE_MAX_ADDRS)
+                    entry->Addrs[entry->NumAddrs++] = addr;
+                numAddrs++;
+            }
+
+            if (haveAddr || type == kDNSType_CNAME)
+                entry->QueryTTL = ::nl::Weave::min(entry->QueryTTL, ttl);
+        }
+
+        offset += dataLen;
+    }
+
+    // If there are no addresses, the time-to-live of the negative answer is taken from the SOA record in the
+    // authority section, as per RFC 2308.
+    for (uint16_t i = 0; i < numAuthorities && numAddrs == 0 && !haveSOA; i++)
+    {
+        uint16_t type, dataLen, dataOffset;
+        uint32_t ttl;
+
+        VerifyOrExit(SkipName(msg, msgLen, offset) && offset + 10 <= msgLen, /* no-op */);
+        type = BigEndian::Get16(msg + offset);
+        ttl = BigEndian::Get32(msg + offset + 4);
+        dataLen = BigEndian::Get16(msg + offset + 8);
+        offset += 10;
+        VerifyOrExit(offset + dataLen <= msgLen, /* no-op */);
+
+        if (type == kDNSType_SOA)
+        {
+            // Skip MNAME and RNAME to the MINIMUM field, the last of the five 32-bit fields that follow.
+            dataOffset = offset;
+            VerifyOrExit(SkipName(msg, msgLen, dataOffset) && SkipName(msg, msgLen, dataOffset), /* no-op */);
+            VerifyOrExit(dataOffset + 20 <= offset + dataLen, /* no-op */);
+
+            negativeTTL = ::nl::Weave::min(ttl, BigEndian::Get32(msg + dataOffset + 16));
+            haveSOA = true;
+        }
+
+        offset += dataLen;
+    }
+
+    if (numAddrs == 0)
+        entry->QueryTTL = ::nl::Weave::min(entry->QueryTTL, negativeTTL);
+
+    entry->QueryFlags &= ~queryFlag;
+
+    if (entry->QueryFlags == 0)
+    {
+        Finish(*entry, (entry->NumAddrs > 0) ? INET_NO_ERROR : INET_ERROR_HOST_NOT_FOUND, entry->QueryTTL);
+    }
+
+    return;
+
+exit:
+    // Drop any addresses taken from a malformed response; the query is left to be answered again.
+    if (entry != NULL && entry->State == DNSCacheEntry::kState_Pending)
+        entry->NumAddrs = prevNumAddrs;
+}
+
+bool DNSClient::IsServer(const IPAddress &addr, uint16_t port) const
+{
+    if (port != mServerPort)
+        return false;
+
+    for (uint8_t i = 0; i < mNumServers; i++)
+    {
+        if (mServers[i] == addr)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ *  Start the timer for the earliest deadline among the queries in progress, if any.
+ */
+void DNSClient::ArmTimer(void)
+{
+    Weave::System::Layer &systemLayer = *mInet->mSystemLayer;
+    const uint64_t now = Weave::System::Layer::GetClock_MonotonicMS();
+    uint64_t deadline = UINT64_MAX;
+
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        const DNSCacheEntry &entry = mInet->mDNSCache.mEntries[i];
+
+        if (entry.State == DNSCacheEntry::kState_Pending && entry.QueryFlags != 0)
+            deadline = ::nl::Weave::min(deadline, entry.QueryDeadlineMS);
+    }
+
+    systemLayer.CancelTimer(HandleTimeout, this);
+
+    if (deadline != UINT64_MAX)
+        systemLayer.StartTimer((deadline > now) ? (uint32_t)(deadline - now) : 0, HandleTimeout, this);
+}
+
+void DNSClient::HandleTimeout(Weave::System::Layer *systemLayer, void *appState, Weave::System::Error err)
+{
+    DNSClient *client = static_cast<DNSClient *>(appState);
+    const uint64_t now = Weave::System::Layer::GetClock_MonotonicMS();
+
+    for (size_t i = 0; i < INET_CONFIG_DNS_CACHE_SIZE; i++)
+    {
+        DNSCacheEntry &entry = client->mInet->mDNSCache.mEntries[i];
+
+        if (entry.State == DNSCacheEntry::kState_Pending && entry.QueryFlags != 0 && entry.QueryDeadlineMS <= now)
+        {
+            WeaveLogDetail(Inet, "DNS query for %s timed out (attempt %u)", entry.HostName, entry.QueryAttempts);
+            client->Retry(entry, INET_ERROR_DNS_TRY_AGAIN);
+        }
+    }
+
+    client->ArmTimer();
+}
+
+void DNSClient::HandleMessageReceived(UDPEndPoint *endPoint, PacketBuffer *msg, const IPPacketInfo *pktInfo)
+{
+    DNSClient *client = static_cast<DNSClient *>(endPoint->AppState);
+
+    // Responses are small enough to be received in a single buffer.
+    if (msg->Next() == NULL)
+        client->HandleResponse(msg->Start(), msg->DataLength(), *pktInfo);
+
+    PacketBuffer::Free(msg);
+
+    client->ArmTimer();
+}
+
+} // namespace Inet
+} // namespace nl
+
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
@@ -0,0 +1,99 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines DNSClient, the object that resolves host names by
+ *      querying Domain Name System (DNS) servers directly over UDP.
+ *
+ */
+
+#ifndef DNSCLIENT_H
+#define DNSCLIENT_H
+
+#include <InetLayer/DNSCache.h>
+#include <InetLayer/UDPEndPoint.h>
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+
+namespace nl {
+namespace Inet {
+
+/**
+ *  @class DNSClient
+ *
+ *  @brief
+ *    This is an internal class to InetLayer that looks up host names for
+ *    the DNS cache by sending A and AAAA queries to the configured name
+ *    servers. It is driven by the events of the system layer: responses
+ *    arrive through a UDP end point and retries are timed with a system
+ *    timer, so no threads are needed. There is no public interface
+ *    available for the application layer.
+ *
+ */
+class DNSClient
+{
+    friend class InetLayer;
+    friend class DNSCache;
+
+private:
+    /// Queries of a lookup yet to be answered.
+    enum
+    {
+        kQueryFlag_A                    = 0x01, ///< The query for IPv4 addresses.
+        kQueryFlag_AAAA                 = 0x02, ///< The query for IPv6 addresses.
+    };
+
+    InetLayer *mInet;
+    UDPEndPoint *mIPv6EndPoint;
+#if INET_CONFIG_ENABLE_IPV4
+    UDPEndPoint *mIPv4EndPoint;
+#endif // INET_CONFIG_ENABLE_IPV4
+    IPAddress mServers[INET_CONFIG_DNS_CLIENT_MAX_SERVERS];
+    uint16_t mServerPort;
+    uint8_t mNumServers;
+
+    void Init(InetLayer *inet);
+    void Shutdown(void);
+    INET_ERROR SetServers(uint8_t numServers, const IPAddress *serverAddrs, uint16_t serverPort);
+    bool HasServers(void) const;
+
+    INET_ERROR StartQuery(DNSCacheEntry &entry);
+    INET_ERROR SendQueries(DNSCacheEntry &entry);
+    INET_ERROR SendQuery(UDPEndPoint *endPoint, const IPAddress &serverAddr, const char *hostName, uint16_t id, uint16_t type);
+    INET_ERROR GetEndPoint(const IPAddress &serverAddr, UDPEndPoint *&endPoint);
+    void Retry(DNSCacheEntry &entry, INET_ERROR err);
+    void Finish(DNSCacheEntry &entry, INET_ERROR err, uint32_t ttlSecs);
+    void HandleResponse(const uint8_t *msg, uint16_t msgLen, const IPPacketInfo &pktInfo);
+    bool IsServer(const IPAddress &addr, uint16_t port) const;
+    void ArmTimer(void);
+
+    static void HandleTimeout(Weave::System::Layer *systemLayer, void *appState, Weave::System::Error err);
+    static void HandleMessageReceived(UDPEndPoint *endPoint, Weave::System::PacketBuffer *msg, const IPPacketInfo *pktInfo);
+};
+
+inline bool DNSClient::HasServers(void) const
+{
+    return mNumServers > 0;
+}
+
+} // namespace Inet
+} // namespace nl
+
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+#endif // !defined(DNSCLIENT_H)
@@ -97,16 +97,8 @@ INET_ERROR DNSResolver::Resolve(const char *hostName, uint16_t hostNameLen, uint
     return INET_ERROR_NOT_IMPLEMENTED;
 #endif // !WEAVE_SYSTEM_CONFIG_USE_SOCKETS && !LWIP_DNS
 
-    uint8_t addrFamilyOption = (options & kDNSOption_AddrFamily_Mask);
-    uint8_t optionFlags = (options & kDNSOption_Flags_Mask);
-
     // Check that the supplied options are valid.
-    if ((addrFamilyOption != kDNSOption_AddrFamily_Any &&
-         addrFamilyOption != kDNSOption_AddrFamily_IPv4Only &&
-         addrFamilyOption != kDNSOption_AddrFamily_IPv4Preferred &&
-         addrFamilyOption != kDNSOption_AddrFamily_IPv6Only &&
-         addrFamilyOption != kDNSOption_AddrFamily_IPv6Preferred) ||
-        (optionFlags & ~kDNSOption_ValidFlags) != 0)
+    if (!AreOptionsValid(options))
     {
         Release();
         return INET_ERROR_BAD_ARGS;
@@ -131,6 +123,10 @@ INET_ERROR DNSResolver::Resolve(const char *hostName, uint16_t hostNameLen, uint
 
 #if WEAVE_SYSTEM_CONFIG_USE_LWIP
 
+#if INET_CONFIG_ENABLE_IPV4
+    uint8_t addrFamilyOption = (options & kDNSOption_AddrFamily_Mask);
+#endif // INET_CONFIG_ENABLE_IPV4
+
 #if LWIP_VERSION_MAJOR > 1 || LWIP_VERSION_MINOR >= 5
 
     u8_t lwipAddrType;
@@ -238,6 +234,27 @@ INET_ERROR DNSResolver::Resolve(const char *hostName, uint16_t hostNameLen, uint
 }
 
 
+/**
+ *  This method checks whether an integer value is a valid combination of #DNSOptions.
+ *
+ *  @param[in]  options     The options to check.
+ *
+ *  @return true if the options are valid, false otherwise.
+ *
+ */
+bool DNSResolver::AreOptionsValid(uint8_t options)
+{
+    uint8_t addrFamilyOption = (options & kDNSOption_AddrFamily_Mask);
+    uint8_t optionFlags = (options & kDNSOption_Flags_Mask);
+
+    return (addrFamilyOption == kDNSOption_AddrFamily_Any ||
+            addrFamilyOption == kDNSOption_AddrFamily_IPv4Only ||
+            addrFamilyOption == kDNSOption_AddrFamily_IPv4Preferred ||
+            addrFamilyOption == kDNSOption_AddrFamily_IPv6Only ||
+            addrFamilyOption == kDNSOption_AddrFamily_IPv6Preferred) &&
+           (optionFlags & ~kDNSOption_ValidFlags) == 0;
+}
+
 /**
  *  This method cancels DNS requests that are in progress.
  *
@@ -246,6 +263,18 @@ INET_ERROR DNSResolver::Resolve(const char *hostName, uint16_t hostNameLen, uint
  */
 INET_ERROR DNSResolver::Cancel()
 {
+#if INET_CONFIG_ENABLE_DNS_CACHE
+    // A request waiting on a lookup shared through the DNS cache can be released right away; the lookup itself
+    // carries on, so that its result is cached for the other requests.
+    if (mCacheEntry != NULL)
+    {
+        mCacheEntry = NULL;
+        OnComplete = NULL;
+        Release();
+        return INET_NO_ERROR;
+    }
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
 #if WEAVE_SYSTEM_CONFIG_USE_LWIP
 
     // NOTE: LwIP does not support canceling DNS requests that are in progress.  As a consequence,
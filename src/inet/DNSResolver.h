@@ -39,6 +39,10 @@ namespace Inet {
 
 class InetLayer;
 
+#if INET_CONFIG_ENABLE_DNS_CACHE
+struct DNSCacheEntry;
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
 /**
  * Options controlling how IP address resolution is performed.
  */
@@ -76,6 +80,9 @@ class DNSResolver: public InetLayerBasis
 {
 private:
     friend class InetLayer;
+#if INET_CONFIG_ENABLE_DNS_CACHE
+    friend class DNSCache;
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
 
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
 #if INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
@@ -133,6 +140,15 @@ private:
      */
     uint8_t DNSOptions;
 
+#if INET_CONFIG_ENABLE_DNS_CACHE
+    /**
+     *  The DNS cache entry whose lookup the request is waiting on, if any.
+     */
+    DNSCacheEntry *mCacheEntry;
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
+    static bool AreOptionsValid(uint8_t options);
+
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
 
     void InitAddrInfoHints(struct addrinfo & hints);
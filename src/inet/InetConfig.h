@@ -286,6 +286,22 @@
 #define INET_CONFIG_NUM_TUN_ENDPOINTS                       64
 #endif // INET_CONFIG_NUM_TUN_ENDPOINTS
 
+/**
+ *  @def INET_CONFIG_TUN_MAX_READS_PER_EVENT
+ *
+ *  @brief
+ *    This is the maximum number of packets a TUN end point reads from
+ *    its tunnel device each time the device becomes readable.
+ *
+ *    Reading a burst of packets per select() wakeup amortizes the cost
+ *    of the event loop over the packets already queued by the kernel.
+ *    Only applies when using sockets.
+ *
+ */
+#ifndef INET_CONFIG_TUN_MAX_READS_PER_EVENT
+#define INET_CONFIG_TUN_MAX_READS_PER_EVENT                 8
+#endif // INET_CONFIG_TUN_MAX_READS_PER_EVENT
+
 /**
  *  @def INET_CONFIG_NUM_DNS_RESOLVERS
  *
@@ -618,6 +634,133 @@
 #define INET_CONFIG_DNS_ASYNC_MAX_THREAD_COUNT             2
 #endif // INET_CONFIG_DNS_ASYNC_MAX_THREAD_COUNT
 
+/**
+ * @def INET_CONFIG_ENABLE_DNS_CACHE
+ *
+ * @brief Defines whether (1) or not (0) host name resolutions are cached
+ * by the InetLayer.
+ *
+ * @details
+ *  Successful resolutions are kept for the time-to-live of the records
+ *  and failures to find a host are kept for a shorter, negative
+ *  time-to-live. Concurrent requests for the same host name share a
+ *  single lookup. While a lookup made with the platform resolver is in
+ *  progress it uses one additional DNS resolver object, which should be
+ *  accounted for in #INET_CONFIG_NUM_DNS_RESOLVERS.
+ */
+#ifndef INET_CONFIG_ENABLE_DNS_CACHE
+#define INET_CONFIG_ENABLE_DNS_CACHE                       0
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
+/**
+ * @def INET_CONFIG_DNS_CACHE_SIZE
+ *
+ * @brief The number of host names held in the DNS cache, including those
+ * with lookups in progress.
+ */
+#ifndef INET_CONFIG_DNS_CACHE_SIZE
+#define INET_CONFIG_DNS_CACHE_SIZE                         8
+#endif // INET_CONFIG_DNS_CACHE_SIZE
+
+/**
+ * @def INET_CONFIG_DNS_CACHE_MAX_ADDRS
+ *
+ * @brief The maximum number of addresses cached for each host name.
+ */
+#ifndef INET_CONFIG_DNS_CACHE_MAX_ADDRS
+#define INET_CONFIG_DNS_CACHE_MAX_ADDRS                    8
+#endif // INET_CONFIG_DNS_CACHE_MAX_ADDRS
+
+/**
+ * @def INET_CONFIG_DNS_CACHE_DEFAULT_TTL_SECS
+ *
+ * @brief The time, in seconds, for which the results of the platform
+ * resolver are cached.
+ *
+ * @details
+ *  The platform resolvers do not report the time-to-live of the records
+ *  they return, so this value is used in its place.
+ */
+#ifndef INET_CONFIG_DNS_CACHE_DEFAULT_TTL_SECS
+#define INET_CONFIG_DNS_CACHE_DEFAULT_TTL_SECS             60
+#endif // INET_CONFIG_DNS_CACHE_DEFAULT_TTL_SECS
+
+/**
+ * @def INET_CONFIG_DNS_CACHE_MAX_TTL_SECS
+ *
+ * @brief The maximum time, in seconds, for which a resolution is cached,
+ * regardless of the time-to-live of its records.
+ */
+#ifndef INET_CONFIG_DNS_CACHE_MAX_TTL_SECS
+#define INET_CONFIG_DNS_CACHE_MAX_TTL_SECS                 3600
+#endif // INET_CONFIG_DNS_CACHE_MAX_TTL_SECS
+
+/**
+ * @def INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS
+ *
+ * @brief The maximum time, in seconds, for which the failure to find a
+ * host is cached.
+ *
+ * @details
+ *  When a name server supplies the SOA record of the zone, the shorter
+ *  negative time-to-live it implies is used instead (RFC 2308).
+ */
+#ifndef INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS
+#define INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS            30
+#endif // INET_CONFIG_DNS_CACHE_NEGATIVE_TTL_SECS
+
+/**
+ * @def INET_CONFIG_ENABLE_DNS_CLIENT
+ *
+ * @brief Defines whether (1) or not (0) to include a DNS client that
+ * queries name servers directly over UDP.
+ *
+ * @details
+ *  The client is used in place of the platform resolver once name
+ *  servers have been configured with InetLayer::SetDNSServers(). It is
+ *  driven entirely by the events of the system layer, requiring no
+ *  threads, and honors the time-to-live of the records it receives.
+ *  Requires #INET_CONFIG_ENABLE_DNS_CACHE and
+ *  #INET_CONFIG_ENABLE_UDP_ENDPOINT.
+ */
+#ifndef INET_CONFIG_ENABLE_DNS_CLIENT
+#define INET_CONFIG_ENABLE_DNS_CLIENT                      0
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
+/**
+ * @def INET_CONFIG_DNS_CLIENT_MAX_SERVERS
+ *
+ * @brief The maximum number of name servers the DNS client can be
+ * configured with.
+ */
+#ifndef INET_CONFIG_DNS_CLIENT_MAX_SERVERS
+#define INET_CONFIG_DNS_CLIENT_MAX_SERVERS                 3
+#endif // INET_CONFIG_DNS_CLIENT_MAX_SERVERS
+
+/**
+ * @def INET_CONFIG_DNS_CLIENT_TIMEOUT_MSECS
+ *
+ * @brief The time, in milliseconds, the DNS client waits for a name
+ * server to answer before querying the next one.
+ */
+#ifndef INET_CONFIG_DNS_CLIENT_TIMEOUT_MSECS
+#define INET_CONFIG_DNS_CLIENT_TIMEOUT_MSECS               2000
+#endif // INET_CONFIG_DNS_CLIENT_TIMEOUT_MSECS
+
+/**
+ * @def INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS
+ *
+ * @brief The number of times the DNS client sends a query, rotating
+ * through the configured name servers, before giving up.
+ */
+#ifndef INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS
+#define INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS                4
+#endif // INET_CONFIG_DNS_CLIENT_MAX_ATTEMPTS
+
+#if INET_CONFIG_ENABLE_DNS_CLIENT && !(INET_CONFIG_ENABLE_DNS_CACHE && INET_CONFIG_ENABLE_UDP_ENDPOINT)
+#error "REQUIRED: if INET_CONFIG_ENABLE_DNS_CLIENT then INET_CONFIG_ENABLE_DNS_CACHE and INET_CONFIG_ENABLE_UDP_ENDPOINT!"
+#endif
+
 /**
  *  @def INET_CONFIG_OVERRIDE_SYSTEM_TCP_USER_TIMEOUT
  *
@@ -305,6 +305,14 @@ INET_ERROR InetLayer::Init(Weave::System::Layer& aSystemLayer, void *aContext)
 
     State = kState_Initialized;
 
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+    mDNSCache.Init(this);
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+    mDNSClient.Init(this);
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
 #if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
 
@@ -354,11 +362,19 @@ INET_ERROR InetLayer::Shutdown(void)
             }
         }
 
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+        mDNSClient.Shutdown();
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
 
         err = mAsyncDNSResolver.Shutdown();
 
 #endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
+
+#if INET_CONFIG_ENABLE_DNS_CACHE
+        mDNSCache.Shutdown();
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
 #endif // INET_CONFIG_ENABLE_DNS_RESOLVER
 
 #if INET_CONFIG_ENABLE_RAW_ENDPOINT
@@ -883,6 +899,9 @@ INET_ERROR InetLayer::ResolveHostAddress(const char *hostName, uint16_t hostName
     if (resolver != NULL)
     {
         resolver->InitInetLayerBasis(*this);
+#if INET_CONFIG_ENABLE_DNS_CACHE
+        resolver->mCacheEntry = NULL;
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
     }
     else
     {
@@ -918,24 +937,47 @@ INET_ERROR InetLayer::ResolveHostAddress(const char *hostName, uint16_t hostName
     }
 
     // After this point, the resolver will be released by:
+    // - the DNS cache (in case of INET_CONFIG_ENABLE_DNS_CACHE)
     // - mAsyncDNSResolver (in case of ASYNC_DNS_SOCKETS)
     // - resolver->Resolve() (in case of synchronous resolving)
     // - the event handlers (in case of LwIP)
 
+#if INET_CONFIG_ENABLE_DNS_CACHE
+    err = mDNSCache.Resolve(*resolver, hostName, hostNameLen, options, maxAddrs, addrArray, onComplete, appState);
+#else // INET_CONFIG_ENABLE_DNS_CACHE
+    err = StartResolve(*resolver, hostName, hostNameLen, options, maxAddrs, addrArray, onComplete, appState);
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
+exit:
+
+    return err;
+}
+
+/**
+ *  Start the resolution of a host name with the platform resolver, on behalf of a resolver object.
+ *
+ *  The resolver is released once the resolution completes.
+ */
+INET_ERROR InetLayer::StartResolve(DNSResolver &resolver, const char *hostName, uint16_t hostNameLen, uint8_t options,
+                                   uint8_t maxAddrs, IPAddress *addrArray,
+                                   DNSResolveCompleteFunct onComplete, void *appState)
+{
+    INET_ERROR err = INET_NO_ERROR;
+
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
 
-    err = mAsyncDNSResolver.PrepareDNSResolver(*resolver, hostName, hostNameLen, options,
+    err = mAsyncDNSResolver.PrepareDNSResolver(resolver, hostName, hostNameLen, options,
                                                maxAddrs, addrArray, onComplete, appState);
     SuccessOrExit(err);
 
-    mAsyncDNSResolver.EnqueueRequest(*resolver);
+    mAsyncDNSResolver.EnqueueRequest(resolver);
 
+exit:
 #endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS && INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
 
 #if !INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
-    err = resolver->Resolve(hostName, hostNameLen, options, maxAddrs, addrArray, onComplete, appState);
+    err = resolver.Resolve(hostName, hostNameLen, options, maxAddrs, addrArray, onComplete, appState);
 #endif // !INET_CONFIG_ENABLE_ASYNC_DNS_SOCKETS
-exit:
 
     return err;
 }
@@ -997,6 +1039,43 @@ void InetLayer::CancelResolveHostAddress(DNSResolveCompleteFunct onComplete, voi
     }
 }
 
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+/**
+ *  Set the name servers to which DNS queries are sent.
+ *
+ *  Once name servers are set, host names are resolved by querying them directly over UDP, from the Inet layer's
+ *  event loop, rather than with the platform resolver. The results are cached for the time-to-live given by the
+ *  name servers. Setting the name servers discards all cached results; lookups in progress are completed with the
+ *  new servers. Setting no name servers reverts to the platform resolver.
+ *
+ *  @param[in]  numServers      The number of name servers, at most #INET_CONFIG_DNS_CLIENT_MAX_SERVERS. The servers
+ *                              are queried in turn, one at a time, as queries time out.
+ *
+ *  @param[in]  serverAddrs     A pointer to the addresses of the name servers.
+ *
+ *  @param[in]  serverPort      The UDP port of the name servers.
+ *
+ *  @retval #INET_NO_ERROR                  if the name servers were set.
+ *  @retval #INET_ERROR_INCORRECT_STATE     if the Inet layer is not initialized.
+ *  @retval #INET_ERROR_BAD_ARGS            if there are too many name servers, or an address is not an IP address.
+ *
+ */
+INET_ERROR InetLayer::SetDNSServers(uint8_t numServers, const IPAddress *serverAddrs, uint16_t serverPort)
+{
+    INET_ERROR err = INET_NO_ERROR;
+
+    VerifyOrExit(State == kState_Initialized, err = INET_ERROR_INCORRECT_STATE);
+
+    err = mDNSClient.SetServers(numServers, serverAddrs, serverPort);
+    SuccessOrExit(err);
+
+    mDNSCache.Clear();
+
+exit:
+    return err;
+}
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
 #endif // INET_CONFIG_ENABLE_DNS_RESOLVER
 
 #if INET_CONFIG_PROVIDE_OBSOLESCENT_INTERFACES
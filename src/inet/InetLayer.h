@@ -85,6 +85,14 @@
 #include <InetLayer/TunEndPoint.h>
 #endif // INET_CONFIG_ENABLE_TUN_ENDPOINT
 
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+#include <InetLayer/DNSCache.h>
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+#include <InetLayer/DNSClient.h>
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+
 #if INET_CONFIG_PROVIDE_OBSOLESCENT_INTERFACES
 #include <InetLayer/InetBuffer.h>
 #endif // INET_CONFIG_PROVIDE_OBSOLESCENT_INTERFACES
@@ -164,6 +172,14 @@ class NL_DLL_EXPORT InetLayer
     friend class DNSResolver;
 #endif // INET_CONFIG_ENABLE_DNS_RESOLVER
 
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+    friend class DNSCache;
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CACHE
+
+#if INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+    friend class DNSClient;
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER && INET_CONFIG_ENABLE_DNS_CLIENT
+
 #if INET_CONFIG_ENABLE_RAW_ENDPOINT
     friend class RawEndPoint;
 #endif // INET_CONFIG_ENABLE_RAW_ENDPOINT
@@ -243,6 +259,10 @@ class NL_DLL_EXPORT InetLayer
             DNSResolveCompleteFunct onComplete, void *appState);
     void CancelResolveHostAddress(DNSResolveCompleteFunct onComplete, void *appState);
 
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+    INET_ERROR SetDNSServers(uint8_t numServers, const IPAddress *serverAddrs, uint16_t serverPort = 53);
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
 #endif // INET_CONFIG_ENABLE_DNS_RESOLVER
 
     INET_ERROR GetInterfaceFromAddr(const IPAddress& addr, InterfaceId& intfId);
@@ -375,6 +395,20 @@ private:
 
 #endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
 
+#if INET_CONFIG_ENABLE_DNS_RESOLVER
+#if INET_CONFIG_ENABLE_DNS_CACHE
+    DNSCache                mDNSCache;
+#endif // INET_CONFIG_ENABLE_DNS_CACHE
+
+#if INET_CONFIG_ENABLE_DNS_CLIENT
+    DNSClient               mDNSClient;
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT
+
+    INET_ERROR StartResolve(DNSResolver &resolver, const char *hostName, uint16_t hostNameLen, uint8_t options,
+            uint8_t maxAddrs, IPAddress *addrArray,
+            DNSResolveCompleteFunct onComplete, void *appState);
+#endif // INET_CONFIG_ENABLE_DNS_RESOLVER
+
     friend INET_ERROR Platform::InetLayer::WillInit(Inet::InetLayer *aLayer, void *aContext);
     friend void       Platform::InetLayer::DidInit(Inet::InetLayer *aLayer, void *aContext, INET_ERROR anError);
 
@@ -62,6 +62,39 @@ using namespace nl::Weave::Encoding;
 void TunEndPoint::Init(InetLayer *inetLayer)
 {
     InitEndPointBasis(*inetLayer);
+
+    mReceiveEnabled = true;
+}
+
+/**
+ * Stop reading packets from the tunnel device.
+ *
+ * While reception is disabled, outbound packets routed to the tunnel
+ * interface are left in the device queue of the host stack.
+ */
+void TunEndPoint::DisableReceive(void)
+{
+    mReceiveEnabled = false;
+}
+
+/**
+ * Resume reading packets from the tunnel device.
+ */
+void TunEndPoint::EnableReceive(void)
+{
+    if (mReceiveEnabled)
+        return;
+
+    mReceiveEnabled = true;
+
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+    if (mState == kState_Open && mSocket >= 0)
+    {
+        // Wake the thread calling select so that it can include the socket
+        // in the select read fd_set.
+        SystemLayer().WakeSelect();
+    }
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
 }
 
 /**
@@ -670,6 +703,13 @@ INET_ERROR TunEndPoint::TunDevOpen (const char *intfName)
     //Keep copy of open device fd
     mSocket = fd;
 
+    // Make reads non-blocking so that queued packets can be drained in a
+    // burst without blocking once the device is empty.
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) < 0)
+    {
+        ExitNow(ret = Weave::System::MapErrorPOSIX(errno));
+    }
+
     memset(&ifr, 0, sizeof(ifr));
 
     ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
@@ -728,7 +768,7 @@ int TunEndPoint::TunGetInterface (int fd,
     return ioctl(fd, TUNGETIFF, (void*)ifr);
 }
 
-/* Read packets from TUN device in Linux */
+/* Read packets from TUN device in Linux; an empty buffer means no packet was pending */
 INET_ERROR TunEndPoint::TunDevRead (PacketBuffer *msg)
 {
     ssize_t rcvLen;
@@ -739,7 +779,14 @@ INET_ERROR TunEndPoint::TunDevRead (PacketBuffer *msg)
     rcvLen = read(mSocket, p, msg->AvailableDataLength());
     if (rcvLen < 0)
     {
-        err = Weave::System::MapErrorPOSIX(errno);
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            msg->SetDataLength(0);
+        }
+        else
+        {
+            err = Weave::System::MapErrorPOSIX(errno);
+        }
     }
     else if (rcvLen > msg->AvailableDataLength())
     {
@@ -758,7 +805,7 @@ SocketEvents TunEndPoint::PrepareIO ()
 {
     SocketEvents res;
 
-    if (mState == kState_Open && OnPacketReceived != NULL)
+    if (mState == kState_Open && OnPacketReceived != NULL && mReceiveEnabled)
     {
         res.SetRead();
     }
@@ -766,45 +813,63 @@ SocketEvents TunEndPoint::PrepareIO ()
     return res;
 }
 
-/* Read from the Tun device in Linux and pass up to upper layer callback */
+/* Read a burst of packets from the Tun device in Linux and pass each up to upper layer callback */
 void TunEndPoint::HandlePendingIO ()
 {
     INET_ERROR err = INET_NO_ERROR;
 
-    if (mState == kState_Open && OnPacketReceived != NULL && mPendingIO.IsReadable())
+    // Prevent the end point from being freed while in the middle of a callback.
+    Retain();
+
+    if (mPendingIO.IsReadable())
     {
+        // The callback may disable reception or close the endpoint, so
+        // check the state again before every read.
+        for (int i = 0; i < INET_CONFIG_TUN_MAX_READS_PER_EVENT &&
+                        mState == kState_Open && OnPacketReceived != NULL && mReceiveEnabled; i++)
+        {
+            PacketBuffer *buf = PacketBuffer::New(0);
 
-        PacketBuffer *buf = PacketBuffer::New(0);
+            if (buf != NULL)
+            {
+                //Read data from Tun Device
+                err = TunDevRead(buf);
+                if (err == INET_NO_ERROR && buf->DataLength() == 0)
+                {
+                    // Device queue drained.
+                    PacketBuffer::Free(buf);
+                    break;
+                }
+                if (err == INET_NO_ERROR)
+                {
+                    err = CheckV6Sanity(buf);
+                }
+            }
+            else
+            {
+                err = INET_ERROR_NO_MEMORY;
+            }
 
-        if (buf != NULL)
-        {
-            //Read data from Tun Device
-            err = TunDevRead(buf);
             if (err == INET_NO_ERROR)
             {
-                err = CheckV6Sanity(buf);
+                OnPacketReceived(this, buf);
             }
-        }
-        else
-        {
-            err = INET_ERROR_NO_MEMORY;
-        }
-
-        if (err == INET_NO_ERROR)
-        {
-            OnPacketReceived(this, buf);
-        }
-        else
-        {
-            PacketBuffer::Free(buf);
-            if (OnReceiveError != NULL)
+            else
             {
-                OnReceiveError(this, err);
+                PacketBuffer::Free(buf);
+                if (OnReceiveError != NULL)
+                {
+                    OnReceiveError(this, err);
+                }
+
+                break;
             }
         }
     }
 
     mPendingIO.Clear();
+
+    Release();
 }
 
 #endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
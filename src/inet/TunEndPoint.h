@@ -181,6 +181,28 @@ public:
 
     InterfaceId GetTunnelInterfaceId(void);
 
+    /**
+     * @brief   Disable reception.
+     *
+     * @details
+     *  Stop reading packets from the tunnel device so that the kernel
+     *  queues (and eventually drops) them while a higher layer cannot
+     *  keep up. On LwIP, packets are delivered to the receive handler
+     *  regardless.
+     */
+    void DisableReceive(void);
+
+    /**
+     * @brief   Enable reception.
+     *
+     * @details
+     *  Resume reading packets from the tunnel device.
+     */
+    void EnableReceive(void);
+
+    /** Returns true if packets are being read from the tunnel device. */
+    bool IsReceiveEnabled(void) const { return mReceiveEnabled; }
+
 private:
 
     TunEndPoint(void);                                  // not defined
@@ -192,6 +214,8 @@ private:
     /** Close the tunnel. */
     void Close(void);
 
+    bool mReceiveEnabled;
+
     // Function that performs some sanity tests for IPv6 packets.
     INET_ERROR CheckV6Sanity(Weave::System::PacketBuffer *message);
     // Function for sending the IPv6 packets over Linux sockets or LwIP.
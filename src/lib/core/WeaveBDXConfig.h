@@ -145,6 +145,154 @@
 #define WEAVE_CONFIG_BDX_SEND_INIT_MAX_METADATA_BYTES 64
 #endif // WEAVE_CONFIG_BDX_SEND_INIT_MAX_METADATA_BYTES
 
+/**
+ *  @def WEAVE_CONFIG_BDX_WINDOW_SIZE
+ *
+ *  @brief
+ *      Maximum number of blocks a V1 sender-drive transfer may have
+ *      outstanding at once.
+ *
+ *  When greater than 1, BDX offers a windowed transfer mode in its
+ *      Init and Accept messages.  If both nodes support it, the sender
+ *      keeps up to this many blocks in flight, the receiver answers
+ *      with cumulative and selective BlockWindowAckV1 messages and only
+ *      the missing blocks are retransmitted.  Each transfer holds one
+ *      PacketBuffer per outstanding block.  Set to 0 to compile out the
+ *      windowed mode and use stop-and-wait transfers only.
+ */
+#ifndef WEAVE_CONFIG_BDX_WINDOW_SIZE
+#define WEAVE_CONFIG_BDX_WINDOW_SIZE 0
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE
+
+/**
+ *  @def WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC
+ *
+ *  @brief
+ *      Lower bound on the time a windowed sender waits for an
+ *      acknowledgement before retransmitting the oldest outstanding block.
+ *
+ *  The actual timeout is twice the smoothed round trip time measured
+ *      for the transfer, but never less than this value.
+ */
+#ifndef WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC
+#define WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC 500
+#endif // WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC
+
+/**
+ *  @def WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS
+ *
+ *  @brief
+ *      Number of consecutive retransmission timeouts after which a
+ *      windowed sender gives up and reports WEAVE_ERROR_TIMEOUT.
+ */
+#ifndef WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS
+#define WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS 8
+#endif // WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS
+
+/**
+ *  @def WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC
+ *
+ *  @brief
+ *      Default global byte-rate budget shared by all transfers of a BdxNode.
+ *
+ *  When non-zero, every block step (sending a block, or the query or
+ *      acknowledgement that lets the peer send one) waits for the budget
+ *      and waiting transfers are served fairly per peer node, so a single
+ *      fast peer cannot starve the others.  Set to 0 to run every transfer
+ *      as fast as its peer allows.  Can be changed at runtime with
+ *      BdxNode::SetMaxByteRate().
+ */
+#ifndef WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC
+#define WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC 0
+#endif // WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC
+
+/**
+ *  @def WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC
+ *
+ *  @brief
+ *      Shortest interval at which a rate-limited BdxNode services the
+ *      transfers waiting for its byte-rate budget.
+ */
+#ifndef WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC
+#define WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC 10
+#endif // WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC
+
+/**
+ *  @def WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES
+ *
+ *  @brief
+ *      Memory budget, in bytes of block data, shared by all transfers of a
+ *      BdxNode.
+ *
+ *  A transfer reserves its max block size times the number of blocks it
+ *      may hold (its window, or 1) when it is initiated or accepted.
+ *      Windows are shrunk to fit the remaining budget and transfers that
+ *      cannot fit a single block are refused.  This bounds memory use
+ *      independently of WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS, which can then
+ *      be sized for many small transfers.  Set to 0 for no budget.
+ */
+#ifndef WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES
+#define WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES 0
+#endif // WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES
+
+/**
+ *  @def WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+ *
+ *  @brief
+ *      Compile support for resumable downloads.
+ *
+ *  When enabled, a transfer initiated with BdxNode::InitBdxReceive() and
+ *      mIsResumable set persists its progress (a hash of the file
+ *      designator, the offset received so far and a CRC-32 of the data)
+ *      through the Platform::PersistedStorage API.  A later download of the
+ *      same file designator asks the sender to start at the persisted
+ *      offset and continues the CRC, so the complete image can be checked
+ *      without reading it again.  Requires the platform to implement
+ *      Platform::PersistedStorage.  Disabled by default.
+ */
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+#define WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT 0
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+/**
+ *  @def WEAVE_CONFIG_BDX_CHECKPOINT_INTERVAL_BYTES
+ *
+ *  @brief
+ *      Number of bytes a resumable download receives between two
+ *      checkpoints.  Progress is also persisted when the transfer fails.
+ */
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_INTERVAL_BYTES
+#define WEAVE_CONFIG_BDX_CHECKPOINT_INTERVAL_BYTES (64 * 1024)
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_INTERVAL_BYTES
+
+/**
+ *  @def WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID
+ *
+ *  @brief
+ *      Persisted storage keys of the BDX checkpoint: the file designator
+ *      hash (0 when there is no checkpoint), the offset as two 32-bit
+ *      halves and the CRC-32 of the data received so far.
+ */
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID
+#define WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID "BdxCkptId"
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID
+
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_LO
+#define WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_LO "BdxCkptOffLo"
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_LO
+
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_HI
+#define WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_HI "BdxCkptOffHi"
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_HI
+
+#ifndef WEAVE_CONFIG_BDX_CHECKPOINT_KEY_CRC
+#define WEAVE_CONFIG_BDX_CHECKPOINT_KEY_CRC "BdxCkptCrc"
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_KEY_CRC
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 32
+#error "WEAVE_CONFIG_BDX_WINDOW_SIZE cannot exceed the 32 blocks covered by a BlockWindowAckV1"
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 32
+
 
 #if (WEAVE_CONFIG_BDX_CLIENT_SEND_SUPPORT == 0) && (WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT == 0)
 #error "At least one of WEAVE_CONFIG_BDX_CLIENT_SEND_SUPPORT or WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT must be enabled"
@@ -374,6 +374,26 @@ void Binding::DoReset(State newState)
 
 #endif
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+    // Give up the binding's use of a pooled connection, which it may already have taken up before
+    // becoming ready, while delivering the ConnectionEstablished event.  If the binding was still
+    // establishing the connection on behalf of the pool, any bindings waiting for it will try again.
+    if (GetFlag(kFlag_ConnectionPooled))
+    {
+        if (mCon != NULL)
+        {
+            mExchangeManager->ReleasePooledConnection(mCon);
+        }
+        if (origState != kState_Ready)
+        {
+            mExchangeManager->AbandonPooledConnection(*this);
+        }
+        ClearFlag(kFlag_ConnectionPooled);
+    }
+
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
     // Release the reference to the connection object, if held.  Block any callback to our
     // connection complete handler that may result from releasing the connection.
     if (GetFlag(kFlag_ConnectionReferenced))
@@ -657,6 +677,15 @@ void Binding::PrepareTransport()
     // If the application has requested TCP, and no existing connection has been supplied...
     if (mTransportOption == kTransport_TCP && mCon == NULL)
     {
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+        // Share an established connection to the peer from the exchange manager's pool, or wait
+        // for one that is being established, if possible.
+        if (PreparePooledTransport())
+        {
+            ExitNow();
+        }
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
         // Construct a new WeaveConnection object.  This method implicitly establishes a reference
         // to the connection object, which will be owned by the Binding until it is closed or fails.
         mCon = mExchangeManager->MessageLayer->NewConnection();
@@ -868,6 +897,134 @@ exit:
     }
 }
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+/**
+ * Determine whether the binding can share a connection from the exchange manager's connection pool.
+ *
+ * Only bindings that make their own TCP connection to a specific peer node, with no security or with
+ * a CASE session, take part.  Shared CASE sessions are established with a router rather than with the
+ * peer, and PASE and TAKE sessions depend on parameters supplied by the application each time the
+ * binding is prepared, so bindings using them always establish their own connection.
+ */
+bool Binding::CanUsePooledConnection(void) const
+{
+    return (mTransportOption == kTransport_TCP && mCon == NULL &&
+            mPeerNodeId != kNodeIdNotSpecified && mPeerNodeId != kAnyNodeId &&
+            (mSecurityOption == kSecurityOption_None || mSecurityOption == kSecurityOption_CASESession));
+}
+
+/**
+ * Prepare the transport of the binding from the exchange manager's connection pool.
+ *
+ * If an established connection to the peer is pooled, the binding is made ready to use it.  If one is
+ * being established by another binding, this binding waits for it, and the exchange manager completes
+ * its preparation once the connection is ready.  Otherwise the binding establishes its connection on
+ * behalf of the pool, if there is room in the pool.
+ *
+ * @return true if the binding is using or waiting for a pooled connection, or false if it must
+ *         establish a connection itself.
+ */
+bool Binding::PreparePooledTransport(void)
+{
+    WeaveExchangeManager::PooledConnection *entry;
+    bool usingPool = false;
+
+    VerifyOrExit(CanUsePooledConnection(), /* no-op */);
+
+    SetFlag(kFlag_ConnectionPooled);
+
+    entry = mExchangeManager->FindPooledConnection(*this);
+    if (entry == NULL)
+    {
+        mExchangeManager->mBindingConnectionPoolStats.Misses++;
+
+        // If the pool is full of connections in use, the binding establishes a connection of its own.
+        if (mExchangeManager->NewPooledConnection(*this) == NULL)
+        {
+            ClearFlag(kFlag_ConnectionPooled);
+        }
+
+        ExitNow();
+    }
+
+    mExchangeManager->mBindingConnectionPoolStats.Hits++;
+    usingPool = true;
+
+    if (entry->State == WeaveExchangeManager::PooledConnection::kState_Established)
+    {
+        entry->UserCount++;
+        UsePooledConnection(entry->Con, entry->KeyId, entry->EncType);
+    }
+    else
+    {
+        WeaveLogDetail(ExchangeManager, "Binding[%" PRIu8 "] (%" PRIu16 "): Waiting for pooled con",
+                GetLogId(), mRefCount);
+
+        mState = kState_PreparingTransport_TCPConnect;
+    }
+
+exit:
+    return usingPool;
+}
+
+/**
+ * Complete the preparation of the binding using an established connection from the connection pool,
+ * along with the session key that authenticates it.
+ */
+void Binding::UsePooledConnection(WeaveConnection *con, uint32_t keyId, uint8_t encType)
+{
+    WeaveLogDetail(ExchangeManager, "Binding[%" PRIu8 "] (%" PRIu16 "): Using pooled con (%04" PRIX16 ")",
+            GetLogId(), mRefCount, con->LogId());
+
+    // Take a reference to the connection, to be released when the binding closes.
+    mCon = con;
+    mCon->AddRef();
+    SetFlag(kFlag_ConnectionReferenced);
+
+    mState = kState_PreparingTransport_TCPConnect;
+
+    // Deliver a ConnectionEstablished API event to the application, as for a connection established by the
+    // binding itself, giving the application the same opportunity to adjust the configuration of the connection.
+    {
+        InEventParam inParam;
+        OutEventParam outParam;
+        inParam.Clear();
+        inParam.Source = this;
+        outParam.Clear();
+        mAppEventCallback(AppState, kEvent_ConnectionEstablished, inParam, outParam);
+    }
+
+    // Stop if the application closed or reset the binding in response to the event.
+    VerifyOrExit(mState == kState_PreparingTransport_TCPConnect, /* no-op */);
+
+    mState = kState_PreparingSecurity;
+
+    // Add a reservation on the session key, to be released when the binding closes.
+    if (mSecurityOption != kSecurityOption_None)
+    {
+        mKeyId = keyId;
+        mEncType = encType;
+        mExchangeManager->MessageLayer->SecurityMgr->ReserveKey(mPeerNodeId, mKeyId);
+        SetFlag(kFlag_KeyReserved);
+    }
+
+    HandleBindingReady();
+
+exit:
+    return;
+}
+
+/**
+ * Determine whether the binding is waiting for a pooled connection being established by another binding.
+ */
+bool Binding::IsWaitingForPooledConnection(void) const
+{
+    return GetFlag(kFlag_ConnectionPooled) && mState == kState_PreparingTransport_TCPConnect && mCon == NULL;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
 /**
  * Transition the Binding to the Ready state.
  */
@@ -882,6 +1039,14 @@ void Binding::HandleBindingReady()
     // Transition to the Ready state.
     mState = kState_Ready;
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    // If the binding established its connection on behalf of the pool, share it with other bindings.
+    if (GetFlag(kFlag_ConnectionPooled))
+    {
+        mExchangeManager->PublishPooledConnection(*this);
+    }
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
 #if WEAVE_DETAIL_LOGGING
     {
         char peerDesc[kGetPeerDescription_MaxLength];
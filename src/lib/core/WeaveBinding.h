@@ -268,6 +268,7 @@ private:
     {
         kFlag_KeyReserved                           = 0x1,
         kFlag_ConnectionReferenced                  = 0x2,
+        kFlag_ConnectionPooled                      = 0x4,
     };
 
     WeaveExchangeManager * mExchangeManager;
@@ -321,6 +322,12 @@ private:
     void PrepareAddress(void);
     void PrepareTransport(void);
     void PrepareSecurity(void);
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    bool CanUsePooledConnection(void) const;
+    bool PreparePooledTransport(void);
+    void UsePooledConnection(WeaveConnection *con, uint32_t keyId, uint8_t encType);
+    bool IsWaitingForPooledConnection(void) const;
+#endif
     void HandleBindingReady(void);
     void HandleBindingFailed(WEAVE_ERROR err, Profiles::StatusReporting::StatusReport *statusReport, bool raiseEvent);
     void OnKeyFailed(uint64_t peerNodeId, uint32_t keyId, WEAVE_ERROR keyErr);
@@ -1282,6 +1282,51 @@
 #define WEAVE_CONFIG_MAX_BINDINGS                           6
 #endif // WEAVE_CONFIG_MAX_BINDINGS
 
+/**
+ *  @def WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+ *
+ *  @brief
+ *    Enable sharing of TCP connections between bindings.
+ *
+ *    When enabled, a binding configured for TCP, with no security or
+ *    a CASE session, and with a specific peer node id, reuses an
+ *    established and authenticated connection to the same peer, with
+ *    the same security settings, in place of opening its own
+ *    connection and running its own handshake.  Exchanges of all the
+ *    bindings are multiplexed over the shared connection, which is
+ *    closed once it has not been used by any binding for
+ *    #WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS.  Each
+ *    binding still receives the ConnectionEstablished event when it
+ *    takes up the shared connection.
+ */
+#ifndef WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+#define WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL         0
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+/**
+ *  @def WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE
+ *
+ *  @brief
+ *    Maximum number of shared binding connections per
+ *    WeaveExchangeManager.  When the pool is full, the connection
+ *    that has been idle the longest is closed to make room; if none
+ *    is idle, the new connection is not shared.
+ */
+#ifndef WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE
+#define WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE           2
+#endif // WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE
+
+/**
+ *  @def WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS
+ *
+ *  @brief
+ *    Time, in milliseconds, that a shared binding connection is kept
+ *    open after the last binding using it has closed.
+ */
+#ifndef WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS
+#define WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS 30000
+#endif // WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS
+
 /**
  *  @def WEAVE_CONFIG_CONNECT_IP_ADDRS
  *
@@ -1425,6 +1470,68 @@
 #define WEAVE_CONFIG_RESOLVE_IPADDR_LITERAL                 (WEAVE_SYSTEM_CONFIG_USE_SOCKETS)
 #endif // WEAVE_CONFIG_RESOLVE_IPADDR_LITERAL
 
+/**
+ *  @def WEAVE_CONFIG_CONNECT_RACING
+ *
+ *  @brief
+ *    Enable racing outbound connections across the addresses of a
+ *    peer, in the manner of RFC 8305 "Happy Eyeballs".
+ *
+ *    When enabled, a connection to a host name (or a host/port list)
+ *    starts a TCP connect to the most promising resolved address and,
+ *    if that has not completed after
+ *    #WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS, starts another to the
+ *    next address while the first continues. The first attempt to
+ *    succeed is used and the others are abandoned. Addresses are
+ *    ordered by how previous connections to them fared.
+ *
+ *    When disabled, addresses are tried one after the other, each
+ *    until it succeeds or times out.
+ *
+ *    Racing requires #WEAVE_CONFIG_ENABLE_DNS_RESOLVER.
+ */
+#ifndef WEAVE_CONFIG_CONNECT_RACING
+#define WEAVE_CONFIG_CONNECT_RACING                         0
+#endif // WEAVE_CONFIG_CONNECT_RACING
+
+/**
+ *  @def WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS
+ *
+ *  @brief
+ *    Maximum number of TCP connect attempts a single connection races
+ *    at once. Each attempt holds a TCP end point until it completes.
+ */
+#ifndef WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS
+#define WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS            2
+#endif // WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS
+
+/**
+ *  @def WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS
+ *
+ *  @brief
+ *    Time, in milliseconds, a racing connect attempt is given before
+ *    the next one is started alongside it. A failed attempt starts the
+ *    next one immediately.
+ */
+#ifndef WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS
+#define WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS            250
+#endif // WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS
+
+/**
+ *  @def WEAVE_CONFIG_CONNECT_HISTORY_SIZE
+ *
+ *  @brief
+ *    Number of destination address/port pairs whose recent connect
+ *    outcomes and latency are remembered to order racing attempts.
+ */
+#ifndef WEAVE_CONFIG_CONNECT_HISTORY_SIZE
+#define WEAVE_CONFIG_CONNECT_HISTORY_SIZE                   8
+#endif // WEAVE_CONFIG_CONNECT_HISTORY_SIZE
+
+#if WEAVE_CONFIG_CONNECT_RACING && !WEAVE_CONFIG_ENABLE_DNS_RESOLVER
+#error "WEAVE_CONFIG_CONNECT_RACING requires WEAVE_CONFIG_ENABLE_DNS_RESOLVER"
+#endif
+
 /**
  *  @def WEAVE_CONFIG_ENABLE_TARGETED_LISTEN
  *
@@ -1917,6 +2024,55 @@
 #define WEAVE_CONFIG_SERVICE_DIR_CONNECT_TIMEOUT_MSECS      (10000)
 #endif // WEAVE_CONFIG_SERVICE_DIR_CONNECT_TIMEOUT_MSECS
 
+/**
+ *  @def WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+ *
+ *  @brief
+ *    The number of seconds a resolved service directory remains
+ *    usable before it must be fetched from the directory server
+ *    again. A value of (0), the default, keeps the resolved
+ *    directory until it is explicitly invalidated.
+ *
+ */
+#ifndef WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+#define WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS             (0)
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+/**
+ *  @def WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS
+ *
+ *  @brief
+ *    The number of seconds before the resolved service directory
+ *    expires at which it is refreshed in the background. Connect
+ *    requests keep using the cached directory while the refresh
+ *    is in progress.
+ *
+ */
+#ifndef WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS
+#define WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS   (60)
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS
+
+/**
+ *  @def WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE
+ *
+ *  @brief
+ *    The number of slots in the hash index over the cached service
+ *    directory, which must be a power of two. Directories with more
+ *    than half this many entries are searched linearly instead.
+ *
+ */
+#ifndef WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE
+#define WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE                 (32)
+#endif // WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE
+
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS != 0 && WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS >= WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+#error "WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS must be less than WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS"
+#endif
+
+#if (WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE & (WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE - 1)) != 0 || WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE > 256
+#error "WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE must be a power of two no larger than 256"
+#endif
+
 /**
  *  @def WEAVE_CONFIG_DEFAULT_INCOMING_CONNECTION_IDLE_TIMEOUT
  *
@@ -406,6 +406,9 @@ WEAVE_ERROR WeaveConnection::Connect(uint64_t peerNodeId, WeaveAuthMode authMode
 
 #if WEAVE_CONFIG_ENABLE_DNS_RESOLVER
     // Initiate the host name resolution.
+#if WEAVE_CONFIG_CONNECT_RACING
+    mPeerAddrsPort = PeerPort;
+#endif
     State = kState_Resolving;
     err = MessageLayer->Inet->ResolveHostAddress(hostName, hostNameLen, dnsOptions, WEAVE_CONFIG_CONNECT_IP_ADDRS, mPeerAddrs, HandleResolveComplete, this);
 #else // !WEAVE_CONFIG_ENABLE_DNS_RESOLVER
@@ -1094,6 +1097,11 @@ void WeaveConnection::DoClose(WEAVE_ERROR err, uint8_t flags)
                 mTcpEndPoint = NULL;
             }
 
+#if WEAVE_CONFIG_CONNECT_RACING
+            // Abandon any connect attempts still racing.
+            AbortConnectAttempts();
+#endif
+
 #if WEAVE_CONFIG_ENABLE_DNS_RESOLVER
             // Cancel any outstanding DNS query that may still be active.  (This situation can
             // arise if the application initiates a connection to a peer using a DNS name and
@@ -1147,6 +1155,10 @@ void WeaveConnection::HandleResolveComplete(void *appState, INET_ERROR dnsRes, u
 
     WeaveLogProgress(MessageLayer, "Con DNS complete %04X %ld", con->LogId(), (long)dnsRes);
 
+#if WEAVE_CONFIG_CONNECT_RACING
+    ClearFlag(con->mFlags, kFlag_ResolvePending);
+#endif
+
     // Attempt to connect to the first resolved address (if any).
     con->TryNextPeerAddress(dnsRes);
 }
@@ -1155,6 +1167,67 @@ WEAVE_ERROR WeaveConnection::TryNextPeerAddress(WEAVE_ERROR lastErr)
 {
     WEAVE_ERROR err = lastErr; // If there are no more addresses to try, lastErr will become the error returned to the user.
 
+#if WEAVE_CONFIG_CONNECT_RACING
+    int i;
+
+    // While there is room for another attempt, race the most promising address not tried yet...
+    while (GetFreeConnectAttempt() != NULL && (i = SelectNextPeerAddress()) >= 0)
+    {
+        // Select the address, removing it from the list so it won't get tried again.
+        PeerAddr = mPeerAddrs[i];
+        PeerPort = mPeerAddrsPort;
+        mPeerAddrs[i] = IPAddress::Any;
+
+        // Initiate a connection to the new address.
+        err = StartConnect();
+
+        if (err == WEAVE_NO_ERROR)
+        {
+            // Give the attempt a head start before another is raced alongside it. (The attempt may already have
+            // completed if the connect finished immediately.)
+            if (HasConnectAttempts())
+                MessageLayer->SystemLayer->StartTimer(WEAVE_CONFIG_CONNECT_ATTEMPT_DELAY_MSECS, HandleConnectAttemptDelay, this);
+            ExitNow();
+        }
+
+        // If the attempts in progress hold all the available end points, put the address back to be tried when
+        // one of them fails.
+        if (err == INET_ERROR_NO_ENDPOINTS && HasConnectAttempts())
+        {
+            mPeerAddrs[i] = PeerAddr;
+            break;
+        }
+    }
+
+    // Once all the addresses of the current host have been tried, and if there are additional entries in the
+    // host/port list, resolve the next host while any remaining attempts continue.
+    if (GetFreeConnectAttempt() != NULL && SelectNextPeerAddress() < 0 && !GetFlag(mFlags, kFlag_ResolvePending) &&
+        !mPeerHostPortList.IsEmpty())
+    {
+        char hostName[256]; // Per spec, max DNS name length is 253.
+
+        // Pop the next host/port pair from the list.
+        err = mPeerHostPortList.Pop(hostName, sizeof(hostName), mPeerAddrsPort);
+        SuccessOrExit(err);
+
+        WeaveLogProgress(MessageLayer, "Con DNS start %04" PRIX16 " %s %02" PRIX8, LogId(), hostName, mDNSOptions);
+        if (!HasConnectAttempts())
+            State = kState_Resolving;
+        SetFlag(mFlags, kFlag_ResolvePending);
+        err = MessageLayer->Inet->ResolveHostAddress(hostName, strlen(hostName), mDNSOptions,
+                                                     WEAVE_CONFIG_CONNECT_IP_ADDRS,
+                                                     mPeerAddrs, HandleResolveComplete, this);
+        if (err == WEAVE_NO_ERROR)
+            ExitNow();
+        ClearFlag(mFlags, kFlag_ResolvePending);
+    }
+
+    // The connection only fails once every attempt has failed.
+    if (HasConnectAttempts() || GetFlag(mFlags, kFlag_ResolvePending))
+        err = WEAVE_NO_ERROR;
+
+#else // !WEAVE_CONFIG_CONNECT_RACING
+
     // Search the list of peer addresses for one we haven't tried yet...
     for (int i = 0; i < WEAVE_CONFIG_CONNECT_IP_ADDRS; i++)
         if (mPeerAddrs[i] != IPAddress::Any)
@@ -1196,6 +1269,8 @@ WEAVE_ERROR WeaveConnection::TryNextPeerAddress(WEAVE_ERROR lastErr)
 #endif // !WEAVE_CONFIG_ENABLE_DNS_RESOLVER
     }
 
+#endif // !WEAVE_CONFIG_CONNECT_RACING
+
 exit:
     // Enter the closed state if an error occurred.
     if (err != WEAVE_NO_ERROR)
@@ -1204,6 +1279,100 @@ exit:
     return err;
 }
 
+#if WEAVE_CONFIG_CONNECT_RACING
+
+WeaveConnection::ConnectAttempt *WeaveConnection::GetFreeConnectAttempt(void)
+{
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+        if (mConnectAttempts[i].EndPoint == NULL)
+            return &mConnectAttempts[i];
+
+    return NULL;
+}
+
+bool WeaveConnection::HasConnectAttempts(void) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+        if (mConnectAttempts[i].EndPoint != NULL)
+            return true;
+
+    return false;
+}
+
+// Abandon all racing connect attempts, along with any pending name resolution for further attempts.
+void WeaveConnection::AbortConnectAttempts(void)
+{
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+    {
+        TCPEndPoint *endPoint = mConnectAttempts[i].EndPoint;
+
+        if (endPoint != NULL)
+        {
+            mConnectAttempts[i].EndPoint = NULL;
+            endPoint->Abort();
+            endPoint->Free();
+        }
+    }
+
+    MessageLayer->SystemLayer->CancelTimer(HandleConnectAttemptDelay, this);
+
+    if (GetFlag(mFlags, kFlag_ResolvePending))
+    {
+        MessageLayer->Inet->CancelResolveHostAddress(HandleResolveComplete, this);
+        ClearFlag(mFlags, kFlag_ResolvePending);
+    }
+}
+
+// Choose the untried peer address to race next, or return -1 if there is none.
+//
+// Addresses are ordered by how recent connects to them fared. Between addresses that rank the same, the address
+// family alternates from one attempt to the next, starting with IPv6, so that a broken IPv4 or IPv6 path costs
+// at most one attempt delay (RFC 8305, section 4).
+int WeaveConnection::SelectNextPeerAddress(void) const
+{
+    int next = -1;
+    uint32_t nextRank = 0;
+#if INET_CONFIG_ENABLE_IPV4
+    const bool lastWasIPv4 = (PeerAddr == IPAddress::Any) || PeerAddr.IsIPv4();
+#endif
+
+    // The address list belongs to the resolver until name resolution completes.
+    if (GetFlag(mFlags, kFlag_ResolvePending))
+        return -1;
+
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_IP_ADDRS; i++)
+    {
+        if (mPeerAddrs[i] == IPAddress::Any)
+            continue;
+
+        uint32_t rank = MessageLayer->ConnectHistory.GetRank(mPeerAddrs[i], mPeerAddrsPort) << 1;
+
+#if INET_CONFIG_ENABLE_IPV4
+        if (mPeerAddrs[i].IsIPv4() == lastWasIPv4)
+            rank |= 1;
+#endif
+
+        if (next < 0 || rank < nextRank)
+        {
+            next = i;
+            nextRank = rank;
+        }
+    }
+
+    return next;
+}
+
+void WeaveConnection::HandleConnectAttemptDelay(System::Layer *systemLayer, void *appState, System::Error err)
+{
+    WeaveConnection *con = (WeaveConnection *)appState;
+
+    // Race another attempt alongside those still in progress.
+    if (con->State == kState_Connecting && con->HasConnectAttempts())
+        con->TryNextPeerAddress(WEAVE_NO_ERROR);
+}
+
+#endif // WEAVE_CONFIG_CONNECT_RACING
+
 void WeaveConnection::StartSession()
 {
     // If the application requested authentication
@@ -1246,18 +1415,33 @@ void WeaveConnection::StartSession()
 WEAVE_ERROR WeaveConnection::StartConnect()
 {
     WEAVE_ERROR err;
+    TCPEndPoint *endPoint = NULL;
+#if WEAVE_CONFIG_CONNECT_RACING
+    ConnectAttempt *attempt = GetFreeConnectAttempt();
+
+    VerifyOrExit(attempt != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+#endif
 
     // TODO: this is wrong. PeerNodeId should only be set once we have a successful connection (including security).
 
     // Determine the peer address/node identifier based on the information given by the caller.
     err = MessageLayer->SelectDestNodeIdAndAddress(PeerNodeId, PeerAddr);
-    if (err != WEAVE_NO_ERROR)
-        return err;
+    SuccessOrExit(err);
 
     // Allocate a new TCP end point.
-    err = MessageLayer->Inet->NewTCPEndPoint(&mTcpEndPoint);
-    if (err != WEAVE_NO_ERROR)
-        return err;
+    err = MessageLayer->Inet->NewTCPEndPoint(&endPoint);
+    SuccessOrExit(err);
+
+#if WEAVE_CONFIG_CONNECT_RACING
+    // Track the end point as one of the attempts racing to connect to the peer. The winner becomes the
+    // connection's end point once it completes.
+    attempt->EndPoint = endPoint;
+    attempt->Addr = PeerAddr;
+    attempt->Port = PeerPort;
+    attempt->StartTime = System::Layer::GetClock_MonotonicMS();
+#else
+    mTcpEndPoint = endPoint;
+#endif
 
     // If the peer address is not a ULA, or if the interface identifier portion of the peer address does not match
     // the peer node id, then force the destination node identifier field to be encoded in all sent messages.
@@ -1278,17 +1462,16 @@ WEAVE_ERROR WeaveConnection::StartConnect()
     if (MessageLayer->FabricState->ListenIPv6Addr != IPAddress::Any)
 #endif // !INET_CONFIG_ENABLE_IPV4
     {
-        err = mTcpEndPoint->Bind(kIPAddressType_IPv6, MessageLayer->FabricState->ListenIPv6Addr, 0, true);
-        if (err != WEAVE_NO_ERROR)
-            return err;
+        err = endPoint->Bind(kIPAddressType_IPv6, MessageLayer->FabricState->ListenIPv6Addr, 0, true);
+        SuccessOrExit(err);
     }
 #endif
 
     State = kState_Connecting;
 
-    mTcpEndPoint->AppState = this;
-    mTcpEndPoint->OnConnectComplete = HandleConnectComplete;
-    mTcpEndPoint->SetConnectTimeout(mConnectTimeout);
+    endPoint->AppState = this;
+    endPoint->OnConnectComplete = HandleConnectComplete;
+    endPoint->SetConnectTimeout(mConnectTimeout);
 
 #if WEAVE_PROGRESS_LOGGING
     {
@@ -1298,7 +1481,19 @@ WEAVE_ERROR WeaveConnection::StartConnect()
     }
 #endif
     // Initiate the TCP connection.
-    return mTcpEndPoint->Connect(PeerAddr, PeerPort, mTargetInterface);
+    err = endPoint->Connect(PeerAddr, PeerPort, mTargetInterface);
+
+exit:
+#if WEAVE_CONFIG_CONNECT_RACING
+    // Release the end point of an attempt that failed to start. (An attempt that failed synchronously never
+    // reports completion, so the end point would otherwise be left behind.)
+    if (err != WEAVE_NO_ERROR && endPoint != NULL && attempt->EndPoint == endPoint)
+    {
+        attempt->EndPoint = NULL;
+        endPoint->Free();
+    }
+#endif
+    return err;
 }
 
 void WeaveConnection::HandleConnectComplete(TCPEndPoint *endPoint, INET_ERROR conRes)
@@ -1307,6 +1502,35 @@ void WeaveConnection::HandleConnectComplete(TCPEndPoint *endPoint, INET_ERROR co
 
     WeaveLogProgress(MessageLayer, "TCP con complete %04X %ld", con->LogId(), (long)conRes);
 
+#if WEAVE_CONFIG_CONNECT_RACING
+    // Retire the attempt the end point belongs to, recording how it fared for use in ordering later attempts.
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+    {
+        ConnectAttempt &attempt = con->mConnectAttempts[i];
+
+        if (attempt.EndPoint != endPoint)
+            continue;
+
+        attempt.EndPoint = NULL;
+
+        if (conRes == INET_NO_ERROR)
+        {
+            con->MessageLayer->ConnectHistory.RecordSuccess(attempt.Addr, attempt.Port,
+                                                            (uint32_t)(System::Layer::GetClock_MonotonicMS() - attempt.StartTime));
+
+            // The winning attempt determines the peer address of the connection. Abandon the others.
+            con->PeerAddr = attempt.Addr;
+            con->PeerPort = attempt.Port;
+            con->AbortConnectAttempts();
+            con->mTcpEndPoint = endPoint;
+        }
+        else
+            con->MessageLayer->ConnectHistory.RecordFailure(attempt.Addr, attempt.Port);
+
+        break;
+    }
+#endif
+
     // If the connection was successful...
     if (conRes == INET_NO_ERROR)
     {
@@ -1623,6 +1847,11 @@ void WeaveConnection::Init(WeaveMessageLayer *msgLayer)
     OnReceiveError = NULL;
     memset(&mPeerAddrs, 0, sizeof(mPeerAddrs));
     mTcpEndPoint = NULL;
+#if WEAVE_CONFIG_CONNECT_RACING
+    for (int i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+        mConnectAttempts[i] = ConnectAttempt();
+    mPeerAddrsPort = 0;
+#endif
 #if CONFIG_NETWORK_LAYER_BLE
     mBleEndPoint = NULL;
 #endif
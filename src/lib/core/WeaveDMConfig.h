@@ -320,6 +320,22 @@
 #define WDM_PUBLISHER_MAX_NUM_PATH_GROUPS 8
 #endif // WDM_PUBLISHER_MAX_NUM_PATH_GROUPS
 
+/**
+ *  @def WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE
+ *
+ *  @brief
+ *    Number of buckets in the publisher's index of subscribed trait
+ *    instances by trait data handle. Marking a trait instance dirty
+ *    only visits the subscriptions in its bucket, rather than every
+ *    subscription handler. Sizing this to at least the number of
+ *    trait data sources in the publisher catalog avoids sharing
+ *    buckets between trait instances.
+ *
+ */
+#ifndef WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE
+#define WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE 8
+#endif // WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE
+
 /**
  *  @def WDM_CLIENT_MAX_NUM_UPDATABLE_TRAITS
  *
@@ -391,6 +407,43 @@
 #define WDM_PUBLISHER_MAX_ITEMS_IN_TRAIT_DIRTY_STORE  10
 #endif
 
+/**
+ *  @def WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS
+ *
+ *  @brief
+ *    The number of trait instances whose dirty paths (outside of dictionaries) the intermediate graph solver can track in
+ *    per-trait bitmaps instead of the granular dirty store. Bitmaps hold any number of dirty paths of a trait, so changes to
+ *    many properties of a trait instance don't exhaust the dirty store and degrade to marking the whole instance dirty.
+ *    Each bitmap costs 2 bits per schema handle (see WDM_PUBLISHER_DIRTY_PATH_BITMAP_MAX_HANDLES). Set to 0 to disable.
+ */
+#ifndef WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS
+#define WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS 0
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_DIRTY_PATH_BITMAP_MAX_HANDLES
+ *
+ *  @brief
+ *    The largest number of schema handles a trait can have for its dirty paths to be tracked in a dirty path bitmap (see
+ *    WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS). Dirty paths of larger traits are kept in the granular dirty store.
+ */
+#ifndef WDM_PUBLISHER_DIRTY_PATH_BITMAP_MAX_HANDLES
+#define WDM_PUBLISHER_DIRTY_PATH_BITMAP_MAX_HANDLES 62
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_CHANGE_JOURNAL_SIZE
+ *
+ *  @brief
+ *    Number of changed property paths remembered by each TraitDataSource, together with the version they were changed at.
+ *    When a subscriber resubscribes with a version that is still covered by the journal, only the paths changed since
+ *    that version are sent instead of the whole trait instance. Only data sources with managed versions keep a journal.
+ *    Each entry costs 16 bytes per data source. Set to 0 to disable.
+ */
+#ifndef WDM_PUBLISHER_CHANGE_JOURNAL_SIZE
+#define WDM_PUBLISHER_CHANGE_JOURNAL_SIZE 0
+#endif
+
 /**
  *  @def WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET
  *
@@ -416,6 +469,31 @@
 #define WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE  10
 #endif
 
+/**
+ *  @def WDM_UPDATE_NUM_PENDING_PATH_BITMAPS
+ *
+ *  @brief
+ *    The number of trait instances whose pending update paths (outside of dictionary items) a SubscriptionClient can track
+ *    in per-trait bitmaps instead of its pending path store. Bitmaps hold any number of paths of a trait, so updating many
+ *    properties of a trait instance doesn't fail with WEAVE_ERROR_WDM_PATH_STORE_FULL; the paths are then sent over as many
+ *    rounds of UpdateRequests as the in-progress list (see WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE) needs.
+ *    Each bitmap costs 2 bits per schema handle (see WDM_UPDATE_PENDING_PATH_BITMAP_MAX_HANDLES). Set to 0 to disable.
+ */
+#ifndef WDM_UPDATE_NUM_PENDING_PATH_BITMAPS
+#define WDM_UPDATE_NUM_PENDING_PATH_BITMAPS 0
+#endif
+
+/**
+ *  @def WDM_UPDATE_PENDING_PATH_BITMAP_MAX_HANDLES
+ *
+ *  @brief
+ *    The largest number of schema handles a trait can have for its pending update paths to be tracked in a pending path
+ *    bitmap (see WDM_UPDATE_NUM_PENDING_PATH_BITMAPS). Pending paths of larger traits are kept in the pending path store.
+ */
+#ifndef WDM_UPDATE_PENDING_PATH_BITMAP_MAX_HANDLES
+#define WDM_UPDATE_PENDING_PATH_BITMAP_MAX_HANDLES 62
+#endif
+
 /**
  *  @def WDM_PUBLISHER_MAX_NOTIFIES_IN_FLIGHT
  *
@@ -429,6 +507,82 @@
 #define WDM_PUBLISHER_MAX_NOTIFIES_IN_FLIGHT 4
 #endif
 
+/**
+ *  @def WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE
+ *
+ *  @brief
+ *    Controls the number of encoded data elements the notification engine retains so that the same trait instance data, at the
+ *    same version, can be copied into the notifies of several subscribers without re-walking the trait schema for each of them.
+ *    This is mostly useful on publishers with a large number of subscribers to the same trait instances. Set to 0 to disable the
+ *    cache.
+ *
+ */
+#ifndef WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE
+#define WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE 0
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_DATA_ELEMENT_CACHE_ENTRY_SIZE
+ *
+ *  @brief
+ *    The maximum size (in bytes) of a single encoded data element that can be retained in the notification engine's data element
+ *    cache. Data elements larger than this are always encoded directly into the notify.
+ *
+ */
+#ifndef WDM_PUBLISHER_DATA_ELEMENT_CACHE_ENTRY_SIZE
+#define WDM_PUBLISHER_DATA_ELEMENT_CACHE_ENTRY_SIZE 256
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_NOTIFY_COALESCING_WINDOW_MSEC
+ *
+ *  @brief
+ *    The default amount of time (in milliseconds) that the notification engine waits after data first becomes dirty for a
+ *    subscription before sending it a notify. Changes made within the window are merged into a single notify. This can be
+ *    overridden per subscription with SubscriptionHandler::SetNotifyRateControl. Set to 0 to send notifies as soon as possible.
+ *
+ */
+#ifndef WDM_PUBLISHER_NOTIFY_COALESCING_WINDOW_MSEC
+#define WDM_PUBLISHER_NOTIFY_COALESCING_WINDOW_MSEC 0
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_NOTIFY_MIN_INTERVAL_MSEC
+ *
+ *  @brief
+ *    The default minimum amount of time (in milliseconds) between the start of successive data notifies to a subscription. This
+ *    can be overridden per subscription with SubscriptionHandler::SetNotifyRateControl. Set to 0 to disable.
+ *
+ */
+#ifndef WDM_PUBLISHER_NOTIFY_MIN_INTERVAL_MSEC
+#define WDM_PUBLISHER_NOTIFY_MIN_INTERVAL_MSEC 0
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_NOTIFY_SLOW_CONFIRM_MSEC
+ *
+ *  @brief
+ *    A notify that takes longer than this (in milliseconds) to be confirmed by a subscriber, or that fails to be delivered,
+ *    causes the notification engine to back off sending further notifies to that subscriber.
+ *
+ */
+#ifndef WDM_PUBLISHER_NOTIFY_SLOW_CONFIRM_MSEC
+#define WDM_PUBLISHER_NOTIFY_SLOW_CONFIRM_MSEC 2000
+#endif
+
+/**
+ *  @def WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC
+ *
+ *  @brief
+ *    The maximum additional delay (in milliseconds) that is added to the minimum notify interval of a subscriber that is slow
+ *    to confirm notifies. The backoff doubles on every slow confirm and halves on every timely one. Set to 0 to disable
+ *    adaptive backoff.
+ *
+ */
+#ifndef WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC
+#define WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC 0
+#endif
+
 /**
  * The auto-generated schema tables key off this define to enable/disable certain fields in the tables. Enable this for now, but remove this define
  * once it has been similarly removed from the auto-generated code since all products are expected to need dictionary support, so the savings in flash/ram
@@ -526,6 +680,40 @@
 #define WDM_ENABLE_SUBSCRIPTION_CLIENT 0
 #endif // WDM_MAX_NUM_SUBSCRIPTION_CLIENTS > 0
 
+/**
+ *  @def WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT
+ *
+ *  @brief
+ *    Number of worker threads available to apply the data list of
+ *    an inbound notify, once enabled through
+ *    SubscriptionEngine::EnableParallelDataListApplication.
+ *
+ *    The data elements of the trait instances whose data sinks are
+ *    thread-safe (see TraitDataSink::IsThreadSafe) are partitioned
+ *    by trait instance, and the partitions are applied concurrently
+ *    on the worker threads. The data elements of the other sinks are
+ *    applied on the Weave thread, in the order of the data list.
+ *
+ *    Requires POSIX threads. 0 disables the feature.
+ *
+ */
+#ifndef WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT
+#define WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT 0
+#endif
+
+/**
+ *  @def WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE
+ *
+ *  @brief
+ *    Maximum number of data elements collected from a data list
+ *    before they are handed to the worker threads. Longer lists are
+ *    applied in consecutive batches.
+ *
+ */
+#ifndef WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE
+#define WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE 32
+#endif
+
 /**
  * @def WDM_MAX_NOTIFICATION_SIZE
  *
@@ -572,6 +760,61 @@
 #define WDM_MIN_UPDATE_SIZE 1024
 #endif /* WDM_MIN_UPDATE_SIZE */
 
+/**
+ * @def WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS
+ *
+ * @brief
+ *   Specify the maximum number of UpdateRequests a
+ *   SubscriptionClient keeps in flight at the same time.
+ *
+ *   With the default of 1, an update that does not fit in
+ *   one payload is sent as a sequence of PartialUpdateRequests
+ *   on a single exchange. With a larger window, the paths
+ *   being updated are spread over up to this many independent
+ *   UpdateRequests, each on its own exchange; the status list
+ *   of each response is applied to the paths the request
+ *   carried, and only the paths that failed with a retriable
+ *   status are retried.
+ *
+ *   Every request of the window costs one UpdateClient and
+ *   one ExchangeContext while it is in flight.
+ *
+ *   The requests of the window share the in-progress list of
+ *   the SubscriptionClient, so no more than
+ *   #WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE paths are in
+ *   flight at once, however wide the window.
+ */
+#ifndef WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS
+#define WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS 1
+#endif /* WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS */
+
+/**
+ * @def WDM_MAX_VIEW_REQUEST_SIZE
+ *
+ * @brief
+ *   Specify the maximum size (in bytes) of a ViewRequest payload
+ *   sent by a MultiViewClient. The payload is also limited by the
+ *   path MTU of the binding and by the size of
+ *   `nl::Weave::System::PacketBuffer`; paths that do not fit are
+ *   sent in further requests.
+ */
+#ifndef WDM_MAX_VIEW_REQUEST_SIZE
+#define WDM_MAX_VIEW_REQUEST_SIZE 2048
+#endif /* WDM_MAX_VIEW_REQUEST_SIZE */
+
+/**
+ * @def WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS
+ *
+ * @brief
+ *   Specify the maximum number of ViewRequests a MultiViewClient
+ *   keeps in flight at the same time on its binding.
+ *
+ *   Every request in flight costs one ExchangeContext.
+ */
+#ifndef WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS
+#define WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS 4
+#endif /* WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS */
+
 /**
  *  @def TDM_DISABLE_STRICT_SCHEMA_COMPLIANCE
  *
@@ -585,6 +828,36 @@
 #define TDM_DISABLE_STRICT_SCHEMA_COMPLIANCE 1
 #endif
 
+/**
+ *  @def TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES
+ *
+ *  @brief
+ *    Maximum number of trait schemas whose property tree index is
+ *    allocated from the shared pool, because the schema doesn't
+ *    provide index storage of its own. The index of a schema is
+ *    built when an instance of the trait is first added to a trait
+ *    catalog. 0 disables the pool, and lookups into such schemas
+ *    scan their schema handle table.
+ *
+ */
+#ifndef TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES
+#define TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES 16
+#endif
+
+/**
+ *  @def TDM_PROPERTY_TREE_INDEX_POOL_SIZE
+ *
+ *  @brief
+ *    Number of schema handle entries in the shared pool that
+ *    property tree indexes are allocated from. The index of a
+ *    schema with N handles takes 4N + 1 entries. Schemas that don't
+ *    fit in what is left of the pool scan their schema handle table.
+ *
+ */
+#ifndef TDM_PROPERTY_TREE_INDEX_POOL_SIZE
+#define TDM_PROPERTY_TREE_INDEX_POOL_SIZE 1024
+#endif
+
 /**
  *  @def WDM_ENABLE_PROTOCOL_CHECKS
  *
@@ -60,6 +60,46 @@
 #define WEAVE_CONFIG_EVENT_LOGGING_BDX_OFFLOAD 0
 #endif /* WEAVE_CONFIG_EVENT_LOGGING_BDX_OFFLOAD */
 
+/**
+ *  @def WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+ *
+ *  @brief
+ *    Enable offering LZ4 compression of the event log uploaded over BDX
+ *
+ *   The uploader offers compression in the SendInit metadata and only
+ *   compresses when the receiver accepts it, so uploads to receivers
+ *   without compression support are unchanged. The log is compressed
+ *   in chunks as it is fetched, never as a whole.
+ */
+#ifndef WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+#define WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION 0
+#endif /* WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION */
+
+/**
+ *  @def WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE
+ *
+ *  @brief
+ *    Bytes of events fetched and compressed at a time by a
+ *    compressing BDX log upload.
+ */
+#ifndef WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE
+#define WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE 1024
+#endif /* WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE */
+
+/**
+ *  @def WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE
+ *
+ *  @brief
+ *    Bytes of previously uploaded events a compressing BDX log upload
+ *    keeps to find repeated data in.
+ *
+ *   Larger histories improve the compression ratio at the cost of RAM.
+ *   The history and one chunk must together fit in 64KiB.
+ */
+#ifndef WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE
+#define WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE 4096
+#endif /* WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE */
+
 /**
  *  @def WEAVE_CONFIG_EVENT_LOGGING_WDM_OFFLOAD
  *
@@ -176,4 +216,8 @@
 #define WEAVE_CONFIG_EVENT_LOGGING_EXTERNAL_EVENT_SUPPORT 0
 #endif
 
+#if (WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE + WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE) > 65535
+#error "The BDX log compression history and chunk must together fit in 64KiB"
+#endif
+
 #endif /* WEAVEEVENTLOGGINGCONFIG_H */
@@ -91,6 +91,10 @@ WEAVE_ERROR WeaveExchangeManager::Init(WeaveMessageLayer *msgLayer)
 
     InitBindingPool();
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    InitBindingConnectionPool();
+#endif
+
     memset(UMHandlerPool, 0, sizeof(UMHandlerPool));
     OnExchangeContextChanged = NULL;
 
@@ -136,6 +140,9 @@ WEAVE_ERROR WeaveExchangeManager::Shutdown()
             MessageLayer->OnMessageReceived = NULL;
             MessageLayer->OnAcceptError = NULL;
         }
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+        ShutdownBindingConnectionPool();
+#endif
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
         WRMPStopTimer();
 
@@ -503,6 +510,10 @@ void WeaveExchangeManager::HandleConnectionClosed(WeaveConnection *con, WEAVE_ER
         BindingPool[i].OnConnectionClosed(con, conErr);
     }
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    HandlePooledConnectionClosed(con);
+#endif
+
     ExchangeContext *ec = (ExchangeContext *) ContextPool;
     for (int i = 0; i < WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS; i++, ec++)
         if (ec->ExchangeMgr != NULL && ec->Con == con)
@@ -1148,6 +1159,10 @@ void WeaveExchangeManager::NotifyKeyFailed(uint64_t peerNodeId, uint16_t keyId,
     {
         BindingPool[i].OnKeyFailed(peerNodeId, keyId, keyErr);
     }
+
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    HandlePooledKeyFailed(peerNodeId, keyId);
+#endif
 }
 
 /**
@@ -1888,5 +1903,374 @@ uint16_t WeaveExchangeManager::GetBindingLogId(const Binding * const binding) co
     return static_cast<uint16_t>(binding - BindingPool);
 }
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+/**
+ *  Get the counters describing the use of the pool of TCP connections shared by bindings.
+ *
+ *  @param[out] stats           The counters, accumulated since the WeaveExchangeManager was initialized.
+ *
+ */
+void WeaveExchangeManager::GetBindingConnectionPoolStats(BindingConnectionPoolStats &stats) const
+{
+    stats = mBindingConnectionPoolStats;
+}
+
+/**
+ *  Initialize the pool of TCP connections shared by bindings.
+ *
+ */
+void WeaveExchangeManager::InitBindingConnectionPool(void)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        mPooledConnections[i].State = PooledConnection::kState_Free;
+        mPooledConnections[i].Con = NULL;
+        mPooledConnections[i].Owner = NULL;
+    }
+    memset(&mBindingConnectionPoolStats, 0, sizeof(mBindingConnectionPoolStats));
+}
+
+/**
+ *  Close all the connections held by the pool of TCP connections shared by bindings.
+ *
+ */
+void WeaveExchangeManager::ShutdownBindingConnectionPool(void)
+{
+    MessageLayer->SystemLayer->CancelTimer(HandleBindingConnectionPoolTimeout, this);
+
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        if (mPooledConnections[i].State != PooledConnection::kState_Free)
+        {
+            ClosePooledConnection(mPooledConnections[i]);
+        }
+    }
+}
+
+/**
+ *  Find the pooled connection, established or being established, matching the peer and the
+ *  security configuration of a binding.
+ *
+ *  @param[in]  binding         The binding being prepared.
+ *
+ *  @return  A pointer to the pooled connection, or NULL if there is none.
+ *
+ */
+WeaveExchangeManager::PooledConnection *WeaveExchangeManager::FindPooledConnection(const Binding &binding)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State != PooledConnection::kState_Free &&
+            entry.PeerNodeId == binding.mPeerNodeId &&
+            entry.PeerAddress == binding.mPeerAddress &&
+            entry.PeerPort == binding.mPeerPort &&
+            entry.PeerInterfaceId == binding.mInterfaceId &&
+            entry.SecurityOption == binding.mSecurityOption &&
+            entry.AuthMode == binding.mAuthMode)
+        {
+            return &entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ *  Allocate a pooled connection to be established by a binding.  If the pool is full, the
+ *  connection that has been idle the longest is closed to make room.
+ *
+ *  @param[in]  owner           The binding that will establish the connection.
+ *
+ *  @return  A pointer to the pooled connection, or NULL if every pooled connection is in use.
+ *
+ */
+WeaveExchangeManager::PooledConnection *WeaveExchangeManager::NewPooledConnection(Binding &owner)
+{
+    PooledConnection *entry = NULL;
+
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &candidate = mPooledConnections[i];
+
+        if (candidate.State == PooledConnection::kState_Free)
+        {
+            entry = &candidate;
+            break;
+        }
+
+        if (candidate.State == PooledConnection::kState_Established && candidate.UserCount == 0 &&
+            (entry == NULL || candidate.IdleSinceMS < entry->IdleSinceMS))
+        {
+            entry = &candidate;
+        }
+    }
+
+    VerifyOrExit(entry != NULL, /* no-op */);
+
+    if (entry->State != PooledConnection::kState_Free)
+    {
+        mBindingConnectionPoolStats.Evictions++;
+        ClosePooledConnection(*entry);
+    }
+
+    entry->State = PooledConnection::kState_Establishing;
+    entry->Owner = &owner;
+    entry->Con = NULL;
+    entry->PeerNodeId = owner.mPeerNodeId;
+    entry->PeerAddress = owner.mPeerAddress;
+    entry->PeerPort = owner.mPeerPort;
+    entry->PeerInterfaceId = owner.mInterfaceId;
+    entry->SecurityOption = owner.mSecurityOption;
+    entry->AuthMode = owner.mAuthMode;
+    entry->KeyId = WeaveKeyId::kNone;
+    entry->EncType = kWeaveEncryptionType_None;
+    entry->UserCount = 0;
+
+exit:
+    return entry;
+}
+
+/**
+ *  Make the connection established by a binding on behalf of the pool available to other bindings.
+ *
+ *  The pool takes a reference to the connection and a reservation on its session key, so that
+ *  both remain after the binding closes, and bindings waiting for the connection are completed.
+ *
+ *  @param[in]  owner           The binding that has become ready.
+ *
+ */
+void WeaveExchangeManager::PublishPooledConnection(Binding &owner)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State == PooledConnection::kState_Establishing && entry.Owner == &owner)
+        {
+            entry.Con = owner.mCon;
+            entry.Con->AddRef();
+
+            if (entry.SecurityOption != Binding::kSecurityOption_None)
+            {
+                entry.KeyId = owner.mKeyId;
+                entry.EncType = owner.mEncType;
+                MessageLayer->SecurityMgr->ReserveKey(entry.PeerNodeId, entry.KeyId);
+            }
+
+            entry.Owner = NULL;
+            entry.UserCount = 1;
+            entry.State = PooledConnection::kState_Established;
+
+            WeaveLogDetail(ExchangeManager, "Binding[%" PRIu8 "]: Pooled con %04" PRIX16,
+                    GetBindingLogId(&owner), entry.Con->LogId());
+
+            // Complete the bindings waiting for the connection once the owner is done being made ready.
+            MessageLayer->SystemLayer->StartTimer(0, HandleBindingConnectionPoolTimeout, this);
+            break;
+        }
+    }
+}
+
+/**
+ *  Give up a pooled connection that a binding was establishing, after the binding has failed
+ *  or been reset.  Bindings waiting for the connection will try again.
+ *
+ *  @param[in]  owner           The binding that was establishing the connection.
+ *
+ */
+void WeaveExchangeManager::AbandonPooledConnection(Binding &owner)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State == PooledConnection::kState_Establishing && entry.Owner == &owner)
+        {
+            entry.Owner = NULL;
+            entry.State = PooledConnection::kState_Free;
+
+            MessageLayer->SystemLayer->StartTimer(0, HandleBindingConnectionPoolTimeout, this);
+            break;
+        }
+    }
+}
+
+/**
+ *  Record that a binding has stopped using a pooled connection.  When no bindings are using the
+ *  connection any longer, it is kept open for the idle timeout in case another binding needs it.
+ *
+ *  @param[in]  con             The pooled connection.
+ *
+ */
+void WeaveExchangeManager::ReleasePooledConnection(WeaveConnection *con)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State == PooledConnection::kState_Established && entry.Con == con)
+        {
+            VerifyOrDie(entry.UserCount > 0);
+
+            if (--entry.UserCount == 0)
+            {
+                entry.IdleSinceMS = System::Layer::GetClock_MonotonicMS();
+                MessageLayer->SystemLayer->StartTimer(0, HandleBindingConnectionPoolTimeout, this);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ *  Remove a connection from the pool, releasing the pool's reservation on its session key
+ *  and its reference to the connection.
+ *
+ *  @param[in]  entry           The pooled connection.
+ *
+ */
+void WeaveExchangeManager::ClosePooledConnection(PooledConnection &entry)
+{
+    WeaveConnection *con = entry.Con;
+
+    // Free the entry first, as releasing the key or the connection may call back into the pool.
+    entry.State = PooledConnection::kState_Free;
+    entry.Con = NULL;
+    entry.Owner = NULL;
+
+    VerifyOrExit(con != NULL, /* no-op */);
+
+    WeaveLogDetail(ExchangeManager, "Closing pooled con %04" PRIX16, con->LogId());
+
+    if (entry.SecurityOption != Binding::kSecurityOption_None)
+    {
+        MessageLayer->SecurityMgr->ReleaseKey(entry.PeerNodeId, entry.KeyId);
+    }
+
+    con->Release();
+
+exit:
+    return;
+}
+
+/**
+ *  Remove a connection from the pool when it closes.
+ *
+ */
+void WeaveExchangeManager::HandlePooledConnectionClosed(WeaveConnection *con)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State == PooledConnection::kState_Established && entry.Con == con)
+        {
+            ClosePooledConnection(entry);
+        }
+    }
+}
+
+/**
+ *  Remove a connection from the pool when its session key fails.
+ *
+ */
+void WeaveExchangeManager::HandlePooledKeyFailed(uint64_t peerNodeId, uint16_t keyId)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+
+        if (entry.State == PooledConnection::kState_Established &&
+            entry.SecurityOption != Binding::kSecurityOption_None &&
+            entry.PeerNodeId == peerNodeId && entry.KeyId == keyId)
+        {
+            ClosePooledConnection(entry);
+        }
+    }
+}
+
+/**
+ *  Complete the preparation of bindings waiting for pooled connections, and close pooled
+ *  connections that have been idle for the idle timeout.
+ *
+ */
+void WeaveExchangeManager::ServiceBindingConnectionPool(void)
+{
+    uint64_t now;
+    uint32_t nextTimeoutMS = 0;
+
+    // Close the connections that have gone unused for the idle timeout, and arrange to be called
+    // again when the next one will have.  This is done first so that a call requested while the
+    // waiting bindings are being completed below takes the place of this one.
+    now = System::Layer::GetClock_MonotonicMS();
+
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; ++i)
+    {
+        PooledConnection &entry = mPooledConnections[i];
+        uint64_t idleMS;
+
+        if (entry.State != PooledConnection::kState_Established || entry.UserCount != 0)
+        {
+            continue;
+        }
+
+        idleMS = now - entry.IdleSinceMS;
+        if (idleMS >= WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS)
+        {
+            mBindingConnectionPoolStats.IdleTimeouts++;
+            ClosePooledConnection(entry);
+        }
+        else if (nextTimeoutMS == 0 || WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS - idleMS < nextTimeoutMS)
+        {
+            nextTimeoutMS = static_cast<uint32_t>(WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS - idleMS);
+        }
+    }
+
+    if (nextTimeoutMS != 0)
+    {
+        MessageLayer->SystemLayer->StartTimer(nextTimeoutMS, HandleBindingConnectionPoolTimeout, this);
+    }
+
+    // Complete the bindings whose pooled connection has been established.  Bindings whose
+    // connection was abandoned prepare their transport again, and one of them takes over
+    // establishing it for the pool.
+    for (size_t i = 0; i < WEAVE_CONFIG_MAX_BINDINGS; ++i)
+    {
+        Binding &binding = BindingPool[i];
+        PooledConnection *entry;
+
+        if (!binding.IsWaitingForPooledConnection())
+        {
+            continue;
+        }
+
+        entry = FindPooledConnection(binding);
+        if (entry == NULL)
+        {
+            binding.ClearFlag(Binding::kFlag_ConnectionPooled);
+            binding.PrepareTransport();
+        }
+        else if (entry->State == PooledConnection::kState_Established)
+        {
+            entry->UserCount++;
+            binding.UsePooledConnection(entry->Con, entry->KeyId, entry->EncType);
+        }
+    }
+}
+
+void WeaveExchangeManager::HandleBindingConnectionPoolTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError)
+{
+    WeaveExchangeManager *exchangeMgr = reinterpret_cast<WeaveExchangeManager *>(aAppState);
+
+    VerifyOrDie((aSystemLayer != NULL) && (exchangeMgr != NULL));
+
+    exchangeMgr->ServiceBindingConnectionPool();
+}
+
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
 } // namespace nl
 } // namespace Weave
@@ -402,6 +402,7 @@ class NL_DLL_EXPORT WeaveExchangeManager
     friend class WeaveConnection;
     friend class WeaveSecurityManager;
     friend class WeaveFabricState;
+    friend class TestBindingConnectionPool;
 
 public:
     enum State
@@ -454,6 +455,21 @@ public:
     void ClearMsgCounterSyncReq(uint64_t peerNodeId);
 #endif
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    /**
+     *  Counters describing the use of the pool of TCP connections shared by bindings.
+     */
+    struct BindingConnectionPoolStats
+    {
+        uint32_t Hits;              /**< Bindings that shared a pooled connection, or waited for one being established. */
+        uint32_t Misses;            /**< Bindings that had to establish a connection of their own. */
+        uint32_t Evictions;         /**< Idle pooled connections closed to make room for another. */
+        uint32_t IdleTimeouts;      /**< Pooled connections closed after going unused for the idle timeout. */
+    };
+
+    void GetBindingConnectionPoolStats(BindingConnectionPoolStats &stats) const;
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
 private:
     uint16_t NextExchangeId;
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
@@ -521,6 +537,47 @@ private:
     Binding BindingPool[WEAVE_CONFIG_MAX_BINDINGS];
     size_t mBindingsInUse;
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    /**
+     *  @class PooledConnection
+     *
+     *  @brief
+     *    A TCP connection, and the session key authenticating it, shared by the bindings
+     *    that target the same peer node at the same address with the same security settings.
+     *    While the connection is being established it is owned by the binding establishing
+     *    it, and other bindings wait for it.  Once established, the pool holds its own
+     *    reference to the connection and reservation on the key, so that they outlive the
+     *    bindings using them until the connection has been idle for the idle timeout.
+     */
+    class PooledConnection
+    {
+    public:
+        enum
+        {
+            kState_Free                 = 0,    /**< The entry is unused. */
+            kState_Establishing         = 1,    /**< The owner binding is connecting and authenticating. */
+            kState_Established          = 2,    /**< The connection is ready to be shared. */
+        };
+
+        WeaveConnection *Con;                   /**< The shared connection, once established. */
+        Binding *Owner;                         /**< The binding establishing the connection. */
+        uint64_t PeerNodeId;                    /**< The node id of the peer. */
+        nl::Inet::IPAddress PeerAddress;        /**< The address of the peer. */
+        InterfaceId PeerInterfaceId;            /**< The interface the connection was made over. */
+        uint64_t IdleSinceMS;                   /**< The monotonic time at which the last binding using the connection closed. */
+        uint32_t KeyId;                         /**< The session key authenticating the connection. */
+        uint16_t PeerPort;                      /**< The port of the peer. */
+        WeaveAuthMode AuthMode;                 /**< The authentication mode requested of the session. */
+        uint8_t EncType;                        /**< The encryption type of the session. */
+        uint8_t SecurityOption;                 /**< The security option of the bindings sharing the connection. */
+        uint8_t UserCount;                      /**< The number of Ready bindings using the connection. */
+        uint8_t State;                          /**< The state of the entry. */
+    };
+
+    PooledConnection mPooledConnections[WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE];
+    BindingConnectionPoolStats mBindingConnectionPoolStats;
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
     UnsolicitedMessageHandler UMHandlerPool[WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS];
     void (*OnExchangeContextChanged)(size_t numContextsInUse);
 
@@ -547,6 +604,21 @@ private:
     void NotifySecurityManagerAvailable();
     void NotifyKeyFailed(uint64_t peerNodeId, uint16_t keyId, WEAVE_ERROR keyErr);
 
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+    void InitBindingConnectionPool(void);
+    void ShutdownBindingConnectionPool(void);
+    PooledConnection *FindPooledConnection(const Binding &binding);
+    PooledConnection *NewPooledConnection(Binding &owner);
+    void PublishPooledConnection(Binding &owner);
+    void AbandonPooledConnection(Binding &owner);
+    void ReleasePooledConnection(WeaveConnection *con);
+    void ClosePooledConnection(PooledConnection &entry);
+    void HandlePooledConnectionClosed(WeaveConnection *con);
+    void HandlePooledKeyFailed(uint64_t peerNodeId, uint16_t keyId);
+    void ServiceBindingConnectionPool(void);
+    static void HandleBindingConnectionPoolTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError);
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
     WeaveExchangeManager(const WeaveExchangeManager&); // not defined
 };
 
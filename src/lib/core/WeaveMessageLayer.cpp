@@ -157,6 +157,9 @@ WEAVE_ERROR WeaveMessageLayer::Init(InitContext *context)
     //Internal and for Debug Only; When set, Message Layer drops message and returns.
     mDropMessage = false;
     mFlags = 0;
+#if WEAVE_CONFIG_CONNECT_RACING
+    ConnectHistory.Init();
+#endif
     SetTCPListenEnabled(context->listenTCP);
     SetUDPListenEnabled(context->listenUDP);
 #if WEAVE_CONFIG_ENABLE_EPHEMERAL_UDP_PORT
@@ -2588,6 +2591,167 @@ void WeaveMessageLayer::GetPeerDescription(char * buf, size_t bufSize, const Wea
         msgInfo->InCon);
 }
 
+#if WEAVE_CONFIG_CONNECT_RACING
+
+const uint32_t WeaveConnectHistory::kLatencyBucketLimitsMS[kLatencyBucketCount - 1] =
+{
+    50, 100, 250, 500, 1000, 2500, 5000
+};
+
+/**
+ *  Forget all connect history and latencies.
+ */
+void WeaveConnectHistory::Init(void)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+        mEntries[i] = Entry();
+
+    mLatencyHistogram = LatencyHistogram();
+    mUseCounter = 0;
+}
+
+/**
+ *  Record a successful TCP connect to a destination.
+ *
+ *  @param[in]  addr        The address connected to.
+ *  @param[in]  port        The port connected to.
+ *  @param[in]  latencyMS   Time the connect took, in milliseconds.
+ */
+void WeaveConnectHistory::RecordSuccess(const IPAddress &addr, uint16_t port, uint32_t latencyMS)
+{
+    Entry *entry = FindOrAdd(addr, port);
+    uint16_t latency = (latencyMS < UINT16_MAX) ? static_cast<uint16_t>(latencyMS) : UINT16_MAX - 1;
+    uint8_t bucket = 0;
+
+    while (bucket < kLatencyBucketCount - 1 && latencyMS >= kLatencyBucketLimitsMS[bucket])
+        bucket++;
+
+    mLatencyHistogram.Counts[bucket]++;
+
+    // Zero marks a destination with no successful connect, so the latency of a success is at least 1ms.
+    if (latency == 0)
+        latency = 1;
+
+    // Average with a weight of 1/4 on the new sample, to follow changes in the path while damping outliers.
+    if (entry->SmoothedLatencyMS == 0)
+        entry->SmoothedLatencyMS = latency;
+    else
+        entry->SmoothedLatencyMS = static_cast<uint16_t>((3 * static_cast<uint32_t>(entry->SmoothedLatencyMS) + latency) / 4);
+
+    entry->Failures = 0;
+}
+
+/**
+ *  Record a failed TCP connect to a destination.
+ *
+ *  @param[in]  addr        The address connected to.
+ *  @param[in]  port        The port connected to.
+ */
+void WeaveConnectHistory::RecordFailure(const IPAddress &addr, uint16_t port)
+{
+    Entry *entry = FindOrAdd(addr, port);
+
+    if (entry->Failures < UINT8_MAX)
+        entry->Failures++;
+}
+
+/**
+ *  Rank a destination by the likelihood of a quick successful connect.
+ *
+ *  Destinations whose last connect succeeded rank first, by their
+ *  average latency, followed by destinations with no history, followed
+ *  by destinations whose recent connects failed, by the number of
+ *  failures.
+ *
+ *  @param[in]  addr        The destination address.
+ *  @param[in]  port        The destination port.
+ *
+ *  @return The rank; lower ranks should be tried first.
+ */
+uint32_t WeaveConnectHistory::GetRank(const IPAddress &addr, uint16_t port) const
+{
+    const Entry *entry = Find(addr, port);
+    uint32_t rank = UINT16_MAX;
+
+    if (entry != NULL)
+    {
+        if (entry->Failures > 0)
+            rank += entry->Failures;
+        else if (entry->SmoothedLatencyMS != 0)
+            rank = entry->SmoothedLatencyMS;
+    }
+
+    return rank;
+}
+
+/**
+ *  Get the counts of successful connects by latency.
+ *
+ *  @param[out] histogram   Receives the counts since Init() or the last ResetLatencyHistogram().
+ */
+void WeaveConnectHistory::GetLatencyHistogram(LatencyHistogram &histogram) const
+{
+    histogram = mLatencyHistogram;
+}
+
+/**
+ *  Zero the counts of successful connects by latency, leaving the history of destinations intact.
+ */
+void WeaveConnectHistory::ResetLatencyHistogram(void)
+{
+    mLatencyHistogram = LatencyHistogram();
+}
+
+const WeaveConnectHistory::Entry *WeaveConnectHistory::Find(const IPAddress &addr, uint16_t port) const
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+    {
+        if (mEntries[i].LastUse != 0 && mEntries[i].Port == port && mEntries[i].Addr == addr)
+            return &mEntries[i];
+    }
+
+    return NULL;
+}
+
+WeaveConnectHistory::Entry *WeaveConnectHistory::FindOrAdd(const IPAddress &addr, uint16_t port)
+{
+    Entry *entry = const_cast<Entry *>(Find(addr, port));
+
+    // Replace the least recently used entry, starting with unused ones.
+    if (entry == NULL)
+    {
+        entry = &mEntries[0];
+
+        for (size_t i = 1; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+        {
+            if (mEntries[i].LastUse < entry->LastUse)
+                entry = &mEntries[i];
+        }
+
+        *entry = Entry();
+        entry->Addr = addr;
+        entry->Port = port;
+    }
+
+    // Restart the use counter, rather than wrapping it to zero, which marks unused entries.
+    if (++mUseCounter == 0)
+    {
+        for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+        {
+            if (mEntries[i].LastUse != 0)
+                mEntries[i].LastUse = 1;
+        }
+
+        mUseCounter = 2;
+    }
+
+    entry->LastUse = mUseCounter;
+
+    return entry;
+}
+
+#endif // WEAVE_CONFIG_CONNECT_RACING
+
 /**
  * @brief
  *   Generate random Weave node Id.
@@ -188,6 +188,65 @@ typedef enum WeaveMessageVersion
     kWeaveMessageVersion_V2                             = 2  /**< Message header format version V2. */
 } WeaveMessageVersion;
 
+#if WEAVE_CONFIG_CONNECT_RACING
+/**
+ *  @class WeaveConnectHistory
+ *
+ *  @brief
+ *    Remembers how recent outbound TCP connects to each destination
+ *    fared, so that racing connections try the destinations most likely
+ *    to succeed first, and counts connect latencies in a histogram.
+ *
+ */
+class NL_DLL_EXPORT WeaveConnectHistory
+{
+public:
+    enum
+    {
+        kLatencyBucketCount     = 8     /**< Number of buckets in the connect latency histogram. */
+    };
+
+    /**
+     *  Counts of successful connects by latency. Bucket i counts connects
+     *  that took less than kLatencyBucketLimitsMS[i] milliseconds and at
+     *  least the limit of the bucket before it; the last bucket counts all
+     *  slower connects.
+     */
+    struct LatencyHistogram
+    {
+        uint32_t Counts[kLatencyBucketCount];
+    };
+
+    static const uint32_t kLatencyBucketLimitsMS[kLatencyBucketCount - 1];
+
+    void Init(void);
+
+    void RecordSuccess(const IPAddress &addr, uint16_t port, uint32_t latencyMS);
+    void RecordFailure(const IPAddress &addr, uint16_t port);
+    uint32_t GetRank(const IPAddress &addr, uint16_t port) const;
+
+    void GetLatencyHistogram(LatencyHistogram &histogram) const;
+    void ResetLatencyHistogram(void);
+
+private:
+    struct Entry
+    {
+        IPAddress Addr;
+        uint32_t LastUse;                   /**< Value of mUseCounter when the entry was last updated; 0 if unused. */
+        uint16_t Port;
+        uint16_t SmoothedLatencyMS;         /**< Moving average latency of successful connects. */
+        uint8_t Failures;                   /**< Connects that failed since the last success. */
+    };
+
+    Entry mEntries[WEAVE_CONFIG_CONNECT_HISTORY_SIZE];
+    LatencyHistogram mLatencyHistogram;
+    uint32_t mUseCounter;
+
+    const Entry *Find(const IPAddress &addr, uint16_t port) const;
+    Entry *FindOrAdd(const IPAddress &addr, uint16_t port);
+};
+#endif // WEAVE_CONFIG_CONNECT_RACING
+
 /**
  *  @class WeaveConnection
  *
@@ -199,6 +258,7 @@ typedef enum WeaveMessageVersion
 class WeaveConnection
 {
     friend class WeaveMessageLayer;
+    friend class TestConnectRacing;
 
 public:
     /**
@@ -394,10 +454,30 @@ private:
     enum FlagsEnum
     {
         kFlag_IsIncoming              = 0x01,           /**< The connection was initiated by external node. */
+        kFlag_ResolvePending          = 0x02,           /**< A host name is being resolved alongside racing connect attempts. */
     };
 
     uint8_t mFlags;                                     /**< Various flags associated with the connection. */
 
+#if WEAVE_CONFIG_CONNECT_RACING
+    struct ConnectAttempt
+    {
+        TCPEndPoint *EndPoint;                          /**< End point of the attempt; NULL if the slot is free. */
+        IPAddress Addr;
+        uint64_t StartTime;                             /**< Monotonic time, in milliseconds, at which the attempt started. */
+        uint16_t Port;
+    };
+
+    ConnectAttempt mConnectAttempts[WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS];
+    uint16_t mPeerAddrsPort;                            /**< Port to connect to at the addresses in mPeerAddrs. */
+
+    ConnectAttempt *GetFreeConnectAttempt(void);
+    bool HasConnectAttempts(void) const;
+    void AbortConnectAttempts(void);
+    int SelectNextPeerAddress(void) const;
+    static void HandleConnectAttemptDelay(System::Layer *systemLayer, void *appState, System::Error err);
+#endif // WEAVE_CONFIG_CONNECT_RACING
+
     void Init(WeaveMessageLayer *msgLayer);
     void MakeConnectedTcp(TCPEndPoint *endPoint, const IPAddress &localAddr, const IPAddress &peerAddr);
     WEAVE_ERROR StartConnect(void);
@@ -568,6 +648,9 @@ public:
                                                              false otherwise. */
     bool mDropMessage;                                  /**< Internal and for Debug Only; When set, WeaveMessageLayer
                                                              drops the message and returns. */
+#if WEAVE_CONFIG_CONNECT_RACING
+    WeaveConnectHistory ConnectHistory;                 /**< Outcomes and latencies of recent outbound connects. */
+#endif
 
     WEAVE_ERROR Init(InitContext *context);
     WEAVE_ERROR Shutdown(void);
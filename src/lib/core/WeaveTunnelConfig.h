@@ -68,15 +68,58 @@
  *  @def WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED
  *
  *  @brief
- *    This defines the default queue depth for queueing data packets
- *    destined for the Service when the connection to the Service
- *    is not yet established.
+ *    This defines the default queue depth, per traffic class, for
+ *    queueing data packets destined for the Service when the
+ *    connection to the Service is not yet established or is backed up.
  *
  */
 #ifndef WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED
 #define WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED              (8)
 #endif // WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED
 
+/**
+ *  @def WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED
+ *
+ *  @brief
+ *    This defines the maximum number of bytes, across all traffic
+ *    classes, that may be held in the queue of data packets destined
+ *    for the Service. Control traffic evicts the oldest default
+ *    traffic when the budget is exhausted.
+ *
+ */
+#ifndef WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED
+#define WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED                (8 * 1280)
+#endif // WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED
+
+/**
+ *  @def WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK
+ *
+ *  @brief
+ *    This defines the number of bytes pending on the TCP connection
+ *    to the Service above which the tunnel agent stops sending and
+ *    instead queues data packets, and stops reading from the tunnel
+ *    interface until the connection drains.
+ *
+ *    A value of 0 disables this backpressure.
+ *
+ */
+#ifndef WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK
+#define WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK           (0)
+#endif // WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK
+
+/**
+ *  @def WEAVE_CONFIG_TUNNELING_SEND_QUEUE_POLL_INTERVAL_MSECS
+ *
+ *  @brief
+ *    This defines the interval (in milliseconds) at which the tunnel
+ *    agent retries sending queued data packets while the TCP
+ *    connection to the Service is above its high watermark.
+ *
+ */
+#ifndef WEAVE_CONFIG_TUNNELING_SEND_QUEUE_POLL_INTERVAL_MSECS
+#define WEAVE_CONFIG_TUNNELING_SEND_QUEUE_POLL_INTERVAL_MSECS      (50)
+#endif // WEAVE_CONFIG_TUNNELING_SEND_QUEUE_POLL_INTERVAL_MSECS
+
 /**
  *  @def WEAVE_CONFIG_TUNNELING_MAX_NUM_SHORTCUT_TUNNEL_PEERS
  *
@@ -89,6 +132,22 @@
 #define WEAVE_CONFIG_TUNNELING_MAX_NUM_SHORTCUT_TUNNEL_PEERS       (8)
 #endif // WEAVE_CONFIG_TUNNELING_MAX_NUM_SHORTCUT_TUNNEL_PEERS
 
+/**
+ *  @def WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE
+ *
+ *  @brief
+ *    This defines the number of entries in the direct-mapped cache of
+ *    next hop decisions (Service, shortcut tunnel or none) for packets
+ *    read from the tunnel interface, keyed on the destination address.
+ *
+ *    The cache is flushed whenever the nexthop table or the tunnel
+ *    state changes. A value of 0 disables the cache.
+ *
+ */
+#ifndef WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE
+#define WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE                    (0)
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE
+
 /**
  *  @def WEAVE_TUNNEL_CONFIG_WILL_OVERRIDE_ADDR_ROUTING_FUNCS
  *
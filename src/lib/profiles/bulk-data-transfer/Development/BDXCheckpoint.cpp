@@ -0,0 +1,198 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements the persisted checkpoints of resumable BDX
+ *      downloads.
+ */
+
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Core/WeaveEncoding.h>
+#include <Weave/Support/platform/PersistedStorage.h>
+
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXCheckpoint.h>
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development) {
+namespace BdxCheckpoint {
+
+using namespace ::nl::Weave::Platform;
+
+// CRC-32 (IEEE 802.3, reflected) of each 4-bit value, to keep the table small
+static const uint32_t sCrcNibbleTable[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t HashBytes(uint32_t aHash, const uint8_t *aData, size_t aLength)
+{
+    for (size_t i = 0; i < aLength; i++)
+    {
+        aHash ^= aData[i];
+        aHash *= 16777619UL;
+    }
+
+    return aHash;
+}
+
+/**
+ * @brief
+ *  Returns the identifier under which the checkpoint of an image is
+ *  persisted, a 32-bit FNV-1a hash of its file designator, length and
+ *  version that is never 0.  A checkpoint is therefore not resumed once the
+ *  image served under the same designator changes.
+ *
+ * @param[in]   aFileDesignator     The file designator of the transfer
+ * @param[in]   aImageLength        Length of the whole image, 0 if unknown
+ * @param[in]   aImageVersion       Version or modification time of the image, 0 if unknown
+ */
+uint32_t ComputeId(const ReferencedString &aFileDesignator, uint64_t aImageLength, uint32_t aImageVersion)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t image[sizeof(aImageLength) + sizeof(aImageVersion)];
+    uint8_t *p = image;
+
+    hash = HashBytes(hash, reinterpret_cast<const uint8_t *>(aFileDesignator.theString), aFileDesignator.theLength);
+
+    nl::Weave::Encoding::LittleEndian::Write64(p, aImageLength);
+    nl::Weave::Encoding::LittleEndian::Write32(p, aImageVersion);
+    hash = HashBytes(hash, image, sizeof(image));
+
+    // 0 marks the absence of a checkpoint
+    return (hash != 0) ? hash : 1;
+}
+
+/**
+ * @brief
+ *  Continues a CRC-32 over aLength more bytes.
+ *
+ * @param[in]   aCrc        CRC of the data so far, kInitialCrc to start
+ * @param[in]   aData       Next bytes of data
+ * @param[in]   aLength     Number of bytes in aData
+ *
+ * @return the CRC of the data so far followed by aData
+ */
+uint32_t UpdateCrc(uint32_t aCrc, const uint8_t *aData, uint64_t aLength)
+{
+    uint32_t crc = ~aCrc;
+
+    for (uint64_t i = 0; i < aLength; i++)
+    {
+        crc ^= aData[i];
+        crc = (crc >> 4) ^ sCrcNibbleTable[crc & 0xF];
+        crc = (crc >> 4) ^ sCrcNibbleTable[crc & 0xF];
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief
+ *  Reads the persisted checkpoint of the download identified by aId.
+ *
+ * @param[in]   aId         Identifier of the download, see ComputeId()
+ * @param[out]  aOffset     Offset up to which data was received
+ * @param[out]  aCrc        CRC-32 of the data received up to aOffset
+ *
+ * @retval      #WEAVE_NO_ERROR                                 If a checkpoint was found
+ * @retval      #WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND  If there is no checkpoint for aId
+ * @retval      other                                           Errors from the persisted storage
+ */
+WEAVE_ERROR Load(uint32_t aId, uint64_t &aOffset, uint32_t &aCrc)
+{
+    WEAVE_ERROR err;
+    uint32_t id;
+    uint32_t offsetLo;
+    uint32_t offsetHi;
+
+    err = PersistedStorage::Read(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID, id);
+    SuccessOrExit(err);
+
+    VerifyOrExit(id == aId, err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+
+    err = PersistedStorage::Read(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_LO, offsetLo);
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Read(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_HI, offsetHi);
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Read(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_CRC, aCrc);
+    SuccessOrExit(err);
+
+    aOffset = (static_cast<uint64_t>(offsetHi) << 32) | offsetLo;
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Persists the progress of the download identified by aId, replacing any
+ *  previous checkpoint.
+ *
+ *  The identifier is cleared first and written last, so an interrupted save
+ *  leaves no checkpoint rather than an inconsistent one.
+ *
+ * @param[in]   aId         Identifier of the download, see ComputeId()
+ * @param[in]   aOffset     Offset up to which data was received
+ * @param[in]   aCrc        CRC-32 of the data received up to aOffset
+ */
+WEAVE_ERROR Save(uint32_t aId, uint64_t aOffset, uint32_t aCrc)
+{
+    WEAVE_ERROR err;
+
+    err = Clear();
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Write(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_LO, static_cast<uint32_t>(aOffset));
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Write(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_OFFSET_HI, static_cast<uint32_t>(aOffset >> 32));
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Write(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_CRC, aCrc);
+    SuccessOrExit(err);
+
+    err = PersistedStorage::Write(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID, aId);
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Forgets the persisted checkpoint, if any.
+ */
+WEAVE_ERROR Clear(void)
+{
+    return PersistedStorage::Write(WEAVE_CONFIG_BDX_CHECKPOINT_KEY_ID, 0);
+}
+
+} // namespace BdxCheckpoint
+} // namespace BulkDataTransfer
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
@@ -0,0 +1,67 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file declares the helpers used by resumable BDX downloads to
+ *      persist their progress through the Platform::PersistedStorage API.
+ *
+ *      A single checkpoint is kept, which fits clients that download one
+ *      image at a time.  It holds a hash of the file designator, image length
+ *      and image version, the offset received so far and a CRC-32 of the data
+ *      up to that offset.
+ */
+
+#ifndef _WEAVE_BDX_CHECKPOINT_H
+#define _WEAVE_BDX_CHECKPOINT_H
+
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXManagedNamespace.hpp>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXMessages.h>
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development) {
+namespace BdxCheckpoint {
+
+enum
+{
+    kInitialCrc = 0 // CRC-32 of no data
+};
+
+uint32_t ComputeId(const ReferencedString &aFileDesignator, uint64_t aImageLength, uint32_t aImageVersion);
+
+uint32_t UpdateCrc(uint32_t aCrc, const uint8_t *aData, uint64_t aLength);
+
+WEAVE_ERROR Load(uint32_t aId, uint64_t &aOffset, uint32_t &aCrc);
+
+WEAVE_ERROR Save(uint32_t aId, uint64_t aOffset, uint32_t aCrc);
+
+WEAVE_ERROR Clear(void);
+
+} // namespace BdxCheckpoint
+} // namespace BulkDataTransfer
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+#endif // _WEAVE_BDX_CHECKPOINT_H
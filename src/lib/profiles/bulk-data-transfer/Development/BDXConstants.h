@@ -64,6 +64,7 @@ enum
     kMsgType_BlockEOFV1 =                   0x12,
     kMsgType_BlockAckV1 =                   0x13,
     kMsgType_BlockEOFAckV1 =                0x14,
+    kMsgType_BlockWindowAckV1 =             0x15,
 };
 
 /*
@@ -81,6 +82,17 @@ enum
     kMode_Asynchronous =                    0x40,
 };
 
+/*
+ * windowed operation is not a transfer mode of its own. it is offered
+ * in the Init messages and confirmed in the Accept messages alongside
+ * sender drive, and lets the sender keep several V1 blocks in flight
+ * that the receiver acknowledges with BlockWindowAckV1 messages.
+ */
+enum
+{
+    kMode_Windowed =                        0x80,
+};
+
 /*
  * with respect to range control, there are several options:
  * - definite length, if set then the transfer has definite length
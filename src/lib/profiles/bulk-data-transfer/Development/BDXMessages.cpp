@@ -50,6 +50,7 @@ SendInit::SendInit()
     , mSenderDriveSupported(true)
     , mReceiverDriveSupported(false)
     , mAsynchronousModeSupported(false)
+    , mWindowedModeSupported(false)
     , mDefiniteLength(true)
     , mStartOffsetPresent(false)
     , mWideRange(false)
@@ -241,6 +242,7 @@ WEAVE_ERROR SendInit::pack(PacketBuffer *aBuffer)
     if (mSenderDriveSupported) ptcByte |= kMode_SenderDrive;
     if (mReceiverDriveSupported) ptcByte |= kMode_ReceiverDrive;
     if (mAsynchronousModeSupported) ptcByte |= kMode_Asynchronous;
+    if (mWindowedModeSupported) ptcByte |= kMode_Windowed;
 
     err = i.writeByte(ptcByte);
     SuccessOrExit(err);
@@ -398,6 +400,7 @@ WEAVE_ERROR SendInit::parse(PacketBuffer *aBuffer, SendInit &aRequest)
     aRequest.mSenderDriveSupported = ((ptcByte & kMode_SenderDrive) != 0);
     aRequest.mReceiverDriveSupported = ((ptcByte & kMode_ReceiverDrive) != 0);
     aRequest.mAsynchronousModeSupported = ((ptcByte & kMode_Asynchronous) != 0);
+    aRequest.mWindowedModeSupported = ((ptcByte & kMode_Windowed) != 0);
 
     // now the range ctl field and do the same
     err = i.readByte(&rangeCtl);
@@ -461,6 +464,7 @@ bool SendInit::operator == (const SendInit &another) const
             mSenderDriveSupported == another.mSenderDriveSupported &&
             mReceiverDriveSupported == another.mReceiverDriveSupported &&
             mAsynchronousModeSupported == another.mAsynchronousModeSupported &&
+            mWindowedModeSupported == another.mWindowedModeSupported &&
             mDefiniteLength == another.mDefiniteLength &&
             mStartOffsetPresent == another.mStartOffsetPresent &&
             mAsynchronousModeSupported == another.mAsynchronousModeSupported &&
@@ -1212,6 +1216,118 @@ bool BlockSendV1::operator == (const BlockSendV1 &another) const
             memcmp(mData, another.mData, mLength) == 0);
 }
 
+// -- definitions for BlockWindowAckV1 and its supporting classes --
+
+/**
+ * The no-arg constructor with defaults for the block window ack message.
+ */
+BlockWindowAckV1::BlockWindowAckV1()
+    : mBlockCounter(0)
+    , mSelectiveAcks(0)
+    , mWindowSize(0)
+{
+}
+
+/**
+ * @brief
+ *  Initialize a BlockWindowAckV1 message
+ *
+ * @param[in]   aCounter        Counter of the next block expected
+ * @param[in]   aSelectiveAcks  Bitmap of the blocks received after aCounter
+ * @param[in]   aWindowSize     Max number of outstanding blocks the receiver accepts
+ *
+ * @return #WEAVE_NO_ERROR if successful
+ */
+WEAVE_ERROR BlockWindowAckV1::init(uint32_t aCounter, uint32_t aSelectiveAcks, uint8_t aWindowSize)
+{
+    mBlockCounter = aCounter;
+    mSelectiveAcks = aSelectiveAcks;
+    mWindowSize = aWindowSize;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * @brief
+ *  Pack a block window ack message into an PacketBuffer
+ *
+ * @param[out]  aBuffer         An PacketBuffer to pack the BlockWindowAckV1 message in
+ *
+ * @retval  #WEAVE_NO_ERROR                 If successful
+ * @retval  #WEAVE_ERROR_BUFFER_TOO_SMALL   If buffer is too small
+ */
+WEAVE_ERROR BlockWindowAckV1::pack(PacketBuffer *aBuffer)
+{
+    MessageIterator i(aBuffer);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    i.append();
+    err = i.write32(mBlockCounter);
+    SuccessOrExit(err);
+
+    err = i.write32(mSelectiveAcks);
+    SuccessOrExit(err);
+
+    err = i.writeByte(mWindowSize);
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Returns the packed length of this block window ack message
+ *
+ * @return length of the message when packed
+ */
+uint16_t BlockWindowAckV1::packedLength()
+{
+    // <counter>+<selective acks>+<window size>
+    return kPayloadLen;
+}
+
+/**
+ * @brief
+ *  Parse data from an PacketBuffer into a BlockWindowAckV1 message format
+ *
+ * @param[in]   aBuffer     Pointer to an PacketBuffer which has the data we want to parse out
+ * @param[out]  aAck        Pointer to a BlockWindowAckV1 object where we should store the results
+ *
+ * @retval  #WEAVE_NO_ERROR                 If successful
+ * @retval  #WEAVE_ERROR_BUFFER_TOO_SMALL   If buffer is too small
+ */
+WEAVE_ERROR BlockWindowAckV1::parse(PacketBuffer *aBuffer, BlockWindowAckV1 &aAck)
+{
+    MessageIterator i(aBuffer);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    err = i.read32(&aAck.mBlockCounter);
+    SuccessOrExit(err);
+
+    err = i.read32(&aAck.mSelectiveAcks);
+    SuccessOrExit(err);
+
+    err = i.readByte(&aAck.mWindowSize);
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Equality comparison between BlockWindowAckV1 messages
+ *
+ * @param[in]   another     Another BlockWindowAckV1 message to compare this one to
+ *
+ * @return true iff they have all the same fields.
+ */
+bool BlockWindowAckV1::operator == (const BlockWindowAckV1 &another) const
+{
+    return (mBlockCounter == another.mBlockCounter &&
+            mSelectiveAcks == another.mSelectiveAcks &&
+            mWindowSize == another.mWindowSize);
+}
+
 } // namespace BulkDataTransfer
 } // namespace Profiles
 } // namespace Weave
@@ -140,6 +140,7 @@ public:
     bool mSenderDriveSupported;         /**< True if we can support sender drive. */
     bool mReceiverDriveSupported;       /**< True if we can support receiver drive. */
     bool mAsynchronousModeSupported;    /**< True if we can support async mode. */
+    bool mWindowedModeSupported;        /**< True if we can keep several V1 blocks in flight. */
     // Range control options
     bool mDefiniteLength;               /**< True if the length field is present. */
     bool mStartOffsetPresent;           /**< True if the start offset field is present. */
@@ -421,6 +422,41 @@ class BlockAckV1 : public BlockQueryV1 { };
  */
 class BlockEOFAckV1 : public BlockQueryV1 { };
 
+/**
+ * @class BlockWindowAckV1
+ *
+ * @brief
+ *   The BlockWindowAckV1 message is used by the receiver of a windowed
+ *   transfer to acknowledge blocks of data.  It carries the counter of the
+ *   next block the receiver expects (all earlier blocks were received), a
+ *   bitmap of the blocks received out of order after it, and the number of
+ *   blocks the receiver is willing to have outstanding.
+ */
+class NL_DLL_EXPORT BlockWindowAckV1
+{
+public:
+    BlockWindowAckV1(void);
+
+    WEAVE_ERROR init(uint32_t aCounter, uint32_t aSelectiveAcks, uint8_t aWindowSize);
+
+    WEAVE_ERROR pack(PacketBuffer *aBuffer);
+    uint16_t packedLength(void);
+    static WEAVE_ERROR parse(PacketBuffer *aBuffer, BlockWindowAckV1 &aAck);
+
+    // BlockWindowAckV1 payload length
+    enum
+    {
+        kPayloadLen = 9,
+    };
+
+public:
+    bool operator == (const BlockWindowAckV1&) const;
+
+    uint32_t mBlockCounter;     /**< Counter of the next block expected, all earlier blocks were received. */
+    uint32_t mSelectiveAcks;    /**< Bit n set if block mBlockCounter + 1 + n was received. */
+    uint8_t mWindowSize;        /**< Max number of outstanding blocks the receiver accepts. */
+};
+
 } // namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development)
 } // namespace Profiles
 } // namespace Weave
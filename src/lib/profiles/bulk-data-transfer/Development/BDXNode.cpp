@@ -52,6 +52,11 @@ BdxNode::BdxNode(void)
     mInitialized            = false;
     mSendInitHandler        = NULL;
     mReceiveInitHandler     = NULL;
+    mMaxByteRate            = 0;
+    mTokens                 = 0;
+    mLastRefillTime         = 0;
+    mVirtualTime            = 0;
+    mNextQueueSeq           = 0;
 }
 
 /**
@@ -81,6 +86,12 @@ WEAVE_ERROR BdxNode::Init(WeaveExchangeManager *anExchangeMgr)
         mTransferPool[i].Reset();
     }
 
+    mMaxByteRate = WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC;
+    mTokens = GetBurstBytes();
+    mLastRefillTime = System::Layer::GetClock_MonotonicMS();
+    mVirtualTime = 0;
+    mNextQueueSeq = 0;
+
     mIsBdxTransferAllowed = true;
     mInitialized = true;
 
@@ -109,6 +120,11 @@ WEAVE_ERROR BdxNode::Shutdown(void)
         ShutdownTransfer(&mTransferPool[i]);
     }
 
+    if (mExchangeMgr != NULL)
+    {
+        mExchangeMgr->MessageLayer->SystemLayer->CancelTimer(HandleSchedulerTimeout, this);
+    }
+
     AllowBdxTransferToRun(false);
 
 #if WEAVE_CONFIG_BDX_SERVER_SUPPORT
@@ -408,6 +424,22 @@ WEAVE_ERROR BdxNode::InitTransfer(ExchangeContext *anEc,
 
     // Initialize xfer struct
     aXfer->mExchangeContext = anEc;
+    aXfer->mNode = this;
+
+    // Join the fair queue at the position of the peer's other transfers, or
+    // at the current virtual time for a new peer so it gets no head start
+    aXfer->mPeerServedBytes = mVirtualTime;
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        BDXTransfer &other = mTransferPool[i];
+
+        if (&other != aXfer && other.mIsInitiated && other.mExchangeContext != NULL &&
+            other.mExchangeContext->PeerNodeId == anEc->PeerNodeId)
+        {
+            aXfer->mPeerServedBytes = other.mPeerServedBytes;
+            break;
+        }
+    }
 
 exit:
     return err;
@@ -458,6 +490,364 @@ bool BdxNode::IsInitialized(void)
     return mInitialized;
 }
 
+/**
+ * @brief
+ *  Sets the byte-rate budget shared by all transfers of this node.
+ *
+ *  Transfers waiting for the budget are served fairly per peer node.  Setting
+ *  the budget to 0 releases any waiting transfers immediately.
+ *
+ * @param[in]   aBytesPerSec    Budget in bytes per second, 0 for no limit
+ */
+void BdxNode::SetMaxByteRate(uint32_t aBytesPerSec)
+{
+    RefillTokens();
+
+    mMaxByteRate = aBytesPerSec;
+    if (mTokens > static_cast<int64_t>(GetBurstBytes()))
+    {
+        mTokens = GetBurstBytes();
+    }
+
+    ServiceWaitingTransfers();
+}
+
+/**
+ * @brief
+ *  Returns the byte-rate budget shared by all transfers of this node.
+ *
+ * @return budget in bytes per second, 0 if there is no limit
+ */
+uint32_t BdxNode::GetMaxByteRate(void)
+{
+    return mMaxByteRate;
+}
+
+/**
+ * @brief
+ *  Returns the number of transfers currently allocated from this node's pool.
+ *
+ * @return number of active transfers
+ */
+uint16_t BdxNode::GetNumActiveTransfers(void)
+{
+    uint16_t count = 0;
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        if (mTransferPool[i].mIsInitiated)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief
+ *  Fills in a snapshot of the progress of one of this node's active transfers,
+ *  e.g. for diagnostics or to decide which transfer to cancel under load.
+ *
+ * @param[in]   aIndex      Index of the transfer among the active transfers,
+ *                              below GetNumActiveTransfers()
+ * @param[out]  aStats      Statistics of the transfer
+ *
+ * @retval      #WEAVE_NO_ERROR                 If successful
+ * @retval      #WEAVE_ERROR_INVALID_ARGUMENT   If there are not that many active transfers
+ */
+WEAVE_ERROR BdxNode::GetTransferStats(uint16_t aIndex, BDXTransferStats &aStats)
+{
+    WEAVE_ERROR err = WEAVE_ERROR_INVALID_ARGUMENT;
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        if (!mTransferPool[i].mIsInitiated)
+        {
+            continue;
+        }
+
+        if (aIndex == 0)
+        {
+            mTransferPool[i].GetStats(aStats);
+            ExitNow(err = WEAVE_NO_ERROR);
+        }
+
+        aIndex--;
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Runs the block step stored in aXfer.mNext once the node's byte-rate budget
+ *  allows it, and otherwise queues the transfer until its turn comes up.
+ *
+ *  Called by the protocol for steps that move file data: sending blocks, and
+ *  the queries and acknowledgements that let the peer send the next ones.
+ *  Errors are reported through the transfer's error handler.
+ *
+ * @param[in]   aXfer       The transfer whose next block step should run
+ */
+void BdxNode::ScheduleBlockAction(BDXTransfer &aXfer)
+{
+    // Already queued; the protocol just updated the step to run
+    VerifyOrExit(!aXfer.mIsWaiting, );
+
+    if (mMaxByteRate == 0)
+    {
+        RunBlockAction(aXfer);
+        ExitNow();
+    }
+
+    RefillTokens();
+
+    // Don't let a newcomer overtake transfers that are already waiting
+    if (mTokens > 0 && !HasWaitingTransfers())
+    {
+        RunBlockAction(aXfer);
+        ExitNow();
+    }
+
+    aXfer.mIsWaiting = true;
+    aXfer.mQueueSeq = mNextQueueSeq++;
+    aXfer.mNumDeferrals++;
+
+    ServiceWaitingTransfers();
+
+exit:
+    return;
+}
+
+/**
+ * @brief
+ *  Reserves room for aXfer's blocks in the node's memory budget
+ *  (WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES), shrinking its window to fit.
+ *  Any reservation aXfer already holds is replaced, so this is called again
+ *  once the accept has negotiated the block size.
+ *
+ * @param[in]   aXfer       The transfer being initiated or accepted
+ *
+ * @retval      #WEAVE_NO_ERROR         If the transfer fits in the budget
+ * @retval      #WEAVE_ERROR_NO_MEMORY  If not even a single block fits
+ */
+WEAVE_ERROR BdxNode::ReserveBuffers(BDXTransfer &aXfer)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+#if WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES > 0
+    uint32_t reserved = 0;
+    uint32_t available;
+    uint32_t blockSize = (aXfer.mMaxBlockSize > 0) ? aXfer.mMaxBlockSize : 1;
+    uint32_t numBlocks;
+
+    aXfer.mBufferReservation = 0;
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        if (mTransferPool[i].mIsInitiated)
+        {
+            reserved += mTransferPool[i].mBufferReservation;
+        }
+    }
+
+    available = (reserved < WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES) ? (WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES - reserved) : 0;
+    VerifyOrExit(blockSize <= available,
+                 err = WEAVE_ERROR_NO_MEMORY;
+                 WeaveLogDetail(BDX, "Not enough BDX buffer budget for a %u byte block (%u available)",
+                                static_cast<unsigned>(blockSize), static_cast<unsigned>(available)));
+
+    // Give a windowed transfer as many blocks as the budget still allows
+    if (aXfer.mMaxWindowSize > available / blockSize)
+    {
+        aXfer.mMaxWindowSize = static_cast<uint8_t>(available / blockSize);
+    }
+
+    numBlocks = aXfer.IsWindowingSupported() ? aXfer.mMaxWindowSize : 1;
+    aXfer.mBufferReservation = blockSize * numBlocks;
+
+exit:
+#endif // WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES > 0
+
+    return err;
+}
+
+/**
+ * Number of bytes the rate budget may accumulate while nothing is waiting:
+ * what it earns in one scheduler interval.
+ */
+uint32_t BdxNode::GetBurstBytes(void)
+{
+    uint64_t burst = (static_cast<uint64_t>(mMaxByteRate) * WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC) / 1000;
+
+    return (burst > 0) ? static_cast<uint32_t>(burst) : 1;
+}
+
+/**
+ * Credits the rate budget with the bytes earned since the last refill.
+ */
+void BdxNode::RefillTokens(void)
+{
+    uint64_t now = System::Layer::GetClock_MonotonicMS();
+    uint64_t earned;
+
+    if (mMaxByteRate == 0)
+    {
+        mLastRefillTime = now;
+        return;
+    }
+
+    earned = ((now - mLastRefillTime) * mMaxByteRate) / 1000;
+
+    // Keep the remainder of a partially earned byte for the next refill
+    if (earned > 0)
+    {
+        mTokens += static_cast<int64_t>(earned);
+        mLastRefillTime = now;
+    }
+
+    if (mTokens > static_cast<int64_t>(GetBurstBytes()))
+    {
+        mTokens = GetBurstBytes();
+    }
+}
+
+bool BdxNode::HasWaitingTransfers(void)
+{
+    return GetNextWaitingTransfer() != NULL;
+}
+
+/**
+ * Returns the waiting transfer whose peer has been served the fewest bytes,
+ * breaking ties in the order the transfers started waiting.
+ */
+BDXTransfer *BdxNode::GetNextWaitingTransfer(void)
+{
+    BDXTransfer *next = NULL;
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        BDXTransfer &xfer = mTransferPool[i];
+
+        if (!xfer.mIsInitiated || !xfer.mIsWaiting)
+        {
+            continue;
+        }
+
+        if (next == NULL ||
+            xfer.mPeerServedBytes < next->mPeerServedBytes ||
+            (xfer.mPeerServedBytes == next->mPeerServedBytes &&
+             static_cast<int32_t>(xfer.mQueueSeq - next->mQueueSeq) < 0))
+        {
+            next = &xfer;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * Runs the transfer's pending block step and charges what it sent (or let
+ * the peer send) to the rate budget.
+ */
+void BdxNode::RunBlockAction(BDXTransfer &aXfer)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    WEAVE_ERROR (*action)(BDXTransfer &) = aXfer.mNext;
+
+    aXfer.mIsWaiting = false;
+    aXfer.mNext = NULL;
+
+    if (action != NULL)
+    {
+        err = action(aXfer);
+    }
+
+    ChargeTransfer(aXfer);
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        aXfer.DispatchErrorHandler(err);
+    }
+}
+
+/**
+ * Charges the bytes aXfer transferred since it was last charged to the rate
+ * budget and to the fair share of its peer.  Blocks are charged once they are
+ * transferred, so a step that moves a block may leave the budget in debt.
+ */
+void BdxNode::ChargeTransfer(BDXTransfer &aXfer)
+{
+    uint64_t bytes;
+    uint64_t peer;
+
+    // The step may have completed or aborted the transfer
+    VerifyOrExit(aXfer.mIsInitiated && aXfer.mExchangeContext != NULL, );
+    VerifyOrExit(aXfer.mBytesTransferred > aXfer.mScheduledBytes, );
+
+    bytes = aXfer.mBytesTransferred - aXfer.mScheduledBytes;
+    aXfer.mScheduledBytes = aXfer.mBytesTransferred;
+
+    VerifyOrExit(mMaxByteRate != 0, );
+
+    mTokens -= static_cast<int64_t>(bytes);
+
+    peer = aXfer.mExchangeContext->PeerNodeId;
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        BDXTransfer &xfer = mTransferPool[i];
+
+        if (xfer.mIsInitiated && xfer.mExchangeContext != NULL && xfer.mExchangeContext->PeerNodeId == peer)
+        {
+            xfer.mPeerServedBytes += bytes;
+        }
+    }
+
+    mVirtualTime = aXfer.mPeerServedBytes;
+
+exit:
+    return;
+}
+
+/**
+ * Serves waiting transfers while the rate budget allows, then arms the
+ * scheduler timer for when the budget will be positive again.
+ */
+void BdxNode::ServiceWaitingTransfers(void)
+{
+    BDXTransfer *xfer;
+    uint64_t delay;
+
+    RefillTokens();
+
+    while ((mMaxByteRate == 0 || mTokens > 0) && (xfer = GetNextWaitingTransfer()) != NULL)
+    {
+        RunBlockAction(*xfer);
+    }
+
+    VerifyOrExit(mExchangeMgr != NULL && HasWaitingTransfers(), );
+
+    delay = ((static_cast<uint64_t>(1 - mTokens) * 1000) + mMaxByteRate - 1) / mMaxByteRate;
+    if (delay < WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC)
+    {
+        delay = WEAVE_CONFIG_BDX_SCHEDULER_MIN_INTERVAL_MSEC;
+    }
+
+    mExchangeMgr->MessageLayer->SystemLayer->StartTimer(static_cast<uint32_t>(delay), HandleSchedulerTimeout, this);
+
+exit:
+    return;
+}
+
+void BdxNode::HandleSchedulerTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError)
+{
+    BdxNode *node = static_cast<BdxNode *>(aAppState);
+
+    node->ServiceWaitingTransfers();
+}
+
 #if WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT
 /**
  * @brief
@@ -490,6 +880,17 @@ WEAVE_ERROR BdxNode::InitBdxReceive(BDXTransfer &aXfer, bool aICanDrive, bool aU
     aXfer.mAmInitiator = true;
     aXfer.mAmSender = false;
 
+    // Hold room for the proposed block size; the accept may settle on a smaller one
+    err = ReserveBuffers(aXfer);
+    SuccessOrExit(err);
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    if (aXfer.mIsResumable)
+    {
+        aXfer.StartCheckpointing();
+    }
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     // Arrange for messages in this exchange to go to our response handler.
     // NOTE: we may want to set different handlers for e.g., Receive, Send in the future
     aXfer.mExchangeContext->OnMessageReceived = BdxProtocol::HandleResponse;
@@ -533,6 +934,10 @@ WEAVE_ERROR BdxNode::InitBdxSend(BDXTransfer &aXfer, bool aICanDrive, bool aUCan
     aXfer.mAmInitiator = true;
     aXfer.mAmSender = true;
 
+    // Hold room for the proposed block size; the accept may settle on a smaller one
+    err = ReserveBuffers(aXfer);
+    SuccessOrExit(err);
+
     // Arrange for messages in this exchange to go to our response handler.
     aXfer.mExchangeContext->OnMessageReceived = BdxProtocol::HandleResponse;
 
@@ -575,6 +980,10 @@ WEAVE_ERROR BdxNode::InitBdxSend(BDXTransfer &aXfer, bool aICanDrive, bool aUCan
     aXfer.mAmInitiator = true;
     aXfer.mAmSender = true;
 
+    // Hold room for the proposed block size; the accept may settle on a smaller one
+    err = ReserveBuffers(aXfer);
+    SuccessOrExit(err);
+
     // Arrange for messages in this exchange to go to our response handler.
     aXfer.mExchangeContext->OnMessageReceived = BdxProtocol::HandleResponse;
 
@@ -744,6 +1153,13 @@ void BdxNode::HandleReceiveInit(ExchangeContext *anEc, const IPPacketInfo *aPktI
         //TODO: merge this up one line when async supported: && !receiveInit.mAsynchronousModeSupported)
                  err = WEAVE_ERROR_INVALID_TRANSFER_MODE; statusCode = kStatus_ServerBadState);
 
+    // Only accept what fits in the node's buffer budget
+    err = bdxApp->ReserveBuffers(*xfer);
+    VerifyOrExit(err == WEAVE_NO_ERROR, statusCode = kStatus_ServerBadState);
+
+    // Keep several blocks in flight if both of us can
+    xfer->NegotiateWindowing(receiveInit.mWindowedModeSupported);
+
     // TODO: validate max block size?  anything else?
     WeaveLogDetail(BDX, "HandleReceiveInit validated request\n");
 
@@ -883,6 +1299,13 @@ void BdxNode::HandleSendInit(ExchangeContext *anEc, const IPPacketInfo *aPktInfo
         //TODO: merge this up one line when async supported: && !sendInit.mAsynchronousModeSupported)
                  err = WEAVE_ERROR_INVALID_TRANSFER_MODE; statusCode = kStatus_ServerBadState);
 
+    // Only accept what fits in the node's buffer budget
+    err = bdxApp->ReserveBuffers(*xfer);
+    VerifyOrExit(err == WEAVE_NO_ERROR, statusCode = kStatus_ServerBadState);
+
+    // Keep several blocks in flight if both of us can
+    xfer->NegotiateWindowing(sendInit.mWindowedModeSupported);
+
     WeaveLogDetail(BDX, "HandleSendInit validated request\n");
 
     err = SendSendAccept(anEc, xfer);
@@ -1000,9 +1423,10 @@ WEAVE_ERROR BdxNode::SendReceiveAccept(ExchangeContext *anEc, BDXTransfer *aXfer
     ReceiveAccept   receiveAccept;
     PacketBuffer*   payload         = NULL;
     uint16_t        flags;
+    uint8_t         transferMode    = aXfer->mTransferMode | (aXfer->mIsWindowed ? kMode_Windowed : 0);
 
     // Send a ReceiveAccept response back to the receiver.
-    err = receiveAccept.init(aXfer->mVersion, aXfer->mTransferMode, aXfer->mMaxBlockSize, aXfer->mLength, NULL);
+    err = receiveAccept.init(aXfer->mVersion, transferMode, aXfer->mMaxBlockSize, aXfer->mLength, NULL);
     VerifyOrExit(err == WEAVE_NO_ERROR,
                  WeaveLogDetail(BDX, "SendReceiveAccept error calling Init on receiveAccept: %d", err));
 
@@ -1066,9 +1490,11 @@ WEAVE_ERROR BdxNode::SendSendAccept(ExchangeContext *anEc, BDXTransfer *aXfer)
     SendAccept      sendAccept;
     PacketBuffer*   payload     = NULL;
     uint16_t        flags;
+    uint8_t         transferMode = aXfer->mTransferMode | (aXfer->mIsWindowed ? kMode_Windowed : 0);
 
     // Send a ReceiveAccept response back to the receiver.
-    err = sendAccept.init(aXfer->mVersion, aXfer->mTransferMode, aXfer->mMaxBlockSize, NULL);
+    err = sendAccept.init(aXfer->mVersion, transferMode, aXfer->mMaxBlockSize,
+                          aXfer->mAcceptMetaData.isEmpty() ? NULL : &aXfer->mAcceptMetaData);
     VerifyOrExit(err == WEAVE_NO_ERROR,
                  WeaveLogDetail(BDX, "SendSendAccept error calling Init on sendAccept: %d", err));
 
@@ -66,6 +66,8 @@ namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesigna
 // their code for a device not meant to support them.
 class NL_DLL_EXPORT BdxNode
 {
+    friend class BdxSchedulerTest;
+
 public:
 
     /** Default constructor that sets all members to NULL. Don't try to do anything
@@ -92,6 +94,18 @@ public:
 
     bool IsInitialized(void);
 
+    void SetMaxByteRate(uint32_t aBytesPerSec);
+
+    uint32_t GetMaxByteRate(void);
+
+    uint16_t GetNumActiveTransfers(void);
+
+    WEAVE_ERROR GetTransferStats(uint16_t aIndex, BDXTransferStats &aStats);
+
+    void ScheduleBlockAction(BDXTransfer &aXfer);
+
+    WEAVE_ERROR ReserveBuffers(BDXTransfer &aXfer);
+
     WEAVE_ERROR InitBdxReceive(BDXTransfer &aXfer, bool aICanDrive, bool aUCanDrive,
                                bool aAsyncOk, ReferencedTLVData *aMetaData);
 
@@ -123,8 +137,24 @@ private:
 
     WEAVE_ERROR InitTransfer(ExchangeContext *anEc, BDXTransfer * &aXfer);
 
+    uint32_t GetBurstBytes(void);
+    void RefillTokens(void);
+    bool HasWaitingTransfers(void);
+    BDXTransfer *GetNextWaitingTransfer(void);
+    void RunBlockAction(BDXTransfer &aXfer);
+    void ChargeTransfer(BDXTransfer &aXfer);
+    void ServiceWaitingTransfers(void);
+    static void HandleSchedulerTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError);
+
     WeaveExchangeManager *mExchangeMgr;
 
+    // Byte-rate budget shared by all transfers, see WEAVE_CONFIG_BDX_MAX_BYTES_PER_SEC
+    uint32_t mMaxByteRate;                   // 0 if block steps are not rate limited
+    int64_t mTokens;                         // Bytes that may still be sent, negative when in debt
+    uint64_t mLastRefillTime;                // Monotonic time (ms) mTokens was last refilled
+    uint64_t mVirtualTime;                   // Peer served bytes of the transfer served last
+    uint32_t mNextQueueSeq;                  // Sequence number given to the next waiting transfer
+
     bool mIsBdxTransferAllowed;              // True when server is allowed to start transfers
     bool mInitialized;
 
@@ -31,6 +31,7 @@
 #include <Weave/Core/WeaveEncoding.h>
 #include <Weave/Core/WeaveServerBase.h>
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXProtocol.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXNode.h>
 #include <Weave/Support/WeaveFaultInjection.h>
 
 namespace nl {
@@ -78,6 +79,9 @@ WEAVE_ERROR InitBdxReceive(BDXTransfer &aXfer, bool aICanDrive, bool aUCanDrive,
         SuccessOrExit(err);
     }
 
+    // Windowing only applies to sender drive transfers
+    msg.mWindowedModeSupported = msg.mSenderDriveSupported && aXfer.IsWindowingSupported();
+
     err = msg.pack(buffer);
     SuccessOrExit(err);
 
@@ -134,6 +138,9 @@ WEAVE_ERROR InitBdxSend(BDXTransfer &aXfer, bool aICanDrive, bool aUCanDrive,
         SuccessOrExit(err);
     }
 
+    // Windowing only applies to sender drive transfers
+    msg.mWindowedModeSupported = msg.mSenderDriveSupported && aXfer.IsWindowingSupported();
+
     err = msg.pack(buffer);
     SuccessOrExit(err);
 
@@ -190,6 +197,9 @@ WEAVE_ERROR InitBdxSend(BDXTransfer &aXfer, bool aICanDrive, bool aUCanDrive,
         SuccessOrExit(err);
     }
 
+    // Windowing only applies to sender drive transfers
+    msg.mWindowedModeSupported = msg.mSenderDriveSupported && aXfer.IsWindowingSupported();
+
     err = msg.pack(buffer);
     SuccessOrExit(err);
 
@@ -281,6 +291,8 @@ WEAVE_ERROR SendBlockQueryV1(BDXTransfer &aXfer)
 
     flags = aXfer.GetDefaultFlags(true);
 
+    aXfer.mLastSendTime = System::Layer::GetClock_MonotonicMS();
+
     err = aXfer.mExchangeContext->SendMessage(kWeaveProfile_BDX, kMsgType_BlockQueryV1, buffer, flags);
     buffer = NULL;
 
@@ -461,6 +473,164 @@ exit:
     return err;
 }
 
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+/**
+ * @brief
+ *  This function sends a BlockWindowAckV1 message for the given windowed BDXTransfer.
+ *  It acknowledges every block before aXfer.mBlockCounter, selectively acknowledges
+ *  the blocks held out of order and advertises aXfer.mMaxWindowSize.
+ *
+ * @note
+ *   The message is sent without requesting a WRMP acknowledgement; the sender
+ *   retransmits blocks whose acknowledgement was lost and we answer duplicates
+ *   with a fresh BlockWindowAckV1.
+ *
+ * @param[in]       aXfer       The BDXTransfer we're sending a BlockWindowAckV1 for.
+ *
+ * @retval          #WEAVE_NO_ERROR         If we successfully sent the message.
+ * @retval          #WEAVE_ERROR_NO_MEMORY  If no available PacketBuffers.
+ */
+static WEAVE_ERROR SendBlockWindowAckV1(BDXTransfer &aXfer)
+{
+    WEAVE_ERROR         err             = WEAVE_NO_ERROR;
+    PacketBuffer*       buffer          = PacketBuffer::NewWithAvailableSize(BlockWindowAckV1::kPayloadLen);
+    BlockWindowAckV1    outMsg;
+    uint32_t            selectiveAcks   = 0;
+
+    VerifyOrExit(buffer != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    for (uint32_t i = 0; (i + 1) < aXfer.mMaxWindowSize; i++)
+    {
+        uint32_t counter = aXfer.mBlockCounter + 1 + i;
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[counter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+        if (slot.mBlock != NULL && slot.mBlockCounter == counter)
+        {
+            selectiveAcks |= (1UL << i);
+        }
+    }
+
+    SuccessOrExit(err = outMsg.init(aXfer.mBlockCounter, selectiveAcks, aXfer.mMaxWindowSize));
+    SuccessOrExit(err = outMsg.pack(buffer));
+
+    err = aXfer.mExchangeContext->SendMessage(kWeaveProfile_BDX, kMsgType_BlockWindowAckV1, buffer, 0);
+    buffer = NULL;
+
+exit:
+    if (buffer != NULL)
+    {
+        PacketBuffer::Free(buffer);
+    }
+
+    return err;
+}
+
+/**
+ * @brief
+ *  This function processes a BlockSendV1 or BlockEOFV1 received by the receiver of
+ *  a windowed transfer.  Blocks ahead of the next expected one are held in the
+ *  window until the missing blocks arrive; blocks are always handed to the
+ *  PutBlockHandler in order.
+ *
+ * @param[in]       aXfer           The windowed BDXTransfer
+ * @param[in]       aMessageType    kMsgType_BlockSendV1 or kMsgType_BlockEOFV1
+ * @param[in]       aPacketBuffer   The received message
+ *
+ * @return #WEAVE_NO_ERROR if successful, or an error from parsing the block
+ */
+static WEAVE_ERROR HandleWindowBlockV1(BDXTransfer &aXfer, uint8_t aMessageType, PacketBuffer *aPacketBuffer)
+{
+    WEAVE_ERROR     err     = WEAVE_NO_ERROR;
+    BlockSendV1     block;
+    uint32_t        offset;
+
+    err = BlockSendV1::parse(aPacketBuffer, block);
+    VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "Windowed block parse failed."));
+
+    offset = block.mBlockCounter - aXfer.mBlockCounter;
+
+    if (static_cast<int32_t>(offset) < 0)
+    {
+        // Duplicate of a block we already have, our acknowledgement was likely lost
+        aXfer.mNext = SendBlockWindowAckV1;
+        ExitNow();
+    }
+
+    if (offset >= aXfer.mMaxWindowSize)
+    {
+        WeaveLogDetail(BDX, "Received block counter: %d outside of window starting at: %d", block.mBlockCounter, aXfer.mBlockCounter);
+        aXfer.mNext = SendBadBlockCounterStatusReport;
+        ExitNow();
+    }
+
+    if (offset > 0)
+    {
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[block.mBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+        // Hold on to the block until the ones before it arrive
+        if (slot.mBlock == NULL)
+        {
+            aPacketBuffer->AddRef();
+            slot.mBlock = aPacketBuffer;
+            slot.mBlockCounter = block.mBlockCounter;
+            slot.mMsgType = aMessageType;
+        }
+
+        aXfer.mNext = SendBlockWindowAckV1;
+        ExitNow();
+    }
+
+    aXfer.RecordBlockTransferred(block.mLength);
+    aXfer.DispatchPutBlockHandler(block.mLength, block.mData, aMessageType == kMsgType_BlockEOFV1);
+
+    if (aMessageType == kMsgType_BlockEOFV1)
+    {
+        // SendBlockEOFAckV1 acknowledges mBlockCounter, i.e. this block
+        aXfer.mNext = SendBlockEOFAckV1;
+        ExitNow();
+    }
+
+    aXfer.mBlockCounter++;
+
+    // Deliver the blocks that were waiting for this one
+    while (true)
+    {
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[aXfer.mBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+        PacketBuffer *held = slot.mBlock;
+        BlockSendV1 heldBlock;
+        bool isLast;
+
+        if (held == NULL || slot.mBlockCounter != aXfer.mBlockCounter)
+        {
+            break;
+        }
+
+        slot.mBlock = NULL;
+        isLast = (slot.mMsgType == kMsgType_BlockEOFV1);
+
+        err = BlockSendV1::parse(held, heldBlock);
+        PacketBuffer::Free(held);
+        SuccessOrExit(err);
+
+        aXfer.RecordBlockTransferred(heldBlock.mLength);
+        aXfer.DispatchPutBlockHandler(heldBlock.mLength, heldBlock.mData, isLast);
+
+        if (isLast)
+        {
+            aXfer.mNext = SendBlockEOFAckV1;
+            ExitNow();
+        }
+
+        aXfer.mBlockCounter++;
+    }
+
+    aXfer.mNext = SendBlockWindowAckV1;
+
+exit:
+    return err;
+}
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
 #if WEAVE_CONFIG_BDX_V0_SUPPORT
 /**
  * @brief
@@ -509,6 +679,11 @@ WEAVE_ERROR SendNextBlock(BDXTransfer &aXfer)
     data += sizeof(counter);
     length = buffer->AvailableDataLength() - sizeof(counter);
 
+    if (length > aXfer.mMaxBlockSize)
+    {
+        length = aXfer.mMaxBlockSize;
+    }
+
     aXfer.DispatchGetBlockHandler(&length, &data, &isLast);
 
     // Ensure that we can fit the buffer within the PacketBuffer, fail
@@ -554,36 +729,53 @@ exit:
 
 /**
  * @brief
- *  This function sends the next BlockSendV1 retrieved by calling the BDXTransfer's
- *  GetBlockHandler.
+ *  Samples the round trip time of a stop-and-wait transfer when the response to
+ *  the last block or query we sent arrives.
  *
- * @param[in]       aXfer   The BDXTransfer whose GetBlockHandler is called to get the
- *                          next block before sending it using the associated ExchangeContext
+ * @param[in]       aXfer   The BDXTransfer that received the response
+ */
+static void RecordStopAndWaitRTT(BDXTransfer &aXfer)
+{
+    if (aXfer.mLastSendTime != 0)
+    {
+        aXfer.RecordRTTSample(static_cast<uint32_t>(System::Layer::GetClock_MonotonicMS() - aXfer.mLastSendTime));
+        aXfer.mLastSendTime = 0;
+    }
+}
+
+/**
+ * @brief
+ *  This function reads the next block from the BDXTransfer's GetBlockHandler and
+ *  packs it, preceded by the given block counter, into a new PacketBuffer.
+ *
+ * @param[in]       aXfer           The BDXTransfer whose GetBlockHandler is called
+ * @param[in]       aBlockCounter   The block counter to put in front of the data
+ * @param[out]      aBuffer         The packed block, owned by the caller on success
+ * @param[out]      aMsgType        kMsgType_BlockEOFV1 for the last block,
+ *                                  kMsgType_BlockSendV1 otherwise
  *
  * @retval          #WEAVE_ERROR_INCORRECT_STATE    If the GetBlockHandler is NULL
+ * @retval          #WEAVE_ERROR_NO_MEMORY          If no available PacketBuffers
  */
-WEAVE_ERROR SendNextBlockV1(BDXTransfer &aXfer)
+static WEAVE_ERROR ReadNextBlockV1(BDXTransfer &aXfer, uint32_t aBlockCounter, PacketBuffer *&aBuffer, uint8_t &aMsgType)
 {
     WEAVE_ERROR     err         = WEAVE_NO_ERROR;
     uint64_t        length;
     uint8_t*        data;
     bool            isLast;
-    uint8_t         msgType;
-    PacketBuffer*   buffer      = PacketBuffer::New();
-    uint16_t        flags;
+    PacketBuffer*   buffer      = NULL;
     uint32_t        blockCounter;
 
-    WeaveLogDetail(BDX, "Sending next block # %d\n", aXfer.mBlockCounter);
-
     VerifyOrExit(aXfer.mHandlers.mGetBlockHandler != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
 
+    buffer = PacketBuffer::New();
     VerifyOrExit(buffer != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // pack the message, no additional abstraction for now.
 
     data = buffer->Start();
 
-    blockCounter = aXfer.mBlockCounter;
+    blockCounter = aBlockCounter;
     WEAVE_FAULT_INJECT(FaultInjection::kFault_BDXBadBlockCounter, blockCounter++);
 
     nl::Weave::Encoding::LittleEndian::Write32(data, blockCounter);
@@ -614,17 +806,353 @@ WEAVE_ERROR SendNextBlockV1(BDXTransfer &aXfer)
 
     if (isLast)
     {
-        msgType = kMsgType_BlockEOFV1;
+        aMsgType = kMsgType_BlockEOFV1;
     }
     else
     {
-        msgType = kMsgType_BlockSendV1;
+        aMsgType = kMsgType_BlockSendV1;
     }
 
+    aXfer.RecordBlockTransferred(length);
+
+    aBuffer = buffer;
+    buffer = NULL;
+
+exit:
+    if (buffer != NULL)
+    {
+        PacketBuffer::Free(buffer);
+    }
+
+    return err;
+}
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+/**
+ * @brief
+ *  Returns the number of blocks a windowed sender may currently have outstanding,
+ *  the smaller of our own window and the one last advertised by the receiver.
+ */
+static uint32_t GetSendWindow(BDXTransfer &aXfer)
+{
+    uint32_t window = aXfer.mMaxWindowSize;
+
+    if (aXfer.mPeerWindowSize < window)
+    {
+        window = aXfer.mPeerWindowSize;
+    }
+
+    return (window > 0) ? window : 1;
+}
+
+/**
+ * @brief
+ *  (Re)arms the retransmission timer of a windowed sender.  The timeout is twice the
+ *  smoothed round trip time, bounded below by WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC
+ *  and doubled for every consecutive timeout.
+ */
+static void StartWindowRetransmitTimer(BDXTransfer &aXfer)
+{
+    uint32_t timeout = 2 * aXfer.mSmoothedRTT;
+
+    if (timeout < WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC)
+    {
+        timeout = WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC;
+    }
+
+    timeout <<= (aXfer.mNumTimeouts < 4) ? aXfer.mNumTimeouts : 4;
+
+    aXfer.mExchangeContext->ExchangeMgr->MessageLayer->SystemLayer->StartTimer(timeout, HandleWindowRetransmitTimeout, &aXfer);
+}
+
+/**
+ * @brief
+ *  This function (re)transmits an outstanding block of a windowed transfer from
+ *  the copy kept in its window slot.
+ *
+ * @note
+ *   Blocks are sent without requesting a WRMP acknowledgement since the
+ *   BlockWindowAckV1 messages and the retransmission timer provide reliability
+ *   for the whole window.
+ *
+ * @param[in]       aXfer           The windowed BDXTransfer
+ * @param[in]       aBlockCounter   The counter of the outstanding block to send
+ *
+ * @retval          #WEAVE_NO_ERROR         If we successfully sent the message.
+ * @retval          #WEAVE_ERROR_NO_MEMORY  If no available PacketBuffers.
+ */
+static WEAVE_ERROR SendWindowBlockV1(BDXTransfer &aXfer, uint32_t aBlockCounter)
+{
+    WEAVE_ERROR                 err     = WEAVE_NO_ERROR;
+    BDXTransfer::WindowSlot &   slot    = aXfer.mWindow[aBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+    PacketBuffer*               buffer  = NULL;
+
+    VerifyOrExit(slot.mBlock != NULL && slot.mBlockCounter == aBlockCounter, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    // The message layer encodes and encrypts in place, so always send a copy
+    buffer = PacketBuffer::New();
+    VerifyOrExit(buffer != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    VerifyOrExit(slot.mBlock->DataLength() <= buffer->AvailableDataLength(), err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    memcpy(buffer->Start(), slot.mBlock->Start(), slot.mBlock->DataLength());
+    buffer->SetDataLength(slot.mBlock->DataLength());
+
+    slot.mSentTime = System::Layer::GetClock_MonotonicMS();
+
+    err = aXfer.mExchangeContext->SendMessage(kWeaveProfile_BDX, slot.mMsgType, buffer, ExchangeContext::kSendFlag_ExpectResponse);
+    buffer = NULL;
+
+exit:
+    if (buffer != NULL)
+    {
+        PacketBuffer::Free(buffer);
+    }
+
+    return err;
+}
+
+/**
+ * @brief
+ *  This function fills the send window of a windowed transfer with new blocks
+ *  retrieved from the BDXTransfer's GetBlockHandler, then rearms the
+ *  retransmission timer.
+ *
+ * @param[in]       aXfer   The windowed BDXTransfer
+ *
+ * @retval          #WEAVE_ERROR_INCORRECT_STATE    If the GetBlockHandler is NULL
+ */
+static WEAVE_ERROR SendNextBlocksWindowV1(BDXTransfer &aXfer)
+{
+    WEAVE_ERROR     err     = WEAVE_NO_ERROR;
+    uint32_t        window  = GetSendWindow(aXfer);
+
+    while (!aXfer.mEOFQueued && (aXfer.mNextBlockCounter - aXfer.mBlockCounter) < window)
+    {
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[aXfer.mNextBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+        WeaveLogDetail(BDX, "Sending next block # %d (window %d)\n", aXfer.mNextBlockCounter, window);
+
+        err = ReadNextBlockV1(aXfer, aXfer.mNextBlockCounter, slot.mBlock, slot.mMsgType);
+        SuccessOrExit(err);
+
+        slot.mBlockCounter = aXfer.mNextBlockCounter;
+        slot.mRetransmitted = false;
+
+        if (slot.mMsgType == kMsgType_BlockEOFV1)
+        {
+            aXfer.mEOFQueued = true;
+            aXfer.mEOFBlockCounter = aXfer.mNextBlockCounter;
+        }
+
+        aXfer.mNextBlockCounter++;
+
+        err = SendWindowBlockV1(aXfer, slot.mBlockCounter);
+        SuccessOrExit(err);
+    }
+
+    if (aXfer.mNextBlockCounter != aXfer.mBlockCounter)
+    {
+        StartWindowRetransmitTimer(aXfer);
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * @brief
+ *  Handler for the retransmission timer of a windowed sender.  Resends the oldest
+ *  outstanding block, which no acknowledgement has covered for a full timeout,
+ *  and gives up with WEAVE_ERROR_TIMEOUT after WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS
+ *  consecutive timeouts.
+ *
+ * @param[in]   aSystemLayer    The system layer that fired the timer
+ * @param[in]   aAppState       The windowed BDXTransfer
+ * @param[in]   aError          Unused
+ */
+void HandleWindowRetransmitTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError)
+{
+    BDXTransfer *xfer = static_cast<BDXTransfer *>(aAppState);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(xfer->mIsWindowed && xfer->mExchangeContext != NULL && xfer->mNextBlockCounter != xfer->mBlockCounter, );
+
+    if (++xfer->mNumTimeouts > WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS)
+    {
+        WeaveLogDetail(BDX, "Block # %d was not acknowledged after %d retransmissions", xfer->mBlockCounter, WEAVE_CONFIG_BDX_WINDOW_MAX_RETRANSMITS);
+        xfer->ReleaseWindow();
+        ExitNow(err = WEAVE_ERROR_TIMEOUT);
+    }
+
+    WeaveLogDetail(BDX, "Retransmitting block # %d", xfer->mBlockCounter);
+
+    xfer->mWindow[xfer->mBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE].mRetransmitted = true;
+    xfer->mNumRetransmits++;
+
+    err = SendWindowBlockV1(*xfer, xfer->mBlockCounter);
+    SuccessOrExit(err);
+
+    StartWindowRetransmitTimer(*xfer);
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        xfer->DispatchErrorHandler(err);
+    }
+}
+
+/**
+ * @brief
+ *  This function processes a BlockWindowAckV1 received by a windowed sender: it
+ *  releases the acknowledged blocks, samples the round trip time from blocks that
+ *  were only sent once, retransmits the holes reported by the selective
+ *  acknowledgements and slides the window forward.
+ *
+ * @param[in]       aXfer   The windowed BDXTransfer
+ * @param[in]       aAck    The acknowledgement received from the receiver
+ */
+static void HandleBlockWindowAckV1(BDXTransfer &aXfer, const BlockWindowAckV1 &aAck)
+{
+    WEAVE_ERROR err             = WEAVE_NO_ERROR;
+    uint64_t    now             = System::Layer::GetClock_MonotonicMS();
+    uint32_t    outstanding     = aXfer.mNextBlockCounter - aXfer.mBlockCounter;
+    uint32_t    acked           = aAck.mBlockCounter - aXfer.mBlockCounter;
+    uint32_t    retransmitAge   = (aXfer.mSmoothedRTT != 0) ? aXfer.mSmoothedRTT : WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC;
+    uint32_t    highestAcked    = aAck.mBlockCounter;
+    bool        haveSelective   = false;
+
+    if (acked > outstanding)
+    {
+        WeaveLogDetail(BDX, "Received BlockWindowAckV1 for block counter: %d, expected between %d and %d",
+                       aAck.mBlockCounter, aXfer.mBlockCounter, aXfer.mNextBlockCounter);
+
+        // Acks for old blocks may be duplicated or reordered; only acks for blocks
+        // we never sent are an error.
+        if (static_cast<int32_t>(aAck.mBlockCounter - aXfer.mBlockCounter) > 0)
+        {
+            aXfer.mNext = SendBadBlockCounterStatusReport;
+        }
+
+        ExitNow();
+    }
+
+    aXfer.mPeerWindowSize = aAck.mWindowSize;
+
+    // Cumulative acknowledgement: everything before aAck.mBlockCounter arrived
+    for (; aXfer.mBlockCounter != aAck.mBlockCounter; aXfer.mBlockCounter++)
+    {
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[aXfer.mBlockCounter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+        if (slot.mBlock != NULL)
+        {
+            if (!slot.mRetransmitted)
+            {
+                aXfer.RecordRTTSample(static_cast<uint32_t>(now - slot.mSentTime));
+            }
+
+            PacketBuffer::Free(slot.mBlock);
+            slot.mBlock = NULL;
+        }
+
+        aXfer.mNumTimeouts = 0;
+    }
+
+    // Selective acknowledgements for blocks received past the first missing one
+    for (uint32_t i = 0; i < 32 && (i + 1) < (aXfer.mNextBlockCounter - aAck.mBlockCounter); i++)
+    {
+        uint32_t counter = aAck.mBlockCounter + 1 + i;
+        BDXTransfer::WindowSlot &slot = aXfer.mWindow[counter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+        if ((aAck.mSelectiveAcks & (1UL << i)) == 0)
+        {
+            continue;
+        }
+
+        haveSelective = true;
+        highestAcked = counter;
+
+        if (slot.mBlock != NULL && slot.mBlockCounter == counter)
+        {
+            if (!slot.mRetransmitted)
+            {
+                aXfer.RecordRTTSample(static_cast<uint32_t>(now - slot.mSentTime));
+            }
+
+            PacketBuffer::Free(slot.mBlock);
+            slot.mBlock = NULL;
+        }
+    }
+
+    // Blocks missing below the highest one received were most likely lost; resend
+    // only those, and at most once per round trip.
+    if (haveSelective)
+    {
+        for (uint32_t counter = aXfer.mBlockCounter; counter != highestAcked; counter++)
+        {
+            BDXTransfer::WindowSlot &slot = aXfer.mWindow[counter % WEAVE_CONFIG_BDX_WINDOW_SIZE];
+
+            if (slot.mBlock == NULL || (now - slot.mSentTime) < retransmitAge)
+            {
+                continue;
+            }
+
+            WeaveLogDetail(BDX, "Retransmitting missing block # %d", counter);
+
+            slot.mRetransmitted = true;
+            aXfer.mNumRetransmits++;
+
+            err = SendWindowBlockV1(aXfer, counter);
+            SuccessOrExit(err);
+        }
+    }
+
+    // Refill the window and rearm the retransmission timer
+    aXfer.mNext = SendNextBlockV1;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        aXfer.DispatchErrorHandler(err);
+    }
+}
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
+/**
+ * @brief
+ *  This function sends the next BlockSendV1 retrieved by calling the BDXTransfer's
+ *  GetBlockHandler.  In a windowed transfer, it sends as many new blocks as the
+ *  window allows.
+ *
+ * @param[in]       aXfer   The BDXTransfer whose GetBlockHandler is called to get the
+ *                          next block before sending it using the associated ExchangeContext
+ *
+ * @retval          #WEAVE_ERROR_INCORRECT_STATE    If the GetBlockHandler is NULL
+ */
+WEAVE_ERROR SendNextBlockV1(BDXTransfer &aXfer)
+{
+    WEAVE_ERROR     err         = WEAVE_NO_ERROR;
+    PacketBuffer*   buffer      = NULL;
+    uint8_t         msgType;
+    uint16_t        flags;
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+    if (aXfer.mIsWindowed)
+    {
+        return SendNextBlocksWindowV1(aXfer);
+    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
+    WeaveLogDetail(BDX, "Sending next block # %d\n", aXfer.mBlockCounter);
+
+    err = ReadNextBlockV1(aXfer, aXfer.mBlockCounter, buffer, msgType);
+    SuccessOrExit(err);
+
     // TODO: for async aXfer, don't expect response. For now, we always expect an ACK or
     // another BlockQuery
     flags = aXfer.GetDefaultFlags(true);
 
+    aXfer.mLastSendTime = System::Layer::GetClock_MonotonicMS();
+
     err = aXfer.mExchangeContext->SendMessage(kWeaveProfile_BDX, msgType, buffer, flags);
     buffer = NULL;
 
@@ -637,6 +1165,26 @@ exit:
     return err;
 }
 
+/**
+ * @brief
+ *  Returns true if aAction moves file data, i.e. sends blocks or lets the peer
+ *  send the next ones, and should therefore be paced by the BdxNode's
+ *  byte-rate budget.
+ *
+ * @param[in]   aAction     A next action of a transfer
+ */
+static bool IsBlockAction(WEAVE_ERROR (*aAction)(BDXTransfer &))
+{
+    return (aAction == SendNextBlockV1 || aAction == SendBlockQueryV1 || aAction == SendBlockAckV1
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+            || aAction == SendBlockWindowAckV1
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+#if WEAVE_CONFIG_BDX_V0_SUPPORT
+            || aAction == SendNextBlock || aAction == SendBlockQuery || aAction == SendBlockAck
+#endif // WEAVE_CONFIG_BDX_V0_SUPPORT
+            );
+}
+
 /**
  * @brief
  *  The main handler for messages arriving on the BDX exchange.  It essentially
@@ -660,8 +1208,12 @@ void HandleResponse(ExchangeContext *anEc, const IPPacketInfo *aPktInfo, const W
     VerifyOrExit(aProfileId == kWeaveProfile_BDX || (aProfileId == kWeaveProfile_Common && aMessageType == Common::kMsgType_StatusReport), err = WEAVE_ERROR_INVALID_PROFILE_ID);
     VerifyOrExit(xfer->mIsInitiated, err = WEAVE_ERROR_INCORRECT_STATE);
 
-    // (Re-)Initialize the next action to take
-    xfer->mNext = NULL;
+    // (Re-)Initialize the next action to take, unless a block step is still
+    // waiting for the node's byte-rate budget
+    if (!xfer->mIsWaiting)
+    {
+        xfer->mNext = NULL;
+    }
 
     if (xfer->mIsAccepted)
     {
@@ -688,8 +1240,18 @@ void HandleResponse(ExchangeContext *anEc, const IPPacketInfo *aPktInfo, const W
 
     if (xfer->mNext)
     {
-        err = xfer->mNext(*xfer);
-        xfer->mNext = NULL;
+        if (xfer->mNode != NULL && IsBlockAction(xfer->mNext))
+        {
+            // The node runs the step now or once this transfer's turn comes
+            // up, and reports any error itself
+            xfer->mNode->ScheduleBlockAction(*xfer);
+        }
+        else
+        {
+            xfer->mIsWaiting = false;
+            err = xfer->mNext(*xfer);
+            xfer->mNext = NULL;
+        }
     }
 
 exit:
@@ -925,6 +1487,8 @@ WEAVE_ERROR HandleResponseTransmit(BDXTransfer &aXfer, uint32_t aProfileId, uint
 
                     if (rcvdCounter == aXfer.mBlockCounter)
                     {
+                        RecordStopAndWaitRTT(aXfer);
+
                         // Update the counter and send the next block
                         aXfer.mBlockCounter++;
                         aXfer.mNext = SendNextBlockV1;
@@ -944,6 +1508,22 @@ WEAVE_ERROR HandleResponseTransmit(BDXTransfer &aXfer, uint32_t aProfileId, uint
 
                 break;
 
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+            case kMsgType_BlockWindowAckV1:
+                {
+                    BlockWindowAckV1 windowAck;
+
+                    VerifyOrExit(aXfer.mIsWindowed && aXfer.IsDriver(), err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
+
+                    err = BlockWindowAckV1::parse(aPacketBuffer, windowAck);
+                    VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "BlockWindowAckV1 parse failed."));
+
+                    HandleBlockWindowAckV1(aXfer, windowAck);
+                }
+
+                break;
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
 #if WEAVE_CONFIG_BDX_V0_SUPPORT
             case kMsgType_BlockQuery:
                 {
@@ -1002,6 +1582,8 @@ WEAVE_ERROR HandleResponseTransmit(BDXTransfer &aXfer, uint32_t aProfileId, uint
                     // Afterwards, check that the received counter is the one after our block counter
                     else if (rcvdCounter == aXfer.mBlockCounter + 1)
                     {
+                        RecordStopAndWaitRTT(aXfer);
+
                         // Increment block counter after verifying block query message + block counter if it isn't the first query
                         // This is because we need to stay on the same block counter if the receiver decides to send an ack
                         // Ex. Recv BlockQuery for #2, send Block #2, get ack back for #2. Need to have block counter on
@@ -1046,6 +1628,17 @@ WEAVE_ERROR HandleResponseTransmit(BDXTransfer &aXfer, uint32_t aProfileId, uint
 
                     rcvdCounter = EOFAckV1.mBlockCounter;
 
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+                    // The receiver of a windowed transfer only acknowledges the
+                    // BlockEOFV1 once every earlier block arrived, so the whole
+                    // window is acknowledged even if BlockWindowAckV1s were lost.
+                    if (aXfer.mIsWindowed && aXfer.mEOFQueued && rcvdCounter == aXfer.mEOFBlockCounter)
+                    {
+                        aXfer.ReleaseWindow();
+                        aXfer.mBlockCounter = rcvdCounter;
+                    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
                     if (rcvdCounter == aXfer.mBlockCounter)
                     {
                         aXfer.mIsCompletedSuccessfully = true;
@@ -1137,6 +1730,15 @@ WEAVE_ERROR HandleResponseReceive(BDXTransfer &aXfer, uint32_t aProfileId, uint8
             case kMsgType_BlockSendV1:
                 {
                     BlockSendV1 blockSendV1;
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+                    if (aXfer.mIsWindowed)
+                    {
+                        err = HandleWindowBlockV1(aXfer, aMessageType, aPacketBuffer);
+                        break;
+                    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
                     err = BlockSendV1::parse(aPacketBuffer, blockSendV1);
                     VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "BlockSendV1 parse failed."));
 
@@ -1144,6 +1746,8 @@ WEAVE_ERROR HandleResponseReceive(BDXTransfer &aXfer, uint32_t aProfileId, uint8
 
                     if (rcvdCounter == aXfer.mBlockCounter)
                     {
+                        RecordStopAndWaitRTT(aXfer);
+                        aXfer.RecordBlockTransferred(blockSendV1.mLength);
                         aXfer.DispatchPutBlockHandler(blockSendV1.mLength, blockSendV1.mData, false);
                     }
 
@@ -1195,6 +1799,15 @@ WEAVE_ERROR HandleResponseReceive(BDXTransfer &aXfer, uint32_t aProfileId, uint8
             case kMsgType_BlockEOFV1:
                 {
                     BlockEOFV1 blockEOFV1;
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+                    if (aXfer.mIsWindowed)
+                    {
+                        err = HandleWindowBlockV1(aXfer, aMessageType, aPacketBuffer);
+                        break;
+                    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
                     err = BlockEOFV1::parse(aPacketBuffer, blockEOFV1);
                     VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "BlockEOFV1 parse failed."));
 
@@ -1202,6 +1815,8 @@ WEAVE_ERROR HandleResponseReceive(BDXTransfer &aXfer, uint32_t aProfileId, uint8
 
                     if (rcvdCounter == aXfer.mBlockCounter)
                     {
+                        RecordStopAndWaitRTT(aXfer);
+                        aXfer.RecordBlockTransferred(blockEOFV1.mLength);
                         aXfer.DispatchPutBlockHandler(blockEOFV1.mLength, blockEOFV1.mData, true);
                     }
 
@@ -1293,6 +1908,7 @@ WEAVE_ERROR HandleResponseNotAccepted(BDXTransfer &aXfer, uint32_t aProfileId, u
                  */
                 {
                     uint8_t xferMode;
+                    bool windowed;
                     SendAccept inMsg;
 
                     err = SendAccept::parse(aPacketBuffer, inMsg);
@@ -1302,10 +1918,24 @@ WEAVE_ERROR HandleResponseNotAccepted(BDXTransfer &aXfer, uint32_t aProfileId, u
                                  err = WEAVE_ERROR_UNSUPPORTED_MESSAGE_VERSION;
                                  WeaveLogDetail(BDX, "SendAccept returned an incompatible version: %d.", inMsg.mVersion));
 
+                    windowed = (inMsg.mTransferMode & kMode_Windowed) != 0;
+
                     aXfer.mIsAccepted = true;
                     aXfer.mMaxBlockSize = inMsg.mMaxBlockSize;
+                    // Windowing is confirmed alongside the transfer mode; keep it out
+                    // of mTransferMode so callers see one of the kMode_* values.
+                    inMsg.mTransferMode &= ~kMode_Windowed;
                     aXfer.mTransferMode = inMsg.mTransferMode;
                     aXfer.mVersion = inMsg.mVersion;
+
+                    // The reservation made at init time assumed our proposed block size
+                    if (aXfer.mNode != NULL)
+                    {
+                        err = aXfer.mNode->ReserveBuffers(aXfer);
+                        SuccessOrExit(err);
+                    }
+
+                    aXfer.NegotiateWindowing(windowed);
                     err = aXfer.DispatchSendAccept(&inMsg);
                     VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "DispatchSendAccept failed."));
 
@@ -1365,6 +1995,7 @@ WEAVE_ERROR HandleResponseNotAccepted(BDXTransfer &aXfer, uint32_t aProfileId, u
                  */
                 {
                     uint8_t xferMode;
+                    bool windowed;
                     ReceiveAccept inMsg;
 
                     err = ReceiveAccept::parse(aPacketBuffer, inMsg);
@@ -1376,10 +2007,24 @@ WEAVE_ERROR HandleResponseNotAccepted(BDXTransfer &aXfer, uint32_t aProfileId, u
                                  WeaveLogDetail(BDX, "ReceiveAccept returned an incompatible version: %d.", inMsg.mVersion));
 
                     // Set up the aXfer object and call callback
+                    windowed = (inMsg.mTransferMode & kMode_Windowed) != 0;
+
                     aXfer.mIsAccepted = true;
                     aXfer.mMaxBlockSize = inMsg.mMaxBlockSize;
+                    // Windowing is confirmed alongside the transfer mode; keep it out
+                    // of mTransferMode so callers see one of the kMode_* values.
+                    inMsg.mTransferMode &= ~kMode_Windowed;
                     aXfer.mTransferMode = inMsg.mTransferMode;
                     aXfer.mVersion = inMsg.mVersion;
+
+                    // The reservation made at init time assumed our proposed block size
+                    if (aXfer.mNode != NULL)
+                    {
+                        err = aXfer.mNode->ReserveBuffers(aXfer);
+                        SuccessOrExit(err);
+                    }
+
+                    aXfer.NegotiateWindowing(windowed);
                     aXfer.mLength = inMsg.mLength;
                     err = aXfer.DispatchReceiveAccept(&inMsg);
                     VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogDetail(BDX, "DispatchReceiveAccept failed."));
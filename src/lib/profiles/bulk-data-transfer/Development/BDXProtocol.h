@@ -84,6 +84,10 @@ void HandleKeyError(ExchangeContext *anEc, WEAVE_ERROR aKeyErr);
 void HandleSendError(ExchangeContext *anEc, WEAVE_ERROR aSendErr, void *aMsgCtxt);
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+void HandleWindowRetransmitTimeout(System::Layer *aSystemLayer, void *aAppState, System::Error aError);
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
 void SendTransferError(ExchangeContext *anEc, uint32_t aProfileId,  uint16_t aStatusCode);
 
 void SendStatusReport(ExchangeContext *anEc, uint32_t aProfileId,  uint16_t aStatusCode);
@@ -22,9 +22,13 @@
  *      the state of an ongoing transfer and is managed by the BdxNode.
  */
 
+#include <inttypes.h>
+
 #include <Weave/Support/logging/WeaveLogging.h>
 
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXTransferState.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXProtocol.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXCheckpoint.h>
 
 namespace nl {
 namespace Weave {
@@ -53,6 +57,8 @@ using namespace nl::Weave::Logging;
  */
 void BDXTransfer::Shutdown(void)
 {
+    ReleaseWindow();
+
     if (mExchangeContext != NULL)
     {
         if (mIsCompletedSuccessfully)
@@ -86,6 +92,54 @@ void BDXTransfer::Reset(void)
     mIsWideRange                    = false;
     mIsCompletedSuccessfully        = false;
     mAmInitiator                    = false;
+    mIsWindowed                     = false;
+    mMaxWindowSize                  = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    mAcceptMetaData.free();
+
+    mXferStartTime                  = 0;
+    mXferEndTime                    = 0;
+    mBytesTransferred               = 0;
+    mLastSendTime                   = 0;
+    mSmoothedRTT                    = 0;
+    mMinRTT                         = 0;
+    mNumRTTSamples                  = 0;
+    mNumRetransmits                 = 0;
+
+    mNode                           = NULL;
+    mNext                           = NULL;
+    mScheduledBytes                 = 0;
+    mPeerServedBytes                = 0;
+    mBufferReservation              = 0;
+    mQueueSeq                       = 0;
+    mNumDeferrals                   = 0;
+    mIsWaiting                      = false;
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    mIsResumable                    = false;
+    mImageLength                    = 0;
+    mImageVersion                   = 0;
+    mExpectedCrc                    = 0;
+    mHasExpectedCrc                 = false;
+    mCheckpointId                   = 0;
+    mReceivedOffset                 = 0;
+    mCheckpointOffset               = 0;
+    mIntegrityCrc                   = BdxCheckpoint::kInitialCrc;
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+    // Any buffers still held were released in Shutdown(); this may also run
+    // on uninitialized memory from BdxNode::Init(), so only clear pointers.
+    for (int i = 0; i < WEAVE_CONFIG_BDX_WINDOW_SIZE; i++)
+    {
+        mWindow[i].mBlock = NULL;
+    }
+
+    mNextBlockCounter               = 0;
+    mEOFBlockCounter                = 0;
+    mEOFQueued                      = false;
+    mPeerWindowSize                 = 1;
+    mNumTimeouts                    = 0;
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
 
     mHandlers.mSendAcceptHandler    = NULL;
     mHandlers.mReceiveAcceptHandler = NULL;
@@ -155,6 +209,222 @@ uint16_t BDXTransfer::GetDefaultFlags(bool aExpectResponse)
             (GetBDXAckFlag(mExchangeContext)));
 }
 
+/**
+ * @brief
+ *  Returns true if this node may offer or accept the windowed transfer mode
+ *  for this transfer.
+ *
+ * @return true iff windowing is compiled in and mMaxWindowSize allows more than one
+ *  outstanding block.
+ */
+bool BDXTransfer::IsWindowingSupported(void)
+{
+#if (WEAVE_CONFIG_BDX_WINDOW_SIZE > 0) && (WEAVE_CONFIG_BDX_VERSION >= 1)
+    return mMaxWindowSize > 1;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief
+ *  Decides whether this transfer runs in windowed mode once the transfer mode and
+ *  version are settled.  Windowing requires a V1 sender drive transfer that both
+ *  nodes support.
+ *
+ * @param[in]   aPeerSupportsWindowing  True if the peer offered (in an Init message)
+ *                                      or confirmed (in an Accept message) windowing
+ */
+void BDXTransfer::NegotiateWindowing(bool aPeerSupportsWindowing)
+{
+    mIsWindowed = aPeerSupportsWindowing && (mVersion == 1) &&
+                  (mTransferMode == kMode_SenderDrive) && IsWindowingSupported();
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+    if (mMaxWindowSize > WEAVE_CONFIG_BDX_WINDOW_SIZE)
+    {
+        mMaxWindowSize = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+}
+
+/**
+ * @brief
+ *  Stops the retransmission timer of a windowed transfer and frees every
+ *  block it still holds.  Safe to call for transfers that are not windowed.
+ */
+void BDXTransfer::ReleaseWindow(void)
+{
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+    if (mIsWindowed && mExchangeContext != NULL)
+    {
+        mExchangeContext->ExchangeMgr->MessageLayer->SystemLayer->CancelTimer(BdxProtocol::HandleWindowRetransmitTimeout, this);
+    }
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_WINDOW_SIZE; i++)
+    {
+        if (mWindow[i].mBlock != NULL)
+        {
+            PacketBuffer::Free(mWindow[i].mBlock);
+            mWindow[i].mBlock = NULL;
+        }
+    }
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+}
+
+/**
+ * @brief
+ *  Folds a round trip time measurement into the transfer statistics.
+ *
+ *  The smoothed value uses the usual 1/8 gain so a single delayed
+ *  response does not swing the retransmission timeout.
+ *
+ * @param[in]   aRTT        Measured round trip time in milliseconds
+ */
+void BDXTransfer::RecordRTTSample(uint32_t aRTT)
+{
+    if (mNumRTTSamples == 0)
+    {
+        mSmoothedRTT = aRTT;
+        mMinRTT = aRTT;
+    }
+    else
+    {
+        mSmoothedRTT = (7 * mSmoothedRTT + aRTT) / 8;
+
+        if (aRTT < mMinRTT)
+        {
+            mMinRTT = aRTT;
+        }
+    }
+
+    mNumRTTSamples++;
+}
+
+/**
+ * @brief
+ *  Accounts for a block of data the protocol sent or received for the first time.
+ *
+ * @param[in]   aLength     Length of the block's data
+ */
+void BDXTransfer::RecordBlockTransferred(uint64_t aLength)
+{
+    if (mXferStartTime == 0)
+    {
+        mXferStartTime = System::Layer::GetClock_MonotonicMS();
+    }
+
+    mBytesTransferred += aLength;
+}
+
+/**
+ * @brief
+ *  Returns the average throughput of this transfer, measured from the first
+ *  block until completion (or until now while the transfer is ongoing).
+ *
+ * @return throughput in bytes per second, 0 if nothing was transferred yet.
+ */
+uint32_t BDXTransfer::GetThroughput(void)
+{
+    uint64_t end = (mXferEndTime != 0) ? mXferEndTime : System::Layer::GetClock_MonotonicMS();
+    uint64_t elapsed;
+
+    if (mXferStartTime == 0)
+    {
+        return 0;
+    }
+
+    // Round sub-millisecond transfers up so we never divide by zero
+    elapsed = (end > mXferStartTime) ? (end - mXferStartTime) : 1;
+
+    return static_cast<uint32_t>((mBytesTransferred * 1000) / elapsed);
+}
+
+/**
+ * @brief
+ *  Fills in a snapshot of this transfer's progress.
+ *
+ * @param[out]  aStats      Statistics of the transfer
+ */
+void BDXTransfer::GetStats(BDXTransferStats &aStats)
+{
+    aStats.mPeerNodeId          = (mExchangeContext != NULL) ? mExchangeContext->PeerNodeId : kNodeIdNotSpecified;
+    aStats.mBytesTransferred    = mBytesTransferred;
+    aStats.mLength              = mLength;
+    aStats.mThroughput          = GetThroughput();
+    aStats.mSmoothedRTT         = mSmoothedRTT;
+    aStats.mMinRTT              = mMinRTT;
+    aStats.mNumRetransmits      = mNumRetransmits;
+    aStats.mNumDeferrals        = mNumDeferrals;
+    aStats.mBufferReservation   = mBufferReservation;
+    aStats.mMaxBlockSize        = mMaxBlockSize;
+    aStats.mAmSender            = mAmSender;
+    aStats.mAmInitiator         = mAmInitiator;
+    aStats.mIsWindowed          = mIsWindowed;
+    aStats.mIsWaiting           = mIsWaiting;
+}
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+/**
+ * @brief
+ *  Starts persisting the progress of a resumable download.  If a previous
+ *  download of the same file designator, image length and image version was
+ *  interrupted, resumes it by moving mStartOffset (and shortening mLength) to
+ *  the persisted offset and continuing its CRC.
+ *
+ *  Called by BdxNode::InitBdxReceive() for transfers with mIsResumable set.
+ */
+void BDXTransfer::StartCheckpointing(void)
+{
+    WEAVE_ERROR err;
+    uint64_t offset;
+    uint32_t crc;
+
+    mCheckpointId = BdxCheckpoint::ComputeId(mFileDesignator, mImageLength, mImageVersion);
+    mIntegrityCrc = BdxCheckpoint::kInitialCrc;
+
+    err = BdxCheckpoint::Load(mCheckpointId, offset, crc);
+
+    // Only resume a download of the same range from its start
+    if (err == WEAVE_NO_ERROR && offset > mStartOffset && (mLength == 0 || offset < mStartOffset + mLength))
+    {
+        WeaveLogProgress(BDX, "Resuming download at offset %" PRIu64, offset);
+
+        if (mLength != 0)
+        {
+            mLength -= offset - mStartOffset;
+        }
+
+        mStartOffset = offset;
+        mIntegrityCrc = crc;
+    }
+
+    mReceivedOffset = mStartOffset;
+    mCheckpointOffset = mStartOffset;
+}
+
+/**
+ * @brief
+ *  Persists the progress of a resumable download if it advanced since the
+ *  last checkpoint.  Failing to persist it only costs a longer download
+ *  next time, so errors are logged and otherwise ignored.
+ */
+void BDXTransfer::SaveCheckpoint(void)
+{
+    WEAVE_ERROR err;
+
+    VerifyOrExit(mCheckpointId != 0 && mReceivedOffset > mCheckpointOffset, );
+
+    err = BdxCheckpoint::Save(mCheckpointId, mReceivedOffset, mIntegrityCrc);
+    VerifyOrExit(err == WEAVE_NO_ERROR, WeaveLogError(BDX, "Unable to save BDX checkpoint: %d", err));
+
+    mCheckpointOffset = mReceivedOffset;
+
+exit:
+    return;
+}
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
 /**
  * @brief
  *  If the receive accept handler has been set, call it.
@@ -200,6 +470,16 @@ WEAVE_ERROR BDXTransfer::DispatchSendAccept(SendAccept *aSendAcceptMsg)
  */
 void BDXTransfer::DispatchRejectHandler(StatusReport *aReport)
 {
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    // The sender can't resume, so start over next time
+    if (mCheckpointId != 0 && aReport->mProfileId == kWeaveProfile_BDX &&
+        aReport->mStatusCode == kStatus_StartOffsetNotSupported)
+    {
+        BdxCheckpoint::Clear();
+        mCheckpointId = 0;
+    }
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     if (mHandlers.mRejectHandler)
     {
         mHandlers.mRejectHandler(this, aReport);
@@ -223,10 +503,28 @@ void BDXTransfer::DispatchPutBlockHandler(uint64_t aLength,
                                           uint8_t *aDataBlock,
                                           bool aLastBlock)
 {
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    if (mCheckpointId != 0)
+    {
+        mIntegrityCrc = BdxCheckpoint::UpdateCrc(mIntegrityCrc, aDataBlock, aLength);
+        mReceivedOffset += aLength;
+    }
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     if (mHandlers.mPutBlockHandler)
     {
         mHandlers.mPutBlockHandler(this, aLength, aDataBlock, aLastBlock);
     }
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    // The block is durable now; the last one is followed by completion,
+    // which clears the checkpoint instead
+    if (mCheckpointId != 0 && !aLastBlock &&
+        mReceivedOffset - mCheckpointOffset >= WEAVE_CONFIG_BDX_CHECKPOINT_INTERVAL_BYTES)
+    {
+        SaveCheckpoint();
+    }
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
 }
 
 /**
@@ -256,6 +554,10 @@ void BDXTransfer::DispatchGetBlockHandler(uint64_t *aLength,
  */
 void BDXTransfer::DispatchErrorHandler(WEAVE_ERROR anErrorCode)
 {
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    SaveCheckpoint();
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     if (mHandlers.mErrorHandler)
     {
         mHandlers.mErrorHandler(this, anErrorCode);
@@ -275,6 +577,10 @@ void BDXTransfer::DispatchErrorHandler(WEAVE_ERROR anErrorCode)
  */
 void BDXTransfer::DispatchXferErrorHandler(StatusReport *aXferError)
 {
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    SaveCheckpoint();
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     if (mHandlers.mXferErrorHandler)
     {
         mHandlers.mXferErrorHandler(this, aXferError);
@@ -292,6 +598,28 @@ void BDXTransfer::DispatchXferErrorHandler(StatusReport *aXferError)
  */
 void BDXTransfer::DispatchXferDoneHandler(void)
 {
+    mXferEndTime = System::Layer::GetClock_MonotonicMS();
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    // Nothing left to resume; mIntegrityCrc now covers the whole image
+    if (mCheckpointId != 0)
+    {
+        BdxCheckpoint::Clear();
+        mCheckpointId = 0;
+
+        // E.g. the image changed under the same designator while the
+        // download was interrupted; the next attempt starts over
+        if (mHasExpectedCrc && mIntegrityCrc != mExpectedCrc)
+        {
+            WeaveLogError(BDX, "Received image CRC-32 0x%08" PRIX32 ", expected 0x%08" PRIX32,
+                          mIntegrityCrc, mExpectedCrc);
+            mIsCompletedSuccessfully = false;
+            DispatchErrorHandler(WEAVE_ERROR_INTEGRITY_CHECK_FAILED);
+            return;
+        }
+    }
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     if (mHandlers.mXferDoneHandler)
     {
         mHandlers.mXferDoneHandler(this);
@@ -40,6 +40,7 @@ namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesigna
 #define DEFAULT_MAX_BLOCK_SIZE 256
 
 struct BDXTransfer; // forward declaration for inclusion in callbacks
+class BdxNode; // forward declaration for the transfer's owning node
 
 // typedefs for handler types needed below
 
@@ -53,6 +54,7 @@ struct BDXTransfer; // forward declaration for inclusion in callbacks
  * This is a good place to attach any application-specific state (open file
  * handles, etc.) to aXfer->mAppState. You should also attach the necessary
  * handlers for e.g. block handling to the BDXTransfer object at this point.
+ * Metadata for the SendAccept can be supplied in aXfer->mAcceptMetaData.
  * If an error code other than WEAVE_NO_ERROR is returned, the transfer is
  * assumed to be rejected and the protocol will handle sending a reject message
  * with the code.
@@ -239,6 +241,27 @@ struct BDXHandlers
     ErrorHandler            mErrorHandler;
 };
 
+/** A snapshot of the progress of a transfer, as returned by
+ * BDXTransfer::GetStats() and BdxNode::GetTransferStats().
+ */
+struct BDXTransferStats
+{
+    uint64_t            mPeerNodeId; // kNodeIdNotSpecified if the transfer has no exchange yet
+    uint64_t            mBytesTransferred;
+    uint64_t            mLength; // Expected length of the transfer, 0 if unknown
+    uint32_t            mThroughput; // Bytes per second
+    uint32_t            mSmoothedRTT; // ms, 0 until measured
+    uint32_t            mMinRTT; // ms, 0 until measured
+    uint32_t            mNumRetransmits;
+    uint32_t            mNumDeferrals; // Block steps held back by the node's byte-rate budget
+    uint32_t            mBufferReservation; // Bytes reserved against the node's memory budget
+    uint16_t            mMaxBlockSize;
+    bool                mAmSender;
+    bool                mAmInitiator;
+    bool                mIsWindowed;
+    bool                mIsWaiting; // A block step is waiting for the byte-rate budget
+};
+
 /** This structure contains data members representing an active BDX transfer.
  * These objects are used by the BdxProtocol to maintain protocol state.
  * They are managed by the BdxServer, which handles creating and initializing
@@ -266,6 +289,7 @@ struct BDXTransfer
     bool                mAmSender;
     bool                mIsWideRange; // true is widths and offsets are 64 bits
     bool                mFirstQuery; // true if we haven't received our first query
+    bool                mIsWindowed; // true if both nodes agreed to keep several V1 blocks in flight
     //TODO: bool mAckRcvd;  // may want to keep track of ACKs to support
                             // retransmission of old blocks in the future
     //TODO: int mSendFlags; // may want to configure SendFlags to be used in calls to
@@ -278,6 +302,11 @@ struct BDXTransfer
      * shouldn't stick around for the whole xfer as that takes up a pbuf
      */
     ReferencedString    mFileDesignator;
+    /** Optional metadata to return in the SendAccept.  A SendInitHandler may
+     * set it when accepting a transfer, e.g. to answer an option offered in
+     * the SendInit metadata.  Released when the transfer is shut down.
+     */
+    ReferencedTLVData   mAcceptMetaData;
     uint16_t            mMaxBlockSize; // Max block size to be used during this transfer
     uint64_t            mStartOffset; // Offset to start at for transfer, typically 0
     uint64_t            mLength; // Expected length of the transfer, 0 if unkown
@@ -290,6 +319,81 @@ struct BDXTransfer
      */
     uint32_t            mBlockCounter;
 
+    /** Max number of blocks this node allows to be outstanding in a windowed
+     * transfer.  Defaults to WEAVE_CONFIG_BDX_WINDOW_SIZE; lower it before
+     * initiating or accepting a transfer to limit windowing, or set it to 0
+     * (or 1) to only do stop-and-wait transfers.
+     */
+    uint8_t             mMaxWindowSize;
+
+    // Transfer statistics, maintained by the protocol
+    uint64_t            mXferStartTime; // Monotonic time (ms) the first block was sent or received
+    uint64_t            mXferEndTime; // Monotonic time (ms) the transfer completed, 0 while ongoing
+    uint64_t            mBytesTransferred; // Payload bytes sent (sender) or received in order (receiver)
+    uint64_t            mLastSendTime; // Monotonic time (ms) of the last stop-and-wait block or query
+    uint32_t            mSmoothedRTT; // Smoothed round trip time in ms, 0 until measured
+    uint32_t            mMinRTT; // Smallest round trip time measured in ms
+    uint32_t            mNumRTTSamples; // Number of round trip times measured
+    uint32_t            mNumRetransmits; // Number of blocks retransmitted by a windowed sender
+
+#if WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+    /** A block held by a windowed transfer.  The sender keeps a copy of each
+     * outstanding block until it is acknowledged, the receiver keeps blocks
+     * that arrived ahead of the next expected one.
+     */
+    struct WindowSlot
+    {
+        PacketBuffer *  mBlock; // Block counter and data, NULL if the slot is free
+        uint64_t        mSentTime; // Monotonic time (ms) of the last transmission
+        uint32_t        mBlockCounter;
+        uint8_t         mMsgType; // kMsgType_BlockSendV1 or kMsgType_BlockEOFV1
+        bool            mRetransmitted; // Excluded from RTT samples once retransmitted
+    };
+
+    WindowSlot          mWindow[WEAVE_CONFIG_BDX_WINDOW_SIZE]; // Indexed by block counter modulo the window size
+    uint32_t            mNextBlockCounter; // Sender: counter of the next new block to send
+    uint32_t            mEOFBlockCounter; // Sender: counter of the BlockEOFV1, valid if mEOFQueued
+    bool                mEOFQueued; // Sender: the last block was read from the application
+    uint8_t             mPeerWindowSize; // Sender: window advertised by the receiver
+    uint8_t             mNumTimeouts; // Sender: consecutive retransmission timeouts
+#endif // WEAVE_CONFIG_BDX_WINDOW_SIZE > 0
+
+    // Scheduler state, maintained by the owning BdxNode
+    BdxNode *           mNode; // Node that owns this transfer, NULL if it is driven without one
+    uint64_t            mScheduledBytes; // Part of mBytesTransferred already charged to the node's rate budget
+    uint64_t            mPeerServedBytes; // Bytes served to all transfers with the same peer, for fair queuing
+    uint32_t            mBufferReservation; // Bytes reserved against WEAVE_CONFIG_BDX_MAX_BUFFERED_BYTES
+    uint32_t            mQueueSeq; // Order in which the transfer started waiting for the rate budget
+    uint32_t            mNumDeferrals; // Block steps held back by the node's byte-rate budget
+    bool                mIsWaiting; // mNext is waiting for the node's byte-rate budget
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    /** Set before BdxNode::InitBdxReceive() to persist the progress of this
+     * download and resume a previous, interrupted download of the same file
+     * designator.  When resuming, mStartOffset is advanced to the persisted
+     * offset, so the PutBlockHandler receives the data from there on.  Data
+     * handed to the PutBlockHandler must be durable by the time it returns.
+     */
+    bool                mIsResumable;
+    /** Identify the image of a resumable download along with its file
+     * designator, so that a checkpoint is only resumed for the same image.
+     * 0 if unknown.
+     */
+    uint64_t            mImageLength; // Length of the whole image
+    uint32_t            mImageVersion; // Version or modification time of the image
+    /** If mHasExpectedCrc is set, a resumable download completes only if the
+     * CRC-32 of the data received from the original start offset equals
+     * mExpectedCrc.  Otherwise the checkpoint is cleared and the transfer
+     * fails with #WEAVE_ERROR_INTEGRITY_CHECK_FAILED.
+     */
+    uint32_t            mExpectedCrc;
+    bool                mHasExpectedCrc;
+    uint32_t            mCheckpointId; // Identifies the checkpoint, 0 if not checkpointing
+    uint64_t            mReceivedOffset; // File offset up to which data was handed to the application
+    uint64_t            mCheckpointOffset; // File offset last persisted
+    uint32_t            mIntegrityCrc; // CRC-32 of the data from the original start offset to mReceivedOffset
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     // application-supplied handlers
     //TODO: make these private when BdxProtocol doesn't inspect them directly
     //before calling DispatchGetBlockHandler().  We'll have to remove that check
@@ -310,6 +414,26 @@ struct BDXTransfer
 
     uint16_t GetDefaultFlags(bool aExpectResponse);
 
+    bool IsWindowingSupported(void);
+
+    void NegotiateWindowing(bool aPeerSupportsWindowing);
+
+    void ReleaseWindow(void);
+
+    void RecordRTTSample(uint32_t aRTT);
+
+    void RecordBlockTransferred(uint64_t aLength);
+
+    uint32_t GetThroughput(void);
+
+    void GetStats(BDXTransferStats &aStats);
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    void StartCheckpointing(void);
+
+    void SaveCheckpoint(void);
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
     /**
      * Dispatchers simply check whether a handler has been set and then call it if so.
      * Therefore, these should be used as the public interface for calling callbacks,
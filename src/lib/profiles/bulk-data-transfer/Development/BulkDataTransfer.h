@@ -32,5 +32,6 @@
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXTransferState.h>
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXProtocol.h>
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXNode.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXCheckpoint.h>
 
 #endif // _BULK_DATA_TRANSFER_H
@@ -15,6 +15,13 @@
  *    See the License for the specific language governing permissions and
  *    limitations under the License.
  */
+// __STDC_FORMAT_MACROS must be defined for PRIu32 to be defined for pre-C++11 clib
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif // __STDC_FORMAT_MACROS
+
+#include <inttypes.h>
+
 #define WEAVE_CONFIG_BDX_NAMESPACE kWeaveManagedNamespace_Development
 
 #include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
@@ -36,10 +43,13 @@ static char sLogFileName[] = "topazlog";
 WEAVE_ERROR BdxSendAcceptHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer,
                                  nl::Weave::Profiles::BulkDataTransfer::SendAccept * aSendAcceptMsg)
 {
-    WEAVE_ERROR error = WEAVE_NO_ERROR;
+    LogBDXUpload * uploader;
+
     WeaveLogDetail(BDX, "SendInit Accepted: %hd maxBlockSize, transfer mode is %hd", aSendAcceptMsg->mMaxBlockSize,
                    aXfer->mTransferMode);
-    return error;
+
+    uploader = static_cast<LogBDXUpload *>(aXfer->mAppState);
+    return uploader->AcceptHandler(aXfer, aSendAcceptMsg);
 }
 
 void BdxRejectHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer,
@@ -85,19 +95,23 @@ void LogBDXUpload::ThrottleIfNeeded(void)
     mFirstXfer = false;
 }
 
-void LogBDXUpload::BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer, uint64_t * aLength,
-                                uint8_t ** aDataBlock, bool * aIsLastBlock)
+/**
+ *  Fetch as many events as fit in aBuffer, moving on to the next importance
+ *  level as each one runs out.  aIsLastChunk is set once the events of all
+ *  importance levels have been fetched.
+ */
+WEAVE_ERROR LogBDXUpload::FetchEvents(uint8_t * aBuffer, uint32_t aBufferSize, uint32_t & aLength, bool & aIsLastChunk)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     TLVWriter writer;
     bool fullBlock = true;
 
-    writer.Init(*aDataBlock, *aLength);
+    writer.Init(aBuffer, aBufferSize);
 
     // If successful, these values will be reset below.  If the
     // function fails, these will be the return values.
-    *aIsLastBlock = true;
-    *aLength      = 0;
+    aIsLastChunk = true;
+    aLength      = 0;
 
     do
     {
@@ -117,7 +131,7 @@ void LogBDXUpload::BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransf
                 // end of the current transfer.  Signal end of
                 // transmission.
                 err                = WEAVE_NO_ERROR;
-                *aIsLastBlock      = true;
+                aIsLastChunk       = true;
                 mCurrentImportance = kImportanceType_First;
                 break;
             }
@@ -141,8 +155,8 @@ void LogBDXUpload::BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransf
         // that there will be more events to transfer.
         if ((err == WEAVE_ERROR_BUFFER_TOO_SMALL) || (err == WEAVE_ERROR_NO_MEMORY))
         {
-            err           = WEAVE_NO_ERROR;
-            *aIsLastBlock = false;
+            err          = WEAVE_NO_ERROR;
+            aIsLastChunk = false;
             break;
         }
 
@@ -150,10 +164,219 @@ void LogBDXUpload::BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransf
     } while (err == WEAVE_NO_ERROR);
 
     SuccessOrExit(err);
-    // on success, the aLastBlock is already set.
-    *aLength = writer.GetLengthWritten();
+    // on success, the aIsLastChunk is already set.
+    aLength = writer.GetLengthWritten();
+    mStats.mEventBytes += aLength;
 exit:
-    return;
+    return err;
+}
+
+void LogBDXUpload::BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer, uint64_t * aLength,
+                                uint8_t ** aDataBlock, bool * aIsLastBlock)
+{
+    WEAVE_ERROR err;
+    uint32_t length;
+    bool isLastBlock;
+
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    if (mStats.mCompression == kLogUploadCompression_LZ4Frame)
+    {
+        err = FetchCompressedBlock(*aDataBlock, static_cast<uint32_t>(*aLength), length, isLastBlock);
+    }
+    else
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    {
+        err = FetchEvents(*aDataBlock, static_cast<uint32_t>(*aLength), length, isLastBlock);
+    }
+
+    // On failure, end the transfer with what has been sent so far.
+    if (err != WEAVE_NO_ERROR)
+    {
+        length      = 0;
+        isLastBlock = true;
+    }
+
+    *aLength      = length;
+    *aIsLastBlock = isLastBlock;
+    mStats.mSentBytes += length;
+}
+
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+
+/**
+ *  Fill a block from the compressed stream, compressing more events as the
+ *  data compressed so far runs out.  At most one chunk of events is held
+ *  uncompressed, however large the log.
+ */
+WEAVE_ERROR LogBDXUpload::FetchCompressedBlock(uint8_t * aDataBlock, uint32_t aBlockSize, uint32_t & aLength, bool & aIsLastBlock)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t len;
+
+    aLength = 0;
+
+    while (aLength < aBlockSize)
+    {
+        if (mCompressedPos == mCompressedLen)
+        {
+            if (mFrameEnded)
+                break;
+
+            err = CompressNextChunk();
+            SuccessOrExit(err);
+        }
+
+        len = mCompressedLen - mCompressedPos;
+        if (len > aBlockSize - aLength)
+            len = aBlockSize - aLength;
+
+        memcpy(aDataBlock + aLength, mCompressedData + mCompressedPos, len);
+        mCompressedPos += len;
+        aLength += len;
+    }
+
+    aIsLastBlock = mFrameEnded && (mCompressedPos == mCompressedLen);
+
+exit:
+    return err;
+}
+
+/**
+ *  Produce the next piece of the LZ4 frame: the frame header, a block
+ *  holding the next chunk of events, or the end mark once all events have
+ *  been compressed.
+ */
+WEAVE_ERROR LogBDXUpload::CompressNextChunk(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t chunkLen;
+    uint64_t startTime;
+
+    mCompressedPos = 0;
+    mCompressedLen = 0;
+
+    if (!mFrameStarted)
+    {
+        mCompressedLen = LZ4FrameWriter::WriteHeader(mCompressedData);
+        mFrameStarted  = true;
+        ExitNow();
+    }
+
+    if (mEventsExhausted)
+    {
+        mCompressedLen = LZ4FrameWriter::WriteEndMark(mCompressedData);
+        mFrameEnded    = true;
+        ExitNow();
+    }
+
+    // Events are fetched straight into the compressor's window, right after the history they may refer back to.
+    err = FetchEvents(mCompressor.GetInputBuffer(), WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE, chunkLen,
+                      mEventsExhausted);
+    SuccessOrExit(err);
+
+    // An event too large for a chunk would otherwise stall the upload.
+    VerifyOrExit(chunkLen > 0 || mEventsExhausted, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    startTime = System::Layer::GetClock_MonotonicHiRes();
+
+    err = mCompressor.EncodeBlock(static_cast<uint16_t>(chunkLen), mCompressedData, sizeof(mCompressedData), mCompressedLen);
+
+    mStats.mCompressionTime += static_cast<uint32_t>(System::Layer::GetClock_MonotonicHiRes() - startTime);
+
+exit:
+    return err;
+}
+
+/**
+ *  Write the SendInit metadata offering the compression formats this
+ *  uploader supports.
+ */
+void LogBDXUpload::WriteCompressionOffer(TLVWriter & aWriter, void * aAppState)
+{
+    WEAVE_ERROR err;
+    TLVType container;
+    TLVType array;
+
+    err = aWriter.StartContainer(AnonymousTag, kTLVType_Structure, container);
+    SuccessOrExit(err);
+
+    err = aWriter.StartContainer(ContextTag(kTag_LogUploadCompression), kTLVType_Array, array);
+    SuccessOrExit(err);
+
+    err = aWriter.Put(AnonymousTag, static_cast<uint8_t>(kLogUploadCompression_LZ4Frame));
+    SuccessOrExit(err);
+
+    err = aWriter.EndContainer(array);
+    SuccessOrExit(err);
+
+    err = aWriter.EndContainer(container);
+    SuccessOrExit(err);
+
+    err = aWriter.Finalize();
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(BDX, "Failed to write log compression offer: %s", ErrorStr(err));
+    }
+}
+
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+
+/**
+ *  Pick up the compression format, if any, the receiver chose from the
+ *  SendAccept metadata.
+ */
+WEAVE_ERROR LogBDXUpload::AcceptHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer,
+                                        nl::Weave::Profiles::BulkDataTransfer::SendAccept * aSendAcceptMsg)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    TLVReader reader;
+    TLVType container;
+    uint8_t compression = kLogUploadCompression_None;
+
+    // Receivers that do not know about compression return no metadata.
+    VerifyOrExit(!aSendAcceptMsg->mMetaData.isEmpty(), );
+
+    reader.Init(aSendAcceptMsg->mMetaData.theData, aSendAcceptMsg->mMetaData.theLength);
+
+    err = reader.Next(kTLVType_Structure, AnonymousTag);
+    SuccessOrExit(err);
+
+    err = reader.EnterContainer(container);
+    SuccessOrExit(err);
+
+    while ((err = reader.Next()) == WEAVE_NO_ERROR)
+    {
+        if (reader.GetTag() == ContextTag(kTag_LogUploadCompression))
+        {
+            err = reader.Get(compression);
+            SuccessOrExit(err);
+        }
+    }
+
+    err = (err == WEAVE_END_OF_TLV) ? reader.ExitContainer(container) : err;
+    SuccessOrExit(err);
+
+    VerifyOrExit(compression != kLogUploadCompression_None, );
+    VerifyOrExit(compression == kLogUploadCompression_LZ4Frame, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mCompressor.Init(mCompressionWindow, sizeof(mCompressionWindow), WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE,
+                           mCompressionHashTable, kCompressionHashBits);
+    SuccessOrExit(err);
+
+    mStats.mCompression = kLogUploadCompression_LZ4Frame;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(BDX, "Invalid log compression in SendAccept: %s", ErrorStr(err));
+    }
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+
+    return err;
 }
 
 void BdxXferErrorHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer,
@@ -204,6 +427,8 @@ WEAVE_ERROR LogBDXUpload::Init(LoggingManagement * inLogger)
     mCurrentEventID    = 0;
     memset(mLastScheduledEventId, 0, sizeof(mLastScheduledEventId));
     memset(mLastTransmittedEventId, 0, sizeof(mLastTransmittedEventId));
+    memset(&mStats, 0, sizeof(mStats));
+    memset(&mLastUploadStats, 0, sizeof(mLastUploadStats));
     mLogger = inLogger;
     err     = mBdxNode.Init(mLogger->mExchangeMgr);
     SuccessOrExit(err);
@@ -239,6 +464,16 @@ WEAVE_ERROR LogBDXUpload::StartUpload(nl::Weave::Binding * aBinding)
     mCurrentImportance = kImportanceType_First;
     mCurrentEventID    = mLastScheduledEventId[mCurrentImportance - kImportanceType_First];
     mFirstXfer         = true;
+    memset(&mStats, 0, sizeof(mStats));
+
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    mCompressedLen   = 0;
+    mCompressedPos   = 0;
+    mFrameStarted    = false;
+    mEventsExhausted = false;
+    mFrameEnded      = false;
+    mCompressionOffer.init(WriteCompressionOffer, this);
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
 
     // create a transfer object
     xfer = NULL;
@@ -251,7 +486,11 @@ WEAVE_ERROR LogBDXUpload::StartUpload(nl::Weave::Binding * aBinding)
     xfer->mLength       = 0;
 
     // start transfer
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    err = mBdxNode.InitBdxSend(*xfer, true, false, false, &mCompressionOffer);
+#else
     err = mBdxNode.InitBdxSend(*xfer, true, false, false, NULL);
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
 
     if (err != WEAVE_NO_ERROR)
     {
@@ -285,6 +524,16 @@ void LogBDXUpload::Done(void)
     memcpy(mLastTransmittedEventId, mLastScheduledEventId, sizeof(mLastTransmittedEventId));
     mState          = UploaderInitialized;
     mUploadPosition = mLogger->GetBytesWritten();
+
+    mLastUploadStats = mStats;
+    if (mStats.mSentBytes > 0 && mStats.mEventBytes > 0)
+    {
+        uint32_t ratio = static_cast<uint32_t>(static_cast<uint64_t>(mStats.mEventBytes) * 100 / mStats.mSentBytes);
+
+        WeaveLogProgress(BDX, "Log upload: %" PRIu32 " event bytes sent in %" PRIu32 " bytes, ratio %" PRIu32 ".%02" PRIu32
+                         ", compression %" PRIu32 " us/MB", mStats.mEventBytes, mStats.mSentBytes, ratio / 100, ratio % 100,
+                         static_cast<uint32_t>(static_cast<uint64_t>(mStats.mCompressionTime) * 1048576 / mStats.mEventBytes));
+    }
     if (mThrottled)
     {
         mLogger->UnthrottleLogger();
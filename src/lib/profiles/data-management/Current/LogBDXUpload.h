@@ -26,6 +26,10 @@
 #include <Weave/Profiles/bulk-data-transfer/Development/BDXMessages.h>
 #include <Weave/Profiles/status-report/StatusReportProfile.h>
 
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+#include <Weave/Support/LZ4Frame.h>
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+
 namespace nl {
 namespace Weave {
 namespace Profiles {
@@ -43,6 +47,38 @@ void BdxXferErrorHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aX
 void BdxXferDoneHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer);
 void BdxErrorHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer, WEAVE_ERROR aErrorCode);
 
+/**
+ *  Compression formats of an uploaded event log.
+ *
+ *  An uploader built with WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION offers
+ *  the formats it supports in the SendInit metadata: an anonymous structure
+ *  whose kTag_LogUploadCompression element is an array of formats. A
+ *  receiver that supports one of them returns it in the SendAccept metadata:
+ *  an anonymous structure whose kTag_LogUploadCompression element is the
+ *  chosen format. Without that answer the log is sent uncompressed.
+ */
+enum LogUploadCompression
+{
+    kLogUploadCompression_None      = 0,
+    kLogUploadCompression_LZ4Frame  = 1,    ///< The whole upload is one LZ4 frame of linked blocks
+};
+
+enum
+{
+    kTag_LogUploadCompression       = 1,
+};
+
+/**
+ *  Statistics of the last completed log upload.
+ */
+struct LogUploadStats
+{
+    uint32_t mEventBytes;                   ///< Bytes of events uploaded
+    uint32_t mSentBytes;                    ///< Bytes sent over BDX
+    uint32_t mCompressionTime;              ///< Time spent compressing, in microseconds
+    uint8_t mCompression;                   ///< LogUploadCompression used
+};
+
 class NL_DLL_EXPORT LogBDXUpload
 {
 
@@ -59,6 +95,8 @@ public:
 
     WEAVE_ERROR StartUpload(nl::Weave::Binding * aBinding);
 
+    WEAVE_ERROR AcceptHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer,
+                              nl::Weave::Profiles::BulkDataTransfer::SendAccept * aSendAcceptMsg);
     void BlockHandler(nl::Weave::Profiles::BulkDataTransfer::BDXTransfer * aXfer, uint64_t * aLength, uint8_t ** aDataBlock,
                       bool * aIsLastBlock);
 
@@ -67,11 +105,38 @@ public:
     void Shutdown(void);
 
     uint32_t GetUploadPosition(void);
+    const LogUploadStats & GetLastUploadStats(void) const { return mLastUploadStats; }
 
     UploaderState mState;
 
 private:
     void ThrottleIfNeeded(void);
+    WEAVE_ERROR FetchEvents(uint8_t * aBuffer, uint32_t aBufferSize, uint32_t & aLength, bool & aIsLastChunk);
+
+#if WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
+    enum
+    {
+        kCompressionHashBits = 10,
+        kCompressionWindowSize =
+            WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_HISTORY_SIZE + WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE,
+    };
+
+    WEAVE_ERROR FetchCompressedBlock(uint8_t * aDataBlock, uint32_t aBlockSize, uint32_t & aLength, bool & aIsLastBlock);
+    WEAVE_ERROR CompressNextChunk(void);
+    static void WriteCompressionOffer(nl::Weave::TLV::TLVWriter & aWriter, void * aAppState);
+
+    nl::Weave::LZ4FrameWriter mCompressor;
+    ReferencedTLVData mCompressionOffer;
+    uint8_t mCompressionWindow[kCompressionWindowSize];
+    uint16_t mCompressionHashTable[1 << kCompressionHashBits];
+    // Compressed data waiting to be sent: the frame header, one block or the end mark
+    uint8_t mCompressedData[nl::Weave::LZ4FrameWriter::kBlockHeaderLength + WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION_CHUNK_SIZE];
+    uint16_t mCompressedLen;
+    uint16_t mCompressedPos;
+    bool mFrameStarted;
+    bool mEventsExhausted;
+    bool mFrameEnded;
+#endif // WEAVE_CONFIG_EVENT_LOGGING_BDX_COMPRESSION
 
     LoggingManagement * mLogger;
     nl::Weave::Profiles::BulkDataTransfer::BdxNode mBdxNode;
@@ -82,6 +147,8 @@ private:
     uint32_t mUploadPosition;
     bool mThrottled;
     bool mFirstXfer;
+    LogUploadStats mStats;
+    LogUploadStats mLastUploadStats;
 };
 
 } // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
@@ -1739,7 +1739,11 @@ void LoggingManagement::FlushHandler(System::Layer * inSystemLayer, INET_ERROR i
 #if WEAVE_CONFIG_EVENT_LOGGING_WDM_OFFLOAD
         if (mExchangeMgr != NULL)
         {
-            nl::Weave::Profiles::DataManagement::SubscriptionEngine::GetInstance()->GetNotificationEngine()->Run();
+            NotificationEngine * notificationEngine =
+                nl::Weave::Profiles::DataManagement::SubscriptionEngine::GetInstance()->GetNotificationEngine();
+
+            notificationEngine->ScheduleEventSubscribers();
+            notificationEngine->Run();
             mUploadRequested = false;
         }
 #endif // WEAVE_CONFIG_EVENT_LOGGING_WDM_OFFLOAD
@@ -62,10 +62,14 @@ bool NotificationEngine::BasicGraphSolver::IsPropertyPathSupported(PropertyPathH
 
 WEAVE_ERROR NotificationEngine::BasicGraphSolver::RetrieveTraitInstanceData(NotifyRequestBuilder * aBuilder,
                                                                             TraitDataHandle aTraitDataHandle,
-                                                                            SchemaVersion aSchemaVersion, bool aRetrieveAll)
+                                                                            SchemaVersion aSchemaVersion, bool aRetrieveAll,
+                                                                            const uint64_t * apSinceVersion)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
+    // Every retrieval is from root, which is also correct for a subscriber resuming from a known version.
+    IgnoreUnusedVariable(apSinceVersion);
+
     err = aBuilder->WriteDataElement(aTraitDataHandle, kRootPropertyPathHandle, aSchemaVersion, NULL, 0, NULL, 0);
     SuccessOrExit(err);
 
@@ -76,24 +80,26 @@ exit:
 WEAVE_ERROR NotificationEngine::BasicGraphSolver::SetDirty(TraitDataHandle aDataHandle, PropertyPathHandle aPropertyHandle)
 {
     SubscriptionEngine * subEngine = SubscriptionEngine::GetInstance();
+    const uint64_t nowMsec         = System::Layer::GetClock_MonotonicMS();
+
+    subEngine->mNotificationEngine.mNotifyStats.mNumDirtyMarks++;
 
-    // Iterate over all subscriptions and their trait instance info lists and mark them dirty as appropriate
-    for (int i = 0; i < SubscriptionEngine::kMaxNumSubscriptionHandlers; ++i)
+    // Mark dirty the trait instances of all subscriptions to this trait data source. Only the subscriptions in the index bucket
+    // of the data handle are visited, rather than every subscription handler.
+    for (SubscriptionHandler::TraitInstanceRef ref = subEngine->GetTraitInstanceIndexHead(aDataHandle); ref.mHandler != NULL;)
     {
-        SubscriptionHandler * subHandler = &subEngine->mHandlers[i];
+        SubscriptionHandler * subHandler                       = ref.mHandler;
+        SubscriptionHandler::TraitInstanceInfo * traitInstance = SubscriptionEngine::GetTraitInstance(ref);
 
-        if (subHandler->IsActive())
-        {
-            SubscriptionHandler::TraitInstanceInfo * traitInstance = subHandler->GetTraitInstanceInfoList();
+        ref = traitInstance->mNextInIndex;
 
-            for (size_t j = 0; j < subHandler->GetNumTraitInstances(); j++)
-            {
-                if (traitInstance[j].mTraitDataHandle == aDataHandle)
-                {
-                    WeaveLogDetail(DataManagement, "<BSolver:SetD> Set S%u:T%u dirty", i, j);
-                    traitInstance[j].SetDirty();
-                }
-            }
+        if (subHandler->IsActive() && traitInstance->mTraitDataHandle == aDataHandle)
+        {
+            WeaveLogDetail(DataManagement, "<BSolver:SetD> Set S%u:T%u dirty", subEngine->GetHandlerId(subHandler),
+                           static_cast<unsigned>(traitInstance - subHandler->GetTraitInstanceInfoList()));
+            traitInstance->SetDirty();
+            subHandler->OnDataDirty(nowMsec);
+            subEngine->mNotificationEngine.ScheduleHandler(subHandler);
         }
     }
 
@@ -187,6 +193,68 @@ bool NotificationEngine::IntermediateGraphSolver::Store::IsPresent(TraitPath aIt
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // IntermediateGraphSolver
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+NotificationEngine::IntermediateGraphSolver::IntermediateGraphSolver(void)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS; i++)
+    {
+        mDirtyPathBitmaps[i].mTraitDataHandle = UINT16_MAX;
+        mDirtyPathBitmaps[i].mIsInUse         = false;
+        mDirtyPathBitmaps[i].mPaths.Init(mDirtyPathBitmaps[i].mWords, DirtyPathBitmap::kNumWords, NULL, 0);
+    }
+}
+
+NotificationEngine::IntermediateGraphSolver::DirtyPathBitmap *
+NotificationEngine::IntermediateGraphSolver::GetDirtyPathBitmap(TraitDataHandle aTraitDataHandle)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS; i++)
+    {
+        if (mDirtyPathBitmaps[i].mIsInUse && mDirtyPathBitmaps[i].mTraitDataHandle == aTraitDataHandle)
+        {
+            return &mDirtyPathBitmaps[i];
+        }
+    }
+
+    return NULL;
+}
+
+void NotificationEngine::IntermediateGraphSolver::ReleaseDirtyPathBitmap(TraitDataHandle aTraitDataHandle)
+{
+    DirtyPathBitmap * dirtyPathBitmap = GetDirtyPathBitmap(aTraitDataHandle);
+
+    if (dirtyPathBitmap != NULL)
+    {
+        dirtyPathBitmap->mPaths.Clear();
+        dirtyPathBitmap->mIsInUse = false;
+    }
+}
+
+bool NotificationEngine::IntermediateGraphSolver::SetDirtyInBitmap(TraitDataHandle aDataHandle, PropertyPathHandle aPropertyHandle,
+                                                                   const TraitSchemaEngine * aSchemaEngine)
+{
+    DirtyPathBitmap * dirtyPathBitmap = GetDirtyPathBitmap(aDataHandle);
+    PropertyPathHandle dictionaryItemHandle;
+
+    // Changes within dictionary items have to be reconciled with the delete store, so they are left to the granular store.
+    if (aSchemaEngine->IsInDictionary(aPropertyHandle, dictionaryItemHandle))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; (dirtyPathBitmap == NULL) && (i < WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS); i++)
+    {
+        if (!mDirtyPathBitmaps[i].mIsInUse && mDirtyPathBitmaps[i].mPaths.Attach(aSchemaEngine) == WEAVE_NO_ERROR)
+        {
+            dirtyPathBitmap                   = &mDirtyPathBitmaps[i];
+            dirtyPathBitmap->mTraitDataHandle = aDataHandle;
+            dirtyPathBitmap->mIsInUse         = true;
+        }
+    }
+
+    return (dirtyPathBitmap != NULL) && (dirtyPathBitmap->mPaths.AddItem(aPropertyHandle) == WEAVE_NO_ERROR);
+}
+#endif // WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+
 bool NotificationEngine::IntermediateGraphSolver::IsPropertyPathSupported(PropertyPathHandle aHandle)
 {
     // The intermediate solver also only supports subscribing to root.
@@ -232,6 +300,10 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::DeleteKey(TraitDataHand
 
         mDeleteStore.RemoveItem(aDataHandle);
 
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+        ReleaseDirtyPathBitmap(aDataHandle);
+#endif
+
         // Mark the data source is being entirely dirty.
         dataSource->SetRootDirty();
     }
@@ -290,6 +362,14 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::SetDirty(TraitDataHandl
         return WEAVE_NO_ERROR;
     }
 
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    if (SetDirtyInBitmap(aDataHandle, aPropertyHandle, dataSource->GetSchemaEngine()))
+    {
+        WeaveLogDetail(DataManagement, "<ISolver:SetDirty> Tracked in bitmap");
+        ExitNow();
+    }
+#endif
+
     // If we have exceeded the num items in the store, we need to mark the whole trait instance as dirty and remove all
     // existing references to this trait instance in the dirty store.
     if (mDirtyStore.IsFull())
@@ -298,6 +378,10 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::SetDirty(TraitDataHandl
 
         mDirtyStore.RemoveItem(aDataHandle);
 
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+        ReleaseDirtyPathBitmap(aDataHandle);
+#endif
+
         // Mark the data source is being entirely dirty.
         dataSource->SetRootDirty();
     }
@@ -339,10 +423,25 @@ exit:
 
 PropertyPathHandle NotificationEngine::IntermediateGraphSolver::GetNextCandidateHandle(uint32_t & aChangeStoreCursor,
                                                                                        TraitDataHandle aTargetDataHandle,
-                                                                                       bool & aCandidateHandleIsDelete)
+                                                                                       bool & aCandidateHandleIsDelete,
+                                                                                       TraitDataSource * aJournalSource,
+                                                                                       uint64_t aSinceVersion)
 {
     PropertyPathHandle candidateHandle = kNullPropertyPathHandle;
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    // When syncing a subscriber from a known version, the candidates come from the data source's change journal instead of the
+    // shared stores. Deletions have been journaled as changes to their dictionary.
+    if (aJournalSource != NULL)
+    {
+        aCandidateHandleIsDelete = false;
+        return aJournalSource->GetNextJournalChange(aSinceVersion, aChangeStoreCursor);
+    }
+#else
+    IgnoreUnusedVariable(aJournalSource);
+    IgnoreUnusedVariable(aSinceVersion);
+#endif
+
     while (aChangeStoreCursor < mDirtyStore.GetStoreSize())
     {
         TraitPath dirtyPath = mDirtyStore.mStore[aChangeStoreCursor];
@@ -359,7 +458,7 @@ PropertyPathHandle NotificationEngine::IntermediateGraphSolver::GetNextCandidate
     }
 
 #if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
-    while (aChangeStoreCursor >= mDirtyStore.GetStoreSize() &&
+    while (candidateHandle == kNullPropertyPathHandle && aChangeStoreCursor >= mDirtyStore.GetStoreSize() &&
            aChangeStoreCursor < (mDeleteStore.GetStoreSize() + mDirtyStore.GetStoreSize()))
     {
         TraitPath deletePath = mDeleteStore.mStore[aChangeStoreCursor - mDirtyStore.GetStoreSize()];
@@ -377,12 +476,36 @@ PropertyPathHandle NotificationEngine::IntermediateGraphSolver::GetNextCandidate
     }
 #endif // TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
 
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    // Paths from the trait's dirty path bitmap come last. Being visited after any dictionary item paths in the stores, ancestors
+    // in the bitmap are always evaluated after their descendants.
+    {
+        uint32_t bitmapCursorBase = mDirtyStore.GetStoreSize();
+        DirtyPathBitmap * dirtyPathBitmap;
+
+#if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
+        bitmapCursorBase += mDeleteStore.GetStoreSize();
+#endif
+
+        if (candidateHandle == kNullPropertyPathHandle && aChangeStoreCursor >= bitmapCursorBase &&
+            (dirtyPathBitmap = GetDirtyPathBitmap(aTargetDataHandle)) != NULL)
+        {
+            uint32_t bitmapCursor = aChangeStoreCursor - bitmapCursorBase;
+
+            candidateHandle          = dirtyPathBitmap->mPaths.GetNextItem(bitmapCursor);
+            aCandidateHandleIsDelete = false;
+            aChangeStoreCursor       = bitmapCursorBase + bitmapCursor;
+        }
+    }
+#endif // WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+
     return candidateHandle;
 }
 
 WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::RetrieveTraitInstanceData(NotifyRequestBuilder * aBuilder,
                                                                                    TraitDataHandle aTraitDataHandle,
-                                                                                   SchemaVersion aSchemaVersion, bool aRetrieveAll)
+                                                                                   SchemaVersion aSchemaVersion, bool aRetrieveAll,
+                                                                                   const uint64_t * apSinceVersion)
 {
     WEAVE_ERROR err;
     PropertyPathHandle mergeHandleSet[WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET]  = { kNullPropertyPathHandle };
@@ -391,6 +514,8 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::RetrieveTraitInstanceDa
     int32_t numDeleteHandles                                                                   = 0;
     PropertyPathHandle currentCommonHandle                                                     = kNullPropertyPathHandle;
     TraitDataSource * dataSource;
+    TraitDataSource * journalSource = NULL;
+    uint64_t sinceVersion           = 0;
     const TraitSchemaEngine * schemaEngine;
 
     err = SubscriptionEngine::GetInstance()->mPublisherCatalog->Locate(aTraitDataHandle, &dataSource);
@@ -405,14 +530,25 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::RetrieveTraitInstanceDa
                    WDM_PUBLISHER_MAX_ITEMS_IN_TRAIT_DIRTY_STORE);
 #endif
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    // A subscriber resuming from a version the data source still has the changes for only needs those changes. The journal has
+    // to be checked again here as it may have overflowed since the subscribe request was processed.
+    if (aRetrieveAll && (apSinceVersion != NULL) && dataSource->IsChangeJournalValidSince(*apSinceVersion))
+    {
+        WeaveLogDetail(DataManagement, "<ISolver::Retr> Retrieving changes since 0x%" PRIx64, *apSinceVersion);
+        journalSource = dataSource;
+        sinceVersion  = *apSinceVersion;
+    }
+#endif // WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+
     // If we are told to retrieve all (i.e root), our job here is done
-    if (aRetrieveAll)
+    if (aRetrieveAll && (journalSource == NULL))
     {
         WeaveLogDetail(DataManagement, "<ISolver::Retr> Retrieving all!");
         currentCommonHandle = kRootPropertyPathHandle;
     }
     // If the data source as a whole has been marked dirty, our job here is done
-    else if (dataSource->IsRootDirty())
+    else if (dataSource->IsRootDirty() && (journalSource == NULL))
     {
         WeaveLogDetail(DataManagement, "<ISolver::Retr> Root is dirty!");
         currentCommonHandle = kRootPropertyPathHandle;
@@ -467,8 +603,8 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::RetrieveTraitInstanceDa
         //      mergeHandleSet = set of handles that will be merged in relative to the currentCommonHandle. If empty, all children
         //                   under the commonHandle will be included.
         //
-        while ((candidateHandle = GetNextCandidateHandle(changeStoreCursor, aTraitDataHandle, candidateHandleIsDelete)) !=
-               kNullPropertyPathHandle)
+        while ((candidateHandle = GetNextCandidateHandle(changeStoreCursor, aTraitDataHandle, candidateHandleIsDelete,
+                                                         journalSource, sinceVersion)) != kNullPropertyPathHandle)
         {
             oldCandidateHandleIsDelete = candidateHandleIsDelete;
 
@@ -665,6 +801,15 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::RetrieveTraitInstanceDa
         }
     }
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    // The journal is only consulted if it holds a change newer than the subscriber's version, but fall back to a full sync
+    // rather than sending nothing should it turn out empty.
+    if ((journalSource != NULL) && (currentCommonHandle == kNullPropertyPathHandle))
+    {
+        currentCommonHandle = kRootPropertyPathHandle;
+    }
+#endif // WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+
     // If our algo is working correctly, currentCommonHandle should always be pointing to a valid handle. This is always the case
     // since a) this function only gets called if we know there is dirtiness in this trait and b) the current common handle is
     // always a function of the dirty handle set, which by definition, cannot be null.
@@ -713,6 +858,14 @@ WEAVE_ERROR NotificationEngine::IntermediateGraphSolver::ClearDirty()
     // Clear out our granular dirty store.
     mDirtyStore.Clear();
 
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    for (size_t i = 0; i < WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS; i++)
+    {
+        mDirtyPathBitmaps[i].mPaths.Clear();
+        mDirtyPathBitmaps[i].mIsInUse = false;
+    }
+#endif
+
 #if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
     mDeleteStore.Clear();
 #endif
@@ -862,15 +1015,43 @@ NotificationEngine::NotifyRequestBuilder::WriteDataElement(TraitDataHandle aTrai
     TraitDataSource * dataSource;
     bool retrievingData = false;
     SchemaVersionRange versionRange;
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    DataElementCache & cache = SubscriptionEngine::GetInstance()->GetNotificationEngine()->mDataElementCache;
+    DataElementCache::Key cacheKey;
+    bool isCacheable = false;
+    uint32_t elementStart = 0;
+#endif
 
     VerifyOrExit(mState == kNotifyRequestBuilder_BuildDataList, err = WEAVE_ERROR_INCORRECT_STATE);
 
-    err = mWriter->StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
+    err = SubscriptionEngine::GetInstance()->mPublisherCatalog->Locate(aTraitDataHandle, &dataSource);
     SuccessOrExit(err);
 
-    err = SubscriptionEngine::GetInstance()->mPublisherCatalog->Locate(aTraitDataHandle, &dataSource);
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    isCacheable = cacheKey.Init(aTraitDataHandle, dataSource, aSchemaVersion, aPropertyPathHandle, aMergeDataHandleSet,
+                                aNumMergeDataHandles, aDeleteHandleSet, aNumDeleteHandles);
+    if (isCacheable)
+    {
+        const uint8_t * cachedData;
+        uint32_t cachedDataLen;
+
+        if (cache.Lookup(cacheKey, cachedData, cachedDataLen))
+        {
+            WeaveLogDetail(DataManagement, "<NE::WriteDE> Using cached element for handle %u", aTraitDataHandle);
+
+            err = mWriter->PutPreEncodedContainer(AnonymousTag, kTLVType_Structure, cachedData, cachedDataLen);
+            ExitNow();
+        }
+    }
+#endif // WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+
+    err = mWriter->StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
     SuccessOrExit(err);
 
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    elementStart = mWriter->GetLengthWritten();
+#endif
+
     versionRange.mMaxVersion = aSchemaVersion;
     versionRange.mMinVersion = dataSource->GetSchemaEngine()->GetLowestCompatibleVersion(versionRange.mMaxVersion);
 
@@ -945,6 +1126,15 @@ NotificationEngine::NotifyRequestBuilder::WriteDataElement(TraitDataHandle aTrai
     err = mWriter->EndContainer(kTLVType_Array);
     SuccessOrExit(err);
 
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    if (isCacheable)
+    {
+        // The writer is not finalized until the notify is complete, so the buffer's data length still marks the start of
+        // the notify request and the element's members are contiguous from elementStart onwards.
+        cache.Store(cacheKey, mBuf->Start() + mBuf->DataLength() + elementStart, mWriter->GetLengthWritten() - elementStart);
+    }
+#endif // WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+
 exit:
     if (retrievingData && err != WEAVE_NO_ERROR)
     {
@@ -1023,19 +1213,166 @@ WEAVE_ERROR NotificationEngine::NotifyRequestBuilder::Rollback(TLVWriter & aPoin
     *mWriter        = aPoint;
     return err;
 }
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NotificationEngine::DataElementCache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool NotificationEngine::DataElementCache::Key::Init(TraitDataHandle aTraitDataHandle, TraitDataSource * aDataSource,
+                                                     SchemaVersion aSchemaVersion, PropertyPathHandle aPropertyPathHandle,
+                                                     const PropertyPathHandle * aMergeDataHandleSet, uint32_t aNumMergeDataHandles,
+                                                     const PropertyPathHandle * aDeleteHandleSet, uint32_t aNumDeleteHandles)
+{
+    if (aNumMergeDataHandles > WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET ||
+        aNumDeleteHandles > WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET)
+    {
+        return false;
+    }
+
+    mTraitDataHandle    = aTraitDataHandle;
+    mDataSource         = aDataSource;
+    mDataVersion        = aDataSource->GetVersion();
+    mSchemaVersion      = aSchemaVersion;
+    mPropertyPathHandle = aPropertyPathHandle;
+    mNumMergeHandles    = static_cast<uint8_t>(aNumMergeDataHandles);
+    mNumDeleteHandles   = static_cast<uint8_t>(aNumDeleteHandles);
+
+    if (aNumMergeDataHandles > 0)
+    {
+        memcpy(mMergeHandleSet, aMergeDataHandleSet, aNumMergeDataHandles * sizeof(PropertyPathHandle));
+    }
+
+    if (aNumDeleteHandles > 0)
+    {
+        memcpy(mDeleteHandleSet, aDeleteHandleSet, aNumDeleteHandles * sizeof(PropertyPathHandle));
+    }
+
+    return true;
+}
+
+bool NotificationEngine::DataElementCache::Key::Matches(const Key & aKey) const
+{
+    return (mTraitDataHandle == aKey.mTraitDataHandle && mDataSource == aKey.mDataSource && mDataVersion == aKey.mDataVersion &&
+            mSchemaVersion == aKey.mSchemaVersion && mPropertyPathHandle == aKey.mPropertyPathHandle &&
+            mNumMergeHandles == aKey.mNumMergeHandles && mNumDeleteHandles == aKey.mNumDeleteHandles &&
+            memcmp(mMergeHandleSet, aKey.mMergeHandleSet, mNumMergeHandles * sizeof(PropertyPathHandle)) == 0 &&
+            memcmp(mDeleteHandleSet, aKey.mDeleteHandleSet, mNumDeleteHandles * sizeof(PropertyPathHandle)) == 0);
+}
+
+void NotificationEngine::DataElementCache::Init(void)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE; i++)
+    {
+        mEntries[i].mIsValid = false;
+    }
+
+    mUseCounter = 0;
+    mNumHits    = 0;
+    mNumMisses  = 0;
+}
+
+bool NotificationEngine::DataElementCache::Lookup(const Key & aKey, const uint8_t *& aData, uint32_t & aDataLen)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE; i++)
+    {
+        Entry & entry = mEntries[i];
+
+        if (entry.mIsValid && entry.mKey.Matches(aKey))
+        {
+            entry.mLastUsed = ++mUseCounter;
+            aData           = entry.mData;
+            aDataLen        = entry.mDataLen;
+            mNumHits++;
+            return true;
+        }
+    }
+
+    mNumMisses++;
+    return false;
+}
+
+void NotificationEngine::DataElementCache::Store(const Key & aKey, const uint8_t * aData, uint32_t aDataLen)
+{
+    Entry * victim = NULL;
+
+    if (aDataLen > WDM_PUBLISHER_DATA_ELEMENT_CACHE_ENTRY_SIZE)
+    {
+        return;
+    }
+
+    // Prefer a free entry, otherwise evict the least recently used one. Entries for older versions of the same trait
+    // instance can never match again, so they are reclaimed first.
+    for (size_t i = 0; i < WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE; i++)
+    {
+        Entry & entry = mEntries[i];
+
+        if (!entry.mIsValid || (entry.mKey.mTraitDataHandle == aKey.mTraitDataHandle &&
+                                entry.mKey.mDataVersion != aKey.mDataVersion))
+        {
+            victim = &entry;
+            break;
+        }
+
+        if (victim == NULL || (mUseCounter - entry.mLastUsed) > (mUseCounter - victim->mLastUsed))
+        {
+            victim = &entry;
+        }
+    }
+
+    victim->mKey      = aKey;
+    victim->mLastUsed = ++mUseCounter;
+    victim->mDataLen  = static_cast<uint16_t>(aDataLen);
+    victim->mIsValid  = true;
+    memcpy(victim->mData, aData, aDataLen);
+}
+
+void NotificationEngine::DataElementCache::Invalidate(TraitDataHandle aTraitDataHandle)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE; i++)
+    {
+        if (mEntries[i].mKey.mTraitDataHandle == aTraitDataHandle)
+        {
+            mEntries[i].mIsValid = false;
+        }
+    }
+}
+#endif // WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // NotificationEngine
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 WEAVE_ERROR NotificationEngine::Init()
 {
-    mCurSubscriptionHandlerIdx = 0;
-    mCurTraitInstanceIdx       = 0;
-    mNumNotifiesInFlight       = 0;
+    mCurTraitInstanceIdx   = 0;
+    mNumNotifiesInFlight   = 0;
+    mNumHandlersInRunQueue = 0;
+    mRunQueueHead          = NULL;
+    mRunQueueTail          = NULL;
+    mWaitListHead          = NULL;
+    mEventSubscribersHead  = NULL;
+    mIsGraphSolverDirty    = false;
+
+    ResetNotifyStatistics();
+
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    mDataElementCache.Init();
+#endif
 
     return WEAVE_NO_ERROR;
 }
 
+void NotificationEngine::GetNotifyStatistics(NotifyStatistics & aStats) const
+{
+    aStats = mNotifyStats;
+}
+
+void NotificationEngine::ResetNotifyStatistics(void)
+{
+    memset(&mNotifyStats, 0, sizeof(mNotifyStats));
+    mNotifyStats.mStartTimeMsec = System::Layer::GetClock_MonotonicMS();
+}
+
 #if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
 WEAVE_ERROR NotificationEngine::DeleteKey(TraitDataSource * aDataSource, PropertyPathHandle aPropertyHandle)
 {
@@ -1052,9 +1389,15 @@ WEAVE_ERROR NotificationEngine::DeleteKey(TraitDataSource * aDataSource, Propert
 
     isLocked = true;
 
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    mDataElementCache.Invalidate(dataHandle);
+#endif
+
     err = mGraphSolver.DeleteKey(dataHandle, aPropertyHandle);
     SuccessOrExit(err);
 
+    mIsGraphSolverDirty = true;
+
 exit:
     if (isLocked)
     {
@@ -1080,9 +1423,15 @@ WEAVE_ERROR NotificationEngine::SetDirty(TraitDataSource * aDataSource, Property
 
     isLocked = true;
 
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    mDataElementCache.Invalidate(dataHandle);
+#endif
+
     err = mGraphSolver.SetDirty(dataHandle, aPropertyHandle);
     SuccessOrExit(err);
 
+    mIsGraphSolverDirty = true;
+
 exit:
     if (isLocked)
     {
@@ -1092,6 +1441,168 @@ exit:
     return err;
 }
 
+void NotificationEngine::ScheduleHandler(SubscriptionHandler * aSubHandler)
+{
+    if (aSubHandler->mIsInRunQueue)
+    {
+        return;
+    }
+
+    if (!aSubHandler->IsNotifiable())
+    {
+        ParkHandler(aSubHandler);
+        return;
+    }
+
+    UnscheduleHandler(aSubHandler);
+
+    aSubHandler->mPrevInRunQueue = mRunQueueTail;
+    aSubHandler->mNextInRunQueue = NULL;
+    aSubHandler->mIsInRunQueue   = true;
+
+    if (mRunQueueTail != NULL)
+    {
+        mRunQueueTail->mNextInRunQueue = aSubHandler;
+    }
+    else
+    {
+        mRunQueueHead = aSubHandler;
+    }
+
+    mRunQueueTail = aSubHandler;
+    mNumHandlersInRunQueue++;
+}
+
+void NotificationEngine::ParkHandler(SubscriptionHandler * aSubHandler)
+{
+    if (aSubHandler->mIsInWaitList || !aSubHandler->IsActive())
+    {
+        return;
+    }
+
+    UnscheduleHandler(aSubHandler);
+
+    // The wait list is only ever walked in full, so handlers are simply pushed at its head.
+    aSubHandler->mPrevInRunQueue = NULL;
+    aSubHandler->mNextInRunQueue = mWaitListHead;
+    aSubHandler->mIsInWaitList   = true;
+
+    if (mWaitListHead != NULL)
+    {
+        mWaitListHead->mPrevInRunQueue = aSubHandler;
+    }
+
+    mWaitListHead = aSubHandler;
+}
+
+void NotificationEngine::UnscheduleHandler(SubscriptionHandler * aSubHandler)
+{
+    if (aSubHandler->mIsInWaitList)
+    {
+        if (aSubHandler->mPrevInRunQueue != NULL)
+        {
+            aSubHandler->mPrevInRunQueue->mNextInRunQueue = aSubHandler->mNextInRunQueue;
+        }
+        else
+        {
+            mWaitListHead = aSubHandler->mNextInRunQueue;
+        }
+
+        if (aSubHandler->mNextInRunQueue != NULL)
+        {
+            aSubHandler->mNextInRunQueue->mPrevInRunQueue = aSubHandler->mPrevInRunQueue;
+        }
+
+        aSubHandler->mPrevInRunQueue = NULL;
+        aSubHandler->mNextInRunQueue = NULL;
+        aSubHandler->mIsInWaitList   = false;
+        return;
+    }
+
+    if (!aSubHandler->mIsInRunQueue)
+    {
+        return;
+    }
+
+    if (aSubHandler->mPrevInRunQueue != NULL)
+    {
+        aSubHandler->mPrevInRunQueue->mNextInRunQueue = aSubHandler->mNextInRunQueue;
+    }
+    else
+    {
+        mRunQueueHead = aSubHandler->mNextInRunQueue;
+    }
+
+    if (aSubHandler->mNextInRunQueue != NULL)
+    {
+        aSubHandler->mNextInRunQueue->mPrevInRunQueue = aSubHandler->mPrevInRunQueue;
+    }
+    else
+    {
+        mRunQueueTail = aSubHandler->mPrevInRunQueue;
+    }
+
+    aSubHandler->mPrevInRunQueue = NULL;
+    aSubHandler->mNextInRunQueue = NULL;
+    aSubHandler->mIsInRunQueue   = false;
+    mNumHandlersInRunQueue--;
+}
+
+void NotificationEngine::AddEventSubscriber(SubscriptionHandler * aSubHandler)
+{
+    if (aSubHandler->mIsEventSubscriber)
+    {
+        return;
+    }
+
+    aSubHandler->mPrevEventSubscriber = NULL;
+    aSubHandler->mNextEventSubscriber = mEventSubscribersHead;
+    aSubHandler->mIsEventSubscriber   = true;
+
+    if (mEventSubscribersHead != NULL)
+    {
+        mEventSubscribersHead->mPrevEventSubscriber = aSubHandler;
+    }
+
+    mEventSubscribersHead = aSubHandler;
+}
+
+void NotificationEngine::RemoveEventSubscriber(SubscriptionHandler * aSubHandler)
+{
+    if (!aSubHandler->mIsEventSubscriber)
+    {
+        return;
+    }
+
+    if (aSubHandler->mPrevEventSubscriber != NULL)
+    {
+        aSubHandler->mPrevEventSubscriber->mNextEventSubscriber = aSubHandler->mNextEventSubscriber;
+    }
+    else
+    {
+        mEventSubscribersHead = aSubHandler->mNextEventSubscriber;
+    }
+
+    if (aSubHandler->mNextEventSubscriber != NULL)
+    {
+        aSubHandler->mNextEventSubscriber->mPrevEventSubscriber = aSubHandler->mPrevEventSubscriber;
+    }
+
+    aSubHandler->mPrevEventSubscriber = NULL;
+    aSubHandler->mNextEventSubscriber = NULL;
+    aSubHandler->mIsEventSubscriber   = false;
+}
+
+void NotificationEngine::ScheduleEventSubscribers(void)
+{
+    // Only the handlers subscribed to events are visited, rather than every subscription handler. Scheduling a handler can move
+    // it between the run queue and the wait list, but never changes the list of event subscribers.
+    for (SubscriptionHandler * subHandler = mEventSubscribersHead; subHandler != NULL; subHandler = subHandler->mNextEventSubscriber)
+    {
+        ScheduleHandler(subHandler);
+    }
+}
+
 WEAVE_ERROR NotificationEngine::RetrieveTraitInstanceData(SubscriptionHandler * aSubHandler,
                                                           SubscriptionHandler::TraitInstanceInfo * aTraitInfo,
                                                           NotifyRequestBuilder * aBuilder, bool * aPacketFull)
@@ -1101,7 +1612,7 @@ WEAVE_ERROR NotificationEngine::RetrieveTraitInstanceData(SubscriptionHandler *
     *aPacketFull = false;
 
     err = mGraphSolver.RetrieveTraitInstanceData(aBuilder, aTraitInfo->mTraitDataHandle, aTraitInfo->mRequestedVersion,
-                                                 aSubHandler->IsSubscribing());
+                                                 aSubHandler->IsSubscribing(), aTraitInfo->GetDeltaSyncVersion());
     SuccessOrExit(err);
 
     // Clear out the dirty bit since we're done processing this trait instance.
@@ -1119,7 +1630,8 @@ exit:
 
 WEAVE_ERROR NotificationEngine::SendNotify(PacketBuffer * aBuffer, SubscriptionHandler * aSubHandler)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    WEAVE_ERROR err          = WEAVE_NO_ERROR;
+    const uint16_t notifyLen = aBuffer->DataLength();
 
     err = aSubHandler->SendNotificationRequest(aBuffer);
     SuccessOrExit(err);
@@ -1127,6 +1639,11 @@ WEAVE_ERROR NotificationEngine::SendNotify(PacketBuffer * aBuffer, SubscriptionH
     // We can only have 1 notify in flight for any given subscription - increment and break out.
     mNumNotifiesInFlight++;
 
+    aSubHandler->OnNotifySent(System::Layer::GetClock_MonotonicMS());
+
+    mNotifyStats.mNumNotifiesSent++;
+    mNotifyStats.mNumNotifyBytesSent += notifyLen;
+
 exit:
     return err;
 }
@@ -1138,6 +1655,8 @@ void NotificationEngine::OnNotifyConfirm(SubscriptionHandler * aSubHandler, bool
     WeaveLogDetail(DataManagement, "<NE> OnNotifyConfirm: NumNotifies-- = %d", mNumNotifiesInFlight - 1);
     mNumNotifiesInFlight--;
 
+    aSubHandler->OnNotifyConfirmed(System::Layer::GetClock_MonotonicMS(), aNotifyDelivered);
+
     if (aNotifyDelivered && aSubHandler->mSubscribeToAllEvents)
     {
         LoggingManagement & logger = LoggingManagement::GetInstance();
@@ -1703,13 +2222,14 @@ exit:
 
 void NotificationEngine::Run()
 {
-    WEAVE_ERROR err                  = WEAVE_NO_ERROR;
-    uint32_t numSubscriptionsHandled = 0;
-    SubscriptionEngine * subEngine   = SubscriptionEngine::GetInstance();
-    SubscriptionHandler * subHandler = subEngine->mHandlers + mCurSubscriptionHandlerIdx;
+    WEAVE_ERROR err                = WEAVE_NO_ERROR;
+    SubscriptionEngine * subEngine = SubscriptionEngine::GetInstance();
+    SubscriptionHandler * subHandler;
     bool subscriptionHandled, isSubscriptionClean;
-    bool isClean  = true;
-    bool isLocked = false;
+    bool isClean     = true;
+    bool isLocked    = false;
+    uint64_t nowMsec = System::Layer::GetClock_MonotonicMS();
+    uint32_t holdoffMsec;
 
     // Lock before attempting to modify any of the shared data structures.
     err = subEngine->Lock();
@@ -1717,18 +2237,31 @@ void NotificationEngine::Run()
 
     isLocked = true;
 
-    WeaveLogDetail(DataManagement, "<NE:Run> NotifiesInFlight = %u", mNumNotifiesInFlight);
+    WeaveLogDetail(DataManagement, "<NE:Run> NotifiesInFlight = %u, HandlersInRunQueue = %u", mNumNotifiesInFlight,
+                   mNumHandlersInRunQueue);
 
-    while ((mNumNotifiesInFlight < WDM_PUBLISHER_MAX_NOTIFIES_IN_FLIGHT) &&
-           (numSubscriptionsHandled < SubscriptionEngine::kMaxNumSubscriptionHandlers))
+    while ((mNumNotifiesInFlight < WDM_PUBLISHER_MAX_NOTIFIES_IN_FLIGHT) && (mRunQueueHead != NULL))
     {
+        subHandler = mRunQueueHead;
+        UnscheduleHandler(subHandler);
+
         subscriptionHandled = true;
 
-        // limit the prints to handlers that are in meaingful subscribing/notifying states.
-        if (subHandler->IsNotifying() || subHandler->IsSubscribing())
+        WeaveLogDetail(DataManagement, "<NE:Run> Eval Subscription: %u (state = %s, num-traits = %u)!",
+                       subEngine->GetHandlerId(subHandler), subHandler->GetStateStr(), subHandler->GetNumTraitInstances());
+
+        holdoffMsec = subHandler->GetNotifyHoldoffMsec(nowMsec);
+
+        if (holdoffMsec > 0)
         {
-            WeaveLogDetail(DataManagement, "<NE:Run> Eval Subscription: %u (state = %s, num-traits = %u)!",
-                           mCurSubscriptionHandlerIdx, subHandler->GetStateStr(), subHandler->GetNumTraitInstances());
+            // Let more changes accumulate so they go out together in one notify. The handler waits on the wait list, and is put
+            // back in the run queue when the holdoff timer fires.
+            if (subHandler->StartNotifyHoldoffTimer(holdoffMsec) == WEAVE_NO_ERROR)
+            {
+                mNotifyStats.mNumNotifyHoldoffs++;
+                ParkHandler(subHandler);
+                continue;
+            }
         }
 
         if (subHandler->IsNotifiable())
@@ -1743,38 +2276,34 @@ void NotificationEngine::Run()
                 // TODO: notification based on the event list state.
                 subHandler->OnNotifyProcessingComplete(false, NULL, 0);
             }
-            subHandler->_Release();
-        }
 
-        if (subscriptionHandled)
-        {
-            numSubscriptionsHandled++;
-        }
-        else
-        {
-            WeaveLogDetail(DataManagement, "<NE:Run> Subscription %u not handled", mCurSubscriptionHandlerIdx);
-            numSubscriptionsHandled = 0;
-        }
+            if (!subscriptionHandled)
+            {
+                // Put the handler back at the tail of the queue so that it gets picked up again once the others have had a turn.
+                // This is a no-op if a notify is now in flight - the handler gets re-scheduled when the notify is confirmed.
+                WeaveLogDetail(DataManagement, "<NE:Run> Subscription %u not handled", subEngine->GetHandlerId(subHandler));
+                ScheduleHandler(subHandler);
+            }
 
-        mCurSubscriptionHandlerIdx = (mCurSubscriptionHandlerIdx + 1) % SubscriptionEngine::kMaxNumSubscriptionHandlers;
-        subHandler                 = subEngine->mHandlers + mCurSubscriptionHandlerIdx;
+            subHandler->_Release();
+        }
     }
 
-    subHandler = subEngine->mHandlers;
-    isClean    = true;
-
-    // We only wipe our granular dirty stores if all the subscriptions are clean. To do so, we iterate over
-    // all of them and check each of their dirty flags.
-    for (int i = 0; i < SubscriptionEngine::kMaxNumSubscriptionHandlers; i++)
+    // We only wipe our granular dirty stores if all the subscriptions are clean. Subscriptions still in the run queue might have
+    // dirty data, so there is no point in checking until it drains. A subscription that is not in the run queue can only have
+    // dirty data if it is on the wait list, so only the wait list is checked.
+    if (mIsGraphSolverDirty && mRunQueueHead == NULL)
     {
-        if (subHandler->IsActive())
+        isClean = true;
+
+        for (subHandler = mWaitListHead; (subHandler != NULL) && isClean; subHandler = subHandler->mNextInRunQueue)
         {
             SubscriptionHandler::TraitInstanceInfo * traitInfo = subHandler->GetTraitInstanceInfoList();
             for (size_t j = 0; j < subHandler->GetNumTraitInstances(); j++)
             {
                 if (traitInfo->IsDirty())
                 {
-                    WeaveLogDetail(DataManagement, "<NE:Run> S%u:T%u still dirty", i, j);
+                    WeaveLogDetail(DataManagement, "<NE:Run> S%u:T%u still dirty", subEngine->GetHandlerId(subHandler), j);
                     isClean = false;
                     break;
                 }
@@ -1783,13 +2312,12 @@ void NotificationEngine::Run()
             }
         }
 
-        subHandler++;
-    }
-
-    if (isClean)
-    {
-        WeaveLogDetail(DataManagement, "<NE> Done processing!");
-        mGraphSolver.ClearDirty();
+        if (isClean)
+        {
+            WeaveLogDetail(DataManagement, "<NE> Done processing!");
+            mGraphSolver.ClearDirty();
+            mIsGraphSolverDirty = false;
+        }
     }
 
 exit:
@@ -31,6 +31,7 @@
 #include <Weave/Profiles/data-management/SubscriptionHandler.h>
 #include <Weave/Profiles/data-management/TraitData.h>
 #include <Weave/Profiles/data-management/TraitCatalog.h>
+#include <Weave/Profiles/data-management/TraitPathStore.h>
 
 namespace nl {
 namespace Weave {
@@ -66,9 +67,9 @@ public:
  *           engine will mark dirtiness down to the property handle. This allows it to generate compact notifies that convey as
  *           succinctly as possible the data that has changed. This will be described in more detail in the solvers section.
  *
- *         At its core, it iterates over every subscription, then every dirty instance within that subscription and tries to gather
- *         and pack as much relevant data as possible into a notify message before sending that to the subscriber. It continues to
- *         do so until it has no more work to do. This could be due to a couple of reasons:
+ *         At its core, it iterates over every subscription with pending work, then every dirty instance within that subscription
+ *         and tries to gather and pack as much relevant data as possible into a notify message before sending that to the
+ *         subscriber. It continues to do so until it has no more work to do. This could be due to a couple of reasons:
  *
  *         - Notifies are in flight to the subscriber(s)
  *         - We have exceeded the maximum number of notifies that can be flight across all subscribers.
@@ -84,8 +85,11 @@ public:
  *
  *         Some notable features:
  *
- *         - Subscription fairness: The engine round-robins over all subscriptions and will always resume its work loop at the last
- *           subscription it was trying to process to ensure all subscriptions are handled with equal priority.
+ *         - Subscription fairness: The engine only visits subscriptions that may have work pending (dirty trait instances, pending
+ *           events, or a subscription being established). These are kept in an intrusive first-in first-out run queue, so each
+ *           pass costs time proportional to the number of subscriptions with work rather than the total number of subscriptions,
+ *           and a subscription that could not be completely handled is put back at the tail so all subscriptions are handled with
+ *           equal priority.
  *
  *         - Trait instance fairness: Within a subscription, the engine also rounds robins over all trait instances and will resume
  *           its work loop at the last trait instance that was being processed *for that subscription*. This ensures trait instances
@@ -124,6 +128,31 @@ public:
 
     WEAVE_ERROR DeleteKey(TraitDataSource * aDataSource, PropertyPathHandle aPropertyHandle);
 
+    /**
+     * Schedules every subscription that is subscribed to events to be evaluated on the next call to Run(). Should be called when
+     * new events are available for offload.
+     */
+    void ScheduleEventSubscribers(void);
+
+    /**
+     * Counters describing the notify traffic generated by the engine since it was initialized or the statistics were last
+     * reset. Rates can be derived by dividing by the time elapsed since mStartTimeMsec: notifies per second from
+     * mNumNotifiesSent, the average notify size from mNumNotifyBytesSent / mNumNotifiesSent, and how well changes are being
+     * coalesced from mNumDirtyMarks / mNumNotifiesSent.
+     */
+    struct NotifyStatistics
+    {
+        uint64_t mStartTimeMsec;      ///< Monotonic time at which counting started.
+        uint32_t mNumNotifiesSent;    ///< Number of notify requests handed to the message layer.
+        uint64_t mNumNotifyBytesSent; ///< Total payload bytes of those notify requests.
+        uint32_t mNumDirtyMarks;      ///< Number of times a data source was marked dirty.
+        uint32_t mNumNotifyHoldoffs;  ///< Number of times a notify was held back by per-subscriber rate control.
+    };
+
+    void GetNotifyStatistics(NotifyStatistics & aStats) const;
+
+    void ResetNotifyStatistics(void);
+
 #if WDM_ENABLE_SUBSCRIPTIONLESS_NOTIFICATION
     WEAVE_ERROR SendSubscriptionlessNotification(Binding * const apBinding, TraitPath *aPathList, uint16_t aPathListSize);
 #endif // WDM_ENABLE_SUBSCRIPTIONLESS_NOTIFICATION
@@ -295,14 +324,17 @@ public:
      *         wire, especially for traits with lots of key/value pairs. It is however useful for bring-up or for debugging issues
      *         with the other solvers.
      *
-     *         Constraints: It only supports subscriptions to root and nothing deeper.
+     *         Constraints: It only supports subscriptions to root and nothing deeper. It does not use the change journal of the
+     *         data sources: apSinceVersion is ignored and a subscriber resuming from a known version always gets the whole
+     *         trait instance.
      */
     class BasicGraphSolver
     {
     public:
         static bool IsPropertyPathSupported(PropertyPathHandle aHandle);
         WEAVE_ERROR RetrieveTraitInstanceData(NotifyRequestBuilder * aBuilder, TraitDataHandle aTraitDataHandle,
-                                              SchemaVersion aSchemaVersion, bool aRetrieveAll);
+                                              SchemaVersion aSchemaVersion, bool aRetrieveAll,
+                                              const uint64_t * apSinceVersion = NULL);
         static WEAVE_ERROR SetDirty(TraitDataHandle aTraitDataHandle, PropertyPathHandle aPropertyHandle);
         WEAVE_ERROR ClearDirty(void);
     };
@@ -321,13 +353,26 @@ public:
      *         instance as dirty. In addition, if it runs out of space in the merge handle set, it will degrade to including all
      *         child trees of the LCA'ed node.
      *
+     *         When WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS is non-zero, dirty paths outside of dictionaries are preferably tracked in
+     *         per trait instance bitmaps, which never run out of space. Only paths within dictionary items (which interact with
+     *         the delete store) and traits that don't get a bitmap use the granular store.
+     *
+     *         When WDM_PUBLISHER_CHANGE_JOURNAL_SIZE is non-zero, a request to retrieve all of a trait instance on behalf of a
+     *         subscriber at a known version (apSinceVersion) is narrowed down to the paths that the data source's change
+     *         journal reports as changed since then, if the journal still covers that version.
+     *
      */
     class IntermediateGraphSolver
     {
     public:
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+        IntermediateGraphSolver(void);
+#endif
+
         static bool IsPropertyPathSupported(PropertyPathHandle aHandle);
         WEAVE_ERROR RetrieveTraitInstanceData(NotifyRequestBuilder * aBuilder, TraitDataHandle aTraitDataHandle,
-                                              SchemaVersion aSchemaVersion, bool aRetrieveAll);
+                                              SchemaVersion aSchemaVersion, bool aRetrieveAll,
+                                              const uint64_t * apSinceVersion = NULL);
         WEAVE_ERROR SetDirty(TraitDataHandle aTraitDataHandle, PropertyPathHandle aPropertyHandle);
 
 #if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
@@ -355,22 +400,119 @@ public:
         };
 
     private:
+        friend class TestTdm;
+
         static void ClearTraitInstanceDirty(void * aDataSource, TraitDataHandle aDataHandle, void * aContext);
         PropertyPathHandle GetNextCandidateHandle(uint32_t & aChangeStoreCursor, TraitDataHandle aTargetDataHandle,
-                                                  bool & aCandidateHandleIsDelete);
+                                                  bool & aCandidateHandleIsDelete, TraitDataSource * aJournalSource,
+                                                  uint64_t aSinceVersion);
 
         Store mDirtyStore;
 
 #if TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
         Store mDeleteStore;
 #endif
+
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+        struct DirtyPathBitmap
+        {
+            enum
+            {
+                kNumWords = 2 *
+                    ((WDM_PUBLISHER_DIRTY_PATH_BITMAP_MAX_HANDLES + TraitSchemaEngine::kHandleTableOffset +
+                      PropertyPathBitmap::kBitsPerWord - 1) /
+                     PropertyPathBitmap::kBitsPerWord)
+            };
+
+            TraitDataHandle mTraitDataHandle;
+            bool mIsInUse;
+            PropertyPathBitmap mPaths;
+            PropertyPathBitmap::Word mWords[kNumWords];
+        };
+
+        DirtyPathBitmap * GetDirtyPathBitmap(TraitDataHandle aTraitDataHandle);
+        void ReleaseDirtyPathBitmap(TraitDataHandle aTraitDataHandle);
+        bool SetDirtyInBitmap(TraitDataHandle aTraitDataHandle, PropertyPathHandle aPropertyHandle,
+                              const TraitSchemaEngine * aSchemaEngine);
+
+        DirtyPathBitmap mDirtyPathBitmaps[WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS];
+#endif // WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    };
+
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    /*
+     *  @class DataElementCache
+     *
+     *  @brief A small cache of fully encoded data elements. When a number of subscribers are interested in the same change to the
+     *         same trait instance, the solver computes an identical data element for each of them. Rather than re-walking the
+     *         schema and re-reading every leaf from the data source for each subscriber, the first notify encodes the element and
+     *         the others copy the encoded bytes in.
+     *
+     *         Entries are keyed on the trait instance, its data version, the requested schema version and the set of handles
+     *         (the property path handle plus the merge and delete handle sets) that shape the element. They are invalidated when
+     *         the trait instance is marked dirty and implicitly stop matching once its data version changes. When the cache is
+     *         full, the least recently used entry is evicted.
+     */
+    class DataElementCache
+    {
+    public:
+        struct Key
+        {
+            /**
+             * Initializes the key. Returns false if the element described by the arguments cannot be cached.
+             */
+            bool Init(TraitDataHandle aTraitDataHandle, TraitDataSource * aDataSource, SchemaVersion aSchemaVersion,
+                      PropertyPathHandle aPropertyPathHandle, const PropertyPathHandle * aMergeDataHandleSet,
+                      uint32_t aNumMergeDataHandles, const PropertyPathHandle * aDeleteHandleSet, uint32_t aNumDeleteHandles);
+            bool Matches(const Key & aKey) const;
+
+            TraitDataSource * mDataSource;
+            uint64_t mDataVersion;
+            PropertyPathHandle mPropertyPathHandle;
+            PropertyPathHandle mMergeHandleSet[WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET];
+            PropertyPathHandle mDeleteHandleSet[WDM_PUBLISHER_INTERMEDIATE_SOLVER_MAX_MERGE_HANDLE_SET];
+            TraitDataHandle mTraitDataHandle;
+            SchemaVersion mSchemaVersion;
+            uint8_t mNumMergeHandles;
+            uint8_t mNumDeleteHandles;
+        };
+
+        void Init(void);
+
+        /**
+         * Looks up a previously encoded data element. On a hit, aData points to the members of the data element structure
+         * (including the end of container marker), suitable for passing to TLVWriter::PutPreEncodedContainer.
+         */
+        bool Lookup(const Key & aKey, const uint8_t *& aData, uint32_t & aDataLen);
+        void Store(const Key & aKey, const uint8_t * aData, uint32_t aDataLen);
+        void Invalidate(TraitDataHandle aTraitDataHandle);
+
+        uint32_t GetNumHits(void) const { return mNumHits; }
+        uint32_t GetNumMisses(void) const { return mNumMisses; }
+
+    private:
+        struct Entry
+        {
+            Key mKey;
+            uint32_t mLastUsed;
+            uint16_t mDataLen;
+            bool mIsValid;
+            uint8_t mData[WDM_PUBLISHER_DATA_ELEMENT_CACHE_ENTRY_SIZE];
+        };
+
+        Entry mEntries[WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE];
+        uint32_t mUseCounter;
+        uint32_t mNumHits;
+        uint32_t mNumMisses;
     };
+#endif // WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
 
 private:
     friend class SubscriptionHandler;
     friend class UpdateClient;
     friend class TestTdm;
     friend class TestWdm;
+    friend class TestWdmNotifyScale;
 
     /**
      * Should be invoked when the device receives a NotifyConfirm, or when the Notify request times out.
@@ -381,6 +523,33 @@ private:
      */
     void OnNotifyConfirm(SubscriptionHandler * aSubHandler, bool aNotifyDelivered);
 
+    /**
+     * Appends a subscription handler to the tail of the run queue. This is a no-op if the handler is already queued. A handler
+     * that is active but not in a state where it can be notified is put on the wait list instead.
+     */
+    void ScheduleHandler(SubscriptionHandler * aSubHandler);
+
+    /**
+     * Moves a subscription handler that may still have dirty data, but cannot be notified right now, onto the wait list. The
+     * handler is moved back to the run queue when it is next scheduled. This is a no-op if the handler is not active.
+     */
+    void ParkHandler(SubscriptionHandler * aSubHandler);
+
+    /**
+     * Removes a subscription handler from the run queue or the wait list, if present.
+     */
+    void UnscheduleHandler(SubscriptionHandler * aSubHandler);
+
+    /**
+     * Adds a subscription handler to the list of handlers scheduled by ScheduleEventSubscribers(), if not already present.
+     */
+    void AddEventSubscriber(SubscriptionHandler * aSubHandler);
+
+    /**
+     * Removes a subscription handler from the list of event subscribers, if present.
+     */
+    void RemoveEventSubscriber(SubscriptionHandler * aSubHandler);
+
     WEAVE_ERROR BuildSingleNotifyRequestDataList(SubscriptionHandler * aSubHandler, NotifyRequestBuilder & aNotifyRequest,
                                                  bool & isSubscriptionClean, bool & aNeWriteInProgress);
     WEAVE_ERROR BuildSingleNotifyRequestEventList(SubscriptionHandler * aSubHandler, NotifyRequestBuilder & aNotifyRequest,
@@ -398,11 +567,20 @@ private:
     WEAVE_ERROR BuildSubscriptionlessNotification(PacketBuffer *msgBuf, uint32_t maxPayloadSize, TraitPath *aPathList,
                                                   uint16_t aPathListSize);
 #endif // WDM_ENABLE_SUBSCRIPTIONLESS_NOTIFICATION
-    uint32_t mCurSubscriptionHandlerIdx;
     uint32_t mCurTraitInstanceIdx;
     uint32_t mNumNotifiesInFlight;
+    uint32_t mNumHandlersInRunQueue;
+    SubscriptionHandler * mRunQueueHead;
+    SubscriptionHandler * mRunQueueTail;
+    SubscriptionHandler * mWaitListHead;
+    SubscriptionHandler * mEventSubscribersHead;
+    bool mIsGraphSolverDirty;
+    NotifyStatistics mNotifyStats;
     nl::Weave::TLV::TLVType mOuterContainerType;
     WEAVE_CONFIG_WDM_PUBLISHER_GRAPH_SOLVER mGraphSolver;
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    DataElementCache mDataElementCache;
+#endif
 };
 
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
@@ -90,11 +90,22 @@ void SubscriptionClient::Reset(void)
 
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
     mUpdateMutex                            = NULL;
-    mUpdateInFlight                         = false;
     mMaxUpdateSize                          = 0;
+    mUpdateSequenceNumber                   = 0;
     mUpdateRequestContext.Reset();
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        mUpdateWindow[i].Reset();
+    }
     mPendingSetState = kPendingSetEmpty;
     mPendingUpdateSet.Init(mPendingStore, ArraySize(mPendingStore));
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        mPendingPathBitmaps[i].mPaths.Init(mPendingPathBitmaps[i].mWords, PendingPathBitmap::kNumWords, NULL, 0);
+        ReleasePendingPathBitmap(mPendingPathBitmaps[i]);
+    }
+#endif
     mInProgressUpdateList.Init(mInProgressStore, ArraySize(mInProgressStore));
     mUpdateRetryCounter                     = 0;
     mUpdateRetryScheduled                   = false;
@@ -141,7 +152,6 @@ WEAVE_ERROR SubscriptionClient::Init(Binding * const apBinding, void * const apA
 
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
     mUpdateMutex                            = aUpdateMutex;
-    mUpdateInFlight                         = false;
     mMaxUpdateSize                          = 0;
 
 #endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
@@ -151,8 +161,11 @@ WEAVE_ERROR SubscriptionClient::Init(Binding * const apBinding, void * const apA
 
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
 
-    err = mUpdateClient.Init(mBinding, this, UpdateEventCallback);
-    SuccessOrExit(err);
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        err = mUpdateWindow[i].mUpdateClient.Init(mBinding, this, UpdateEventCallback);
+        SuccessOrExit(err);
+    }
 
     ConfigureUpdatableSinks();
 
@@ -988,7 +1001,10 @@ void SubscriptionClient::_Cleanup(void)
     }
 
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
-    mUpdateClient.Shutdown();
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        mUpdateWindow[i].mUpdateClient.Shutdown();
+    }
 
     mDataSinkCatalog->Iterate(CleanupUpdatableSinkTrait, this);
 #endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
@@ -1414,10 +1430,10 @@ WEAVE_ERROR SubscriptionClient::ProcessDataList(nl::Weave::TLV::TLVReader & aRea
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
     if (false == IsUpdateInProgress())
     {
-        size_t numPendingBefore = mPendingUpdateSet.GetNumItems();
+        size_t numPendingBefore = GetNumPendingPaths();
         PurgePendingUpdate();
 
-        if (numPendingBefore && mPendingUpdateSet.IsEmpty())
+        if (numPendingBefore && IsPendingSetEmpty())
         {
             NoMorePendingEventCbHelper();
         }
@@ -2084,16 +2100,33 @@ void SubscriptionClient::SetMaxUpdateSize(const uint32_t aMaxSize)
  * Skip the private ones, as they will be re-added during the recursion.
  */
 WEAVE_ERROR SubscriptionClient::MoveInProgressToPending(void)
+{
+    return MoveInProgressToPending(0, mInProgressUpdateList.GetPathStoreSize());
+}
+
+/**
+ * Move the paths of a range of the dispatched store back to the pending one,
+ * and remove everything else in the range.
+ * This is used to requeue the paths carried by one request of the update window
+ * while the other requests are still in flight.
+ *
+ * @param[in] aFirstItem    Index of the first item of the range.
+ * @param[in] aEndItem      Index past the last item of the range.
+ */
+WEAVE_ERROR SubscriptionClient::MoveInProgressToPending(size_t aFirstItem, size_t aEndItem)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     uint32_t count = 0;
     TraitDataSink *dataSink;
     TraitPath traitPath;
 
-    for (size_t i = mInProgressUpdateList.GetFirstValidItem();
-            i < mInProgressUpdateList.GetPathStoreSize();
-            i = mInProgressUpdateList.GetNextValidItem(i))
+    for (size_t i = aFirstItem; i < aEndItem && i < mInProgressUpdateList.GetPathStoreSize(); i++)
     {
+        if (! mInProgressUpdateList.IsItemValid(i))
+        {
+            continue;
+        }
+
         mInProgressUpdateList.GetItemAt(i, traitPath);
 
         if ( ! mInProgressUpdateList.AreFlagsSet(i, kFlag_Private))
@@ -2114,15 +2147,26 @@ WEAVE_ERROR SubscriptionClient::MoveInProgressToPending(void)
 
     // Move the state to Ready only if it was Empty; if the application is adding paths,
     // let it decide when to call FlushUpdate.
-    if ((mPendingUpdateSet.GetNumItems() > 0) && (mPendingSetState == kPendingSetEmpty))
+    if ((GetNumPendingPaths() > 0) && (mPendingSetState == kPendingSetEmpty))
     {
         SetPendingSetState(kPendingSetReady);
     }
 
-    // Call clear to remove the private ones as well and anything else.
-    mInProgressUpdateList.Clear();
+    // Remove the private ones as well and anything else.
+    for (size_t i = aFirstItem; i < aEndItem && i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemInUse(i))
+        {
+            mInProgressUpdateList.RemoveItemAt(i);
+        }
+    }
+
+    if (mInProgressUpdateList.IsEmpty())
+    {
+        mInProgressUpdateList.Clear();
 
-    mUpdateRequestContext.Reset();
+        mUpdateRequestContext.Reset();
+    }
 
 exit:
     WeaveLogDetail(DataManagement, "Moved %" PRIu32 " items from InProgress to Pending; err %" PRId32 "", count, err);
@@ -2131,7 +2175,9 @@ exit:
 }
 
 // Move the pending set to the in-progress list, grouping the
-// paths by trait instance
+// paths by trait instance.
+// Pending path bitmaps can hold more paths than the in-progress list;
+// what does not fit stays pending, to be sent once the list is done.
 WEAVE_ERROR SubscriptionClient::MovePendingToInProgress(void)
 {
     VerifyOrDie(mInProgressUpdateList.IsEmpty());
@@ -2141,8 +2187,40 @@ WEAVE_ERROR SubscriptionClient::MovePendingToInProgress(void)
         mDataSinkCatalog->Iterate(MovePendingToInProgressUpdatableSinkTrait, this);
     }
 
-    mPendingUpdateSet.Clear();
-    SetPendingSetState(kPendingSetEmpty);
+    if (mInProgressUpdateList.IsFull())
+    {
+        // Drop what could not be sent anyway, as clearing the set would.
+        for (size_t i = 0; i < mPendingUpdateSet.GetPathStoreSize(); i++)
+        {
+            if (mPendingUpdateSet.IsItemInUse(i) && mPendingUpdateSet.IsItemFailed(i))
+            {
+                mPendingUpdateSet.RemoveItemAt(i);
+            }
+        }
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+        for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+        {
+            if (mPendingPathBitmaps[i].mIsInUse && mPendingPathBitmaps[i].mIsFailed && !mPendingPathBitmaps[i].mIsPurging)
+            {
+                ReleasePendingPathBitmap(mPendingPathBitmaps[i]);
+            }
+        }
+#endif
+    }
+    else
+    {
+        ClearPendingSet();
+    }
+
+    if (IsPendingSetEmpty())
+    {
+        mPendingUpdateSet.Clear();
+        SetPendingSetState(kPendingSetEmpty);
+    }
+    else
+    {
+        WeaveLogDetail(DataManagement, "%u paths left pending", static_cast<unsigned>(GetNumPendingPaths()));
+    }
 
     return WEAVE_NO_ERROR;
 }
@@ -2166,9 +2244,21 @@ void SubscriptionClient::MovePendingToInProgressUpdatableSinkTrait(void * aDataS
 
         err = subClient->mInProgressUpdateList.AddItem(traitPath);
         SuccessOrExit(err);
+        subClient->mPendingUpdateSet.RemoveItemAt(i);
         count++;
     }
 
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    {
+        PendingPathBitmap * bitmap = subClient->GetPendingPathBitmap(aDataHandle);
+
+        if (bitmap != NULL)
+        {
+            subClient->MovePendingPathBitmapToInProgress(*bitmap, count);
+        }
+    }
+#endif
+
 exit:
     WeaveLogDetail(DataManagement, "Moved %d items from Pending to InProgress; err %" PRId32 "", count, err);
     return;
@@ -2226,11 +2316,21 @@ void SubscriptionClient::PurgeAndNotifyFailedPaths(WEAVE_ERROR aErr, TraitPathSt
         }
     }
 
-    if (&aPathStore == &mPendingUpdateSet && aPathStore.IsEmpty())
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    if (&aPathStore == &mPendingUpdateSet)
+    {
+        size_t count;
+
+        PurgeAndNotifyFailedPathBitmaps(aErr, count);
+        aCount += count;
+    }
+#endif
+
+    if (&aPathStore == &mPendingUpdateSet && IsPendingSetEmpty())
     {
         SetPendingSetState(kPendingSetEmpty);
     }
-    if (&aPathStore == &mInProgressUpdateList)
+    if (&aPathStore == &mInProgressUpdateList && aPathStore.IsEmpty())
     {
         mUpdateRequestContext.Reset();
     }
@@ -2241,13 +2341,338 @@ void SubscriptionClient::PurgeAndNotifyFailedPaths(WEAVE_ERROR aErr, TraitPathSt
 WEAVE_ERROR SubscriptionClient::AddItemPendingUpdateSet(const TraitPath &aItem, const TraitSchemaEngine * const aSchemaEngine)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool isAdded = false;
 
-    err = mPendingUpdateSet.AddItemDedup(aItem, aSchemaEngine);
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    isAdded = AddItemPendingPathBitmap(aItem, aSchemaEngine, err);
+#endif
+
+    if (false == isAdded)
+    {
+        err = mPendingUpdateSet.AddItemDedup(aItem, aSchemaEngine);
+    }
 
     WeaveLogDetail(DataManagement, "%s t%u, p%u, err %d", __func__, aItem.mTraitDataHandle, aItem.mPropertyPathHandle, err);
     return err;
 }
 
+/**
+ * @return The number of paths in the pending set, including the failed
+ *          ones that have not been purged yet.
+ */
+size_t SubscriptionClient::GetNumPendingPaths(void)
+{
+    size_t numPaths = mPendingUpdateSet.GetNumItems();
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        if (mPendingPathBitmaps[i].mIsInUse && !mPendingPathBitmaps[i].mIsPurging)
+        {
+            numPaths += mPendingPathBitmaps[i].mPaths.GetNumItems();
+        }
+    }
+#endif
+
+    return numPaths;
+}
+
+/**
+ * @return true if the pending set has paths of the given trait instance
+ *          that have not failed.
+ */
+bool SubscriptionClient::IsTraitPending(TraitDataHandle aTraitDataHandle) const
+{
+    bool retval = mPendingUpdateSet.IsTraitPresent(aTraitDataHandle);
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    retval = retval || (NULL != GetPendingPathBitmap(aTraitDataHandle));
+#endif
+
+    return retval;
+}
+
+/**
+ * @return true if the path itself is in the pending set.
+ */
+bool SubscriptionClient::IsPathPending(const TraitPath &aItem) const
+{
+    bool retval = mPendingUpdateSet.IsPresent(aItem);
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    const PendingPathBitmap * bitmap = GetPendingPathBitmap(aItem.mTraitDataHandle);
+
+    retval = retval || (bitmap != NULL && bitmap->mPaths.IsPresent(aItem.mPropertyPathHandle));
+#endif
+
+    return retval;
+}
+
+/**
+ * @return true if the path or one of its ancestors is in the pending set
+ *          and has not failed.
+ */
+bool SubscriptionClient::IsPathIncludedInPendingSet(const TraitPath &aItem, const TraitSchemaEngine * const aSchemaEngine) const
+{
+    bool retval = mPendingUpdateSet.Includes(aItem, aSchemaEngine);
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    const PendingPathBitmap * bitmap = GetPendingPathBitmap(aItem.mTraitDataHandle);
+
+    retval = retval || (bitmap != NULL && bitmap->mPaths.Includes(aItem.mPropertyPathHandle));
+#endif
+
+    return retval;
+}
+
+/**
+ * Mark all pending paths of a trait instance as failed; they are removed
+ * by PurgeAndNotifyFailedPaths().
+ */
+void SubscriptionClient::SetFailedPendingTrait(TraitDataHandle aTraitDataHandle)
+{
+    mPendingUpdateSet.SetFailedTrait(aTraitDataHandle);
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    PendingPathBitmap * bitmap = GetPendingPathBitmap(aTraitDataHandle);
+
+    if (bitmap != NULL)
+    {
+        bitmap->mIsFailed = true;
+    }
+#endif
+}
+
+/**
+ * Mark all pending paths as failed; they are removed by PurgeAndNotifyFailedPaths().
+ */
+void SubscriptionClient::SetFailedPendingSet(void)
+{
+    mPendingUpdateSet.SetFailed();
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        if (mPendingPathBitmaps[i].mIsInUse && !mPendingPathBitmaps[i].mIsPurging)
+        {
+            mPendingPathBitmaps[i].mIsFailed = true;
+        }
+    }
+#endif
+}
+
+/**
+ * Empty the pending set without notifying the application.
+ */
+void SubscriptionClient::ClearPendingSet(void)
+{
+    mPendingUpdateSet.Clear();
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        if (mPendingPathBitmaps[i].mIsInUse && !mPendingPathBitmaps[i].mIsPurging)
+        {
+            ReleasePendingPathBitmap(mPendingPathBitmaps[i]);
+        }
+    }
+#endif
+}
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+/**
+ * @return The pending path bitmap holding the paths of a trait instance that
+ *          have not failed, or NULL if the trait instance does not have one.
+ */
+const SubscriptionClient::PendingPathBitmap * SubscriptionClient::GetPendingPathBitmap(TraitDataHandle aTraitDataHandle) const
+{
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        const PendingPathBitmap & bitmap = mPendingPathBitmaps[i];
+
+        if (bitmap.mIsInUse && !bitmap.mIsFailed && !bitmap.mIsPurging && bitmap.mTraitDataHandle == aTraitDataHandle)
+        {
+            return &bitmap;
+        }
+    }
+
+    return NULL;
+}
+
+SubscriptionClient::PendingPathBitmap * SubscriptionClient::GetPendingPathBitmap(TraitDataHandle aTraitDataHandle)
+{
+    return const_cast<PendingPathBitmap *>(static_cast<const SubscriptionClient *>(this)->GetPendingPathBitmap(aTraitDataHandle));
+}
+
+void SubscriptionClient::ReleasePendingPathBitmap(PendingPathBitmap & aBitmap)
+{
+    aBitmap.mPaths.Clear();
+    aBitmap.mTraitDataHandle = UINT16_MAX;
+    aBitmap.mIsInUse         = false;
+    aBitmap.mIsFailed        = false;
+    aBitmap.mIsPurging       = false;
+}
+
+/**
+ * Add a path to the pending path bitmap of its trait instance, taking a free
+ * bitmap if the trait instance does not have one yet.
+ * Paths within dictionary items, and paths of trait instances that can't get
+ * a bitmap, are left to the pending path store.
+ *
+ * @param[out] aErr     The result of adding the path, if it was handled.
+ *
+ * @return false if the path has to be added to the pending path store instead.
+ */
+bool SubscriptionClient::AddItemPendingPathBitmap(const TraitPath &aItem, const TraitSchemaEngine * const aSchemaEngine,
+                                                  WEAVE_ERROR &aErr)
+{
+    PendingPathBitmap * bitmap = GetPendingPathBitmap(aItem.mTraitDataHandle);
+    PropertyPathHandle dictionaryItemHandle;
+    bool retval = true;
+
+    aErr = WEAVE_NO_ERROR;
+
+    if (bitmap != NULL && bitmap->mPaths.Includes(aItem.mPropertyPathHandle))
+    {
+        WeaveLogDetail(DataManagement, "Path already present");
+        ExitNow();
+    }
+
+    VerifyOrExit(false == aSchemaEngine->IsInDictionary(aItem.mPropertyPathHandle, dictionaryItemHandle), retval = false);
+
+    if (mPendingUpdateSet.Includes(aItem, aSchemaEngine))
+    {
+        WeaveLogDetail(DataManagement, "Path already present");
+        ExitNow();
+    }
+
+    for (size_t i = 0; (bitmap == NULL) && (i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS); i++)
+    {
+        if (!mPendingPathBitmaps[i].mIsInUse && mPendingPathBitmaps[i].mPaths.Attach(aSchemaEngine) == WEAVE_NO_ERROR)
+        {
+            bitmap                   = &mPendingPathBitmaps[i];
+            bitmap->mTraitDataHandle = aItem.mTraitDataHandle;
+            bitmap->mIsInUse         = true;
+        }
+    }
+
+    VerifyOrExit(bitmap != NULL, retval = false);
+
+    // Remove any paths of the store of which aItem is an ancestor
+    for (size_t i = mPendingUpdateSet.GetFirstValidItem(aItem.mTraitDataHandle);
+            i < mPendingUpdateSet.GetPathStoreSize();
+            i = mPendingUpdateSet.GetNextValidItem(i, aItem.mTraitDataHandle))
+    {
+        TraitPath traitPath;
+
+        mPendingUpdateSet.GetItemAt(i, traitPath);
+
+        if (aSchemaEngine->IsParent(traitPath.mPropertyPathHandle, aItem.mPropertyPathHandle))
+        {
+            mPendingUpdateSet.RemoveItemAt(i);
+        }
+    }
+
+    aErr = bitmap->mPaths.AddItem(aItem.mPropertyPathHandle);
+
+    if (bitmap->mPaths.IsEmpty())
+    {
+        ReleasePendingPathBitmap(*bitmap);
+    }
+
+exit:
+    return retval;
+}
+
+/**
+ * Move as many paths of a pending path bitmap to the in-progress list as
+ * the list can take. The bitmap is released once it is empty.
+ */
+void SubscriptionClient::MovePendingPathBitmapToInProgress(PendingPathBitmap &aBitmap, int &aCount)
+{
+    uint32_t cursor = 0;
+    PropertyPathHandle handle;
+    size_t numMoved = 0;
+
+    while ((handle = aBitmap.mPaths.GetNextItem(cursor)) != kNullPropertyPathHandle)
+    {
+        if (mInProgressUpdateList.AddItem(TraitPath(aBitmap.mTraitDataHandle, handle)) != WEAVE_NO_ERROR)
+        {
+            break;
+        }
+
+        numMoved++;
+    }
+
+    aCount += static_cast<int>(numMoved);
+
+    if (numMoved == aBitmap.mPaths.GetNumItems())
+    {
+        ReleasePendingPathBitmap(aBitmap);
+        ExitNow();
+    }
+
+    // The paths are iterated in the same order; remove the ones that were moved.
+    for (cursor = 0; numMoved > 0; numMoved--)
+    {
+        aBitmap.mPaths.RemoveItem(aBitmap.mPaths.GetNextItem(cursor));
+    }
+
+exit:
+    return;
+}
+
+/**
+ * Like PurgeAndNotifyFailedPaths(), for the failed pending path bitmaps.
+ * The application can call SetUpdated() from the callback: while the paths of
+ * a bitmap are being notified, the bitmap is not looked up nor taken for
+ * new paths.
+ */
+void SubscriptionClient::PurgeAndNotifyFailedPathBitmaps(WEAVE_ERROR aErr, size_t &aCount)
+{
+    aCount = 0;
+
+    for (size_t i = 0; i < WDM_UPDATE_NUM_PENDING_PATH_BITMAPS; i++)
+    {
+        PendingPathBitmap & bitmap = mPendingPathBitmaps[i];
+        TraitUpdatableDataSink * updatableDataSink;
+        PropertyPathHandle handle;
+        uint32_t cursor = 0;
+
+        if (!bitmap.mIsInUse || !bitmap.mIsFailed || bitmap.mIsPurging)
+        {
+            continue;
+        }
+
+        bitmap.mIsPurging = true;
+
+        while ((handle = bitmap.mPaths.GetNextItem(cursor)) != kNullPropertyPathHandle)
+        {
+            // Locate() can return NULL if the datasink has been removed from the catalog.
+            // In that case, the remaining paths are stale.
+            updatableDataSink = Locate(bitmap.mTraitDataHandle, mDataSinkCatalog);
+            if (updatableDataSink == NULL)
+            {
+                break;
+            }
+
+            updatableDataSink->ClearVersion();
+            updatableDataSink->ClearUpdateRequiredVersion();
+            updatableDataSink->SetConditionalUpdate(false);
+
+            UpdateCompleteEventCbHelper(TraitPath(bitmap.mTraitDataHandle, handle),
+                    nl::Weave::Profiles::kWeaveProfile_Common,
+                    nl::Weave::Profiles::Common::kStatus_InternalError,
+                    aErr,
+                    false);
+            aCount++;
+        }
+
+        ReleasePendingPathBitmap(bitmap);
+    }
+}
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+
 void SubscriptionClient::ClearPotentialDataLoss(TraitDataHandle aTraitDataHandle, TraitUpdatableDataSink &aUpdatableSink)
 {
     if (aUpdatableSink.IsPotentialDataLoss())
@@ -2273,7 +2698,7 @@ void SubscriptionClient::MarkFailedPendingPaths(TraitDataHandle aTraitDataHandle
                 aSink.GetUpdateRequiredVersion(),
                 aLatestVersion);
 
-        mPendingUpdateSet.SetFailedTrait(aTraitDataHandle);
+        SetFailedPendingTrait(aTraitDataHandle);
     }
 
     return;
@@ -2286,7 +2711,7 @@ bool SubscriptionClient::FilterNotifiedPath(TraitDataHandle aTraitDataHandle,
     bool retval = false;
 
     retval = mInProgressUpdateList.Includes(TraitPath(aTraitDataHandle, aLeafPathHandle), aSchemaEngine) ||
-             mPendingUpdateSet.Includes(TraitPath(aTraitDataHandle, aLeafPathHandle), aSchemaEngine);
+             IsPathIncludedInPendingSet(TraitPath(aTraitDataHandle, aLeafPathHandle), aSchemaEngine);
 
     if (retval)
     {
@@ -2390,7 +2815,8 @@ void SubscriptionClient::SetPendingSetState(PendingSetState aState)
 }
 
 // TODO: Break this method down into smaller methods.
-void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profiles::StatusReporting::StatusReport * apStatus)
+void SubscriptionClient::OnUpdateResponse(UpdateRequestSlot & aSlot, WEAVE_ERROR aReason,
+                                          nl::Weave::Profiles::StatusReporting::StatusReport * apStatus)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     WEAVE_ERROR callbackerr;
@@ -2411,6 +2837,10 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
     bool isPathSuccessful;
     bool isPathPrivate;
     bool willRetryPath;
+    bool failedUnsentPaths = false;
+    bool needToRefillWindow = false;
+    size_t firstItem;
+    size_t endItem;
 
     // This method invokes callbacks into the upper layer.
     _AddRef();
@@ -2418,13 +2848,18 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
     LockUpdateMutex();
 
     additionalInfo = apStatus->mAdditionalInfo;
-    ClearUpdateInFlight();
+    aSlot.mIsInFlight = false;
 
-    if (mUpdateRequestContext.mIsPartialUpdate)
+    if (aSlot.mIsPartialUpdate)
     {
         WeaveLogDetail(DataManagement, "Got StatusReport in the middle of a long update");
     }
 
+    GetUpdateRequestRange(aSlot, firstItem, endItem);
+
+    WeaveLogDetail(DataManagement, "UpdateRequest %" PRIu32 " completed; items [%zu, %zu)",
+                   aSlot.mSequenceNumber, firstItem, endItem);
+
     WeaveLogDetail(DataManagement, "Received StatusReport %s", nl::StatusReportStr(apStatus->mProfileId, apStatus->mStatusCode));
     WeaveLogDetail(DataManagement, "Received StatusReport additional info %u",
                    additionalInfo.theLength);
@@ -2496,10 +2931,13 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
     // TODO: validate that the version and status lists are either empty or contain
     // the same number of items as the dispatched list
 
-    for (size_t j = mInProgressUpdateList.GetFirstValidItem();
-            j < mInProgressUpdateList.GetPathStoreSize();
-            j = mInProgressUpdateList.GetNextValidItem(j))
+    for (size_t j = firstItem; j < endItem; j++)
     {
+        if (! mInProgressUpdateList.IsItemValid(j))
+        {
+            continue;
+        }
+
         if (IsVersionListPresent)
         {
             err = versionList.Next();
@@ -2564,7 +3002,11 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
                 {
                     updatableDataSink->SetVersion(versionCreated);
                 }
-                if (mPendingUpdateSet.IsPresent(traitPath))
+                // Paths of the same trait instance that are still pending, or in the window
+                // but not carried by this request, are sent against the new version.
+                if (IsPathPending(traitPath) ||
+                        IsTraitInProgress(traitPath.mTraitDataHandle, 0, firstItem) ||
+                        IsTraitInProgress(traitPath.mTraitDataHandle, endItem, mInProgressUpdateList.GetPathStoreSize()))
                 {
                     updatableDataSink->SetUpdateRequiredVersion(versionCreated);
                 }
@@ -2591,10 +3033,11 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
                 mInProgressUpdateList.RemoveItemAt(j);
 
                 // Fail all pending ones as well for VersionMismatch and force resubscribe
-                if (mPendingUpdateSet.IsTraitPresent(traitPath.mTraitDataHandle))
+                if (IsTraitPending(traitPath.mTraitDataHandle))
                 {
-                    mPendingUpdateSet.SetFailedTrait(traitPath.mTraitDataHandle);
+                    SetFailedPendingTrait(traitPath.mTraitDataHandle);
                 }
+                failedUnsentPaths |= FailUnsentUpdates(traitPath.mTraitDataHandle);
                 updatableDataSink->ClearVersion();
                 updatableDataSink->ClearUpdateRequiredVersion();
                 updatableDataSink->SetConditionalUpdate(false);
@@ -2608,10 +3051,15 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
                 {
                     mInProgressUpdateList.RemoveItemAt(j);
 
+                    if (updatableDataSink->IsConditionalUpdate())
+                    {
+                        failedUnsentPaths |= FailUnsentUpdates(traitPath.mTraitDataHandle);
+                    }
+
                     if (updatableDataSink->IsConditionalUpdate() &&
-                            mPendingUpdateSet.IsTraitPresent(traitPath.mTraitDataHandle))
+                            IsTraitPending(traitPath.mTraitDataHandle))
                     {
-                        mPendingUpdateSet.SetFailedTrait(traitPath.mTraitDataHandle);
+                        SetFailedPendingTrait(traitPath.mTraitDataHandle);
                         updatableDataSink->ClearUpdateRequiredVersion();
                         updatableDataSink->SetConditionalUpdate(false);
                     }
@@ -2636,7 +3084,7 @@ void SubscriptionClient::OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profil
             // the next item in the list will be invalid, and the loop will terminate.
             // Either this method or DiscardUpdates will trigger a resubscription.
         }
-    } // for all paths in mInProgressUpdateList
+    } // for all paths carried by the request
 
 exit:
 
@@ -2647,39 +3095,64 @@ exit:
         // If the loop above exited early for an error, the application
         // is notified for any remaining path by the following method.
         // These paths are not retried.
-        mInProgressUpdateList.SetFailed();
+        for (size_t j = firstItem; j < endItem; j++)
+        {
+            if (mInProgressUpdateList.IsItemInUse(j))
+            {
+                mInProgressUpdateList.SetFailed(j);
+            }
+        }
         PurgeAndNotifyFailedPaths(err, mInProgressUpdateList, count);
         needToResubscribe = true;
     }
     else
     {
         // Whatever was not discarded above should be retried
-        err = MoveInProgressToPending();
+        err = MoveInProgressToPending(firstItem, endItem);
         if (err != WEAVE_NO_ERROR)
         {
             AbortUpdates(err);
         }
+        else if (failedUnsentPaths)
+        {
+            size_t count;
+
+            PurgeAndNotifyFailedPaths(WEAVE_ERROR_WDM_VERSION_MISMATCH, mInProgressUpdateList, count);
+        }
     }
 
-    mUpdateRequestContext.Reset();
+    aSlot.Reset();
 
     PurgePendingUpdate();
 
-    if (mPendingSetState == kPendingSetEmpty)
+    if (IsUpdateWindowEmpty() && ! HasUnsentUpdates())
     {
-        mUpdateRetryCounter = 0;
+        mInProgressUpdateList.Clear();
+        mUpdateRequestContext.Reset();
 
-        NoMorePendingEventCbHelper();
+        if (mPendingSetState == kPendingSetEmpty)
+        {
+            mUpdateRetryCounter = 0;
+
+            NoMorePendingEventCbHelper();
+
+            if (CheckForSinksWithDataLoss())
+            {
+                needToResubscribe = true;
+            }
+        }
 
-        if (CheckForSinksWithDataLoss())
+        if (mPendingSetState == kPendingSetReady)
         {
-            needToResubscribe = true;
+            StartUpdateRetryTimer(wholeRequestSucceeded ? WEAVE_NO_ERROR : WEAVE_ERROR_STATUS_REPORT_RECEIVED);
         }
     }
-
-    if (mPendingSetState == kPendingSetReady)
+    else
     {
-        StartUpdateRetryTimer(wholeRequestSucceeded ? WEAVE_NO_ERROR : WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+        // Other requests of the window are in flight, or paths are left to send:
+        // refill the window. Paths that are to be retried wait in the pending set
+        // until the whole window has completed.
+        needToRefillWindow = true;
     }
 
     // If we need to resubscribe, bring it down
@@ -2689,6 +3162,11 @@ exit:
         HandleSubscriptionTerminated(IsRetryEnabled(), err, NULL);
     }
 
+    if (needToRefillWindow && IsUpdateInProgress())
+    {
+        FormAndSendUpdate();
+    }
+
     UnlockUpdateMutex();
 
     WeaveLogFunctError(err);
@@ -2699,23 +3177,47 @@ exit:
 /**
  * This handler is optimized for the case that the request never reached the
  * responder: the dispatched paths are put back in the pending queue and retried.
+ *
+ * @param[in] aError    The reason the request failed.
+ * @param[in] aSlot     The request of the window that failed; if NULL, all the
+ *                      requests of the window are canceled and every dispatched
+ *                      path is put back in the pending queue.
  */
-void SubscriptionClient::OnUpdateNoResponse(WEAVE_ERROR aError)
+void SubscriptionClient::OnUpdateNoResponse(WEAVE_ERROR aError, UpdateRequestSlot * aSlot)
 {
     TraitPath traitPath;
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    size_t firstItem = 0;
+    size_t endItem = mInProgressUpdateList.GetPathStoreSize();
 
     _AddRef();
 
     LockUpdateMutex();
 
-    ClearUpdateInFlight();
+    if (aSlot == NULL)
+    {
+        CancelUpdateWindow();
+    }
+    else
+    {
+        aSlot->mIsInFlight = false;
+
+        GetUpdateRequestRange(*aSlot, firstItem, endItem);
+
+        WeaveLogDetail(DataManagement, "UpdateRequest %" PRIu32 " failed; items [%zu, %zu)",
+                       aSlot->mSequenceNumber, firstItem, endItem);
+
+        aSlot->Reset();
+    }
 
     // Notify the app for all dispatched paths.
-    for (size_t j = mInProgressUpdateList.GetFirstValidItem();
-            j < mInProgressUpdateList.GetPathStoreSize();
-            j = mInProgressUpdateList.GetNextValidItem(j))
+    for (size_t j = firstItem; j < endItem; j++)
     {
+        if (! mInProgressUpdateList.IsItemValid(j))
+        {
+            continue;
+        }
+
         if (! mInProgressUpdateList.AreFlagsSet(j, kFlag_Private))
         {
             mInProgressUpdateList.GetItemAt(j, traitPath);
@@ -2729,7 +3231,7 @@ void SubscriptionClient::OnUpdateNoResponse(WEAVE_ERROR aError)
     }
 
     //Move paths from DispatchedUpdates to PendingUpdates for all TIs.
-    err = MoveInProgressToPending();
+    err = MoveInProgressToPending(firstItem, endItem);
     if (err != WEAVE_NO_ERROR)
     {
         AbortUpdates(err);
@@ -2739,13 +3241,18 @@ void SubscriptionClient::OnUpdateNoResponse(WEAVE_ERROR aError)
         PurgePendingUpdate();
     }
 
-    if (mPendingUpdateSet.IsEmpty())
-    {
-        NoMorePendingEventCbHelper();
-    }
-    else
+    // If other requests of the window are still in flight, their
+    // completion takes care of what is left.
+    if (IsUpdateWindowEmpty())
     {
-        StartUpdateRetryTimer(aError);
+        if (IsPendingSetEmpty() && ! IsUpdateInProgress())
+        {
+            NoMorePendingEventCbHelper();
+        }
+        else
+        {
+            StartUpdateRetryTimer(aError);
+        }
     }
 
     UnlockUpdateMutex();
@@ -2759,28 +3266,36 @@ void SubscriptionClient::UpdateEventCallback (void * const aAppState,
                                               UpdateClient::OutEventParam & aOutParam)
 {
     SubscriptionClient * const pSubClient = reinterpret_cast<SubscriptionClient *>(aAppState);
+    UpdateRequestSlot * slot = NULL;
 
     VerifyOrExit(!(pSubClient->IsAborting()),
             WeaveLogDetail(DataManagement, "<UpdateEventCallback> subscription has been aborted"));
 
+    slot = pSubClient->FindUpdateRequestSlot(aInParam.Source);
+
     switch (aEvent)
     {
     case UpdateClient::kEvent_UpdateComplete:
         WeaveLogDetail(DataManagement, "UpdateComplete event: %d", aEvent);
 
+        VerifyOrExit(slot != NULL, WeaveLogDetail(DataManagement, "<UpdateEventCallback> no request in flight"));
+
         if (aInParam.UpdateComplete.Reason == WEAVE_NO_ERROR)
         {
-            pSubClient->OnUpdateResponse(aInParam.UpdateComplete.Reason, aInParam.UpdateComplete.StatusReportPtr);
+            pSubClient->OnUpdateResponse(*slot, aInParam.UpdateComplete.Reason, aInParam.UpdateComplete.StatusReportPtr);
         }
         else
         {
-            pSubClient->OnUpdateNoResponse(aInParam.UpdateComplete.Reason);
+            pSubClient->OnUpdateNoResponse(aInParam.UpdateComplete.Reason, slot);
         }
 
         break;
     case UpdateClient::kEvent_UpdateContinue:
         WeaveLogDetail(DataManagement, "UpdateContinue event: %d", aEvent);
-        pSubClient->ClearUpdateInFlight();
+
+        VerifyOrExit(slot != NULL, WeaveLogDetail(DataManagement, "<UpdateEventCallback> no request in flight"));
+
+        slot->mIsInFlight = false;
         pSubClient->FormAndSendUpdate();
         break;
     default:
@@ -2817,7 +3332,7 @@ WEAVE_ERROR SubscriptionClient::SetUpdated(TraitUpdatableDataSink * aDataSink, P
     err = mDataSinkCatalog->Locate(aDataSink, dataHandle);
     SuccessOrExit(err);
 
-    isTraitInstanceInUpdate = mPendingUpdateSet.IsTraitPresent(dataHandle) ||
+    isTraitInstanceInUpdate = IsTraitPending(dataHandle) ||
                               mInProgressUpdateList.IsTraitPresent(dataHandle);
 
     // It is not supported to mix conditional and non-conditional updates
@@ -2894,9 +3409,7 @@ void SubscriptionClient::AbortUpdates(WEAVE_ERROR aErr)
 
     mUpdateFlushScheduled = false;
 
-    ClearUpdateInFlight();
-
-    mUpdateClient.CancelUpdate();
+    CancelUpdateWindow();
 
     if (mDataSinkCatalog)
     {
@@ -2911,8 +3424,8 @@ void SubscriptionClient::AbortUpdates(WEAVE_ERROR aErr)
     // If there's an error code, notify the application
     if (aErr == WEAVE_NO_ERROR)
     {
-        numPending = mPendingUpdateSet.GetNumItems();
-        mPendingUpdateSet.Clear();
+        numPending = GetNumPendingPaths();
+        ClearPendingSet();
 
         numInProgress = mInProgressUpdateList.GetNumItems();
         mInProgressUpdateList.Clear();
@@ -2926,7 +3439,7 @@ void SubscriptionClient::AbortUpdates(WEAVE_ERROR aErr)
         // A call to DiscardUpdates() does nothing because all paths are already marked as failed,
         // unless SetUpdated() has been by a callback for an earlier element.
 
-        mPendingUpdateSet.SetFailed();
+        SetFailedPendingSet();
         mInProgressUpdateList.SetFailed();
         PurgeAndNotifyFailedPaths(aErr, mPendingUpdateSet, numPending);
         PurgeAndNotifyFailedPaths(aErr, mInProgressUpdateList, numInProgress);
@@ -2951,7 +3464,7 @@ void SubscriptionClient::RefreshUpdatableSinkTrait(void * aDataSink, TraitDataHa
 
     updatableDataSink = static_cast<TraitUpdatableDataSink *>(dataSink);
 
-    if (subClient->mPendingUpdateSet.IsTraitPresent(aDataHandle))
+    if (subClient->IsTraitPending(aDataHandle))
     {
         refreshTraitInstance = true;
     }
@@ -3008,9 +3521,9 @@ WEAVE_ERROR SubscriptionClient::PurgePendingUpdate()
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     size_t numPendingPathsDeleted = 0;
 
-    WeaveLogDetail(DataManagement, "PurgePendingUpdate: numItems before: %d", mPendingUpdateSet.GetNumItems());
+    WeaveLogDetail(DataManagement, "PurgePendingUpdate: numItems before: %d", GetNumPendingPaths());
 
-    VerifyOrExit(mPendingUpdateSet.GetNumItems() > 0, );
+    VerifyOrExit(GetNumPendingPaths() > 0, );
 
     if (mDataSinkCatalog)
     {
@@ -3025,7 +3538,7 @@ WEAVE_ERROR SubscriptionClient::PurgePendingUpdate()
     }
 
 exit:
-    WeaveLogDetail(DataManagement, "PurgePendingUpdate: numItems after: %d", mPendingUpdateSet.GetNumItems());
+    WeaveLogDetail(DataManagement, "PurgePendingUpdate: numItems after: %d", GetNumPendingPaths());
 
     return err;
 }
@@ -3049,15 +3562,18 @@ exit:
     return;
 }
 
-void SubscriptionClient::SetUpdateStartVersions(void)
+void SubscriptionClient::SetUpdateStartVersions(size_t aFirstItem, size_t aEndItem)
 {
     TraitPath traitPath;
     TraitUpdatableDataSink *updatableSink;
 
-    for (size_t i = mInProgressUpdateList.GetFirstValidItem();
-            i < mInProgressUpdateList.GetPathStoreSize();
-            i = mInProgressUpdateList.GetNextValidItem(i))
+    for (size_t i = aFirstItem; i < aEndItem && i < mInProgressUpdateList.GetPathStoreSize(); i++)
     {
+        if (! mInProgressUpdateList.IsItemValid(i))
+        {
+            continue;
+        }
+
         mInProgressUpdateList.GetItemAt(i, traitPath);
 
         updatableSink = Locate(traitPath.mTraitDataHandle, mDataSinkCatalog);
@@ -3068,7 +3584,19 @@ void SubscriptionClient::SetUpdateStartVersions(void)
     }
 }
 
-WEAVE_ERROR SubscriptionClient::SendSingleUpdateRequest(void)
+/**
+ * Encodes and sends the next payload of an update request, starting from
+ * the first path of mInProgressUpdateList that has not been sent yet.
+ *
+ * With a window of one request, whatever does not fit in the payload is sent in
+ * PartialUpdateRequests on the same exchange. With a larger window, the request is
+ * completed with the paths that fit and the rest of the list is left to the next
+ * request of the window; only a dictionary that overflows the payload is continued
+ * in a PartialUpdateRequest.
+ *
+ * @param[in] aSlot     The request of the window the payload belongs to.
+ */
+WEAVE_ERROR SubscriptionClient::SendSingleUpdateRequest(UpdateRequestSlot & aSlot)
 {
     WEAVE_ERROR err   = WEAVE_NO_ERROR;
     uint32_t maxUpdateSize;
@@ -3076,8 +3604,12 @@ WEAVE_ERROR SubscriptionClient::SendSingleUpdateRequest(void)
     PacketBuffer* pBuf = NULL;
     UpdateEncoder::Context context;
 
+    // The encoder inserts private paths in the list and can't do so
+    // while the responses to other requests have left holes in it.
+    CompactInProgressList();
+
     maxUpdateSize = GetMaxUpdateSize();
-    err = mUpdateClient.mpBinding->AllocateRightSizedBuffer(pBuf, maxUpdateSize, WDM_MIN_UPDATE_SIZE, maxPayloadSize);
+    err = aSlot.mUpdateClient.mpBinding->AllocateRightSizedBuffer(pBuf, maxUpdateSize, WDM_MIN_UPDATE_SIZE, maxPayloadSize);
     SuccessOrExit(err);
 
     mUpdateRequestContext.mIsPartialUpdate = false;
@@ -3096,7 +3628,8 @@ WEAVE_ERROR SubscriptionClient::SendSingleUpdateRequest(void)
 
     mUpdateRequestContext.mNextDictionaryElementPathHandle = context.mNextDictionaryElementPathHandle;
 
-    if (context.mItemInProgress < mInProgressUpdateList.GetPathStoreSize())
+    if (context.mItemInProgress < mInProgressUpdateList.GetPathStoreSize() &&
+            (ArraySize(mUpdateWindow) == 1 || context.mNextDictionaryElementPathHandle != kNullPropertyPathHandle))
     {
         // This is a PartialUpdateRequest; increase the index for the next one
         mUpdateRequestContext.mIsPartialUpdate = true;
@@ -3109,26 +3642,31 @@ WEAVE_ERROR SubscriptionClient::SendSingleUpdateRequest(void)
         if (false == mUpdateRequestContext.mIsPartialUpdate)
         {
             // TODO: Should this happen at the first PartialUpdateRequest, or at the final UpdateRequest?
-            SetUpdateStartVersions();
+            SetUpdateStartVersions(aSlot.mFirstItem, context.mItemInProgress);
         }
 
-        WeaveLogDetail(DataManagement, "Sending %sUpdateRequest with %" PRIu16 " DEs",
+        WeaveLogDetail(DataManagement, "Sending %sUpdateRequest %" PRIu32 " with %" PRIu16 " DEs",
                 mUpdateRequestContext.mIsPartialUpdate ? "Partial" : "",
+                aSlot.mSequenceNumber,
                 context.mNumDataElementsAddedToPayload);
 
-        // TODO: SetUpdateInFlight is here instead of after SendUpdate
-        // to be able to inject timeouts; must improve this..
-        SetUpdateInFlight();
-
-        err = mUpdateClient.SendUpdate(mUpdateRequestContext.mIsPartialUpdate, pBuf, context.mUpdateRequestIndex == 0);
+        err = aSlot.mUpdateClient.SendUpdate(mUpdateRequestContext.mIsPartialUpdate, pBuf, context.mUpdateRequestIndex == 0);
         pBuf = NULL;
         SuccessOrExit(err);
 
+        // An injected timeout fails the request from within SendUpdate,
+        // through OnUpdateNoResponse; the slot is free again then.
+        VerifyOrExit(aSlot.mIsActive, );
+
+        aSlot.mIsInFlight = true;
+        aSlot.mIsPartialUpdate = mUpdateRequestContext.mIsPartialUpdate;
+
         mUpdateRequestContext.mItemInProgress = context.mItemInProgress;
+        aSlot.mEndItem = context.mItemInProgress;
     }
     else
     {
-        mUpdateClient.CancelUpdate();
+        aSlot.mUpdateClient.CancelUpdate();
     }
 
 exit:
@@ -3147,13 +3685,68 @@ exit:
     return err;
 }
 
+/**
+ * Sends payloads until the window of update requests is full or there is
+ * nothing left to send: the request that is being continued with
+ * PartialUpdateRequests is served first; otherwise, new requests are started
+ * from the first path of mInProgressUpdateList that has not been sent yet.
+ *
+ * If a payload can't be sent, the request it belongs to is failed as if it
+ * had not been responded to, and the error is returned.
+ */
+WEAVE_ERROR SubscriptionClient::SendUpdateWindow(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    UpdateRequestSlot * slot;
+
+    while (NULL != (slot = GetNextUpdateRequestSlot()))
+    {
+        if (false == slot->mIsActive)
+        {
+            VerifyOrExit(HasUnsentUpdates(), /* nothing to send */);
+
+            // Conditional updates to a trait instance are all based off the version
+            // the trait instance had when the update started: the paths that follow
+            // one of its requests have to wait for the version it creates.
+            VerifyOrExit(false == IsBlockedByConditionalUpdate(),
+                    WeaveLogDetail(DataManagement, "Waiting for the version of a conditional update"));
+
+            slot->mIsActive = true;
+            slot->mSequenceNumber = mUpdateSequenceNumber++;
+            slot->mFirstItem = mUpdateRequestContext.mItemInProgress;
+            slot->mEndItem = slot->mFirstItem;
+
+            mUpdateRequestContext.mUpdateRequestIndex = 0;
+        }
+
+        err = SendSingleUpdateRequest(*slot);
+        if (err != WEAVE_NO_ERROR)
+        {
+            // If anything failed, the UpdateRequest payload was not sent.
+            // Move paths back to pending and retry later.
+            OnUpdateNoResponse(err, slot);
+            ExitNow();
+        }
+
+        if (false == slot->mIsInFlight)
+        {
+            // Nothing could be encoded.
+            slot->Reset();
+            ExitNow();
+        }
+    }
+
+exit:
+    return err;
+}
+
 void SubscriptionClient::FormAndSendUpdate()
 {
     WEAVE_ERROR err                  = WEAVE_NO_ERROR;
 
     LockUpdateMutex();
 
-    VerifyOrExit(!IsUpdateInFlight(), WeaveLogDetail(DataManagement, "Update request in flight"));
+    VerifyOrExit(NULL != GetNextUpdateRequestSlot(), WeaveLogDetail(DataManagement, "Update request in flight"));
 
     WeaveLogDetail(DataManagement, "Eval Subscription: (state = %s)!", GetStateStr());
 
@@ -3164,8 +3757,8 @@ void SubscriptionClient::FormAndSendUpdate()
             MovePendingToInProgress();
         }
 
-        err = SendSingleUpdateRequest();
-        SuccessOrExit(err);
+        // Failures are handled by SendUpdateWindow.
+        SendUpdateWindow();
 
         WeaveLogDetail(DataManagement, "Done update processing!");
     }
@@ -3181,7 +3774,7 @@ exit:
     {
         // If anything failed, the UpdateRequest payload was not sent.
         // Move paths back to pending and retry later.
-        OnUpdateNoResponse(err);
+        OnUpdateNoResponse(err, NULL);
     }
 
     UnlockUpdateMutex();
@@ -3191,6 +3784,275 @@ exit:
     return;
 }
 
+/**
+ * @return The request of the window the next payload should be sent for: the
+ *          request being continued with PartialUpdateRequests if it is not waiting
+ *          for the previous payload to be acknowledged, or else a free slot.
+ *          NULL if the window is full.
+ */
+SubscriptionClient::UpdateRequestSlot * SubscriptionClient::GetNextUpdateRequestSlot(void)
+{
+    UpdateRequestSlot * freeSlot = NULL;
+
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        UpdateRequestSlot & slot = mUpdateWindow[i];
+
+        if (slot.mIsActive && slot.mIsPartialUpdate)
+        {
+            // The request being continued owns the rest of the list
+            // until its last payload is sent.
+            return slot.mIsInFlight ? NULL : &slot;
+        }
+
+        if (false == slot.mIsActive && NULL == freeSlot)
+        {
+            freeSlot = &slot;
+        }
+    }
+
+    return freeSlot;
+}
+
+SubscriptionClient::UpdateRequestSlot * SubscriptionClient::FindUpdateRequestSlot(const UpdateClient * aUpdateClient)
+{
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        if (mUpdateWindow[i].mIsActive && &(mUpdateWindow[i].mUpdateClient) == aUpdateClient)
+        {
+            return &mUpdateWindow[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Computes the range of mInProgressUpdateList a request of the window applies to.
+ * A request that has not sent its last payload yet also owns the paths that were not
+ * sent: they are given the same fate as the request's, and nothing is left to send.
+ *
+ * @param[in]  aSlot        The request.
+ * @param[out] aFirstItem   Index of the first item of the range.
+ * @param[out] aEndItem     Index past the last item of the range.
+ */
+void SubscriptionClient::GetUpdateRequestRange(UpdateRequestSlot & aSlot, size_t & aFirstItem, size_t & aEndItem)
+{
+    aFirstItem = aSlot.mFirstItem;
+    aEndItem = aSlot.mEndItem;
+
+    if (aSlot.mIsPartialUpdate || aSlot.mEndItem == aSlot.mFirstItem)
+    {
+        aEndItem = mInProgressUpdateList.GetPathStoreSize();
+
+        mUpdateRequestContext.mItemInProgress = aEndItem;
+        mUpdateRequestContext.mNextDictionaryElementPathHandle = kNullPropertyPathHandle;
+        mUpdateRequestContext.mUpdateRequestIndex = 0;
+        mUpdateRequestContext.mIsPartialUpdate = false;
+    }
+}
+
+void SubscriptionClient::CancelUpdateWindow(void)
+{
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        mUpdateWindow[i].mUpdateClient.CancelUpdate();
+        mUpdateWindow[i].Reset();
+    }
+
+    mUpdateRequestContext.Reset();
+}
+
+bool SubscriptionClient::IsUpdateWindowEmpty(void) const
+{
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        if (mUpdateWindow[i].mIsActive)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SubscriptionClient::IsUpdateInFlight(void) const
+{
+    for (size_t i = 0; i < ArraySize(mUpdateWindow); i++)
+    {
+        if (mUpdateWindow[i].mIsInFlight)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @return true if mInProgressUpdateList has valid paths that have not been sent yet.
+ */
+bool SubscriptionClient::HasUnsentUpdates(void)
+{
+    for (size_t i = mUpdateRequestContext.mItemInProgress; i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemValid(i))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @return true if the first path that has not been sent yet belongs to a trait instance
+ *          updated conditionally that has paths in a request in flight.
+ */
+bool SubscriptionClient::IsBlockedByConditionalUpdate(void)
+{
+    TraitPath traitPath;
+    TraitUpdatableDataSink * updatableDataSink;
+    size_t i;
+
+    for (i = mUpdateRequestContext.mItemInProgress; i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemValid(i))
+        {
+            break;
+        }
+    }
+
+    VerifyOrExit(i < mInProgressUpdateList.GetPathStoreSize(), );
+
+    mInProgressUpdateList.GetItemAt(i, traitPath);
+
+    updatableDataSink = Locate(traitPath.mTraitDataHandle, mDataSinkCatalog);
+    VerifyOrExit(NULL != updatableDataSink && updatableDataSink->IsConditionalUpdate(), );
+
+    for (size_t j = 0; j < ArraySize(mUpdateWindow); j++)
+    {
+        if (mUpdateWindow[j].mIsActive &&
+                IsTraitInProgress(traitPath.mTraitDataHandle, mUpdateWindow[j].mFirstItem, mUpdateWindow[j].mEndItem))
+        {
+            return true;
+        }
+    }
+
+exit:
+    return false;
+}
+
+/**
+ * @return true if a range of mInProgressUpdateList has valid paths of a trait instance.
+ */
+bool SubscriptionClient::IsTraitInProgress(TraitDataHandle aTraitDataHandle, size_t aFirstItem, size_t aEndItem)
+{
+    TraitPath traitPath;
+
+    for (size_t i = aFirstItem; i < aEndItem && i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemValid(i))
+        {
+            mInProgressUpdateList.GetItemAt(i, traitPath);
+
+            if (traitPath.mTraitDataHandle == aTraitDataHandle)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Fails the paths of a trait instance that have not been sent yet, after a
+ * conditional update of the trait instance has failed. The caller is expected
+ * to purge them with PurgeAndNotifyFailedPaths.
+ *
+ * @return true if any path was failed.
+ */
+bool SubscriptionClient::FailUnsentUpdates(TraitDataHandle aTraitDataHandle)
+{
+    TraitPath traitPath;
+    bool retval = false;
+
+    for (size_t i = mUpdateRequestContext.mItemInProgress; i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemValid(i))
+        {
+            mInProgressUpdateList.GetItemAt(i, traitPath);
+
+            if (traitPath.mTraitDataHandle == aTraitDataHandle)
+            {
+                mInProgressUpdateList.SetFailed(i);
+                retval = true;
+            }
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * @return The number of items in use in mInProgressUpdateList before a given index; that is,
+ *          the index the item would have after the list is compacted.
+ */
+size_t SubscriptionClient::CountInProgressItemsBefore(size_t aIndex)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < aIndex && i < mInProgressUpdateList.GetPathStoreSize(); i++)
+    {
+        if (mInProgressUpdateList.IsItemInUse(i))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Compacts mInProgressUpdateList after the responses to some requests of the window have
+ * removed their paths, and translates the ranges of the requests still in flight and the
+ * position of the first path not sent yet accordingly. Compacting preserves the order of
+ * the items, so every range still covers the same paths.
+ */
+void SubscriptionClient::CompactInProgressList(void)
+{
+    const size_t numItems = mInProgressUpdateList.GetNumItems();
+    size_t i;
+
+    for (i = 0; i < numItems; i++)
+    {
+        if (! mInProgressUpdateList.IsItemInUse(i))
+        {
+            break;
+        }
+    }
+
+    // No holes.
+    VerifyOrExit(i < numItems, );
+
+    for (size_t j = 0; j < ArraySize(mUpdateWindow); j++)
+    {
+        if (mUpdateWindow[j].mIsActive)
+        {
+            mUpdateWindow[j].mFirstItem = CountInProgressItemsBefore(mUpdateWindow[j].mFirstItem);
+            mUpdateWindow[j].mEndItem = CountInProgressItemsBefore(mUpdateWindow[j].mEndItem);
+        }
+    }
+
+    mUpdateRequestContext.mItemInProgress = CountInProgressItemsBefore(mUpdateRequestContext.mItemInProgress);
+
+    mInProgressUpdateList.Compact();
+
+exit:
+    return;
+}
+
 /**
  * Signals that the application has finished mutating all TraitUpdatableDataSinks.
  * Unless a previous update exchange is in progress, the client will
@@ -3360,6 +4222,16 @@ void SubscriptionClient::UpdateRequestContext::Reset()
     mIsPartialUpdate = false;
 }
 
+void SubscriptionClient::UpdateRequestSlot::Reset()
+{
+    mSequenceNumber = 0;
+    mFirstItem = 0;
+    mEndItem = 0;
+    mIsActive = false;
+    mIsInFlight = false;
+    mIsPartialUpdate = false;
+}
+
 #endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
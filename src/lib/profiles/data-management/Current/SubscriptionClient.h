@@ -558,6 +558,24 @@ private:
         uint32_t mUpdateRequestIndex;
         bool mIsPartialUpdate;
     };
+
+    /**
+     * One UpdateRequest of the update window. A request carries a contiguous
+     * range of mInProgressUpdateList; the range is what its StatusList and
+     * VersionList are applied to when the response comes back.
+     */
+    struct UpdateRequestSlot
+    {
+        void Reset();
+
+        UpdateClient mUpdateClient;
+        uint32_t mSequenceNumber;   /**< Order in which the request was started, for logging. */
+        size_t mFirstItem;          /**< Index in mInProgressUpdateList of the first path carried by the request. */
+        size_t mEndItem;            /**< Index past the last path carried by the request so far. */
+        bool mIsActive;             /**< The slot is carrying a request. */
+        bool mIsInFlight;           /**< A payload of the request is waiting for its response. */
+        bool mIsPartialUpdate;      /**< The last payload sent was a PartialUpdateRequest. */
+    };
     uint32_t mUpdateRetryCounter;
     bool mSuspendUpdateRetries;
     bool mUpdateRetryScheduled;
@@ -573,13 +591,28 @@ private:
 
     // Methods to encode and send update requests
     void FormAndSendUpdate();
-    WEAVE_ERROR SendSingleUpdateRequest(void);
+    WEAVE_ERROR SendUpdateWindow(void);
+    WEAVE_ERROR SendSingleUpdateRequest(UpdateRequestSlot & aSlot);
     static WEAVE_ERROR AddElementFunc(UpdateEncoder * aEncoder, void * apCallState, TLV::TLVWriter & aOuterWriter);
-    void SetUpdateStartVersions(void);
+    void SetUpdateStartVersions(size_t aFirstItem, size_t aEndItem);
+
+    // Methods to manage the window of update requests
+    UpdateRequestSlot * GetNextUpdateRequestSlot(void);
+    UpdateRequestSlot * FindUpdateRequestSlot(const UpdateClient * aUpdateClient);
+    void GetUpdateRequestRange(UpdateRequestSlot & aSlot, size_t & aFirstItem, size_t & aEndItem);
+    void CancelUpdateWindow(void);
+    bool IsUpdateWindowEmpty(void) const;
+    bool HasUnsentUpdates(void);
+    bool IsBlockedByConditionalUpdate(void);
+    bool IsTraitInProgress(TraitDataHandle aTraitDataHandle, size_t aFirstItem, size_t aEndItem);
+    bool FailUnsentUpdates(TraitDataHandle aTraitDataHandle);
+    size_t CountInProgressItemsBefore(size_t aIndex);
+    void CompactInProgressList(void);
 
     // Methods to handle update response and exchange failures (OnResponseTimeout, OnSendError)
-    void OnUpdateResponse(WEAVE_ERROR aReason, nl::Weave::Profiles::StatusReporting::StatusReport * apStatus);
-    void OnUpdateNoResponse(WEAVE_ERROR aReason);
+    void OnUpdateResponse(UpdateRequestSlot & aSlot, WEAVE_ERROR aReason,
+                          nl::Weave::Profiles::StatusReporting::StatusReport * apStatus);
+    void OnUpdateNoResponse(WEAVE_ERROR aReason, UpdateRequestSlot * aSlot);
     static bool WillRetryUpdate(WEAVE_ERROR aErr, uint32_t aStatusProfileId, uint16_t aStatusCode);
 
     // Methods to purge obsolete pending paths
@@ -608,12 +641,19 @@ private:
     void SetPendingSetState(PendingSetState aState);
     WEAVE_ERROR MovePendingToInProgress(void);
     WEAVE_ERROR AddItemPendingUpdateSet(const TraitPath & aItem, const TraitSchemaEngine * const aSchemaEngine);
+    size_t GetNumPendingPaths(void);
+    bool IsPendingSetEmpty(void) { return GetNumPendingPaths() == 0; }
+    bool IsTraitPending(TraitDataHandle aTraitDataHandle) const;
+    bool IsPathPending(const TraitPath & aItem) const;
+    bool IsPathIncludedInPendingSet(const TraitPath & aItem, const TraitSchemaEngine * const aSchemaEngine) const;
+    void SetFailedPendingTrait(TraitDataHandle aTraitDataHandle);
+    void SetFailedPendingSet(void);
+    void ClearPendingSet(void);
     WEAVE_ERROR MoveInProgressToPending(void);
+    WEAVE_ERROR MoveInProgressToPending(size_t aFirstItem, size_t aEndItem);
 
     // Tracking if a payload is in flight
-    bool IsUpdateInFlight() { return mUpdateInFlight; }
-    void SetUpdateInFlight() { mUpdateInFlight = true; }
-    void ClearUpdateInFlight() { mUpdateInFlight = false; }
+    bool IsUpdateInFlight(void) const;
 
     // Knowing if an update is pending or in progress
     bool IsUpdateInProgress() { return (false == mInProgressUpdateList.IsEmpty()); }
@@ -624,7 +664,7 @@ private:
                                      WEAVE_ERROR aReason, bool aWillRetry);
     void NoMorePendingEventCbHelper(void);
 
-    // Other methods related to mUpdateClient
+    // Other methods related to the UpdateClients of the window
     static void UpdateEventCallback(void * const aAppState, UpdateClient::EventType aEvent,
                                     const UpdateClient::InEventParam & aInParam, UpdateClient::OutEventParam & aOutParam);
     void AbortUpdates(WEAVE_ERROR);
@@ -640,7 +680,7 @@ private:
     bool mResubscribeNeeded;
     UpdateRequestContext mUpdateRequestContext;
     uint16_t mMaxUpdateSize;
-    bool mUpdateInFlight;
+    uint32_t mUpdateSequenceNumber;
 
     // Flags used with mInProgressUpdateList
     enum
@@ -661,10 +701,41 @@ private:
     TraitPathStore mPendingUpdateSet;
     TraitPathStore::Record mPendingStore[WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE];
 
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    // The pending paths of a trait instance that are not within dictionary items;
+    // see WDM_UPDATE_NUM_PENDING_PATH_BITMAPS.
+    struct PendingPathBitmap
+    {
+        enum
+        {
+            kNumWords = 2 *
+                ((WDM_UPDATE_PENDING_PATH_BITMAP_MAX_HANDLES + TraitSchemaEngine::kHandleTableOffset +
+                  PropertyPathBitmap::kBitsPerWord - 1) /
+                 PropertyPathBitmap::kBitsPerWord)
+        };
+
+        TraitDataHandle mTraitDataHandle;
+        bool mIsInUse;
+        bool mIsFailed;     /**< Like TraitPathStore::SetFailed(), for all paths of the bitmap. */
+        bool mIsPurging;    /**< The application is being notified about the paths of the bitmap. */
+        PropertyPathBitmap mPaths;
+        PropertyPathBitmap::Word mWords[kNumWords];
+    };
+
+    const PendingPathBitmap * GetPendingPathBitmap(TraitDataHandle aTraitDataHandle) const;
+    PendingPathBitmap * GetPendingPathBitmap(TraitDataHandle aTraitDataHandle);
+    void ReleasePendingPathBitmap(PendingPathBitmap & aBitmap);
+    bool AddItemPendingPathBitmap(const TraitPath & aItem, const TraitSchemaEngine * const aSchemaEngine, WEAVE_ERROR & aErr);
+    void MovePendingPathBitmapToInProgress(PendingPathBitmap & aBitmap, int & aCount);
+    void PurgeAndNotifyFailedPathBitmaps(WEAVE_ERROR aErr, size_t & aCount);
+
+    PendingPathBitmap mPendingPathBitmaps[WDM_UPDATE_NUM_PENDING_PATH_BITMAPS];
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+
     TraitPathStore mInProgressUpdateList;
     TraitPathStore::Record mInProgressStore[WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE];
 
-    UpdateClient mUpdateClient;
+    UpdateRequestSlot mUpdateWindow[WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS];
     UpdateEncoder mUpdateEncoder;
 #endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
 };
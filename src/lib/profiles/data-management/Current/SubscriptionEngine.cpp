@@ -101,6 +101,11 @@ WEAVE_ERROR SubscriptionEngine::Init(nl::Weave::WeaveExchangeManager * const apE
 #endif // WDM_ENABLE_SUBSCRIPTION_PUBLISHER
 
     mNumTraitInfosInPool = 0;
+    InitTraitInstanceIndex();
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    mIsParallelDataListApplicationEnabled = false;
+#endif
 
 exit:
     WeaveLogFunctError(err);
@@ -108,6 +113,15 @@ exit:
     return err;
 }
 
+void SubscriptionEngine::Shutdown(void)
+{
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    EnableParallelDataListApplication(false);
+#endif
+
+    mExchangeMgr->UnregisterUnsolicitedMessageHandler(nl::Weave::Profiles::kWeaveProfile_WDM);
+}
+
 #if WEAVE_DETAIL_LOGGING
 void SubscriptionEngine::LogSubscriptionFreed(void) const
 {
@@ -466,6 +480,11 @@ WEAVE_ERROR SubscriptionEngine::ProcessDataList(nl::Weave::TLV::TLVReader & aRea
                                                 IDataElementAccessControlDelegate & acDelegate)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    SubscriptionEngine * const engine = SubscriptionEngine::GetInstance();
+    DataListWorkerPool * const workerPool =
+        engine->mIsParallelDataListApplicationEnabled ? &engine->mDataListWorkerPool : NULL;
+#endif
 
     // TODO: We currently don't support changes that span multiple notifies, nor changes
     // that get aborted and restarted within the same notify. See WEAV-1586 for more details.
@@ -571,8 +590,23 @@ WEAVE_ERROR SubscriptionEngine::ProcessDataList(nl::Weave::TLV::TLVReader & aRea
             flags |= TraitDataSink::kLastElementInChange;
         }
 
-        err = dataSink->StoreDataElement(pathHandle, pathReader, flags, NULL, NULL, handle);
-        SuccessOrExit(err);
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+        if (NULL != workerPool)
+        {
+            if (workerPool->IsFull())
+            {
+                err = workerPool->Run();
+                SuccessOrExit(err);
+            }
+
+            workerPool->AddItem(dataSink, handle, pathHandle, pathReader, flags);
+        }
+        else
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+        {
+            err = dataSink->StoreDataElement(pathHandle, pathReader, flags, NULL, NULL, handle);
+            SuccessOrExit(err);
+        }
 
         aOutIsPartialChange = isPartialChange;
 
@@ -587,10 +621,262 @@ WEAVE_ERROR SubscriptionEngine::ProcessDataList(nl::Weave::TLV::TLVReader & aRea
         err = WEAVE_NO_ERROR;
     }
 
+exit:
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    // Whatever was queued precedes the point of any failure, so it gets applied just like it would have been serially.
+    if (NULL != workerPool)
+    {
+        WEAVE_ERROR runErr = workerPool->Run();
+
+        if (WEAVE_NO_ERROR == err)
+        {
+            err = runErr;
+        }
+    }
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+
+    return err;
+
+}
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+void SubscriptionEngine::EnableParallelDataListApplication(bool aEnable)
+{
+    if (aEnable)
+    {
+        mDataListWorkerPool.Start();
+    }
+    else
+    {
+        mDataListWorkerPool.Stop();
+    }
+
+    mIsParallelDataListApplicationEnabled = aEnable;
+}
+
+SubscriptionEngine::DataListWorkerPool::DataListWorkerPool(void) :
+    mIsStarted(false), mNumItems(0), mNumPartitions(0), mNextPartition(0), mNumPartitionsDone(0), mIsStopping(false)
+{ }
+
+void SubscriptionEngine::DataListWorkerPool::Start(void)
+{
+    int pthreadErr;
+
+    VerifyOrExit(!mIsStarted, );
+
+    pthreadErr = pthread_mutex_init(&mMutex, NULL);
+    VerifyOrDie(pthreadErr == 0);
+
+    pthreadErr = pthread_cond_init(&mWorkCondVar, NULL);
+    VerifyOrDie(pthreadErr == 0);
+
+    pthreadErr = pthread_cond_init(&mDoneCondVar, NULL);
+    VerifyOrDie(pthreadErr == 0);
+
+    mIsStopping = false;
+
+    for (int i = 0; i < WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT; i++)
+    {
+        pthreadErr = pthread_create(&mThreads[i], NULL, &WorkerThreadMain, this);
+        VerifyOrDie(pthreadErr == 0);
+    }
+
+    mIsStarted = true;
+
+exit:
+    return;
+}
+
+void SubscriptionEngine::DataListWorkerPool::Stop(void)
+{
+    int pthreadErr;
+
+    VerifyOrExit(mIsStarted, );
+
+    pthread_mutex_lock(&mMutex);
+    mIsStopping = true;
+    pthread_cond_broadcast(&mWorkCondVar);
+    pthread_mutex_unlock(&mMutex);
+
+    for (int i = 0; i < WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT; i++)
+    {
+        pthreadErr = pthread_join(mThreads[i], NULL);
+        VerifyOrDie(pthreadErr == 0);
+    }
+
+    pthread_cond_destroy(&mDoneCondVar);
+    pthread_cond_destroy(&mWorkCondVar);
+    pthread_mutex_destroy(&mMutex);
+
+    mIsStarted = false;
+
+exit:
+    return;
+}
+
+void SubscriptionEngine::DataListWorkerPool::AddItem(TraitDataSink * aDataSink, TraitDataHandle aTraitDataHandle,
+                                                     PropertyPathHandle aPropertyPathHandle,
+                                                     const nl::Weave::TLV::TLVReader & aReader, uint8_t aFlags)
+{
+    Item & item = mItems[mNumItems++];
+
+    item.mDataSink           = aDataSink;
+    item.mTraitDataHandle    = aTraitDataHandle;
+    item.mPropertyPathHandle = aPropertyPathHandle;
+    item.mReader.Init(aReader);
+    item.mFlags              = aFlags;
+}
+
+WEAVE_ERROR SubscriptionEngine::DataListWorkerPool::Run(void)
+{
+    WEAVE_ERROR err   = WEAVE_NO_ERROR;
+    size_t failedItem = mNumItems;
+
+    VerifyOrExit(mNumItems > 0, );
+
+    pthread_mutex_lock(&mMutex);
+
+    // One partition per trait instance with a thread-safe sink, in order of first appearance.
+    for (size_t i = 0; i < mNumItems; i++)
+    {
+        size_t j;
+
+        if (!mItems[i].mDataSink->IsThreadSafe())
+        {
+            continue;
+        }
+
+        for (j = 0; j < mNumPartitions && mPartitions[j].mTraitDataHandle != mItems[i].mTraitDataHandle; j++)
+            ;
+
+        if (j == mNumPartitions)
+        {
+            mPartitions[mNumPartitions].mTraitDataHandle = mItems[i].mTraitDataHandle;
+            mPartitions[mNumPartitions].mFailedItem      = mNumItems;
+            mPartitions[mNumPartitions].mErr             = WEAVE_NO_ERROR;
+            mNumPartitions++;
+        }
+    }
+
+    mNextPartition     = 0;
+    mNumPartitionsDone = 0;
+
+    if (mNumPartitions > 0)
+    {
+        pthread_cond_broadcast(&mWorkCondVar);
+    }
+
+    pthread_mutex_unlock(&mMutex);
+
+    // The sinks that aren't thread-safe are only ever called here, on the Weave thread, in list order.
+    ApplyItems(NULL, failedItem, err);
+
+    // Then the Weave thread takes its share of the partitions and waits for the workers to finish theirs.
+    pthread_mutex_lock(&mMutex);
+
+    ApplyPartitionsLocked();
+
+    while (mNumPartitionsDone < mNumPartitions)
+    {
+        pthread_cond_wait(&mDoneCondVar, &mMutex);
+    }
+
+    for (size_t i = 0; i < mNumPartitions; i++)
+    {
+        if (mPartitions[i].mFailedItem < failedItem)
+        {
+            failedItem = mPartitions[i].mFailedItem;
+            err        = mPartitions[i].mErr;
+        }
+    }
+
+    mNumPartitions = 0;
+    mNextPartition = 0;
+
+    pthread_mutex_unlock(&mMutex);
+
+    mNumItems = 0;
+
 exit:
     return err;
+}
+
+void * SubscriptionEngine::DataListWorkerPool::WorkerThreadMain(void * aArg)
+{
+    DataListWorkerPool * const pool = static_cast<DataListWorkerPool *>(aArg);
+
+    pthread_mutex_lock(&pool->mMutex);
+
+    while (true)
+    {
+        while (!pool->mIsStopping && pool->mNextPartition >= pool->mNumPartitions)
+        {
+            pthread_cond_wait(&pool->mWorkCondVar, &pool->mMutex);
+        }
+
+        if (pool->mIsStopping)
+        {
+            break;
+        }
+
+        pool->ApplyPartitionsLocked();
+    }
+
+    pthread_mutex_unlock(&pool->mMutex);
+
+    return NULL;
+}
+
+void SubscriptionEngine::DataListWorkerPool::ApplyPartitionsLocked(void)
+{
+    while (mNextPartition < mNumPartitions)
+    {
+        Partition & partition = mPartitions[mNextPartition++];
+        size_t failedItem     = mNumItems;
+        WEAVE_ERROR err       = WEAVE_NO_ERROR;
+
+        pthread_mutex_unlock(&mMutex);
+
+        ApplyItems(&partition, failedItem, err);
+
+        pthread_mutex_lock(&mMutex);
+
+        partition.mFailedItem = failedItem;
+        partition.mErr        = err;
+
+        if (++mNumPartitionsDone == mNumPartitions)
+        {
+            pthread_cond_signal(&mDoneCondVar);
+        }
+    }
+}
+
+void SubscriptionEngine::DataListWorkerPool::ApplyItems(const Partition * aPartition, size_t & aOutFailedItem,
+                                                        WEAVE_ERROR & aOutErr)
+{
+    // mItems isn't resized while a batch is applied, and each item is only touched by the one thread applying it. While the
+    // batch is applied, the Weave thread holds the update mutex of the subscription client (see
+    // SubscriptionClient::ProcessDataList), so the updates the sinks check their paths against can't change under them.
+    for (size_t i = 0; i < mNumItems; i++)
+    {
+        Item & item = mItems[i];
+
+        // Without a partition, only the items of the sinks that aren't thread-safe are applied.
+        if ((aPartition != NULL) ? (item.mTraitDataHandle != aPartition->mTraitDataHandle) : item.mDataSink->IsThreadSafe())
+        {
+            continue;
+        }
 
+        aOutErr = item.mDataSink->StoreDataElement(item.mPropertyPathHandle, item.mReader, item.mFlags, NULL, NULL,
+                                                   item.mTraitDataHandle);
+        if (aOutErr != WEAVE_NO_ERROR)
+        {
+            aOutFailedItem = i;
+            break;
+        }
+    }
 }
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
 
 #if WDM_ENABLE_SUBSCRIPTIONLESS_NOTIFICATION
 WEAVE_ERROR SubscriptionEngine::RegisterForSubscriptionlessNotifications(
@@ -932,6 +1218,12 @@ void SubscriptionEngine::ReclaimTraitInfo(SubscriptionHandler * const aHandlerTo
     const uint16_t numTraitInstances                             = aHandlerToBeReclaimed->mNumTraitInstances;
     size_t numTraitInstancesToBeAffected;
 
+    // Take the trait instances out of the index while they can still be found through the handler
+    for (uint16_t i = 0; i < numTraitInstances; ++i)
+    {
+        UnindexTraitInstance(aHandlerToBeReclaimed, i);
+    }
+
     aHandlerToBeReclaimed->mTraitInstanceList = NULL;
     aHandlerToBeReclaimed->mNumTraitInstances = 0;
 
@@ -980,6 +1272,67 @@ exit:
     WeaveLogDetail(DataManagement, "Number of allocated trait instances: %u", mNumTraitInfosInPool);
 }
 
+void SubscriptionEngine::InitTraitInstanceIndex(void)
+{
+    for (size_t i = 0; i < WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE; ++i)
+    {
+        mTraitInstanceIndex[i].mHandler = NULL;
+        mTraitInstanceIndex[i].mIndex   = 0;
+    }
+}
+
+SubscriptionHandler::TraitInstanceRef & SubscriptionEngine::GetTraitInstanceIndexHead(const TraitDataHandle aTraitDataHandle)
+{
+    return mTraitInstanceIndex[aTraitDataHandle % WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE];
+}
+
+SubscriptionHandler::TraitInstanceInfo * SubscriptionEngine::GetTraitInstance(const SubscriptionHandler::TraitInstanceRef & aRef)
+{
+    return aRef.mHandler->mTraitInstanceList + aRef.mIndex;
+}
+
+/**
+ * Add a trait instance of a subscription to the index of subscribed trait instances by trait data handle, so that marking the
+ * trait data source dirty finds the subscription without visiting every subscription handler.
+ */
+void SubscriptionEngine::IndexTraitInstance(SubscriptionHandler * const aHandler, const uint16_t aIndex)
+{
+    SubscriptionHandler::TraitInstanceInfo * const traitInstance = aHandler->mTraitInstanceList + aIndex;
+    SubscriptionHandler::TraitInstanceRef & head                 = GetTraitInstanceIndexHead(traitInstance->mTraitDataHandle);
+
+    traitInstance->mPrevInIndex.mHandler = NULL;
+    traitInstance->mPrevInIndex.mIndex   = 0;
+    traitInstance->mNextInIndex          = head;
+
+    if (head.mHandler != NULL)
+    {
+        GetTraitInstance(head)->mPrevInIndex.mHandler = aHandler;
+        GetTraitInstance(head)->mPrevInIndex.mIndex   = aIndex;
+    }
+
+    head.mHandler = aHandler;
+    head.mIndex   = aIndex;
+}
+
+void SubscriptionEngine::UnindexTraitInstance(SubscriptionHandler * const aHandler, const uint16_t aIndex)
+{
+    SubscriptionHandler::TraitInstanceInfo * const traitInstance = aHandler->mTraitInstanceList + aIndex;
+
+    if (traitInstance->mPrevInIndex.mHandler != NULL)
+    {
+        GetTraitInstance(traitInstance->mPrevInIndex)->mNextInIndex = traitInstance->mNextInIndex;
+    }
+    else
+    {
+        GetTraitInstanceIndexHead(traitInstance->mTraitDataHandle) = traitInstance->mNextInIndex;
+    }
+
+    if (traitInstance->mNextInIndex.mHandler != NULL)
+    {
+        GetTraitInstance(traitInstance->mNextInIndex)->mPrevInIndex = traitInstance->mPrevInIndex;
+    }
+}
+
 WEAVE_ERROR SubscriptionEngine::EnablePublisher(IWeavePublisherLock * aLock,
                                                 TraitCatalogBase<TraitDataSource> * const aPublisherCatalog)
 {
@@ -35,6 +35,13 @@
 #include <Weave/Profiles/data-management/NotificationEngine.h>
 #include <Weave/Profiles/data-management/Command.h>
 
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+#if !WEAVE_SYSTEM_CONFIG_POSIX_LOCKING
+#error "WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT requires WEAVE_SYSTEM_CONFIG_POSIX_LOCKING"
+#endif
+#include <pthread.h>
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+
 namespace nl {
 namespace Weave {
 namespace Profiles {
@@ -305,6 +312,15 @@ public:
                      const TraitCatalogBase<TraitDataSink> * const apCatalog);
 #endif // WDM_ENABLE_SUBSCRIPTIONLESS_NOTIFICATION
 
+    // Releases what Init set up. Call before shutting down the exchange manager.
+    void Shutdown(void);
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    // Apply the data lists of inbound notifies on the worker threads, see WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT.
+    // Disabling it stops the worker threads.
+    void EnableParallelDataListApplication(bool aEnable);
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+
     nl::Weave::WeaveExchangeManager * GetExchangeManager(void) const { return mExchangeMgr; };
 
 private:
@@ -313,6 +329,7 @@ private:
     friend class NotificationEngine;
     friend class TestTdm;
     friend class TestWdm;
+    friend class TestWdmNotifyScale;
 
     nl::Weave::WeaveExchangeManager * mExchangeMgr;
     void * mAppState;
@@ -375,6 +392,74 @@ private:
                                        bool & aOutIsPartialChange,
                                        TraitDataHandle & aOutTraitDataHandle,
                                        IDataElementAccessControlDelegate & acDelegate);
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    /**
+     *  Applies batches of data elements concurrently, one trait instance per thread at a time. The Weave thread queues the
+     *  elements of a data list, then Run() hands the trait instances whose sinks are thread-safe (see
+     *  TraitDataSink::IsThreadSafe) to the worker threads. Meanwhile the Weave thread applies the elements of the other sinks
+     *  in list order, then takes its share of the thread-safe ones and waits for the workers to finish theirs.
+     */
+    class DataListWorkerPool
+    {
+    public:
+        DataListWorkerPool(void);
+
+        void Start(void);
+        void Stop(void);
+        bool IsStarted(void) const { return mIsStarted; }
+
+        bool IsFull(void) const { return mNumItems >= WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE; }
+        void AddItem(TraitDataSink * aDataSink, TraitDataHandle aTraitDataHandle, PropertyPathHandle aPropertyPathHandle,
+                     const nl::Weave::TLV::TLVReader & aReader, uint8_t aFlags);
+
+        // Returns the error of the first element, in list order, that failed to apply. As on the Weave thread, the later
+        // elements of the same trait instance aren't applied; those of other trait instances may already have been.
+        WEAVE_ERROR Run(void);
+
+    private:
+        struct Item
+        {
+            TraitDataSink * mDataSink;
+            TraitDataHandle mTraitDataHandle;
+            PropertyPathHandle mPropertyPathHandle;
+            nl::Weave::TLV::TLVReader mReader;
+            uint8_t mFlags;
+        };
+
+        struct Partition
+        {
+            TraitDataHandle mTraitDataHandle;
+            size_t mFailedItem; // Index of the item that failed to apply, mNumItems if none did
+            WEAVE_ERROR mErr;
+        };
+
+        static void * WorkerThreadMain(void * aArg);
+
+        void ApplyPartitionsLocked(void);
+        void ApplyItems(const Partition * aPartition, size_t & aOutFailedItem, WEAVE_ERROR & aOutErr);
+
+        bool mIsStarted;
+        pthread_t mThreads[WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT];
+        pthread_mutex_t mMutex;
+        pthread_cond_t mWorkCondVar; // Signaled when a new batch is available or the pool is stopping
+        pthread_cond_t mDoneCondVar; // Signaled when the last partition of a batch is applied
+
+        Item mItems[WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE];
+        size_t mNumItems;
+
+        // ******************* begin protected by mMutex **************************
+        Partition mPartitions[WDM_CLIENT_DATA_LIST_MAX_BATCH_SIZE];
+        size_t mNumPartitions;
+        size_t mNextPartition;
+        size_t mNumPartitionsDone;
+        bool mIsStopping;
+        // ******************* end protected by mMutex   **************************
+    };
+
+    DataListWorkerPool mDataListWorkerPool;
+    bool mIsParallelDataListApplicationEnabled;
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
 #if WEAVE_DETAIL_LOGGING
     void LogSubscriptionFreed(void) const;
 #endif // #if WEAVE_DETAIL_LOGGING
@@ -407,12 +492,21 @@ private:
     uint16_t mNumTraitInfosInPool;
     SubscriptionHandler::TraitInstanceInfo mTraitInfoPool[kMaxNumPathGroups];
 
+    // Heads of the lists of subscribed trait instances, bucketed by trait data handle
+    SubscriptionHandler::TraitInstanceRef mTraitInstanceIndex[WDM_PUBLISHER_TRAIT_INSTANCE_INDEX_SIZE];
+
     uint16_t mNumOfPropertyPathHandlesAllocated;
     // PropertyPathHandle mPropertyPathHandlePool[kMaxNumPropertyPathHandles];
     // ******************* end protected by lock   **************************
 
     void ReclaimTraitInfo(SubscriptionHandler * const aHandlerToBeReclaimed);
 
+    void InitTraitInstanceIndex(void);
+    void IndexTraitInstance(SubscriptionHandler * const aHandler, const uint16_t aIndex);
+    void UnindexTraitInstance(SubscriptionHandler * const aHandler, const uint16_t aIndex);
+    SubscriptionHandler::TraitInstanceRef & GetTraitInstanceIndexHead(const TraitDataHandle aTraitDataHandle);
+    static SubscriptionHandler::TraitInstanceInfo * GetTraitInstance(const SubscriptionHandler::TraitInstanceRef & aRef);
+
     static void OnSubscribeRequest(nl::Weave::ExchangeContext * aEC, const nl::Inet::IPPacketInfo * aPktInfo,
                                    const nl::Weave::WeaveMessageInfo * aMsgInfo, uint32_t aProfileId, uint8_t aMsgType,
                                    PacketBuffer * aPayload);
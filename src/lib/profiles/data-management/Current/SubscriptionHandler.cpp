@@ -74,6 +74,15 @@ void SubscriptionHandler::InitAsFree()
     mCurProcessingTraitInstanceIdx = 0;
     mCurrentImportance             = kImportanceType_Invalid;
     mBytesOffloaded                = 0;
+    mPrevInRunQueue                = NULL;
+    mNextInRunQueue                = NULL;
+    mIsInRunQueue                  = false;
+    mIsInWaitList                  = false;
+    mPrevEventSubscriber           = NULL;
+    mNextEventSubscriber           = NULL;
+    mIsEventSubscriber             = false;
+
+    ResetNotifyRateControl();
 
     memset(mSelfVendedEvents, 0, sizeof(mSelfVendedEvents));
     memset(mLastScheduledEventId, 0, sizeof(mLastScheduledEventId));
@@ -225,6 +234,46 @@ exit:
     return err;
 }
 
+/**
+ * Allocate a trait instance for this subscription from the pool in the subscription engine, and add it to the engine's index
+ * of subscribed trait instances. Trait instances of a subscription are allocated contiguously, so they must all be added
+ * before trait instances are added to another subscription.
+ *
+ * @param[in]  aTraitDataHandle     The handle of the trait data source subscribed to.
+ * @param[out] aTraitInstance       The new trait instance, which is clean.
+ *
+ * @retval #WEAVE_ERROR_NO_MEMORY   If the trait instance pool is exhausted.
+ */
+WEAVE_ERROR SubscriptionHandler::AddTraitInstance(const TraitDataHandle aTraitDataHandle, TraitInstanceInfo *& aTraitInstance)
+{
+    WEAVE_ERROR err                    = WEAVE_NO_ERROR;
+    SubscriptionEngine * const pEngine = SubscriptionEngine::GetInstance();
+
+    WEAVE_FAULT_INJECT(FaultInjection::kFault_WDM_TraitInstanceNew, ExitNow(err = WEAVE_ERROR_NO_MEMORY));
+
+    VerifyOrExit(pEngine->mNumTraitInfosInPool < SubscriptionEngine::kMaxNumPathGroups, err = WEAVE_ERROR_NO_MEMORY);
+
+    aTraitInstance = pEngine->mTraitInfoPool + pEngine->mNumTraitInfosInPool;
+    ++(pEngine->mNumTraitInfosInPool);
+    SYSTEM_STATS_INCREMENT(nl::Weave::System::Stats::kWDM_NumTraits);
+
+    if (NULL == mTraitInstanceList)
+    {
+        // this the first trait instance for this subscription
+        mTraitInstanceList = aTraitInstance;
+    }
+    ++mNumTraitInstances;
+
+    aTraitInstance->Init();
+    aTraitInstance->mTraitDataHandle  = aTraitDataHandle;
+    aTraitInstance->mRequestedVersion = 0;
+
+    pEngine->IndexTraitInstance(this, static_cast<uint16_t>(mNumTraitInstances - 1));
+
+exit:
+    return err;
+}
+
 WEAVE_ERROR SubscriptionHandler::ParsePathVersionEventLists(SubscribeRequest::Parser & aRequest,
                                                             uint32_t & aRejectReasonProfileId,
                                                             uint16_t & aRejectReasonStatusCode)
@@ -336,44 +385,22 @@ WEAVE_ERROR SubscriptionHandler::ParsePathVersionEventLists(SubscribeRequest::Pa
         if (!traitInstance)
         {
             // allocate a new trait instance
-            WEAVE_FAULT_INJECT(FaultInjection::kFault_WDM_TraitInstanceNew, ExitNow(err = WEAVE_ERROR_NO_MEMORY));
-
-            if (SubscriptionEngine::GetInstance()->mNumTraitInfosInPool < SubscriptionEngine::kMaxNumPathGroups)
-            {
-                traitInstance =
-                    SubscriptionEngine::GetInstance()->mTraitInfoPool + SubscriptionEngine::GetInstance()->mNumTraitInfosInPool;
-                ++mNumTraitInstances;
-                ++(SubscriptionEngine::GetInstance()->mNumTraitInfosInPool);
-                SYSTEM_STATS_INCREMENT(nl::Weave::System::Stats::kWDM_NumTraits);
-
-                traitInstance->Init();
-            }
-            else
-            {
-                // we run out of trait instances, abort
-                // Note it might help the client understanding what's going on with an error status like
-                // "out of memory" or "internal error", but it's pretty common that a server doesn't disclose
-                // too much internal status to clients
-                SuccessOrExit(err = WEAVE_ERROR_NO_MEMORY);
-            }
+            // Note it might help the client understanding what's going on with an error status like
+            // "out of memory" or "internal error" when we run out of trait instances, but it's pretty common
+            // that a server doesn't disclose too much internal status to clients
+            err = AddTraitInstance(traitDataHandle, traitInstance);
+            SuccessOrExit(err);
         }
 
-        traitInstance->mTraitDataHandle  = traitDataHandle;
         traitInstance->mRequestedVersion = computedForwardRequestedVersion;
 
-        if (NULL == mTraitInstanceList)
-        {
-            // this the first trait instance for this subscription
-            // mNumTraitInstanceList has already be incremented
-            mTraitInstanceList = traitInstance;
-        }
-
         if (!IsVersionListPresent)
         {
             // no existing version
             WeaveLogDetail(DataManagement, "Handler[%u] Syncing is requested for trait[%u].path[%u]",
                            SubscriptionEngine::GetInstance()->GetHandlerId(this), traitDataHandle, propertyPathHandle);
 
+            traitInstance->ClearDirty();
             traitInstance->SetDirty();
         }
         else
@@ -385,6 +412,7 @@ WEAVE_ERROR SubscriptionHandler::ParsePathVersionEventLists(SubscribeRequest::Pa
                 WeaveLogDetail(DataManagement, "Handler[%u] Syncing is requested for trait[%u].path[%u]",
                                SubscriptionEngine::GetInstance()->GetHandlerId(this), traitDataHandle, propertyPathHandle);
 
+                traitInstance->ClearDirty();
                 traitInstance->SetDirty();
             }
             else
@@ -400,7 +428,26 @@ WEAVE_ERROR SubscriptionHandler::ParsePathVersionEventLists(SubscribeRequest::Pa
                                    SubscriptionEngine::GetInstance()->GetHandlerId(this), traitDataHandle, propertyPathHandle);
 
                     WeaveLogIfFalse(existingVersion < datasourceVersion);
-                    traitInstance->SetDirty();
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+                    const uint64_t * deltaSyncVersion = traitInstance->GetDeltaSyncVersion();
+
+                    // Unless another path of the same trait instance has already asked for a full sync (or a different
+                    // version), only send what changed since the subscriber's version if the data source still knows it.
+                    if (dataSource->IsChangeJournalValidSince(existingVersion) &&
+                        (!traitInstance->IsDirty() || (deltaSyncVersion != NULL && *deltaSyncVersion == existingVersion)))
+                    {
+                        WeaveLogDetail(DataManagement, "Handler[%u] Only changes since 0x%" PRIx64 " are needed for trait[%u]",
+                                       SubscriptionEngine::GetInstance()->GetHandlerId(this), existingVersion, traitDataHandle);
+
+                        traitInstance->SetDirty(existingVersion);
+                    }
+                    else
+#endif // WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+                    {
+                        traitInstance->ClearDirty();
+                        traitInstance->SetDirty();
+                    }
                 }
                 else
                 {
@@ -1212,6 +1259,10 @@ void SubscriptionHandler::AbortSubscription()
         mCurrentImportance             = kImportanceType_Invalid;
         (void) RefreshTimer();
 
+        SubscriptionEngine::GetInstance()->GetExchangeManager()->MessageLayer->SystemLayer->CancelTimer(
+            OnNotifyHoldoffTimerCallback, this);
+        ResetNotifyRateControl();
+
         // release all trait instances back to the shared pool
         SubscriptionEngine::GetInstance()->ReclaimTraitInfo(this);
 
@@ -1495,10 +1546,37 @@ const char * SubscriptionHandler::GetStateStr() const
 
 void SubscriptionHandler::MoveToState(const HandlerState aTargetState)
 {
+    NotificationEngine * const notificationEngine = SubscriptionEngine::GetInstance()->GetNotificationEngine();
+
     mCurrentState = aTargetState;
     WeaveLogDetail(DataManagement, "Handler[%u] Moving to [%5.5s] Ref(%d)", SubscriptionEngine::GetInstance()->GetHandlerId(this),
                    GetStateStr(), mRefCount);
 
+    // Only handlers that are able to send out a notify need to be visited by the notification engine. Those that are being
+    // evaluated or are waiting on a notify confirm are parked on the wait list, and re-scheduled when they come back to a
+    // notifiable state. Those that are being torn down are dropped.
+    if (IsNotifiable())
+    {
+        notificationEngine->ScheduleHandler(this);
+    }
+    else if (IsActive())
+    {
+        notificationEngine->ParkHandler(this);
+    }
+    else
+    {
+        notificationEngine->UnscheduleHandler(this);
+    }
+
+    if (IsActive() && mSubscribeToAllEvents)
+    {
+        notificationEngine->AddEventSubscriber(this);
+    }
+    else if (!IsActive())
+    {
+        notificationEngine->RemoveEventSubscriber(this);
+    }
+
 #if WEAVE_DETAIL_LOGGING
     if (kState_Free == mCurrentState)
     {
@@ -1757,6 +1835,109 @@ void SubscriptionHandler::SetMaxNotificationSize(const uint32_t aMaxSize)
         mMaxNotificationSize = aMaxSize;
 }
 
+void SubscriptionHandler::SetNotifyRateControl(const uint32_t aCoalescingWindowMsec, const uint32_t aMinIntervalMsec)
+{
+    mNotifyCoalescingWindowMsec = aCoalescingWindowMsec;
+    mNotifyMinIntervalMsec      = aMinIntervalMsec;
+}
+
+void SubscriptionHandler::ResetNotifyRateControl(void)
+{
+    mFirstDirtyTimeMsec         = 0;
+    mLastNotifyTimeMsec         = 0;
+    mNotifyCoalescingWindowMsec = WDM_PUBLISHER_NOTIFY_COALESCING_WINDOW_MSEC;
+    mNotifyMinIntervalMsec      = WDM_PUBLISHER_NOTIFY_MIN_INTERVAL_MSEC;
+    mNotifyBackoffMsec          = 0;
+}
+
+/**
+ * Returns how much longer (in milliseconds) a data notify to this subscriber should be held off, or 0 if it can be sent now.
+ */
+uint32_t SubscriptionHandler::GetNotifyHoldoffMsec(const uint64_t aNowMsec) const
+{
+    uint64_t notifyTimeMsec;
+
+    // Only data changes to an established subscription are paced; the notifies that prime a new subscriber are never held back.
+    if (mCurrentState != kState_SubscriptionEstablished_Idle || mFirstDirtyTimeMsec == 0)
+    {
+        return 0;
+    }
+
+    notifyTimeMsec = mFirstDirtyTimeMsec + mNotifyCoalescingWindowMsec;
+
+    if (mLastNotifyTimeMsec != 0 && (mLastNotifyTimeMsec + mNotifyMinIntervalMsec + mNotifyBackoffMsec) > notifyTimeMsec)
+    {
+        notifyTimeMsec = mLastNotifyTimeMsec + mNotifyMinIntervalMsec + mNotifyBackoffMsec;
+    }
+
+    return (notifyTimeMsec > aNowMsec) ? static_cast<uint32_t>(notifyTimeMsec - aNowMsec) : 0;
+}
+
+void SubscriptionHandler::OnDataDirty(const uint64_t aNowMsec)
+{
+    if (mFirstDirtyTimeMsec == 0)
+    {
+        mFirstDirtyTimeMsec = aNowMsec;
+    }
+}
+
+void SubscriptionHandler::OnNotifySent(const uint64_t aNowMsec)
+{
+    mFirstDirtyTimeMsec = 0;
+    mLastNotifyTimeMsec = aNowMsec;
+}
+
+void SubscriptionHandler::OnNotifyConfirmed(const uint64_t aNowMsec, const bool aNotifyDelivered)
+{
+#if WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC > 0
+    const uint64_t confirmTimeMsec = aNowMsec - mLastNotifyTimeMsec;
+
+    if (!aNotifyDelivered || confirmTimeMsec > WDM_PUBLISHER_NOTIFY_SLOW_CONFIRM_MSEC)
+    {
+        // Back off by at least as long as the subscriber took to respond, doubling on every consecutive slow confirm.
+        uint64_t backoffMsec = (mNotifyBackoffMsec > confirmTimeMsec) ? 2 * static_cast<uint64_t>(mNotifyBackoffMsec) : confirmTimeMsec;
+
+        if (backoffMsec > WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC)
+        {
+            backoffMsec = WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC;
+        }
+
+        mNotifyBackoffMsec = static_cast<uint32_t>(backoffMsec);
+
+        WeaveLogDetail(DataManagement, "Handler[%u] slow notify confirm (%" PRIu32 " msec), backing off %" PRIu32 " msec",
+                       SubscriptionEngine::GetInstance()->GetHandlerId(this), static_cast<uint32_t>(confirmTimeMsec),
+                       mNotifyBackoffMsec);
+    }
+    else
+    {
+        mNotifyBackoffMsec /= 2;
+    }
+#else
+    IgnoreUnusedVariable(aNowMsec);
+    IgnoreUnusedVariable(aNotifyDelivered);
+#endif // WDM_PUBLISHER_NOTIFY_MAX_BACKOFF_MSEC > 0
+}
+
+WEAVE_ERROR SubscriptionHandler::StartNotifyHoldoffTimer(const uint32_t aHoldoffMsec)
+{
+    WeaveLogDetail(DataManagement, "Handler[%u] [%5.5s] %s Ref(%d) Holding off notify for %" PRIu32 " msec",
+                   SubscriptionEngine::GetInstance()->GetHandlerId(this), GetStateStr(), __func__, mRefCount, aHoldoffMsec);
+
+    return SubscriptionEngine::GetInstance()->GetExchangeManager()->MessageLayer->SystemLayer->StartTimer(
+        aHoldoffMsec, OnNotifyHoldoffTimerCallback, this);
+}
+
+void SubscriptionHandler::OnNotifyHoldoffTimerCallback(System::Layer * aSystemLayer, void * aAppState, System::Error)
+{
+    SubscriptionHandler * const pHandler    = reinterpret_cast<SubscriptionHandler *>(aAppState);
+    NotificationEngine * notificationEngine = SubscriptionEngine::GetInstance()->GetNotificationEngine();
+
+    notificationEngine->ScheduleHandler(pHandler);
+
+    // Note that the call to NotificationEngine::Run could actually cause this particular handler to be aborted
+    notificationEngine->Run();
+}
+
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
 }; // namespace Weave
@@ -53,16 +53,47 @@ public:
         kNoTimeout = 0,
     };
 
+    // Names a trait instance by its subscription handler and its position in the handler's trait instance list. Unlike a
+    // pointer into the trait instance pool, this stays valid when the pool is compacted.
+    struct TraitInstanceRef
+    {
+        SubscriptionHandler * mHandler;
+        uint16_t mIndex;
+    };
+
     struct TraitInstanceInfo
     {
         void Init(void) { this->ClearDirty(); }
         bool IsDirty(void) { return mDirty; }
         void SetDirty(void) { mDirty = true; }
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+        // Marks the trait instance as dirty, to be synced by sending only what changed since the subscriber's version.
+        void SetDirty(uint64_t aSubscriberVersion)
+        {
+            mDirty             = true;
+            mIsDeltaSync       = true;
+            mSubscriberVersion = aSubscriberVersion;
+        }
+        void ClearDirty(void) { mDirty = mIsDeltaSync = false; }
+        const uint64_t * GetDeltaSyncVersion(void) const { return mIsDeltaSync ? &mSubscriberVersion : NULL; }
+#else
         void ClearDirty(void) { mDirty = false; }
+        const uint64_t * GetDeltaSyncVersion(void) const { return NULL; }
+#endif
 
         TraitDataHandle mTraitDataHandle;
         uint16_t mRequestedVersion;
         bool mDirty;
+
+        // Links into the SubscriptionEngine index of trait instances by trait data handle.
+        TraitInstanceRef mPrevInIndex;
+        TraitInstanceRef mNextInIndex;
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+        bool mIsDeltaSync;
+        uint64_t mSubscriberVersion;
+#endif
     };
 
     enum EventID
@@ -185,12 +216,26 @@ public:
 
     void SetMaxNotificationSize(const uint32_t aMaxPayload);
 
+    /**
+     * @brief Sets how data notifies to this subscriber are paced. Successive changes are merged into a single notify for as
+     * long as the notify is held off, and the notify is packed with as many trait instances as fit in the maximum notification
+     * size. Notifies that make up the initial data sync of a subscription are never held off.
+     *
+     * The defaults come from #WDM_PUBLISHER_NOTIFY_COALESCING_WINDOW_MSEC and #WDM_PUBLISHER_NOTIFY_MIN_INTERVAL_MSEC. This can
+     * be called from the kEvent_OnSubscribeRequestParsed callback, or at any time while the subscription is active.
+     *
+     * @param[in] aCoalescingWindowMsec     Time to wait after data first becomes dirty before notifying the subscriber.
+     * @param[in] aMinIntervalMsec          Minimum time between the start of successive data notifies to the subscriber.
+     */
+    void SetNotifyRateControl(const uint32_t aCoalescingWindowMsec, const uint32_t aMinIntervalMsec);
+
 private:
     friend class SubscriptionEngine;
     friend class NotificationEngine;
     friend class TestSubscriptionHandler;
     friend class TestTdm;
     friend class TestWdm;
+    friend class TestWdmNotifyScale;
 
     struct LastVendedEvent
     {
@@ -250,6 +295,37 @@ private:
     uint16_t mMaxNotificationSize;
     uint32_t mCurProcessingTraitInstanceIdx;
 
+    // Links into the NotificationEngine run queue, which holds handlers that may have notify work pending, or into its wait list,
+    // which holds active handlers that may still have dirty data but cannot be notified right now. A handler is on at most one of
+    // the two.
+    SubscriptionHandler * mPrevInRunQueue;
+    SubscriptionHandler * mNextInRunQueue;
+    bool mIsInRunQueue;
+    bool mIsInWaitList;
+
+    // Links into the NotificationEngine list of handlers subscribed to events.
+    SubscriptionHandler * mPrevEventSubscriber;
+    SubscriptionHandler * mNextEventSubscriber;
+    bool mIsEventSubscriber;
+
+    // Notify rate control. mFirstDirtyTimeMsec is the time at which data first became dirty since the last notify was sent, or
+    // 0 if there has been no change since.
+    uint64_t mFirstDirtyTimeMsec;
+    uint64_t mLastNotifyTimeMsec;
+    uint32_t mNotifyCoalescingWindowMsec;
+    uint32_t mNotifyMinIntervalMsec;
+    uint32_t mNotifyBackoffMsec;
+
+    uint32_t GetNotifyHoldoffMsec(const uint64_t aNowMsec) const;
+    void OnDataDirty(const uint64_t aNowMsec);
+    void OnNotifySent(const uint64_t aNowMsec);
+    void OnNotifyConfirmed(const uint64_t aNowMsec, const bool aNotifyDelivered);
+    void ResetNotifyRateControl(void);
+    WEAVE_ERROR StartNotifyHoldoffTimer(const uint32_t aHoldoffMsec);
+    static void OnNotifyHoldoffTimerCallback(System::Layer * aSystemLayer, void * aAppState, System::Error aErrorCode);
+
+    WEAVE_ERROR AddTraitInstance(const TraitDataHandle aTraitDataHandle, TraitInstanceInfo *& aTraitInstance);
+
     TraitInstanceInfo * GetTraitInstanceInfoList(void) { return mTraitInstanceList; }
     uint32_t GetNumTraitInstances(void) { return mNumTraitInstances; }
 
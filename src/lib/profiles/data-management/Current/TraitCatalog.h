@@ -194,6 +194,108 @@ private:
 typedef SingleResourceTraitCatalog<TraitDataSink> SingleResourceSinkTraitCatalog;
 typedef SingleResourceTraitCatalog<TraitDataSource> SingleResourceSourceTraitCatalog;
 
+/*
+ *  @class MultiResourceTraitCatalog
+ *
+ *  @brief A Weave provided implementation of the TraitCatalogBase interface for a large collection of trait data instances that
+ *         may belong to any number of resources. Like SingleResourceTraitCatalog, it is backed by bounded, caller-provided storage,
+ *         but paths are resolved through hash indexes instead of a scan of the whole store:
+ *
+ *           - Handles are offsets into the item store, so Locate(TraitDataHandle, ...) is a direct lookup.
+ *           - (resource ID, profile ID, instance ID) tuples are chained through an address index.
+ *           - Trait data instance pointers are chained through an item index for reverse lookups.
+ *
+ *         Items can be added and removed at any time without rebuilding the indexes. Iterate() and DispatchEvent() visit items in
+ *         handle order. Handles of removed items are only handed out again once every item in the store has been used once.
+ *
+ *         A path that doesn't carry a resource ID refers to the resource passed in at construction, typically the self resource.
+ */
+template <typename T>
+class MultiResourceTraitCatalog : public TraitCatalogBase<T>
+{
+public:
+    enum
+    {
+        kInvalidHandle = 0xFFFF,
+    };
+
+    struct CatalogItem
+    {
+        ResourceIdentifier mResourceId;
+        uint64_t mInstanceId;
+        T * mItem;
+        uint32_t mProfileId;
+        TraitDataHandle mNextByAddress; ///< Next item in the same address bucket, or next free item once removed
+        TraitDataHandle mNextByItem;    ///< Next item in the same item bucket
+    };
+
+    struct Bucket
+    {
+        TraitDataHandle mAddressHead;
+        TraitDataHandle mItemHead;
+    };
+
+    /*
+     * Instances a trait catalog given pointers to the underlying item store and to the hash buckets. For constant time lookups,
+     * the number of buckets should be in the order of the number of items.
+     */
+    MultiResourceTraitCatalog(const ResourceIdentifier & aDefaultResourceId, CatalogItem * aCatalogStore,
+                              uint32_t aNumMaxCatalogItems, Bucket * aBuckets, uint32_t aNumBuckets);
+
+    /*
+     * Add a new trait data instance of the given resource into the catalog and return a handle to it.
+     */
+    WEAVE_ERROR Add(const ResourceIdentifier & aResourceId, uint64_t aInstanceId, T * aItem, TraitDataHandle & aHandle);
+
+    /**
+     * Removes a trait instance from the catalog.
+     */
+    WEAVE_ERROR Remove(TraitDataHandle aHandle);
+
+    WEAVE_ERROR Locate(const ResourceIdentifier & aResourceId, uint32_t aProfileId, uint64_t aInstanceId,
+                       TraitDataHandle & aHandle) const;
+
+    /**
+     * Return the number of trait instances in the catalog.
+     */
+    uint32_t Count() const { return mNumItems; }
+
+public: // TraitCatalogBase
+    WEAVE_ERROR AddressToHandle(TLV::TLVReader & aReader, TraitDataHandle & aHandle,
+                                SchemaVersionRange & aSchemaVersionRange) const;
+    WEAVE_ERROR HandleToAddress(TraitDataHandle aHandle, TLV::TLVWriter & aWriter, SchemaVersionRange & aSchemaVersionRange) const;
+    WEAVE_ERROR Locate(TraitDataHandle aHandle, T ** aTraitInstance) const;
+    WEAVE_ERROR Locate(T * aTraitInstance, TraitDataHandle & aHandle) const;
+    WEAVE_ERROR DispatchEvent(uint16_t aEvent, void * aContext) const;
+    void Iterate(IteratorCallback aCallback, void * aContext);
+
+#if    WEAVE_CONFIG_ENABLE_WDM_UPDATE
+    WEAVE_ERROR GetInstanceId(TraitDataHandle aHandle, uint64_t &aInstanceId) const;
+    WEAVE_ERROR GetResourceId(TraitDataHandle aHandle, ResourceIdentifier &aResourceId) const;
+#endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
+
+private:
+    bool IsValidHandle(TraitDataHandle aHandle) const
+    {
+        return (aHandle < mNumOfUsedCatalogItems && mCatalogStore[aHandle].mItem != NULL);
+    }
+
+    uint32_t GetAddressBucket(const ResourceIdentifier & aResourceId, uint32_t aProfileId, uint64_t aInstanceId) const;
+    uint32_t GetItemBucket(const T * aItem) const;
+
+    CatalogItem * mCatalogStore;
+    Bucket * mBuckets;
+    ResourceIdentifier mDefaultResourceId;
+    uint32_t mNumMaxCatalogItems;
+    uint32_t mNumBuckets;
+    uint32_t mNumOfUsedCatalogItems; ///< High water mark of the item store
+    uint32_t mNumItems;
+    TraitDataHandle mFreeListHead;
+};
+
+typedef MultiResourceTraitCatalog<TraitDataSink> MultiResourceSinkTraitCatalog;
+typedef MultiResourceTraitCatalog<TraitDataSource> MultiResourceSourceTraitCatalog;
+
 template <typename T>
 SingleResourceTraitCatalog<T>::SingleResourceTraitCatalog(ResourceIdentifier aResourceIdentifier, CatalogItem * aCatalogStore,
                                                           uint32_t aNumMaxCatalogItems) :
@@ -207,11 +309,19 @@ SingleResourceTraitCatalog<T>::SingleResourceTraitCatalog(ResourceIdentifier aRe
 template <typename T>
 WEAVE_ERROR SingleResourceTraitCatalog<T>::Add(uint64_t aInstanceId, T * aItem, TraitDataHandle & aHandle)
 {
+    WEAVE_ERROR err;
+
     if (mNumOfUsedCatalogItems >= mNumMaxCatalogItems)
     {
         return WEAVE_ERROR_NO_MEMORY;
     }
 
+    err = aItem->GetSchemaEngine()->BuildPropertyTreeIndex();
+    if (err != WEAVE_NO_ERROR)
+    {
+        return err;
+    }
+
     mCatalogStore[mNumOfUsedCatalogItems].mInstanceId = aInstanceId;
     mCatalogStore[mNumOfUsedCatalogItems].mItem       = aItem;
     aHandle                                           = mNumOfUsedCatalogItems++;
@@ -224,11 +334,19 @@ WEAVE_ERROR SingleResourceTraitCatalog<T>::Add(uint64_t aInstanceId, T * aItem,
 template <typename T>
 WEAVE_ERROR SingleResourceTraitCatalog<T>::AddAt(uint64_t aInstanceId, T * aItem, TraitDataHandle aHandle)
 {
+    WEAVE_ERROR err;
+
     if (aHandle >= mNumMaxCatalogItems)
     {
         return WEAVE_ERROR_INVALID_ARGUMENT;
     }
 
+    err = aItem->GetSchemaEngine()->BuildPropertyTreeIndex();
+    if (err != WEAVE_NO_ERROR)
+    {
+        return err;
+    }
+
     mCatalogStore[aHandle].mInstanceId = aInstanceId;
     mCatalogStore[aHandle].mItem       = aItem;
     mNumOfUsedCatalogItems++;
@@ -484,6 +602,368 @@ WEAVE_ERROR SingleResourceTraitCatalog<T>::GetResourceId(TraitDataHandle aHandle
 
 #endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
 
+template <typename T>
+MultiResourceTraitCatalog<T>::MultiResourceTraitCatalog(const ResourceIdentifier & aDefaultResourceId, CatalogItem * aCatalogStore,
+                                                        uint32_t aNumMaxCatalogItems, Bucket * aBuckets, uint32_t aNumBuckets) :
+    mDefaultResourceId(aDefaultResourceId)
+{
+    mCatalogStore          = aCatalogStore;
+    mBuckets               = aBuckets;
+    mNumMaxCatalogItems    = (aNumMaxCatalogItems < kInvalidHandle) ? aNumMaxCatalogItems : kInvalidHandle;
+    mNumBuckets            = aNumBuckets;
+    mNumOfUsedCatalogItems = 0;
+    mNumItems              = 0;
+    mFreeListHead          = kInvalidHandle;
+
+    for (uint32_t i = 0; i < mNumBuckets; i++)
+    {
+        mBuckets[i].mAddressHead = kInvalidHandle;
+        mBuckets[i].mItemHead    = kInvalidHandle;
+    }
+}
+
+template <typename T>
+uint32_t MultiResourceTraitCatalog<T>::GetAddressBucket(const ResourceIdentifier & aResourceId, uint32_t aProfileId,
+                                                        uint64_t aInstanceId) const
+{
+    // 64-bit FNV-1a style mix of the three address components
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hash = (hash ^ aResourceId.GetResourceId()) * 0x100000001B3ULL;
+    hash = (hash ^ aResourceId.GetResourceType()) * 0x100000001B3ULL;
+    hash = (hash ^ aProfileId) * 0x100000001B3ULL;
+    hash = (hash ^ aInstanceId) * 0x100000001B3ULL;
+
+    return static_cast<uint32_t>((hash ^ (hash >> 32)) % mNumBuckets);
+}
+
+template <typename T>
+uint32_t MultiResourceTraitCatalog<T>::GetItemBucket(const T * aItem) const
+{
+    uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(aItem)) * 0x9E3779B97F4A7C15ULL;
+
+    return static_cast<uint32_t>((hash >> 32) % mNumBuckets);
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Add(const ResourceIdentifier & aResourceId, uint64_t aInstanceId, T * aItem,
+                                              TraitDataHandle & aHandle)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TraitDataHandle handle;
+    uint32_t profileId;
+    uint32_t bucket;
+
+    VerifyOrExit(aItem != NULL && mNumBuckets > 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    profileId = aItem->GetSchemaEngine()->GetProfileId();
+
+    // Addresses have to be unique for AddressToHandle to be meaningful.
+    VerifyOrExit(Locate(aResourceId, profileId, aInstanceId, handle) != WEAVE_NO_ERROR, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = aItem->GetSchemaEngine()->BuildPropertyTreeIndex();
+    SuccessOrExit(err);
+
+    if (mNumOfUsedCatalogItems < mNumMaxCatalogItems)
+    {
+        handle = static_cast<TraitDataHandle>(mNumOfUsedCatalogItems++);
+    }
+    else
+    {
+        VerifyOrExit(mFreeListHead != kInvalidHandle, err = WEAVE_ERROR_NO_MEMORY);
+
+        handle        = mFreeListHead;
+        mFreeListHead = mCatalogStore[handle].mNextByAddress;
+    }
+
+    mCatalogStore[handle].mResourceId = aResourceId;
+    mCatalogStore[handle].mInstanceId = aInstanceId;
+    mCatalogStore[handle].mItem       = aItem;
+    mCatalogStore[handle].mProfileId  = profileId;
+
+    bucket                               = GetAddressBucket(aResourceId, profileId, aInstanceId);
+    mCatalogStore[handle].mNextByAddress = mBuckets[bucket].mAddressHead;
+    mBuckets[bucket].mAddressHead        = handle;
+
+    bucket                            = GetItemBucket(aItem);
+    mCatalogStore[handle].mNextByItem = mBuckets[bucket].mItemHead;
+    mBuckets[bucket].mItemHead        = handle;
+
+    mNumItems++;
+    aHandle = handle;
+
+    WeaveLogDetail(DataManagement, "Adding trait version (%u, %u)", aItem->GetSchemaEngine()->GetMinVersion(),
+                   aItem->GetSchemaEngine()->GetMaxVersion());
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Remove(TraitDataHandle aHandle)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    CatalogItem * item;
+    TraitDataHandle * link;
+
+    VerifyOrExit(IsValidHandle(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+    item = &mCatalogStore[aHandle];
+
+    // Unlink from both index chains
+    link = &mBuckets[GetAddressBucket(item->mResourceId, item->mProfileId, item->mInstanceId)].mAddressHead;
+    while (*link != aHandle)
+    {
+        link = &mCatalogStore[*link].mNextByAddress;
+    }
+    *link = item->mNextByAddress;
+
+    link = &mBuckets[GetItemBucket(item->mItem)].mItemHead;
+    while (*link != aHandle)
+    {
+        link = &mCatalogStore[*link].mNextByItem;
+    }
+    *link = item->mNextByItem;
+
+    item->mItem          = NULL;
+    item->mNextByAddress = mFreeListHead;
+    mFreeListHead        = aHandle;
+    mNumItems--;
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Locate(const ResourceIdentifier & aResourceId, uint32_t aProfileId, uint64_t aInstanceId,
+                                                 TraitDataHandle & aHandle) const
+{
+    TraitDataHandle handle;
+
+    if (mNumBuckets == 0)
+    {
+        return WEAVE_ERROR_INVALID_PROFILE_ID;
+    }
+
+    for (handle = mBuckets[GetAddressBucket(aResourceId, aProfileId, aInstanceId)].mAddressHead; handle != kInvalidHandle;
+         handle = mCatalogStore[handle].mNextByAddress)
+    {
+        const CatalogItem & item = mCatalogStore[handle];
+
+        if ((item.mProfileId == aProfileId) && (item.mInstanceId == aInstanceId) && (item.mResourceId == aResourceId))
+        {
+            aHandle = handle;
+            return WEAVE_NO_ERROR;
+        }
+    }
+
+    return WEAVE_ERROR_INVALID_PROFILE_ID;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::AddressToHandle(TLV::TLVReader & aReader, TraitDataHandle & aHandle,
+                                                          SchemaVersionRange & aSchemaVersionRange) const
+{
+    WEAVE_ERROR err     = WEAVE_NO_ERROR;
+    uint32_t profileId  = 0;
+    uint64_t instanceId = 0;
+    ResourceIdentifier resourceId = mDefaultResourceId;
+    Path::Parser path;
+    nl::Weave::TLV::TLVReader reader;
+
+    err = path.Init(aReader);
+    SuccessOrExit(err);
+
+    err = path.GetProfileID(&profileId, &aSchemaVersionRange);
+    SuccessOrExit(err);
+
+    err = path.GetInstanceID(&instanceId);
+    if ((WEAVE_NO_ERROR != err) && (WEAVE_END_OF_TLV != err))
+    {
+        ExitNow();
+    }
+
+    err = path.GetResourceID(&reader);
+    if (err == WEAVE_NO_ERROR)
+    {
+        err = resourceId.FromTLV(reader);
+        SuccessOrExit(err);
+    }
+    else if (err == WEAVE_END_OF_TLV)
+    {
+        // no-op, element not found
+    }
+    else
+    {
+        ExitNow();
+    }
+
+    path.GetTags(&aReader);
+
+    VerifyOrExit(profileId != 0, err = WEAVE_ERROR_TLV_TAG_NOT_FOUND);
+
+    err = Locate(resourceId, profileId, instanceId, aHandle);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::HandleToAddress(TraitDataHandle aHandle, TLV::TLVWriter & aWriter,
+                                                          SchemaVersionRange & aSchemaVersionRange) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    CatalogItem * item;
+    TLV::TLVType type;
+
+    // Make sure the handle exists and mItem is not NULL
+    VerifyOrExit(IsValidHandle(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+    item = &mCatalogStore[aHandle];
+
+    VerifyOrExit(aSchemaVersionRange.IsValid(), err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = aWriter.StartContainer(TLV::ContextTag(Path::kCsTag_InstanceLocator), TLV::kTLVType_Structure, type);
+    SuccessOrExit(err);
+
+    if (aSchemaVersionRange.mMinVersion != 1 || aSchemaVersionRange.mMaxVersion != 1)
+    {
+        TLV::TLVType type2;
+
+        err = aWriter.StartContainer(TLV::ContextTag(Path::kCsTag_TraitProfileID), TLV::kTLVType_Array, type2);
+        SuccessOrExit(err);
+
+        err = aWriter.Put(TLV::AnonymousTag, item->mProfileId);
+        SuccessOrExit(err);
+
+        // Only encode the max version if it isn't 1.
+        if (aSchemaVersionRange.mMaxVersion != 1)
+        {
+            err = aWriter.Put(TLV::AnonymousTag, aSchemaVersionRange.mMaxVersion);
+            SuccessOrExit(err);
+        }
+
+        // Only encode the min version if it isn't 1.
+        if (aSchemaVersionRange.mMinVersion != 1)
+        {
+            err = aWriter.Put(TLV::AnonymousTag, aSchemaVersionRange.mMinVersion);
+            SuccessOrExit(err);
+        }
+
+        err = aWriter.EndContainer(type2);
+        SuccessOrExit(err);
+    }
+    else
+    {
+        err = aWriter.Put(TLV::ContextTag(Path::kCsTag_TraitProfileID), item->mProfileId);
+        SuccessOrExit(err);
+    }
+
+    if (item->mInstanceId)
+    {
+        err = aWriter.Put(TLV::ContextTag(Path::kCsTag_TraitInstanceID), item->mInstanceId);
+        SuccessOrExit(err);
+    }
+
+    err = item->mResourceId.ToTLV(aWriter);
+    SuccessOrExit(err);
+
+    err = aWriter.EndContainer(type);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Locate(TraitDataHandle aHandle, T ** aTraitInstance) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    // Make sure the handle exists and mItem is not NULL
+    VerifyOrExit(IsValidHandle(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+    *aTraitInstance = mCatalogStore[aHandle].mItem;
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Locate(T * aTraitInstance, TraitDataHandle & aHandle) const
+{
+    TraitDataHandle handle;
+
+    if (mNumBuckets == 0)
+    {
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (handle = mBuckets[GetItemBucket(aTraitInstance)].mItemHead; handle != kInvalidHandle;
+         handle = mCatalogStore[handle].mNextByItem)
+    {
+        if (mCatalogStore[handle].mItem == aTraitInstance)
+        {
+            aHandle = handle;
+            return WEAVE_NO_ERROR;
+        }
+    }
+
+    return WEAVE_ERROR_INVALID_ARGUMENT;
+}
+
+template <typename T>
+void MultiResourceTraitCatalog<T>::Iterate(IteratorCallback aCallback, void * aContext)
+{
+    for (uint32_t i = 0; i < mNumOfUsedCatalogItems; i++)
+    {
+        if (mCatalogStore[i].mItem != NULL)
+        {
+            aCallback(mCatalogStore[i].mItem, i, aContext);
+        }
+    }
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::DispatchEvent(uint16_t aEvent, void * aContext) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    for (uint32_t i = 0; i < mNumOfUsedCatalogItems; i++)
+    {
+        if (mCatalogStore[i].mItem != NULL)
+        {
+            mCatalogStore[i].mItem->OnEvent(aEvent, aContext);
+        }
+    }
+
+    return err;
+}
+
+#if WEAVE_CONFIG_ENABLE_WDM_UPDATE
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::GetInstanceId(TraitDataHandle aHandle, uint64_t &aInstanceId) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(IsValidHandle(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+    aInstanceId = mCatalogStore[aHandle].mInstanceId;
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::GetResourceId(TraitDataHandle aHandle, ResourceIdentifier &aResourceId) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(IsValidHandle(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+    aResourceId = mCatalogStore[aHandle].mResourceId;
+
+exit:
+    return err;
+}
+#endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
+
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
 }; // namespace Weave
@@ -36,6 +36,7 @@
 #include <Weave/Profiles/data-management/DataManagement.h>
 #include <Weave/Support/WeaveFaultInjection.h>
 #include <Weave/Support/RandUtils.h>
+#include <SystemLayer/SystemStats.h>
 
 using namespace ::nl::Weave;
 using namespace ::nl::Weave::TLV;
@@ -616,6 +617,34 @@ PropertyPathHandle TraitSchemaEngine::GetNextChild(PropertyPathHandle aParentHan
     PropertySchemaHandle parentSchemaHandle   = GetPropertySchemaHandle(aParentHandle);
     PropertySchemaHandle childSchemaHandle    = GetPropertySchemaHandle(aChildHandle);
     PropertyDictionaryKey parentDictionaryKey = GetPropertyDictionaryKey(aParentHandle);
+    const PropertyTreeIndex * index           = GetPropertyTreeIndex();
+
+    if (index != NULL && parentSchemaHandle < (mSchema.mNumSchemaHandleEntries + kHandleTableOffset))
+    {
+        const PropertyInfo * childInfo        = GetMap(childSchemaHandle);
+        PropertySchemaHandle nextSchemaHandle = 0;
+        bool isIndexed                        = true;
+
+        if (childSchemaHandle == kRootPropertyPathHandle)
+        {
+            nextSchemaHandle = index->mFirstChild[parentSchemaHandle];
+        }
+        else if (childInfo != NULL && childInfo->mParentHandle == parentSchemaHandle)
+        {
+            nextSchemaHandle = index->mNextSibling[childSchemaHandle - kHandleTableOffset];
+        }
+        else
+        {
+            // Not a child of this parent - leave it to the table scan below.
+            isIndexed = false;
+        }
+
+        if (isIndexed)
+        {
+            return (nextSchemaHandle == 0) ? kNullPropertyPathHandle
+                                           : CreatePropertyPathHandle(nextSchemaHandle, parentDictionaryKey);
+        }
+    }
 
     // Starting from 1 node after the child node that's been passed in, iterate till we find the next child belonging to aParentId.
     for (i = (childSchemaHandle - 1); i < mSchema.mNumSchemaHandleEntries; i++)
@@ -648,6 +677,29 @@ PropertyPathHandle TraitSchemaEngine::GetChildHandle(PropertyPathHandle aParentH
 
 PropertyPathHandle TraitSchemaEngine::_GetChildHandle(PropertyPathHandle aParentHandle, uint8_t aContextTag) const
 {
+    const PropertyTreeIndex * index = GetPropertyTreeIndex();
+
+    if (index != NULL)
+    {
+        PropertySchemaHandle parentSchemaHandle = GetPropertySchemaHandle(aParentHandle);
+        uint32_t bucket                         = HashChildKey(parentSchemaHandle, aContextTag, index->mChildHashTblSize);
+        PropertySchemaHandle childSchemaHandle;
+
+        while ((childSchemaHandle = index->mChildHashTbl[bucket]) != 0)
+        {
+            const PropertyInfo & childInfo = mSchema.mSchemaHandleTbl[childSchemaHandle - kHandleTableOffset];
+
+            if (childInfo.mParentHandle == parentSchemaHandle && childInfo.mContextTag == aContextTag)
+            {
+                return CreatePropertyPathHandle(childSchemaHandle, GetPropertyDictionaryKey(aParentHandle));
+            }
+
+            bucket = (bucket + 1) % index->mChildHashTblSize;
+        }
+
+        return kNullPropertyPathHandle;
+    }
+
     for (PropertyPathHandle childProperty = GetFirstChild(aParentHandle); !IsNullPropertyPathHandle(childProperty);
          childProperty                    = GetNextChild(aParentHandle, childProperty))
     {
@@ -680,6 +732,11 @@ bool TraitSchemaEngine::IsLeaf(PropertyPathHandle aHandle) const
     {
         return false;
     }
+    else if (GetPropertyTreeIndex() != NULL)
+    {
+        return (schemaHandle >= (mSchema.mNumSchemaHandleEntries + kHandleTableOffset)) ||
+            (mSchema.mPropertyTreeIndex->mFirstChild[schemaHandle] == 0);
+    }
     else
     {
         for (unsigned int i = 0; i < mSchema.mNumSchemaHandleEntries; i++)
@@ -819,6 +876,121 @@ bool TraitSchemaEngine::IsEphemeral(PropertyPathHandle aHandle) const
     return GetBitFromPathHandleBitfield(mSchema.mIsEphemeralBitfield, aHandle);
 }
 
+#if TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+static TraitSchemaEngine::PropertyTreeIndex sPooledPropertyTreeIndexes[TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES];
+static PropertySchemaHandle sPropertyTreeIndexPool[TDM_PROPERTY_TREE_INDEX_POOL_SIZE];
+static uint32_t sNumPooledPropertyTreeIndexes;
+static uint32_t sPropertyTreeIndexPoolUsed;
+#endif // TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+
+void TraitSchemaEngine::AllocatePropertyTreeIndex(void) const
+{
+#if TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+    const uint32_t numEntries = mSchema.mNumSchemaHandleEntries;
+    // Give the child hash table twice as many entries as there are handles to keep probe sequences short.
+    const uint32_t hashTblSize = 2 * numEntries;
+    const uint32_t poolNeeded  = (numEntries + kHandleTableOffset) + numEntries + hashTblSize;
+    PropertyTreeIndex * index;
+
+    // A trait without properties has nothing to index.
+    VerifyOrExit(numEntries > 0, );
+
+    if ((sNumPooledPropertyTreeIndexes >= TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES) ||
+        (poolNeeded > TDM_PROPERTY_TREE_INDEX_POOL_SIZE - sPropertyTreeIndexPoolUsed))
+    {
+        WeaveLogDetail(DataManagement, "[Trait %08x] No room to index %u schema handles", mSchema.mProfileId, numEntries);
+        ExitNow();
+    }
+
+    index = &sPooledPropertyTreeIndexes[sNumPooledPropertyTreeIndexes++];
+
+    index->mFirstChild = &sPropertyTreeIndexPool[sPropertyTreeIndexPoolUsed];
+    sPropertyTreeIndexPoolUsed += numEntries + kHandleTableOffset;
+    index->mNextSibling = &sPropertyTreeIndexPool[sPropertyTreeIndexPoolUsed];
+    sPropertyTreeIndexPoolUsed += numEntries;
+    index->mChildHashTbl = &sPropertyTreeIndexPool[sPropertyTreeIndexPoolUsed];
+    sPropertyTreeIndexPoolUsed += hashTblSize;
+    index->mChildHashTblSize = hashTblSize;
+    index->mIsBuilt          = false;
+
+    mSchema.mPropertyTreeIndex = index;
+
+exit:
+    return;
+#endif // TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+}
+
+WEAVE_ERROR TraitSchemaEngine::BuildPropertyTreeIndex(void) const
+{
+    WEAVE_ERROR err           = WEAVE_NO_ERROR;
+    const uint32_t numEntries = mSchema.mNumSchemaHandleEntries;
+    PropertyTreeIndex * index;
+
+    if (mSchema.mPropertyTreeIndex == NULL)
+    {
+        AllocatePropertyTreeIndex();
+    }
+
+    index = mSchema.mPropertyTreeIndex;
+
+    VerifyOrExit(index != NULL && !index->mIsBuilt, );
+
+    // The hash table needs at least one free slot to terminate probing.
+    VerifyOrExit(index->mChildHashTblSize > numEntries, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    memset(index->mFirstChild, 0, (numEntries + kHandleTableOffset) * sizeof(PropertySchemaHandle));
+    memset(index->mNextSibling, 0, numEntries * sizeof(PropertySchemaHandle));
+    memset(index->mChildHashTbl, 0, index->mChildHashTblSize * sizeof(PropertySchemaHandle));
+
+    // Walk the table backwards, pushing each handle onto the front of its parent's child list. This leaves every list in
+    // ascending handle order, which is the order a scan of the table visits them in.
+    for (uint32_t i = numEntries; i > 0; i--)
+    {
+        const PropertySchemaHandle parentHandle = mSchema.mSchemaHandleTbl[i - 1].mParentHandle;
+
+        if (parentHandle < (numEntries + kHandleTableOffset))
+        {
+            index->mNextSibling[i - 1]       = index->mFirstChild[parentHandle];
+            index->mFirstChild[parentHandle] = static_cast<PropertySchemaHandle>(i - 1 + kHandleTableOffset);
+        }
+    }
+
+    // Insert in ascending handle order so that lookups find the same child a scan of the table would.
+    for (uint32_t i = 0; i < numEntries; i++)
+    {
+        uint32_t bucket =
+            HashChildKey(mSchema.mSchemaHandleTbl[i].mParentHandle, mSchema.mSchemaHandleTbl[i].mContextTag, index->mChildHashTblSize);
+
+        while (index->mChildHashTbl[bucket] != 0)
+        {
+            bucket = (bucket + 1) % index->mChildHashTblSize;
+        }
+
+        index->mChildHashTbl[bucket] = static_cast<PropertySchemaHandle>(i + kHandleTableOffset);
+    }
+
+    index->mIsBuilt = true;
+
+exit:
+    return err;
+}
+
+const TraitSchemaEngine::PropertyTreeIndex * TraitSchemaEngine::GetPropertyTreeIndex(void) const
+{
+    if (mSchema.mPropertyTreeIndex == NULL || !mSchema.mPropertyTreeIndex->mIsBuilt)
+    {
+        return NULL;
+    }
+
+    return mSchema.mPropertyTreeIndex;
+}
+
+uint32_t TraitSchemaEngine::HashChildKey(PropertySchemaHandle aParentHandle, uint8_t aContextTag, uint32_t aTblSize)
+{
+    // Knuth's multiplicative hash over the combined key.
+    return ((static_cast<uint32_t>(aParentHandle) << 8 | aContextTag) * 2654435761U) % aTblSize;
+}
+
 bool TraitSchemaEngine::GetBitFromPathHandleBitfield(uint8_t * aBitfield, PropertyPathHandle aPathHandle) const
 {
     bool retval = false;
@@ -1068,6 +1240,7 @@ exit:
     return err;
 }
 
+
 void TraitDataSink::OnDataSinkEvent(DataSinkEventType aEventType, PropertyPathHandle aHandle)
 {
     EventType event;
@@ -1115,7 +1288,21 @@ WEAVE_ERROR TraitDataSink::SetData(PropertyPathHandle aHandle, TLVReader & aRead
 
     if (mSchemaEngine->IsLeaf(aHandle))
     {
-        err = SetLeafData(aHandle, aReader);
+        LeafDataView view;
+
+        // fall back to SetLeafData if the leaf isn't a string in a PacketBuffer or the sink doesn't take views
+        err = WEAVE_ERROR_NOT_IMPLEMENTED;
+        if (((aReader.GetType() == kTLVType_ByteString) || (aReader.GetType() == kTLVType_UTF8String)) &&
+            (view.Init(aReader) == WEAVE_NO_ERROR))
+        {
+            err = SetLeafDataView(aHandle, view);
+        }
+
+        if (err == WEAVE_ERROR_NOT_IMPLEMENTED)
+        {
+            err = SetLeafData(aHandle, aReader);
+        }
+
         if (err != WEAVE_NO_ERROR)
         {
             WeaveLogDetail(DataManagement, "ahandle %u err: %d", aHandle, err);
@@ -1124,6 +1311,93 @@ WEAVE_ERROR TraitDataSink::SetData(PropertyPathHandle aHandle, TLVReader & aRead
     return err;
 }
 
+LeafDataView::LeafDataView() : mBuffer(NULL), mData(NULL), mLength(0), mType(kTLVType_NotSpecified), mIsRetained(false) { }
+
+LeafDataView::LeafDataView(const LeafDataView & aOther) :
+    mBuffer(aOther.mBuffer), mData(aOther.mData), mLength(aOther.mLength), mType(aOther.mType), mIsRetained(false)
+{
+    Retain();
+}
+
+LeafDataView & LeafDataView::operator=(const LeafDataView & aOther)
+{
+    if (this != &aOther)
+    {
+        Release();
+
+        mBuffer = aOther.mBuffer;
+        mData   = aOther.mData;
+        mLength = aOther.mLength;
+        mType   = aOther.mType;
+
+        Retain();
+    }
+
+    return *this;
+}
+
+WEAVE_ERROR LeafDataView::Init(TLVReader & aReader)
+{
+    WEAVE_ERROR err      = WEAVE_NO_ERROR;
+    const uint8_t * data = NULL;
+    System::PacketBuffer * buf;
+
+    Release();
+
+    VerifyOrExit(aReader.GetType() == kTLVType_ByteString || aReader.GetType() == kTLVType_UTF8String,
+                 err = WEAVE_ERROR_WRONG_TLV_TYPE);
+
+    // Only a reader initialized over a single PacketBuffer has one as its buffer handle; readers over
+    // raw memory have none, and readers with a GetNextBuffer function may use the handle for anything.
+    VerifyOrExit(aReader.GetNextBuffer == NULL && aReader.GetBufHandle() != 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    buf = reinterpret_cast<System::PacketBuffer *>(aReader.GetBufHandle());
+
+    err = aReader.GetDataPtr(data);
+    SuccessOrExit(err);
+
+    VerifyOrExit(data >= buf->Start() && data + aReader.GetLength() <= buf->Start() + buf->DataLength(),
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mBuffer = buf;
+    mData   = data;
+    mLength = aReader.GetLength();
+    mType   = aReader.GetType();
+
+exit:
+    return err;
+}
+
+void LeafDataView::Retain()
+{
+    if (mBuffer != NULL)
+    {
+        mBuffer->AddRef();
+        mIsRetained = true;
+
+#if WDM_ENABLE_SUBSCRIPTION_CLIENT
+        SYSTEM_STATS_INCREMENT(nl::Weave::System::Stats::kWDM_NumRetainedLeafViews);
+#endif
+    }
+}
+
+void LeafDataView::Release()
+{
+    if (mIsRetained)
+    {
+        System::PacketBuffer::Free(mBuffer);
+        mIsRetained = false;
+
+#if WDM_ENABLE_SUBSCRIPTION_CLIENT
+        SYSTEM_STATS_DECREMENT(nl::Weave::System::Stats::kWDM_NumRetainedLeafViews);
+#endif
+    }
+
+    mBuffer = NULL;
+    mData   = NULL;
+    mLength = 0;
+    mType   = kTLVType_NotSpecified;
+}
+
 TraitDataSource::TraitDataSource(const TraitSchemaEngine * aEngine)
 {
     // Set the version to 0, indicating the lack of a valid version.
@@ -1133,6 +1407,13 @@ TraitDataSource::TraitDataSource(const TraitSchemaEngine * aEngine)
     mSetDirtyCalled = false;
     mSchemaEngine   = aEngine;
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    mChangeJournalHead         = 0;
+    mNumChangeJournalEntries   = 0;
+    mChangeJournalStartVersion = 0;
+    mChangeJournalStarted      = false;
+#endif
+
 #if (WEAVE_CONFIG_WDM_PUBLISHER_GRAPH_SOLVER == IntermediateGraphSolver)
     ClearRootDirty();
 #endif
@@ -1236,6 +1517,10 @@ void TraitDataSource::SetDirty(PropertyPathHandle aPropertyHandle)
     {
         mSetDirtyCalled = true;
         SubscriptionEngine::GetInstance()->GetNotificationEngine()->SetDirty(this, aPropertyHandle);
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+        RecordChange(aPropertyHandle);
+#endif
     }
 }
 
@@ -1247,10 +1532,91 @@ void TraitDataSource::DeleteKey(PropertyPathHandle aPropertyHandle)
     {
         mSetDirtyCalled = true;
         SubscriptionEngine::GetInstance()->GetNotificationEngine()->DeleteKey(this, aPropertyHandle);
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+        // A deletion can only be conveyed to a resuming subscriber by replacing the whole dictionary.
+        RecordChange(mSchemaEngine->GetParent(aPropertyHandle));
+#endif
     }
 }
 #endif // TDM_ENABLE_PUBLISHER_DICTIONARY_SUPPORT
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+void TraitDataSource::RecordChange(PropertyPathHandle aPropertyHandle)
+{
+    uint64_t baseVersion;
+
+    // Versions of unmanaged sources may move arbitrarily, so changes cannot be attributed to them.
+    VerifyOrExit(mManagedVersion, /* no-op */);
+
+    // The version is only incremented when the data source is unlocked, so every change made within the current session is
+    // relative to the current version.
+    baseVersion = GetVersion();
+
+    // Skip the path if it has already been recorded in this session.
+    for (uint32_t i = mNumChangeJournalEntries; i > 0; i--)
+    {
+        const ChangeJournalEntry & entry =
+            mChangeJournal[(mChangeJournalHead + i - 1) % WDM_PUBLISHER_CHANGE_JOURNAL_SIZE];
+
+        if (entry.mBaseVersion != baseVersion)
+        {
+            break;
+        }
+
+        VerifyOrExit(entry.mPropertyPathHandle != aPropertyHandle, /* no-op */);
+    }
+
+    if (!mChangeJournalStarted)
+    {
+        mChangeJournalStartVersion = baseVersion;
+        mChangeJournalStarted      = true;
+    }
+
+    if (mNumChangeJournalEntries == WDM_PUBLISHER_CHANGE_JOURNAL_SIZE)
+    {
+        // Dropping the oldest entry means a peer at its base version can no longer be brought up to date from the journal.
+        mChangeJournalStartVersion = mChangeJournal[mChangeJournalHead].mBaseVersion + 1;
+        mChangeJournalHead         = (mChangeJournalHead + 1) % WDM_PUBLISHER_CHANGE_JOURNAL_SIZE;
+        mNumChangeJournalEntries--;
+    }
+
+    {
+        ChangeJournalEntry & entry =
+            mChangeJournal[(mChangeJournalHead + mNumChangeJournalEntries) % WDM_PUBLISHER_CHANGE_JOURNAL_SIZE];
+
+        entry.mBaseVersion        = baseVersion;
+        entry.mPropertyPathHandle = aPropertyHandle;
+        mNumChangeJournalEntries++;
+    }
+
+exit:
+    return;
+}
+
+bool TraitDataSource::IsChangeJournalValidSince(uint64_t aVersion)
+{
+    return mManagedVersion && mChangeJournalStarted && (aVersion >= mChangeJournalStartVersion) && (aVersion < GetVersion());
+}
+
+PropertyPathHandle TraitDataSource::GetNextJournalChange(uint64_t aVersion, uint32_t & aCursor) const
+{
+    while (aCursor < mNumChangeJournalEntries)
+    {
+        const ChangeJournalEntry & entry = mChangeJournal[(mChangeJournalHead + aCursor) % WDM_PUBLISHER_CHANGE_JOURNAL_SIZE];
+
+        aCursor++;
+
+        if (entry.mBaseVersion >= aVersion)
+        {
+            return entry.mPropertyPathHandle;
+        }
+    }
+
+    return kNullPropertyPathHandle;
+}
+#endif // WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+
 WEAVE_ERROR TraitDataSource::Lock()
 {
     mSetDirtyCalled = false;
@@ -176,6 +176,27 @@ public:
         uint8_t mContextTag;
     };
 
+    /**
+     *  @brief
+     *    Optional lookup tables derived from the schema handle table that let the engine navigate the schema tree without
+     *    scanning the whole handle table on every step.
+     *
+     *    The storage is either provided by the trait alongside its schema, or allocated from a shared pool sized by
+     *    #TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES and #TDM_PROPERTY_TREE_INDEX_POOL_SIZE. It is filled in from the schema
+     *    handle table by BuildPropertyTreeIndex, which the trait catalogs call when a trait instance is added. Until then, or if
+     *    the pool is exhausted, the engine keeps scanning the handle table. For a trait with N schema handles, mFirstChild needs
+     *    N + kHandleTableOffset entries, mNextSibling needs N entries and mChildHashTbl needs more than N entries (2N is a good
+     *    choice). Once built, child lookups by context tag and leaf checks are O(1), making path mapping O(depth).
+     */
+    struct PropertyTreeIndex
+    {
+        PropertySchemaHandle * mFirstChild;   ///< Indexed by schema handle, the first child of that handle or 0 if it's a leaf.
+        PropertySchemaHandle * mNextSibling;  ///< Indexed by table offset, the next child of the same parent or 0 if none.
+        PropertySchemaHandle * mChildHashTbl; ///< Open-addressed hash table of child schema handles keyed on (parent, tag).
+        uint32_t mChildHashTblSize;           ///< The number of entries in mChildHashTbl.
+        bool mIsBuilt;                        ///< Set once the tables above have been populated.
+    };
+
     /**
      *  @brief
      *    The main schema structure that houses the schema information.
@@ -201,6 +222,8 @@ public:
 #if (TDM_VERSIONING_SUPPORT)
         const ConstSchemaVersionRange *mVersionRange;     ///< Range of versions supported by this trait
 #endif
+        mutable PropertyTreeIndex *mPropertyTreeIndex; ///< Lookup tables to accelerate tree navigation. Set from the shared pool
+                                                       ///< when the index is built, if NULL.
     };
 
     /* While traits can have deep nested structures (which can include dictionaries), application logic is only expected to provide
@@ -519,14 +542,77 @@ public:
     SchemaVersion GetMinVersion() const;
     SchemaVersion GetMaxVersion() const;
 
+    /**
+     * Populates the property tree index of the schema from its handle table. The trait catalogs call this when a trait
+     * instance is added; it must not be called once the schema is in use on more than one thread, since it writes to the
+     * index storage shared by every engine for the trait. Lookups made before the index is built scan the handle table. If the
+     * schema doesn't provide index storage, it is allocated from the shared pool; if the pool is exhausted, the schema is left
+     * unindexed. This is a no-op if the index has already been built.
+     *
+     * @retval #WEAVE_NO_ERROR                  On success, or if there is no index to build.
+     * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL    If the child hash table doesn't have more entries than the schema has handles.
+     */
+    WEAVE_ERROR BuildPropertyTreeIndex(void) const;
+
 private:
     PropertyPathHandle _GetChildHandle(PropertyPathHandle aParentHandle, uint8_t aContextTag) const;
+    const PropertyTreeIndex * GetPropertyTreeIndex(void) const;
+    void AllocatePropertyTreeIndex(void) const;
+    static uint32_t HashChildKey(PropertySchemaHandle aParentHandle, uint8_t aContextTag, uint32_t aTblSize);
     bool GetBitFromPathHandleBitfield(uint8_t * aBitfield, PropertyPathHandle aPathHandle) const;
 
 public:
     const Schema mSchema;
 };
 
+/*
+ * @class  LeafDataView
+ *
+ * @brief  A view on the contents of a byte or UTF-8 string leaf, in place in the PacketBuffer it was received in.
+ *
+ * The view handed to TraitDataSink::SetLeafDataView is only valid for the duration of that call. Copying it takes a reference
+ * on the PacketBuffer, so a sink can keep large leaves (images, configuration blobs, key material) without copying them out;
+ * the buffer is returned to the pool once every copy has been released. Retained views are counted in System::Stats.
+ *
+ * Note that a retained view keeps the whole PacketBuffer it points into out of the pool.
+ */
+class LeafDataView
+{
+public:
+    LeafDataView(void);
+    LeafDataView(const LeafDataView & aOther);
+    ~LeafDataView(void) { Release(); }
+
+    LeafDataView & operator=(const LeafDataView & aOther);
+
+    /**
+     * Points the view at the string the reader is positioned on, without taking a reference on the buffer.
+     *
+     * @retval #WEAVE_ERROR_WRONG_TLV_TYPE    The reader is not positioned on a byte or UTF-8 string.
+     * @retval #WEAVE_ERROR_INVALID_ARGUMENT  The reader is not reading from a single PacketBuffer.
+     */
+    WEAVE_ERROR Init(nl::Weave::TLV::TLVReader & aReader);
+
+    /**
+     * Drops the reference on the buffer, if any, and empties the view.
+     */
+    void Release(void);
+
+    const uint8_t * GetData(void) const { return mData; }
+    uint32_t GetLength(void) const { return mLength; }
+    nl::Weave::TLV::TLVType GetType(void) const { return mType; }
+    bool IsRetained(void) const { return mIsRetained; }
+
+private:
+    void Retain(void);
+
+    System::PacketBuffer * mBuffer;
+    const uint8_t * mData;
+    uint32_t mLength;
+    nl::Weave::TLV::TLVType mType;
+    bool mIsRetained;
+};
+
 /*
  * @class  TraitDataSink
  *
@@ -685,6 +771,16 @@ public:
      */
     virtual WEAVE_ERROR OnEvent(uint16_t aType, void * aInEventParam) { return WEAVE_NO_ERROR; }
 
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    /*
+     * Sub-classes return true to have their data elements applied on the data list worker threads (see
+     * WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT), concurrently with other sinks. Calls into one sink still come from one thread
+     * at a time and in list order. Such a sink must only touch its own state: it must not call into the Weave stack, and must
+     * not retain the LeafDataViews it is given.
+     */
+    virtual bool IsThreadSafe(void) { return false; }
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+
 #if WEAVE_CONFIG_ENABLE_WDM_UPDATE
     virtual bool IsUpdatableDataSink(void)  { return false; }
 
@@ -712,6 +808,16 @@ protected: // ISetDataDelegate
      */
     virtual WEAVE_ERROR SetData(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader, bool aIsNull) __OVERRIDE;
 
+    /*
+     * Invoked by the default SetData instead of SetLeafData for byte and UTF-8 string leaves received in a PacketBuffer.
+     * Sinks that want to consume such leaves without copying them override this and copy aView to keep it; returning
+     * WEAVE_ERROR_NOT_IMPLEMENTED, as the default does, hands the leaf to SetLeafData instead.
+     */
+    virtual WEAVE_ERROR SetLeafDataView(PropertyPathHandle aLeafHandle, const LeafDataView & aView)
+    {
+        return WEAVE_ERROR_NOT_IMPLEMENTED;
+    }
+
     /* Subclass can invoke this if they desire to reject a particular data change */
     void RejectChange(uint16_t aRejectionStatusCode);
 
@@ -838,6 +944,20 @@ public:
     void DeleteKey(PropertyPathHandle aPropertyHandle);
 #endif
 
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    /**
+     * Returns true if the change journal holds every path changed since aVersion, i.e. a peer at aVersion can be brought up to
+     * date by sending only the paths returned by GetNextJournalChange().
+     */
+    bool IsChangeJournalValidSince(uint64_t aVersion);
+
+    /**
+     * Iterates over the paths changed since aVersion. aCursor should be set to 0 before the first call. Returns
+     * kNullPropertyPathHandle once the journal has been exhausted. A path may be returned more than once.
+     */
+    PropertyPathHandle GetNextJournalChange(uint64_t aVersion, uint32_t & aCursor) const;
+#endif
+
     // This API has been deprecated.
     virtual void OnCustomCommand(Command * aCommand, const nl::Weave::WeaveMessageInfo * aMsgInfo,
                                  nl::Weave::PacketBuffer * aPayload, const uint64_t & aCommandType, const bool aIsExpiryTimeValid,
@@ -900,6 +1020,23 @@ protected: // IGetDataDelegate
     const TraitSchemaEngine * mSchemaEngine;
 
 private:
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    void RecordChange(PropertyPathHandle aPropertyHandle);
+
+    struct ChangeJournalEntry
+    {
+        uint64_t mBaseVersion; ///< Version of the data just before the change
+        PropertyPathHandle mPropertyPathHandle;
+    };
+
+    ChangeJournalEntry mChangeJournal[WDM_PUBLISHER_CHANGE_JOURNAL_SIZE];
+    uint32_t mChangeJournalHead; ///< Index of the oldest entry
+    uint32_t mNumChangeJournalEntries;
+    // Oldest version from which all changes are still in the journal. Only meaningful once an entry has been recorded.
+    uint64_t mChangeJournalStartVersion;
+    bool mChangeJournalStarted;
+#endif
+
     // Current version of the data in this source.
     uint64_t mVersion;
     // Tracks whether SetDirty was called within a Lock/Unlock 'session'
@@ -515,3 +515,433 @@ void TraitPathStore::SetFlags(size_t aIndex, Flags aFlags, bool aValue)
         mStore[aIndex].mFlags |= aFlags;
     }
 }
+
+/**
+ * Empty constructor
+ */
+PropertyPathBitmap::PropertyPathBitmap()
+    : mSchemaEngine(NULL), mPresent(NULL), mBelow(NULL), mMaxWords(0), mNumWords(0),
+      mKeyedPaths(NULL), mMaxKeyedPaths(0), mNumKeyedPaths(0), mNumItems(0)
+{
+}
+
+/**
+ * Inits the PropertyPathBitmap
+ *
+ * @param[in]   aWords          Storage for the bitmaps. Use GetNumWordsNeeded() to size it for the
+ *                              largest trait the set will be attached to.
+ * @param[in]   aNumWords       Length of aWords in number of Words.
+ * @param[in]   aKeyedPaths     Storage for paths within dictionary items. Can be NULL if
+ *                              aMaxKeyedPaths is 0, in which case adding such a path fails.
+ * @param[in]   aMaxKeyedPaths  Length of aKeyedPaths in number of items.
+ */
+void PropertyPathBitmap::Init(Word *aWords, size_t aNumWords, PropertyPathHandle *aKeyedPaths, size_t aMaxKeyedPaths)
+{
+    mSchemaEngine = NULL;
+    mMaxWords = aNumWords / 2;
+    mNumWords = 0;
+    mPresent = aWords;
+    mBelow = aWords + mMaxWords;
+    mKeyedPaths = aKeyedPaths;
+    mMaxKeyedPaths = aMaxKeyedPaths;
+
+    Clear();
+}
+
+/**
+ * Empties the set and binds it to the schema of a trait.
+ *
+ * @param[in]   aSchemaEngine   The TraitSchemaEngine of the trait instance the paths will refer to.
+ *
+ * @retval WEAVE_NO_ERROR               in case of success.
+ * @retval WEAVE_ERROR_BUFFER_TOO_SMALL if the storage passed to Init() is too small for the schema.
+ */
+WEAVE_ERROR PropertyPathBitmap::Attach(const TraitSchemaEngine * const aSchemaEngine)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const size_t numWords = GetNumWordsNeeded(aSchemaEngine->mSchema.mNumSchemaHandleEntries) / 2;
+
+    VerifyOrExit(numWords <= mMaxWords, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    mSchemaEngine = aSchemaEngine;
+    mNumWords = numWords;
+
+    Clear();
+
+exit:
+    return err;
+}
+
+/**
+ * Adds a path to the set, removing any paths it is an ancestor of.
+ * Adding a path that is already included by the set is a no-op.
+ *
+ * @param[in]   aItem   The PropertyPathHandle to add.
+ *
+ * @retval WEAVE_NO_ERROR                   in case of success.
+ * @retval WEAVE_ERROR_INCORRECT_STATE      if the set is not attached to a schema.
+ * @retval WEAVE_ERROR_INVALID_ARGUMENT     if aItem is not a handle of the schema.
+ * @retval WEAVE_ERROR_WDM_PATH_STORE_FULL  if aItem is within a dictionary item and there is no
+ *                                          space left in the side set.
+ */
+WEAVE_ERROR PropertyPathBitmap::AddItem(PropertyPathHandle aItem)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool isKeyed;
+
+    VerifyOrExit(mSchemaEngine != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(!IsNullPropertyPathHandle(aItem) &&
+                 GetPropertySchemaHandle(aItem) < mSchemaEngine->mSchema.mNumSchemaHandleEntries + TraitSchemaEngine::kHandleTableOffset,
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    if (Includes(aItem))
+    {
+        ExitNow();
+    }
+
+    isKeyed = IsKeyed(aItem);
+
+    // Check for space before touching the set so that a failure leaves it unchanged.
+    VerifyOrExit(!isKeyed || mNumKeyedPaths < mMaxKeyedPaths, err = WEAVE_ERROR_WDM_PATH_STORE_FULL);
+
+    RemoveItemsBelow(aItem, isKeyed);
+
+    if (isKeyed)
+    {
+        mKeyedPaths[mNumKeyedPaths++] = aItem;
+    }
+    else
+    {
+        SetBit(mPresent, GetPropertySchemaHandle(aItem));
+    }
+
+    mNumItems++;
+
+    MarkAncestors(aItem, isKeyed);
+
+exit:
+    return err;
+}
+
+/**
+ * Removes a path from the set. Paths included by aItem but not equal to it are not affected.
+ * The subtree bitmap is rebuilt from the remaining paths, so this costs a walk up the schema
+ * tree for each of them.
+ *
+ * @param[in]   aItem   The PropertyPathHandle to remove.
+ */
+void PropertyPathBitmap::RemoveItem(PropertyPathHandle aItem)
+{
+    uint32_t cursor = 0;
+    PropertyPathHandle handle;
+
+    VerifyOrExit(IsPresent(aItem), );
+
+    if (IsKeyed(aItem))
+    {
+        for (size_t i = 0; i < mNumKeyedPaths; i++)
+        {
+            if (mKeyedPaths[i] == aItem)
+            {
+                mKeyedPaths[i] = mKeyedPaths[--mNumKeyedPaths];
+                break;
+            }
+        }
+    }
+    else
+    {
+        ClearBit(mPresent, GetPropertySchemaHandle(aItem));
+    }
+
+    mNumItems--;
+
+    memset(mBelow, 0, mMaxWords * sizeof(Word));
+
+    while ((handle = GetNextItem(cursor)) != kNullPropertyPathHandle)
+    {
+        MarkAncestors(handle, IsKeyed(handle));
+    }
+
+exit:
+    return;
+}
+
+/**
+ * Empties the set.
+ */
+void PropertyPathBitmap::Clear()
+{
+    if (mPresent != NULL)
+    {
+        memset(mPresent, 0, 2 * mMaxWords * sizeof(Word));
+    }
+
+    mNumKeyedPaths = 0;
+    mNumItems = 0;
+}
+
+/**
+ * Iterates over the paths in the set. Paths outside of dictionaries are returned in ascending
+ * schema handle order, followed by the paths within dictionary items.
+ *
+ * @param[inout]    aCursor     Set to 0 to start iterating; updated on every call.
+ *
+ * @return The next path in the set, or kNullPropertyPathHandle once all have been returned.
+ */
+PropertyPathHandle PropertyPathBitmap::GetNextItem(uint32_t &aCursor) const
+{
+    const uint32_t numBits = mNumWords * kBitsPerWord;
+
+    while (aCursor < numBits)
+    {
+        const Word word = mPresent[aCursor / kBitsPerWord] >> (aCursor % kBitsPerWord);
+
+        if (word == 0)
+        {
+            // Skip the rest of this word.
+            aCursor += kBitsPerWord - (aCursor % kBitsPerWord);
+        }
+        else if (word & 0x1)
+        {
+            return static_cast<PropertyPathHandle>(aCursor++);
+        }
+        else
+        {
+            aCursor++;
+        }
+    }
+
+    if (aCursor - numBits < mNumKeyedPaths)
+    {
+        return mKeyedPaths[aCursor++ - numBits];
+    }
+
+    return kNullPropertyPathHandle;
+}
+
+/**
+ * @param[in] aItem The PropertyPathHandle to look for.
+ *
+ * @return Returns true if aItem itself is in the set.
+ */
+bool PropertyPathBitmap::IsPresent(PropertyPathHandle aItem) const
+{
+    if (mNumItems == 0)
+    {
+        return false;
+    }
+
+    if (IsKeyed(aItem))
+    {
+        return IsKeyedItemPresent(aItem);
+    }
+
+    return GetPropertySchemaHandle(aItem) < mNumWords * kBitsPerWord && TestBit(mPresent, GetPropertySchemaHandle(aItem));
+}
+
+/**
+ * Check if the set includes a given path; that is, if the path or one of its ancestors is in the set.
+ *
+ * @param[in] aItem The PropertyPathHandle to be checked against the set.
+ *
+ * @return  true if aItem is included by the paths in the set.
+ */
+bool PropertyPathBitmap::Includes(PropertyPathHandle aItem) const
+{
+    bool isKeyed;
+
+    if (mNumItems == 0)
+    {
+        return false;
+    }
+
+    isKeyed = IsKeyed(aItem);
+
+    for (PropertyPathHandle handle = aItem; !IsNullPropertyPathHandle(handle); )
+    {
+        PropertyPathHandle parent = mSchemaEngine->GetParent(handle);
+
+        if (isKeyed ? IsKeyedItemPresent(handle) : TestBit(mPresent, GetPropertySchemaHandle(handle)))
+        {
+            return true;
+        }
+
+        // Past the top of a dictionary item, the ancestors are plain schema handles again.
+        if (isKeyed && mSchemaEngine->IsDictionary(parent))
+        {
+            isKeyed = false;
+        }
+
+        handle = parent;
+    }
+
+    return false;
+}
+
+/**
+ * Check if any of the paths in the set intersects a given path. Two paths intersect each
+ * other if they are the same or one of them is an ancestor of the other.
+ *
+ * @param[in] aItem The PropertyPathHandle to be checked against the set.
+ *
+ * @return  true if the set intersects aItem.
+ */
+bool PropertyPathBitmap::Intersects(PropertyPathHandle aItem) const
+{
+    return Includes(aItem) || HasItemBelow(aItem, IsKeyed(aItem));
+}
+
+/**
+ * Check if any path in this set intersects any path in another set for the same trait.
+ * Paths outside of dictionaries are compared a word at a time.
+ *
+ * @param[in] aOther    The set to be checked against this one.
+ *
+ * @return  true if the sets intersect.
+ */
+bool PropertyPathBitmap::Intersects(const PropertyPathBitmap &aOther) const
+{
+    uint32_t cursor;
+    PropertyPathHandle handle;
+
+    if (mNumItems == 0 || aOther.mNumItems == 0 || mSchemaEngine != aOther.mSchemaEngine)
+    {
+        return false;
+    }
+
+    // A path in one set intersects the other set if it is in the other set, or the other set has a path below it. Paths below
+    // an ancestor are recorded in the subtree bitmaps for keyed paths too, so this also catches any keyed path that is below a
+    // path outside of dictionaries.
+    for (size_t i = 0; i < mNumWords; i++)
+    {
+        if ((mPresent[i] & (aOther.mPresent[i] | aOther.mBelow[i])) | (aOther.mPresent[i] & mBelow[i]))
+        {
+            return true;
+        }
+    }
+
+    // What remains is keyed paths intersecting each other, or a keyed path being included by a path outside of dictionaries.
+    cursor = aOther.mNumWords * kBitsPerWord;
+    while ((handle = aOther.GetNextItem(cursor)) != kNullPropertyPathHandle)
+    {
+        if (Intersects(handle))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Private members
+
+bool PropertyPathBitmap::IsKeyed(PropertyPathHandle aItem) const
+{
+    PropertyPathHandle dictionaryItemHandle;
+
+    return (!IsNullPropertyPathHandle(aItem) && mSchemaEngine->IsInDictionary(aItem, dictionaryItemHandle));
+}
+
+bool PropertyPathBitmap::IsKeyedItemPresent(PropertyPathHandle aItem) const
+{
+    for (size_t i = 0; i < mNumKeyedPaths; i++)
+    {
+        if (mKeyedPaths[i] == aItem)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PropertyPathBitmap::HasItemBelow(PropertyPathHandle aItem, bool aIsKeyed) const
+{
+    if (!aIsKeyed && TestBit(mBelow, GetPropertySchemaHandle(aItem)))
+    {
+        return true;
+    }
+
+    // Keyed paths can only be below keyed paths of the same dictionary item; those aren't tracked in the subtree bitmap.
+    for (size_t i = 0; aIsKeyed && i < mNumKeyedPaths; i++)
+    {
+        if (mSchemaEngine->IsParent(mKeyedPaths[i], aItem))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PropertyPathBitmap::RemoveItemsBelow(PropertyPathHandle aItem, bool aIsKeyed)
+{
+    const PropertySchemaHandle schemaHandle = GetPropertySchemaHandle(aItem);
+
+    if (!aIsKeyed && TestBit(mBelow, schemaHandle))
+    {
+        for (size_t i = 0; i < mNumWords; i++)
+        {
+            for (Word bits = mPresent[i] | mBelow[i]; bits != 0; bits &= bits - 1)
+            {
+                PropertySchemaHandle handle = 0;
+
+                while (((bits >> handle) & 0x1) == 0)
+                {
+                    handle++;
+                }
+
+                handle = static_cast<PropertySchemaHandle>(i * kBitsPerWord + handle);
+
+                if (mSchemaEngine->IsParent(handle, aItem))
+                {
+                    if (TestBit(mPresent, handle))
+                    {
+                        ClearBit(mPresent, handle);
+                        mNumItems--;
+                    }
+
+                    ClearBit(mBelow, handle);
+                }
+            }
+        }
+
+        ClearBit(mBelow, schemaHandle);
+    }
+
+    // Keyed paths can be below either kind of path.
+    for (size_t i = mNumKeyedPaths; i > 0; i--)
+    {
+        if (mSchemaEngine->IsParent(mKeyedPaths[i - 1], aItem))
+        {
+            mKeyedPaths[i - 1] = mKeyedPaths[--mNumKeyedPaths];
+            mNumItems--;
+        }
+    }
+}
+
+void PropertyPathBitmap::MarkAncestors(PropertyPathHandle aItem, bool aIsKeyed)
+{
+    PropertyPathHandle handle = mSchemaEngine->GetParent(aItem);
+
+    while (!IsNullPropertyPathHandle(handle))
+    {
+        if (aIsKeyed && mSchemaEngine->IsDictionary(handle))
+        {
+            aIsKeyed = false;
+        }
+
+        if (!aIsKeyed)
+        {
+            // If this ancestor was already marked, so are all the ones above it.
+            if (TestBit(mBelow, GetPropertySchemaHandle(handle)))
+            {
+                break;
+            }
+
+            SetBit(mBelow, GetPropertySchemaHandle(handle));
+        }
+
+        handle = mSchemaEngine->GetParent(handle);
+    }
+}
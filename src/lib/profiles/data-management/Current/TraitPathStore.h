@@ -18,7 +18,8 @@
 
 /**
  *    @file
- *    Defines TraitPathStore: a data structure to store lists or sets of TraitPaths.
+ *    Defines TraitPathStore: a data structure to store lists or sets of TraitPaths,
+ *    and PropertyPathBitmap: a set of property paths within a single trait instance.
  *
  */
 
@@ -110,6 +111,84 @@ struct TraitPathStore
         size_t mNumItems;
 };
 
+/**
+ * A set of property paths within a single trait instance, stored as bitmaps over the schema handles of the trait.
+ *
+ * Alongside the bitmap of paths in the set, a second "subtree" bitmap records, for every schema handle, whether some path in
+ * the set lies strictly below it. Together they make insertion and the inclusion/intersection tests O(depth) regardless of
+ * how many paths are in the set, and let two sets be intersected a word at a time.
+ *
+ * Paths inside dictionary items carry a dictionary key and can't be represented by a bit per schema handle; these are kept in
+ * a small side set of handles supplied by the caller.
+ *
+ * Like TraitPathStore, the set only holds the minimal covering paths: adding a path that is already included is a no-op,
+ * and adding an ancestor of existing paths replaces them.
+ */
+class PropertyPathBitmap
+{
+    public:
+        typedef uint32_t Word;
+
+        enum {
+            kBitsPerWord = 32,
+        };
+
+        PropertyPathBitmap();
+
+        /**
+         * @return The number of Words of storage needed for a trait with the given number of schema handles.
+         */
+        static size_t GetNumWordsNeeded(uint32_t aNumSchemaHandleEntries) {
+            return 2 * ((aNumSchemaHandleEntries + TraitSchemaEngine::kHandleTableOffset + kBitsPerWord - 1) / kBitsPerWord);
+        }
+
+        void Init(Word *aWords, size_t aNumWords, PropertyPathHandle *aKeyedPaths, size_t aMaxKeyedPaths);
+
+        WEAVE_ERROR Attach(const TraitSchemaEngine * const aSchemaEngine);
+        const TraitSchemaEngine *GetSchemaEngine() const { return mSchemaEngine; }
+
+        bool IsEmpty() const { return mNumItems == 0; }
+        size_t GetNumItems() const { return mNumItems; }
+
+        WEAVE_ERROR AddItem(PropertyPathHandle aItem);
+        void RemoveItem(PropertyPathHandle aItem);
+        void Clear();
+
+        PropertyPathHandle GetNextItem(uint32_t &aCursor) const;
+
+        bool IsPresent(PropertyPathHandle aItem) const;
+        bool Includes(PropertyPathHandle aItem) const;
+        bool Intersects(PropertyPathHandle aItem) const;
+        bool Intersects(const PropertyPathBitmap &aOther) const;
+
+    private:
+        bool IsKeyed(PropertyPathHandle aItem) const;
+        bool IsKeyedItemPresent(PropertyPathHandle aItem) const;
+        bool HasItemBelow(PropertyPathHandle aItem, bool aIsKeyed) const;
+        void RemoveItemsBelow(PropertyPathHandle aItem, bool aIsKeyed);
+        void MarkAncestors(PropertyPathHandle aItem, bool aIsKeyed);
+
+        static bool TestBit(const Word *aBits, PropertySchemaHandle aHandle) {
+            return (aBits[aHandle / kBitsPerWord] & (static_cast<Word>(1) << (aHandle % kBitsPerWord))) != 0;
+        }
+        static void SetBit(Word *aBits, PropertySchemaHandle aHandle) {
+            aBits[aHandle / kBitsPerWord] |= (static_cast<Word>(1) << (aHandle % kBitsPerWord));
+        }
+        static void ClearBit(Word *aBits, PropertySchemaHandle aHandle) {
+            aBits[aHandle / kBitsPerWord] &= ~(static_cast<Word>(1) << (aHandle % kBitsPerWord));
+        }
+
+        const TraitSchemaEngine *mSchemaEngine;
+        Word *mPresent;             /**< A bit per schema handle, set if the handle is in the set. */
+        Word *mBelow;               /**< A bit per schema handle, set if an item in the set lies strictly below it. */
+        size_t mMaxWords;           /**< The capacity of each of the two bitmaps. */
+        size_t mNumWords;           /**< The number of words of each bitmap used by the attached schema. */
+        PropertyPathHandle *mKeyedPaths;
+        size_t mMaxKeyedPaths;
+        size_t mNumKeyedPaths;
+        size_t mNumItems;
+};
+
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
 }; // namespace Weave
@@ -40,8 +40,11 @@ namespace Weave {
 namespace Profiles {
 namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current) {
 
-// Do nothing
-ViewClient::ViewClient() { }
+ViewClient::ViewClient() :
+    mCurrentMode(kMode_Canceled), mBinding(NULL), mAppState(NULL), mEventCallback(NULL), mPrevIsPartialChange(false), mEC(NULL)
+{
+    mHandleDataElement = NULL;
+}
 
 // AddRef to Binding
 // store pointers to binding and app state
@@ -73,7 +76,7 @@ WEAVE_ERROR ViewClient::SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog,
 {
     WEAVE_ERROR err       = WEAVE_NO_ERROR;
     PacketBuffer * MsgBuf = NULL;
-    SchemaVersionRange requestedSchemaVersionRange;
+    size_t numPathsConsumed;
 
     VerifyOrExit(kMode_Initialized == mCurrentMode, err = WEAVE_ERROR_INCORRECT_STATE);
 
@@ -85,59 +88,86 @@ WEAVE_ERROR ViewClient::SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog,
 
     {
         nl::Weave::TLV::TLVWriter writer;
-        nl::Weave::TLV::TLVType dummyContainerType;
         writer.Init(MsgBuf);
 
-        err = writer.StartContainer(nl::Weave::TLV::AnonymousTag, nl::Weave::TLV::kTLVType_Structure, dummyContainerType);
+        err = EncodeRequest(writer, apCatalog, aPathList, aPathListSize, MsgBuf->AvailableDataLength(), numPathsConsumed);
         SuccessOrExit(err);
 
-        PathList::Builder pathList;
-        err = pathList.Init(&writer, ViewRequest::kCsTag_PathList);
+        // all paths must fit in a single request
+        VerifyOrExit(numPathsConsumed == aPathListSize, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+        err = writer.Finalize();
         SuccessOrExit(err);
+    }
 
-        for (size_t i = 0; i < aPathListSize; ++i)
-        {
-            TraitDataSink * pDataSink;
-            nl::Weave::TLV::TLVType dummyContainerType2;
+    err = mBinding->NewExchangeContext(mEC);
+    if (WEAVE_NO_ERROR != err)
+    {
+        EventParam Param;
+        // Nothing to initialize in Param.mRequestFailureEventParam
+        mEventCallback(mAppState, kEvent_RequestFailed, err, Param);
+        ExitNow();
+    }
 
-            // Start the TLV Path
-            err = writer.StartContainer(nl::Weave::TLV::AnonymousTag, nl::Weave::TLV::kTLVType_Path, dummyContainerType2);
-            SuccessOrExit(err);
+    mEC->AppState          = this;
+    mEC->OnMessageReceived = OnMessageReceived;
+    mEC->OnResponseTimeout = OnResponseTimeout;
+    mEC->OnSendError       = OnSendError;
 
-            // Start, fill, and close the TLV Structure that contains ResourceID, ProfileID, and InstanceID
-            err = mDataSinkCatalog->HandleToAddress(aPathList[i].mTraitDataHandle, writer, requestedSchemaVersionRange);
+    err    = mEC->SendMessage(nl::Weave::Profiles::kWeaveProfile_WDM, kMsgType_ViewRequest, MsgBuf);
+    MsgBuf = NULL;
+    SuccessOrExit(err);
 
-            if (err == WEAVE_ERROR_INVALID_ARGUMENT)
-            {
-                // HandleToAddress() can return an error if the sink has been removed from the catalog. In that case,
-                // continue to next entry
-                err = WEAVE_NO_ERROR;
-                continue;
-            }
+exit:
+    WeaveLogFunctError(err);
 
-            SuccessOrExit(err);
+    if (NULL != MsgBuf)
+    {
+        PacketBuffer::Free(MsgBuf);
+        MsgBuf = NULL;
+    }
 
-            if (mDataSinkCatalog->Locate(aPathList[i].mTraitDataHandle, &pDataSink) != WEAVE_NO_ERROR)
-            {
-                // Ideally, this code will not be reached as Locate() should find the entry in the catalog.
-                // Otherwise, the earlier HandleToAddress() call would have continued.
-                // However, keeping this check here for consistency and code safety
-                continue;
-            }
+    if (WEAVE_NO_ERROR != err)
+    {
+        Cancel();
+    }
 
-            // Append zero or more TLV tags based on the Path Handle
-            err = pDataSink->GetSchemaEngine()->MapHandleToPath(aPathList[i].mPropertyPathHandle, writer);
-            SuccessOrExit(err);
+    return err;
+}
 
-            // Close the TLV Path
-            err = writer.EndContainer(dummyContainerType2);
-            SuccessOrExit(err);
-        }
+// acquire right-sized buffer from binding, encode the paths that fit, kick off send message
+WEAVE_ERROR ViewClient::SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog, const TraitPath aPathList[],
+                                    const size_t aPathListSize, HandleDataElement const aHandleDataElement,
+                                    size_t & aNumPathsConsumed)
+{
+    WEAVE_ERROR err         = WEAVE_NO_ERROR;
+    PacketBuffer * MsgBuf   = NULL;
+    uint32_t maxPayloadSize = 0;
 
-        err = pathList.EndOfPathList().GetError();
-        SuccessOrExit(err);
+    aNumPathsConsumed = 0;
 
-        err = writer.EndContainer(dummyContainerType);
+    VerifyOrExit(kMode_Initialized == mCurrentMode, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    if (NULL == aHandleDataElement)
+    {
+        mCurrentMode     = kMode_DataSink;
+        mDataSinkCatalog = apCatalog;
+    }
+    else
+    {
+        mCurrentMode       = kMode_WithoutDataSink;
+        mHandleDataElement = aHandleDataElement;
+    }
+
+    // A path that can't fit in the payload is reported by EncodeRequest; no need for a minimum size here
+    err = mBinding->AllocateRightSizedBuffer(MsgBuf, WDM_MAX_VIEW_REQUEST_SIZE, 0, maxPayloadSize);
+    SuccessOrExit(err);
+
+    {
+        nl::Weave::TLV::TLVWriter writer;
+        writer.Init(MsgBuf, maxPayloadSize);
+
+        err = EncodeRequest(writer, apCatalog, aPathList, aPathListSize, maxPayloadSize, aNumPathsConsumed);
         SuccessOrExit(err);
 
         err = writer.Finalize();
@@ -179,6 +209,106 @@ exit:
     return err;
 }
 
+/**
+ * Encodes a ViewRequest with the paths of the list, in order, until the
+ * next one would not leave room to close the request within aMaxPayloadSize.
+ *
+ * Paths whose sink has been removed from the catalog are skipped, but still
+ * count as consumed.
+ *
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL if the first path doesn't fit.
+ */
+WEAVE_ERROR ViewClient::EncodeRequest(nl::Weave::TLV::TLVWriter & aWriter, TraitCatalogBase<TraitDataSink> * apCatalog,
+                                      const TraitPath aPathList[], const size_t aPathListSize, const uint32_t aMaxPayloadSize,
+                                      size_t & aNumPathsConsumed)
+{
+    // End of the path list and of the request
+    const uint32_t kRequestTrailerSize = 2;
+
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Weave::TLV::TLVType dummyContainerType;
+    nl::Weave::TLV::TLVWriter checkpoint;
+    SchemaVersionRange requestedSchemaVersionRange;
+    PathList::Builder pathList;
+    size_t i = 0;
+
+    aNumPathsConsumed = 0;
+
+    err = aWriter.StartContainer(nl::Weave::TLV::AnonymousTag, nl::Weave::TLV::kTLVType_Structure, dummyContainerType);
+    SuccessOrExit(err);
+
+    err = pathList.Init(&aWriter, ViewRequest::kCsTag_PathList);
+    SuccessOrExit(err);
+
+    for (i = 0; i < aPathListSize; ++i)
+    {
+        TraitDataSink * pDataSink;
+        nl::Weave::TLV::TLVType dummyContainerType2;
+
+        checkpoint = aWriter;
+
+        // Start the TLV Path
+        err = aWriter.StartContainer(nl::Weave::TLV::AnonymousTag, nl::Weave::TLV::kTLVType_Path, dummyContainerType2);
+        SuccessOrExit(err);
+
+        // Start, fill, and close the TLV Structure that contains ResourceID, ProfileID, and InstanceID
+        err = apCatalog->HandleToAddress(aPathList[i].mTraitDataHandle, aWriter, requestedSchemaVersionRange);
+
+        if (err == WEAVE_ERROR_INVALID_ARGUMENT)
+        {
+            // HandleToAddress() can return an error if the sink has been removed from the catalog. In that case,
+            // continue to next entry
+            err     = WEAVE_NO_ERROR;
+            aWriter = checkpoint;
+            continue;
+        }
+
+        SuccessOrExit(err);
+
+        if (apCatalog->Locate(aPathList[i].mTraitDataHandle, &pDataSink) != WEAVE_NO_ERROR)
+        {
+            // Ideally, this code will not be reached as Locate() should find the entry in the catalog.
+            // Otherwise, the earlier HandleToAddress() call would have continued.
+            // However, keeping this check here for consistency and code safety
+            aWriter = checkpoint;
+            continue;
+        }
+
+        // Append zero or more TLV tags based on the Path Handle
+        err = pDataSink->GetSchemaEngine()->MapHandleToPath(aPathList[i].mPropertyPathHandle, aWriter);
+        SuccessOrExit(err);
+
+        // Close the TLV Path
+        err = aWriter.EndContainer(dummyContainerType2);
+        SuccessOrExit(err);
+
+        VerifyOrExit(aWriter.GetLengthWritten() + kRequestTrailerSize <= aMaxPayloadSize, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+    }
+
+exit:
+    if ((WEAVE_ERROR_BUFFER_TOO_SMALL == err) && (i > 0))
+    {
+        // Leave this path and the rest of the list to the next request
+        aWriter = checkpoint;
+        err     = WEAVE_NO_ERROR;
+    }
+
+    if (WEAVE_NO_ERROR == err)
+    {
+        aNumPathsConsumed = i;
+
+        err = pathList.EndOfPathList().GetError();
+        if (WEAVE_NO_ERROR == err)
+        {
+            err = aWriter.EndContainer(dummyContainerType);
+        }
+    }
+
+    WeaveLogFunctError(err);
+
+    return err;
+}
+
 // acquire EC from binding, kick off send message
 WEAVE_ERROR ViewClient::SendRequest(AppendToPathList const aAppendToPathList, HandleDataElement const aHandleDataElement)
 {
@@ -561,6 +691,342 @@ exit:
     }
 }
 
+MultiViewClient::MultiViewClient() :
+    mBinding(NULL), mAppState(NULL), mEventCallback(NULL), mHandleDataElement(NULL), mDataSinkCatalog(NULL), mPathList(NULL),
+    mPathListSize(0), mNextPath(0), mViewError(WEAVE_NO_ERROR), mIsWorkScheduled(false)
+{
+    for (size_t i = 0; i < ArraySize(mRequests); ++i)
+    {
+        mRequests[i].mpOwner = this;
+        mRequests[i].mState  = kRequestState_Free;
+    }
+
+    ResetStatistics();
+}
+
+// AddRef to Binding
+// store pointers to binding and app state
+WEAVE_ERROR MultiViewClient::Init(Binding * const apBinding, void * const apAppState, EventCallback const aEventCallback)
+{
+    (void) Cancel();
+
+    apBinding->AddRef();
+
+    mBinding       = apBinding;
+    mAppState      = apAppState;
+    mEventCallback = aEventCallback;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * Retrieves the paths of the list with as many ViewRequests as it takes,
+ * keeping up to #WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS of them in flight.
+ *
+ * Once the view has started, failures are only reported through the event
+ * callback: every path that could not be retrieved is reported by a
+ * kEvent_RequestFailed, possibly before this method returns, and the view
+ * always ends with kEvent_ViewComplete.
+ *
+ * @retval #WEAVE_ERROR_INCORRECT_STATE if the client is not initialized or a view is in progress.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT if the path list is empty.
+ */
+WEAVE_ERROR MultiViewClient::SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog, const TraitPath aPathList[],
+                                         const size_t aPathListSize, ViewClient::HandleDataElement const aHandleDataElement)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(NULL != mBinding && !IsViewInProgress(), err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(NULL != aPathList && aPathListSize > 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mDataSinkCatalog   = apCatalog;
+    mHandleDataElement = aHandleDataElement;
+    mPathList          = aPathList;
+    mPathListSize      = aPathListSize;
+    mNextPath          = 0;
+    mViewError         = WEAVE_NO_ERROR;
+
+    SendPendingRequests();
+
+exit:
+    WeaveLogFunctError(err);
+
+    return err;
+}
+
+// cancel all requests in flight, release binding, null out all pointers
+WEAVE_ERROR MultiViewClient::Cancel()
+{
+    CancelRequests();
+
+    if (NULL != mBinding)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+
+    mAppState      = NULL;
+    mEventCallback = NULL;
+
+    return WEAVE_NO_ERROR;
+}
+
+void MultiViewClient::ResetStatistics()
+{
+    memset(&mStatistics, 0, sizeof(mStatistics));
+}
+
+void MultiViewClient::CancelRequests()
+{
+    if (mIsWorkScheduled)
+    {
+        mBinding->GetExchangeManager()->MessageLayer->SystemLayer->CancelTimer(OnWork, this);
+        mIsWorkScheduled = false;
+    }
+
+    for (size_t i = 0; i < ArraySize(mRequests); ++i)
+    {
+        mRequests[i].mViewClient.Cancel();
+        mRequests[i].mState = kRequestState_Free;
+    }
+
+    mPathList     = NULL;
+    mPathListSize = 0;
+    mNextPath     = 0;
+}
+
+/**
+ * Sends requests for the paths that have not been sent yet, until the window
+ * of requests is full. Requests that have completed since the last call are
+ * made available again first.
+ *
+ * If a request can't be sent, the paths that have not been sent are given up
+ * on and reported to the application with kEvent_RequestFailed.
+ */
+void MultiViewClient::SendPendingRequests()
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    for (size_t i = 0; i < ArraySize(mRequests) && mNextPath < mPathListSize; ++i)
+    {
+        Request & request = mRequests[i];
+
+        if (kRequestState_Done == request.mState)
+        {
+            request.mState = kRequestState_Free;
+        }
+
+        if (kRequestState_Free != request.mState)
+        {
+            continue;
+        }
+
+        err = request.mViewClient.Init(mBinding, &request, ViewClientEventCallback);
+        SuccessOrExit(err);
+
+        request.mState        = kRequestState_InFlight;
+        request.mFirstPath    = mNextPath;
+        request.mSendTimeMsec = System::Layer::GetClock_MonotonicMS();
+
+        // mNumPaths is filled in before the ViewClient can report a failure to send
+        err = request.mViewClient.SendRequest(mDataSinkCatalog, &mPathList[mNextPath], mPathListSize - mNextPath,
+                                              (NULL != mHandleDataElement) ? HandleDataElementForRequest : NULL,
+                                              request.mNumPaths);
+        if (WEAVE_NO_ERROR != err)
+        {
+            if (kRequestState_InFlight == request.mState)
+            {
+                request.mState = kRequestState_Free;
+            }
+            else
+            {
+                // The failure has already been reported with the paths of the request,
+                // and the application may have canceled the view from the callback
+                VerifyOrExit(IsViewInProgress(), err = WEAVE_NO_ERROR);
+
+                mNextPath += request.mNumPaths;
+            }
+
+            ExitNow();
+        }
+
+        WeaveLogDetail(DataManagement, "Sent ViewRequest for paths %u-%u of %u", static_cast<unsigned>(request.mFirstPath),
+                       static_cast<unsigned>(request.mFirstPath + request.mNumPaths), static_cast<unsigned>(mPathListSize));
+
+        mStatistics.mNumRequestsSent++;
+        mNextPath += request.mNumPaths;
+    }
+
+exit:
+    WeaveLogFunctError(err);
+
+    if ((WEAVE_NO_ERROR != err) && (mNextPath < mPathListSize))
+    {
+        FailUnsentPaths(err);
+    }
+}
+
+// Gives up on the paths that have not been sent; the view completes once the requests in flight have
+void MultiViewClient::FailUnsentPaths(WEAVE_ERROR aErrorCode)
+{
+    EventParam param;
+
+    param.mPathList     = &mPathList[mNextPath];
+    param.mPathListSize = mPathListSize - mNextPath;
+    param.mStatusReport = NULL;
+
+    mNextPath  = mPathListSize;
+    mViewError = aErrorCode;
+
+    mStatistics.mNumRequestsFailed++;
+    mEventCallback(mAppState, kEvent_RequestFailed, aErrorCode, param);
+
+    // The application may have canceled the view from the callback
+    if (IsViewInProgress())
+    {
+        ScheduleWork();
+    }
+}
+
+void MultiViewClient::ScheduleWork()
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(!mIsWorkScheduled, );
+
+    err = mBinding->GetExchangeManager()->MessageLayer->SystemLayer->ScheduleWork(OnWork, this);
+    SuccessOrExit(err);
+
+    mIsWorkScheduled = true;
+
+exit:
+    WeaveLogFunctError(err);
+}
+
+// The ViewClient that completed a request is still on the stack; the next requests are sent from here
+void MultiViewClient::OnWork(System::Layer * aSystemLayer, void * aAppState, System::Error aError)
+{
+    MultiViewClient * const pClient = reinterpret_cast<MultiViewClient *>(aAppState);
+    WEAVE_ERROR err                 = WEAVE_NO_ERROR;
+    bool isComplete                 = true;
+    EventParam param;
+
+    VerifyOrExit(pClient->mIsWorkScheduled, );
+    pClient->mIsWorkScheduled = false;
+
+    pClient->SendPendingRequests();
+    VerifyOrExit(pClient->IsViewInProgress(), );
+
+    for (size_t i = 0; i < ArraySize(pClient->mRequests); ++i)
+    {
+        if (kRequestState_InFlight == pClient->mRequests[i].mState)
+        {
+            isComplete = false;
+        }
+    }
+
+    if (isComplete && pClient->mNextPath == pClient->mPathListSize)
+    {
+        err = pClient->mViewError;
+
+        pClient->CancelRequests();
+
+        param.mPathList     = NULL;
+        param.mPathListSize = 0;
+        param.mStatusReport = NULL;
+        pClient->mEventCallback(pClient->mAppState, kEvent_ViewComplete, err, param);
+    }
+
+exit:
+    return;
+}
+
+void MultiViewClient::RecordLatency(Request & aRequest)
+{
+    const uint32_t latencyMsec = static_cast<uint32_t>(System::Layer::GetClock_MonotonicMS() - aRequest.mSendTimeMsec);
+
+    if ((0 == mStatistics.mNumResponsesReceived) || (latencyMsec < mStatistics.mMinLatencyMsec))
+    {
+        mStatistics.mMinLatencyMsec = latencyMsec;
+    }
+
+    if (latencyMsec > mStatistics.mMaxLatencyMsec)
+    {
+        mStatistics.mMaxLatencyMsec = latencyMsec;
+    }
+
+    mStatistics.mNumResponsesReceived++;
+    mStatistics.mTotalLatencyMsec += latencyMsec;
+}
+
+void MultiViewClient::OnRequestDone(Request & aRequest, EventID aEvent, WEAVE_ERROR aErrorCode, PacketBuffer * aStatusReport)
+{
+    EventParam param;
+
+    aRequest.mState = kRequestState_Done;
+
+    if (kEvent_RequestFailed == aEvent)
+    {
+        mViewError = aErrorCode;
+        mStatistics.mNumRequestsFailed++;
+    }
+
+    param.mPathList     = &mPathList[aRequest.mFirstPath];
+    param.mPathListSize = aRequest.mNumPaths;
+    param.mStatusReport = aStatusReport;
+    mEventCallback(mAppState, aEvent, aErrorCode, param);
+
+    // The application may have canceled the view from the callback
+    if (IsViewInProgress())
+    {
+        ScheduleWork();
+    }
+}
+
+WEAVE_ERROR MultiViewClient::HandleDataElementForRequest(void * const apAppState, DataElement::Parser & aDataElement)
+{
+    Request * const pRequest        = reinterpret_cast<Request *>(apAppState);
+    MultiViewClient * const pClient = pRequest->mpOwner;
+
+    return pClient->mHandleDataElement(pClient->mAppState, aDataElement);
+}
+
+void MultiViewClient::ViewClientEventCallback(void * const apAppState, ViewClient::EventID aEvent, WEAVE_ERROR aErrorCode,
+                                              ViewClient::EventParam & aEventParam)
+{
+    Request * const pRequest        = reinterpret_cast<Request *>(apAppState);
+    MultiViewClient * const pClient = pRequest->mpOwner;
+
+    VerifyOrExit(kRequestState_InFlight == pRequest->mState, );
+
+    switch (aEvent)
+    {
+    case ViewClient::kEvent_ViewResponseReceived:
+        pClient->RecordLatency(*pRequest);
+        break;
+
+    case ViewClient::kEvent_ViewResponseConsumed:
+        pClient->OnRequestDone(*pRequest, kEvent_ViewResponseConsumed, WEAVE_NO_ERROR, NULL);
+        break;
+
+    case ViewClient::kEvent_StatusReportReceived:
+        pClient->RecordLatency(*pRequest);
+        pClient->OnRequestDone(*pRequest, kEvent_RequestFailed, aErrorCode,
+                               aEventParam.mStatusReportReceivedEventParam.mMessage);
+        break;
+
+    case ViewClient::kEvent_RequestFailed:
+        pClient->OnRequestDone(*pRequest, kEvent_RequestFailed, aErrorCode, NULL);
+        break;
+
+    default:
+        break;
+    }
+
+exit:
+    return;
+}
+
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
 }; // namespace Weave
@@ -110,7 +110,7 @@ public:
 
     typedef void (*EventCallback)(void * const aAppState, EventID aEvent, WEAVE_ERROR aErrorCode, EventParam & aEventParam);
 
-    // Do nothing
+    // Start out canceled
     ViewClient(void);
 
     // AddRef to Binding
@@ -126,6 +126,11 @@ public:
 
     WEAVE_ERROR SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog, const TraitPath aPathList[], const size_t aPathListSize);
 
+    // acquire a right-sized buffer from binding, encode as many paths of the list as fit, kick off send message
+    // data elements in the response are passed to aHandleDataElement, or stored in the sinks of the catalog if it is NULL
+    WEAVE_ERROR SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog, const TraitPath aPathList[], const size_t aPathListSize,
+                            HandleDataElement const aHandleDataElement, size_t & aNumPathsConsumed);
+
     // InternalCancel(false)
     WEAVE_ERROR Cancel(void);
 
@@ -160,6 +165,10 @@ protected:
 
     static void DataSinkOperation_NoMoreData(void * const apOpState, TraitDataSink * const apDataSink);
 
+    static WEAVE_ERROR EncodeRequest(nl::Weave::TLV::TLVWriter & aWriter, TraitCatalogBase<TraitDataSink> * apCatalog,
+                                     const TraitPath aPathList[], const size_t aPathListSize, const uint32_t aMaxPayloadSize,
+                                     size_t & aNumPathsConsumed);
+
     static void OnSendError(ExchangeContext * aEC, WEAVE_ERROR aErrorCode, void * aMsgSpecificContext);
     static void OnResponseTimeout(nl::Weave::ExchangeContext * aEC);
     static void OnMessageReceived(nl::Weave::ExchangeContext * aEC, const nl::Inet::IPPacketInfo * aPktInfo,
@@ -167,6 +176,125 @@ protected:
                                   PacketBuffer * aPayload);
 };
 
+/**
+ * A view client that spreads the paths of a view over as many ViewRequests as
+ * needed to fit the payload of the binding, and keeps up to
+ * #WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS of them in flight on the same binding.
+ *
+ * Data elements are handed to the application as each response arrives, in the
+ * order the responses arrive; a failed request does not stop the others.
+ */
+class MultiViewClient
+{
+public:
+    enum EventID
+    {
+        // One of the requests failed; the paths it carried have not been retrieved
+        // Check error code; WEAVE_ERROR_STATUS_REPORT_RECEIVED if the publisher responded with a Status Report
+        kEvent_RequestFailed = 1,
+
+        // The response to one of the requests has been consumed
+        kEvent_ViewResponseConsumed = 2,
+
+        // All requests of the view have completed, the client can send another view
+        // Error code is that of the last request that failed, if any
+        kEvent_ViewComplete = 3,
+    };
+
+    struct EventParam
+    {
+        // Paths carried by the request, NULL for kEvent_ViewComplete
+        const TraitPath * mPathList;
+        size_t mPathListSize;
+
+        // Status Report received in response to the request, if any
+        // Do not modify the message content
+        PacketBuffer * mStatusReport;
+    };
+
+    struct Statistics
+    {
+        uint32_t mNumRequestsSent;
+        uint32_t mNumRequestsFailed;
+        uint32_t mNumResponsesReceived;
+
+        // Time between sending a request and receiving its response, including Status Reports
+        uint32_t mMinLatencyMsec;
+        uint32_t mMaxLatencyMsec;
+        uint64_t mTotalLatencyMsec;
+    };
+
+    typedef void (*EventCallback)(void * const aAppState, EventID aEvent, WEAVE_ERROR aErrorCode, EventParam & aEventParam);
+
+    MultiViewClient(void);
+
+    // AddRef to Binding
+    // store pointers to binding and app state
+    WEAVE_ERROR Init(Binding * const apBinding, void * const apAppState, EventCallback const aEventCallback);
+
+    // Path list must stay valid until kEvent_ViewComplete, the next view can be sent from that event
+    // aHandleDataElement is called for every data element received, the sinks of the catalog are used if it is NULL
+    // Only errors in the arguments or the state are returned; once the view has started, failures are reported with
+    // kEvent_RequestFailed and the view ends with kEvent_ViewComplete
+    WEAVE_ERROR SendRequest(TraitCatalogBase<TraitDataSink> * apCatalog, const TraitPath aPathList[], const size_t aPathListSize,
+                            ViewClient::HandleDataElement const aHandleDataElement = NULL);
+
+    // cancel all requests in flight and release binding
+    WEAVE_ERROR Cancel(void);
+
+    bool IsViewInProgress(void) const { return NULL != mPathList; }
+
+    const Statistics & GetStatistics(void) const { return mStatistics; }
+    void ResetStatistics(void);
+
+private:
+    enum RequestState
+    {
+        kRequestState_Free     = 0,
+        kRequestState_InFlight = 1,
+
+        // Completed, but the ViewClient is not reusable until its callback has returned
+        kRequestState_Done = 2,
+    };
+
+    struct Request
+    {
+        MultiViewClient * mpOwner;
+        ViewClient mViewClient;
+        size_t mFirstPath;
+        size_t mNumPaths;
+        uint64_t mSendTimeMsec;
+        RequestState mState;
+    };
+
+    Binding * mBinding;
+    void * mAppState;
+    EventCallback mEventCallback;
+    ViewClient::HandleDataElement mHandleDataElement;
+    TraitCatalogBase<TraitDataSink> * mDataSinkCatalog;
+
+    const TraitPath * mPathList;
+    size_t mPathListSize;
+    size_t mNextPath;
+    WEAVE_ERROR mViewError;
+    bool mIsWorkScheduled;
+
+    Request mRequests[WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS];
+    Statistics mStatistics;
+
+    void SendPendingRequests(void);
+    void FailUnsentPaths(WEAVE_ERROR aErrorCode);
+    void CancelRequests(void);
+    void ScheduleWork(void);
+    void RecordLatency(Request & aRequest);
+    void OnRequestDone(Request & aRequest, EventID aEvent, WEAVE_ERROR aErrorCode, PacketBuffer * aStatusReport);
+
+    static void OnWork(System::Layer * aSystemLayer, void * aAppState, System::Error aError);
+    static WEAVE_ERROR HandleDataElementForRequest(void * const apAppState, DataElement::Parser & aDataElement);
+    static void ViewClientEventCallback(void * const apAppState, ViewClient::EventID aEvent, WEAVE_ERROR aErrorCode,
+                                        ViewClient::EventParam & aEventParam);
+};
+
 }; // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }; // namespace Profiles
 }; // namespace Weave
@@ -262,6 +262,8 @@ WeaveServiceManager::WeaveServiceManager()
     mExchangeContext = NULL;
     mServiceEndpointQueryBegin = NULL;
     mServiceEndpointQueryEndWithTimeInfo = NULL;
+    mDeferredResponse = NULL;
+    mResolvedTimeMS = 0;
 
     freeConnectRequests();
 
@@ -274,13 +276,13 @@ WeaveServiceManager::WeaveServiceManager()
  */
 WeaveServiceManager::~WeaveServiceManager()
 {
+    reset();
+
     mExchangeManager = NULL;
     mCache.base = NULL;
     mCache.length = 0;
     mServiceEndpointQueryBegin = NULL;
     mServiceEndpointQueryEndWithTimeInfo = NULL;
-
-    reset();
 }
 
 /**
@@ -434,6 +436,8 @@ WEAVE_ERROR WeaveServiceManager::connect(uint64_t aServiceEp,
         mDirectory.base = mCache.base;
         mDirectory.length = 1;
 
+        buildIndex();
+
         mCacheState = kServiceMgrState_Resolving;
     }
 
@@ -487,6 +491,12 @@ WEAVE_ERROR WeaveServiceManager::connect(uint64_t aServiceEp,
      * else until the response comes back or it's "resolved"
      * in which case we're good to go. in either case, we
      * queue up a connect request.
+     *
+     * a resolved directory stays usable while it is being
+     * refreshed in the background. the only time a request
+     * waits on a resolved directory is when a refreshed one
+     * has arrived and is only held back until connections
+     * still using the old one are done with it.
      */
 
     req = getAvailableRequest();
@@ -507,6 +517,11 @@ WEAVE_ERROR WeaveServiceManager::connect(uint64_t aServiceEp,
         WeaveLogProgress(ServiceDirectory, "waiting");
     }
 
+    else if (mCacheState == kServiceMgrState_Resolved && mDeferredResponse != NULL)
+    {
+        WeaveLogProgress(ServiceDirectory, "awaiting refreshed directory");
+    }
+
     else if (mCacheState == kServiceMgrState_Resolved)
     {
         WeaveLogProgress(ServiceDirectory, "resolved");
@@ -610,6 +625,9 @@ exit:
  * directory, implementations should strongly favor using the variant of this
  * method that generates the HostPortList.
  *
+ * Entries are found through an index built when the directory is cached, so
+ * the cost of a lookup does not grow with the size of the directory.
+ *
  * @param [in] aServiceEp       The identifier of the service endpoint to
  *   look up.
  *
@@ -641,6 +659,24 @@ WEAVE_ERROR WeaveServiceManager::lookup(uint64_t aServiceEp, uint8_t *aControlBy
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_ServiceManager_Lookup,
                        memset(&aServiceEp, 0x0F, sizeof(aServiceEp)));
 
+    if (mIndexValid)
+    {
+        IndexEntry *slot = findIndexSlot(aServiceEp);
+
+        if (slot->serviceEp == aServiceEp)
+        {
+            WeaveLogProgress(ServiceDirectory, "found [%x,%llx]", slot->ctrlByte, aServiceEp);
+
+            *aControlByte = slot->ctrlByte;
+            *aDirectoryEntry = mDirectory.base + slot->offset;
+
+            found = true;
+            err = WEAVE_NO_ERROR;
+        }
+
+        ExitNow();
+    }
+
     for (uint8_t i = 0; i < mDirectory.length; i++)
     {
         uint8_t  entryCtrlByte = Read8(p);
@@ -670,12 +706,12 @@ WEAVE_ERROR WeaveServiceManager::lookup(uint64_t aServiceEp, uint8_t *aControlBy
         p += entryLen;
     }
 
-    if (!found)
+exit:
+    if (!found && err == WEAVE_NO_ERROR)
     {
         err = WEAVE_ERROR_INVALID_SERVICE_EP;
     }
 
-exit:
     WeaveLogProgress(ServiceDirectory, "lookup() => %s", ErrorStr(err));
 
     return err;
@@ -803,6 +839,10 @@ WEAVE_ERROR WeaveServiceManager::replaceOrAddCacheEntry(uint16_t port,
 
     mDirAndSuffTableSize += overrideEntryTotalLen;
 
+    // Entries after the new one have moved, so index them afresh.
+
+    buildIndex();
+
 exit:
     WeaveLogProgress(ServiceDirectory, "%s : %s", __func__, nl::ErrorStr(err));
 
@@ -840,7 +880,7 @@ void WeaveServiceManager::cancel(uint64_t aServiceEp, void *aAppState)
             activeRequests++;
     }
 
-    if (activeRequests == 0)
+    if (activeRequests == 0 && !mRefreshing)
     {
         /*
          * in principle we could be in one of two states here -
@@ -860,6 +900,8 @@ void WeaveServiceManager::cancel(uint64_t aServiceEp, void *aAppState)
 
         cleanupExchangeContext(WEAVE_ERROR_CONNECTION_CLOSED_UNEXPECTEDLY);
     }
+
+    applyDeferredResponse();
 }
 
 /**
@@ -905,6 +947,11 @@ void WeaveServiceManager::unresolve(void)
     {
         cleanupExchangeContext();
 
+        cancelCacheTimer();
+        mRefreshing = false;
+        PacketBuffer::Free(mDeferredResponse);
+        mDeferredResponse = NULL;
+
         mCacheState = kServiceMgrState_Resolving;
 
         finalizeConnectRequests();
@@ -1084,6 +1131,10 @@ void WeaveServiceManager::onConnectionClosed(WEAVE_ERROR aError)
  *    This method handles any response message in the conversation with
  *    directory service.
  *
+ *  A directory response that arrives while connections made from the
+ *  current directory are still being established is held back until
+ *  they complete, since their host/port lists point into the cache.
+ *
  *  @param [in] aProfileId   The profile ID for this incoming message.
  *  @param [in] aMsgType     The profile-specific type for this message.
  *  @param [in] aMsg         The content of this message.
@@ -1092,7 +1143,6 @@ void WeaveServiceManager::onResponseReceived(uint32_t aProfileId, uint8_t aMsgTy
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     StatusReport report;
-    bool redir = false;
 
     WeaveLogProgress(ServiceDirectory, "onResponseReceived(0x%x, %d)", aProfileId, aMsgType);
 
@@ -1112,11 +1162,24 @@ void WeaveServiceManager::onResponseReceived(uint32_t aProfileId, uint8_t aMsgTy
 
         WeaveLogProgress(ServiceDirectory, "status: %lx, %x", report.mProfileId, report.mStatusCode);
 
-        clearWorkingState();
+        if (mRefreshing)
+        {
+            /*
+             * a failed background refresh leaves the resolved
+             * directory and the requests using it alone.
+             */
 
-        mCacheState = kServiceMgrState_Initial;
+            refreshFailed(WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+        }
+
+        else
+        {
+            clearWorkingState();
+
+            mCacheState = kServiceMgrState_Initial;
 
-        transactionsReportStatus(report);
+            transactionsReportStatus(report);
+        }
     }
 
     else
@@ -1131,165 +1194,226 @@ void WeaveServiceManager::onResponseReceived(uint32_t aProfileId, uint8_t aMsgTy
          */
 
         VerifyOrExit(aMsgType == kMsgType_ServiceEndpointResponse, err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
-        VerifyOrExit(mCacheState == kServiceMgrState_Waiting, err = WEAVE_ERROR_INCORRECT_STATE);
-
-        /*
-         * this block unpacks the service directory message.
-         */
+        VerifyOrExit(mCacheState == kServiceMgrState_Waiting || (mCacheState == kServiceMgrState_Resolved && mRefreshing),
+                     err = WEAVE_ERROR_INCORRECT_STATE);
 
+        if (hasConnectsInProgress())
         {
-            MessageIterator i(aMsg);
+            WeaveLogProgress(ServiceDirectory, "onResponseReceived(): deferred");
 
-            uint16_t msgLen = aMsg->DataLength();
-            uint8_t dirCtrl;
-            uint8_t *writePtr;
-            uint8_t dirLen;
-            bool suffixesPresent;
-            uint8_t aLength;
-            bool timePresent = false;
+            mDeferredResponse = aMsg;
+            aMsg = NULL;
 
-            err = i.readByte(&dirCtrl);
-            SuccessOrExit(err);
+            ExitNow();
+        }
 
-            dirLen = dirCtrl & kMask_DirectoryLen;
-            redir = (dirCtrl & kMask_Redirect) != 0;
-            suffixesPresent = (dirCtrl & kMask_SuffixTablePresent) != 0;
-            timePresent = (dirCtrl & kMask_TimeFieldsPresent) != 0;
+        err = processDirectoryResponse(aMsg, true);
+        aMsg = NULL;
+        SuccessOrExit(err);
+    }
 
-            if (((msgLen > mCache.length) && !timePresent) || (msgLen > (mCache.length + (sizeof(uint64_t) + sizeof(uint32_t)))))
-            {
-                WeaveLogProgress(ServiceDirectory, "message length error: %d m.len:%d", msgLen, mCache.length);
+exit:
 
-                err = WEAVE_ERROR_MESSAGE_TOO_LONG;
-            }
-            SuccessOrExit(err);
+    // Free the received message buffer if it hasn't been done already.
 
-            /*
-             * here we have directory information beyond the root directory but
-             * we're not done yet.
-             */
+    PacketBuffer::Free(aMsg);
 
-            mDirectory.length = dirLen;
-            writePtr = mDirectory.base = mCache.base;
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogProgress(ServiceDirectory, "onResponseReceived: %s", ErrorStr(err));
 
-            err = cacheDirectory(i, mDirectory.length, writePtr);
-            SuccessOrExit(err);
+        fail(err);
+    }
+}
 
-            if (suffixesPresent)
-            {
-                WeaveLogProgress(ServiceDirectory, "suffixesPresent");
+/**
+ *  @brief
+ *    This method unpacks a service endpoint response into the cache and
+ *    then either follows a redirect or connects the pending requests.
+ *
+ *  Writing the cache ends any background refresh, so a failure from here
+ *  on invalidates the cache like a failed query would.
+ *
+ *  @param [in] aMsg              The response, which this method frees.
+ *  @param [in] aDeliverTimeInfo  Whether to pass the time fields of the
+ *    response to the application. This is false for a response that was
+ *    held back, whose time fields no longer reflect its flight time.
+ *
+ *  @return #WEAVE_NO_ERROR on success; otherwise, a respective error code.
+ */
+WEAVE_ERROR WeaveServiceManager::processDirectoryResponse(PacketBuffer *aMsg, bool aDeliverTimeInfo)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool redir = false;
 
-                err = i.readByte(&aLength);
-                SuccessOrExit(err);
+    mRefreshing = false;
+    mCacheState = kServiceMgrState_Waiting;
+    mDirAndSuffTableSize = 0;
 
-                mSuffixTable.length = aLength;
-                writePtr += 1;
-                mSuffixTable.base = writePtr;
+    clearIndex();
 
-                mDirAndSuffTableSize++;
+    /*
+     * this block unpacks the service directory message.
+     */
 
-                err = cacheSuffixes(i, mSuffixTable.length, writePtr);
-                SuccessOrExit(err);
-            }
+    {
+        MessageIterator i(aMsg);
 
-            else
-            {
-                mSuffixTable.length = 0;
-                mSuffixTable.base = NULL;
-            }
+        uint16_t msgLen = aMsg->DataLength();
+        uint8_t dirCtrl;
+        uint8_t *writePtr;
+        uint8_t dirLen;
+        bool suffixesPresent;
+        uint8_t aLength;
+        bool timePresent = false;
 
-            if (timePresent)
-            {
-                WeaveLogProgress(ServiceDirectory, "timePresent");
+        err = i.readByte(&dirCtrl);
+        SuccessOrExit(err);
 
-                err = handleTimeInfo(i);
-                SuccessOrExit(err);
-            }
+        dirLen = dirCtrl & kMask_DirectoryLen;
+        redir = (dirCtrl & kMask_Redirect) != 0;
+        suffixesPresent = (dirCtrl & kMask_SuffixTablePresent) != 0;
+        timePresent = (dirCtrl & kMask_TimeFieldsPresent) != 0;
+
+        if (((msgLen > mCache.length) && !timePresent) || (msgLen > (mCache.length + (sizeof(uint64_t) + sizeof(uint32_t)))))
+        {
+            WeaveLogProgress(ServiceDirectory, "message length error: %d m.len:%d", msgLen, mCache.length);
+
+            err = WEAVE_ERROR_MESSAGE_TOO_LONG;
         }
+        SuccessOrExit(err);
 
         /*
-         * Release the received message buffer so that any code we
-         * call below can immediately re-use it.
+         * here we have directory information beyond the root directory but
+         * we're not done yet.
          */
 
-        PacketBuffer::Free(aMsg);
-        aMsg = NULL;
+        mDirectory.length = dirLen;
+        writePtr = mDirectory.base = mCache.base;
 
-        if (redir)
+        err = cacheDirectory(i, mDirectory.length, writePtr);
+        SuccessOrExit(err);
+
+        if (suffixesPresent)
         {
-            // send out yet another query using this directory server.
+            WeaveLogProgress(ServiceDirectory, "suffixesPresent");
 
-            mConnection = mExchangeManager->MessageLayer->NewConnection();
-            VerifyOrExit(mConnection, err = WEAVE_ERROR_NO_MEMORY);
+            err = i.readByte(&aLength);
+            SuccessOrExit(err);
 
-            WeaveLogProgress(ServiceDirectory, "onResponseReceived(): redirecting");
+            mSuffixTable.length = aLength;
+            writePtr += 1;
+            mSuffixTable.base = writePtr;
 
-            err = lookupAndConnect(mConnection,
-                                   kServiceEndpoint_Directory,
-                                   mDirAuthMode,
-                                   this,
-                                   handleSDConnectionComplete,
-                                   WEAVE_CONFIG_SERVICE_DIR_CONNECT_TIMEOUT_MSECS);
+            mDirAndSuffTableSize++;
+
+            err = cacheSuffixes(i, mSuffixTable.length, writePtr);
+            SuccessOrExit(err);
         }
 
         else
         {
-            mCacheState = kServiceMgrState_Resolved;
+            mSuffixTable.length = 0;
+            mSuffixTable.base = NULL;
+        }
 
-            WeaveLogProgress(ServiceDirectory, "onResponseReceived(): ->resolved");
+        if (timePresent && aDeliverTimeInfo)
+        {
+            WeaveLogProgress(ServiceDirectory, "timePresent");
 
-            // now we gotta process all the pending transactions (see below)
+            err = handleTimeInfo(i);
+            SuccessOrExit(err);
+        }
+    }
 
-            for (uint8_t j = 0; j < ARRAY_SIZE(mConnectRequestPool); j++)
-            {
+    /*
+     * Release the received message buffer so that any code we
+     * call below can immediately re-use it.
+     */
 
-                /*
-                 * go through all the transactions here even if some
-                 * of them err out and invoke a handler. this leaves
-                 * openthe possiblity that hihger layer code can
-                 * handle indiviual failures individually.
-                 */
+    PacketBuffer::Free(aMsg);
+    aMsg = NULL;
 
-                WEAVE_ERROR conErr;
-                ConnectRequest *req = &mConnectRequestPool[j];
-                StatusHandler handler = req->mStatusHandler;
-                void *appState = req->mAppState;
+    buildIndex();
 
-                if (req->mServiceEp != 0)
-                {
-                    WeaveLogProgress(ServiceDirectory, "onResponseReceived() txn = %llx", req->mServiceEp);
-
-                    conErr = lookupAndConnect(req->mConnection,
-                                              req->mServiceEp,
-                                              req->mAuthMode,
-                                              req,
-                                              handleAppConnectionComplete,
-                                              req->mConnectTimeoutMsecs,
-                                              req->mConnIntf);
-
-                    if (conErr != WEAVE_NO_ERROR)
-                    {
-                        req->finalize();
-
-                        if (handler)
-                            handler(appState, conErr, NULL);
-                    }
-                }
-            }
-        }
+    if (redir)
+    {
+        // send out yet another query using this directory server.
+
+        mConnection = mExchangeManager->MessageLayer->NewConnection();
+        VerifyOrExit(mConnection, err = WEAVE_ERROR_NO_MEMORY);
+
+        WeaveLogProgress(ServiceDirectory, "onResponseReceived(): redirecting");
+
+        err = lookupAndConnect(mConnection,
+                               kServiceEndpoint_Directory,
+                               mDirAuthMode,
+                               this,
+                               handleSDConnectionComplete,
+                               WEAVE_CONFIG_SERVICE_DIR_CONNECT_TIMEOUT_MSECS);
     }
 
-exit:
+    else
+    {
+        mCacheState = kServiceMgrState_Resolved;
+        mResolvedTimeMS = System::Layer::GetClock_MonotonicMS();
 
-    // Free the received message buffer if it hasn't been done already.
+        WeaveLogProgress(ServiceDirectory, "onResponseReceived(): ->resolved");
+
+        armCacheTimer();
+
+        connectPendingRequests();
+    }
+
+exit:
 
     PacketBuffer::Free(aMsg);
 
-    if (err != WEAVE_NO_ERROR)
+    return err;
+}
+
+/**
+ *  @brief
+ *    This method starts the connections of all queued connect requests
+ *    against the newly resolved directory.
+ */
+void WeaveServiceManager::connectPendingRequests(void)
+{
+    for (uint8_t j = 0; j < ARRAY_SIZE(mConnectRequestPool); j++)
     {
-        WeaveLogProgress(ServiceDirectory, "onResponseReceived: %s", ErrorStr(err));
 
-        fail(err);
+        /*
+         * go through all the transactions here even if some
+         * of them err out and invoke a handler. this leaves
+         * openthe possiblity that hihger layer code can
+         * handle indiviual failures individually.
+         */
+
+        WEAVE_ERROR conErr;
+        ConnectRequest *req = &mConnectRequestPool[j];
+        StatusHandler handler = req->mStatusHandler;
+        void *appState = req->mAppState;
+
+        if (req->mServiceEp != 0)
+        {
+            WeaveLogProgress(ServiceDirectory, "onResponseReceived() txn = %llx", req->mServiceEp);
+
+            conErr = lookupAndConnect(req->mConnection,
+                                      req->mServiceEp,
+                                      req->mAuthMode,
+                                      req,
+                                      handleAppConnectionComplete,
+                                      req->mConnectTimeoutMsecs,
+                                      req->mConnIntf);
+
+            if (conErr != WEAVE_NO_ERROR)
+            {
+                req->finalize();
+
+                if (handler)
+                    handler(appState, conErr, NULL);
+            }
+        }
     }
 }
 
@@ -1344,6 +1468,7 @@ WEAVE_ERROR WeaveServiceManager::ConnectRequest::init(WeaveServiceManager *aMana
     mServiceEp = aServiceEp;
     mAuthMode = aAuthMode;
     mAppState = aAppState;
+    mManager = aManager;
     mStatusHandler = aStatusHandler;
     mConnectionCompleteHandler = aCompleteHandler;
     mConnectTimeoutMsecs = aConnectTimeoutMsecs;
@@ -1382,18 +1507,22 @@ void WeaveServiceManager::ConnectRequest::finalize(void)
 
 /**
  *  This method is a trampoline to application layer for the connection complete event. It calls the
- *  connection complete handler assigned at lookupAndConnect() .
+ *  connection complete handler assigned at lookupAndConnect() , then lets the service manager apply
+ *  any directory response that was held back for this connection.
  */
 void WeaveServiceManager::ConnectRequest::onConnectionComplete(WEAVE_ERROR aError)
 {
     WeaveConnection *con = mConnection;
     WeaveConnection::ConnectionCompleteFunct handler = mConnectionCompleteHandler;
+    WeaveServiceManager *manager = mManager;
 
     con->AppState = mAppState;
 
     free();
 
     handler(con, aError);
+
+    manager->applyDeferredResponse();
 }
 
 /**
@@ -1752,18 +1881,29 @@ WEAVE_ERROR WeaveServiceManager::cacheSuffixes(MessageIterator &aIterator, uint8
  *    manager's working state, calling all the appropriate handler methods and
  *    freeing any pending transactions.
  *
+ *  A failed background refresh only ends the refresh; the resolved
+ *  directory stays in use until it expires.
+ *
  *  @param[in] anError An error code indicating the cause of failure.
  */
 void WeaveServiceManager::fail(WEAVE_ERROR aError)
 {
     WeaveLogProgress(ServiceDirectory, "fail() <= %s", ErrorStr(aError));
 
-    cleanupExchangeContext(aError);
+    if (mRefreshing)
+    {
+        refreshFailed(aError);
+    }
 
-    clearWorkingState();
-    clearCacheState();
+    else
+    {
+        cleanupExchangeContext(aError);
 
-    transactionsErrorOut(aError);
+        clearWorkingState();
+        clearCacheState();
+
+        transactionsErrorOut(aError);
+    }
 }
 
 /**
@@ -1873,6 +2013,13 @@ void WeaveServiceManager::clearWorkingState(void)
     mSuffixTable.length = 0;
     mSuffixTable.base = NULL;
     mDirAndSuffTableSize = 0;
+
+    clearIndex();
+
+    cancelCacheTimer();
+    mRefreshing = false;
+    PacketBuffer::Free(mDeferredResponse);
+    mDeferredResponse = NULL;
 }
 
 /**
@@ -1908,6 +2055,296 @@ exit:
     return err;
 }
 
+/**
+ *  @brief
+ *    This method returns the index slot that holds the given service
+ *    endpoint, or the empty slot where it would be inserted.
+ *
+ *  The index is never more than half full, so the probe always ends.
+ */
+WeaveServiceManager::IndexEntry *WeaveServiceManager::findIndexSlot(uint64_t aServiceEp)
+{
+    uint32_t hash = static_cast<uint32_t>(aServiceEp ^ (aServiceEp >> 32)) * 0x9E3779B1U;
+    uint8_t mask = ARRAY_SIZE(mIndex) - 1;
+    uint8_t i = (hash >> 24) & mask;
+
+    while (mIndex[i].serviceEp != 0 && mIndex[i].serviceEp != aServiceEp)
+    {
+        i = (i + 1) & mask;
+    }
+
+    return &mIndex[i];
+}
+
+/**
+ *  @brief
+ *    This method indexes every entry of the working directory by its
+ *    service endpoint so that lookup() does not have to walk the cache.
+ *
+ *  Only the first entry for an endpoint is indexed, matching what a walk
+ *  of the directory would find. If the directory does not fit in the
+ *  index, or cannot be walked, the index is left invalid and lookup()
+ *  walks the directory instead.
+ */
+void WeaveServiceManager::buildIndex(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint8_t *p = mDirectory.base;
+    uint16_t entryLen;
+
+    clearIndex();
+
+    VerifyOrExit(mDirectory.length <= ARRAY_SIZE(mIndex) / 2, err = WEAVE_ERROR_NO_MEMORY);
+
+    for (size_t i = 0; i < mDirectory.length; i++)
+    {
+        uint8_t  entryCtrlByte = Read8(p);
+        uint64_t svcEp = Read64(p);
+        IndexEntry *slot;
+
+        VerifyOrExit(svcEp != 0, err = WEAVE_ERROR_INVALID_SERVICE_EP);
+
+        slot = findIndexSlot(svcEp);
+
+        if (slot->serviceEp == 0)
+        {
+            slot->serviceEp = svcEp;
+            slot->offset = static_cast<uint16_t>(p - mDirectory.base);
+            slot->ctrlByte = entryCtrlByte;
+        }
+
+        err = calculateEntryLength(p, entryCtrlByte, &entryLen);
+        SuccessOrExit(err);
+
+        p += entryLen;
+    }
+
+    mIndexValid = true;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogProgress(ServiceDirectory, "buildIndex: %s", ErrorStr(err));
+
+        clearIndex();
+    }
+}
+
+/**
+ *  @brief
+ *    This method empties the directory index.
+ */
+void WeaveServiceManager::clearIndex(void)
+{
+    memset(mIndex, 0, sizeof(mIndex));
+    mIndexValid = false;
+}
+
+/**
+ *  @brief
+ *    This method arms the timer that refreshes the resolved directory
+ *    ahead of its expiry, or expires it once the refresh time has passed.
+ */
+void WeaveServiceManager::armCacheTimer(void)
+{
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+    uint64_t now = System::Layer::GetClock_MonotonicMS();
+    uint64_t refreshTime = mResolvedTimeMS +
+        (WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS - WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS) * 1000ULL;
+    uint64_t expiryTime = mResolvedTimeMS + WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS * 1000ULL;
+    uint64_t fireTime = (now < refreshTime) ? refreshTime : expiryTime;
+    System::Error err;
+
+    err = mExchangeManager->MessageLayer->SystemLayer->StartTimer(static_cast<uint32_t>(fireTime > now ? fireTime - now : 0),
+                                                                  handleCacheTimer, this);
+    if (err != WEAVE_SYSTEM_NO_ERROR)
+    {
+        WeaveLogError(ServiceDirectory, "armCacheTimer: %s", ErrorStr(err));
+    }
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+}
+
+/**
+ *  @brief
+ *    This method cancels the refresh and expiry timer, if armed.
+ */
+void WeaveServiceManager::cancelCacheTimer(void)
+{
+    if (mExchangeManager != NULL && mExchangeManager->MessageLayer != NULL)
+    {
+        mExchangeManager->MessageLayer->SystemLayer->CancelTimer(handleCacheTimer, this);
+    }
+}
+
+/**
+ *  @brief
+ *    This method is a trampoline which calls the actual handler
+ *    WeaveServiceManager::onCacheTimer() .
+ */
+void WeaveServiceManager::handleCacheTimer(System::Layer *aSystemLayer, void *aAppState, System::Error aError)
+{
+    WeaveServiceManager *manager = static_cast<WeaveServiceManager *>(aAppState);
+
+    manager->onCacheTimer();
+}
+
+/**
+ *  @brief
+ *    This method starts a background refresh of the resolved directory
+ *    when it is about to expire, and expires it once it has.
+ *
+ *  An expired directory is only abandoned once no refresh is in flight,
+ *  so that connect requests keep being served from it until the refresh
+ *  either succeeds or fails.
+ */
+void WeaveServiceManager::onCacheTimer(void)
+{
+    VerifyOrExit(mCacheState == kServiceMgrState_Resolved, );
+
+    if (isCacheExpired())
+    {
+        if (!mRefreshing && mDeferredResponse == NULL)
+        {
+            WeaveLogProgress(ServiceDirectory, "onCacheTimer(): expired");
+
+            mCacheState = kServiceMgrState_Resolving;
+        }
+
+        ExitNow();
+    }
+
+    if (!mRefreshing && mDeferredResponse == NULL)
+    {
+        startRefresh();
+    }
+
+    armCacheTimer();
+
+exit:
+    return;
+}
+
+/**
+ *  @brief
+ *    This method tests if the resolved directory has outlived its TTL.
+ *
+ *  @return true if the directory has expired, false otherwise.
+ */
+bool WeaveServiceManager::isCacheExpired(void)
+{
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+    return (System::Layer::GetClock_MonotonicMS() - mResolvedTimeMS) >= WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS * 1000ULL;
+#else
+    return false;
+#endif
+}
+
+/**
+ *  @brief
+ *    This method sends a directory query while the resolved directory
+ *    stays in use for connect requests.
+ */
+void WeaveServiceManager::startRefresh(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    WeaveLogProgress(ServiceDirectory, "startRefresh()");
+
+    mConnection = mExchangeManager->MessageLayer->NewConnection();
+    VerifyOrExit(mConnection, err = WEAVE_ERROR_NO_MEMORY);
+
+    mRefreshing = true;
+
+    err = lookupAndConnect(mConnection,
+                           kServiceEndpoint_Directory,
+                           mDirAuthMode,
+                           this,
+                           handleSDConnectionComplete,
+                           WEAVE_CONFIG_SERVICE_DIR_CONNECT_TIMEOUT_MSECS);
+
+exit:
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogProgress(ServiceDirectory, "startRefresh: %s", ErrorStr(err));
+
+        /*
+         * lookupAndConnect() may already have ended the refresh by
+         * invoking the connection complete handler synchronously.
+         */
+
+        if (mRefreshing)
+            refreshFailed(err);
+    }
+}
+
+/**
+ *  @brief
+ *    This method ends a failed background refresh, leaving the resolved
+ *    directory in use unless it has already expired.
+ *
+ *  @param[in] aError An error code indicating the cause of failure.
+ */
+void WeaveServiceManager::refreshFailed(WEAVE_ERROR aError)
+{
+    WeaveLogProgress(ServiceDirectory, "refreshFailed() <= %s", ErrorStr(aError));
+
+    cleanupExchangeContext(aError);
+
+    mRefreshing = false;
+
+    if (isCacheExpired())
+    {
+        mCacheState = kServiceMgrState_Resolving;
+    }
+}
+
+/**
+ *  @brief
+ *    This method tests if any connect request is still establishing a
+ *    connection to host/port list entries in the cache.
+ *
+ *  @return true if such a connect request exists, false otherwise.
+ */
+bool WeaveServiceManager::hasConnectsInProgress(void)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(mConnectRequestPool); i++)
+    {
+        ConnectRequest &r = mConnectRequestPool[i];
+
+        if (!r.isFree() && r.mConnection != NULL && r.mConnection->State != WeaveConnection::kState_ReadyToConnect)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ *  @brief
+ *    This method applies a held-back directory response once no connect
+ *    request uses the cache any more.
+ */
+void WeaveServiceManager::applyDeferredResponse(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *msg = mDeferredResponse;
+
+    VerifyOrExit(msg != NULL && !hasConnectsInProgress(), );
+
+    WeaveLogProgress(ServiceDirectory, "applyDeferredResponse()");
+
+    mDeferredResponse = NULL;
+
+    err = processDirectoryResponse(msg, false);
+
+exit:
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        fail(err);
+    }
+}
+
 /**
  *  @brief
  *    This method clears the state and cache of the manager if the state is in
@@ -1920,6 +2357,9 @@ void WeaveServiceManager::clearCache(void)
 
     if (mCacheState == kServiceMgrState_Resolved)
     {
+        if (mRefreshing)
+            cleanupExchangeContext();
+
         clearWorkingState();
         clearCacheState();
     }
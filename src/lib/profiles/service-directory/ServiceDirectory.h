@@ -158,6 +158,8 @@ enum
  */
 class NL_DLL_EXPORT WeaveServiceManager
 {
+    friend class TestServiceDirectory;
+
 public:
 
     /**
@@ -374,6 +376,9 @@ public:
         WeaveAuthMode   mAuthMode;
         void            *mAppState;
 
+        /// The service manager this request was made to.
+        WeaveServiceManager *mManager;
+
         /// A connection to stash here while it's awaiting completion.
         WeaveConnection *mConnection;
 
@@ -397,6 +402,17 @@ private:
         size_t  length;
     };
 
+    /**
+     *  A slot of the hash index over the working directory. An empty slot
+     *  has a service endpoint of zero, which is never a valid endpoint.
+     */
+    struct IndexEntry
+    {
+        uint64_t serviceEp;
+        uint16_t offset;                                  ///< offset of the entry body from the directory base
+        uint8_t  ctrlByte;
+    };
+
     void freeConnectRequests(void);
     void finalizeConnectRequests(void);
     ConnectRequest *getAvailableRequest(void);
@@ -412,6 +428,23 @@ private:
     WEAVE_ERROR cacheDirectory(MessageIterator &, uint8_t, uint8_t *&);
     WEAVE_ERROR cacheSuffixes(MessageIterator &, uint8_t, uint8_t *&);
     WEAVE_ERROR calculateEntryLength(uint8_t *entryStart, uint8_t entryCtrlByte, uint16_t *entryLen);
+    WEAVE_ERROR processDirectoryResponse(PacketBuffer *aMsg, bool aDeliverTimeInfo);
+    void connectPendingRequests(void);
+
+    void buildIndex(void);
+    void clearIndex(void);
+    IndexEntry *findIndexSlot(uint64_t aServiceEp);
+
+    void armCacheTimer(void);
+    void cancelCacheTimer(void);
+    static void handleCacheTimer(System::Layer *aSystemLayer, void *aAppState, System::Error aError);
+    void onCacheTimer(void);
+    bool isCacheExpired(void);
+    void startRefresh(void);
+    void refreshFailed(WEAVE_ERROR aError);
+    bool hasConnectsInProgress(void);
+    void applyDeferredResponse(void);
+
     /*
      *  A group of methods that clear up working state and free
      *  resources - generally in the case of a failure. one of
@@ -453,6 +486,11 @@ private:
     bool                    mWasRelocated;                ///< true iff the service manager has been relocated once.
     WeaveAuthMode           mDirAuthMode;                 ///< the authentication mode to use when talking to the directory service.
     uint32_t                mDirAndSuffTableSize;         ///< the size of the directory and suffix table  in the cache.
+    IndexEntry              mIndex[WEAVE_CONFIG_SERVICE_DIR_INDEX_SIZE]; ///< hash index over the working directory
+    bool                    mIndexValid;                  ///< true iff every directory entry is in mIndex
+    bool                    mRefreshing;                  ///< true iff a background refresh of a resolved directory is in progress
+    uint64_t                mResolvedTimeMS;              ///< monotonic time at which the directory was last resolved
+    PacketBuffer            *mDeferredResponse;           ///< a directory response held until in-progress connects no longer use the cache
 
     /**
      *  Callback happens right before we send out the service endpoint query request
@@ -69,14 +69,19 @@ WeaveTunnelAgent::WeaveTunnelAgent()
 #endif
 
     mPeerNodeId               = 0;
-    qFront                    = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
-    qRear                     = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
+    mTunEP                    = NULL;
     mTunAgentState            = kState_NotInitialized;
     mPeerNodeId               = kNodeIdNotSpecified;
     mServiceAddress           = IPAddress::Any;
     mServicePort              = WEAVE_PORT;
     mAuthMode                 = kWeaveAuthMode_Unauthenticated;
     mAppContext               = NULL;
+
+    InitQueues();
+
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+    ClearRouteCache();
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
 }
 
 #if WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
@@ -173,9 +178,8 @@ WEAVE_ERROR WeaveTunnelAgent::ConfigureAndInit (InetLayer *inet, WeaveExchangeMa
     mRole                    = role;
     mAuthMode                = authMode;
     mAppContext              = appContext;
-    memset(queuedMsgs, 0, sizeof(queuedMsgs));
-    qFront                   = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
-    qRear                    = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
+    InitQueues();
+    InvalidateRouteCache();
 #if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
     memset(&mWeaveTunnelStats, 0, sizeof(mWeaveTunnelStats));
 #endif
@@ -307,6 +311,8 @@ void WeaveTunnelAgent::SetDestination(const uint64_t nodeId, const IPAddress ipA
 void WeaveTunnelAgent::SetTunnelingDeviceRole(const Role role)
 {
     mRole             = role;
+
+    InvalidateRouteCache();
 }
 
 #if WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
@@ -856,6 +862,11 @@ void WeaveTunnelAgent::SetState(AgentState toState)
     WeaveLogDetail(WeaveTunnel, "FromState:%s ToState:%s\n", GetAgentStateName(mTunAgentState),
                                  GetAgentStateName(toState));
     mTunAgentState = toState;
+
+    // Routing configuration changes (e.g., role or fabric) take effect
+    // across a tunnel restart; forget next hops resolved under the old one.
+
+    InvalidateRouteCache();
 }
 
 /**
@@ -901,7 +912,7 @@ void WeaveTunnelAgent::ParseDestinationIPAddress(const PacketBuffer &inMsg, IPAd
 void WeaveTunnelAgent::RecvdFromTunnelEndPoint(TunEndPoint *tunEP, PacketBuffer *msg)
 {
     WEAVE_ERROR err             = WEAVE_NO_ERROR;
-    uint64_t nodeId;
+    uint64_t peerId             = 0;
     IPAddress destIP6Addr;
     WeaveTunnelAgent *tAgent    = static_cast<WeaveTunnelAgent *>(tunEP->AppState);
 
@@ -910,41 +921,28 @@ void WeaveTunnelAgent::RecvdFromTunnelEndPoint(TunEndPoint *tunEP, PacketBuffer
     err = tAgent->AddTunnelHdrToMsg(msg);
     SuccessOrExit(err);
 
-    nodeId = destIP6Addr.InterfaceId();
-    if (destIP6Addr.Subnet() == kWeaveSubnetId_Service)
+    switch (tAgent->LookupNextHop(destIP6Addr, peerId))
     {
+    case kNextHop_Service:
         // Destined for Service
 
         err = tAgent->HandleSendingToService(msg);
         msg = NULL;
         SuccessOrExit(err);
-    }
-    else if (destIP6Addr.Subnet() == kWeaveSubnetId_MobileDevice)
-    {
-        if (tAgent->mRole == kClientRole_BorderGateway)
-        {
-            // Decide based on lookup of nexthop table and send locally
-            // via UDP tunnel or remotely via Service TCP connection.
+        break;
 
-            err = tAgent->DecideAndSendShortcutOrRemoteTunnel(nodeId, msg);
-            msg = NULL;
-            SuccessOrExit(err);
-        }
-    }
-    else if ((destIP6Addr.Subnet() == kWeaveSubnetId_PrimaryWiFi) ||
-             (destIP6Addr.Subnet() == kWeaveSubnetId_ThreadMesh))
-    {
-        // Generated locally on Mobile phone; Needs to go via local tunnel or Service
+#if WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+    case kNextHop_Shortcut:
+        // Send locally via UDP tunnel to a peer in the nexthop table.
 
-        if (tAgent->mRole == kClientRole_MobileDevice)
-        {
-            // Decide based on lookup of nexthop table and send locally
-            // via UDP tunnel or remotely via Service TCP connection.
+        err = tAgent->SendOverTunnelShortcut(peerId, msg);
+        msg = NULL;
+        SuccessOrExit(err);
+        break;
+#endif // WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
 
-            err = tAgent->DecideAndSendShortcutOrRemoteTunnel(tAgent->mExchangeMgr->FabricState->FabricId, msg);
-            msg = NULL;
-            SuccessOrExit(err);
-        }
+    default:
+        break;
     }
 
 exit:
@@ -1219,6 +1217,8 @@ WEAVE_ERROR WeaveTunnelAgent::HandleSendingToService(PacketBuffer *msg)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     bool dropPacket = false;
+    const WeaveTunnelConnectionMgr *connMgr = NULL;
+    WeaveMessageInfo msgInfo;
 
     if (mPrimaryTunConnMgr.mConnectionState != WeaveTunnelConnectionMgr::kState_TunnelOpen
 #if WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
@@ -1243,24 +1243,36 @@ WEAVE_ERROR WeaveTunnelAgent::HandleSendingToService(PacketBuffer *msg)
 
     if (mPrimaryTunConnMgr.mConnectionState == WeaveTunnelConnectionMgr::kState_TunnelOpen)
     {
-        WeaveMessageInfo msgInfo;
-
-        PopulateTunnelMsgHeader(&msgInfo, &mPrimaryTunConnMgr);
-
-        err = SendMessageUponPktTransitAnalysis(&mPrimaryTunConnMgr, kDir_Outbound, kType_TunnelPrimary,
-                                                &msgInfo, msg, dropPacket);
+        connMgr = &mPrimaryTunConnMgr;
     }
 #if WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
-    else if (mBackupTunConnMgr.mConnectionState == WeaveTunnelConnectionMgr::kState_TunnelOpen)
+    else
     {
-        WeaveMessageInfo msgInfo;
+        connMgr = &mBackupTunConnMgr;
+    }
+#endif // WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
+
+    // Keep messages in order behind those already queued, and hold them back
+    // while the Service connection has more than its high watermark pending.
 
-        PopulateTunnelMsgHeader(&msgInfo, &mBackupTunConnMgr);
+    if (HasQueuedMessages() || IsServiceConnectionBackedUp(connMgr))
+    {
+        err = EnQueuePacket(msg);
 
-        err = SendMessageUponPktTransitAnalysis(&mBackupTunConnMgr, kDir_Outbound, kType_TunnelBackup,
-                                                &msgInfo, msg, dropPacket);
+        if (err != WEAVE_NO_ERROR)
+        {
+            dropPacket = true;
+        }
+
+        SendQueuedMessages(connMgr);
+
+        ExitNow();
     }
-#endif // WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
+
+    PopulateTunnelMsgHeader(&msgInfo, connMgr);
+
+    err = SendMessageUponPktTransitAnalysis(connMgr, kDir_Outbound, connMgr->mTunType,
+                                            &msgInfo, msg, dropPacket);
 
 exit:
 
@@ -1281,46 +1293,31 @@ exit:
     return err;
 }
 
+#if WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
 /**
- * Prepare message and send to Service via Remote tunnel.
+ * Send message locally via UDP tunnel to a peer in the nexthop table.
  */
-WEAVE_ERROR WeaveTunnelAgent::DecideAndSendShortcutOrRemoteTunnel(uint64_t peerId, PacketBuffer *msg)
+WEAVE_ERROR WeaveTunnelAgent::SendOverTunnelShortcut(uint64_t peerId, PacketBuffer *msg)
 {
     WEAVE_ERROR err =  WEAVE_NO_ERROR;
     bool dropPacket = false;
+    WeaveMessageInfo msgInfo;
 
-#if WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
-
-    // Lookup nexthop table
-
-    if (mTunShortcutControl.IsPeerInShortcutTunnelCache(peerId))
-    {
-        WeaveMessageInfo msgInfo;
-
-        PopulateTunnelMsgHeader(&msgInfo, NULL);
+    PopulateTunnelMsgHeader(&msgInfo, NULL);
 
 #if WEAVE_CONFIG_TUNNEL_ENABLE_TRANSIT_CALLBACK
-        if (OnTunneledPacketTransit)
-        {
-            // Skip the Tunnel header and send the IP packet.
-            OnTunneledPacketTransit(*msg, kDir_Outbound, kType_TunnelShortcut, dropPacket);
-        }
+    if (OnTunneledPacketTransit)
+    {
+        // Skip the Tunnel header and send the IP packet.
+        OnTunneledPacketTransit(*msg, kDir_Outbound, kType_TunnelShortcut, dropPacket);
+    }
 #endif // WEAVE_CONFIG_TUNNEL_ENABLE_TRANSIT_CALLBACK
 
-        // Send over UDP tunnel
+    // Send over UDP tunnel
 
-        if (!dropPacket)
-        {
-            err = mTunShortcutControl.SendMessageOverTunnelShortcut(peerId, &msgInfo, msg);
-            msg = NULL;
-        }
-    }
-    else
-#endif // WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+    if (!dropPacket)
     {
-        // Not found in nexthop table; default to sending to Service
-
-        err = HandleSendingToService(msg);
+        err = mTunShortcutControl.SendMessageOverTunnelShortcut(peerId, &msgInfo, msg);
         msg = NULL;
     }
 
@@ -1336,6 +1333,136 @@ WEAVE_ERROR WeaveTunnelAgent::DecideAndSendShortcutOrRemoteTunnel(uint64_t peerI
 
     return err;
 }
+#endif // WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+
+/**
+ * Decide where a packet read from the tunnel interface should be sent,
+ * based on the subnet of its destination address, the role of this
+ * device and the nexthop table.
+ *
+ * @param[in]  destAddr     The destination address of the packet.
+ * @param[out] outPeerId    The shortcut tunnel peer, if kNextHop_Shortcut is returned.
+ *
+ */
+WeaveTunnelAgent::NextHop WeaveTunnelAgent::ResolveNextHop(const IPAddress &destAddr, uint64_t &outPeerId)
+{
+    NextHop nextHop = kNextHop_None;
+
+    if (destAddr.Subnet() == kWeaveSubnetId_Service)
+    {
+        nextHop = kNextHop_Service;
+    }
+    else if (destAddr.Subnet() == kWeaveSubnetId_MobileDevice)
+    {
+        // Forwarded on behalf of a mobile device.
+
+        if (mRole == kClientRole_BorderGateway)
+        {
+            nextHop = kNextHop_Service;
+            outPeerId = destAddr.InterfaceId();
+        }
+    }
+    else if ((destAddr.Subnet() == kWeaveSubnetId_PrimaryWiFi) ||
+             (destAddr.Subnet() == kWeaveSubnetId_ThreadMesh))
+    {
+        // Generated locally on Mobile phone; Needs to go via local tunnel or Service
+
+        if (mRole == kClientRole_MobileDevice)
+        {
+            nextHop = kNextHop_Service;
+            outPeerId = mExchangeMgr->FabricState->FabricId;
+        }
+    }
+
+#if WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+    // Prefer a local UDP tunnel when the peer is in the nexthop table.
+
+    if (nextHop == kNextHop_Service && outPeerId != 0 &&
+        mTunShortcutControl.IsPeerInShortcutTunnelCache(outPeerId))
+    {
+        nextHop = kNextHop_Shortcut;
+    }
+#endif // WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+
+    return nextHop;
+}
+
+/**
+ * Look up the next hop for a packet read from the tunnel interface in the
+ * route cache, resolving and caching it on a miss.
+ */
+WeaveTunnelAgent::NextHop WeaveTunnelAgent::LookupNextHop(const IPAddress &destAddr, uint64_t &outPeerId)
+{
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+    RouteCacheEntry &entry = GetRouteCacheEntry(destAddr);
+
+    if (entry.mGeneration == mRouteCacheGeneration && entry.mDestAddr == destAddr)
+    {
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+        mWeaveTunnelStats.mRouteCacheHits++;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+
+        outPeerId = entry.mPeerId;
+        return static_cast<NextHop>(entry.mNextHop);
+    }
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    mWeaveTunnelStats.mRouteCacheMisses++;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+
+    outPeerId = 0;
+    entry.mNextHop = ResolveNextHop(destAddr, outPeerId);
+    entry.mDestAddr = destAddr;
+    entry.mPeerId = outPeerId;
+    entry.mGeneration = mRouteCacheGeneration;
+
+    return static_cast<NextHop>(entry.mNextHop);
+#else
+    return ResolveNextHop(destAddr, outPeerId);
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+}
+
+/**
+ * Forget all cached next hops, e.g., when the nexthop table or the tunnel
+ * state changes.
+ */
+void WeaveTunnelAgent::InvalidateRouteCache(void)
+{
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+    // Bump the generation so that every entry goes stale at once. On wrap,
+    // clear the entries so that none of them matches generation 1 again.
+
+    if (++mRouteCacheGeneration == 0)
+    {
+        ClearRouteCache();
+    }
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+}
+
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+/**
+ * Get the route cache entry a destination address maps to. The subnet and
+ * the interface identifier are what vary between destinations of a fabric.
+ */
+WeaveTunnelAgent::RouteCacheEntry &WeaveTunnelAgent::GetRouteCacheEntry(const IPAddress &destAddr)
+{
+    return mRouteCache[(destAddr.InterfaceId() ^ destAddr.Subnet()) % WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE];
+}
+
+/**
+ * Mark every route cache entry as belonging to no generation, and restart
+ * the generations at 1.
+ */
+void WeaveTunnelAgent::ClearRouteCache(void)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE; i++)
+    {
+        mRouteCache[i] = RouteCacheEntry();
+    }
+
+    mRouteCacheGeneration = 1;
+}
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
 
 /**
  * Handle a message received over tunnel and decode tunnel header and send
@@ -1462,34 +1589,102 @@ void WeaveTunnelAgent::UpdateTunnelDownStatistics(const TunnelType tunType, cons
 #endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
 
 /**
- * Queue packet for Remote tunnel connection to get established.
+ * Reset the queues of messages for the Service.
+ */
+void WeaveTunnelAgent::InitQueues(void)
+{
+    memset(mQueues, 0, sizeof(mQueues));
+    mQueuedBytes = 0;
+}
+
+/**
+ * Classify a tunneled message for queueing by looking at the IPv6 header
+ * following the tunnel header. ICMPv6 (which carries neighbor discovery
+ * and router advertisements) and network control traffic are given
+ * priority over all other traffic.
+ */
+WeaveTunnelAgent::TrafficClass WeaveTunnelAgent::ClassifyPacket(const PacketBuffer *pkt)
+{
+    TrafficClass trafficClass = kTrafficClass_Default;
+    const uint8_t *p = pkt->Start() + TUN_HDR_SIZE_IN_BYTES;
+    uint8_t trafficClassField;
+
+    VerifyOrExit(pkt->DataLength() >= TUN_HDR_SIZE_IN_BYTES + NL_IPV6_HDR_SIZE_IN_BYTES, );
+
+    // The IPv6 Traffic Class straddles the first two bytes of the header;
+    // its upper six bits are the DSCP.
+
+    trafficClassField = static_cast<uint8_t>(((p[0] & 0x0F) << 4) | (p[1] >> 4));
+
+    if (p[NL_IPV6_NEXT_HDR_OFFSET] == kIPProtocol_ICMPv6 ||
+        (trafficClassField >> 2) >= NL_IPV6_DSCP_CS6)
+    {
+        trafficClass = kTrafficClass_Control;
+    }
+
+exit:
+    return trafficClass;
+}
+
+/**
+ * Queue packet for Remote tunnel connection to get established or drain.
+ *
+ * When the queue is full, a control message evicts the oldest default
+ * messages to make room; a default message is rejected.
  */
 WEAVE_ERROR WeaveTunnelAgent::EnQueuePacket(PacketBuffer *pkt)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const TrafficClass trafficClass = ClassifyPacket(pkt);
+    const uint32_t pktLen = pkt->DataLength();
+    PacketQueue &queue = mQueues[trafficClass];
+    PacketBuffer *evictedPkt = NULL;
 
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_TunnelQueueFull,
                        ExitNow(err = WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL);
                       );
 
-    if ((qFront == qRear + 1) || (qFront == 0 && qRear == WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED - 1))
-    {
-        // Queue full;
+    VerifyOrExit(queue.mCount < WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED &&
+                 pktLen <= WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED,
+                 err = WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL);
 
-        err = WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL;
-        ExitNow();
-    }
-    else
+    while (mQueuedBytes + pktLen > WEAVE_CONFIG_TUNNELING_MAX_NUM_BYTES_QUEUED)
     {
-        if (qFront == TUNNEL_PACKET_QUEUE_INVALID_INDEX)
-        {
-            qFront = 0;
-        }
-        qRear = (qRear + 1) % WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED;
-        queuedMsgs[qRear] = pkt;
+        VerifyOrExit(trafficClass == kTrafficClass_Control,
+                     err = WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL);
+
+        evictedPkt = DeQueuePacket(kTrafficClass_Default);
+        VerifyOrExit(evictedPkt != NULL, err = WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL);
+
+        WeaveLogDetail(WeaveTunnel, "Tunnel queue full: Evicting message for control traffic\n");
+
+        PacketBuffer::Free(evictedPkt);
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+        // Update tunnel statistics
+        mWeaveTunnelStats.mDroppedMessagesCount++;
+        mWeaveTunnelStats.mQueueDroppedMessagesCount++;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
     }
 
+    queue.mPkts[(queue.mHead + queue.mCount) % WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED] = pkt;
+    queue.mCount++;
+    mQueuedBytes += pktLen;
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    // Update tunnel statistics
+    mWeaveTunnelStats.mQueuedMessagesCount++;
+    mWeaveTunnelStats.mQueuedBytesCount = mQueuedBytes;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+
 exit:
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    if (err == WEAVE_ERROR_TUNNEL_SERVICE_QUEUE_FULL)
+    {
+        // The caller counts the message as dropped.
+        mWeaveTunnelStats.mQueueDroppedMessagesCount++;
+    }
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
 
     return err;
 }
@@ -1498,41 +1693,57 @@ void WeaveTunnelAgent::DumpQueuedMessages(void)
 {
     PacketBuffer *queuedPkt = NULL;
 
-    while (qFront != TUNNEL_PACKET_QUEUE_INVALID_INDEX)
+    while ((queuedPkt = DeQueuePacket()) != NULL)
     {
-        queuedPkt = DeQueuePacket();
-        if (queuedPkt)
-        {
-            PacketBuffer::Free(queuedPkt);
+        PacketBuffer::Free(queuedPkt);
 
 #if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
-            // Update tunnel statistics
-            mWeaveTunnelStats.mDroppedMessagesCount++;
+        // Update tunnel statistics
+        mWeaveTunnelStats.mDroppedMessagesCount++;
 #endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
-
-            queuedPkt = NULL;
-        }
     }
+
+    // Nothing is left to drain; read from the tunnel interface again.
+
+    ResumeTunEndPointReceive();
 }
 
 /**
- * Dequeue a packet for sending via Service tunnel.
+ * Dequeue a packet for sending via Service tunnel; control messages first.
  */
 PacketBuffer *WeaveTunnelAgent::DeQueuePacket(void)
 {
     PacketBuffer *retPkt = NULL;
-    if (qFront != TUNNEL_PACKET_QUEUE_INVALID_INDEX)
+
+    for (int i = 0; i < kTrafficClass_Count && retPkt == NULL; i++)
     {
-        retPkt = queuedMsgs[qFront];
-        if (qFront == qRear) // Only one packet in queue
-        {
-            qFront = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
-            qRear  = TUNNEL_PACKET_QUEUE_INVALID_INDEX;
-        }
-        else
-        {
-            qFront = (qFront + 1) % WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED;
-        }
+        retPkt = DeQueuePacket(static_cast<TrafficClass>(i));
+    }
+
+    return retPkt;
+}
+
+/**
+ * Dequeue the oldest packet of a traffic class.
+ */
+PacketBuffer *WeaveTunnelAgent::DeQueuePacket(TrafficClass trafficClass)
+{
+    PacketBuffer *retPkt = NULL;
+    PacketQueue &queue = mQueues[trafficClass];
+
+    if (queue.mCount > 0)
+    {
+        retPkt = queue.mPkts[queue.mHead];
+        queue.mPkts[queue.mHead] = NULL;
+        queue.mHead = (queue.mHead + 1) % WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED;
+        queue.mCount--;
+        mQueuedBytes -= retPkt->DataLength();
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+        // Update tunnel statistics
+        mWeaveTunnelStats.mQueuedMessagesCount--;
+        mWeaveTunnelStats.mQueuedBytesCount = mQueuedBytes;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
     }
 
     return retPkt;
@@ -1540,7 +1751,11 @@ PacketBuffer *WeaveTunnelAgent::DeQueuePacket(void)
 
 /**
  * Flush queued messages that were pending because Service tunnel
- * was not setup.
+ * was not setup or was backed up.
+ *
+ * Sending stops while the Service connection stays above its high
+ * watermark; reading from the tunnel interface is then paused until
+ * the remaining messages have been sent.
  */
 void WeaveTunnelAgent::SendQueuedMessages(const WeaveTunnelConnectionMgr *connMgr)
 {
@@ -1548,12 +1763,12 @@ void WeaveTunnelAgent::SendQueuedMessages(const WeaveTunnelConnectionMgr *connMg
     PacketBuffer*     queuedPkt   = NULL;
     bool dropPacket;
 
-    while ((queuedPkt = DeQueuePacket()) != NULL)
+    while (!IsServiceConnectionBackedUp(connMgr) && (queuedPkt = DeQueuePacket()) != NULL)
     {
         dropPacket = false;
         PopulateTunnelMsgHeader(&msgInfo, connMgr);
 
-        // Send over TCP Connection
+        // Send over TCP Connection; statistics are updated on success.
 
         msgInfo.DestNodeId = connMgr->mServiceCon->PeerNodeId;
         SendMessageUponPktTransitAnalysis(connMgr, kDir_Outbound, connMgr->mTunType,
@@ -1572,19 +1787,106 @@ void WeaveTunnelAgent::SendQueuedMessages(const WeaveTunnelConnectionMgr *connMg
 
             PacketBuffer::Free(queuedPkt);
         }
-        else
-        {
-#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
-            UpdateOutboundMessageStatistics(connMgr->mTunType, queuedPkt->DataLength());
-#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
-        }
 
         queuedPkt = NULL;
     }
 
+    if (HasQueuedMessages())
+    {
+        PauseTunEndPointReceive();
+    }
+    else
+    {
+        ResumeTunEndPointReceive();
+    }
+
     return;
 }
 
+/**
+ * Check whether the TCP connection to the Service has more bytes pending
+ * than the configured high watermark.
+ */
+bool WeaveTunnelAgent::IsServiceConnectionBackedUp(const WeaveTunnelConnectionMgr *connMgr) const
+{
+#if WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK > 0
+    TCPEndPoint *tcpEndPoint = NULL;
+
+    if (connMgr->mServiceCon != NULL)
+    {
+        tcpEndPoint = connMgr->mServiceCon->GetTCPEndPoint();
+    }
+
+    return (tcpEndPoint != NULL &&
+            tcpEndPoint->PendingSendLength() >= WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK);
+#else
+    return false;
+#endif // WEAVE_CONFIG_TUNNELING_SEND_QUEUE_HIGH_WATERMARK > 0
+}
+
+/**
+ * Stop reading from the tunnel interface and poll the Service connection
+ * until the queued messages have been sent.
+ */
+void WeaveTunnelAgent::PauseTunEndPointReceive(void)
+{
+    if (mTunEP != NULL && mTunEP->IsReceiveEnabled())
+    {
+        WeaveLogDetail(WeaveTunnel, "Service connection backed up: Pausing tunnel interface\n");
+
+        mTunEP->DisableReceive();
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+        // Update tunnel statistics
+        mWeaveTunnelStats.mReceivePausedCount++;
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    }
+
+    mExchangeMgr->MessageLayer->SystemLayer->StartTimer(WEAVE_CONFIG_TUNNELING_SEND_QUEUE_POLL_INTERVAL_MSECS,
+                                                        HandleSendQueuePollTimeout, this);
+}
+
+/**
+ * Resume reading from the tunnel interface.
+ */
+void WeaveTunnelAgent::ResumeTunEndPointReceive(void)
+{
+    if (mExchangeMgr != NULL)
+    {
+        mExchangeMgr->MessageLayer->SystemLayer->CancelTimer(HandleSendQueuePollTimeout, this);
+    }
+
+    if (mTunEP != NULL && !mTunEP->IsReceiveEnabled())
+    {
+        WeaveLogDetail(WeaveTunnel, "Service connection drained: Resuming tunnel interface\n");
+
+        mTunEP->EnableReceive();
+    }
+}
+
+void WeaveTunnelAgent::HandleSendQueuePollTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError)
+{
+    WeaveTunnelAgent *tAgent = static_cast<WeaveTunnelAgent *>(aAppState);
+
+    if (tAgent->mPrimaryTunConnMgr.mConnectionState == WeaveTunnelConnectionMgr::kState_TunnelOpen)
+    {
+        tAgent->SendQueuedMessages(&tAgent->mPrimaryTunConnMgr);
+    }
+#if WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
+    else if (tAgent->mBackupTunConnMgr.mConnectionState == WeaveTunnelConnectionMgr::kState_TunnelOpen)
+    {
+        tAgent->SendQueuedMessages(&tAgent->mBackupTunConnMgr);
+    }
+#endif // WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
+    else
+    {
+        // The queue is held until a tunnel is established, as before
+        // the connection backed up.
+
+        tAgent->ResumeTunEndPointReceive();
+    }
+}
+
 /**
  * Post processing function after Tunnel has been opened.
  */
@@ -1936,7 +2238,7 @@ void WeaveTunnelAgent::WeaveTunnelUpNotifyAndSetState(AgentState state,
     // on behalf of a Thread device or its own packets. So, it is better to send these
     // across and have the Service decide to throw or accept.
 
-    if (qFront != TUNNEL_PACKET_QUEUE_INVALID_INDEX)
+    if (HasQueuedMessages())
     {
         SendQueuedMessages(connMgr);
     }
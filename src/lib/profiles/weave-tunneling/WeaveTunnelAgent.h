@@ -39,8 +39,6 @@
 #define TUN_INTF_NAME_MAX_LEN                 (64)
 #define WEAVE_ULA_FABRIC_DEFAULT_PREFIX_LEN   (48)
 
-#define TUNNEL_PACKET_QUEUE_INVALID_INDEX     (-1)
-
 namespace nl {
 namespace Weave {
 namespace Profiles {
@@ -123,6 +121,12 @@ typedef struct WeaveTunnelStatistics
 {
     WeaveTunnelCommonStatistics mPrimaryStats;                             /**< Primary Weave Tunnel statistics counters. */
     uint32_t     mDroppedMessagesCount;                                    /**< Number of dropped messages by the WeaveTunnelAgent. */
+    uint32_t     mQueuedMessagesCount;                                     /**< Number of messages currently queued for the Service. */
+    uint32_t     mQueuedBytesCount;                                        /**< Number of bytes currently queued for the Service. */
+    uint32_t     mQueueDroppedMessagesCount;                               /**< Number of messages dropped or evicted because the queue for the Service was full; included in mDroppedMessagesCount. */
+    uint32_t     mReceivePausedCount;                                      /**< Number of times reading from the tunnel interface was paused because the Service connection was backed up. */
+    uint32_t     mRouteCacheHits;                                          /**< Number of packets from the tunnel interface routed using a cached next hop. */
+    uint32_t     mRouteCacheMisses;                                        /**< Number of packets from the tunnel interface whose next hop had to be resolved. */
     TunnelType   mCurrentActiveTunnel;                                     /**< The Weave tunnel that is currently being used for data traffic. */
 #if WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
     WeaveTunnelCommonStatistics mBackupStats;                              /**< Backup Weave Tunnel statistics counters. */
@@ -138,6 +142,7 @@ class WeaveTunnelAgent
 {
   friend class WeaveTunnelControl;
   friend class WeaveTunnelConnectionMgr;
+  friend class TestWeaveTunnelRouteCache;
 
 public:
 
@@ -554,10 +559,28 @@ private:
 
     WeaveAuthMode mAuthMode;
 
-    // Queued messages for Service; pending until connection established.
+    // Traffic classes of messages queued for the Service; lower values are sent first.
+
+    typedef enum TrafficClass
+    {
+        kTrafficClass_Control                 = 0,  ///< ICMPv6 and network control (DSCP CS6 and above).
+        kTrafficClass_Default                 = 1,  ///< All other traffic.
+
+        kTrafficClass_Count                   = 2
+    } TrafficClass;
 
-    PacketBuffer *queuedMsgs[WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED];
-    int qFront, qRear;
+    // Queued messages for Service, one ring per traffic class; pending until
+    // connection established or while the connection is backed up.
+
+    struct PacketQueue
+    {
+        PacketBuffer *mPkts[WEAVE_CONFIG_TUNNELING_MAX_NUM_PACKETS_QUEUED];
+        uint16_t mHead;
+        uint16_t mCount;
+    };
+
+    PacketQueue mQueues[kTrafficClass_Count];
+    uint32_t mQueuedBytes;
 
     // Role; Border gateway or Mobile device
 
@@ -597,6 +620,22 @@ private:
     WeaveTunnelControl mTunShortcutControl;
 #endif
 
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+    // Cache of next hop decisions, keyed on the destination address.
+    // Entries from an older generation are stale.
+
+    struct RouteCacheEntry
+    {
+        IPAddress mDestAddr;
+        uint64_t mPeerId;
+        uint16_t mGeneration;
+        uint8_t mNextHop;
+    };
+
+    RouteCacheEntry mRouteCache[WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE];
+    uint16_t mRouteCacheGeneration;
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+
     // WeaveTunnelAgent state
 
     AgentState  mTunAgentState;
@@ -634,10 +673,28 @@ private:
     WEAVE_ERROR HandleSendingToService(PacketBuffer *msg);
     WEAVE_ERROR HandleTunneledReceive(PacketBuffer *msg, TunnelType tunType);
 
-    /// Decide based on lookup of nexthop table and send locally
-    /// via UDP tunnel or remotely via Service TCP connection.
+    /// Next hop for packets read from the tunnel interface, decided based
+    /// on lookup of nexthop table: locally via UDP tunnel or remotely via
+    /// Service TCP connection.
+
+    typedef enum NextHop
+    {
+        kNextHop_None                         = 0,  ///< Not routed over any tunnel; dropped.
+        kNextHop_Service                      = 1,  ///< Remote tunnel to the Service.
+        kNextHop_Shortcut                     = 2,  ///< Local UDP tunnel to a shortcut peer.
+    } NextHop;
+
+    NextHop ResolveNextHop(const IPAddress &destAddr, uint64_t &outPeerId);
+    NextHop LookupNextHop(const IPAddress &destAddr, uint64_t &outPeerId);
+    void InvalidateRouteCache(void);
+#if WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+    RouteCacheEntry &GetRouteCacheEntry(const IPAddress &destAddr);
+    void ClearRouteCache(void);
+#endif // WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
 
-    WEAVE_ERROR DecideAndSendShortcutOrRemoteTunnel(uint64_t nodeId, PacketBuffer *msg);
+#if WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
+    WEAVE_ERROR SendOverTunnelShortcut(uint64_t peerId, PacketBuffer *msg);
+#endif // WEAVE_CONFIG_TUNNEL_SHORTCUT_SUPPORTED
 
     void PopulateTunnelMsgHeader(WeaveMessageInfo *msgInfo, const WeaveTunnelConnectionMgr *connMgr);
 
@@ -657,7 +714,18 @@ private:
     void SendQueuedMessages(const WeaveTunnelConnectionMgr *connMgr);
     WEAVE_ERROR EnQueuePacket(PacketBuffer *pkt);
     PacketBuffer *DeQueuePacket(void);
+    PacketBuffer *DeQueuePacket(TrafficClass trafficClass);
     void DumpQueuedMessages(void);
+    void InitQueues(void);
+    bool HasQueuedMessages(void) const { return mQueuedBytes != 0; }
+    static TrafficClass ClassifyPacket(const PacketBuffer *pkt);
+
+    // Service connection backpressure functions
+
+    bool IsServiceConnectionBackedUp(const WeaveTunnelConnectionMgr *connMgr) const;
+    void PauseTunEndPointReceive(void);
+    void ResumeTunEndPointReceive(void);
+    static void HandleSendQueuePollTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError);
 
     // Tunnel Control post-processing functions
 
@@ -48,6 +48,11 @@
 #define NL_TUNNEL_LIVENESS_MAX_TIMEOUT_SIZE_IN_BYTES   (2)
 #define TUN_HDR_SIZE_IN_BYTES                          (TUN_HDR_VERSION_FIELD_SIZE_IN_BYTES)
 
+// Defines for classifying tunneled IPv6 packets
+#define NL_IPV6_HDR_SIZE_IN_BYTES                      (40)
+#define NL_IPV6_NEXT_HDR_OFFSET                        (6)
+#define NL_IPV6_DSCP_CS6                               (48)
+
 // clang-format on
 
 namespace nl {
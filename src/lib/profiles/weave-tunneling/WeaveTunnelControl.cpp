@@ -657,6 +657,10 @@ WEAVE_ERROR WeaveTunnelControl::FreeNextHopEntry (int index)
 
     memset(&ShortcutTunnelPeerCache[index], 0, sizeof(ShortcutTunnelPeerEntry));
 
+    // Packets to this peer now go to the Service.
+
+    mTunnelAgent->InvalidateRouteCache();
+
 exit:
 
     return err;
@@ -679,6 +683,10 @@ WEAVE_ERROR WeaveTunnelControl::UpdateOrAddTunnelPeerEntry (uint64_t peerId, IPA
         {
             ExitNow(err = WEAVE_ERROR_TUNNEL_NEXTHOP_TABLE_FULL);
         }
+
+        // Packets to this peer can now take the shortcut tunnel.
+
+        mTunnelAgent->InvalidateRouteCache();
     }
 
     // Update the fields in the cache.
@@ -0,0 +1,555 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a streaming encoder and decoder for the LZ4
+ *      frame format.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "LZ4Frame.h"
+
+#include <Weave/Support/CodeUtils.h>
+
+namespace nl {
+namespace Weave {
+
+enum
+{
+    kFrameMagic                     = 0x184D2204,
+    kFrameVersion                   = 0x40,     // FLG version bits
+    kFrameVersionMask               = 0xC0,
+    kFlag_BlockIndependence         = 0x20,
+    kFlag_BlockChecksum             = 0x10,
+    kFlag_ContentSize               = 0x08,
+    kFlag_ContentChecksum           = 0x04,
+    kFlag_Reserved                  = 0x02,
+    kFlag_DictID                    = 0x01,
+    kBlockMaxSize_64KiB             = 0x40,     // BD value for 64KiB blocks
+    kBlockMaxSizeMask               = 0x70,
+    kFrameHeaderChecksum            = 0xC0,     // (XXH32({ FLG, BD }, 0) >> 8) & 0xFF for the header the writer emits
+    kStoredBlockFlag                = 0x80000000,
+
+    kMinMatch                       = 4,
+    kLastLiterals                   = 5,        // The last 5 bytes of a block are always literals
+    kMatchFindLimit                 = 12,       // The last match must start at least 12 bytes before the end of a block
+    kMaxOffset                      = UINT16_MAX,
+    kRunMask                        = 0x0F,
+    kHashEntryEmpty                 = UINT16_MAX,
+};
+
+static inline uint32_t Read32(const uint8_t *p)
+{
+    uint32_t val;
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
+
+static inline uint32_t ReadLE32(const uint8_t *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+        (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void WriteLE32(uint8_t *p, uint32_t val)
+{
+    p[0] = static_cast<uint8_t>(val);
+    p[1] = static_cast<uint8_t>(val >> 8);
+    p[2] = static_cast<uint8_t>(val >> 16);
+    p[3] = static_cast<uint8_t>(val >> 24);
+}
+
+// Worst case number of bytes needed to encode a length field of len, excluding the token nibble.
+static inline uint32_t LengthFieldSize(uint32_t len)
+{
+    return (len >= kRunMask) ? (len - kRunMask) / 255 + 1 : 0;
+}
+
+static inline uint8_t *WriteLengthField(uint8_t *op, uint32_t len)
+{
+    if (len >= kRunMask)
+    {
+        len -= kRunMask;
+        for (; len >= 255; len -= 255)
+            *op++ = 255;
+        *op++ = static_cast<uint8_t>(len);
+    }
+    return op;
+}
+
+WEAVE_ERROR LZ4FrameWriter::Init(uint8_t *aWindowBuf, uint16_t aWindowBufSize, uint16_t aMaxInputLen, uint16_t *aHashTable,
+                                 uint8_t aHashTableBits)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(aWindowBuf != NULL && aHashTable != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(aMaxInputLen > 0 && aMaxInputLen <= aWindowBufSize, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(aHashTableBits >= kMinHashTableBits && aHashTableBits <= kMaxHashTableBits, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mWindowBuf = aWindowBuf;
+    mWindowBufSize = aWindowBufSize;
+    mMaxInputLen = aMaxInputLen;
+    mInputPos = 0;
+    mHashTable = aHashTable;
+    mHashTableBits = aHashTableBits;
+
+    for (uint32_t i = 0; i < (1UL << mHashTableBits); i++)
+        mHashTable[i] = kHashEntryEmpty;
+
+exit:
+    return err;
+}
+
+uint8_t *LZ4FrameWriter::GetInputBuffer(void)
+{
+    if (static_cast<uint32_t>(mInputPos) + mMaxInputLen > mWindowBufSize)
+        SlideWindow();
+
+    return mWindowBuf + mInputPos;
+}
+
+WEAVE_ERROR LZ4FrameWriter::EncodeBlock(const uint8_t *aInput, uint16_t aInputLen, uint8_t *aOut, uint16_t aOutSize,
+                                        uint16_t &aOutLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(aInputLen <= mMaxInputLen, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    memcpy(GetInputBuffer(), aInput, aInputLen);
+
+    err = EncodeBlock(aInputLen, aOut, aOutSize, aOutLen);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR LZ4FrameWriter::EncodeBlock(uint16_t aInputLen, uint8_t *aOut, uint16_t aOutSize, uint16_t &aOutLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t blockLen;
+
+    aOutLen = 0;
+
+    VerifyOrExit(aInputLen <= mMaxInputLen && static_cast<uint32_t>(mInputPos) + aInputLen <= mWindowBufSize,
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(aOutSize >= GetMaxEncodedLength(aInputLen), err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    // A zero length block would read as the end mark.
+    VerifyOrExit(aInputLen > 0, );
+
+    blockLen = CompressBlock(aInputLen, aOut + kBlockHeaderLength, aInputLen);
+    if (blockLen > 0)
+    {
+        WriteLE32(aOut, blockLen);
+    }
+    else
+    {
+        blockLen = aInputLen;
+        WriteLE32(aOut, blockLen | kStoredBlockFlag);
+        memcpy(aOut + kBlockHeaderLength, mWindowBuf + mInputPos, blockLen);
+    }
+
+    // Stored or not, the block stays in the window as history for the blocks after it.
+    mInputPos += aInputLen;
+    aOutLen = static_cast<uint16_t>(blockLen + kBlockHeaderLength);
+
+exit:
+    return err;
+}
+
+uint16_t LZ4FrameWriter::WriteHeader(uint8_t *aOut)
+{
+    WriteLE32(aOut, kFrameMagic);
+    aOut[4] = kFrameVersion;
+    aOut[5] = kBlockMaxSize_64KiB;
+    aOut[6] = kFrameHeaderChecksum;
+    return kFrameHeaderLength;
+}
+
+uint16_t LZ4FrameWriter::WriteEndMark(uint8_t *aOut)
+{
+    WriteLE32(aOut, 0);
+    return kEndMarkLength;
+}
+
+/**
+ *  Greedy single-probe LZ4 block compression of the input at mInputPos.
+ *
+ *  @return The length of the compressed block, or 0 if it would not fit in aOutSize bytes.
+ */
+uint32_t LZ4FrameWriter::CompressBlock(uint16_t aInputLen, uint8_t *aOut, uint32_t aOutSize)
+{
+    const uint8_t *const base = mWindowBuf;
+    const uint8_t *ip = base + mInputPos;
+    const uint8_t *anchor = ip;
+    const uint8_t *const iend = ip + aInputLen;
+    const uint8_t *const mflimit = iend - kMatchFindLimit;
+    const uint8_t *const matchlimit = iend - kLastLiterals;
+    const uint32_t hashShift = 32 - mHashTableBits;
+    uint8_t *op = aOut;
+    uint8_t *const oend = aOut + aOutSize;
+    uint32_t litLen;
+
+    if (aInputLen > kMatchFindLimit)
+    {
+        while (ip < mflimit)
+        {
+            const uint32_t seq = Read32(ip);
+            const uint32_t hash = (seq * 2654435761U) >> hashShift;
+            const uint16_t ref = mHashTable[hash];
+            const uint8_t *match;
+            const uint8_t *matchEnd;
+            uint32_t matchLen;
+            uint16_t offset;
+
+            mHashTable[hash] = static_cast<uint16_t>(ip - base);
+
+            // Every entry lies before ip within a window of at most kMaxOffset bytes, so any hit is in range.
+            if (ref == kHashEntryEmpty || Read32(base + ref) != seq)
+            {
+                ip++;
+                continue;
+            }
+
+            match = base + ref;
+            offset = static_cast<uint16_t>(ip - match);
+
+            while (ip > anchor && match > base && ip[-1] == match[-1])
+            {
+                ip--;
+                match--;
+            }
+
+            matchEnd = ip + kMinMatch;
+            for (match += kMinMatch; matchEnd < matchlimit && *matchEnd == *match; match++)
+                matchEnd++;
+
+            litLen = static_cast<uint32_t>(ip - anchor);
+            matchLen = static_cast<uint32_t>(matchEnd - ip) - kMinMatch;
+
+            if (op + 1 + LengthFieldSize(litLen) + litLen + 2 + LengthFieldSize(matchLen) > oend)
+                return 0;
+
+            *op++ = static_cast<uint8_t>(((litLen < kRunMask ? litLen : kRunMask) << 4) | (matchLen < kRunMask ? matchLen : kRunMask));
+            op = WriteLengthField(op, litLen);
+            memcpy(op, anchor, litLen);
+            op += litLen;
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            op = WriteLengthField(op, matchLen);
+
+            ip = anchor = matchEnd;
+
+            if (ip < mflimit)
+                mHashTable[(Read32(ip - 2) * 2654435761U) >> hashShift] = static_cast<uint16_t>(ip - 2 - base);
+        }
+    }
+
+    litLen = static_cast<uint32_t>(iend - anchor);
+
+    if (op + 1 + LengthFieldSize(litLen) + litLen > oend)
+        return 0;
+
+    *op++ = static_cast<uint8_t>((litLen < kRunMask ? litLen : kRunMask) << 4);
+    op = WriteLengthField(op, litLen);
+    memcpy(op, anchor, litLen);
+    op += litLen;
+
+    return static_cast<uint32_t>(op - aOut);
+}
+
+/**
+ *  Move the most recent history to the front of the window buffer to make room
+ *  for a full block of input, rebasing the match finder table to match.
+ */
+void LZ4FrameWriter::SlideWindow(void)
+{
+    const uint16_t historyLen = mWindowBufSize - mMaxInputLen;
+    const uint16_t shift = mInputPos - historyLen;
+
+    memmove(mWindowBuf, mWindowBuf + shift, historyLen);
+    mInputPos = historyLen;
+
+    for (uint32_t i = 0; i < (1UL << mHashTableBits); i++)
+    {
+        if (mHashTable[i] == kHashEntryEmpty || mHashTable[i] < shift)
+            mHashTable[i] = kHashEntryEmpty;
+        else
+            mHashTable[i] -= shift;
+    }
+}
+
+WEAVE_ERROR LZ4FrameReader::Init(uint8_t *aWindowBuf, uint32_t aWindowBufSize, uint8_t *aBlockBuf, uint32_t aBlockBufSize)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(aWindowBuf != NULL && aBlockBuf != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mWindowBuf = aWindowBuf;
+    mWindowBufSize = aWindowBufSize;
+    mBlockBuf = aBlockBuf;
+    mBlockBufSize = aBlockBufSize;
+    mOutputPos = 0;
+    mMaxBlockLen = 0;
+    mFlags = 0;
+    mState = kState_Header;
+    mFieldLen = 6;                      // Magic, FLG and BD; the rest of the header depends on FLG
+    mFieldPos = 0;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR LZ4FrameReader::Decode(const uint8_t *aInput, uint32_t aInputLen, OutputFunct aOutput, void *aAppState)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    while (aInputLen > 0)
+    {
+        uint32_t len = mFieldLen - mFieldPos;
+        uint32_t blockLen;
+
+        if (len > aInputLen)
+            len = aInputLen;
+
+        switch (mState)
+        {
+        case kState_Header:
+        case kState_BlockHeader:
+            memcpy(mHeader + mFieldPos, aInput, len);
+            break;
+
+        case kState_StoredBlock:
+            memcpy(mWindowBuf + mOutputPos, aInput, len);
+            err = aOutput(aAppState, mWindowBuf + mOutputPos, len);
+            SuccessOrExit(err);
+            mOutputPos += len;
+            break;
+
+        case kState_CompressedBlock:
+            memcpy(mBlockBuf + mFieldPos, aInput, len);
+            break;
+
+        case kState_BlockChecksum:
+        case kState_ContentChecksum:
+            // Checksums are not verified; the transport already protects the data.
+            break;
+
+        default:
+            ExitNow(err = WEAVE_ERROR_INVALID_ARGUMENT);
+        }
+
+        aInput += len;
+        aInputLen -= len;
+        mFieldPos += len;
+
+        if (mFieldPos < mFieldLen)
+            break;
+
+        mFieldPos = 0;
+
+        switch (mState)
+        {
+        case kState_Header:
+            err = ParseHeader();
+            SuccessOrExit(err);
+            break;
+
+        case kState_BlockHeader:
+            blockLen = ReadLE32(mHeader);
+            if (blockLen == 0)
+            {
+                mState = (mFlags & kFlag_ContentChecksum) ? kState_ContentChecksum : kState_Done;
+                mFieldLen = 4;
+                break;
+            }
+
+            mFieldLen = blockLen & ~kStoredBlockFlag;
+            VerifyOrExit(mFieldLen <= mMaxBlockLen, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+            if (mOutputPos + mMaxBlockLen > mWindowBufSize)
+                SlideWindow();
+
+            if (blockLen & kStoredBlockFlag)
+            {
+                mState = kState_StoredBlock;
+            }
+            else
+            {
+                VerifyOrExit(mFieldLen <= mBlockBufSize, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+                mState = kState_CompressedBlock;
+            }
+            break;
+
+        case kState_CompressedBlock:
+            err = DecompressBlock(aOutput, aAppState);
+            SuccessOrExit(err);
+            // fall through
+
+        case kState_StoredBlock:
+            mState = (mFlags & kFlag_BlockChecksum) ? kState_BlockChecksum : kState_BlockHeader;
+            mFieldLen = 4;
+            break;
+
+        case kState_BlockChecksum:
+            mState = kState_BlockHeader;
+            mFieldLen = 4;
+            break;
+
+        case kState_ContentChecksum:
+            mState = kState_Done;
+            break;
+        }
+
+        // An empty stored block or a stream ending exactly on a field boundary leaves nothing more to do.
+        if (mState == kState_StoredBlock && mFieldLen == 0)
+        {
+            mState = (mFlags & kFlag_BlockChecksum) ? kState_BlockChecksum : kState_BlockHeader;
+            mFieldLen = 4;
+        }
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR LZ4FrameReader::ParseHeader(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    if (mFieldLen == 6)
+    {
+        mFlags = mHeader[4];
+
+        VerifyOrExit(ReadLE32(mHeader) == kFrameMagic, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        VerifyOrExit((mFlags & kFrameVersionMask) == kFrameVersion, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        VerifyOrExit((mFlags & (kFlag_Reserved | kFlag_DictID)) == 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        VerifyOrExit((mHeader[5] & ~kBlockMaxSizeMask) == 0 && (mHeader[5] & kBlockMaxSizeMask) >= kBlockMaxSize_64KiB,
+                     err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        // 64KiB, 256KiB, 1MiB or 4MiB.
+        mMaxBlockLen = 1UL << (8 + 2 * ((mHeader[5] & kBlockMaxSizeMask) >> 4));
+        VerifyOrExit(mMaxBlockLen < mWindowBufSize, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+        // Read the optional content size and the header checksum, which are skipped.
+        mFieldLen += ((mFlags & kFlag_ContentSize) ? 8 : 0) + 1;
+        mFieldPos = 6;
+    }
+    else
+    {
+        mState = kState_BlockHeader;
+        mFieldLen = 4;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR LZ4FrameReader::DecompressBlock(OutputFunct aOutput, void *aAppState)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint8_t *ip = mBlockBuf;
+    const uint8_t *const iend = mBlockBuf + mFieldLen;
+    uint8_t *const ostart = mWindowBuf + mOutputPos;
+    uint8_t *op = ostart;
+    uint8_t *const oend = ostart + mMaxBlockLen;
+
+    while (true)
+    {
+        const uint8_t token = *ip++;
+        uint32_t len = token >> 4;
+        uint32_t offset;
+        uint8_t b;
+
+        if (len == kRunMask)
+        {
+            do
+            {
+                VerifyOrExit(ip < iend, err = WEAVE_ERROR_INVALID_ARGUMENT);
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+
+        VerifyOrExit(len <= static_cast<uint32_t>(iend - ip) && len <= static_cast<uint32_t>(oend - op),
+                     err = WEAVE_ERROR_INVALID_ARGUMENT);
+        memcpy(op, ip, len);
+        ip += len;
+        op += len;
+
+        // The last sequence of a block has only literals.
+        if (ip == iend)
+            break;
+
+        VerifyOrExit(iend - ip >= 2, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        offset = ip[0] | (static_cast<uint32_t>(ip[1]) << 8);
+        ip += 2;
+        VerifyOrExit(offset != 0 && offset <= static_cast<uint32_t>(op - mWindowBuf), err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        len = token & kRunMask;
+        if (len == kRunMask)
+        {
+            do
+            {
+                VerifyOrExit(ip < iend, err = WEAVE_ERROR_INVALID_ARGUMENT);
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += kMinMatch;
+
+        VerifyOrExit(len <= static_cast<uint32_t>(oend - op), err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        // Matches may overlap the bytes they produce, so copy forward one byte at a time.
+        for (const uint8_t *match = op - offset; len > 0; len--)
+            *op++ = *match++;
+
+        VerifyOrExit(ip < iend, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    }
+
+    mOutputPos += static_cast<uint32_t>(op - ostart);
+
+    err = aOutput(aAppState, ostart, static_cast<uint32_t>(op - ostart));
+
+exit:
+    return err;
+}
+
+/**
+ *  Move the most recent history to the front of the window buffer to make room
+ *  for a full block of output.
+ */
+void LZ4FrameReader::SlideWindow(void)
+{
+    const uint32_t historyLen = mWindowBufSize - mMaxBlockLen;
+    const uint32_t shift = mOutputPos - historyLen;
+
+    memmove(mWindowBuf, mWindowBuf + shift, historyLen);
+    mOutputPos = historyLen;
+}
+
+} // namespace Weave
+} // namespace nl
@@ -0,0 +1,188 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines a streaming encoder and decoder for the LZ4
+ *      frame format.
+ *
+ *      The encoder produces frames of linked blocks that any LZ4 frame
+ *      decoder accepts. It works block by block out of caller-supplied
+ *      buffers, so data can be compressed as it is produced without
+ *      holding the whole stream in memory.
+ *
+ */
+
+#ifndef LZ4FRAME_H_
+#define LZ4FRAME_H_
+
+#include <stdint.h>
+
+#include <Weave/Core/WeaveError.h>
+
+namespace nl {
+namespace Weave {
+
+/**
+ *  Compresses a stream into an LZ4 frame one block at a time.
+ *
+ *  Input is placed in a window buffer owned by the caller, which also holds
+ *  the tail of the previously compressed input so that each block can refer
+ *  back to data in earlier blocks. A block that does not compress is sent
+ *  stored, so an encoded block is never longer than its input plus
+ *  kBlockHeaderLength.
+ *
+ *  A frame is the output of WriteHeader(), followed by any number of blocks
+ *  from EncodeBlock(), followed by the output of WriteEndMark().
+ */
+class LZ4FrameWriter
+{
+public:
+    enum
+    {
+        kFrameHeaderLength          = 7,
+        kBlockHeaderLength          = 4,
+        kEndMarkLength              = 4,
+        kMaxWindowBufSize           = 0xFFFF,
+        kMinHashTableBits           = 8,
+        kMaxHashTableBits           = 16,
+    };
+
+    /**
+     *  Prepare to encode a new frame.
+     *
+     *  @param[in] aWindowBuf       Buffer holding the input of the current block and the history before it.
+     *  @param[in] aWindowBufSize   Size of aWindowBuf, at most kMaxWindowBufSize.
+     *  @param[in] aMaxInputLen     Largest block that will be encoded; the rest of the window buffer is history.
+     *  @param[in] aHashTable       Match finder table of (1 << aHashTableBits) entries.
+     *  @param[in] aHashTableBits   Log2 of the number of entries in aHashTable.
+     */
+    WEAVE_ERROR Init(uint8_t *aWindowBuf, uint16_t aWindowBufSize, uint16_t aMaxInputLen, uint16_t *aHashTable,
+                     uint8_t aHashTableBits);
+
+    /**
+     *  Return the space in the window buffer where the next block of input
+     *  must be placed, making room for aMaxInputLen bytes.
+     */
+    uint8_t *GetInputBuffer(void);
+
+    /**
+     *  Encode the aInputLen bytes placed in the buffer returned by
+     *  GetInputBuffer() as one block of the frame.
+     *
+     *  @param[in]  aInputLen       Number of input bytes, at most aMaxInputLen.
+     *  @param[out] aOut            Output buffer; at least GetMaxEncodedLength(aInputLen) bytes.
+     *  @param[in]  aOutSize        Size of aOut.
+     *  @param[out] aOutLen         Number of bytes written to aOut, including the block header.
+     */
+    WEAVE_ERROR EncodeBlock(uint16_t aInputLen, uint8_t *aOut, uint16_t aOutSize, uint16_t &aOutLen);
+
+    /**
+     *  Copy aInputLen bytes into the window buffer and encode them as one block.
+     */
+    WEAVE_ERROR EncodeBlock(const uint8_t *aInput, uint16_t aInputLen, uint8_t *aOut, uint16_t aOutSize, uint16_t &aOutLen);
+
+    static uint16_t WriteHeader(uint8_t *aOut);
+    static uint16_t WriteEndMark(uint8_t *aOut);
+
+    static uint32_t GetMaxEncodedLength(uint16_t aInputLen) { return static_cast<uint32_t>(aInputLen) + kBlockHeaderLength; }
+
+private:
+    uint8_t *mWindowBuf;
+    uint16_t *mHashTable;
+    uint16_t mWindowBufSize;
+    uint16_t mMaxInputLen;
+    uint16_t mInputPos;
+    uint8_t mHashTableBits;
+
+    uint32_t CompressBlock(uint16_t aInputLen, uint8_t *aOut, uint32_t aOutSize);
+    void SlideWindow(void);
+};
+
+/**
+ *  Decodes an LZ4 frame delivered in pieces of any size.
+ *
+ *  Decoded data is passed to an output callback one block at a time, or in
+ *  smaller pieces for stored blocks. The window buffer must hold the largest
+ *  block the frame declares plus as much history as the encoder refers back
+ *  to: 64KiB for frames from arbitrary encoders, or the history size of the
+ *  window buffer of an LZ4FrameWriter.
+ */
+class LZ4FrameReader
+{
+public:
+    typedef WEAVE_ERROR (*OutputFunct)(void *aAppState, const uint8_t *aData, uint32_t aDataLen);
+
+    /**
+     *  Prepare to decode a new frame.
+     *
+     *  @param[in] aWindowBuf       Buffer receiving decoded data, including the history it refers to.
+     *  @param[in] aWindowBufSize   Size of aWindowBuf.
+     *  @param[in] aBlockBuf        Buffer collecting one compressed block as it arrives.
+     *  @param[in] aBlockBufSize    Size of aBlockBuf; must hold the largest compressed block of the frame.
+     */
+    WEAVE_ERROR Init(uint8_t *aWindowBuf, uint32_t aWindowBufSize, uint8_t *aBlockBuf, uint32_t aBlockBufSize);
+
+    /**
+     *  Consume the next aInputLen bytes of the frame.
+     *
+     *  @retval #WEAVE_NO_ERROR                 On success.
+     *  @retval #WEAVE_ERROR_INVALID_ARGUMENT   If the input is not a valid LZ4 frame.
+     *  @retval #WEAVE_ERROR_BUFFER_TOO_SMALL   If a block does not fit in the supplied buffers.
+     *  @retval other                           Errors returned by aOutput.
+     */
+    WEAVE_ERROR Decode(const uint8_t *aInput, uint32_t aInputLen, OutputFunct aOutput, void *aAppState);
+
+    /**
+     *  True once the end mark of the frame, and its content checksum if any, have been consumed.
+     */
+    bool IsComplete(void) const { return mState == kState_Done; }
+
+private:
+    enum
+    {
+        kState_Header               = 0,
+        kState_BlockHeader          = 1,
+        kState_StoredBlock          = 2,
+        kState_CompressedBlock      = 3,
+        kState_BlockChecksum        = 4,
+        kState_ContentChecksum      = 5,
+        kState_Done                 = 6,
+    };
+
+    uint8_t *mWindowBuf;
+    uint8_t *mBlockBuf;
+    uint32_t mWindowBufSize;
+    uint32_t mBlockBufSize;
+    uint32_t mOutputPos;
+    uint32_t mMaxBlockLen;
+    uint32_t mFieldLen;                     // Length of the header, block or checksum being read
+    uint32_t mFieldPos;                     // Bytes of it read so far
+    uint8_t mHeader[15];                    // Largest frame header without a dictionary ID
+    uint8_t mFlags;
+    uint8_t mState;
+
+    WEAVE_ERROR ParseHeader(void);
+    WEAVE_ERROR DecompressBlock(OutputFunct aOutput, void *aAppState);
+    void SlideWindow(void);
+};
+
+} // namespace Weave
+} // namespace nl
+
+#endif /* LZ4FRAME_H_ */
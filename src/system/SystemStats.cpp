@@ -76,6 +76,7 @@ static const Label sStatsStrings[nl::Weave::System::Stats::kNumEntries] =
 #endif
 #if WDM_ENABLE_SUBSCRIPTION_CLIENT
     "WDM_NumSubscriptionClients",
+    "WDM_NumRetainedLeafViews",
 #endif
 #if WDM_ENABLE_SUBSCRIPTION_PUBLISHER
     "WDM_NumSubscriptionHandlers",
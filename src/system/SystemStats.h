@@ -84,6 +84,7 @@ enum
 #endif
 #if WDM_ENABLE_SUBSCRIPTION_CLIENT
     kWDM_NumSubscriptionClients,
+    kWDM_NumRetainedLeafViews,
 #endif
 #if WDM_ENABLE_SUBSCRIPTION_PUBLISHER
     kWDM_NumSubscriptionHandlers,
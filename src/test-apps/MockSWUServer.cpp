@@ -232,7 +232,7 @@ WEAVE_ERROR MockSoftwareUpdateServer::SendImageQueryResponse()
     err = GenerateImageDigest(mFileDesignator, (uint8_t)integrityType, imageDigest);
     SuccessOrExit(err);
 
-    err = integritySpec.init(mRefImageQuery->integrityTypes.theList[i], imageDigest);
+    err = integritySpec.init((uint8_t)integrityType, imageDigest);
     SuccessOrExit(err);
 
     err = URI.init((uint16_t)(strlen(mFileDesignator) + 1), (char *)mFileDesignator);
@@ -0,0 +1,482 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the persisted checkpoints of
+ *      resumable Development Bulk Data Transfer downloads.
+ *
+ *      The transfers never reach the network: the tests hand blocks to the
+ *      transfer's dispatchers the way BdxProtocol does, and the checkpoints
+ *      go to the test implementation of the persisted storage.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BulkDataTransfer.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BDXCheckpoint.h>
+
+#include "TestPersistedStorageImplementation.h"
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+using namespace nl::Weave::Profiles::WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development);
+using nl::Weave::Profiles::StatusReporting::StatusReport;
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+class BdxCheckpointTest
+{
+public:
+    BdxCheckpointTest();
+
+    void SetupTest(void);
+    void TearDownTest(void);
+
+    void TestSaveLoadClear(nlTestSuite *inSuite, void *inContext);
+    void TestCrc(nlTestSuite *inSuite, void *inContext);
+    void TestResumeFromOffset(nlTestSuite *inSuite, void *inContext);
+    void TestRejectMismatchedCheckpoint(nlTestSuite *inSuite, void *inContext);
+    void TestRejectMismatchedImage(nlTestSuite *inSuite, void *inContext);
+
+private:
+    enum
+    {
+        kImageLength = 256,
+        kImageVersion = 7,
+
+        // Where the first download is interrupted
+        kInterruptOffset = 96,
+    };
+
+    BDXTransfer mXfer;
+    uint8_t mImage[kImageLength];
+    char mFileDesignator[16];
+
+    // Data handed to the application
+    uint64_t mBytesPut;
+    bool mLastBlockPut;
+
+    bool mXferDone;
+    WEAVE_ERROR mError;
+    size_t mNumErrors;
+
+    void ResetObservations(void);
+    void InitTransfer(uint64_t aImageLength, uint32_t aImageVersion);
+    uint32_t ImageCheckpointId(void);
+    void PutBlock(uint64_t aOffset, uint64_t aLength, bool aIsLast);
+
+    static void HandlePutBlock(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aLastBlock);
+    static void HandleXferError(BDXTransfer *aXfer, StatusReport *aXferError);
+    static void HandleXferDone(BDXTransfer *aXfer);
+    static void HandleError(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode);
+};
+
+BdxCheckpointTest::BdxCheckpointTest() :
+    mBytesPut(0),
+    mLastBlockPut(false),
+    mXferDone(false),
+    mError(WEAVE_NO_ERROR),
+    mNumErrors(0)
+{
+    for (size_t i = 0; i < sizeof(mImage); i++)
+    {
+        mImage[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+
+    strcpy(mFileDesignator, "image.bin");
+}
+
+void BdxCheckpointTest::SetupTest(void)
+{
+    sPersistentStore.clear();
+
+    ResetObservations();
+}
+
+void BdxCheckpointTest::TearDownTest(void)
+{
+    sPersistentStore.clear();
+}
+
+void BdxCheckpointTest::ResetObservations(void)
+{
+    mBytesPut = 0;
+    mLastBlockPut = false;
+    mXferDone = false;
+    mError = WEAVE_NO_ERROR;
+    mNumErrors = 0;
+}
+
+/**
+ * Returns the checkpoint id of the test image as originally served.
+ */
+uint32_t BdxCheckpointTest::ImageCheckpointId(void)
+{
+    ReferencedString fileDesignator;
+
+    fileDesignator.init(static_cast<uint16_t>(strlen(mFileDesignator)), mFileDesignator);
+
+    return BdxCheckpoint::ComputeId(fileDesignator, kImageLength, kImageVersion);
+}
+
+/**
+ * Prepares a resumable download of the whole image, as an application would
+ * before BdxNode::InitBdxReceive(), and starts checkpointing it.
+ */
+void BdxCheckpointTest::InitTransfer(uint64_t aImageLength, uint32_t aImageVersion)
+{
+    BDXHandlers handlers =
+    {
+        NULL,               // SendAcceptHandler
+        NULL,               // ReceiveAcceptHandler
+        NULL,               // RejectHandler
+        NULL,               // GetBlockHandler
+        HandlePutBlock,     // PutBlockHandler
+        HandleXferError,    // XferErrorHandler
+        HandleXferDone,     // XferDoneHandler
+        HandleError         // ErrorHandler
+    };
+
+    mXfer.Reset();
+    mXfer.SetHandlers(handlers);
+    mXfer.mAppState = this;
+    mXfer.mAmInitiator = true;
+    mXfer.mAmSender = false;
+    mXfer.mFileDesignator.init(static_cast<uint16_t>(strlen(mFileDesignator)), mFileDesignator);
+    mXfer.mIsResumable = true;
+    mXfer.mImageLength = aImageLength;
+    mXfer.mImageVersion = aImageVersion;
+    mXfer.mExpectedCrc = BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, mImage, sizeof(mImage));
+    mXfer.mHasExpectedCrc = true;
+
+    mXfer.StartCheckpointing();
+}
+
+/**
+ * Hands the image from aOffset to the transfer in blocks, the way the
+ * protocol does as they arrive.
+ */
+void BdxCheckpointTest::PutBlock(uint64_t aOffset, uint64_t aLength, bool aIsLast)
+{
+    mXfer.DispatchPutBlockHandler(aLength, &mImage[aOffset], aIsLast);
+}
+
+void BdxCheckpointTest::HandlePutBlock(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aLastBlock)
+{
+    BdxCheckpointTest *test = static_cast<BdxCheckpointTest *>(aXfer->mAppState);
+
+    test->mBytesPut += aLength;
+    test->mLastBlockPut = aLastBlock;
+}
+
+void BdxCheckpointTest::HandleXferError(BDXTransfer *aXfer, StatusReport *aXferError)
+{
+    BdxCheckpointTest *test = static_cast<BdxCheckpointTest *>(aXfer->mAppState);
+
+    test->mNumErrors++;
+}
+
+void BdxCheckpointTest::HandleXferDone(BDXTransfer *aXfer)
+{
+    BdxCheckpointTest *test = static_cast<BdxCheckpointTest *>(aXfer->mAppState);
+
+    test->mXferDone = true;
+}
+
+void BdxCheckpointTest::HandleError(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode)
+{
+    BdxCheckpointTest *test = static_cast<BdxCheckpointTest *>(aXfer->mAppState);
+
+    test->mError = aErrorCode;
+    test->mNumErrors++;
+}
+
+void BdxCheckpointTest::TestSaveLoadClear(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    const uint64_t offset = 0x100000010ULL; // Needs both halves of the persisted offset
+    const uint32_t crc = 0x12345678;
+    uint64_t loadedOffset = 0;
+    uint32_t loadedCrc = 0;
+
+    // Nothing saved yet
+    err = BdxCheckpoint::Load(1, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+
+    err = BdxCheckpoint::Save(1, offset, crc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = BdxCheckpoint::Load(1, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, loadedOffset == offset);
+    NL_TEST_ASSERT(inSuite, loadedCrc == crc);
+
+    // Only the download that saved it finds the checkpoint
+    err = BdxCheckpoint::Load(2, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+
+    // A later save replaces it
+    err = BdxCheckpoint::Save(2, 32, crc + 1);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = BdxCheckpoint::Load(1, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+
+    err = BdxCheckpoint::Load(2, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, loadedOffset == 32);
+    NL_TEST_ASSERT(inSuite, loadedCrc == crc + 1);
+
+    err = BdxCheckpoint::Clear();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = BdxCheckpoint::Load(2, loadedOffset, loadedCrc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+}
+
+void BdxCheckpointTest::TestCrc(nlTestSuite *inSuite, void *inContext)
+{
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    uint32_t crc;
+
+    // The CRC-32 check value
+    crc = BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, check, sizeof(check));
+    NL_TEST_ASSERT(inSuite, crc == 0xCBF43926);
+
+    // Continuing a CRC gives the CRC of the whole data
+    crc = BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, check, 4);
+    crc = BdxCheckpoint::UpdateCrc(crc, &check[4], sizeof(check) - 4);
+    NL_TEST_ASSERT(inSuite, crc == 0xCBF43926);
+}
+
+void BdxCheckpointTest::TestResumeFromOffset(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    uint64_t offset = 0;
+    uint32_t crc = 0;
+
+    // The first download is interrupted after a few blocks
+    InitTransfer(kImageLength, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == 0);
+
+    PutBlock(0, 32, false);
+    PutBlock(32, kInterruptOffset - 32, false);
+    mXfer.DispatchErrorHandler(WEAVE_ERROR_TIMEOUT);
+
+    NL_TEST_ASSERT(inSuite, mNumErrors == 1);
+
+    err = BdxCheckpoint::Load(mXfer.mCheckpointId, offset, crc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, offset == kInterruptOffset);
+    NL_TEST_ASSERT(inSuite, crc == BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, mImage, kInterruptOffset));
+
+    // The next download of the same image picks up where it stopped
+    ResetObservations();
+    InitTransfer(kImageLength, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == kInterruptOffset);
+    NL_TEST_ASSERT(inSuite, mXfer.mIntegrityCrc == crc);
+
+    PutBlock(kInterruptOffset, kImageLength - kInterruptOffset, true);
+    NL_TEST_ASSERT(inSuite, mBytesPut == kImageLength - kInterruptOffset);
+    NL_TEST_ASSERT(inSuite, mLastBlockPut);
+
+    // The image checks out, and there is nothing left to resume
+    mXfer.mIsCompletedSuccessfully = true;
+    mXfer.DispatchXferDoneHandler();
+    NL_TEST_ASSERT(inSuite, mXferDone);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+    NL_TEST_ASSERT(inSuite, mXfer.mIntegrityCrc == mXfer.mExpectedCrc);
+
+    err = BdxCheckpoint::Load(ImageCheckpointId(), offset, crc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+}
+
+void BdxCheckpointTest::TestRejectMismatchedCheckpoint(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    uint32_t crc = BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, mImage, kInterruptOffset);
+
+    err = BdxCheckpoint::Save(ImageCheckpointId(), kInterruptOffset, crc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // A new version of the image under the same designator starts over
+    InitTransfer(kImageLength, kImageVersion + 1);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == 0);
+    NL_TEST_ASSERT(inSuite, mXfer.mIntegrityCrc == BdxCheckpoint::kInitialCrc);
+
+    // So does an image of another length
+    InitTransfer(kImageLength - 1, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == 0);
+    NL_TEST_ASSERT(inSuite, mXfer.mIntegrityCrc == BdxCheckpoint::kInitialCrc);
+
+    // The same image resumes
+    InitTransfer(kImageLength, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == kInterruptOffset);
+    NL_TEST_ASSERT(inSuite, mXfer.mIntegrityCrc == crc);
+}
+
+void BdxCheckpointTest::TestRejectMismatchedImage(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    uint64_t offset = 0;
+    uint32_t crc = 0;
+    uint8_t stale[kInterruptOffset];
+
+    // The checkpoint was taken of other data than the image now served
+    memset(stale, 0xA5, sizeof(stale));
+    err = BdxCheckpoint::Save(ImageCheckpointId(), kInterruptOffset, BdxCheckpoint::UpdateCrc(BdxCheckpoint::kInitialCrc, stale, sizeof(stale)));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    InitTransfer(kImageLength, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == kInterruptOffset);
+
+    PutBlock(kInterruptOffset, kImageLength - kInterruptOffset, true);
+
+    // The transfer fails instead of completing, and the next one starts over
+    mXfer.mIsCompletedSuccessfully = true;
+    mXfer.DispatchXferDoneHandler();
+    NL_TEST_ASSERT(inSuite, !mXferDone);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 1);
+    NL_TEST_ASSERT(inSuite, mError == WEAVE_ERROR_INTEGRITY_CHECK_FAILED);
+    NL_TEST_ASSERT(inSuite, !mXfer.mIsCompletedSuccessfully);
+
+    err = BdxCheckpoint::Load(ImageCheckpointId(), offset, crc);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+
+    InitTransfer(kImageLength, kImageVersion);
+    NL_TEST_ASSERT(inSuite, mXfer.mStartOffset == 0);
+}
+
+// Test Suite
+
+static BdxCheckpointTest gBdxCheckpointTest;
+
+static void BdxCheckpointTest_SaveLoadClear(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxCheckpointTest.TestSaveLoadClear(inSuite, inContext);
+}
+
+static void BdxCheckpointTest_Crc(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxCheckpointTest.TestCrc(inSuite, inContext);
+}
+
+static void BdxCheckpointTest_ResumeFromOffset(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxCheckpointTest.TestResumeFromOffset(inSuite, inContext);
+}
+
+static void BdxCheckpointTest_RejectMismatchedCheckpoint(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxCheckpointTest.TestRejectMismatchedCheckpoint(inSuite, inContext);
+}
+
+static void BdxCheckpointTest_RejectMismatchedImage(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxCheckpointTest.TestRejectMismatchedImage(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Save, load and clear a checkpoint",  BdxCheckpointTest_SaveLoadClear),
+    NL_TEST_DEF("Compute the integrity CRC across blocks",  BdxCheckpointTest_Crc),
+    NL_TEST_DEF("Resume an interrupted download from its offset",  BdxCheckpointTest_ResumeFromOffset),
+    NL_TEST_DEF("Start over on a checkpoint of another image",  BdxCheckpointTest_RejectMismatchedCheckpoint),
+    NL_TEST_DEF("Fail a resumed download whose CRC does not match",  BdxCheckpointTest_RejectMismatchedImage),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gBdxCheckpointTest.SetupTest();
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gBdxCheckpointTest.TearDownTest();
+
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-BDXCheckpoint",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+#else // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    return 0;
+#endif // WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+}
@@ -0,0 +1,517 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the scheduler that paces the
+ *      block steps of all transfers of a Development Bulk Data Transfer
+ *      node against a shared byte-rate budget.
+ *
+ *      The transfers never reach the network: their block step is a stub
+ *      that only accounts for a block, so the tests see exactly which
+ *      transfer the node served and when.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BulkDataTransfer.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development) {
+
+class BdxSchedulerTest
+{
+public:
+    BdxSchedulerTest();
+
+    void SetupTest(nlTestSuite *inSuite);
+    void TearDownTest(void);
+
+    void TestRateLimit(nlTestSuite *inSuite, void *inContext);
+    void TestRemoveRateLimit(nlTestSuite *inSuite, void *inContext);
+    void TestRoundRobinPerPeer(nlTestSuite *inSuite, void *inContext);
+    void TestNewPeerJoinsAtVirtualTime(nlTestSuite *inSuite, void *inContext);
+
+private:
+    enum
+    {
+        kBlockSize = 100,
+
+        // 20 blocks per second
+        kMaxByteRate = 2000,
+
+        kRunMsec = 500,
+
+        kMaxNumServed = 64,
+    };
+
+    BdxNode mNode;
+
+    // Transfers in the order their block steps were served
+    BDXTransfer *mServed[kMaxNumServed];
+    size_t mNumServed;
+
+    BDXTransfer *NewTransfer(nlTestSuite *inSuite, uint64_t aPeerNodeId);
+    void ScheduleBlock(BDXTransfer *aXfer);
+    void HoldBackAllSteps(void);
+    BDXTransfer *ServeNext(nlTestSuite *inSuite);
+    void ServiceEventsFor(uint32_t aMsec);
+
+    static WEAVE_ERROR SendStubBlock(BDXTransfer &aXfer);
+};
+
+static const uint64_t kPeerA = 0x18B4300000000001ULL;
+static const uint64_t kPeerB = 0x18B4300000000002ULL;
+static const uint64_t kPeerC = 0x18B4300000000003ULL;
+
+BdxSchedulerTest::BdxSchedulerTest() :
+    mNumServed(0)
+{
+}
+
+void BdxSchedulerTest::SetupTest(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err;
+
+    mNumServed = 0;
+
+    err = mNode.Init(&ExchangeMgr);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+void BdxSchedulerTest::TearDownTest(void)
+{
+    mNode.Shutdown();
+}
+
+BDXTransfer *BdxSchedulerTest::NewTransfer(nlTestSuite *inSuite, uint64_t aPeerNodeId)
+{
+    WEAVE_ERROR err;
+    ExchangeContext *ec;
+    BDXTransfer *xfer = NULL;
+
+    ec = ExchangeMgr.NewContext(aPeerNodeId, this);
+    NL_TEST_ASSERT(inSuite, ec != NULL);
+    VerifyOrExit(ec != NULL, );
+
+    err = mNode.InitTransfer(ec, xfer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, xfer != NULL);
+    VerifyOrExit(xfer != NULL, ec->Close());
+
+    xfer->mAppState = this;
+    xfer->mAmInitiator = true;
+    xfer->mAmSender = true;
+    xfer->mMaxBlockSize = kBlockSize;
+
+exit:
+    return xfer;
+}
+
+void BdxSchedulerTest::ScheduleBlock(BDXTransfer *aXfer)
+{
+    aXfer->mNext = SendStubBlock;
+    mNode.ScheduleBlockAction(*aXfer);
+}
+
+/**
+ * Puts the rate budget so deep in debt that every block step has to wait, so
+ * the test can serve them one at a time in the order the node picks.
+ */
+void BdxSchedulerTest::HoldBackAllSteps(void)
+{
+    mNode.SetMaxByteRate(1);
+    mNode.mTokens = -static_cast<int64_t>(kBlockSize) * kMaxNumServed;
+}
+
+BDXTransfer *BdxSchedulerTest::ServeNext(nlTestSuite *inSuite)
+{
+    BDXTransfer *xfer = mNode.GetNextWaitingTransfer();
+
+    NL_TEST_ASSERT(inSuite, xfer != NULL);
+    VerifyOrExit(xfer != NULL, );
+
+    mNode.RunBlockAction(*xfer);
+
+    // The transfer wants to send its next block right away
+    ScheduleBlock(xfer);
+    NL_TEST_ASSERT(inSuite, xfer->mIsWaiting);
+
+exit:
+    return xfer;
+}
+
+void BdxSchedulerTest::ServiceEventsFor(uint32_t aMsec)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + aMsec;
+
+    while (System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    }
+}
+
+WEAVE_ERROR BdxSchedulerTest::SendStubBlock(BDXTransfer &aXfer)
+{
+    BdxSchedulerTest *test = static_cast<BdxSchedulerTest *>(aXfer.mAppState);
+
+    aXfer.mBytesTransferred += kBlockSize;
+
+    if (test->mNumServed < kMaxNumServed)
+    {
+        test->mServed[test->mNumServed] = &aXfer;
+    }
+    test->mNumServed++;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * A transfer that always has a block to send moves no more than the budget
+ * allows, and its held back steps are counted.
+ */
+void BdxSchedulerTest::TestRateLimit(nlTestSuite *inSuite, void *inContext)
+{
+    BDXTransfer *xfer;
+    BDXTransferStats stats;
+    uint64_t startMsec;
+    uint64_t elapsedMsec;
+    uint64_t maxBytes;
+
+    mNode.SetMaxByteRate(kMaxByteRate);
+    NL_TEST_ASSERT(inSuite, mNode.GetMaxByteRate() == kMaxByteRate);
+
+    xfer = NewTransfer(inSuite, kPeerA);
+    VerifyOrExit(xfer != NULL, );
+
+    startMsec = System::Layer::GetClock_MonotonicMS();
+
+    while (System::Layer::GetClock_MonotonicMS() - startMsec < kRunMsec)
+    {
+        if (!xfer->mIsWaiting)
+        {
+            ScheduleBlock(xfer);
+        }
+
+        ServiceEventsFor(1);
+    }
+
+    elapsedMsec = System::Layer::GetClock_MonotonicMS() - startMsec;
+
+    // What the budget earned, plus its burst and the block that may put it in debt
+    maxBytes = (elapsedMsec * kMaxByteRate) / 1000 + mNode.GetBurstBytes() + kBlockSize;
+
+    NL_TEST_ASSERT(inSuite, xfer->mBytesTransferred <= maxBytes);
+    NL_TEST_ASSERT(inSuite, xfer->mBytesTransferred >= (elapsedMsec * kMaxByteRate) / 2000);
+    NL_TEST_ASSERT(inSuite, mNumServed * kBlockSize == xfer->mBytesTransferred);
+
+    NL_TEST_ASSERT(inSuite, mNode.GetNumActiveTransfers() == 1);
+    NL_TEST_ASSERT(inSuite, mNode.GetTransferStats(0, stats) == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, stats.mPeerNodeId == kPeerA);
+    NL_TEST_ASSERT(inSuite, stats.mBytesTransferred == xfer->mBytesTransferred);
+    NL_TEST_ASSERT(inSuite, stats.mNumDeferrals > 0);
+    NL_TEST_ASSERT(inSuite, stats.mNumDeferrals <= mNumServed + 1);
+    NL_TEST_ASSERT(inSuite, mNode.GetTransferStats(1, stats) == WEAVE_ERROR_INVALID_ARGUMENT);
+
+exit:
+    return;
+}
+
+/**
+ * Lifting the budget releases the waiting steps at once, and later steps no
+ * longer wait.
+ */
+void BdxSchedulerTest::TestRemoveRateLimit(nlTestSuite *inSuite, void *inContext)
+{
+    BDXTransfer *xferA;
+    BDXTransfer *xferB;
+    uint32_t numDeferrals;
+
+    xferA = NewTransfer(inSuite, kPeerA);
+    xferB = NewTransfer(inSuite, kPeerB);
+    VerifyOrExit(xferA != NULL && xferB != NULL, );
+
+    HoldBackAllSteps();
+
+    ScheduleBlock(xferA);
+    ScheduleBlock(xferB);
+
+    NL_TEST_ASSERT(inSuite, xferA->mIsWaiting && xferB->mIsWaiting);
+    NL_TEST_ASSERT(inSuite, mNumServed == 0);
+
+    mNode.SetMaxByteRate(0);
+
+    NL_TEST_ASSERT(inSuite, !xferA->mIsWaiting && !xferB->mIsWaiting);
+    NL_TEST_ASSERT(inSuite, mNumServed == 2);
+    NL_TEST_ASSERT(inSuite, xferA->mBytesTransferred == kBlockSize);
+    NL_TEST_ASSERT(inSuite, xferB->mBytesTransferred == kBlockSize);
+
+    numDeferrals = xferA->mNumDeferrals;
+
+    for (int i = 0; i < 10; i++)
+    {
+        ScheduleBlock(xferA);
+    }
+
+    NL_TEST_ASSERT(inSuite, !xferA->mIsWaiting);
+    NL_TEST_ASSERT(inSuite, xferA->mNumDeferrals == numDeferrals);
+    NL_TEST_ASSERT(inSuite, xferA->mBytesTransferred == 11 * kBlockSize);
+
+exit:
+    return;
+}
+
+/**
+ * Waiting transfers are served per peer: a peer with two transfers gets no
+ * more of the budget than a peer with one, and its transfers take turns.
+ */
+void BdxSchedulerTest::TestRoundRobinPerPeer(nlTestSuite *inSuite, void *inContext)
+{
+    BDXTransfer *xferA1;
+    BDXTransfer *xferA2;
+    BDXTransfer *xferB;
+    BDXTransfer *expected[4];
+    const size_t numRounds = 4;
+
+    xferA1 = NewTransfer(inSuite, kPeerA);
+    xferA2 = NewTransfer(inSuite, kPeerA);
+    xferB = NewTransfer(inSuite, kPeerB);
+    VerifyOrExit(xferA1 != NULL && xferA2 != NULL && xferB != NULL, );
+
+    HoldBackAllSteps();
+
+    ScheduleBlock(xferA1);
+    ScheduleBlock(xferA2);
+    ScheduleBlock(xferB);
+
+    NL_TEST_ASSERT(inSuite, xferA1->mIsWaiting && xferA2->mIsWaiting && xferB->mIsWaiting);
+    NL_TEST_ASSERT(inSuite, mNumServed == 0);
+
+    expected[0] = xferA1;
+    expected[1] = xferB;
+    expected[2] = xferA2;
+    expected[3] = xferB;
+
+    for (size_t i = 0; i < numRounds * 4; i++)
+    {
+        NL_TEST_ASSERT(inSuite, ServeNext(inSuite) == expected[i % 4]);
+    }
+
+    NL_TEST_ASSERT(inSuite, xferA1->mBytesTransferred == numRounds * kBlockSize);
+    NL_TEST_ASSERT(inSuite, xferA2->mBytesTransferred == numRounds * kBlockSize);
+    NL_TEST_ASSERT(inSuite, xferB->mBytesTransferred == 2 * numRounds * kBlockSize);
+
+    // Both peers have been served the same
+    NL_TEST_ASSERT(inSuite, xferA1->mPeerServedBytes == xferB->mPeerServedBytes);
+    NL_TEST_ASSERT(inSuite, xferA2->mPeerServedBytes == xferB->mPeerServedBytes);
+
+exit:
+    return;
+}
+
+/**
+ * A peer that starts a transfer late shares the budget from then on, rather
+ * than catching up on what the other peers have been served.
+ */
+void BdxSchedulerTest::TestNewPeerJoinsAtVirtualTime(nlTestSuite *inSuite, void *inContext)
+{
+    BDXTransfer *xferA;
+    BDXTransfer *xferB;
+    BDXTransfer *xferC;
+    BDXTransfer *xfer;
+    size_t numServedC = 0;
+    size_t numServedSinceC = 0;
+
+    xferA = NewTransfer(inSuite, kPeerA);
+    xferB = NewTransfer(inSuite, kPeerB);
+    VerifyOrExit(xferA != NULL && xferB != NULL, );
+
+    HoldBackAllSteps();
+
+    ScheduleBlock(xferA);
+    ScheduleBlock(xferB);
+
+    for (int i = 0; i < 10; i++)
+    {
+        ServeNext(inSuite);
+    }
+
+    NL_TEST_ASSERT(inSuite, xferA->mBytesTransferred == 5 * kBlockSize);
+    NL_TEST_ASSERT(inSuite, xferB->mBytesTransferred == 5 * kBlockSize);
+
+    xferC = NewTransfer(inSuite, kPeerC);
+    VerifyOrExit(xferC != NULL, );
+    ScheduleBlock(xferC);
+
+    NL_TEST_ASSERT(inSuite, xferC->mIsWaiting);
+
+    // Every run of three steps serves each peer once
+    for (int i = 0; i < 12; i++)
+    {
+        xfer = ServeNext(inSuite);
+
+        if (xfer == xferC)
+        {
+            numServedC++;
+            NL_TEST_ASSERT(inSuite, numServedSinceC == 0 || numServedSinceC == 2);
+            numServedSinceC = 0;
+        }
+        else
+        {
+            numServedSinceC++;
+            NL_TEST_ASSERT(inSuite, numServedSinceC <= 2);
+        }
+    }
+
+    NL_TEST_ASSERT(inSuite, numServedC == 4);
+    NL_TEST_ASSERT(inSuite, xferA->mBytesTransferred == 9 * kBlockSize);
+    NL_TEST_ASSERT(inSuite, xferB->mBytesTransferred == 9 * kBlockSize);
+
+exit:
+    return;
+}
+
+} // namespace BulkDataTransfer
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+using namespace nl::Weave::Profiles::WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development);
+
+// Test Suite
+
+static BdxSchedulerTest gBdxSchedulerTest;
+
+static void BdxSchedulerTest_RateLimit(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxSchedulerTest.TestRateLimit(inSuite, inContext);
+}
+
+static void BdxSchedulerTest_RemoveRateLimit(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxSchedulerTest.TestRemoveRateLimit(inSuite, inContext);
+}
+
+static void BdxSchedulerTest_RoundRobinPerPeer(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxSchedulerTest.TestRoundRobinPerPeer(inSuite, inContext);
+}
+
+static void BdxSchedulerTest_NewPeerJoinsAtVirtualTime(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxSchedulerTest.TestNewPeerJoinsAtVirtualTime(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Hold block steps to the byte-rate budget",  BdxSchedulerTest_RateLimit),
+    NL_TEST_DEF("Release waiting steps when the budget is lifted",  BdxSchedulerTest_RemoveRateLimit),
+    NL_TEST_DEF("Serve waiting transfers round robin per peer",  BdxSchedulerTest_RoundRobinPerPeer),
+    NL_TEST_DEF("Let a new peer join at the current virtual time",  BdxSchedulerTest_NewPeerJoinsAtVirtualTime),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gBdxSchedulerTest.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gBdxSchedulerTest.TearDownTest();
+
+    return 0;
+}
+
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-BDXScheduler",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
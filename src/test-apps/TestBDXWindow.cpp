@@ -0,0 +1,1092 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for windowed transfers of the
+ *      Development Bulk Data Transfer profile.
+ *
+ *      A BdxNode transfer talks to the node itself over the loopback
+ *      interface.  The test plays the peer by hand, so it decides which
+ *      blocks and acknowledgements get lost or reordered.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlbyteorder.h>
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Profiles/status-report/StatusReportProfile.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BulkDataTransfer.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+
+#define PRINT_TEST_NAME() printf("\n%s\n", __func__);
+
+
+
+using namespace nl::Weave::Profiles::BulkDataTransfer;
+using nl::Weave::Profiles::StatusReporting::StatusReport;
+
+// The tests need a few blocks in flight
+#if (WEAVE_CONFIG_BDX_WINDOW_SIZE >= 4) && WEAVE_CONFIG_BDX_CLIENT_SEND_SUPPORT && WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT
+
+class BdxWindowTest {
+    public:
+        BdxWindowTest();
+        ~BdxWindowTest() { }
+
+        // Tests
+        void SetupTest(nlTestSuite *inSuite);
+        void TearDownTest();
+
+        void TestOutOfOrderBlocks(nlTestSuite *inSuite, void *inContext);
+        void TestRetransmitOnTimeout(nlTestSuite *inSuite, void *inContext);
+        void TestSelectiveAckGap(nlTestSuite *inSuite, void *inContext);
+        void TestEOFInPartiallyAckedWindow(nlTestSuite *inSuite, void *inContext);
+        void TestWindowCap(nlTestSuite *inSuite, void *inContext);
+
+    private:
+        enum
+        {
+            kBlockSize = 32,
+
+            // More blocks in flight than any node supports
+            kOversizedWindowSize = 255,
+
+            kMaxNumMessages = 64,
+            kMaxNumBlocks = 64,
+
+            // How long the peer holds the first block before acknowledging it,
+            // which gives the sender a round trip time to pace retransmissions with
+            kAckDelayMsec = 20,
+
+            kTimeoutMsec = 5000,
+        };
+
+        // A message the transfer sent to the peer side of the test
+        struct PeerMessage
+        {
+            uint32_t mProfileId;
+            uint8_t mMsgType;
+            uint32_t mBlockCounter;     // Blocks, EOF acks and window acks
+            uint8_t mBlockData;         // First data byte of a block
+            uint64_t mBlockLength;
+            uint32_t mSelectiveAcks;    // Window acks
+            uint8_t mWindowSize;        // Window acks
+            uint16_t mStatusCode;       // Status reports
+        };
+
+        BdxNode mNode;
+        Binding *mBinding;
+        BDXTransfer *mXfer;
+
+        // The exchange the peer side answers on
+        nl::Weave::ExchangeContext *mPeerEC;
+        bool mPeerOfferedWindowing;
+
+        PeerMessage mMessages[kMaxNumMessages];
+        size_t mNumMessages;
+
+        // Sender side: blocks read from the application
+        uint32_t mNumBlocks;
+        uint32_t mNumBlocksRead;
+        uint8_t mBlockData[kBlockSize];
+
+        // Receiver side: first data byte of the blocks handed to the application
+        uint8_t mBlocksPut[kMaxNumBlocks];
+        size_t mNumBlocksPut;
+        bool mLastBlockPut;
+
+        bool mXferDone;
+        size_t mNumErrors;
+
+        // Test support functions
+        void ServiceEventsFor(uint32_t aMsec);
+        void ServiceEventsUntilMessages(size_t aNumMessages);
+        void ServiceEventsUntilPeer(void);
+        void StartSend(nlTestSuite *inSuite, uint32_t aNumBlocks, uint8_t aPeerWindowSize);
+        void StartReceive(nlTestSuite *inSuite, uint32_t aNumBlocks);
+        void SendPeerMessage(nlTestSuite *inSuite, uint8_t aMsgType, PacketBuffer *aBuffer);
+        void SendWindowAck(nlTestSuite *inSuite, uint32_t aCounter, uint32_t aSelectiveAcks, uint8_t aWindowSize);
+        void SendEOFAck(nlTestSuite *inSuite, uint32_t aCounter);
+        void SendBlock(nlTestSuite *inSuite, uint32_t aCounter, bool aIsLast);
+        void VerifyBlock(nlTestSuite *inSuite, size_t aIndex, uint32_t aCounter);
+        void VerifyWindowAck(nlTestSuite *inSuite, size_t aIndex, uint32_t aCounter, uint32_t aSelectiveAcks);
+        bool IsWindowReleased(void) const;
+
+        static void HandlePeerInit(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                   const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId, uint8_t aMsgType,
+                                   PacketBuffer *aPayload);
+        static void HandlePeerMessage(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                      const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId, uint8_t aMsgType,
+                                      PacketBuffer *aPayload);
+
+        static void HandleReject(BDXTransfer *aXfer, StatusReport *aReport);
+        static void HandleGetBlock(BDXTransfer *aXfer, uint64_t *aLength, uint8_t **aDataBlock, bool *aLastBlock);
+        static void HandlePutBlock(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aLastBlock);
+        static void HandleXferError(BDXTransfer *aXfer, StatusReport *aXferError);
+        static void HandleXferDone(BDXTransfer *aXfer);
+        static void HandleError(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode);
+};
+
+BdxWindowTest::BdxWindowTest() :
+    mBinding(NULL),
+    mXfer(NULL),
+    mPeerEC(NULL),
+    mPeerOfferedWindowing(false),
+    mNumMessages(0),
+    mNumBlocks(0),
+    mNumBlocksRead(0),
+    mNumBlocksPut(0),
+    mLastBlockPut(false),
+    mXferDone(false),
+    mNumErrors(0)
+{
+}
+
+void BdxWindowTest::SetupTest(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Inet::IPAddress peerAddr;
+    ReferencedString fileDesignator;
+    BDXHandlers handlers =
+    {
+        NULL,               // SendAcceptHandler
+        NULL,               // ReceiveAcceptHandler
+        HandleReject,       // RejectHandler
+        HandleGetBlock,     // GetBlockHandler
+        HandlePutBlock,     // PutBlockHandler
+        HandleXferError,    // XferErrorHandler
+        HandleXferDone,     // XferDoneHandler
+        HandleError         // ErrorHandler
+    };
+
+    mPeerEC = NULL;
+    mPeerOfferedWindowing = false;
+    mNumMessages = 0;
+    mNumBlocks = 0;
+    mNumBlocksRead = 0;
+    mNumBlocksPut = 0;
+    mLastBlockPut = false;
+    mXferDone = false;
+    mNumErrors = 0;
+
+    nl::Inet::IPAddress::FromString("::1", peerAddr);
+    fileDesignator.init(static_cast<uint16_t>(strlen("window-test")), const_cast<char *>("window-test"));
+
+    err = mNode.Init(&ExchangeMgr);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // The Init messages are sent to this node, and answered by HandlePeerInit
+    err = ExchangeMgr.RegisterUnsolicitedMessageHandler(kWeaveProfile_BDX, kMsgType_SendInit, HandlePeerInit, this);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = ExchangeMgr.RegisterUnsolicitedMessageHandler(kWeaveProfile_BDX, kMsgType_ReceiveInit, HandlePeerInit, this);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    mBinding = ExchangeMgr.NewBinding();
+    NL_TEST_ASSERT(inSuite, mBinding != NULL);
+    VerifyOrExit(mBinding != NULL, );
+
+    err = mBinding->BeginConfiguration()
+              .Target_NodeId(FabricState.LocalNodeId)
+              .TargetAddress_IP(peerAddr)
+              .Transport_UDP()
+              .Security_None()
+              .PrepareBinding();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBinding->IsReady());
+
+    err = mNode.NewTransfer(mBinding, handlers, fileDesignator, this, mXfer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mXfer != NULL);
+
+exit:
+    return;
+}
+
+void BdxWindowTest::TearDownTest()
+{
+    if (mXfer != NULL)
+    {
+        BdxNode::ShutdownTransfer(mXfer);
+        mXfer = NULL;
+    }
+
+    mNode.Shutdown();
+
+    if (mPeerEC != NULL)
+    {
+        mPeerEC->Close();
+        mPeerEC = NULL;
+    }
+
+    if (mBinding != NULL)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+
+    ExchangeMgr.UnregisterUnsolicitedMessageHandler(kWeaveProfile_BDX, kMsgType_SendInit);
+    ExchangeMgr.UnregisterUnsolicitedMessageHandler(kWeaveProfile_BDX, kMsgType_ReceiveInit);
+}
+
+void BdxWindowTest::ServiceEventsFor(uint32_t aMsec)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + aMsec;
+
+    while (System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    }
+}
+
+void BdxWindowTest::ServiceEventsUntilMessages(size_t aNumMessages)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kTimeoutMsec;
+
+    while (mNumMessages < aNumMessages && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        ServiceEventsFor(1);
+    }
+}
+
+void BdxWindowTest::ServiceEventsUntilPeer(void)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kTimeoutMsec;
+
+    while ((mPeerEC == NULL || !mXfer->mIsAccepted) && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        ServiceEventsFor(1);
+    }
+}
+
+/**
+ * Starts a windowed upload of aNumBlocks blocks to the peer side, and lets the
+ * peer acknowledge the first block, advertising aPeerWindowSize, once the
+ * window has opened.
+ */
+void BdxWindowTest::StartSend(nlTestSuite *inSuite, uint32_t aNumBlocks, uint8_t aPeerWindowSize)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t numOpened;
+
+    mNumBlocks = aNumBlocks;
+
+    err = mNode.InitBdxSend(*mXfer, true, false, false, NULL);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    ServiceEventsUntilPeer();
+
+    NL_TEST_ASSERT(inSuite, mPeerOfferedWindowing);
+    NL_TEST_ASSERT(inSuite, mXfer->mIsAccepted);
+    NL_TEST_ASSERT(inSuite, mXfer->mIsWindowed);
+    NL_TEST_ASSERT(inSuite, mXfer->mMaxWindowSize <= WEAVE_CONFIG_BDX_WINDOW_SIZE);
+
+    // Until the receiver advertises its window, the sender has one block in flight
+    ServiceEventsUntilMessages(1);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == 1);
+    VerifyBlock(inSuite, 0, 0);
+
+    SendWindowAck(inSuite, 1, 0, aPeerWindowSize);
+
+    numOpened = (aPeerWindowSize < mXfer->mMaxWindowSize) ? aPeerWindowSize : mXfer->mMaxWindowSize;
+    if (numOpened > aNumBlocks - 1)
+    {
+        numOpened = aNumBlocks - 1;
+    }
+
+    ServiceEventsUntilMessages(1 + numOpened);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == 1 + numOpened);
+
+    for (uint32_t i = 1; i <= numOpened; i++)
+    {
+        VerifyBlock(inSuite, i, i);
+    }
+}
+
+/**
+ * Starts a windowed download of aNumBlocks blocks from the peer side.
+ */
+void BdxWindowTest::StartReceive(nlTestSuite *inSuite, uint32_t aNumBlocks)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    mNumBlocks = aNumBlocks;
+
+    err = mNode.InitBdxReceive(*mXfer, false, true, false, NULL);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    ServiceEventsUntilPeer();
+
+    NL_TEST_ASSERT(inSuite, mPeerOfferedWindowing);
+    NL_TEST_ASSERT(inSuite, mXfer->mIsAccepted);
+    NL_TEST_ASSERT(inSuite, mXfer->mIsWindowed);
+    NL_TEST_ASSERT(inSuite, mNumMessages == 0);
+}
+
+void BdxWindowTest::SendPeerMessage(nlTestSuite *inSuite, uint8_t aMsgType, PacketBuffer *aBuffer)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(mPeerEC != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    err = mPeerEC->SendMessage(kWeaveProfile_BDX, aMsgType, aBuffer, 0);
+    aBuffer = NULL;
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (aBuffer != NULL)
+    {
+        PacketBuffer::Free(aBuffer);
+    }
+}
+
+void BdxWindowTest::SendWindowAck(nlTestSuite *inSuite, uint32_t aCounter, uint32_t aSelectiveAcks, uint8_t aWindowSize)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *buf = PacketBuffer::New();
+    BlockWindowAckV1 ack;
+
+    VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = ack.init(aCounter, aSelectiveAcks, aWindowSize);
+    SuccessOrExit(err);
+
+    err = ack.pack(buf);
+    SuccessOrExit(err);
+
+    SendPeerMessage(inSuite, kMsgType_BlockWindowAckV1, buf);
+    buf = NULL;
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+}
+
+void BdxWindowTest::SendEOFAck(nlTestSuite *inSuite, uint32_t aCounter)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *buf = PacketBuffer::New();
+    BlockEOFAckV1 ack;
+
+    VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = ack.init(aCounter);
+    SuccessOrExit(err);
+
+    err = ack.pack(buf);
+    SuccessOrExit(err);
+
+    SendPeerMessage(inSuite, kMsgType_BlockEOFAckV1, buf);
+    buf = NULL;
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+}
+
+/**
+ * Sends the block aCounter to a receiving transfer; its data bytes are all
+ * set to the block counter.
+ */
+void BdxWindowTest::SendBlock(nlTestSuite *inSuite, uint32_t aCounter, bool aIsLast)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *buf = PacketBuffer::New();
+    uint8_t *p;
+
+    VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    p = buf->Start();
+    nl::Weave::Encoding::LittleEndian::Write32(p, aCounter);
+    memset(p, static_cast<uint8_t>(aCounter), kBlockSize);
+    buf->SetDataLength(sizeof(aCounter) + kBlockSize);
+
+    SendPeerMessage(inSuite, aIsLast ? kMsgType_BlockEOFV1 : kMsgType_BlockSendV1, buf);
+    buf = NULL;
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+}
+
+/**
+ * Checks that message aIndex is block aCounter, as read from the application.
+ */
+void BdxWindowTest::VerifyBlock(nlTestSuite *inSuite, size_t aIndex, uint32_t aCounter)
+{
+    NL_TEST_ASSERT(inSuite, aIndex < mNumMessages);
+    VerifyOrExit(aIndex < mNumMessages, );
+
+    {
+        const PeerMessage &message = mMessages[aIndex];
+        const uint8_t msgType = (aCounter + 1 == mNumBlocks) ? kMsgType_BlockEOFV1 : kMsgType_BlockSendV1;
+
+        NL_TEST_ASSERT(inSuite, message.mProfileId == kWeaveProfile_BDX);
+        NL_TEST_ASSERT(inSuite, message.mMsgType == msgType);
+        NL_TEST_ASSERT(inSuite, message.mBlockCounter == aCounter);
+        NL_TEST_ASSERT(inSuite, message.mBlockLength == kBlockSize);
+        NL_TEST_ASSERT(inSuite, message.mBlockData == static_cast<uint8_t>(aCounter));
+    }
+
+exit:
+    return;
+}
+
+void BdxWindowTest::VerifyWindowAck(nlTestSuite *inSuite, size_t aIndex, uint32_t aCounter, uint32_t aSelectiveAcks)
+{
+    NL_TEST_ASSERT(inSuite, aIndex < mNumMessages);
+    VerifyOrExit(aIndex < mNumMessages, );
+
+    {
+        const PeerMessage &message = mMessages[aIndex];
+
+        NL_TEST_ASSERT(inSuite, message.mProfileId == kWeaveProfile_BDX);
+        NL_TEST_ASSERT(inSuite, message.mMsgType == kMsgType_BlockWindowAckV1);
+        NL_TEST_ASSERT(inSuite, message.mBlockCounter == aCounter);
+        NL_TEST_ASSERT(inSuite, message.mSelectiveAcks == aSelectiveAcks);
+        NL_TEST_ASSERT(inSuite, message.mWindowSize == mXfer->mMaxWindowSize);
+    }
+
+exit:
+    return;
+}
+
+bool BdxWindowTest::IsWindowReleased(void) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_BDX_WINDOW_SIZE; i++)
+    {
+        if (mXfer->mWindow[i].mBlock != NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BdxWindowTest::TestOutOfOrderBlocks(nlTestSuite *inSuite, void *inContext)
+{
+    const uint32_t numBlocks = 5;
+    const uint32_t lastCounter = numBlocks - 1;
+
+    PRINT_TEST_NAME();
+
+    StartReceive(inSuite, numBlocks);
+
+    // Blocks ahead of the first one are held and selectively acknowledged
+    SendBlock(inSuite, 1, false);
+    ServiceEventsUntilMessages(1);
+    VerifyWindowAck(inSuite, 0, 0, 0x1);
+
+    SendBlock(inSuite, 3, false);
+    ServiceEventsUntilMessages(2);
+    VerifyWindowAck(inSuite, 1, 0, 0x5);
+
+    SendBlock(inSuite, 2, false);
+    ServiceEventsUntilMessages(3);
+    VerifyWindowAck(inSuite, 2, 0, 0x7);
+
+    NL_TEST_ASSERT(inSuite, mNumBlocksPut == 0);
+
+    // The missing block releases the ones held after it, in order
+    SendBlock(inSuite, 0, false);
+    ServiceEventsUntilMessages(4);
+    VerifyWindowAck(inSuite, 3, lastCounter, 0);
+
+    NL_TEST_ASSERT(inSuite, mNumBlocksPut == lastCounter);
+
+    for (size_t i = 0; i < mNumBlocksPut; i++)
+    {
+        NL_TEST_ASSERT(inSuite, mBlocksPut[i] == i);
+    }
+
+    // A duplicate is only acknowledged again
+    SendBlock(inSuite, 2, false);
+    ServiceEventsUntilMessages(5);
+    VerifyWindowAck(inSuite, 4, lastCounter, 0);
+
+    NL_TEST_ASSERT(inSuite, mNumBlocksPut == lastCounter);
+
+    // A block past the receiver's window is rejected, and not held
+    SendBlock(inSuite, lastCounter + mXfer->mMaxWindowSize, false);
+    ServiceEventsUntilMessages(6);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == 6);
+    NL_TEST_ASSERT(inSuite, mMessages[5].mProfileId == kWeaveProfile_Common);
+    NL_TEST_ASSERT(inSuite, mMessages[5].mStatusCode == kStatus_BadBlockCounter);
+    NL_TEST_ASSERT(inSuite, IsWindowReleased());
+
+    // The last block completes the transfer
+    SendBlock(inSuite, lastCounter, true);
+    ServiceEventsUntilMessages(7);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == 7);
+    NL_TEST_ASSERT(inSuite, mMessages[6].mMsgType == kMsgType_BlockEOFAckV1);
+    NL_TEST_ASSERT(inSuite, mMessages[6].mBlockCounter == lastCounter);
+
+    NL_TEST_ASSERT(inSuite, mNumBlocksPut == numBlocks);
+    NL_TEST_ASSERT(inSuite, mLastBlockPut);
+    NL_TEST_ASSERT(inSuite, mXferDone);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+    NL_TEST_ASSERT(inSuite, mXfer->mBytesTransferred == numBlocks * kBlockSize);
+}
+
+void BdxWindowTest::TestRetransmitOnTimeout(nlTestSuite *inSuite, void *inContext)
+{
+    const uint32_t numBlocks = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    size_t numMessages;
+
+    PRINT_TEST_NAME();
+
+    StartSend(inSuite, numBlocks, WEAVE_CONFIG_BDX_WINDOW_SIZE);
+
+    numMessages = mNumMessages;
+
+    // The peer drops every block after the first one and stays silent: nothing
+    // is resent before the retransmission timer fires
+    ServiceEventsFor(WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC / 2);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages);
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 0);
+
+    // Then only the oldest outstanding block is resent, from the copy held in the window
+    ServiceEventsUntilMessages(numMessages + 1);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages + 1);
+    VerifyBlock(inSuite, numMessages, 1);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 1);
+    NL_TEST_ASSERT(inSuite, mXfer->mNumTimeouts == 1);
+    NL_TEST_ASSERT(inSuite, mNumBlocksRead == numBlocks);
+
+    // The retransmission got through along with the rest of the window
+    SendEOFAck(inSuite, numBlocks - 1);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mXferDone);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+    NL_TEST_ASSERT(inSuite, IsWindowReleased());
+    NL_TEST_ASSERT(inSuite, mXfer->mBytesTransferred == numBlocks * kBlockSize);
+}
+
+void BdxWindowTest::TestSelectiveAckGap(nlTestSuite *inSuite, void *inContext)
+{
+    const uint32_t numBlocks = 3 * WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    const uint32_t lostCounter = 3;
+    uint32_t window;
+    uint32_t selectiveAcks;
+    size_t numMessages;
+
+    PRINT_TEST_NAME();
+
+    StartSend(inSuite, numBlocks, WEAVE_CONFIG_BDX_WINDOW_SIZE);
+
+    // Blocks 1 to window are in flight
+    window = mXfer->mMaxWindowSize;
+    numMessages = mNumMessages;
+
+    NL_TEST_ASSERT(inSuite, mXfer->mSmoothedRTT >= kAckDelayMsec);
+
+    // Block 3 is lost: the ones after it are selectively acknowledged once they
+    // are older than a round trip
+    ServiceEventsFor(3 * kAckDelayMsec);
+
+    selectiveAcks = (1UL << (window - lostCounter)) - 1;
+    SendWindowAck(inSuite, lostCounter, selectiveAcks, window);
+
+    // Only the hole is resent, then the window slides past the acknowledged blocks
+    ServiceEventsUntilMessages(numMessages + 3);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages + 3);
+    VerifyBlock(inSuite, numMessages, lostCounter);
+    VerifyBlock(inSuite, numMessages + 1, window + 1);
+    VerifyBlock(inSuite, numMessages + 2, window + 2);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 1);
+    NL_TEST_ASSERT(inSuite, mXfer->mBlockCounter == lostCounter);
+
+    // The same gap reported again within a round trip is not resent again
+    numMessages = mNumMessages;
+
+    SendWindowAck(inSuite, lostCounter, selectiveAcks, window);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages);
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 1);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+}
+
+void BdxWindowTest::TestEOFInPartiallyAckedWindow(nlTestSuite *inSuite, void *inContext)
+{
+    // All the blocks fit in the window opened by the first acknowledgement
+    const uint32_t numBlocks = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    const uint32_t lastCounter = numBlocks - 1;
+    const uint32_t lostCounter = 2;
+    size_t numMessages;
+
+    PRINT_TEST_NAME();
+
+    StartSend(inSuite, numBlocks, WEAVE_CONFIG_BDX_WINDOW_SIZE);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mEOFQueued);
+    NL_TEST_ASSERT(inSuite, mXfer->mEOFBlockCounter == lastCounter);
+    NL_TEST_ASSERT(inSuite, mNumBlocksRead == numBlocks);
+
+    numMessages = mNumMessages;
+
+    // Block 2 is lost, the blocks up to the BlockEOFV1 arrived
+    ServiceEventsFor(3 * kAckDelayMsec);
+    SendWindowAck(inSuite, lostCounter, (1UL << (lastCounter - lostCounter)) - 1, WEAVE_CONFIG_BDX_WINDOW_SIZE);
+
+    // Only the hole is resent; there is nothing new to send
+    ServiceEventsUntilMessages(numMessages + 1);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages + 1);
+    VerifyBlock(inSuite, numMessages, lostCounter);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mBlockCounter == lostCounter);
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 1);
+    NL_TEST_ASSERT(inSuite, !mXferDone);
+
+    // The window acknowledgement for the hole is lost too, but the BlockEOFAckV1
+    // acknowledges the rest of the window
+    SendEOFAck(inSuite, lastCounter);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mXferDone);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+    NL_TEST_ASSERT(inSuite, mXfer->mBlockCounter == lastCounter);
+    NL_TEST_ASSERT(inSuite, IsWindowReleased());
+    NL_TEST_ASSERT(inSuite, mXfer->mBytesTransferred == numBlocks * kBlockSize);
+
+    // The retransmission timer stopped with the transfer
+    numMessages = mNumMessages;
+
+    ServiceEventsFor(WEAVE_CONFIG_BDX_WINDOW_MIN_RETRANSMIT_TIMEOUT_MSEC + kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages);
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 1);
+}
+
+void BdxWindowTest::TestWindowCap(nlTestSuite *inSuite, void *inContext)
+{
+    const uint32_t numBlocks = 4 * WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    const uint32_t window = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    size_t numMessages;
+
+    PRINT_TEST_NAME();
+
+    // The selective acknowledgements cover at most 32 blocks
+    NL_TEST_ASSERT(inSuite, WEAVE_CONFIG_BDX_WINDOW_SIZE <= 32);
+
+    // Ask for more than the node supports; the peer advertises more too
+    mXfer->mMaxWindowSize = kOversizedWindowSize;
+
+    StartSend(inSuite, numBlocks, kOversizedWindowSize);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mMaxWindowSize == window);
+
+    // No more than the compiled-in window is in flight
+    NL_TEST_ASSERT(inSuite, mNumMessages == 1 + window);
+    NL_TEST_ASSERT(inSuite, mXfer->mNextBlockCounter - mXfer->mBlockCounter == window);
+
+    // Each acknowledged block lets exactly one more go
+    numMessages = mNumMessages;
+
+    SendWindowAck(inSuite, 2, 0, kOversizedWindowSize);
+    ServiceEventsUntilMessages(numMessages + 1);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages + 1);
+    VerifyBlock(inSuite, numMessages, window + 1);
+
+    // A smaller window advertised by the receiver holds the sender back
+    numMessages = mNumMessages;
+
+    SendWindowAck(inSuite, 3, 0, 2);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages);
+
+    SendWindowAck(inSuite, window + 2, 0, 2);
+    ServiceEventsUntilMessages(numMessages + 2);
+    ServiceEventsFor(kAckDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, mNumMessages == numMessages + 2);
+    VerifyBlock(inSuite, numMessages, window + 2);
+    VerifyBlock(inSuite, numMessages + 1, window + 3);
+
+    NL_TEST_ASSERT(inSuite, mXfer->mNumRetransmits == 0);
+    NL_TEST_ASSERT(inSuite, mNumErrors == 0);
+}
+
+/**
+ * Answers the SendInit or ReceiveInit of the transfer under test with an
+ * Accept that confirms windowed sender drive.
+ */
+void BdxWindowTest::HandlePeerInit(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                   const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId,
+                                   uint8_t aMsgType, PacketBuffer *aPayload)
+{
+    BdxWindowTest * const pTest = static_cast<BdxWindowTest *>(aEC->AppState);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint8_t transferMode = kMode_SenderDrive | kMode_Windowed;
+    PacketBuffer *buf = NULL;
+
+    VerifyOrExit(pTest->mPeerEC == NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    buf = PacketBuffer::New();
+    VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    if (aMsgType == kMsgType_SendInit)
+    {
+        SendInit sendInit;
+        SendAccept sendAccept;
+
+        err = SendInit::parse(aPayload, sendInit);
+        SuccessOrExit(err);
+
+        pTest->mPeerOfferedWindowing = sendInit.mWindowedModeSupported;
+
+        err = sendAccept.init(1, transferMode, kBlockSize, NULL);
+        SuccessOrExit(err);
+
+        err = sendAccept.pack(buf);
+        SuccessOrExit(err);
+    }
+    else
+    {
+        ReceiveInit receiveInit;
+        ReceiveAccept receiveAccept;
+
+        err = ReceiveInit::parse(aPayload, receiveInit);
+        SuccessOrExit(err);
+
+        pTest->mPeerOfferedWindowing = receiveInit.mWindowedModeSupported;
+
+        err = receiveAccept.init(1, transferMode, kBlockSize, static_cast<uint32_t>(pTest->mNumBlocks * kBlockSize), NULL);
+        SuccessOrExit(err);
+
+        err = receiveAccept.pack(buf);
+        SuccessOrExit(err);
+    }
+
+    aEC->OnMessageReceived = HandlePeerMessage;
+
+    err = aEC->SendMessage(kWeaveProfile_BDX, (aMsgType == kMsgType_SendInit) ? kMsgType_SendAccept : kMsgType_ReceiveAccept, buf, 0);
+    buf = NULL;
+    SuccessOrExit(err);
+
+    pTest->mPeerEC = aEC;
+    aEC = NULL;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        printf("Failed to accept transfer: %s\n", nl::ErrorStr(err));
+    }
+
+    if (aEC != NULL)
+    {
+        aEC->Close();
+    }
+
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+
+    PacketBuffer::Free(aPayload);
+}
+
+/**
+ * Records the messages the transfer under test sends to the peer side.
+ */
+void BdxWindowTest::HandlePeerMessage(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                      const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId,
+                                      uint8_t aMsgType, PacketBuffer *aPayload)
+{
+    BdxWindowTest * const pTest = static_cast<BdxWindowTest *>(aEC->AppState);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(pTest->mNumMessages < kMaxNumMessages, err = WEAVE_ERROR_NO_MEMORY);
+
+    {
+        PeerMessage &message = pTest->mMessages[pTest->mNumMessages];
+
+        memset(&message, 0, sizeof(message));
+        message.mProfileId = aProfileId;
+        message.mMsgType = aMsgType;
+
+        if (aProfileId == kWeaveProfile_Common && aMsgType == nl::Weave::Profiles::Common::kMsgType_StatusReport)
+        {
+            StatusReport report;
+
+            err = StatusReport::parse(aPayload, report);
+            SuccessOrExit(err);
+
+            message.mStatusCode = report.mStatusCode;
+        }
+        else if (aMsgType == kMsgType_BlockSendV1 || aMsgType == kMsgType_BlockEOFV1)
+        {
+            BlockSendV1 block;
+
+            err = BlockSendV1::parse(aPayload, block);
+            SuccessOrExit(err);
+
+            message.mBlockCounter = block.mBlockCounter;
+            message.mBlockLength = block.mLength;
+            message.mBlockData = (block.mData != NULL) ? block.mData[0] : 0;
+        }
+        else if (aMsgType == kMsgType_BlockWindowAckV1)
+        {
+            BlockWindowAckV1 ack;
+
+            err = BlockWindowAckV1::parse(aPayload, ack);
+            SuccessOrExit(err);
+
+            message.mBlockCounter = ack.mBlockCounter;
+            message.mSelectiveAcks = ack.mSelectiveAcks;
+            message.mWindowSize = ack.mWindowSize;
+        }
+        else if (aMsgType == kMsgType_BlockEOFAckV1)
+        {
+            BlockEOFAckV1 ack;
+
+            err = BlockEOFAckV1::parse(aPayload, ack);
+            SuccessOrExit(err);
+
+            message.mBlockCounter = ack.mBlockCounter;
+        }
+    }
+
+    pTest->mNumMessages++;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        printf("Failed to parse message type %u: %s\n", aMsgType, nl::ErrorStr(err));
+    }
+
+    PacketBuffer::Free(aPayload);
+}
+
+void BdxWindowTest::HandleReject(BDXTransfer *aXfer, StatusReport *aReport)
+{
+    static_cast<BdxWindowTest *>(aXfer->mAppState)->mNumErrors++;
+}
+
+/**
+ * Hands out the next block of the upload; all its bytes are set to the block counter.
+ */
+void BdxWindowTest::HandleGetBlock(BDXTransfer *aXfer, uint64_t *aLength, uint8_t **aDataBlock, bool *aLastBlock)
+{
+    BdxWindowTest * const pTest = static_cast<BdxWindowTest *>(aXfer->mAppState);
+
+    memset(pTest->mBlockData, static_cast<uint8_t>(pTest->mNumBlocksRead), kBlockSize);
+
+    *aLength = kBlockSize;
+    *aDataBlock = pTest->mBlockData;
+
+    pTest->mNumBlocksRead++;
+    *aLastBlock = (pTest->mNumBlocksRead >= pTest->mNumBlocks);
+}
+
+void BdxWindowTest::HandlePutBlock(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aLastBlock)
+{
+    BdxWindowTest * const pTest = static_cast<BdxWindowTest *>(aXfer->mAppState);
+
+    if (pTest->mNumBlocksPut < kMaxNumBlocks)
+    {
+        pTest->mBlocksPut[pTest->mNumBlocksPut++] = (aLength > 0) ? aDataBlock[0] : 0;
+    }
+
+    pTest->mLastBlockPut = aLastBlock;
+}
+
+void BdxWindowTest::HandleXferError(BDXTransfer *aXfer, StatusReport *aXferError)
+{
+    static_cast<BdxWindowTest *>(aXfer->mAppState)->mNumErrors++;
+}
+
+void BdxWindowTest::HandleXferDone(BDXTransfer *aXfer)
+{
+    static_cast<BdxWindowTest *>(aXfer->mAppState)->mXferDone = true;
+}
+
+void BdxWindowTest::HandleError(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode)
+{
+    printf("Transfer error: %s\n", nl::ErrorStr(aErrorCode));
+
+    static_cast<BdxWindowTest *>(aXfer->mAppState)->mNumErrors++;
+}
+
+// Test Suite
+
+static BdxWindowTest gBdxWindowTest;
+
+void BdxWindowTest_OutOfOrderBlocks(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxWindowTest.TestOutOfOrderBlocks(inSuite, inContext);
+}
+
+void BdxWindowTest_RetransmitOnTimeout(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxWindowTest.TestRetransmitOnTimeout(inSuite, inContext);
+}
+
+void BdxWindowTest_SelectiveAckGap(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxWindowTest.TestSelectiveAckGap(inSuite, inContext);
+}
+
+void BdxWindowTest_EOFInPartiallyAckedWindow(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxWindowTest.TestEOFInPartiallyAckedWindow(inSuite, inContext);
+}
+
+void BdxWindowTest_WindowCap(nlTestSuite *inSuite, void *inContext)
+{
+    gBdxWindowTest.TestWindowCap(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Deliver blocks received out of order",  BdxWindowTest_OutOfOrderBlocks),
+    NL_TEST_DEF("Retransmit a dropped block on timeout",  BdxWindowTest_RetransmitOnTimeout),
+    NL_TEST_DEF("Resend only the gap of a selective ack",  BdxWindowTest_SelectiveAckGap),
+    NL_TEST_DEF("Complete with the EOF in a partially acked window",  BdxWindowTest_EOFInPartiallyAckedWindow),
+    NL_TEST_DEF("Cap the number of blocks in flight",  BdxWindowTest_WindowCap),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gBdxWindowTest.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gBdxWindowTest.TearDownTest();
+
+    return 0;
+}
+
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-BDXWindow",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // (WEAVE_CONFIG_BDX_WINDOW_SIZE >= 4) && WEAVE_CONFIG_BDX_CLIENT_SEND_SUPPORT && WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // (WEAVE_CONFIG_BDX_WINDOW_SIZE >= 4) && WEAVE_CONFIG_BDX_CLIENT_SEND_SUPPORT && WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT
@@ -0,0 +1,787 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the pool of TCP connections
+ *      that the exchange manager shares between bindings to the same peer.
+ *
+ *      The bindings connect over loopback to a listener owned by the test,
+ *      which accepts the connections and otherwise leaves them alone.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+#if WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+namespace nl {
+namespace Weave {
+
+class TestBindingConnectionPool
+{
+public:
+    TestBindingConnectionPool();
+
+    void SetupTest(nlTestSuite *inSuite);
+    void TearDownTest(void);
+
+    void TestSharedConnection(nlTestSuite *inSuite, void *inContext);
+    void TestWaiterServedAfterPublish(nlTestSuite *inSuite, void *inContext);
+    void TestAbandonedConnectionTakenOver(nlTestSuite *inSuite, void *inContext);
+    void TestIdleConnectionEvicted(nlTestSuite *inSuite, void *inContext);
+    void TestIdleTimeout(nlTestSuite *inSuite, void *inContext);
+    void TestAuthMismatchNotShared(nlTestSuite *inSuite, void *inContext);
+    void TestCloseOnConnectionEstablished(nlTestSuite *inSuite, void *inContext);
+
+private:
+    enum
+    {
+        kTestPort = WEAVE_PORT + 26,
+
+        kMaxNumBindings = WEAVE_CONFIG_MAX_BINDINGS,
+        kMaxNumAccepted = 8,
+
+        kPrepareTimeoutMsec = 2000,
+    };
+
+    enum SecurityType
+    {
+        kSecurity_None,
+        kSecurity_CASE,
+    };
+
+    TCPEndPoint *mListener;
+    TCPEndPoint *mAccepted[kMaxNumAccepted];
+    size_t mNumAccepted;
+
+    Binding *mBindings[kMaxNumBindings];
+    size_t mNumBindings;
+
+    // Bindings in the order they became ready
+    Binding *mReady[kMaxNumBindings];
+    size_t mNumReady;
+    size_t mNumConnectionsEstablished;
+    size_t mNumPrepareFailed;
+
+    // Close bindings as they get the ConnectionEstablished event
+    bool mCloseOnConnectionEstablished;
+
+    WeaveExchangeManager::BindingConnectionPoolStats mStats;
+
+    Binding *Prepare(nlTestSuite *inSuite, uint64_t aPeerNodeId, SecurityType aSecurity);
+    void Close(Binding *aBinding);
+    WeaveExchangeManager::PooledConnection *FindPooledConnection(uint64_t aPeerNodeId);
+    const WeaveExchangeManager::BindingConnectionPoolStats &GetStats(void);
+    void ServiceUntilReady(size_t aNumReady);
+    void ServiceEventsFor(uint32_t aMsec);
+
+    static void HandleBindingEvent(void *apAppState, Binding::EventType aEvent,
+                                   const Binding::InEventParam &aInParam, Binding::OutEventParam &aOutParam);
+    static void HandleConnectionReceived(TCPEndPoint *listeningEndPoint, TCPEndPoint *conEndPoint,
+                                         const IPAddress &peerAddr, uint16_t peerPort);
+};
+
+static const uint64_t kPeerNodeId = 0x18B4300000000001ULL;
+
+TestBindingConnectionPool::TestBindingConnectionPool() :
+    mListener(NULL),
+    mNumAccepted(0),
+    mNumBindings(0),
+    mNumReady(0),
+    mNumConnectionsEstablished(0),
+    mNumPrepareFailed(0),
+    mCloseOnConnectionEstablished(false)
+{
+}
+
+void TestBindingConnectionPool::SetupTest(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err;
+    IPAddress addr;
+
+    mNumAccepted = 0;
+    mNumBindings = 0;
+    mNumReady = 0;
+    mNumConnectionsEstablished = 0;
+    mNumPrepareFailed = 0;
+    mCloseOnConnectionEstablished = false;
+
+    // Start each test with an empty pool and zeroed counters
+    ExchangeMgr.InitBindingConnectionPool();
+
+    IPAddress::FromString("::1", addr);
+
+    err = ::Inet.NewTCPEndPoint(&mListener);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    mListener->AppState = this;
+    mListener->OnConnectionReceived = HandleConnectionReceived;
+
+    err = mListener->Bind(kIPAddressType_IPv6, addr, kTestPort, true);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = mListener->Listen(kMaxNumAccepted);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+exit:
+    return;
+}
+
+void TestBindingConnectionPool::TearDownTest(void)
+{
+    for (size_t i = 0; i < mNumBindings; i++)
+    {
+        if (mBindings[i] != NULL)
+        {
+            mBindings[i]->Close();
+            mBindings[i] = NULL;
+        }
+    }
+    mNumBindings = 0;
+
+    ExchangeMgr.ShutdownBindingConnectionPool();
+
+    for (size_t i = 0; i < mNumAccepted; i++)
+    {
+        mAccepted[i]->Free();
+    }
+    mNumAccepted = 0;
+
+    if (mListener != NULL)
+    {
+        mListener->Free();
+        mListener = NULL;
+    }
+}
+
+Binding *TestBindingConnectionPool::Prepare(nlTestSuite *inSuite, uint64_t aPeerNodeId, SecurityType aSecurity)
+{
+    WEAVE_ERROR err;
+    IPAddress addr;
+    Binding *binding = NULL;
+
+    VerifyOrExit(mNumBindings < kMaxNumBindings, );
+
+    binding = ExchangeMgr.NewBinding(HandleBindingEvent, this);
+    NL_TEST_ASSERT(inSuite, binding != NULL);
+    VerifyOrExit(binding != NULL, );
+
+    mBindings[mNumBindings++] = binding;
+
+    IPAddress::FromString("::1", addr);
+
+    if (aSecurity == kSecurity_CASE)
+    {
+        err = binding->BeginConfiguration()
+                .Target_NodeId(aPeerNodeId)
+                .TargetAddress_IP(addr, kTestPort)
+                .Transport_TCP()
+                .Security_CASESession()
+                .PrepareBinding();
+    }
+    else
+    {
+        err = binding->BeginConfiguration()
+                .Target_NodeId(aPeerNodeId)
+                .TargetAddress_IP(addr, kTestPort)
+                .Transport_TCP()
+                .Security_None()
+                .PrepareBinding();
+    }
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+exit:
+    return binding;
+}
+
+void TestBindingConnectionPool::Close(Binding *aBinding)
+{
+    for (size_t i = 0; i < mNumBindings; i++)
+    {
+        if (mBindings[i] == aBinding)
+        {
+            mBindings[i] = NULL;
+        }
+    }
+
+    aBinding->Close();
+}
+
+WeaveExchangeManager::PooledConnection *TestBindingConnectionPool::FindPooledConnection(uint64_t aPeerNodeId)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; i++)
+    {
+        WeaveExchangeManager::PooledConnection &entry = ExchangeMgr.mPooledConnections[i];
+
+        if (entry.State != WeaveExchangeManager::PooledConnection::kState_Free && entry.PeerNodeId == aPeerNodeId)
+        {
+            return &entry;
+        }
+    }
+
+    return NULL;
+}
+
+const WeaveExchangeManager::BindingConnectionPoolStats &TestBindingConnectionPool::GetStats(void)
+{
+    ExchangeMgr.GetBindingConnectionPoolStats(mStats);
+
+    return mStats;
+}
+
+void TestBindingConnectionPool::ServiceUntilReady(size_t aNumReady)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kPrepareTimeoutMsec;
+
+    while (mNumReady < aNumReady && mNumPrepareFailed == 0 && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        ServiceEventsFor(1);
+    }
+}
+
+void TestBindingConnectionPool::ServiceEventsFor(uint32_t aMsec)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + aMsec;
+
+    do
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    } while (System::Layer::GetClock_MonotonicMS() < endMsec);
+}
+
+void TestBindingConnectionPool::HandleBindingEvent(void *apAppState, Binding::EventType aEvent,
+                                                   const Binding::InEventParam &aInParam, Binding::OutEventParam &aOutParam)
+{
+    TestBindingConnectionPool *test = static_cast<TestBindingConnectionPool *>(apAppState);
+
+    switch (aEvent)
+    {
+    case Binding::kEvent_BindingReady:
+        if (test->mNumReady < kMaxNumBindings)
+        {
+            test->mReady[test->mNumReady] = aInParam.Source;
+        }
+        test->mNumReady++;
+        break;
+
+    case Binding::kEvent_ConnectionEstablished:
+        test->mNumConnectionsEstablished++;
+        if (test->mCloseOnConnectionEstablished)
+        {
+            test->Close(aInParam.Source);
+        }
+        break;
+
+    case Binding::kEvent_PrepareFailed:
+        test->mNumPrepareFailed++;
+        break;
+
+    default:
+        Binding::DefaultEventHandler(apAppState, aEvent, aInParam, aOutParam);
+        break;
+    }
+}
+
+void TestBindingConnectionPool::HandleConnectionReceived(TCPEndPoint *listeningEndPoint, TCPEndPoint *conEndPoint,
+                                                         const IPAddress &peerAddr, uint16_t peerPort)
+{
+    TestBindingConnectionPool *test = static_cast<TestBindingConnectionPool *>(listeningEndPoint->AppState);
+
+    // Hold on to accepted connections until the test ends, so that the peer never closes them
+    if (test->mNumAccepted < kMaxNumAccepted)
+    {
+        test->mAccepted[test->mNumAccepted++] = conEndPoint;
+    }
+    else
+    {
+        conEndPoint->Free();
+    }
+}
+
+/**
+ * A second binding to the same peer uses the connection of the first one,
+ * without connecting, and keeps it after the first binding closes.
+ */
+void TestBindingConnectionPool::TestSharedConnection(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *first;
+    Binding *second;
+    WeaveConnection *con;
+    WeaveExchangeManager::PooledConnection *entry;
+
+    first = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(first != NULL, );
+
+    ServiceUntilReady(1);
+    NL_TEST_ASSERT(inSuite, first->IsReady());
+    NL_TEST_ASSERT(inSuite, mNumConnectionsEstablished == 1);
+
+    con = first->GetConnection();
+    NL_TEST_ASSERT(inSuite, con != NULL);
+
+    second = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(second != NULL, );
+
+    // Ready at once, on the same connection, which is established for it as well
+    NL_TEST_ASSERT(inSuite, second->IsReady());
+    NL_TEST_ASSERT(inSuite, second->GetConnection() == con);
+    NL_TEST_ASSERT(inSuite, mNumReady == 2);
+    NL_TEST_ASSERT(inSuite, mNumConnectionsEstablished == 2);
+    NL_TEST_ASSERT(inSuite, mNumAccepted == 1);
+
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == 1);
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 1);
+
+    entry = FindPooledConnection(kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL);
+    VerifyOrExit(entry != NULL, );
+    NL_TEST_ASSERT(inSuite, entry->Con == con);
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 2);
+
+    Close(first);
+    ServiceEventsFor(5);
+
+    NL_TEST_ASSERT(inSuite, second->IsReady());
+    NL_TEST_ASSERT(inSuite, con->State == WeaveConnection::kState_Connected);
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 1);
+
+exit:
+    return;
+}
+
+/**
+ * A binding prepared while another is still connecting to the same peer
+ * waits, and is made ready on that connection once it is published.
+ */
+void TestBindingConnectionPool::TestWaiterServedAfterPublish(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *owner;
+    Binding *waiter;
+    WeaveExchangeManager::PooledConnection *entry;
+
+    owner = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    waiter = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(owner != NULL && waiter != NULL, );
+
+    entry = FindPooledConnection(kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL);
+    VerifyOrExit(entry != NULL, );
+
+    NL_TEST_ASSERT(inSuite, owner->IsPreparing());
+    NL_TEST_ASSERT(inSuite, waiter->IsPreparing());
+    NL_TEST_ASSERT(inSuite, waiter->GetConnection() == NULL);
+    NL_TEST_ASSERT(inSuite, entry->State == WeaveExchangeManager::PooledConnection::kState_Establishing);
+
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == 1);
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 1);
+
+    ServiceUntilReady(2);
+
+    NL_TEST_ASSERT(inSuite, mNumReady == 2);
+    NL_TEST_ASSERT(inSuite, mReady[0] == owner);
+    NL_TEST_ASSERT(inSuite, mReady[1] == waiter);
+    NL_TEST_ASSERT(inSuite, waiter->GetConnection() == owner->GetConnection());
+    NL_TEST_ASSERT(inSuite, mNumConnectionsEstablished == 2);
+    NL_TEST_ASSERT(inSuite, mNumAccepted == 1);
+    NL_TEST_ASSERT(inSuite, entry->State == WeaveExchangeManager::PooledConnection::kState_Established);
+    NL_TEST_ASSERT(inSuite, entry->Con == owner->GetConnection());
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 2);
+
+exit:
+    return;
+}
+
+/**
+ * When the binding establishing a pooled connection goes away before it
+ * is ready, a waiting binding takes over and establishes it.
+ */
+void TestBindingConnectionPool::TestAbandonedConnectionTakenOver(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *owner;
+    Binding *waiter;
+    WeaveExchangeManager::PooledConnection *entry;
+
+    owner = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    waiter = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(owner != NULL && waiter != NULL, );
+
+    NL_TEST_ASSERT(inSuite, waiter->IsPreparing());
+    NL_TEST_ASSERT(inSuite, waiter->GetConnection() == NULL);
+
+    Close(owner);
+    NL_TEST_ASSERT(inSuite, FindPooledConnection(kPeerNodeId) == NULL);
+
+    ServiceUntilReady(1);
+
+    NL_TEST_ASSERT(inSuite, mNumReady == 1);
+    NL_TEST_ASSERT(inSuite, mReady[0] == waiter);
+    NL_TEST_ASSERT(inSuite, mNumPrepareFailed == 0);
+    NL_TEST_ASSERT(inSuite, waiter->GetConnection() != NULL);
+
+    entry = FindPooledConnection(kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL && entry->Con == waiter->GetConnection());
+
+    // The waiter missed the second time round, as it had to connect itself
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == 2);
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 1);
+
+exit:
+    return;
+}
+
+/**
+ * A full pool makes room for a new peer by closing the connection that
+ * has been idle the longest.
+ */
+void TestBindingConnectionPool::TestIdleConnectionEvicted(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *binding;
+    WeaveConnection *oldest = NULL;
+    WeaveExchangeManager::PooledConnection *entry;
+    const uint64_t newPeerNodeId = kPeerNodeId + WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE;
+
+    for (size_t i = 0; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; i++)
+    {
+        binding = Prepare(inSuite, kPeerNodeId + i, kSecurity_None);
+        VerifyOrExit(binding != NULL, );
+
+        ServiceUntilReady(i + 1);
+        NL_TEST_ASSERT(inSuite, binding->IsReady());
+
+        if (i == 0)
+        {
+            oldest = binding->GetConnection();
+        }
+
+        Close(binding);
+
+        // Keep the idle times apart
+        ServiceEventsFor(5);
+    }
+
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE);
+    NL_TEST_ASSERT(inSuite, GetStats().Evictions == 0);
+    NL_TEST_ASSERT(inSuite, oldest != NULL && oldest->State == WeaveConnection::kState_Connected);
+
+    binding = Prepare(inSuite, newPeerNodeId, kSecurity_None);
+    VerifyOrExit(binding != NULL, );
+
+    NL_TEST_ASSERT(inSuite, GetStats().Evictions == 1);
+    NL_TEST_ASSERT(inSuite, FindPooledConnection(kPeerNodeId) == NULL);
+    NL_TEST_ASSERT(inSuite, oldest->State == WeaveConnection::kState_Closed);
+
+    for (size_t i = 1; i < WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE; i++)
+    {
+        NL_TEST_ASSERT(inSuite, FindPooledConnection(kPeerNodeId + i) != NULL);
+    }
+
+    ServiceUntilReady(WEAVE_CONFIG_BINDING_CONNECTION_POOL_SIZE + 1);
+
+    NL_TEST_ASSERT(inSuite, binding->IsReady());
+
+    entry = FindPooledConnection(newPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL && entry->Con == binding->GetConnection());
+
+exit:
+    return;
+}
+
+/**
+ * A pooled connection nobody uses is closed once it has been idle for the
+ * idle timeout.
+ */
+void TestBindingConnectionPool::TestIdleTimeout(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *binding;
+    WeaveConnection *con;
+    WeaveExchangeManager::PooledConnection *entry;
+
+    binding = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(binding != NULL, );
+
+    ServiceUntilReady(1);
+    NL_TEST_ASSERT(inSuite, binding->IsReady());
+
+    con = binding->GetConnection();
+
+    Close(binding);
+    ServiceEventsFor(5);
+
+    // Idle, but not for long enough yet
+    entry = FindPooledConnection(kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL);
+    VerifyOrExit(entry != NULL, );
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 0);
+    NL_TEST_ASSERT(inSuite, con->State == WeaveConnection::kState_Connected);
+    NL_TEST_ASSERT(inSuite, GetStats().IdleTimeouts == 0);
+
+    // Rather than wait out the timeout, make the connection look idle for that long
+    entry->IdleSinceMS -= WEAVE_CONFIG_BINDING_CONNECTION_POOL_IDLE_TIMEOUT_MSECS;
+    ExchangeMgr.ServiceBindingConnectionPool();
+
+    NL_TEST_ASSERT(inSuite, GetStats().IdleTimeouts == 1);
+    NL_TEST_ASSERT(inSuite, FindPooledConnection(kPeerNodeId) == NULL);
+    NL_TEST_ASSERT(inSuite, con->State == WeaveConnection::kState_Closed);
+
+    // The next binding to the peer has to connect again
+    binding = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(binding != NULL, );
+
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == 2);
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 0);
+
+exit:
+    return;
+}
+
+/**
+ * A binding to the same peer with different security settings does not
+ * share the pooled connection.
+ */
+void TestBindingConnectionPool::TestAuthMismatchNotShared(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *unsecured;
+    Binding *secured;
+    Binding *unsecured2;
+
+    unsecured = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(unsecured != NULL, );
+
+    ServiceUntilReady(1);
+    NL_TEST_ASSERT(inSuite, unsecured->IsReady());
+
+    secured = Prepare(inSuite, kPeerNodeId, kSecurity_CASE);
+    VerifyOrExit(secured != NULL, );
+
+    NL_TEST_ASSERT(inSuite, !secured->IsReady());
+    NL_TEST_ASSERT(inSuite, secured->GetConnection() != NULL);
+    NL_TEST_ASSERT(inSuite, secured->GetConnection() != unsecured->GetConnection());
+    NL_TEST_ASSERT(inSuite, GetStats().Misses == 2);
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 0);
+
+    // A binding with matching settings still shares
+    unsecured2 = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(unsecured2 != NULL, );
+
+    NL_TEST_ASSERT(inSuite, unsecured2->IsReady());
+    NL_TEST_ASSERT(inSuite, unsecured2->GetConnection() == unsecured->GetConnection());
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 1);
+
+exit:
+    return;
+}
+
+/**
+ * A binding closed in response to the ConnectionEstablished event for a
+ * pooled connection gives up its use of the connection.
+ */
+void TestBindingConnectionPool::TestCloseOnConnectionEstablished(nlTestSuite *inSuite, void *inContext)
+{
+    Binding *first;
+    Binding *second;
+    WeaveExchangeManager::PooledConnection *entry;
+
+    first = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(first != NULL, );
+
+    ServiceUntilReady(1);
+    NL_TEST_ASSERT(inSuite, first->IsReady());
+
+    entry = FindPooledConnection(kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, entry != NULL);
+    VerifyOrExit(entry != NULL, );
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 1);
+
+    mCloseOnConnectionEstablished = true;
+
+    second = Prepare(inSuite, kPeerNodeId, kSecurity_None);
+    VerifyOrExit(second != NULL, );
+
+    // The second binding got the event and closed without becoming ready
+    NL_TEST_ASSERT(inSuite, GetStats().Hits == 1);
+    NL_TEST_ASSERT(inSuite, mNumConnectionsEstablished == 2);
+    NL_TEST_ASSERT(inSuite, mNumReady == 1);
+    NL_TEST_ASSERT(inSuite, entry->UserCount == 1);
+
+    NL_TEST_ASSERT(inSuite, first->IsReady());
+    NL_TEST_ASSERT(inSuite, first->GetConnection()->State == WeaveConnection::kState_Connected);
+
+exit:
+    return;
+}
+
+} // namespace Weave
+} // namespace nl
+
+using namespace nl::Weave;
+
+// Test Suite
+
+static TestBindingConnectionPool gTestBindingConnectionPool;
+
+static void TestBindingConnectionPool_SharedConnection(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestSharedConnection(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_WaiterServedAfterPublish(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestWaiterServedAfterPublish(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_AbandonedConnectionTakenOver(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestAbandonedConnectionTakenOver(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_IdleConnectionEvicted(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestIdleConnectionEvicted(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_IdleTimeout(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestIdleTimeout(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_AuthMismatchNotShared(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestAuthMismatchNotShared(inSuite, inContext);
+}
+
+static void TestBindingConnectionPool_CloseOnConnectionEstablished(nlTestSuite *inSuite, void *inContext)
+{
+    gTestBindingConnectionPool.TestCloseOnConnectionEstablished(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Share a connection between bindings to the same peer",  TestBindingConnectionPool_SharedConnection),
+    NL_TEST_DEF("Serve a waiting binding once the connection is published",  TestBindingConnectionPool_WaiterServedAfterPublish),
+    NL_TEST_DEF("Take over an abandoned connection",  TestBindingConnectionPool_AbandonedConnectionTakenOver),
+    NL_TEST_DEF("Evict the longest idle connection",  TestBindingConnectionPool_IdleConnectionEvicted),
+    NL_TEST_DEF("Close a connection after the idle timeout",  TestBindingConnectionPool_IdleTimeout),
+    NL_TEST_DEF("Don't share across security settings",  TestBindingConnectionPool_AuthMismatchNotShared),
+    NL_TEST_DEF("Release a connection closed on its established event",  TestBindingConnectionPool_CloseOnConnectionEstablished),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gTestBindingConnectionPool.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gTestBindingConnectionPool.TearDownTest();
+
+    return 0;
+}
+
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-BindingConnectionPool",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // !WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_BINDING_CONNECTION_POOL
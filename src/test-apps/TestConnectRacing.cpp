@@ -0,0 +1,741 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the racing of outbound Weave
+ *      connections across the addresses of a peer, and for the history of
+ *      recent connects that orders the addresses.
+ *
+ *      The racing tests connect over loopback to listeners owned by the
+ *      test, and hand the connection its peer addresses directly, as a
+ *      completed name resolution would.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+#if WEAVE_CONFIG_CONNECT_RACING
+
+namespace nl {
+namespace Weave {
+
+class TestConnectRacing
+{
+public:
+    TestConnectRacing();
+
+    void SetupTest(nlTestSuite *inSuite);
+    void TearDownTest(void);
+
+    void TestHistoryRanking(nlTestSuite *inSuite, void *inContext);
+    void TestHistoryEviction(nlTestSuite *inSuite, void *inContext);
+    void TestLatencyHistogram(nlTestSuite *inSuite, void *inContext);
+#if INET_CONFIG_ENABLE_IPV4
+    void TestAddressOrdering(nlTestSuite *inSuite, void *inContext);
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+    void TestFirstFailsSecondWins(nlTestSuite *inSuite, void *inContext);
+    void TestLoserClosed(nlTestSuite *inSuite, void *inContext);
+    void TestAllAttemptsFail(nlTestSuite *inSuite, void *inContext);
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+#endif // INET_CONFIG_ENABLE_IPV4
+
+private:
+    enum
+    {
+        // Nothing else listens here, so connects to addresses without a listener are refused
+        kTestPort = WEAVE_PORT + 25,
+
+        kMaxNumListeners = 2,
+        kMaxNumAccepted = 4,
+
+        kConnectTimeoutMsec = 2000,
+    };
+
+    nlTestSuite *mSuite;
+
+    WeaveConnection *mCon;
+    bool mComplete;
+    WEAVE_ERROR mConErr;
+    bool mAttemptsLeftOnComplete;
+    TCPEndPoint *mRaced[WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS];
+    bool mLoserRetainedOnComplete;
+
+    TCPEndPoint *mListeners[kMaxNumListeners];
+    size_t mNumListeners;
+    TCPEndPoint *mAccepted[kMaxNumAccepted];
+    size_t mNumAccepted;
+
+    static IPAddress Address(const char *aAddr);
+    void ExpectOrder(nlTestSuite *inSuite, const char * const aExpected[], size_t aNumExpected);
+    void SetPeerAddresses(const char * const aAddrs[], size_t aNumAddrs);
+    WEAVE_ERROR Listen(IPAddressType aAddrType, const char *aAddr);
+    WEAVE_ERROR StartRace(const char * const aAddrs[], size_t aNumAddrs);
+    void ServiceUntilComplete(void);
+
+    static void HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr);
+    static void HandleConnectionReceived(TCPEndPoint *listeningEndPoint, TCPEndPoint *conEndPoint,
+                                         const IPAddress &peerAddr, uint16_t peerPort);
+};
+
+TestConnectRacing::TestConnectRacing() :
+    mSuite(NULL),
+    mCon(NULL),
+    mNumListeners(0),
+    mNumAccepted(0)
+{
+}
+
+void TestConnectRacing::SetupTest(nlTestSuite *inSuite)
+{
+    mSuite = inSuite;
+
+    mCon = NULL;
+    mComplete = false;
+    mConErr = WEAVE_NO_ERROR;
+    mAttemptsLeftOnComplete = false;
+    mLoserRetainedOnComplete = false;
+
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+    {
+        mRaced[i] = NULL;
+    }
+
+    mNumListeners = 0;
+    mNumAccepted = 0;
+
+    MessageLayer.ConnectHistory.Init();
+}
+
+void TestConnectRacing::TearDownTest(void)
+{
+    if (mCon != NULL)
+    {
+        mCon->Abort();
+        mCon = NULL;
+    }
+
+    for (size_t i = 0; i < mNumAccepted; i++)
+    {
+        mAccepted[i]->Free();
+    }
+    mNumAccepted = 0;
+
+    for (size_t i = 0; i < mNumListeners; i++)
+    {
+        mListeners[i]->Free();
+    }
+    mNumListeners = 0;
+}
+
+IPAddress TestConnectRacing::Address(const char *aAddr)
+{
+    IPAddress addr = IPAddress::Any;
+
+    IPAddress::FromString(aAddr, addr);
+
+    return addr;
+}
+
+/**
+ * Checks the order the connection would race its peer addresses in, taking
+ * each address the way TryNextPeerAddress() does.
+ */
+void TestConnectRacing::ExpectOrder(nlTestSuite *inSuite, const char * const aExpected[], size_t aNumExpected)
+{
+    for (size_t i = 0; i < aNumExpected; i++)
+    {
+        int next = mCon->SelectNextPeerAddress();
+
+        NL_TEST_ASSERT(inSuite, next >= 0);
+        VerifyOrExit(next >= 0, );
+
+        NL_TEST_ASSERT(inSuite, mCon->mPeerAddrs[next] == Address(aExpected[i]));
+
+        mCon->PeerAddr = mCon->mPeerAddrs[next];
+        mCon->mPeerAddrs[next] = IPAddress::Any;
+    }
+
+    NL_TEST_ASSERT(inSuite, mCon->SelectNextPeerAddress() < 0);
+
+exit:
+    return;
+}
+
+void TestConnectRacing::SetPeerAddresses(const char * const aAddrs[], size_t aNumAddrs)
+{
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_IP_ADDRS; i++)
+    {
+        mCon->mPeerAddrs[i] = (i < aNumAddrs) ? Address(aAddrs[i]) : IPAddress::Any;
+    }
+
+    mCon->mPeerAddrsPort = kTestPort;
+}
+
+WEAVE_ERROR TestConnectRacing::Listen(IPAddressType aAddrType, const char *aAddr)
+{
+    WEAVE_ERROR err;
+    TCPEndPoint *endPoint = NULL;
+
+    VerifyOrExit(mNumListeners < kMaxNumListeners, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = ::Inet.NewTCPEndPoint(&endPoint);
+    SuccessOrExit(err);
+
+    err = endPoint->Bind(aAddrType, Address(aAddr), kTestPort, true);
+    SuccessOrExit(err);
+
+    endPoint->AppState = this;
+    endPoint->OnConnectionReceived = HandleConnectionReceived;
+
+    err = endPoint->Listen(kMaxNumAccepted);
+    SuccessOrExit(err);
+
+    mListeners[mNumListeners++] = endPoint;
+    endPoint = NULL;
+
+exit:
+    if (endPoint != NULL)
+    {
+        endPoint->Free();
+    }
+    return err;
+}
+
+/**
+ * Hands a new connection its peer addresses, as a completed name resolution
+ * would, and starts racing them.
+ */
+WEAVE_ERROR TestConnectRacing::StartRace(const char * const aAddrs[], size_t aNumAddrs)
+{
+    WEAVE_ERROR err;
+
+    mCon = MessageLayer.NewConnection();
+    VerifyOrExit(mCon != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    mCon->AppState = this;
+    mCon->OnConnectionComplete = HandleConnectionComplete;
+
+    mCon->NetworkType = WeaveConnection::kNetworkType_IP;
+    mCon->PeerNodeId = kNodeIdNotSpecified;
+    mCon->AuthMode = kWeaveAuthMode_Unauthenticated;
+    mCon->mConnectTimeout = kConnectTimeoutMsec;
+    SetPeerAddresses(aAddrs, aNumAddrs);
+
+    // Held until the connection closes, as Connect() would
+    mCon->mRefCount++;
+    mCon->State = WeaveConnection::kState_Resolving;
+
+    err = mCon->TryNextPeerAddress(WEAVE_NO_ERROR);
+
+exit:
+    return err;
+}
+
+void TestConnectRacing::ServiceUntilComplete(void)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kConnectTimeoutMsec;
+
+    while (!mComplete && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    }
+}
+
+void TestConnectRacing::HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr)
+{
+    TestConnectRacing *test = static_cast<TestConnectRacing *>(con->AppState);
+
+    test->mComplete = true;
+    test->mConErr = conErr;
+    test->mAttemptsLeftOnComplete = con->HasConnectAttempts();
+
+    // The losing end points have to be gone by the time the winner is reported
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+    {
+        TCPEndPoint *endPoint = test->mRaced[i];
+
+        if (endPoint != NULL && endPoint != con->mTcpEndPoint && endPoint->IsRetained(SystemLayer))
+        {
+            test->mLoserRetainedOnComplete = true;
+        }
+    }
+}
+
+void TestConnectRacing::HandleConnectionReceived(TCPEndPoint *listeningEndPoint, TCPEndPoint *conEndPoint,
+                                                 const IPAddress &peerAddr, uint16_t peerPort)
+{
+    TestConnectRacing *test = static_cast<TestConnectRacing *>(listeningEndPoint->AppState);
+
+    // Hold on to accepted connections until the test ends, so that the winner isn't closed by its peer
+    if (test->mNumAccepted < kMaxNumAccepted)
+    {
+        test->mAccepted[test->mNumAccepted++] = conEndPoint;
+    }
+    else
+    {
+        conEndPoint->Free();
+    }
+}
+
+/**
+ * Destinations whose last connect succeeded rank first, by their smoothed
+ * latency, followed by those with no history, followed by those whose
+ * connects failed, by the number of failures.
+ */
+void TestConnectRacing::TestHistoryRanking(nlTestSuite *inSuite, void *inContext)
+{
+    WeaveConnectHistory history;
+    const IPAddress fast = Address("fd00:0:1:1::1");
+    const IPAddress slow = Address("fd00:0:1:1::2");
+    const IPAddress failing = Address("fd00:0:1:1::3");
+    const IPAddress unknown = Address("fd00:0:1:1::4");
+
+    history.Init();
+
+    NL_TEST_ASSERT(inSuite, history.GetRank(fast, kTestPort) == UINT16_MAX);
+
+    history.RecordSuccess(fast, kTestPort, 20);
+    history.RecordSuccess(slow, kTestPort, 200);
+    history.RecordFailure(failing, kTestPort);
+
+    NL_TEST_ASSERT(inSuite, history.GetRank(fast, kTestPort) == 20);
+    NL_TEST_ASSERT(inSuite, history.GetRank(slow, kTestPort) == 200);
+    NL_TEST_ASSERT(inSuite, history.GetRank(unknown, kTestPort) == UINT16_MAX);
+    NL_TEST_ASSERT(inSuite, history.GetRank(failing, kTestPort) == UINT16_MAX + 1);
+
+    // The history is per port
+    NL_TEST_ASSERT(inSuite, history.GetRank(fast, kTestPort + 1) == UINT16_MAX);
+
+    // Each failure ranks the destination further back
+    history.RecordFailure(failing, kTestPort);
+    NL_TEST_ASSERT(inSuite, history.GetRank(failing, kTestPort) == UINT16_MAX + 2);
+
+    // A new sample carries a quarter of the weight
+    history.RecordSuccess(fast, kTestPort, 100);
+    NL_TEST_ASSERT(inSuite, history.GetRank(fast, kTestPort) == (3 * 20 + 100) / 4);
+
+    // A failure ranks a destination behind those without history, and the next success brings it back
+    history.RecordFailure(slow, kTestPort);
+    NL_TEST_ASSERT(inSuite, history.GetRank(slow, kTestPort) == UINT16_MAX + 1);
+
+    history.RecordSuccess(slow, kTestPort, 40);
+    NL_TEST_ASSERT(inSuite, history.GetRank(slow, kTestPort) == (3 * 200 + 40) / 4);
+
+    // A connect that took no measurable time still ranks as a success
+    history.RecordSuccess(unknown, kTestPort, 0);
+    NL_TEST_ASSERT(inSuite, history.GetRank(unknown, kTestPort) == 1);
+
+    history.Init();
+    NL_TEST_ASSERT(inSuite, history.GetRank(fast, kTestPort) == UINT16_MAX);
+    NL_TEST_ASSERT(inSuite, history.GetRank(failing, kTestPort) == UINT16_MAX);
+}
+
+/**
+ * A full history makes room for a new destination by forgetting the one
+ * least recently used.
+ */
+void TestConnectRacing::TestHistoryEviction(nlTestSuite *inSuite, void *inContext)
+{
+    WeaveConnectHistory history;
+    const IPAddress addr = Address("fd00:0:1:1::1");
+
+    history.Init();
+
+    for (uint16_t i = 0; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+    {
+        history.RecordFailure(addr, kTestPort + i);
+    }
+
+    // Use the oldest entry again, leaving the second oldest as the least recently used
+    history.RecordSuccess(addr, kTestPort, 30);
+
+    history.RecordFailure(addr, kTestPort + WEAVE_CONFIG_CONNECT_HISTORY_SIZE);
+
+    NL_TEST_ASSERT(inSuite, history.GetRank(addr, kTestPort) == 30);
+    NL_TEST_ASSERT(inSuite, history.GetRank(addr, kTestPort + 1) == UINT16_MAX);
+    NL_TEST_ASSERT(inSuite, history.GetRank(addr, kTestPort + WEAVE_CONFIG_CONNECT_HISTORY_SIZE) == UINT16_MAX + 1);
+
+    for (uint16_t i = 2; i < WEAVE_CONFIG_CONNECT_HISTORY_SIZE; i++)
+    {
+        NL_TEST_ASSERT(inSuite, history.GetRank(addr, kTestPort + i) == UINT16_MAX + 1);
+    }
+}
+
+/**
+ * Successful connects are counted in the bucket of their latency; failures
+ * are not counted, and resetting the histogram keeps the destinations.
+ */
+void TestConnectRacing::TestLatencyHistogram(nlTestSuite *inSuite, void *inContext)
+{
+    WeaveConnectHistory history;
+    WeaveConnectHistory::LatencyHistogram histogram;
+    const IPAddress addr = Address("fd00:0:1:1::1");
+    const uint32_t latencies[] = { 0, 49, 50, 99, 100, 2499, 2500, 4999, 5000, 60000, 100000 };
+    const uint32_t expected[WeaveConnectHistory::kLatencyBucketCount] = { 2, 2, 1, 0, 0, 1, 2, 3 };
+
+    history.Init();
+
+    history.GetLatencyHistogram(histogram);
+    for (size_t i = 0; i < WeaveConnectHistory::kLatencyBucketCount; i++)
+    {
+        NL_TEST_ASSERT(inSuite, histogram.Counts[i] == 0);
+    }
+
+    for (size_t i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++)
+    {
+        history.RecordSuccess(addr, kTestPort, latencies[i]);
+    }
+    history.RecordFailure(addr, kTestPort);
+
+    history.GetLatencyHistogram(histogram);
+    for (size_t i = 0; i < WeaveConnectHistory::kLatencyBucketCount; i++)
+    {
+        NL_TEST_ASSERT(inSuite, histogram.Counts[i] == expected[i]);
+    }
+
+    history.ResetLatencyHistogram();
+
+    history.GetLatencyHistogram(histogram);
+    for (size_t i = 0; i < WeaveConnectHistory::kLatencyBucketCount; i++)
+    {
+        NL_TEST_ASSERT(inSuite, histogram.Counts[i] == 0);
+    }
+
+    NL_TEST_ASSERT(inSuite, history.GetRank(addr, kTestPort) == UINT16_MAX + 1);
+}
+
+#if INET_CONFIG_ENABLE_IPV4
+
+/**
+ * Addresses that rank the same alternate between the families, starting
+ * with IPv6; history moves a recent success to the front and a recent
+ * failure to the back.
+ */
+void TestConnectRacing::TestAddressOrdering(nlTestSuite *inSuite, void *inContext)
+{
+    static const char * const addrs[] = { "10.0.0.1", "10.0.0.2", "2001:db8::1", "2001:db8::2" };
+    static const char * const noHistoryOrder[] = { "2001:db8::1", "10.0.0.1", "2001:db8::2", "10.0.0.2" };
+    static const char * const historyOrder[] = { "10.0.0.2", "2001:db8::2", "10.0.0.1", "2001:db8::1" };
+
+    mCon = MessageLayer.NewConnection();
+    NL_TEST_ASSERT(inSuite, mCon != NULL);
+    VerifyOrExit(mCon != NULL, );
+
+    SetPeerAddresses(addrs, 4);
+    ExpectOrder(inSuite, noHistoryOrder, 4);
+
+    MessageLayer.ConnectHistory.RecordFailure(Address("2001:db8::1"), kTestPort);
+    MessageLayer.ConnectHistory.RecordSuccess(Address("10.0.0.2"), kTestPort, 30);
+
+    mCon->PeerAddr = IPAddress::Any;
+    SetPeerAddresses(addrs, 4);
+    ExpectOrder(inSuite, historyOrder, 4);
+
+exit:
+    return;
+}
+
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+/**
+ * When the first address raced is refused, the next one is raced at once
+ * and wins, and the history learns from both.
+ */
+void TestConnectRacing::TestFirstFailsSecondWins(nlTestSuite *inSuite, void *inContext)
+{
+    static const char * const addrs[] = { "127.0.0.1", "::1" };
+    WEAVE_ERROR err;
+
+    // Only the IPv4 address, which is raced second, has a listener
+    err = Listen(kIPAddressType_IPv4, "127.0.0.1");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = StartRace(addrs, 2);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    NL_TEST_ASSERT(inSuite, mCon->PeerAddr == Address("::1"));
+
+    ServiceUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, mComplete);
+    NL_TEST_ASSERT(inSuite, mConErr == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, !mAttemptsLeftOnComplete);
+    NL_TEST_ASSERT(inSuite, mCon->State == WeaveConnection::kState_Connected);
+    NL_TEST_ASSERT(inSuite, mCon->PeerAddr == Address("127.0.0.1"));
+    NL_TEST_ASSERT(inSuite, mCon->PeerPort == kTestPort);
+    NL_TEST_ASSERT(inSuite, mCon->mTcpEndPoint != NULL);
+    NL_TEST_ASSERT(inSuite, !mCon->HasConnectAttempts());
+
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(Address("::1"), kTestPort) == UINT16_MAX + 1);
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(Address("127.0.0.1"), kTestPort) < UINT16_MAX);
+
+exit:
+    return;
+}
+
+/**
+ * With two attempts in flight, the first to connect wins and the other is
+ * aborted and its end point freed before the connection is reported.
+ */
+void TestConnectRacing::TestLoserClosed(nlTestSuite *inSuite, void *inContext)
+{
+    static const char * const addrs[] = { "127.0.0.1", "::1" };
+    WEAVE_ERROR err;
+    size_t numRaced = 0;
+
+    err = Listen(kIPAddressType_IPv4, "127.0.0.1");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = Listen(kIPAddressType_IPv6, "::1");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = StartRace(addrs, 2);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    // Race the second address without waiting for the attempt delay
+    WeaveConnection::HandleConnectAttemptDelay(&SystemLayer, mCon, WEAVE_SYSTEM_NO_ERROR);
+
+    for (size_t i = 0; i < WEAVE_CONFIG_CONNECT_RACING_MAX_ATTEMPTS; i++)
+    {
+        mRaced[i] = mCon->mConnectAttempts[i].EndPoint;
+        if (mRaced[i] != NULL)
+        {
+            numRaced++;
+        }
+    }
+
+    NL_TEST_ASSERT(inSuite, numRaced == 2);
+    NL_TEST_ASSERT(inSuite, mCon->SelectNextPeerAddress() < 0);
+
+    ServiceUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, mComplete);
+    NL_TEST_ASSERT(inSuite, mConErr == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, !mAttemptsLeftOnComplete);
+    NL_TEST_ASSERT(inSuite, !mLoserRetainedOnComplete);
+    NL_TEST_ASSERT(inSuite, mCon->mTcpEndPoint == mRaced[0] || mCon->mTcpEndPoint == mRaced[1]);
+    NL_TEST_ASSERT(inSuite, mCon->PeerAddr == Address("127.0.0.1") || mCon->PeerAddr == Address("::1"));
+
+    // Only the winner was recorded; the loser has no outcome to learn from
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(mCon->PeerAddr, kTestPort) < UINT16_MAX);
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(Address("127.0.0.1"), kTestPort) == UINT16_MAX ||
+                            MessageLayer.ConnectHistory.GetRank(Address("::1"), kTestPort) == UINT16_MAX);
+
+exit:
+    return;
+}
+
+/**
+ * The connection fails only once every address has failed.
+ */
+void TestConnectRacing::TestAllAttemptsFail(nlTestSuite *inSuite, void *inContext)
+{
+    static const char * const addrs[] = { "127.0.0.1", "::1" };
+    WEAVE_ERROR err;
+
+    err = StartRace(addrs, 2);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    ServiceUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, mComplete);
+    NL_TEST_ASSERT(inSuite, mConErr != WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, !mAttemptsLeftOnComplete);
+    NL_TEST_ASSERT(inSuite, mCon->State == WeaveConnection::kState_Closed);
+
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(Address("127.0.0.1"), kTestPort) == UINT16_MAX + 1);
+    NL_TEST_ASSERT(inSuite, MessageLayer.ConnectHistory.GetRank(Address("::1"), kTestPort) == UINT16_MAX + 1);
+
+exit:
+    return;
+}
+
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+#endif // INET_CONFIG_ENABLE_IPV4
+
+} // namespace Weave
+} // namespace nl
+
+using namespace nl::Weave;
+
+// Test Suite
+
+static TestConnectRacing gTestConnectRacing;
+
+static void TestConnectRacing_HistoryRanking(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestHistoryRanking(inSuite, inContext);
+}
+
+static void TestConnectRacing_HistoryEviction(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestHistoryEviction(inSuite, inContext);
+}
+
+static void TestConnectRacing_LatencyHistogram(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestLatencyHistogram(inSuite, inContext);
+}
+
+#if INET_CONFIG_ENABLE_IPV4
+static void TestConnectRacing_AddressOrdering(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestAddressOrdering(inSuite, inContext);
+}
+
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+static void TestConnectRacing_FirstFailsSecondWins(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestFirstFailsSecondWins(inSuite, inContext);
+}
+
+static void TestConnectRacing_LoserClosed(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestLoserClosed(inSuite, inContext);
+}
+
+static void TestConnectRacing_AllAttemptsFail(nlTestSuite *inSuite, void *inContext)
+{
+    gTestConnectRacing.TestAllAttemptsFail(inSuite, inContext);
+}
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+#endif // INET_CONFIG_ENABLE_IPV4
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Rank destinations by connect history",  TestConnectRacing_HistoryRanking),
+    NL_TEST_DEF("Evict the least recently used destination",  TestConnectRacing_HistoryEviction),
+    NL_TEST_DEF("Count connect latencies in buckets",  TestConnectRacing_LatencyHistogram),
+#if INET_CONFIG_ENABLE_IPV4
+    NL_TEST_DEF("Order peer addresses by history and family",  TestConnectRacing_AddressOrdering),
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+    NL_TEST_DEF("Win with the second address when the first fails",  TestConnectRacing_FirstFailsSecondWins),
+    NL_TEST_DEF("Close the losing attempt",  TestConnectRacing_LoserClosed),
+    NL_TEST_DEF("Fail once all attempts fail",  TestConnectRacing_AllAttemptsFail),
+#endif // WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+#endif // INET_CONFIG_ENABLE_IPV4
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gTestConnectRacing.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gTestConnectRacing.TearDownTest();
+
+    return 0;
+}
+
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-ConnectRacing",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // !WEAVE_CONFIG_CONNECT_RACING
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_CONNECT_RACING
@@ -70,6 +70,27 @@ static void HandleResolutionComplete(void *appState, INET_ERROR err, uint8_t add
 static void ServiceNetworkUntilDone(uint32_t timeoutMS);
 static void HandleSIGUSR1(int sig);
 
+#if INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+#define STUB_SERVER_PORT                              (53535)
+#define STUB_SERVER_TTL_SECS                          (1)
+
+// The number of queries the DNS client sends to look up both address families.
+#if INET_CONFIG_ENABLE_IPV4
+constexpr uint32_t kQueriesPerLookup = 2;
+#else
+constexpr uint32_t kQueriesPerLookup = 1;
+#endif
+
+static UDPEndPoint *sStubServerEndPoint = NULL;
+static uint32_t sStubServerQueryCount = 0;
+
+static void StartStubServer(nlTestSuite * testSuite);
+static void StopStubServer(void);
+static void HandleStubServerQuery(UDPEndPoint *endPoint, PacketBuffer *msg, const IPPacketInfo *pktInfo);
+
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
 /**
  * Test basic name resolution functionality.
  */
@@ -471,6 +492,223 @@ static void TestDNSResolution_Simultaneous(nlTestSuite *testSuite, void *inConte
     NL_TEST_ASSERT(testSuite, sNumResInProgress == 0);
 }
 
+#if INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+/**
+ * Test that results from the DNS client are cached for their time-to-live.
+ */
+static void TestDNSClient_Cache(nlTestSuite * testSuite, void * testContext)
+{
+    const DNSResolutionTestCase testCase
+    {
+        "cached.weave.test",
+        kDNSOption_Default,
+        kMaxResults,
+        INET_NO_ERROR,
+        INET_CONFIG_ENABLE_IPV4,
+        true
+    };
+    uint32_t queryCount;
+
+    StartStubServer(testSuite);
+
+    // The first resolution queries the server.
+    queryCount = sStubServerQueryCount;
+    RunTestCase(testSuite, testCase);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount + kQueriesPerLookup);
+
+    // A second resolution is answered from the cache.
+    queryCount = sStubServerQueryCount;
+    RunTestCase(testSuite, testCase);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount);
+
+    // Once the records expire, the server is queried again.
+    Done = false;
+    ServiceNetworkUntilDone(STUB_SERVER_TTL_SECS * 1000 + 500);
+
+    queryCount = sStubServerQueryCount;
+    RunTestCase(testSuite, testCase);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount + kQueriesPerLookup);
+
+    StopStubServer();
+}
+
+/**
+ * Test that non-existent names are cached.
+ */
+static void TestDNSClient_NegativeCache(nlTestSuite * testSuite, void * testContext)
+{
+    const DNSResolutionTestCase testCase
+    {
+        "missing.weave.test",
+        kDNSOption_Default,
+        kMaxResults,
+        INET_ERROR_HOST_NOT_FOUND,
+        false,
+        false
+    };
+    uint32_t queryCount;
+
+    StartStubServer(testSuite);
+
+    queryCount = sStubServerQueryCount;
+    RunTestCase(testSuite, testCase);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount + kQueriesPerLookup);
+
+    queryCount = sStubServerQueryCount;
+    RunTestCase(testSuite, testCase);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount);
+
+    StopStubServer();
+}
+
+/**
+ * Test that simultaneous resolutions of the same name share a single lookup.
+ */
+static void TestDNSClient_Simultaneous(nlTestSuite * testSuite, void * inContext)
+{
+    const DNSResolutionTestCase testCase
+    {
+        "shared.weave.test",
+        kDNSOption_Default,
+        kMaxResults,
+        INET_NO_ERROR,
+        INET_CONFIG_ENABLE_IPV4,
+        true
+    };
+    DNSResolutionTestContext tests[] =
+    {
+        { testSuite, testCase },
+        { testSuite, testCase },
+        { testSuite, testCase }
+    };
+    uint32_t queryCount;
+
+    StartStubServer(testSuite);
+
+    queryCount = sStubServerQueryCount;
+
+    for (DNSResolutionTestContext & testContext : tests)
+    {
+        StartTestCase(testContext);
+    }
+
+    ServiceNetworkUntilDone(DEFAULT_TEST_DURATION_MILLISECS);
+
+    NL_TEST_ASSERT(testSuite, Done == true);
+    NL_TEST_ASSERT(testSuite, sNumResInProgress == 0);
+    NL_TEST_ASSERT(testSuite, sStubServerQueryCount == queryCount + kQueriesPerLookup);
+
+    StopStubServer();
+}
+
+/**
+ * Start a name server on the loopback interface, and direct the DNS client to it.
+ */
+static void StartStubServer(nlTestSuite * testSuite)
+{
+    INET_ERROR err;
+    IPAddress serverAddr;
+
+    err = Inet.NewUDPEndPoint(&sStubServerEndPoint);
+    NL_TEST_ASSERT(testSuite, err == INET_NO_ERROR);
+    SuccessOrExit(err);
+
+    sStubServerEndPoint->OnMessageReceived = reinterpret_cast<IPEndPointBasis::OnMessageReceivedFunct>(HandleStubServerQuery);
+
+    err = sStubServerEndPoint->Bind(kIPAddressType_IPv6, IPAddress::Any, STUB_SERVER_PORT);
+    NL_TEST_ASSERT(testSuite, err == INET_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = sStubServerEndPoint->Listen();
+    NL_TEST_ASSERT(testSuite, err == INET_NO_ERROR);
+    SuccessOrExit(err);
+
+    IPAddress::FromString("::1", serverAddr);
+
+    err = Inet.SetDNSServers(1, &serverAddr, STUB_SERVER_PORT);
+    NL_TEST_ASSERT(testSuite, err == INET_NO_ERROR);
+
+exit:
+    return;
+}
+
+static void StopStubServer(void)
+{
+    Inet.SetDNSServers(0, NULL);
+
+    if (sStubServerEndPoint != NULL)
+    {
+        sStubServerEndPoint->Free();
+        sStubServerEndPoint = NULL;
+    }
+}
+
+/**
+ * Answer a query with an A or AAAA record, unless the name starts with "missing", in which case the name
+ * doesn't exist.
+ */
+static void HandleStubServerQuery(UDPEndPoint *endPoint, PacketBuffer *msg, const IPPacketInfo *pktInfo)
+{
+    uint8_t *p = msg->Start();
+    uint16_t msgLen = msg->DataLength();
+    uint16_t offset = 12;
+    uint16_t qType;
+    bool missing;
+
+    sStubServerQueryCount++;
+
+    VerifyOrExit(msgLen > offset + 4, /* no-op */);
+
+    missing = (p[offset] == 7 && memcmp(&p[offset + 1], "missing", 7) == 0);
+
+    // Skip the (uncompressed) question name.
+    while (offset < msgLen && p[offset] != 0)
+        offset += p[offset] + 1;
+    offset++;
+    VerifyOrExit(offset + 4 <= msgLen, /* no-op */);
+
+    qType = nl::Weave::Encoding::BigEndian::Get16(&p[offset]);
+    offset += 4;
+
+    // Turn the query into a response, with no additional records.
+    nl::Weave::Encoding::BigEndian::Put16(&p[2], missing ? 0x8183 : 0x8180);
+    nl::Weave::Encoding::BigEndian::Put16(&p[6], missing ? 0 : 1);
+    nl::Weave::Encoding::BigEndian::Put16(&p[10], 0);
+
+    if (!missing)
+    {
+        static const uint8_t kIPv4Addr[] = { 192, 0, 2, 1 };
+        static const uint8_t kIPv6Addr[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+        const uint8_t *addr = (qType == 28) ? kIPv6Addr : kIPv4Addr;
+        const uint16_t addrLen = (qType == 28) ? sizeof(kIPv6Addr) : sizeof(kIPv4Addr);
+        uint8_t *answer = &p[offset];
+
+        VerifyOrExit(msg->AvailableDataLength() >= 12 + addrLen, /* no-op */);
+
+        nl::Weave::Encoding::BigEndian::Write16(answer, 0xC00C); // Pointer to the question name
+        nl::Weave::Encoding::BigEndian::Write16(answer, qType);
+        nl::Weave::Encoding::BigEndian::Write16(answer, 1); // IN
+        nl::Weave::Encoding::BigEndian::Write32(answer, STUB_SERVER_TTL_SECS);
+        nl::Weave::Encoding::BigEndian::Write16(answer, addrLen);
+        memcpy(answer, addr, addrLen);
+        answer += addrLen;
+
+        offset = (uint16_t)(answer - p);
+    }
+
+    msg->SetDataLength(offset);
+
+    endPoint->SendTo(pktInfo->SrcAddress, pktInfo->SrcPort, msg);
+    msg = NULL;
+
+exit:
+    if (msg != NULL)
+        PacketBuffer::Free(msg);
+}
+
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
 static void RunTestCase(nlTestSuite * testSuite, const DNSResolutionTestCase & testCase)
 {
     DNSResolutionTestContext testContext {
@@ -670,6 +908,11 @@ int main(int argc, char *argv[])
         NL_TEST_DEF("TestDNSResolution:NoHostRecord", TestDNSResolution_NoHostRecord),
         NL_TEST_DEF("TestDNSResolution:Cancel", TestDNSResolution_Cancel),
         NL_TEST_DEF("TestDNSResolution:Simultaneous", TestDNSResolution_Simultaneous),
+#if INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+        NL_TEST_DEF("TestDNSClient:Cache", TestDNSClient_Cache),
+        NL_TEST_DEF("TestDNSClient:NegativeCache", TestDNSClient_NegativeCache),
+        NL_TEST_DEF("TestDNSClient:Simultaneous", TestDNSClient_Simultaneous),
+#endif // INET_CONFIG_ENABLE_DNS_CLIENT && WEAVE_SYSTEM_CONFIG_USE_SOCKETS
         NL_TEST_SENTINEL()
     };
 
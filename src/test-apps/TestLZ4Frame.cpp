@@ -0,0 +1,333 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a unit test suite for the Weave LZ4
+ *      frame encoder and decoder.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <nlunit-test.h>
+
+#include <Weave/Support/LZ4Frame.h>
+
+using namespace nl::Weave;
+
+enum
+{
+    kTestDataSize       = 48 * 1024,
+    kWriterWindowSize   = 4096,
+    kWriterBlockSize    = 1024,
+    kHashTableBits      = 10,
+    kReaderWindowSize   = 128 * 1024,
+    kReaderBlockSize    = 64 * 1024,
+};
+
+struct TestContext
+{
+    uint8_t mData[kTestDataSize];
+    uint8_t mFrame[kTestDataSize + kTestDataSize / kWriterBlockSize * LZ4FrameWriter::kBlockHeaderLength + 64];
+    uint8_t mDecoded[kTestDataSize];
+    uint32_t mFrameLen;
+    uint32_t mDecodedLen;
+
+    uint8_t mWriterWindow[kWriterWindowSize];
+    uint16_t mHashTable[1 << kHashTableBits];
+    uint8_t mReaderWindow[kReaderWindowSize];
+    uint8_t mReaderBlock[kReaderBlockSize];
+};
+
+static TestContext sContext;
+
+// "weave event log weave event log weave event log 0123456789 weave event log!\n" compressed by the reference lz4 tool,
+// with independent blocks and a content checksum.
+static const uint8_t sReferenceFrame[] =
+{
+    0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x28, 0x00, 0x00, 0x00, 0xff,
+    0x01, 0x77, 0x65, 0x61, 0x76, 0x65, 0x20, 0x65, 0x76, 0x65, 0x6e, 0x74,
+    0x20, 0x6c, 0x6f, 0x67, 0x20, 0x10, 0x00, 0x0d, 0xa9, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x2b, 0x00, 0x50, 0x6c, 0x6f,
+    0x67, 0x21, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x75, 0x1a, 0x5b
+};
+
+static const char sReferenceText[] = "weave event log weave event log weave event log 0123456789 weave event log!\n";
+
+static WEAVE_ERROR CollectOutput(void *aAppState, const uint8_t *aData, uint32_t aDataLen)
+{
+    TestContext *theContext = static_cast<TestContext *>(aAppState);
+
+    if (theContext->mDecodedLen + aDataLen > sizeof(theContext->mDecoded))
+        return WEAVE_ERROR_BUFFER_TOO_SMALL;
+
+    memcpy(theContext->mDecoded + theContext->mDecodedLen, aData, aDataLen);
+    theContext->mDecodedLen += aDataLen;
+
+    return WEAVE_NO_ERROR;
+}
+
+// Text shaped like a stream of logged events: repetitive structure with varying values.
+static void FillEventLikeData(TestContext *theContext)
+{
+    uint32_t pos = 0;
+
+    for (uint32_t i = 0; pos < sizeof(theContext->mData); i++)
+    {
+        char line[64];
+        int len = snprintf(line, sizeof(line), "{event:%u,importance:%u,ts:%u,value:%u}", i, i % 4, 1000000 + i * 37,
+                           (i * 2654435761U) >> 20);
+
+        for (int j = 0; j < len && pos < sizeof(theContext->mData); j++)
+            theContext->mData[pos++] = static_cast<uint8_t>(line[j]);
+    }
+}
+
+static void FillRandomData(TestContext *theContext)
+{
+    uint32_t state = 12345;
+
+    for (uint32_t i = 0; i < sizeof(theContext->mData); i++)
+    {
+        state = state * 1103515245 + 12345;
+        theContext->mData[i] = static_cast<uint8_t>(state >> 16);
+    }
+}
+
+static WEAVE_ERROR EncodeFrame(TestContext *theContext, uint32_t aDataLen, uint16_t aBlockSize)
+{
+    WEAVE_ERROR err;
+    LZ4FrameWriter writer;
+    uint16_t outLen;
+
+    err = writer.Init(theContext->mWriterWindow, sizeof(theContext->mWriterWindow), aBlockSize, theContext->mHashTable,
+                      kHashTableBits);
+    if (err != WEAVE_NO_ERROR)
+        return err;
+
+    theContext->mFrameLen = LZ4FrameWriter::WriteHeader(theContext->mFrame);
+
+    for (uint32_t pos = 0; pos < aDataLen; pos += aBlockSize)
+    {
+        uint16_t len = (aDataLen - pos < aBlockSize) ? static_cast<uint16_t>(aDataLen - pos) : aBlockSize;
+
+        memcpy(writer.GetInputBuffer(), theContext->mData + pos, len);
+
+        err = writer.EncodeBlock(len, theContext->mFrame + theContext->mFrameLen,
+                                 static_cast<uint16_t>(LZ4FrameWriter::GetMaxEncodedLength(len)), outLen);
+        if (err != WEAVE_NO_ERROR)
+            return err;
+
+        theContext->mFrameLen += outLen;
+    }
+
+    theContext->mFrameLen += LZ4FrameWriter::WriteEndMark(theContext->mFrame + theContext->mFrameLen);
+
+    return WEAVE_NO_ERROR;
+}
+
+static WEAVE_ERROR DecodeFrame(TestContext *theContext, const uint8_t *aFrame, uint32_t aFrameLen, uint32_t aChunkSize,
+                               LZ4FrameReader &aReader)
+{
+    WEAVE_ERROR err;
+
+    theContext->mDecodedLen = 0;
+
+    err = aReader.Init(theContext->mReaderWindow, sizeof(theContext->mReaderWindow), theContext->mReaderBlock,
+                       sizeof(theContext->mReaderBlock));
+    if (err != WEAVE_NO_ERROR)
+        return err;
+
+    for (uint32_t pos = 0; pos < aFrameLen; pos += aChunkSize)
+    {
+        uint32_t len = (aFrameLen - pos < aChunkSize) ? aFrameLen - pos : aChunkSize;
+
+        err = aReader.Decode(aFrame + pos, len, CollectOutput, theContext);
+        if (err != WEAVE_NO_ERROR)
+            return err;
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+static void CheckRoundTrip(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    static const uint32_t chunkSizes[] = { 1, 7, 1000, kTestDataSize * 2 };
+    LZ4FrameReader reader;
+    WEAVE_ERROR err;
+
+    FillEventLikeData(theContext);
+
+    err = EncodeFrame(theContext, sizeof(theContext->mData), kWriterBlockSize);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, theContext->mFrameLen < sizeof(theContext->mData) / 2);
+
+    for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++)
+    {
+        err = DecodeFrame(theContext, theContext->mFrame, theContext->mFrameLen, chunkSizes[i], reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, reader.IsComplete());
+        NL_TEST_ASSERT(inSuite, theContext->mDecodedLen == sizeof(theContext->mData));
+        NL_TEST_ASSERT(inSuite, memcmp(theContext->mDecoded, theContext->mData, sizeof(theContext->mData)) == 0);
+    }
+}
+
+static void CheckSmallBlocks(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    static const uint16_t blockSizes[] = { 1, 13, 100, kWriterWindowSize };
+    LZ4FrameReader reader;
+    WEAVE_ERROR err;
+
+    FillEventLikeData(theContext);
+
+    for (size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); i++)
+    {
+        err = EncodeFrame(theContext, 3000, blockSizes[i]);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = DecodeFrame(theContext, theContext->mFrame, theContext->mFrameLen, 64, reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, reader.IsComplete());
+        NL_TEST_ASSERT(inSuite, theContext->mDecodedLen == 3000);
+        NL_TEST_ASSERT(inSuite, memcmp(theContext->mDecoded, theContext->mData, 3000) == 0);
+    }
+}
+
+static void CheckIncompressible(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    const uint32_t numBlocks = sizeof(theContext->mData) / kWriterBlockSize;
+    LZ4FrameReader reader;
+    WEAVE_ERROR err;
+
+    FillRandomData(theContext);
+
+    err = EncodeFrame(theContext, sizeof(theContext->mData), kWriterBlockSize);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Every block is sent stored, so the frame only grows by its framing.
+    NL_TEST_ASSERT(inSuite, theContext->mFrameLen == sizeof(theContext->mData) + LZ4FrameWriter::kFrameHeaderLength +
+                   numBlocks * LZ4FrameWriter::kBlockHeaderLength + LZ4FrameWriter::kEndMarkLength);
+
+    err = DecodeFrame(theContext, theContext->mFrame, theContext->mFrameLen, 333, reader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.IsComplete());
+    NL_TEST_ASSERT(inSuite, theContext->mDecodedLen == sizeof(theContext->mData));
+    NL_TEST_ASSERT(inSuite, memcmp(theContext->mDecoded, theContext->mData, sizeof(theContext->mData)) == 0);
+}
+
+static void CheckLinkedBlocks(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    LZ4FrameWriter writer;
+    uint8_t block[LZ4FrameWriter::kBlockHeaderLength + kWriterBlockSize];
+    uint16_t firstLen;
+    uint16_t secondLen;
+    WEAVE_ERROR err;
+
+    FillRandomData(theContext);
+
+    err = writer.Init(theContext->mWriterWindow, sizeof(theContext->mWriterWindow), kWriterBlockSize, theContext->mHashTable,
+                      kHashTableBits);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // A block repeating the previous one is encoded as a reference to it.
+    err = writer.EncodeBlock(theContext->mData, kWriterBlockSize, block, sizeof(block), firstLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.EncodeBlock(theContext->mData, kWriterBlockSize, block, sizeof(block), secondLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, firstLen == kWriterBlockSize + LZ4FrameWriter::kBlockHeaderLength);
+    NL_TEST_ASSERT(inSuite, secondLen < 32);
+
+    err = writer.EncodeBlock(theContext->mData, kWriterBlockSize, block, kWriterBlockSize, firstLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+}
+
+static void CheckReferenceFrame(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    LZ4FrameReader reader;
+    WEAVE_ERROR err;
+
+    err = DecodeFrame(theContext, sReferenceFrame, sizeof(sReferenceFrame), 5, reader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.IsComplete());
+    NL_TEST_ASSERT(inSuite, theContext->mDecodedLen == sizeof(sReferenceText) - 1);
+    NL_TEST_ASSERT(inSuite, memcmp(theContext->mDecoded, sReferenceText, sizeof(sReferenceText) - 1) == 0);
+}
+
+static void CheckCorruptFrame(nlTestSuite *inSuite, void *inContext)
+{
+    TestContext *theContext = static_cast<TestContext *>(inContext);
+    uint8_t frame[sizeof(sReferenceFrame)];
+    LZ4FrameReader reader;
+    WEAVE_ERROR err;
+
+    // Bad magic number.
+    memcpy(frame, sReferenceFrame, sizeof(frame));
+    frame[0] ^= 0xFF;
+    err = DecodeFrame(theContext, frame, sizeof(frame), sizeof(frame), reader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    // Match offset reaching before the start of the stream.
+    memcpy(frame, sReferenceFrame, sizeof(frame));
+    frame[29] = 0xFF;
+    frame[30] = 0x00;
+    err = DecodeFrame(theContext, frame, sizeof(frame), sizeof(frame), reader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    // Data after the end of the frame.
+    err = DecodeFrame(theContext, sReferenceFrame, sizeof(sReferenceFrame), sizeof(sReferenceFrame), reader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = reader.Decode(sReferenceFrame, 1, CollectOutput, theContext);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+}
+
+static const nlTest sTests[] = {
+    NL_TEST_DEF("round-trip",         CheckRoundTrip),
+    NL_TEST_DEF("small-blocks",       CheckSmallBlocks),
+    NL_TEST_DEF("incompressible",     CheckIncompressible),
+    NL_TEST_DEF("linked-blocks",      CheckLinkedBlocks),
+    NL_TEST_DEF("reference-frame",    CheckReferenceFrame),
+    NL_TEST_DEF("corrupt-frame",      CheckCorruptFrame),
+    NL_TEST_SENTINEL()
+};
+
+int main(void)
+{
+    nlTestSuite theSuite = {
+        "weave-lz4-frame",
+        &sTests[0]
+    };
+
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    nlTestRunner(&theSuite, &sContext);
+
+    return nlTestRunnerStats(&theSuite);
+}
@@ -85,6 +85,10 @@ class TraitPathStoreTest {
         TraitPathStore mStore;
         TraitPathStore::Record mStorage[10];
 
+        PropertyPathBitmap mBitmap;
+        PropertyPathBitmap::Word mBitmapWords[2];
+        PropertyPathHandle mKeyedPaths[2];
+
         TraitPath mPath;
         TraitDataHandle mTDH1;
         TraitDataHandle mTDH2;
@@ -102,12 +106,15 @@ class TraitPathStoreTest {
         void TestFlags(nlTestSuite *inSuite, void *inContext);
         void TestInsertItem(nlTestSuite *inSuite, void *inContext);
         void TestSetFailedTrait(nlTestSuite *inSuite, void *inContext);
+        void TestBitmapAddItem(nlTestSuite *inSuite, void *inContext);
+        void TestBitmapIncludesIntersects(nlTestSuite *inSuite, void *inContext);
 };
 
 TraitPathStoreTest::TraitPathStoreTest() :
             mTDH1(1), mTDH2(2), mSchemaEngine(&TestHTrait::TraitSchema)
 {
     mStore.Init(mStorage, ArraySize(mStorage));
+    mBitmap.Init(mBitmapWords, ArraySize(mBitmapWords), mKeyedPaths, ArraySize(mKeyedPaths));
 }
 
 void TraitPathStoreTest::TestInitCleanup(nlTestSuite *inSuite, void *inContext)
@@ -644,6 +651,121 @@ void TraitPathStoreTest::TestSetFailedTrait(nlTestSuite *inSuite, void *inContex
     mStore.Clear();
 }
 
+void TraitPathStoreTest::TestBitmapAddItem(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PropertyPathHandle handle;
+    uint32_t cursor = 0;
+
+    NL_TEST_ASSERT(inSuite, ArraySize(mBitmapWords) >= PropertyPathBitmap::GetNumWordsNeeded(mSchemaEngine->mSchema.mNumSchemaHandleEntries));
+
+    err = mBitmap.Attach(mSchemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.IsEmpty());
+
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sb));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_A));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 2);
+
+    // Adding the same path twice is a no-op
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_A));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 2);
+
+    // Items come out in schema handle order
+    handle = mBitmap.GetNextItem(cursor);
+    NL_TEST_ASSERT(inSuite, handle == CreatePropertyPathHandle(TestHTrait::kPropertyHandle_A));
+    handle = mBitmap.GetNextItem(cursor);
+    NL_TEST_ASSERT(inSuite, handle == CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sb));
+    handle = mBitmap.GetNextItem(cursor);
+    NL_TEST_ASSERT(inSuite, handle == kNullPropertyPathHandle);
+
+    // Adding a descendant of an item already in the set is a no-op
+    handle = mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sa), 1);
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = mBitmap.AddItem(handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.IsPresent(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K)));
+    NL_TEST_ASSERT(inSuite, false == mBitmap.IsPresent(handle));
+
+    // ...and adding an ancestor removes its descendants
+    NL_TEST_ASSERT(inSuite, false == mBitmap.IsPresent(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sb)));
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 2);
+
+    err = mBitmap.AddItem(kRootPropertyPathHandle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 1);
+    NL_TEST_ASSERT(inSuite, mBitmap.IsPresent(kRootPropertyPathHandle));
+
+    mBitmap.Clear();
+    NL_TEST_ASSERT(inSuite, mBitmap.IsEmpty());
+
+    // Dictionary items go to the side set, which can fill up
+    err = mBitmap.AddItem(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L), 1));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = mBitmap.AddItem(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L), 2));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = mBitmap.AddItem(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L), 3));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_WDM_PATH_STORE_FULL);
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 2);
+
+    // The dictionary itself subsumes them and frees up the side set
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.GetNumItems() == 1);
+
+    mBitmap.Clear();
+}
+
+void TraitPathStoreTest::TestBitmapIncludesIntersects(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PropertyPathBitmap other;
+    PropertyPathBitmap::Word otherWords[2];
+    PropertyPathHandle otherKeyedPaths[2];
+
+    err = mBitmap.Attach(mSchemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = mBitmap.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Includes(kRootPropertyPathHandle));
+    NL_TEST_ASSERT(inSuite, mBitmap.Includes(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K)));
+    NL_TEST_ASSERT(inSuite, mBitmap.Includes(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sa), 1)));
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Includes(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_I)));
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Includes(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L), 1)));
+
+    NL_TEST_ASSERT(inSuite, mBitmap.Intersects(kRootPropertyPathHandle));
+    NL_TEST_ASSERT(inSuite, mBitmap.Intersects(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sb)));
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Intersects(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_I)));
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Intersects(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_L), 1)));
+
+    other.Init(otherWords, ArraySize(otherWords), otherKeyedPaths, ArraySize(otherKeyedPaths));
+    err = other.Attach(mSchemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = other.AddItem(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_I));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, false == mBitmap.Intersects(other));
+
+    err = other.AddItem(mSchemaEngine->GetDictionaryItemHandle(CreatePropertyPathHandle(TestHTrait::kPropertyHandle_K_Sa), 1));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.Intersects(other));
+    NL_TEST_ASSERT(inSuite, other.Intersects(mBitmap));
+
+    other.Clear();
+    err = other.AddItem(kRootPropertyPathHandle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBitmap.Intersects(other));
+    NL_TEST_ASSERT(inSuite, other.Intersects(mBitmap));
+
+    mBitmap.Clear();
+}
+
 } // WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }
 }
@@ -720,6 +842,16 @@ void TraitPathStoreTest_SetFailedTrait(nlTestSuite *inSuite, void *inContext)
     gPathStoreTest.TestSetFailedTrait(inSuite, inContext);
 }
 
+void TraitPathStoreTest_BitmapAddItem(nlTestSuite *inSuite, void *inContext)
+{
+    gPathStoreTest.TestBitmapAddItem(inSuite, inContext);
+}
+
+void TraitPathStoreTest_BitmapIncludesIntersects(nlTestSuite *inSuite, void *inContext)
+{
+    gPathStoreTest.TestBitmapIncludesIntersects(inSuite, inContext);
+}
+
 // Test Suite
 
 /**
@@ -738,6 +870,8 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Flags",  TraitPathStoreTest_Flags),
     NL_TEST_DEF("InsertItem",  TraitPathStoreTest_InsertItem),
     NL_TEST_DEF("SetFailedTrait",  TraitPathStoreTest_SetFailedTrait),
+    NL_TEST_DEF("Bitmap AddItem",  TraitPathStoreTest_BitmapAddItem),
+    NL_TEST_DEF("Bitmap Includes and Intersects",  TraitPathStoreTest_BitmapIncludesIntersects),
 
     NL_TEST_SENTINEL()
 };
@@ -0,0 +1,723 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the directory cache of the
+ *      Weave service manager: the index over the cached directory, and
+ *      the background refresh of a resolved directory before it expires.
+ *
+ *      Directory responses are handed to the service manager as if they
+ *      had come back from the directory server.  Connections go to closed
+ *      ports on the loopback interface, so they complete with an error
+ *      without any server being involved.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Profiles/common/WeaveMessage.h>
+#include <Weave/Profiles/service-directory/ServiceDirectory.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+#if WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
+
+using nl::Weave::Profiles::MessageIterator;
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace ServiceDirectory {
+
+class TestServiceDirectory
+{
+public:
+    TestServiceDirectory();
+
+    void SetupTest(nlTestSuite *inSuite);
+    void TearDownTest(void);
+
+    void TestIndexMatchesScan(nlTestSuite *inSuite, void *inContext);
+    void TestIndexAfterCacheEntryReplaced(nlTestSuite *inSuite, void *inContext);
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+    void TestCacheExpiry(nlTestSuite *inSuite, void *inContext);
+    void TestRefreshAhead(nlTestSuite *inSuite, void *inContext);
+    void TestRefreshFailure(nlTestSuite *inSuite, void *inContext);
+    void TestDeferredResponseApplied(nlTestSuite *inSuite, void *inContext);
+    void TestDeferredResponseFails(nlTestSuite *inSuite, void *inContext);
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+private:
+    enum
+    {
+        kCacheSize = 500,
+
+        // Entries of the test directory, which stays within the 15 a response can hold
+        kNumEntries = 12,
+        kSingleNodeEntry = 2,
+
+        // Ports nothing listens on, so connects are refused
+        kFirstBasePort = 1,
+        kRefreshedBasePort = 101,
+
+        kConnectTimeoutMsec = 1000,
+        kTimeoutMsec = 5000,
+    };
+
+    WeaveServiceManager mManager;
+    uint8_t mCache[kCacheSize];
+
+    size_t mNumConnectsCompleted;
+    size_t mNumStatusReported;
+
+    PacketBuffer *BuildResponse(nlTestSuite *inSuite, uint16_t aBasePort, bool aTruncated);
+    void ResolveDirectory(nlTestSuite *inSuite, uint16_t aBasePort);
+    void VerifyIndexMatchesScan(nlTestSuite *inSuite, uint64_t aServiceEp);
+    void VerifyDirectory(nlTestSuite *inSuite, uint16_t aBasePort);
+    uint16_t LookupPort(nlTestSuite *inSuite, uint64_t aServiceEp);
+    void BackdateDirectory(uint64_t aAgeMsec);
+    void StartRefresh(nlTestSuite *inSuite);
+    void ConnectToService(nlTestSuite *inSuite, uint64_t aServiceEp);
+    void ServiceEventsUntilConnectsCompleted(size_t aNumConnects);
+
+    static WEAVE_ERROR GetRootDirectory(uint8_t *aDirectory, uint16_t aLength);
+    static void HandleStatus(void *anAppState, WEAVE_ERROR anError, StatusReport *aStatusReport);
+    static void HandleConnectionComplete(WeaveConnection *aCon, WEAVE_ERROR aConErr);
+};
+
+// The endpoints of the test directory; the last one repeats an earlier one
+static const uint64_t sTestEndpoints[] = {
+    kServiceEndpoint_Directory,
+    kServiceEndpoint_SoftwareUpdate,
+    kServiceEndpoint_Data_Management,
+    kServiceEndpoint_Log_Upload,
+    kServiceEndpoint_TimeService,
+    kServiceEndpoint_ServiceProvisioning,
+    kServiceEndpoint_WeaveTunneling,
+    kServiceEndpoint_CoreRouter,
+    kServiceEndpoint_FileDownload,
+    kServiceEndpoint_Bastion,
+    0x18B4300200000020ULL,
+    kServiceEndpoint_Bastion,
+};
+
+static const uint64_t kMissingEndpoint = 0x18B43002000000FFULL;
+static const uint64_t kAddedEndpoint = 0x18B4300200000021ULL;
+static const char kTestHost[] = "::1";
+
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+static const uint64_t kRefreshAgeMsec =
+    (WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS - WEAVE_CONFIG_SERVICE_DIR_CACHE_REFRESH_AHEAD_SECS) * 1000ULL;
+static const uint64_t kExpiryAgeMsec = WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS * 1000ULL;
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+TestServiceDirectory::TestServiceDirectory() :
+    mNumConnectsCompleted(0),
+    mNumStatusReported(0)
+{
+}
+
+void TestServiceDirectory::SetupTest(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err;
+
+    mNumConnectsCompleted = 0;
+    mNumStatusReported = 0;
+
+    err = mManager.init(&ExchangeMgr, mCache, sizeof(mCache), GetRootDirectory);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+void TestServiceDirectory::TearDownTest(void)
+{
+    mManager.reset();
+}
+
+/**
+ * Builds a service endpoint response with a host/port list entry for every
+ * test endpoint, except for one single node entry.  Entry i lists port
+ * aBasePort + i.  A truncated response claims more entries than it holds.
+ */
+PacketBuffer *TestServiceDirectory::BuildResponse(nlTestSuite *inSuite, uint16_t aBasePort, bool aTruncated)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *msg = PacketBuffer::New();
+    uint8_t dirLen = aTruncated ? kNumEntries + 2 : kNumEntries;
+
+    NL_TEST_ASSERT(inSuite, msg != NULL);
+    VerifyOrExit(msg != NULL, );
+
+    {
+        MessageIterator i(msg);
+
+        i.append();
+
+        err = i.writeByte(dirLen & kMask_DirectoryLen);
+        SuccessOrExit(err);
+
+        for (uint8_t entry = 0; entry < kNumEntries; entry++)
+        {
+            if (entry == kSingleNodeEntry)
+            {
+                err = i.writeByte(kDirectoryEntryType_SingleNode);
+                SuccessOrExit(err);
+
+                err = i.write64(sTestEndpoints[entry]);
+                SuccessOrExit(err);
+
+                err = i.write64(FabricState.LocalNodeId);
+                SuccessOrExit(err);
+
+                continue;
+            }
+
+            err = i.writeByte(kDirectoryEntryType_HostPortList | 1);
+            SuccessOrExit(err);
+
+            err = i.write64(sTestEndpoints[entry]);
+            SuccessOrExit(err);
+
+            err = i.writeByte(kHostIdType_FullyQualified | kMask_PortIdPresent);
+            SuccessOrExit(err);
+
+            err = i.writeByte(static_cast<uint8_t>(strlen(kTestHost)));
+            SuccessOrExit(err);
+
+            err = i.writeBytes(static_cast<uint16_t>(strlen(kTestHost)), (uint8_t *)kTestHost);
+            SuccessOrExit(err);
+
+            err = i.write16(static_cast<uint16_t>(aBasePort + entry));
+            SuccessOrExit(err);
+        }
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    return msg;
+}
+
+/**
+ * Resolves the directory as if a query had just been answered.
+ */
+void TestServiceDirectory::ResolveDirectory(nlTestSuite *inSuite, uint16_t aBasePort)
+{
+    mManager.mCacheState = kServiceMgrState_Waiting;
+
+    mManager.onResponseReceived(kWeaveProfile_ServiceDirectory, kMsgType_ServiceEndpointResponse,
+                                BuildResponse(inSuite, aBasePort, false));
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+    NL_TEST_ASSERT(inSuite, mManager.mDirectory.length == kNumEntries);
+    NL_TEST_ASSERT(inSuite, mManager.mIndexValid);
+}
+
+/**
+ * Looks aServiceEp up through the index and by walking the directory, and
+ * checks that both find the same entry, or both find none.
+ */
+void TestServiceDirectory::VerifyIndexMatchesScan(nlTestSuite *inSuite, uint64_t aServiceEp)
+{
+    WEAVE_ERROR indexErr;
+    WEAVE_ERROR scanErr;
+    uint8_t indexCtrlByte = 0;
+    uint8_t scanCtrlByte = 0;
+    uint8_t *indexEntry = NULL;
+    uint8_t *scanEntry = NULL;
+
+    NL_TEST_ASSERT(inSuite, mManager.mIndexValid);
+
+    indexErr = mManager.lookup(aServiceEp, &indexCtrlByte, &indexEntry);
+
+    mManager.mIndexValid = false;
+    scanErr = mManager.lookup(aServiceEp, &scanCtrlByte, &scanEntry);
+    mManager.mIndexValid = true;
+
+    NL_TEST_ASSERT(inSuite, indexErr == scanErr);
+    NL_TEST_ASSERT(inSuite, indexCtrlByte == scanCtrlByte);
+    NL_TEST_ASSERT(inSuite, indexEntry == scanEntry);
+}
+
+/**
+ * Checks that every host/port list entry of the cached directory lists the
+ * port given by aBasePort.
+ */
+void TestServiceDirectory::VerifyDirectory(nlTestSuite *inSuite, uint16_t aBasePort)
+{
+    for (uint8_t entry = 0; entry < kNumEntries - 1; entry++)
+    {
+        if (entry != kSingleNodeEntry)
+        {
+            NL_TEST_ASSERT(inSuite, LookupPort(inSuite, sTestEndpoints[entry]) == aBasePort + entry);
+        }
+    }
+}
+
+uint16_t TestServiceDirectory::LookupPort(nlTestSuite *inSuite, uint64_t aServiceEp)
+{
+    WEAVE_ERROR err;
+    HostPortList hostPortList;
+    char host[16];
+    uint16_t port = 0;
+
+    err = mManager.lookup(aServiceEp, &hostPortList);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    SuccessOrExit(err);
+
+    err = hostPortList.Get(0, host, sizeof(host), port);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, strcmp(host, kTestHost) == 0);
+
+exit:
+    return port;
+}
+
+void TestServiceDirectory::BackdateDirectory(uint64_t aAgeMsec)
+{
+    mManager.mResolvedTimeMS = System::Layer::GetClock_MonotonicMS() - aAgeMsec;
+}
+
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+/**
+ * Fires the cache timer once the directory is due for a refresh.  The
+ * refresh connects to the directory server, which is never answered: the
+ * tests hand the manager its response or failure themselves.
+ */
+void TestServiceDirectory::StartRefresh(nlTestSuite *inSuite)
+{
+    BackdateDirectory(kRefreshAgeMsec);
+
+    mManager.onCacheTimer();
+
+    NL_TEST_ASSERT(inSuite, mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, mManager.mConnection != NULL);
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+}
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+void TestServiceDirectory::ConnectToService(nlTestSuite *inSuite, uint64_t aServiceEp)
+{
+    WEAVE_ERROR err;
+
+    err = mManager.connect(aServiceEp, kWeaveAuthMode_Unauthenticated, this, HandleStatus, HandleConnectionComplete,
+                           kConnectTimeoutMsec);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+void TestServiceDirectory::ServiceEventsUntilConnectsCompleted(size_t aNumConnects)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kTimeoutMsec;
+
+    while (mNumConnectsCompleted < aNumConnects && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    }
+}
+
+WEAVE_ERROR TestServiceDirectory::GetRootDirectory(uint8_t *aDirectory, uint16_t aLength)
+{
+    // The tests resolve the directory themselves
+    return WEAVE_ERROR_INCORRECT_STATE;
+}
+
+void TestServiceDirectory::HandleStatus(void *anAppState, WEAVE_ERROR anError, StatusReport *aStatusReport)
+{
+    TestServiceDirectory *test = static_cast<TestServiceDirectory *>(anAppState);
+
+    test->mNumStatusReported++;
+}
+
+void TestServiceDirectory::HandleConnectionComplete(WeaveConnection *aCon, WEAVE_ERROR aConErr)
+{
+    TestServiceDirectory *test = static_cast<TestServiceDirectory *>(aCon->AppState);
+
+    test->mNumConnectsCompleted++;
+
+    aCon->Close();
+}
+
+/**
+ * Every endpoint, including a repeated and a missing one, is found at the
+ * same entry through the index as by walking the directory.
+ */
+void TestServiceDirectory::TestIndexMatchesScan(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t ctrlByte;
+    uint8_t *entry;
+
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    for (size_t i = 0; i < kNumEntries; i++)
+    {
+        VerifyIndexMatchesScan(inSuite, sTestEndpoints[i]);
+    }
+
+    VerifyIndexMatchesScan(inSuite, kMissingEndpoint);
+
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    // The first of the repeated entries wins
+    NL_TEST_ASSERT(inSuite, LookupPort(inSuite, kServiceEndpoint_Bastion) == kFirstBasePort + 9);
+
+    NL_TEST_ASSERT(inSuite, mManager.lookup(kServiceEndpoint_Data_Management, &ctrlByte, &entry) == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, (ctrlByte & kMask_DirectoryEntryType) == kDirectoryEntryType_SingleNode);
+
+    NL_TEST_ASSERT(inSuite, mManager.lookup(kMissingEndpoint, &ctrlByte, &entry) == WEAVE_ERROR_INVALID_SERVICE_EP);
+}
+
+/**
+ * Replacing or adding a cache entry moves the entries behind it, and the
+ * index follows.
+ */
+void TestServiceDirectory::TestIndexAfterCacheEntryReplaced(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    const uint16_t replacedPort = 2000;
+    const uint16_t addedPort = 3000;
+
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    err = mManager.replaceOrAddCacheEntry(replacedPort, kTestHost, static_cast<uint8_t>(strlen(kTestHost)),
+                                          kServiceEndpoint_TimeService);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mManager.mDirectory.length == kNumEntries);
+
+    err = mManager.replaceOrAddCacheEntry(addedPort, kTestHost, static_cast<uint8_t>(strlen(kTestHost)),
+                                          kAddedEndpoint);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mManager.mDirectory.length == kNumEntries + 1);
+
+    for (size_t i = 0; i < kNumEntries; i++)
+    {
+        VerifyIndexMatchesScan(inSuite, sTestEndpoints[i]);
+    }
+
+    VerifyIndexMatchesScan(inSuite, kAddedEndpoint);
+    VerifyIndexMatchesScan(inSuite, kMissingEndpoint);
+
+    NL_TEST_ASSERT(inSuite, LookupPort(inSuite, kServiceEndpoint_TimeService) == replacedPort);
+    NL_TEST_ASSERT(inSuite, LookupPort(inSuite, kAddedEndpoint) == addedPort);
+    NL_TEST_ASSERT(inSuite, LookupPort(inSuite, kServiceEndpoint_FileDownload) == kFirstBasePort + 8);
+}
+
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+/**
+ * A directory is used until its TTL has passed, after which the next
+ * connect has to query the directory server again.
+ */
+void TestServiceDirectory::TestCacheExpiry(nlTestSuite *inSuite, void *inContext)
+{
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    NL_TEST_ASSERT(inSuite, !mManager.isCacheExpired());
+
+    BackdateDirectory(kExpiryAgeMsec - 1000);
+    NL_TEST_ASSERT(inSuite, !mManager.isCacheExpired());
+
+    BackdateDirectory(kExpiryAgeMsec);
+    NL_TEST_ASSERT(inSuite, mManager.isCacheExpired());
+
+    mManager.onCacheTimer();
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolving);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, mManager.mConnection == NULL);
+}
+
+/**
+ * Ahead of expiry the directory is refreshed in the background, serving
+ * lookups from the cached one until the refreshed one arrives.
+ */
+void TestServiceDirectory::TestRefreshAhead(nlTestSuite *inSuite, void *inContext)
+{
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    StartRefresh(inSuite);
+
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    mManager.onResponseReceived(kWeaveProfile_ServiceDirectory, kMsgType_ServiceEndpointResponse,
+                                BuildResponse(inSuite, kRefreshedBasePort, false));
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, mManager.mConnection == NULL);
+    NL_TEST_ASSERT(inSuite, !mManager.isCacheExpired());
+    NL_TEST_ASSERT(inSuite, System::Layer::GetClock_MonotonicMS() - mManager.mResolvedTimeMS < kRefreshAgeMsec);
+
+    VerifyDirectory(inSuite, kRefreshedBasePort);
+    VerifyIndexMatchesScan(inSuite, kServiceEndpoint_Bastion);
+}
+
+/**
+ * A failed refresh keeps the cached directory in use until it expires, and
+ * an expired directory is kept while a refresh is still in flight.
+ */
+void TestServiceDirectory::TestRefreshFailure(nlTestSuite *inSuite, void *inContext)
+{
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    StartRefresh(inSuite);
+
+    mManager.onResponseTimeout();
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, mManager.mConnection == NULL);
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    // Try again, and let the directory expire while the refresh is in flight
+    StartRefresh(inSuite);
+
+    BackdateDirectory(kExpiryAgeMsec);
+    mManager.onCacheTimer();
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+    NL_TEST_ASSERT(inSuite, mManager.mRefreshing);
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    mManager.onResponseTimeout();
+
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolving);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, mNumStatusReported == 0);
+}
+
+/**
+ * A refreshed directory that arrives while a connect still uses host/port
+ * entries of the cache is held back until that connect completes.  A
+ * connect requested in the meantime waits for the refreshed directory.
+ */
+void TestServiceDirectory::TestDeferredResponseApplied(nlTestSuite *inSuite, void *inContext)
+{
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    StartRefresh(inSuite);
+
+    ConnectToService(inSuite, kServiceEndpoint_CoreRouter);
+    NL_TEST_ASSERT(inSuite, mManager.hasConnectsInProgress());
+
+    mManager.onResponseReceived(kWeaveProfile_ServiceDirectory, kMsgType_ServiceEndpointResponse,
+                                BuildResponse(inSuite, kRefreshedBasePort, false));
+
+    NL_TEST_ASSERT(inSuite, mManager.mDeferredResponse != NULL);
+    NL_TEST_ASSERT(inSuite, mManager.mConnection == NULL);
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    ConnectToService(inSuite, kServiceEndpoint_FileDownload);
+
+    ServiceEventsUntilConnectsCompleted(1);
+
+    NL_TEST_ASSERT(inSuite, mNumConnectsCompleted >= 1);
+    NL_TEST_ASSERT(inSuite, mManager.mDeferredResponse == NULL);
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Resolved);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    VerifyDirectory(inSuite, kRefreshedBasePort);
+
+    // The waiting connect was started from the refreshed directory
+    ServiceEventsUntilConnectsCompleted(2);
+
+    NL_TEST_ASSERT(inSuite, mNumConnectsCompleted == 2);
+    NL_TEST_ASSERT(inSuite, mNumStatusReported == 0);
+}
+
+/**
+ * A held back response that turns out to be malformed when it is applied
+ * invalidates the cache, like a failed query would.
+ */
+void TestServiceDirectory::TestDeferredResponseFails(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t ctrlByte;
+    uint8_t *entry;
+
+    ResolveDirectory(inSuite, kFirstBasePort);
+
+    StartRefresh(inSuite);
+
+    ConnectToService(inSuite, kServiceEndpoint_CoreRouter);
+    NL_TEST_ASSERT(inSuite, mManager.hasConnectsInProgress());
+
+    mManager.onResponseReceived(kWeaveProfile_ServiceDirectory, kMsgType_ServiceEndpointResponse,
+                                BuildResponse(inSuite, kRefreshedBasePort, true));
+
+    NL_TEST_ASSERT(inSuite, mManager.mDeferredResponse != NULL);
+    VerifyDirectory(inSuite, kFirstBasePort);
+
+    ServiceEventsUntilConnectsCompleted(1);
+
+    NL_TEST_ASSERT(inSuite, mNumConnectsCompleted == 1);
+    NL_TEST_ASSERT(inSuite, mManager.mDeferredResponse == NULL);
+    NL_TEST_ASSERT(inSuite, mManager.mCacheState == kServiceMgrState_Initial);
+    NL_TEST_ASSERT(inSuite, !mManager.mRefreshing);
+    NL_TEST_ASSERT(inSuite, !mManager.mIndexValid);
+    NL_TEST_ASSERT(inSuite, mManager.lookup(kServiceEndpoint_CoreRouter, &ctrlByte, &entry) != WEAVE_NO_ERROR);
+}
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+} // namespace ServiceDirectory
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+using namespace nl::Weave::Profiles::ServiceDirectory;
+
+// Test Suite
+
+static TestServiceDirectory gTestServiceDirectory;
+
+static void TestIndexMatchesScan(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestIndexMatchesScan(inSuite, inContext);
+}
+
+static void TestIndexAfterCacheEntryReplaced(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestIndexAfterCacheEntryReplaced(inSuite, inContext);
+}
+
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+static void TestCacheExpiry(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestCacheExpiry(inSuite, inContext);
+}
+
+static void TestRefreshAhead(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestRefreshAhead(inSuite, inContext);
+}
+
+static void TestRefreshFailure(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestRefreshFailure(inSuite, inContext);
+}
+
+static void TestDeferredResponseApplied(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestDeferredResponseApplied(inSuite, inContext);
+}
+
+static void TestDeferredResponseFails(nlTestSuite *inSuite, void *inContext)
+{
+    gTestServiceDirectory.TestDeferredResponseFails(inSuite, inContext);
+}
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Index matches directory scan",      TestIndexMatchesScan),
+    NL_TEST_DEF("Index after cache entry replaced",  TestIndexAfterCacheEntryReplaced),
+#if WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+    NL_TEST_DEF("Cache expiry",                      TestCacheExpiry),
+    NL_TEST_DEF("Refresh ahead of expiry",           TestRefreshAhead),
+    NL_TEST_DEF("Refresh failure",                   TestRefreshFailure),
+    NL_TEST_DEF("Deferred response applied",         TestDeferredResponseApplied),
+    NL_TEST_DEF("Deferred response fails",           TestDeferredResponseFails),
+#endif // WEAVE_CONFIG_SERVICE_DIR_CACHE_TTL_SECS
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gTestServiceDirectory.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gTestServiceDirectory.TearDownTest();
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-service-directory",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
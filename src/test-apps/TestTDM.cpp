@@ -35,6 +35,7 @@
 #include <Weave/Core/WeaveTLVData.hpp>
 #include <Weave/Core/WeaveCircularTLVBuffer.h>
 #include <Weave/Support/RandUtils.h>
+#include <SystemLayer/SystemStats.h>
 
 #include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
 #include <Weave/Profiles/data-management/DataManagement.h>
@@ -116,6 +117,7 @@ SubscriptionEngine * SubscriptionEngine::GetInstance()
 
 static void CheckDataSourceEmptySchema(nlTestSuite *inSuite, void *inContext);
 static void CheckDataSinkEmptySchema(nlTestSuite *inSuite, void *inContext);
+static void CheckDataSinkLeafDataView(nlTestSuite *inSuite, void *inContext);
 
 static void TestTdmStatic_SingleLeafHandle(nlTestSuite *inSuite, void *inContext);
 static void TestTdmStatic_SingleLevelMerge(nlTestSuite *inSuite, void *inContext);
@@ -161,6 +163,23 @@ static void TestTdmDictionary_DeleteEntryTwice(nlTestSuite *inSuite, void *inCon
 static void TestRandomizedDataVersions(nlTestSuite *inSuite, void *inContext);
 
 static void TestTdmStatic_MultiInstance(nlTestSuite *inSuite, void *inContext);
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+static void TestTdmStatic_ParallelDataList(nlTestSuite *inSuite, void *inContext);
+#endif
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+static void TestTdmStatic_DataElementCache(nlTestSuite *inSuite, void *inContext);
+#endif
+static void TestTdmStatic_NotifyRateControl(nlTestSuite *inSuite, void *inContext);
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+static void TestTdmStatic_DeltaResync(nlTestSuite *inSuite, void *inContext);
+#endif
+static void TestTdmLargeSchema_PropertyTreeIndex(nlTestSuite *inSuite, void *inContext);
+#if TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+static void TestTdmStatic_GeneratedSchemaIndex(nlTestSuite *inSuite, void *inContext);
+#endif
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+static void TestTdmLargeSchema_DirtyPathBitmapOverflow(nlTestSuite *inSuite, void *inContext);
+#endif
 static void CheckAllocateRightSizedBufferForNotifications(nlTestSuite *inSuite, void *inContext);
 
 // Test Suite
@@ -171,6 +190,7 @@ static void CheckAllocateRightSizedBufferForNotifications(nlTestSuite *inSuite,
 static const nlTest sTests[] = {
     NL_TEST_DEF("Test TraitDataSource + schema with no properties",  CheckDataSourceEmptySchema),
     NL_TEST_DEF("Test TraitDataSink + schema with no properties",    CheckDataSinkEmptySchema),
+    NL_TEST_DEF("Test TraitDataSink + byte string leaf kept in place", CheckDataSinkLeafDataView),
 
     // Tests the static schema portions of TDM
     NL_TEST_DEF("Test Tdm (Static schema): Single leaf handle", TestTdmStatic_SingleLeafHandle),
@@ -223,6 +243,25 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Test Tdm (Randomized Data Versions): Randomized Data Versions", TestRandomizedDataVersions),
 
     NL_TEST_DEF("Test Tdm (Multi Instance): Multi Instance", TestTdmStatic_MultiInstance),
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    NL_TEST_DEF("Test Tdm (Multi Instance): Parallel data list application", TestTdmStatic_ParallelDataList),
+#endif
+
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    NL_TEST_DEF("Test Tdm (Static schema): Encoded data element cache", TestTdmStatic_DataElementCache),
+#endif
+    NL_TEST_DEF("Test Tdm (Static schema): Notify rate control", TestTdmStatic_NotifyRateControl),
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    NL_TEST_DEF("Test Tdm (Static schema): Resubscribe with only the changes since a known version", TestTdmStatic_DeltaResync),
+#endif
+
+    NL_TEST_DEF("Test Tdm (Large schema): Property tree index", TestTdmLargeSchema_PropertyTreeIndex),
+#if TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+    NL_TEST_DEF("Test Tdm (Static schema): Generated schema uses a pooled property tree index", TestTdmStatic_GeneratedSchemaIndex),
+#endif
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    NL_TEST_DEF("Test Tdm (Large schema): Trait too large for a dirty path bitmap", TestTdmLargeSchema_DirtyPathBitmapOverflow),
+#endif
 
     // Tests the allocation of buffer for building and sending Notifies and
     // Updates.
@@ -354,6 +393,132 @@ exit:
     return;
 }
 
+class TestLeafDataViewSink : public TraitDataSink {
+public:
+    TestLeafDataViewSink(const TraitSchemaEngine *aSchema) : TraitDataSink(aSchema), mSetLeafDataCalled(false) { }
+
+    WEAVE_ERROR SetLeafData(PropertyPathHandle aLeafHandle, TLVReader &aReader) { mSetLeafDataCalled = true; return WEAVE_NO_ERROR; }
+    WEAVE_ERROR SetLeafDataView(PropertyPathHandle aLeafHandle, const LeafDataView &aView) { mView = aView; return WEAVE_NO_ERROR; }
+
+    bool mSetLeafDataCalled;
+    LeafDataView mView;
+};
+
+static int GetNumRetainedLeafViews(void)
+{
+#if WEAVE_SYSTEM_CONFIG_PROVIDE_STATISTICS && WDM_ENABLE_SUBSCRIPTION_CLIENT
+    return System::Stats::GetResourcesInUse()[System::Stats::kWDM_NumRetainedLeafViews];
+#else
+    return 0;
+#endif
+}
+
+static void CheckDataSinkLeafDataView(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TestLeafDataViewSink dataSink(&TestBTrait::TraitSchema);
+    PacketBuffer *buf = NULL;
+    TLVWriter writer;
+    TLVReader reader;
+    TLVType dummyContainerType;
+    uint8_t blob[512];
+    int numRetainedLeafViews = GetNumRetainedLeafViews();
+
+    for (size_t i = 0; i < sizeof(blob); i++)
+    {
+        blob[i] = static_cast<uint8_t>(i);
+    }
+
+    buf = PacketBuffer::New();
+    NL_TEST_ASSERT(inSuite, buf != NULL);
+    VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    writer.Init(buf);
+
+    err = writer.StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(DataElement::kCsTag_Version), static_cast<uint64_t>(1));
+    SuccessOrExit(err);
+
+    err = writer.PutBytes(ContextTag(DataElement::kCsTag_Data), blob, sizeof(blob));
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(dummyContainerType);
+    SuccessOrExit(err);
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    // Received in a PacketBuffer: the sink gets a view into it, and keeps the buffer alive by copying the view
+    reader.Init(buf);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = dataSink.StoreDataElement(TestBTrait::kPropertyHandle_TaK, reader, 0, NULL, NULL);
+    SuccessOrExit(err);
+
+    NL_TEST_ASSERT(inSuite, dataSink.mSetLeafDataCalled == false);
+    NL_TEST_ASSERT(inSuite, dataSink.mView.IsRetained());
+    NL_TEST_ASSERT(inSuite, dataSink.mView.GetType() == kTLVType_ByteString);
+    NL_TEST_ASSERT(inSuite, dataSink.mView.GetLength() == sizeof(blob));
+    NL_TEST_ASSERT(inSuite, dataSink.mView.GetData() > buf->Start() && dataSink.mView.GetData() < buf->Start() + buf->DataLength());
+
+#if WEAVE_SYSTEM_CONFIG_PROVIDE_STATISTICS && WDM_ENABLE_SUBSCRIPTION_CLIENT
+    NL_TEST_ASSERT(inSuite, GetNumRetainedLeafViews() == numRetainedLeafViews + 1);
+#endif
+
+    PacketBuffer::Free(buf);
+    buf = NULL;
+
+    NL_TEST_ASSERT(inSuite, memcmp(dataSink.mView.GetData(), blob, sizeof(blob)) == 0);
+
+    dataSink.mView.Release();
+    NL_TEST_ASSERT(inSuite, GetNumRetainedLeafViews() == numRetainedLeafViews);
+
+    // Not in a PacketBuffer: the leaf goes to SetLeafData
+    {
+        uint8_t encoding[sizeof(blob) + 32];
+
+        writer.Init(encoding, sizeof(encoding));
+
+        err = writer.StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
+        SuccessOrExit(err);
+
+        err = writer.Put(ContextTag(DataElement::kCsTag_Version), static_cast<uint64_t>(2));
+        SuccessOrExit(err);
+
+        err = writer.PutBytes(ContextTag(DataElement::kCsTag_Data), blob, sizeof(blob));
+        SuccessOrExit(err);
+
+        err = writer.EndContainer(dummyContainerType);
+        SuccessOrExit(err);
+
+        err = writer.Finalize();
+        SuccessOrExit(err);
+
+        reader.Init(encoding, writer.GetLengthWritten());
+
+        err = reader.Next();
+        SuccessOrExit(err);
+
+        err = dataSink.StoreDataElement(TestBTrait::kPropertyHandle_TaK, reader, 0, NULL, NULL);
+        SuccessOrExit(err);
+    }
+
+    NL_TEST_ASSERT(inSuite, dataSink.mSetLeafDataCalled == true);
+    NL_TEST_ASSERT(inSuite, dataSink.mView.GetData() == NULL);
+
+exit:
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
 static void CheckDataSinkEmptySchema(nlTestSuite *inSuite, void *inContext)
 {
     WEAVE_ERROR err;
@@ -578,19 +743,40 @@ public:
     void DumpChangeSets();
 
     bool ValidateChangeSets(std::map <PropertyPathHandle, uint32_t> aTargetModifiedSet, std::set <PropertyPathHandle> aTargetDeletedSet, std::set <PropertyPathHandle> aTargetReplacedSet);
+    bool IsModified(PropertyPathHandle aHandle) const { return mModifiedHandles.find(aHandle) != mModifiedHandles.end(); }
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    // Whether OnEvent or SetLeafData was called on a thread other than the one that created the sink.
+    bool WasCalledOffThread() const { return mWasCalledOffThread; }
+    void SetThreadSafe(bool aIsThreadSafe) { mIsThreadSafe = aIsThreadSafe; }
+#endif
 
 private:
     WEAVE_ERROR OnEvent(uint16_t aType, void *aInParam);
     WEAVE_ERROR SetLeafData(PropertyPathHandle aLeafHandle, nl::Weave::TLV::TLVReader &aReader);
     WEAVE_ERROR GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter &aWriter);
+    void CheckThread();
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    bool IsThreadSafe() { return mIsThreadSafe; }
+#endif
     std::map <PropertyPathHandle, uint32_t> mModifiedHandles;
     std::set <PropertyPathHandle> mDeletedHandles;
     std::set <PropertyPathHandle> mReplacedDictionaries;
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    pthread_t mThread;
+    bool mWasCalledOffThread;
+    bool mIsThreadSafe;
+#endif
 };
 
 TestTdmSink::TestTdmSink()
     : TraitDataSink(&TestHTrait::TraitSchema)
 {
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    mThread = pthread_self();
+    mWasCalledOffThread = false;
+    mIsThreadSafe = false;
+#endif
 }
 
 void TestTdmSink::Reset()
@@ -599,6 +785,19 @@ void TestTdmSink::Reset()
     mDeletedHandles.clear();
     mReplacedDictionaries.clear();
     ClearVersion();
+
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    mWasCalledOffThread = false;
+#endif
+}
+
+void TestTdmSink::CheckThread()
+{
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    if (!pthread_equal(pthread_self(), mThread)) {
+        mWasCalledOffThread = true;
+    }
+#endif
 }
 
 void TestTdmSink::DumpChangeSets()
@@ -649,6 +848,8 @@ WEAVE_ERROR TestTdmSink::OnEvent(uint16_t aType, void *aInParam)
 {
     InEventParam *inParam = static_cast<InEventParam *>(aInParam);
 
+    CheckThread();
+
     switch (aType) {
         case kEventDictionaryItemDelete:
             WeaveLogDetail(DataManagement, "[TestTdmSink::OnEvent] Deleting %u:%u", GetPropertyDictionaryKey(inParam->mDictionaryItemDelete.mTargetHandle), GetPropertySchemaHandle(inParam->mDictionaryItemDelete.mTargetHandle));
@@ -673,6 +874,8 @@ WEAVE_ERROR TestTdmSink::SetLeafData(PropertyPathHandle aHandle, TLVReader &aRea
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     uint16_t val;
 
+    CheckThread();
+
     err = aReader.Get(val);
     SuccessOrExit(err);
 
@@ -691,6 +894,9 @@ public:
     int Teardown();
     int Reset();
     int BuildAndProcessNotify();
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    int ProcessSubscribeRequest(TraitDataHandle aTraitDataHandle, uint64_t aVersion);
+#endif
 
     void TestTdmStatic_SingleLeafHandle(nlTestSuite *inSuite);
     void TestTdmStatic_SingleLevelMerge(nlTestSuite *inSuite);
@@ -737,6 +943,19 @@ public:
     void TestRandomizedDataVersions(nlTestSuite *inSuite);
 
     void TestTdmStatic_MultiInstance(nlTestSuite *inSuite);
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+    void TestTdmStatic_ParallelDataList(nlTestSuite *inSuite);
+#endif
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    void TestTdmStatic_DataElementCache(nlTestSuite *inSuite);
+#endif
+    void TestTdmStatic_NotifyRateControl(nlTestSuite *inSuite);
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+    void TestTdmStatic_DeltaResync(nlTestSuite *inSuite);
+#endif
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+    void TestTdmLargeSchema_DirtyPathBitmapOverflow(nlTestSuite *inSuite);
+#endif
 
     void CheckAllocateRightSizedBufferForNotifications(nlTestSuite *inSuite);
 
@@ -826,37 +1045,20 @@ int TestTdm::Setup()
 
     mSinkCatalog.Add(3, &mTestBSink, testBSinkHandle);
 
-    traitInstance = mSubscriptionEngine.mTraitInfoPool;
-    mSubHandler->mTraitInstanceList = traitInstance;
-    mSubHandler->mNumTraitInstances++;
-    ++(SubscriptionEngine::GetInstance()->mNumTraitInfosInPool);
-
-    traitInstance->Init();
-    traitInstance->mTraitDataHandle = testTdmSourceHandle;
+    err = mSubHandler->AddTraitInstance(testTdmSourceHandle, traitInstance);
+    SuccessOrExit(err);
     traitInstance->mRequestedVersion = 1;
 
-    traitInstance = mSubscriptionEngine.mTraitInfoPool + 1;
-    mSubHandler->mNumTraitInstances++;
-    ++(SubscriptionEngine::GetInstance()->mNumTraitInfosInPool);
-
-    traitInstance->Init();
-    traitInstance->mTraitDataHandle = testTdmSourceHandle1;
+    err = mSubHandler->AddTraitInstance(testTdmSourceHandle1, traitInstance);
+    SuccessOrExit(err);
     traitInstance->mRequestedVersion = 1;
 
-    traitInstance = mSubscriptionEngine.mTraitInfoPool + 2;
-    mSubHandler->mNumTraitInstances++;
-    ++(SubscriptionEngine::GetInstance()->mNumTraitInfosInPool);
-
-    traitInstance->Init();
-    traitInstance->mTraitDataHandle = testMismatchedCSourceHandle;
+    err = mSubHandler->AddTraitInstance(testMismatchedCSourceHandle, traitInstance);
+    SuccessOrExit(err);
     traitInstance->mRequestedVersion = 1;
 
-    traitInstance = mSubscriptionEngine.mTraitInfoPool + 3;
-    mSubHandler->mNumTraitInstances++;
-    ++(SubscriptionEngine::GetInstance()->mNumTraitInfosInPool);
-
-    traitInstance->Init();
-    traitInstance->mTraitDataHandle = testBSourceHandle;
+    err = mSubHandler->AddTraitInstance(testBSourceHandle, traitInstance);
+    SuccessOrExit(err);
     traitInstance->mRequestedVersion = 1;
 
 exit:
@@ -877,6 +1079,8 @@ int TestTdm::Teardown()
         mClientBinding = NULL;
     }
 
+    mSubscriptionEngine.Shutdown();
+
     return err;
 }
 
@@ -898,6 +1102,9 @@ int TestTdm::Reset()
     mTestBSource.Reset();
 
     mNotificationEngine->mGraphSolver.ClearDirty();
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+    mNotificationEngine->mDataElementCache.Init();
+#endif
 
     return err;
 }
@@ -1001,6 +1208,318 @@ exit:
     NL_TEST_ASSERT(inSuite, testPass);
 }
 
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+void TestTdm::TestTdmStatic_ParallelDataList(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool testPass = false;
+
+    Reset();
+
+    mSubscriptionEngine.EnableParallelDataListApplication(true);
+
+    // mTestTdmSink may be applied on a worker thread, mTestTdmSink1 only on this one.
+    mTestTdmSink.SetThreadSafe(true);
+
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_A, 2);
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_B, 3);
+    mTestTdmSource1.SetValue(TestHTrait::kPropertyHandle_B, 4);
+    mTestTdmSource1.SetValue(TestHTrait::kPropertyHandle_C, 5);
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink.ValidateChangeSets( { { TestHTrait::kPropertyHandle_A, 2 }, { TestHTrait::kPropertyHandle_B, 3 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    testPass = mTestTdmSink1.ValidateChangeSets( { { TestHTrait::kPropertyHandle_B, 4 }, { TestHTrait::kPropertyHandle_C, 5 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    testPass = !mTestTdmSink1.WasCalledOffThread();
+    VerifyOrExit(testPass, );
+
+    testPass = (mTestTdmSink.GetVersion() == mTestTdmSource.GetVersion()) &&
+               (mTestTdmSink1.GetVersion() == mTestTdmSource1.GetVersion());
+    VerifyOrExit(testPass, );
+
+    // Disabling joins the worker threads; the pool can be started again afterwards.
+    mSubscriptionEngine.EnableParallelDataListApplication(false);
+    testPass = !mSubscriptionEngine.mDataListWorkerPool.IsStarted();
+    VerifyOrExit(testPass, );
+
+    mSubscriptionEngine.EnableParallelDataListApplication(true);
+
+    mTestTdmSource1.SetValue(TestHTrait::kPropertyHandle_C, 6);
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink1.ValidateChangeSets( { { TestHTrait::kPropertyHandle_B, 4 }, { TestHTrait::kPropertyHandle_C, 6 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    testPass = !mTestTdmSink1.WasCalledOffThread();
+    VerifyOrExit(testPass, );
+
+exit:
+    mSubscriptionEngine.EnableParallelDataListApplication(false);
+    mTestTdmSink.SetThreadSafe(false);
+
+    NL_TEST_ASSERT(inSuite, testPass);
+}
+#endif // WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+void TestTdm::TestTdmStatic_DataElementCache(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool testPass = false;
+    uint32_t numHits;
+
+    Reset();
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_A, 2);
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink.ValidateChangeSets( { { TestHTrait::kPropertyHandle_A, 2 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    numHits = mNotificationEngine->mDataElementCache.GetNumHits();
+
+    // Notifying the same unchanged data again (as would happen for a second subscriber) should be served from the cache.
+    mTestTdmSink.Reset();
+    mSubHandler->GetTraitInstanceInfoList()[0].SetDirty();
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink.ValidateChangeSets( { { TestHTrait::kPropertyHandle_A, 2 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    testPass = (mNotificationEngine->mDataElementCache.GetNumHits() == numHits + 1);
+    VerifyOrExit(testPass, );
+
+    // Modifying the source must invalidate the cached element.
+    mTestTdmSink.Reset();
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_A, 3);
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink.ValidateChangeSets( { { TestHTrait::kPropertyHandle_A, 3 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    testPass = (mNotificationEngine->mDataElementCache.GetNumHits() == numHits + 1);
+
+exit:
+    NL_TEST_ASSERT(inSuite, testPass);
+}
+#endif // WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+
+void TestTdm::TestTdmStatic_NotifyRateControl(nlTestSuite *inSuite)
+{
+    bool testPass = false;
+    SubscriptionHandler::HandlerState savedState = mSubHandler->mCurrentState;
+
+    mSubHandler->mCurrentState = SubscriptionHandler::kState_SubscriptionEstablished_Idle;
+    mSubHandler->ResetNotifyRateControl();
+    mSubHandler->SetNotifyRateControl(100, 1000);
+
+    // Nothing dirty, nothing to hold off.
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5000) == 0);
+    VerifyOrExit(testPass, );
+
+    // The first change opens the coalescing window; later changes don't extend it.
+    mSubHandler->OnDataDirty(5000);
+    mSubHandler->OnDataDirty(5050);
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5050) == 50);
+    VerifyOrExit(testPass, );
+
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5100) == 0);
+    VerifyOrExit(testPass, );
+
+    // Once a notify has gone out, the next one is held off until the minimum interval has elapsed.
+    mSubHandler->OnNotifySent(5100);
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5200) == 0);
+    VerifyOrExit(testPass, );
+
+    mSubHandler->OnDataDirty(5200);
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5200) == 900);
+    VerifyOrExit(testPass, );
+
+    // Notifies that prime a subscription are never held off.
+    mSubHandler->mCurrentState = SubscriptionHandler::kState_Subscribing;
+    testPass = (mSubHandler->GetNotifyHoldoffMsec(5200) == 0);
+
+exit:
+    mSubHandler->mCurrentState = savedState;
+    mSubHandler->ResetNotifyRateControl();
+
+    NL_TEST_ASSERT(inSuite, testPass);
+}
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+// Has the subscription handler process a subscribe request to the root of a trait instance, from a subscriber at aVersion.
+int TestTdm::ProcessSubscribeRequest(TraitDataHandle aTraitDataHandle, uint64_t aVersion)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint8_t backingStore[256];
+    TLVWriter writer;
+    TLVReader reader;
+    TLVType dummyContainerType;
+    SchemaVersionRange versionRange;
+    SubscribeRequest::Builder requestBuilder;
+    SubscribeRequest::Parser request;
+    uint32_t rejectReasonProfileId = 0;
+    uint16_t rejectReasonStatusCode = 0;
+
+    writer.Init(backingStore, sizeof(backingStore));
+
+    err = requestBuilder.Init(&writer);
+    SuccessOrExit(err);
+
+    {
+        PathList::Builder & pathList = requestBuilder.CreatePathListBuilder();
+
+        err = writer.StartContainer(AnonymousTag, kTLVType_Path, dummyContainerType);
+        SuccessOrExit(err);
+
+        err = mSourceCatalog.HandleToAddress(aTraitDataHandle, writer, versionRange);
+        SuccessOrExit(err);
+
+        err = writer.EndContainer(dummyContainerType);
+        SuccessOrExit(err);
+
+        pathList.EndOfPathList();
+        SuccessOrExit(err = pathList.GetError());
+    }
+
+    {
+        VersionList::Builder & versionList = requestBuilder.CreateVersionListBuilder();
+
+        versionList.AddVersion(aVersion);
+        versionList.EndOfVersionList();
+        SuccessOrExit(err = versionList.GetError());
+    }
+
+    requestBuilder.EndOfRequest();
+    SuccessOrExit(err = requestBuilder.GetError());
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    reader.Init(backingStore, writer.GetLengthWritten());
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = request.Init(reader);
+    SuccessOrExit(err);
+
+    err = mSubHandler->ParsePathVersionEventLists(request, rejectReasonProfileId, rejectReasonStatusCode);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+void TestTdm::TestTdmStatic_DeltaResync(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool testPass = false;
+    uint64_t subscriberVersion;
+    SubscriptionHandler::HandlerState savedState = mSubHandler->mCurrentState;
+    SubscriptionHandler::TraitInstanceInfo *traitInstance = &mSubHandler->GetTraitInstanceInfoList()[0];
+
+    Reset();
+
+    mTestTdmSource.Lock();
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_A, 2);
+    mTestTdmSource.Unlock();
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    subscriberVersion = mTestTdmSource.GetVersion();
+
+    mTestTdmSource.Lock();
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_B, 3);
+    mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_C, 4);
+    mTestTdmSource.Unlock();
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    // A subscriber resuming from the version before the last change only needs B and C.
+    mTestTdmSink.Reset();
+    mSubHandler->mCurrentState = SubscriptionHandler::kState_Subscribing;
+
+    err = ProcessSubscribeRequest(traitInstance->mTraitDataHandle, subscriberVersion);
+    SuccessOrExit(err);
+
+    testPass = traitInstance->IsDirty() && (traitInstance->GetDeltaSyncVersion() != NULL) &&
+        (*traitInstance->GetDeltaSyncVersion() == subscriberVersion);
+    VerifyOrExit(testPass, );
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    testPass = mTestTdmSink.ValidateChangeSets( { { TestHTrait::kPropertyHandle_B, 3 }, { TestHTrait::kPropertyHandle_C, 4 } },
+                                                { },
+                                                { } );
+    VerifyOrExit(testPass, );
+
+    // Once the changes since that version no longer fit in the journal, a full sync is needed.
+    mSubHandler->mCurrentState = SubscriptionHandler::kState_SubscriptionEstablished_Idle;
+
+    for (int i = 0; i < WDM_PUBLISHER_CHANGE_JOURNAL_SIZE; i++)
+    {
+        mTestTdmSource.Lock();
+        mTestTdmSource.SetValue(TestHTrait::kPropertyHandle_A, 5 + i);
+        mTestTdmSource.Unlock();
+    }
+
+    testPass = !mTestTdmSource.IsChangeJournalValidSince(subscriberVersion) &&
+        mTestTdmSource.IsChangeJournalValidSince(mTestTdmSource.GetVersion() - 1);
+    VerifyOrExit(testPass, );
+
+    mTestTdmSink.Reset();
+    mSubHandler->mCurrentState = SubscriptionHandler::kState_Subscribing;
+
+    err = ProcessSubscribeRequest(traitInstance->mTraitDataHandle, subscriberVersion);
+    SuccessOrExit(err);
+
+    testPass = traitInstance->IsDirty() && (traitInstance->GetDeltaSyncVersion() == NULL);
+    VerifyOrExit(testPass, );
+
+    err = BuildAndProcessNotify();
+    SuccessOrExit(err);
+
+    // The whole trait instance is sent: along with the changed A, B and C, D has not changed since the subscriber's version.
+    testPass = mTestTdmSink.IsModified(TestHTrait::kPropertyHandle_A) && mTestTdmSink.IsModified(TestHTrait::kPropertyHandle_B) &&
+        mTestTdmSink.IsModified(TestHTrait::kPropertyHandle_C) && mTestTdmSink.IsModified(TestHTrait::kPropertyHandle_D);
+
+exit:
+    mSubHandler->mCurrentState = savedState;
+    mNotificationEngine->mGraphSolver.ClearDirty();
+
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, testPass);
+}
+#endif // WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+
 void TestTdm::TestTdmStatic_SingleLeafHandle(nlTestSuite *inSuite)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
@@ -2252,6 +2771,420 @@ static void TestTdmStatic_MultiInstance(nlTestSuite *inSuite, void *inContext)
     gTestTdm->TestTdmStatic_MultiInstance(inSuite);
 }
 
+#if WDM_CLIENT_DATA_LIST_WORKER_THREAD_COUNT > 0
+static void TestTdmStatic_ParallelDataList(nlTestSuite *inSuite, void *inContext)
+{
+    gTestTdm->TestTdmStatic_ParallelDataList(inSuite);
+}
+#endif
+
+#if WDM_PUBLISHER_DATA_ELEMENT_CACHE_SIZE > 0
+static void TestTdmStatic_DataElementCache(nlTestSuite *inSuite, void *inContext)
+{
+    gTestTdm->TestTdmStatic_DataElementCache(inSuite);
+}
+#endif
+
+static void TestTdmStatic_NotifyRateControl(nlTestSuite *inSuite, void *inContext)
+{
+    gTestTdm->TestTdmStatic_NotifyRateControl(inSuite);
+}
+
+#if WDM_PUBLISHER_CHANGE_JOURNAL_SIZE > 0
+static void TestTdmStatic_DeltaResync(nlTestSuite *inSuite, void *inContext)
+{
+    gTestTdm->TestTdmStatic_DeltaResync(inSuite);
+}
+#endif
+
+/*
+ * A large synthetic trait used to compare schema navigation with and without a property tree index. It is a complete tree with
+ * kLargeTraitFanout structures at each of the first two levels and kLargeTraitFanout leaves under every second level structure,
+ * laid out breadth first in the handle table the way code-gen lays out traits.
+ */
+enum
+{
+    kLargeTraitFanout         = 10,
+    kLargeTraitNumHandles     = kLargeTraitFanout + kLargeTraitFanout * kLargeTraitFanout +
+                                kLargeTraitFanout * kLargeTraitFanout * kLargeTraitFanout,
+    kLargeTraitHashTblSize    = 2 * kLargeTraitNumHandles,
+    kLargeTraitNumIterations  = 20,
+};
+
+static TraitSchemaEngine::PropertyInfo sLargeTraitPropertyMap[kLargeTraitNumHandles];
+static PropertySchemaHandle sLargeTraitFirstChild[kLargeTraitNumHandles + TraitSchemaEngine::kHandleTableOffset];
+static PropertySchemaHandle sLargeTraitNextSibling[kLargeTraitNumHandles];
+static PropertySchemaHandle sLargeTraitChildHashTbl[kLargeTraitHashTblSize];
+
+static TraitSchemaEngine::PropertyTreeIndex sLargeTraitIndex = {
+    sLargeTraitFirstChild,
+    sLargeTraitNextSibling,
+    sLargeTraitChildHashTbl,
+    kLargeTraitHashTblSize,
+    false
+};
+
+// An index whose hash table is too small to hold every handle of the large trait.
+static TraitSchemaEngine::PropertyTreeIndex sLargeTraitUndersizedIndex = {
+    sLargeTraitFirstChild,
+    sLargeTraitNextSibling,
+    sLargeTraitChildHashTbl,
+    kLargeTraitNumHandles,
+    false
+};
+
+static const TraitSchemaEngine sLargeTraitSchema = {
+    {
+        0x7FFF0001,
+        sLargeTraitPropertyMap,
+        kLargeTraitNumHandles,
+        4,
+#if (TDM_EXTENSION_SUPPORT) || (TDM_VERSIONING_SUPPORT)
+        2,
+#endif
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+#if (TDM_EXTENSION_SUPPORT)
+        NULL,
+#endif
+#if (TDM_VERSIONING_SUPPORT)
+        NULL,
+#endif
+        NULL
+    }
+};
+
+static const TraitSchemaEngine sLargeTraitIndexedSchema = {
+    {
+        0x7FFF0001,
+        sLargeTraitPropertyMap,
+        kLargeTraitNumHandles,
+        4,
+#if (TDM_EXTENSION_SUPPORT) || (TDM_VERSIONING_SUPPORT)
+        2,
+#endif
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+#if (TDM_EXTENSION_SUPPORT)
+        NULL,
+#endif
+#if (TDM_VERSIONING_SUPPORT)
+        NULL,
+#endif
+        &sLargeTraitIndex
+    }
+};
+
+static const TraitSchemaEngine sLargeTraitUndersizedIndexSchema = {
+    {
+        0x7FFF0001,
+        sLargeTraitPropertyMap,
+        kLargeTraitNumHandles,
+        4,
+#if (TDM_EXTENSION_SUPPORT) || (TDM_VERSIONING_SUPPORT)
+        2,
+#endif
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+#if (TDM_EXTENSION_SUPPORT)
+        NULL,
+#endif
+#if (TDM_VERSIONING_SUPPORT)
+        NULL,
+#endif
+        &sLargeTraitUndersizedIndex
+    }
+};
+
+static PropertySchemaHandle LargeTraitHandle(int aLevel, int aIndex)
+{
+    static const int kLevelOffset[] = { 0, kLargeTraitFanout, kLargeTraitFanout + kLargeTraitFanout * kLargeTraitFanout };
+
+    return static_cast<PropertySchemaHandle>(kLevelOffset[aLevel] + aIndex + TraitSchemaEngine::kHandleTableOffset);
+}
+
+static void InitLargeTraitPropertyMap(void)
+{
+    int i = 0;
+
+    for (int level = 0; level < 3; level++)
+    {
+        int numNodes = 1;
+
+        for (int j = 0; j < level; j++)
+        {
+            numNodes *= kLargeTraitFanout;
+        }
+
+        for (int node = 0; node < numNodes; node++)
+        {
+            for (int child = 0; child < kLargeTraitFanout; child++, i++)
+            {
+                sLargeTraitPropertyMap[i].mParentHandle = (level == 0) ? kRootPropertyPathHandle : LargeTraitHandle(level - 1, node);
+                sLargeTraitPropertyMap[i].mContextTag   = static_cast<uint8_t>(child + 1);
+            }
+        }
+    }
+}
+
+// Resolves every leaf in the large trait one path step at a time, the way MapPathToHandle does, and returns the number of
+// leaves whose handle didn't resolve as expected.
+static int ResolveLargeTraitLeaves(const TraitSchemaEngine & aEngine)
+{
+    int numErrors = 0;
+
+    for (int a = 0; a < kLargeTraitFanout; a++)
+    {
+        for (int b = 0; b < kLargeTraitFanout; b++)
+        {
+            for (int c = 0; c < kLargeTraitFanout; c++)
+            {
+                PropertyPathHandle handle = kRootPropertyPathHandle;
+
+                handle = aEngine.GetChildHandle(handle, static_cast<uint8_t>(a + 1));
+                handle = aEngine.GetChildHandle(handle, static_cast<uint8_t>(b + 1));
+                handle = aEngine.GetChildHandle(handle, static_cast<uint8_t>(c + 1));
+
+                if (handle != LargeTraitHandle(2, (a * kLargeTraitFanout + b) * kLargeTraitFanout + c) || !aEngine.IsLeaf(handle))
+                {
+                    numErrors++;
+                }
+            }
+        }
+    }
+
+    return numErrors;
+}
+
+// Checks every child lookup of the large trait against the handles InitLargeTraitPropertyMap assigned, and returns the number
+// of lookups that didn't resolve as expected.
+static int CheckLargeTraitChildren(const TraitSchemaEngine & aEngine)
+{
+    int numErrors = 0;
+    int numNodes  = 1;
+
+    for (int level = 0; level < 3; level++)
+    {
+        for (int node = 0; node < numNodes; node++)
+        {
+            PropertyPathHandle parent = (level == 0) ? kRootPropertyPathHandle : LargeTraitHandle(level - 1, node);
+
+            for (int child = 0; child < kLargeTraitFanout; child++)
+            {
+                PropertyPathHandle expected = LargeTraitHandle(level, node * kLargeTraitFanout + child);
+
+                if (aEngine.GetChildHandle(parent, static_cast<uint8_t>(child + 1)) != expected || aEngine.GetParent(expected) != parent ||
+                    aEngine.IsLeaf(expected) != (level == 2))
+                {
+                    numErrors++;
+                }
+            }
+
+            if (!IsNullPropertyPathHandle(aEngine.GetChildHandle(parent, kLargeTraitFanout + 1)))
+            {
+                numErrors++;
+            }
+        }
+
+        numNodes *= kLargeTraitFanout;
+    }
+
+    return numErrors;
+}
+
+static void TestTdmLargeSchema_PropertyTreeIndex(nlTestSuite *inSuite, void *inContext)
+{
+    uint64_t startTime, linearTime, indexedTime;
+    int numChildren;
+    SingleResourceSourceTraitCatalog::CatalogItem catalogStore[1];
+    SingleResourceSourceTraitCatalog catalog(ResourceIdentifier(ResourceIdentifier::SELF_NODE_ID), catalogStore, 1);
+    TestEmptyDataSource largeTraitSource(&sLargeTraitIndexedSchema);
+    TraitDataHandle largeTraitHandle;
+
+    InitLargeTraitPropertyMap();
+
+    NL_TEST_ASSERT(inSuite, CheckLargeTraitChildren(sLargeTraitSchema) == 0);
+
+    // An undersized index is rejected, and lookups keep scanning the handle table.
+    NL_TEST_ASSERT(inSuite, sLargeTraitUndersizedIndexSchema.BuildPropertyTreeIndex() == WEAVE_ERROR_BUFFER_TOO_SMALL);
+    NL_TEST_ASSERT(inSuite, !sLargeTraitUndersizedIndex.mIsBuilt);
+    NL_TEST_ASSERT(inSuite, CheckLargeTraitChildren(sLargeTraitUndersizedIndexSchema) == 0);
+
+    // Lookups don't build the index as a side effect, they scan the handle table until it's built.
+    NL_TEST_ASSERT(inSuite, CheckLargeTraitChildren(sLargeTraitIndexedSchema) == 0);
+    NL_TEST_ASSERT(inSuite, !sLargeTraitIndex.mIsBuilt);
+
+    // Adding a trait instance to a catalog builds the index of its schema.
+    NL_TEST_ASSERT(inSuite, catalog.Add(0, &largeTraitSource, largeTraitHandle) == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, sLargeTraitIndex.mIsBuilt);
+    NL_TEST_ASSERT(inSuite, sLargeTraitIndexedSchema.BuildPropertyTreeIndex() == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, CheckLargeTraitChildren(sLargeTraitIndexedSchema) == 0);
+
+    // Both engines must agree on child iteration order, leaf-ness and child lookups, including for tags that don't exist.
+    for (PropertySchemaHandle handle = kRootPropertyPathHandle; handle < kLargeTraitNumHandles + TraitSchemaEngine::kHandleTableOffset;
+         handle++)
+    {
+        PropertyPathHandle linearChild  = sLargeTraitSchema.GetFirstChild(handle);
+        PropertyPathHandle indexedChild = sLargeTraitIndexedSchema.GetFirstChild(handle);
+
+        numChildren = 0;
+
+        while (!IsNullPropertyPathHandle(linearChild))
+        {
+            NL_TEST_ASSERT(inSuite, linearChild == indexedChild);
+
+            numChildren++;
+            linearChild  = sLargeTraitSchema.GetNextChild(handle, linearChild);
+            indexedChild = sLargeTraitIndexedSchema.GetNextChild(handle, indexedChild);
+        }
+
+        NL_TEST_ASSERT(inSuite, IsNullPropertyPathHandle(indexedChild));
+        NL_TEST_ASSERT(inSuite, sLargeTraitSchema.IsLeaf(handle) == sLargeTraitIndexedSchema.IsLeaf(handle));
+        NL_TEST_ASSERT(inSuite, sLargeTraitIndexedSchema.IsLeaf(handle) == (numChildren == 0));
+        NL_TEST_ASSERT(inSuite, IsNullPropertyPathHandle(sLargeTraitIndexedSchema.GetChildHandle(handle, kLargeTraitFanout + 1)));
+    }
+
+    startTime = System::Layer::GetClock_MonotonicHiRes();
+    for (int i = 0; i < kLargeTraitNumIterations; i++)
+    {
+        NL_TEST_ASSERT(inSuite, ResolveLargeTraitLeaves(sLargeTraitSchema) == 0);
+    }
+    linearTime = System::Layer::GetClock_MonotonicHiRes() - startTime;
+
+    startTime = System::Layer::GetClock_MonotonicHiRes();
+    for (int i = 0; i < kLargeTraitNumIterations; i++)
+    {
+        NL_TEST_ASSERT(inSuite, ResolveLargeTraitLeaves(sLargeTraitIndexedSchema) == 0);
+    }
+    indexedTime = System::Layer::GetClock_MonotonicHiRes() - startTime;
+
+    printf("Resolving %d leaf paths of a %d handle trait %d times: %lu usec with table scans, %lu usec with property tree index\n",
+           kLargeTraitFanout * kLargeTraitFanout * kLargeTraitFanout, kLargeTraitNumHandles, kLargeTraitNumIterations,
+           static_cast<unsigned long>(linearTime), static_cast<unsigned long>(indexedTime));
+}
+
+#if TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+static void TestTdmStatic_GeneratedSchemaIndex(nlTestSuite *inSuite, void *inContext)
+{
+    SingleResourceSourceTraitCatalog::CatalogItem catalogStore[1];
+    SingleResourceSourceTraitCatalog catalog(ResourceIdentifier(ResourceIdentifier::SELF_NODE_ID), catalogStore, 1);
+    TestEmptyDataSource dataSource(&TestHTrait::TraitSchema);
+    TraitDataHandle dataHandle;
+    const TraitSchemaEngine & indexedSchema = TestHTrait::TraitSchema;
+    const TraitSchemaEngine linearSchema    = { indexedSchema.mSchema };
+
+    // The generated schema doesn't provide index storage. Adding an instance of the trait to a catalog allocates its index from
+    // the shared pool and builds it.
+    NL_TEST_ASSERT(inSuite, catalog.Add(0, &dataSource, dataHandle) == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, indexedSchema.mSchema.mPropertyTreeIndex != NULL);
+    NL_TEST_ASSERT(inSuite, indexedSchema.mSchema.mPropertyTreeIndex != NULL && indexedSchema.mSchema.mPropertyTreeIndex->mIsBuilt);
+
+    // A copy of the schema without the index scans the handle table. Both must agree on child iteration order, leaf-ness and
+    // child lookups, including for tags that don't exist.
+    linearSchema.mSchema.mPropertyTreeIndex = NULL;
+
+    for (PropertySchemaHandle handle = kRootPropertyPathHandle;
+         handle < indexedSchema.mSchema.mNumSchemaHandleEntries + TraitSchemaEngine::kHandleTableOffset; handle++)
+    {
+        PropertyPathHandle linearChild  = linearSchema.GetFirstChild(handle);
+        PropertyPathHandle indexedChild = indexedSchema.GetFirstChild(handle);
+
+        while (!IsNullPropertyPathHandle(linearChild))
+        {
+            NL_TEST_ASSERT(inSuite, linearChild == indexedChild);
+
+            linearChild  = linearSchema.GetNextChild(handle, linearChild);
+            indexedChild = indexedSchema.GetNextChild(handle, indexedChild);
+        }
+
+        NL_TEST_ASSERT(inSuite, IsNullPropertyPathHandle(indexedChild));
+        NL_TEST_ASSERT(inSuite, linearSchema.IsLeaf(handle) == indexedSchema.IsLeaf(handle));
+
+        for (uint32_t tag = 0; tag <= UINT8_MAX; tag++)
+        {
+            NL_TEST_ASSERT(inSuite, linearSchema.GetChildHandle(handle, static_cast<uint8_t>(tag)) ==
+                                        indexedSchema.GetChildHandle(handle, static_cast<uint8_t>(tag)));
+        }
+    }
+}
+#endif // TDM_MAX_NUM_POOLED_PROPERTY_TREE_INDEXES > 0
+
+#if WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+void TestTdm::TestTdmLargeSchema_DirtyPathBitmapOverflow(nlTestSuite *inSuite)
+{
+    static TestEmptyDataSource largeTraitSource(&sLargeTraitSchema);
+    NotificationEngine::IntermediateGraphSolver & solver = mNotificationEngine->mGraphSolver;
+    PropertyPathBitmap bitmap;
+    PropertyPathBitmap::Word bitmapWords[NotificationEngine::IntermediateGraphSolver::DirtyPathBitmap::kNumWords];
+    TraitDataHandle testTdmSourceHandle;
+    TraitDataHandle largeTraitHandle;
+    WEAVE_ERROR err;
+
+    InitLargeTraitPropertyMap();
+    Reset();
+
+    // A bitmap sized for the largest supported trait can't take the large trait.
+    bitmap.Init(bitmapWords, ArraySize(bitmapWords), NULL, 0);
+    NL_TEST_ASSERT(inSuite, bitmap.Attach(&sLargeTraitSchema) == WEAVE_ERROR_BUFFER_TOO_SMALL);
+    NL_TEST_ASSERT(inSuite, bitmap.AddItem(LargeTraitHandle(2, 0)) == WEAVE_ERROR_INCORRECT_STATE);
+    NL_TEST_ASSERT(inSuite, bitmap.Attach(&TestHTrait::TraitSchema) == WEAVE_NO_ERROR);
+
+    err = mSourceCatalog.Locate(&mTestTdmSource, testTdmSourceHandle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = mSourceCatalog.Add(4, &largeTraitSource, largeTraitHandle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Dirty leaves of a trait that fits are tracked in a bitmap, without using up the granular dirty store.
+    mTestTdmSource.SetDirty(TestHTrait::kPropertyHandle_A);
+    mTestTdmSource.SetDirty(TestHTrait::kPropertyHandle_B);
+    mTestTdmSource.SetDirty(TestHTrait::kPropertyHandle_C);
+
+    NL_TEST_ASSERT(inSuite, solver.GetDirtyPathBitmap(testTdmSourceHandle) != NULL);
+    NL_TEST_ASSERT(inSuite, solver.GetDirtyPathBitmap(testTdmSourceHandle)->mPaths.GetNumItems() == 3);
+    NL_TEST_ASSERT(inSuite, solver.mDirtyStore.GetNumItems() == 0);
+
+    // Dirty leaves of the large trait fall back to the granular dirty store...
+    largeTraitSource.SetDirty(LargeTraitHandle(2, 0));
+
+    NL_TEST_ASSERT(inSuite, solver.GetDirtyPathBitmap(largeTraitHandle) == NULL);
+    NL_TEST_ASSERT(inSuite, solver.mDirtyStore.IsPresent(TraitPath(largeTraitHandle, LargeTraitHandle(2, 0))));
+    NL_TEST_ASSERT(inSuite, !largeTraitSource.IsRootDirty());
+
+    // ...and once it is full, to marking the whole trait instance dirty.
+    for (int i = 1; i <= WDM_PUBLISHER_MAX_ITEMS_IN_TRAIT_DIRTY_STORE; i++)
+    {
+        largeTraitSource.SetDirty(LargeTraitHandle(2, i));
+    }
+
+    NL_TEST_ASSERT(inSuite, largeTraitSource.IsRootDirty());
+    NL_TEST_ASSERT(inSuite, !solver.mDirtyStore.IsPresent(TraitPath(largeTraitHandle, LargeTraitHandle(2, 0))));
+
+    // The trait that fits is unaffected.
+    NL_TEST_ASSERT(inSuite, !mTestTdmSource.IsRootDirty());
+    NL_TEST_ASSERT(inSuite, solver.GetDirtyPathBitmap(testTdmSourceHandle)->mPaths.GetNumItems() == 3);
+
+    Reset();
+    largeTraitSource.ClearRootDirty();
+    mSourceCatalog.Remove(largeTraitHandle);
+}
+
+static void TestTdmLargeSchema_DirtyPathBitmapOverflow(nlTestSuite *inSuite, void *inContext)
+{
+    gTestTdm->TestTdmLargeSchema_DirtyPathBitmapOverflow(inSuite);
+}
+#endif // WDM_PUBLISHER_NUM_DIRTY_PATH_BITMAPS > 0
+
 static void CheckAllocateRightSizedBufferForNotifications(nlTestSuite *inSuite, void *inContext)
 {
     gTestTdm->CheckAllocateRightSizedBufferForNotifications(inSuite);
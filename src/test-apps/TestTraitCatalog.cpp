@@ -0,0 +1,389 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the MultiResourceTraitCatalog
+ *      class.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlbyteorder.h>
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+
+#include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+#include <nest/test/trait/TestCTrait.h>
+#include <nest/test/trait/TestHTrait.h>
+
+using namespace nl;
+using namespace nl::Weave::TLV;
+using namespace nl::Weave::Profiles::DataManagement;
+using namespace Schema::Nest::Test::Trait;
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current) {
+namespace Platform {
+    // for unit tests, the dummy critical section is sufficient.
+    void CriticalSectionEnter()
+    {
+        return;
+    }
+
+    void CriticalSectionExit()
+    {
+        return;
+    }
+} // Platform
+
+template <const TraitSchemaEngine * SchemaEngine>
+class CatalogTestSink : public TraitDataSink
+{
+public:
+    CatalogTestSink() : TraitDataSink(SchemaEngine) { }
+
+private:
+    WEAVE_ERROR SetLeafData(PropertyPathHandle aLeafHandle, TLVReader & aReader) { return WEAVE_NO_ERROR; }
+};
+
+typedef CatalogTestSink<&TestHTrait::TraitSchema> TestHSink;
+typedef CatalogTestSink<&TestCTrait::TraitSchema> TestCSink;
+
+class TraitCatalogTest
+{
+public:
+    enum
+    {
+        kNumResources = 10,
+        kNumInstances = 50,
+        kNumProfiles  = 2,
+        kNumItems     = kNumResources * kNumInstances * kNumProfiles,
+    };
+
+    TraitCatalogTest();
+    ~TraitCatalogTest() { }
+
+    void TestAddLocate(nlTestSuite * inSuite, void * inContext);
+    void TestRemoveAdd(nlTestSuite * inSuite, void * inContext);
+    void TestAddressRoundTrip(nlTestSuite * inSuite, void * inContext);
+
+private:
+    static void CollectHandles(void * aTraitInstance, TraitDataHandle aHandle, void * aContext);
+
+    void FillCatalog(nlTestSuite * inSuite);
+    uint32_t GetIndex(uint32_t aResource, uint32_t aProfile, uint32_t aInstance) const
+    {
+        return (aResource * kNumProfiles + aProfile) * kNumInstances + aInstance;
+    }
+    TraitDataSink * GetSink(uint32_t aIndex)
+    {
+        // Every other block of instances is of the second profile
+        if ((aIndex / kNumInstances) % kNumProfiles == 0)
+        {
+            return &mHSinks[(aIndex / (kNumInstances * kNumProfiles)) * kNumInstances + aIndex % kNumInstances];
+        }
+
+        return &mCSinks[(aIndex / (kNumInstances * kNumProfiles)) * kNumInstances + aIndex % kNumInstances];
+    }
+    ResourceIdentifier GetResourceId(uint32_t aResource) const
+    {
+        return ResourceIdentifier(0x18B4300000000000ULL + aResource);
+    }
+
+    TestHSink mHSinks[kNumResources * kNumInstances];
+    TestCSink mCSinks[kNumResources * kNumInstances];
+    TraitDataHandle mHandles[kNumItems];
+
+    MultiResourceSinkTraitCatalog::CatalogItem mCatalogStore[kNumItems];
+    MultiResourceSinkTraitCatalog::Bucket mBuckets[kNumItems];
+    MultiResourceSinkTraitCatalog mCatalog;
+
+    TraitDataHandle mIterated[kNumItems];
+    uint32_t mNumIterated;
+};
+
+TraitCatalogTest::TraitCatalogTest() :
+    mCatalog(ResourceIdentifier(ResourceIdentifier::RESOURCE_TYPE_RESERVED, ResourceIdentifier::SELF_NODE_ID), mCatalogStore,
+             ArraySize(mCatalogStore), mBuckets, ArraySize(mBuckets)),
+    mNumIterated(0)
+{
+}
+
+void TraitCatalogTest::CollectHandles(void * aTraitInstance, TraitDataHandle aHandle, void * aContext)
+{
+    TraitCatalogTest * self = static_cast<TraitCatalogTest *>(aContext);
+
+    self->mIterated[self->mNumIterated++] = aHandle;
+}
+
+void TraitCatalogTest::FillCatalog(nlTestSuite * inSuite)
+{
+    WEAVE_ERROR err;
+
+    for (uint32_t resource = 0; resource < kNumResources; resource++)
+    {
+        for (uint32_t profile = 0; profile < kNumProfiles; profile++)
+        {
+            for (uint32_t instance = 0; instance < kNumInstances; instance++)
+            {
+                uint32_t i = GetIndex(resource, profile, instance);
+
+                err = mCatalog.Add(GetResourceId(resource), instance, GetSink(i), mHandles[i]);
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            }
+        }
+    }
+}
+
+void TraitCatalogTest::TestAddLocate(nlTestSuite * inSuite, void * inContext)
+{
+    WEAVE_ERROR err;
+    TraitDataHandle handle;
+    TraitDataSink * sink;
+    TestHSink extraSink;
+
+    FillCatalog(inSuite);
+    NL_TEST_ASSERT(inSuite, mCatalog.Count() == kNumItems);
+
+    for (uint32_t resource = 0; resource < kNumResources; resource++)
+    {
+        for (uint32_t profile = 0; profile < kNumProfiles; profile++)
+        {
+            for (uint32_t instance = 0; instance < kNumInstances; instance++)
+            {
+                uint32_t i = GetIndex(resource, profile, instance);
+
+                err = mCatalog.Locate(GetResourceId(resource), GetSink(i)->GetSchemaEngine()->GetProfileId(), instance, handle);
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[i]);
+
+                err = mCatalog.Locate(mHandles[i], &sink);
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && sink == GetSink(i));
+
+                err = mCatalog.Locate(GetSink(i), handle);
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[i]);
+            }
+        }
+    }
+
+    // Unknown resource, unknown instance
+    err = mCatalog.Locate(GetResourceId(kNumResources), TestHTrait::kWeaveProfileId, 0, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_PROFILE_ID);
+
+    err = mCatalog.Locate(GetResourceId(0), TestHTrait::kWeaveProfileId, kNumInstances, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_PROFILE_ID);
+
+    // Addresses are unique, and the catalog is full
+    err = mCatalog.Add(GetResourceId(0), 0, &extraSink, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mCatalog.Add(GetResourceId(kNumResources), 0, &extraSink, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_NO_MEMORY);
+}
+
+void TraitCatalogTest::TestRemoveAdd(nlTestSuite * inSuite, void * inContext)
+{
+    WEAVE_ERROR err;
+    TraitDataHandle handle;
+    TraitDataSink * sink;
+    uint32_t removed = GetIndex(3, 1, 7);
+    uint32_t kept    = GetIndex(3, 1, 8);
+
+    err = mCatalog.Remove(mHandles[removed]);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mCatalog.Count() == kNumItems - 1);
+
+    err = mCatalog.Remove(mHandles[removed]);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mCatalog.Locate(GetResourceId(3), TestCTrait::kWeaveProfileId, 7, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_PROFILE_ID);
+
+    err = mCatalog.Locate(mHandles[removed], &sink);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mCatalog.Locate(GetSink(removed), handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mCatalog.Locate(GetResourceId(3), TestCTrait::kWeaveProfileId, 8, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[kept]);
+
+    // Iteration skips the removed item and keeps handle order
+    mNumIterated = 0;
+    mCatalog.Iterate(CollectHandles, this);
+    NL_TEST_ASSERT(inSuite, mNumIterated == kNumItems - 1);
+
+    for (uint32_t i = 1; i < mNumIterated; i++)
+    {
+        NL_TEST_ASSERT(inSuite, mIterated[i - 1] < mIterated[i]);
+        NL_TEST_ASSERT(inSuite, mIterated[i] != mHandles[removed]);
+    }
+
+    // The store is full, so the freed handle is handed out again
+    err = mCatalog.Add(GetResourceId(kNumResources), 7, GetSink(removed), handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[removed]);
+    NL_TEST_ASSERT(inSuite, mCatalog.Count() == kNumItems);
+
+    err = mCatalog.Locate(GetResourceId(kNumResources), TestCTrait::kWeaveProfileId, 7, handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[removed]);
+
+    err = mCatalog.Locate(GetSink(removed), handle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == mHandles[removed]);
+}
+
+void TraitCatalogTest::TestAddressRoundTrip(nlTestSuite * inSuite, void * inContext)
+{
+    WEAVE_ERROR err;
+    uint8_t buf[64];
+    TLVWriter writer;
+    TLVReader reader;
+    TLVType container;
+    TraitDataHandle handle;
+    TraitDataHandle selfHandle;
+    SchemaVersionRange versionRange;
+    TestHSink selfSink;
+    uint32_t i = GetIndex(5, 0, 42);
+
+    // The last item in the store has been replaced by TestRemoveAdd; put a sink of the self resource in its place.
+    err = mCatalog.Remove(mHandles[kNumItems - 1]);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = mCatalog.Add(ResourceIdentifier(ResourceIdentifier::RESOURCE_TYPE_RESERVED, ResourceIdentifier::SELF_NODE_ID), 1,
+                       &selfSink, selfHandle);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        TraitDataHandle expected = (pass == 0) ? mHandles[i] : selfHandle;
+
+        writer.Init(buf, sizeof(buf));
+
+        err = writer.StartContainer(AnonymousTag, kTLVType_Path, container);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = mCatalog.HandleToAddress(expected, writer, versionRange);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = writer.EndContainer(container);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = writer.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        reader.Init(buf, writer.GetLengthWritten());
+
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = mCatalog.AddressToHandle(reader, handle, versionRange);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR && handle == expected);
+    }
+
+    mCatalog.Remove(selfHandle);
+}
+
+} // WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
+} // Profiles
+} // Weave
+} // nl
+
+static SubscriptionEngine *gSubscriptionEngine;
+
+SubscriptionEngine * SubscriptionEngine::GetInstance()
+{
+    return gSubscriptionEngine;
+}
+
+static TraitCatalogTest * gTraitCatalogTest;
+
+void TraitCatalogTest_AddLocate(nlTestSuite *inSuite, void *inContext)
+{
+    gTraitCatalogTest->TestAddLocate(inSuite, inContext);
+}
+
+void TraitCatalogTest_RemoveAdd(nlTestSuite *inSuite, void *inContext)
+{
+    gTraitCatalogTest->TestRemoveAdd(inSuite, inContext);
+}
+
+void TraitCatalogTest_AddressRoundTrip(nlTestSuite *inSuite, void *inContext)
+{
+    gTraitCatalogTest->TestAddressRoundTrip(inSuite, inContext);
+}
+
+// Test Suite
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Add and Locate 1000 instances of 10 resources",  TraitCatalogTest_AddLocate),
+    NL_TEST_DEF("Remove and Add",  TraitCatalogTest_RemoveAdd),
+    NL_TEST_DEF("HandleToAddress and AddressToHandle",  TraitCatalogTest_AddressRoundTrip),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int TestSetup(void *inContext)
+{
+    gSubscriptionEngine = NULL;
+    gTraitCatalogTest = new TraitCatalogTest();
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int TestTeardown(void *inContext)
+{
+    delete gTraitCatalogTest;
+    gTraitCatalogTest = NULL;
+
+    return 0;
+}
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+    nlTestSuite theSuite = {
+        "weave-TraitCatalog",
+        &sTests[0],
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, NULL);
+
+    return nlTestRunnerStats(&theSuite);
+}
@@ -0,0 +1,860 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the WDM MultiViewClient, which
+ *      retrieves a list of paths with a window of ViewRequests.
+ *
+ *      The requests are sent to the node itself over the loopback interface,
+ *      and answered by the test in any order.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlbyteorder.h>
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveServerBase.h>
+
+#include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+#include <nest/test/trait/TestATrait.h>
+#include "MockSinkTraits.h"
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+
+#define PRINT_TEST_NAME() printf("\n%s\n", __func__);
+
+
+
+using namespace nl;
+using namespace nl::Weave::TLV;
+using namespace nl::Weave::Profiles::DataManagement;
+using namespace Schema::Nest::Test::Trait;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// System/Platform definitions
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current) {
+
+SubscriptionEngine * SubscriptionEngine::GetInstance()
+{
+    static SubscriptionEngine *gSubscriptionEngine = NULL;
+    return gSubscriptionEngine;
+}
+
+namespace Platform {
+    // For unit tests, a dummy critical section is sufficient.
+    void CriticalSectionEnter()
+    {
+        return;
+    }
+
+    void CriticalSectionExit()
+    {
+        return;
+    }
+
+} // Platform
+
+} // WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
+} // Profiles
+} // Weave
+} // nl
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+
+class WdmMultiViewClientTest {
+    public:
+        WdmMultiViewClientTest();
+        ~WdmMultiViewClientTest() { }
+
+        // Tests
+        void SetupTest(nlTestSuite *inSuite);
+        void TearDownTest();
+
+        void TestSplitAndPipeline(nlTestSuite *inSuite, void *inContext);
+        void TestStatusReportFailsOneRequest(nlTestSuite *inSuite, void *inContext);
+        void TestSendFailureReportedByEvent(nlTestSuite *inSuite, void *inContext);
+        void TestBadInputs(nlTestSuite *inSuite, void *inContext);
+
+    private:
+        enum
+        {
+            // Enough paths for more requests than fit in the window
+            kNumPaths = 1000,
+
+            kMaxNumRequests = 64,
+            kMaxNumEvents = 64,
+
+            // Every path of the list takes less than this in a ViewRequest
+            kMaxEncodedPathSize = 32,
+
+            // How long the requests are held before being answered
+            kResponseDelayMsec = 20,
+
+            kTimeoutMsec = 5000,
+        };
+
+        // A ViewRequest received by the publisher side of the test
+        struct ReceivedRequest
+        {
+            nl::Weave::ExchangeContext *mEC;
+            size_t mNumPaths;
+            uint16_t mPayloadLength;
+        };
+
+        // What the MultiViewClient reported to the application
+        struct EventRecord
+        {
+            MultiViewClient::EventID mEvent;
+            WEAVE_ERROR mError;
+            size_t mFirstPath;
+            size_t mNumPaths;
+            bool mHasStatusReport;
+        };
+
+        MultiViewClient mClient;
+        Binding *mBinding;
+
+        // The Trait instance the paths belong to
+        TestATraitDataSink mTestATraitDataSink;
+
+        // The catalog
+        SingleResourceSinkTraitCatalog mSinkCatalog;
+        SingleResourceSinkTraitCatalog::CatalogItem mSinkCatalogStore[1];
+        TraitDataHandle mTestATraitDataSinkHandle;
+
+        TraitPath mPaths[kNumPaths];
+
+        ReceivedRequest mRequests[kMaxNumRequests];
+        size_t mNumRequests;
+        size_t mMaxNumPending;
+
+        EventRecord mEvents[kMaxNumEvents];
+        size_t mNumEvents;
+
+        // Test support functions
+        size_t GetNumPending(void) const;
+        void ServiceEventsFor(uint32_t aMsec);
+        void ServiceEventsUntilPending(size_t aNumPending);
+        void ServiceEventsUntilComplete(void);
+        void SendResponse(nlTestSuite *inSuite, ReceivedRequest &aRequest, bool aFail);
+        bool RespondToWindow(nlTestSuite *inSuite, size_t aRequestToFail);
+        size_t CountEvents(MultiViewClient::EventID aEvent) const;
+        void VerifyPathCoverage(nlTestSuite *inSuite);
+
+        static void HandleViewRequest(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                      const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId, uint8_t aMsgType,
+                                      PacketBuffer *aPayload);
+        static WEAVE_ERROR HandleDataElement(void * const apAppState, DataElement::Parser & aDataElement);
+        static void ClientEventCallback(void * const aAppState, MultiViewClient::EventID aEvent, WEAVE_ERROR aErrorCode,
+                                        MultiViewClient::EventParam & aEventParam);
+};
+
+WdmMultiViewClientTest::WdmMultiViewClientTest() :
+    mBinding(NULL),
+    mSinkCatalog(ResourceIdentifier(ResourceIdentifier::SELF_NODE_ID),
+            mSinkCatalogStore, sizeof(mSinkCatalogStore) / sizeof(mSinkCatalogStore[0])),
+    mNumRequests(0),
+    mMaxNumPending(0),
+    mNumEvents(0)
+{
+    mSinkCatalog.Add(0, &mTestATraitDataSink, mTestATraitDataSinkHandle);
+
+    for (uint32_t i = 0; i < kNumPaths; i++)
+    {
+        mPaths[i].mTraitDataHandle = mTestATraitDataSinkHandle;
+        mPaths[i].mPropertyPathHandle = CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, i);
+    }
+}
+
+void WdmMultiViewClientTest::SetupTest(nlTestSuite *inSuite)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Inet::IPAddress peerAddr;
+
+    mNumRequests = 0;
+    mMaxNumPending = 0;
+    mNumEvents = 0;
+
+    nl::Inet::IPAddress::FromString("::1", peerAddr);
+
+    // The requests are sent to this node, and handled by HandleViewRequest
+    err = ExchangeMgr.RegisterUnsolicitedMessageHandler(nl::Weave::Profiles::kWeaveProfile_WDM, kMsgType_ViewRequest,
+                                                        HandleViewRequest, this);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    mBinding = ExchangeMgr.NewBinding();
+    NL_TEST_ASSERT(inSuite, mBinding != NULL);
+    VerifyOrExit(mBinding != NULL, );
+
+    err = mBinding->BeginConfiguration()
+              .Target_NodeId(FabricState.LocalNodeId)
+              .TargetAddress_IP(peerAddr)
+              .Transport_UDP()
+              .Security_None()
+              .PrepareBinding();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBinding->IsReady());
+
+    err = mClient.Init(mBinding, this, ClientEventCallback);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    mClient.ResetStatistics();
+
+exit:
+    return;
+}
+
+void WdmMultiViewClientTest::TearDownTest()
+{
+    mClient.Cancel();
+
+    for (size_t i = 0; i < mNumRequests; i++)
+    {
+        if (mRequests[i].mEC != NULL)
+        {
+            mRequests[i].mEC->Close();
+            mRequests[i].mEC = NULL;
+        }
+    }
+
+    if (mBinding != NULL)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+
+    ExchangeMgr.UnregisterUnsolicitedMessageHandler(nl::Weave::Profiles::kWeaveProfile_WDM, kMsgType_ViewRequest);
+}
+
+size_t WdmMultiViewClientTest::GetNumPending(void) const
+{
+    size_t numPending = 0;
+
+    for (size_t i = 0; i < mNumRequests; i++)
+    {
+        if (mRequests[i].mEC != NULL)
+        {
+            numPending++;
+        }
+    }
+
+    return numPending;
+}
+
+void WdmMultiViewClientTest::ServiceEventsFor(uint32_t aMsec)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + aMsec;
+
+    while (System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 1000;
+
+        ServiceEvents(sleepTime);
+    }
+}
+
+void WdmMultiViewClientTest::ServiceEventsUntilPending(size_t aNumPending)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kTimeoutMsec;
+
+    while (GetNumPending() < aNumPending && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        ServiceEventsFor(1);
+    }
+}
+
+void WdmMultiViewClientTest::ServiceEventsUntilComplete(void)
+{
+    const uint64_t endMsec = System::Layer::GetClock_MonotonicMS() + kTimeoutMsec;
+
+    while (mClient.IsViewInProgress() && System::Layer::GetClock_MonotonicMS() < endMsec)
+    {
+        ServiceEventsFor(1);
+    }
+}
+
+/**
+ * Answers a request with an empty ViewResponse, or with a StatusReport if aFail is true.
+ */
+void WdmMultiViewClientTest::SendResponse(nlTestSuite *inSuite, ReceivedRequest &aRequest, bool aFail)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *buf = NULL;
+
+    if (aFail)
+    {
+        err = nl::Weave::WeaveServerBase::SendStatusReport(aRequest.mEC, nl::Weave::Profiles::kWeaveProfile_Common,
+                                                           nl::Weave::Profiles::Common::kStatus_Busy, WEAVE_NO_ERROR);
+        SuccessOrExit(err);
+    }
+    else
+    {
+        TLVWriter writer;
+        TLVType dummyContainerType;
+        DataList::Builder dataList;
+
+        buf = PacketBuffer::New();
+        VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        writer.Init(buf);
+
+        err = writer.StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
+        SuccessOrExit(err);
+
+        err = dataList.Init(&writer, ViewResponse::kCsTag_DataList);
+        SuccessOrExit(err);
+
+        err = dataList.EndOfDataList().GetError();
+        SuccessOrExit(err);
+
+        err = writer.EndContainer(dummyContainerType);
+        SuccessOrExit(err);
+
+        err = writer.Finalize();
+        SuccessOrExit(err);
+
+        err = aRequest.mEC->SendMessage(nl::Weave::Profiles::kWeaveProfile_WDM, kMsgType_ViewResponse, buf);
+        buf = NULL;
+        SuccessOrExit(err);
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (buf != NULL)
+    {
+        PacketBuffer::Free(buf);
+    }
+
+    aRequest.mEC->Close();
+    aRequest.mEC = NULL;
+}
+
+/**
+ * Lets the client fill its window and the requests age, then answers all the
+ * pending requests, newest first.
+ *
+ * @param[in] aRequestToFail    The index of a request to answer with a
+ *                              StatusReport, or kMaxNumRequests.
+ *
+ * @return true if there were requests to answer.
+ */
+bool WdmMultiViewClientTest::RespondToWindow(nlTestSuite *inSuite, size_t aRequestToFail)
+{
+    bool responded = false;
+
+    ServiceEventsFor(kResponseDelayMsec);
+
+    NL_TEST_ASSERT(inSuite, GetNumPending() <= WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+
+    for (size_t i = mNumRequests; i > 0; i--)
+    {
+        ReceivedRequest &request = mRequests[i - 1];
+
+        if (request.mEC != NULL)
+        {
+            SendResponse(inSuite, request, (i - 1) == aRequestToFail);
+            responded = true;
+        }
+    }
+
+    return responded;
+}
+
+size_t WdmMultiViewClientTest::CountEvents(MultiViewClient::EventID aEvent) const
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < mNumEvents; i++)
+    {
+        if (mEvents[i].mEvent == aEvent)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Checks that every path of the list has been reported exactly once, either
+ * as retrieved or as failed.
+ */
+void WdmMultiViewClientTest::VerifyPathCoverage(nlTestSuite *inSuite)
+{
+    uint8_t coverage[kNumPaths];
+
+    memset(coverage, 0, sizeof(coverage));
+
+    for (size_t i = 0; i < mNumEvents; i++)
+    {
+        const EventRecord &event = mEvents[i];
+
+        if (event.mEvent == MultiViewClient::kEvent_ViewComplete)
+        {
+            continue;
+        }
+
+        NL_TEST_ASSERT(inSuite, event.mFirstPath + event.mNumPaths <= kNumPaths);
+
+        for (size_t j = event.mFirstPath; j < event.mFirstPath + event.mNumPaths && j < kNumPaths; j++)
+        {
+            coverage[j]++;
+        }
+    }
+
+    for (size_t i = 0; i < kNumPaths; i++)
+    {
+        NL_TEST_ASSERT(inSuite, coverage[i] == 1);
+    }
+}
+
+void WdmMultiViewClientTest::TestSplitAndPipeline(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    size_t numPaths = 0;
+    uint16_t maxPayloadLength = 0;
+    size_t iterations = 0;
+
+    PRINT_TEST_NAME();
+
+    err = mClient.SendRequest(&mSinkCatalog, mPaths, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // The list takes more requests than the window holds: the window is full
+    ServiceEventsUntilPending(WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+    NL_TEST_ASSERT(inSuite, GetNumPending() == WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+
+    // A second view can't be sent until the first one completes
+    err = mClient.SendRequest(&mSinkCatalog, mPaths, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+
+    while (mClient.IsViewInProgress() && iterations++ < kMaxNumRequests)
+    {
+        RespondToWindow(inSuite, kMaxNumRequests);
+    }
+
+    ServiceEventsUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, !mClient.IsViewInProgress());
+    NL_TEST_ASSERT(inSuite, mMaxNumPending == WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+    NL_TEST_ASSERT(inSuite, mNumRequests > WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+
+    // The requests carry the whole list, and are filled up to the size limit
+    for (size_t i = 0; i < mNumRequests; i++)
+    {
+        numPaths += mRequests[i].mNumPaths;
+
+        NL_TEST_ASSERT(inSuite, mRequests[i].mPayloadLength <= WDM_MAX_VIEW_REQUEST_SIZE);
+
+        if (mRequests[i].mPayloadLength > maxPayloadLength)
+        {
+            maxPayloadLength = mRequests[i].mPayloadLength;
+        }
+    }
+
+    NL_TEST_ASSERT(inSuite, numPaths == kNumPaths);
+
+    for (size_t i = 0; i + 1 < mNumRequests; i++)
+    {
+        NL_TEST_ASSERT(inSuite, mRequests[i].mPayloadLength + kMaxEncodedPathSize > maxPayloadLength);
+    }
+
+    // One response consumed per request, then the view completes
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewResponseConsumed) == mNumRequests);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_RequestFailed) == 0);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewComplete) == 1);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mEvent == MultiViewClient::kEvent_ViewComplete);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mError == WEAVE_NO_ERROR);
+
+    VerifyPathCoverage(inSuite);
+
+    {
+        const MultiViewClient::Statistics &stats = mClient.GetStatistics();
+
+        NL_TEST_ASSERT(inSuite, stats.mNumRequestsSent == mNumRequests);
+        NL_TEST_ASSERT(inSuite, stats.mNumRequestsFailed == 0);
+        NL_TEST_ASSERT(inSuite, stats.mNumResponsesReceived == mNumRequests);
+        NL_TEST_ASSERT(inSuite, stats.mMinLatencyMsec >= kResponseDelayMsec);
+        NL_TEST_ASSERT(inSuite, stats.mMaxLatencyMsec >= stats.mMinLatencyMsec);
+        NL_TEST_ASSERT(inSuite, stats.mTotalLatencyMsec >= static_cast<uint64_t>(stats.mMinLatencyMsec) * mNumRequests);
+        NL_TEST_ASSERT(inSuite, stats.mTotalLatencyMsec <= static_cast<uint64_t>(stats.mMaxLatencyMsec) * mNumRequests);
+    }
+
+    mClient.ResetStatistics();
+
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mNumRequestsSent == 0);
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mNumResponsesReceived == 0);
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mTotalLatencyMsec == 0);
+}
+
+void WdmMultiViewClientTest::TestStatusReportFailsOneRequest(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const size_t requestToFail = 1;
+    size_t iterations = 0;
+
+    PRINT_TEST_NAME();
+
+    err = mClient.SendRequest(&mSinkCatalog, mPaths, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    ServiceEventsUntilPending(WDM_VIEW_CLIENT_MAX_IN_FLIGHT_REQUESTS);
+    NL_TEST_ASSERT(inSuite, GetNumPending() > requestToFail);
+
+    while (mClient.IsViewInProgress() && iterations++ < kMaxNumRequests)
+    {
+        RespondToWindow(inSuite, requestToFail);
+    }
+
+    ServiceEventsUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, !mClient.IsViewInProgress());
+
+    // Only the paths of the failed request are reported as failed, with the StatusReport
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_RequestFailed) == 1);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewResponseConsumed) == mNumRequests - 1);
+
+    for (size_t i = 0; i < mNumEvents; i++)
+    {
+        if (mEvents[i].mEvent == MultiViewClient::kEvent_RequestFailed)
+        {
+            NL_TEST_ASSERT(inSuite, mEvents[i].mError == WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+            NL_TEST_ASSERT(inSuite, mEvents[i].mHasStatusReport);
+            NL_TEST_ASSERT(inSuite, mEvents[i].mFirstPath == mRequests[0].mNumPaths);
+            NL_TEST_ASSERT(inSuite, mEvents[i].mNumPaths == mRequests[requestToFail].mNumPaths);
+        }
+    }
+
+    // The view still completes, with the error of the failed request
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewComplete) == 1);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mEvent == MultiViewClient::kEvent_ViewComplete);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mError == WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+
+    VerifyPathCoverage(inSuite);
+
+    {
+        const MultiViewClient::Statistics &stats = mClient.GetStatistics();
+
+        NL_TEST_ASSERT(inSuite, stats.mNumRequestsSent == mNumRequests);
+        NL_TEST_ASSERT(inSuite, stats.mNumRequestsFailed == 1);
+
+        // StatusReports count as responses
+        NL_TEST_ASSERT(inSuite, stats.mNumResponsesReceived == mNumRequests);
+    }
+}
+
+void WdmMultiViewClientTest::TestSendFailureReportedByEvent(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Weave::ExchangeContext *contexts[WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS];
+    size_t numContexts = 0;
+
+    PRINT_TEST_NAME();
+
+    // Run out of exchange contexts, so that the first request can't be sent
+    while (numContexts < ArraySize(contexts))
+    {
+        contexts[numContexts] = ExchangeMgr.NewContext(FabricState.LocalNodeId, this);
+
+        if (contexts[numContexts] == NULL)
+        {
+            break;
+        }
+
+        numContexts++;
+    }
+
+    // The failure is reported through the events only
+    err = mClient.SendRequest(&mSinkCatalog, mPaths, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    for (size_t i = 0; i < numContexts; i++)
+    {
+        contexts[i]->Close();
+    }
+
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_RequestFailed) > 0);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewComplete) == 0);
+
+    // The view completes once the client gets back to the event loop
+    ServiceEventsUntilComplete();
+
+    NL_TEST_ASSERT(inSuite, !mClient.IsViewInProgress());
+    NL_TEST_ASSERT(inSuite, mNumRequests == 0);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewResponseConsumed) == 0);
+    NL_TEST_ASSERT(inSuite, CountEvents(MultiViewClient::kEvent_ViewComplete) == 1);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mEvent == MultiViewClient::kEvent_ViewComplete);
+    NL_TEST_ASSERT(inSuite, mNumEvents > 0 && mEvents[mNumEvents - 1].mError != WEAVE_NO_ERROR);
+
+    VerifyPathCoverage(inSuite);
+
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mNumRequestsSent == 0);
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mNumRequestsFailed == CountEvents(MultiViewClient::kEvent_RequestFailed));
+    NL_TEST_ASSERT(inSuite, mClient.GetStatistics().mNumResponsesReceived == 0);
+}
+
+void WdmMultiViewClientTest::TestBadInputs(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    MultiViewClient uninitializedClient;
+
+    PRINT_TEST_NAME();
+
+    err = mClient.SendRequest(&mSinkCatalog, mPaths, 0, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = mClient.SendRequest(&mSinkCatalog, NULL, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    err = uninitializedClient.SendRequest(&mSinkCatalog, mPaths, kNumPaths, HandleDataElement);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+
+    NL_TEST_ASSERT(inSuite, !mClient.IsViewInProgress());
+    NL_TEST_ASSERT(inSuite, mNumEvents == 0);
+}
+
+void WdmMultiViewClientTest::HandleViewRequest(nl::Weave::ExchangeContext *aEC, const nl::Inet::IPPacketInfo *aPktInfo,
+                                               const nl::Weave::WeaveMessageInfo *aMsgInfo, uint32_t aProfileId,
+                                               uint8_t aMsgType, PacketBuffer *aPayload)
+{
+    WdmMultiViewClientTest * const pTest = static_cast<WdmMultiViewClientTest *>(aEC->AppState);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVReader reader;
+    TLVType dummyContainerType;
+    PathList::Parser pathList;
+    size_t numPaths = 0;
+
+    VerifyOrExit(pTest->mNumRequests < kMaxNumRequests, err = WEAVE_ERROR_NO_MEMORY);
+
+    reader.Init(aPayload);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = reader.EnterContainer(dummyContainerType);
+    SuccessOrExit(err);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = pathList.Init(reader);
+    SuccessOrExit(err);
+
+    pathList.GetReader(&reader);
+
+    while (WEAVE_NO_ERROR == (err = reader.Next()))
+    {
+        numPaths++;
+    }
+
+    VerifyOrExit(err == WEAVE_END_OF_TLV, );
+    err = WEAVE_NO_ERROR;
+
+    {
+        ReceivedRequest &request = pTest->mRequests[pTest->mNumRequests++];
+
+        request.mEC = aEC;
+        request.mNumPaths = numPaths;
+        request.mPayloadLength = aPayload->DataLength();
+    }
+
+    aEC = NULL;
+
+    if (pTest->GetNumPending() > pTest->mMaxNumPending)
+    {
+        pTest->mMaxNumPending = pTest->GetNumPending();
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        printf("Failed to parse ViewRequest: %s\n", nl::ErrorStr(err));
+    }
+
+    if (aEC != NULL)
+    {
+        aEC->Close();
+    }
+
+    PacketBuffer::Free(aPayload);
+}
+
+WEAVE_ERROR WdmMultiViewClientTest::HandleDataElement(void * const apAppState, DataElement::Parser & aDataElement)
+{
+    // The responses carry no data elements
+    return WEAVE_ERROR_INCORRECT_STATE;
+}
+
+void WdmMultiViewClientTest::ClientEventCallback(void * const aAppState, MultiViewClient::EventID aEvent,
+                                                 WEAVE_ERROR aErrorCode, MultiViewClient::EventParam & aEventParam)
+{
+    WdmMultiViewClientTest * const pTest = static_cast<WdmMultiViewClientTest *>(aAppState);
+
+    VerifyOrExit(pTest->mNumEvents < kMaxNumEvents, );
+
+    {
+        EventRecord &event = pTest->mEvents[pTest->mNumEvents++];
+
+        event.mEvent = aEvent;
+        event.mError = aErrorCode;
+        event.mFirstPath = (aEventParam.mPathList != NULL) ? static_cast<size_t>(aEventParam.mPathList - pTest->mPaths) : 0;
+        event.mNumPaths = aEventParam.mPathListSize;
+        event.mHasStatusReport = (aEventParam.mStatusReport != NULL);
+    }
+
+exit:
+    return;
+}
+
+// Test Suite
+
+static WdmMultiViewClientTest gWdmMultiViewClientTest;
+
+void WdmMultiViewClientTest_SplitAndPipeline(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmMultiViewClientTest.TestSplitAndPipeline(inSuite, inContext);
+}
+
+void WdmMultiViewClientTest_StatusReportFailsOneRequest(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmMultiViewClientTest.TestStatusReportFailsOneRequest(inSuite, inContext);
+}
+
+void WdmMultiViewClientTest_SendFailureReportedByEvent(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmMultiViewClientTest.TestSendFailureReportedByEvent(inSuite, inContext);
+}
+
+void WdmMultiViewClientTest_BadInputs(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmMultiViewClientTest.TestBadInputs(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Split a path list in a window of requests",  WdmMultiViewClientTest_SplitAndPipeline),
+    NL_TEST_DEF("Fail one request of the window with a StatusReport",  WdmMultiViewClientTest_StatusReportFailsOneRequest),
+    NL_TEST_DEF("Report a failure to send through the events",  WdmMultiViewClientTest_SendFailureReportedByEvent),
+    NL_TEST_DEF("Reject bad inputs",  WdmMultiViewClientTest_BadInputs),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int SuiteSetup(void *inContext)
+{
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    return 0;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int SuiteTeardown(void *inContext)
+{
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    return 0;
+}
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gWdmMultiViewClientTest.SetupTest(static_cast<nlTestSuite *>(inContext));
+
+    return 0;
+}
+
+/**
+ *  Tear down each test.
+ */
+static int TestTeardown(void *inContext)
+{
+    gWdmMultiViewClientTest.TearDownTest();
+
+    return 0;
+}
+
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-WdmMultiViewClient",
+        &sTests[0],
+        SuiteSetup,
+        SuiteTeardown,
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, &theSuite);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else  // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
@@ -0,0 +1,372 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a performance scenario for the Weave Data Management (WDM) publisher that measures how long the
+ *      notification engine takes to process a data change when a large number of subscriptions are established.
+ *
+ *      Usage: TestWdmNotifyScale [<num-subscriptions> ...]
+ *
+ *      By default, the scenario is run with 1000 and 10000 subscriptions, each to the one trait instance the publisher
+ *      hosts. Every change is expected to produce exactly one notify per subscription; the subscriber's status reports are
+ *      simulated so that the notification engine can move on to the next batch of subscriptions. The number of subscriptions
+ *      must not exceed WDM_MAX_NUM_SUBSCRIPTION_HANDLERS or WDM_PUBLISHER_MAX_NUM_PATH_GROUPS, which the build of this test
+ *      raises to 10000 for the WDM sources it is compiled with.
+ *
+ */
+
+#define __STDC_FORMAT_MACROS
+
+#include "ToolCommon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+#include <nest/test/trait/TestHTrait.h>
+
+#include "WdmNextPerfUtility.h"
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+using namespace nl;
+using namespace nl::Weave::TLV;
+using namespace nl::Weave::Profiles::DataManagement;
+using namespace Schema::Nest::Test::Trait;
+
+static SubscriptionEngine gSubscriptionEngine;
+
+SubscriptionEngine * SubscriptionEngine::GetInstance()
+{
+    return &gSubscriptionEngine;
+}
+
+#define TOOL_NAME "TestWdmNotifyScale"
+
+enum
+{
+    kNumIterations  = 10,
+    kPeerNodeId     = 1,
+    // Nothing listens on this port, the notifies are simply dropped.
+    kPeerPort       = 11097,
+};
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current) {
+namespace Platform {
+    // for this single-threaded tool, the dummy critical section is sufficient.
+    void CriticalSectionEnter()
+    {
+        return;
+    }
+
+    void CriticalSectionExit()
+    {
+        return;
+    }
+} // Platform
+
+class ScaleTestSource : public TraitDataSource
+{
+public:
+    ScaleTestSource() : TraitDataSource(&TestHTrait::TraitSchema) { }
+
+    void Touch(void) { SetDirty(TestHTrait::kPropertyHandle_A); }
+
+private:
+    WEAVE_ERROR GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
+    {
+        return aWriter.Put(aTagToWrite, static_cast<uint32_t>(0));
+    }
+};
+
+class TestWdmNotifyScale
+{
+public:
+    TestWdmNotifyScale(void);
+
+    WEAVE_ERROR Init(void);
+    WEAVE_ERROR Run(uint32_t aNumSubscriptions);
+
+private:
+    WEAVE_ERROR Setup(uint32_t aNumSubscriptions);
+    void Teardown(void);
+    WEAVE_ERROR ProcessChange(uint32_t aNumSubscriptions);
+
+    static void HandleSubscriptionEvent(void * const aAppState, SubscriptionHandler::EventID aEvent,
+                                        const SubscriptionHandler::InEventParam & aInParam,
+                                        SubscriptionHandler::OutEventParam & aOutParam);
+
+    SingleResourceSourceTraitCatalog::CatalogItem mSourceCatalogStore[1];
+    SingleResourceSourceTraitCatalog mSourceCatalog;
+    ScaleTestSource mSource;
+    TraitDataHandle mSourceHandle;
+    Binding * mBinding;
+};
+
+TestWdmNotifyScale::TestWdmNotifyScale(void) :
+    mSourceCatalog(ResourceIdentifier(ResourceIdentifier::SELF_NODE_ID), mSourceCatalogStore, 1), mSourceHandle(0),
+    mBinding(NULL)
+{ }
+
+} // WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
+}
+}
+}
+
+void TestWdmNotifyScale::HandleSubscriptionEvent(void * const aAppState, SubscriptionHandler::EventID aEvent,
+                                                 const SubscriptionHandler::InEventParam & aInParam,
+                                                 SubscriptionHandler::OutEventParam & aOutParam)
+{
+    SubscriptionHandler::DefaultEventHandler(aEvent, aInParam, aOutParam);
+}
+
+WEAVE_ERROR TestWdmNotifyScale::Init(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Inet::IPAddress peerAddr;
+
+    err = gSubscriptionEngine.Init(&ExchangeMgr, NULL, NULL);
+    SuccessOrExit(err);
+
+    err = gSubscriptionEngine.EnablePublisher(NULL, &mSourceCatalog);
+    SuccessOrExit(err);
+
+    err = mSourceCatalog.Add(0, &mSource, mSourceHandle);
+    SuccessOrExit(err);
+
+    // All subscriptions are to the same peer, over one UDP binding that every subscription handler holds a reference to.
+    nl::Inet::IPAddress::FromString("::1", peerAddr);
+
+    mBinding = ExchangeMgr.NewBinding();
+    VerifyOrExit(mBinding != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = mBinding->BeginConfiguration()
+              .Target_NodeId(kPeerNodeId)
+              .TargetAddress_IP(peerAddr, kPeerPort)
+              .Transport_UDP()
+              .Security_None()
+              .PrepareBinding();
+    SuccessOrExit(err);
+
+    VerifyOrExit(mBinding->IsReady(), err = WEAVE_ERROR_INCORRECT_STATE);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TestWdmNotifyScale::Setup(uint32_t aNumSubscriptions)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    NotificationEngine::NotifyStatistics stats;
+
+    VerifyOrExit(aNumSubscriptions <= SubscriptionEngine::kMaxNumSubscriptionHandlers &&
+                     aNumSubscriptions <= SubscriptionEngine::kMaxNumPathGroups,
+                 err = WEAVE_ERROR_NO_MEMORY);
+
+    // Establish each subscription the way SubscriptionHandler::InitWithIncomingRequest and the subscribe request parser
+    // would, with the subscriber already holding the current version of the trait instance.
+    for (uint32_t i = 0; i < aNumSubscriptions; i++)
+    {
+        SubscriptionHandler * subHandler;
+        SubscriptionHandler::TraitInstanceInfo * traitInstance;
+
+        err = gSubscriptionEngine.NewSubscriptionHandler(&subHandler);
+        SuccessOrExit(err);
+
+        subHandler->_AddRef();
+
+        mBinding->AddRef();
+        subHandler->mBinding        = mBinding;
+        subHandler->mAppState       = this;
+        subHandler->mEventCallback  = HandleSubscriptionEvent;
+        subHandler->mPeerNodeId     = kPeerNodeId;
+        subHandler->mSubscriptionId = i + 1;
+        subHandler->MoveToState(SubscriptionHandler::kState_SubscriptionEstablished_Idle);
+
+        err = subHandler->AddTraitInstance(mSourceHandle, traitInstance);
+        SuccessOrExit(err);
+
+        traitInstance->mRequestedVersion = mSource.GetVersion();
+        traitInstance->ClearDirty();
+    }
+
+    // None of the subscriptions are behind, so there is nothing to notify yet.
+    gSubscriptionEngine.GetNotificationEngine()->Run();
+    gSubscriptionEngine.GetNotificationEngine()->GetNotifyStatistics(stats);
+
+    VerifyOrExit(stats.mNumNotifiesSent == 0, err = WEAVE_ERROR_INCORRECT_STATE);
+
+exit:
+    return err;
+}
+
+void TestWdmNotifyScale::Teardown(void)
+{
+    for (size_t i = 0; i < SubscriptionEngine::kMaxNumSubscriptionHandlers; i++)
+    {
+        SubscriptionHandler * subHandler = &gSubscriptionEngine.mHandlers[i];
+
+        if (subHandler->mCurrentState != SubscriptionHandler::kState_Free)
+        {
+            subHandler->AbortSubscription();
+        }
+    }
+
+    gSubscriptionEngine.GetNotificationEngine()->ResetNotifyStatistics();
+}
+
+// Marks the trait instance dirty and runs the notification engine until every subscription has been notified of the change.
+// Each time the engine stops on its limit of notifies in flight, the notifies are confirmed the way the status reports from
+// the subscriber would confirm them.
+WEAVE_ERROR TestWdmNotifyScale::ProcessChange(uint32_t aNumSubscriptions)
+{
+    WEAVE_ERROR err                  = WEAVE_NO_ERROR;
+    NotificationEngine * notifEngine = gSubscriptionEngine.GetNotificationEngine();
+    NotificationEngine::NotifyStatistics before;
+    NotificationEngine::NotifyStatistics after;
+    bool notifying;
+
+    notifEngine->GetNotifyStatistics(before);
+
+    mSource.Touch();
+
+    do
+    {
+        notifEngine->Run();
+
+        notifying = false;
+
+        for (uint32_t i = 0; i < aNumSubscriptions; i++)
+        {
+            SubscriptionHandler * subHandler = &gSubscriptionEngine.mHandlers[i];
+
+            if (subHandler->mCurrentState == SubscriptionHandler::kState_SubscriptionEstablished_Notifying)
+            {
+                notifEngine->OnNotifyConfirm(subHandler, true);
+                subHandler->FlushExistingExchangeContext();
+                subHandler->MoveToState(SubscriptionHandler::kState_SubscriptionEstablished_Idle);
+                notifying = true;
+            }
+        }
+    } while (notifying);
+
+    notifEngine->GetNotifyStatistics(after);
+
+    VerifyOrExit(after.mNumNotifiesSent - before.mNumNotifiesSent == aNumSubscriptions, err = WEAVE_ERROR_INCORRECT_STATE);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TestWdmNotifyScale::Run(uint32_t aNumSubscriptions)
+{
+    WEAVE_ERROR err              = WEAVE_NO_ERROR;
+    WdmNextPerfUtility & TimeRef = *WdmNextPerfUtility::Instance();
+    perfData result;
+
+    err = Setup(aNumSubscriptions);
+    SuccessOrExit(err);
+
+    TimeRef();
+
+    for (int i = 0; i < kNumIterations; i++)
+    {
+        err = ProcessChange(aNumSubscriptions);
+        SuccessOrExit(err);
+    }
+
+    TimeRef();
+    TimeRef.SetPerf();
+
+    result = TimeRef.GetPerf();
+
+    printf("%u subscriptions: %d changes notified in %d.%06d seconds (%ld usec per change)\n", aNumSubscriptions,
+           kNumIterations, static_cast<int>(result.latency.tv_sec), static_cast<int>(result.latency.tv_usec),
+           static_cast<long>((result.latency.tv_sec * 1000000L + result.latency.tv_usec) / kNumIterations));
+
+    TimeRef.ReportPerf();
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        fprintf(stderr, "%s: %u subscriptions failed: %s\n", TOOL_NAME, aNumSubscriptions, nl::ErrorStr(err));
+    }
+
+    Teardown();
+
+    return err;
+}
+
+int main(int argc, char * argv[])
+{
+    static TestWdmNotifyScale scenario;
+    static const uint32_t kDefaultScenarios[] = { 1000, 10000 };
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+
+    err = scenario.Init();
+    SuccessOrExit(err);
+
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            err = scenario.Run(static_cast<uint32_t>(strtoul(argv[i], NULL, 10)));
+            SuccessOrExit(err);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(kDefaultScenarios) / sizeof(kDefaultScenarios[0]); i++)
+        {
+            err = scenario.Run(kDefaultScenarios[i]);
+            SuccessOrExit(err);
+        }
+    }
+
+    WdmNextPerfUtility::Remove();
+
+exit:
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        fprintf(stderr, "%s: scenario failed: %s\n", TOOL_NAME, nl::ErrorStr(err));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -126,6 +126,15 @@ class WdmUpdateEncoderTest {
 
         void TestRemoveDictionaryItemsBetweenPayloads_loop(nlTestSuite *inSuite, void *inContext, bool aRemoveAll);
         void TestRemoveDictionaryItemsBetweenPayloads(nlTestSuite *inSuite, void *inContext);
+        void TestWindowedUpdateThroughput(nlTestSuite *inSuite, void *inContext);
+        void TestCompactInProgressList(nlTestSuite *inSuite, void *inContext);
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+        void TestPendingPathBitmap(nlTestSuite *inSuite, void *inContext);
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+        void TestWindowOutOfOrderResponses(nlTestSuite *inSuite, void *inContext);
+        void TestWindowRequestFailure(nlTestSuite *inSuite, void *inContext);
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
 
     private:
         // The encoder
@@ -144,6 +153,9 @@ class WdmUpdateEncoderTest {
         TraitPathStore mPathList;
         TraitPathStore::Record mStorage[10];
 
+        // A SubscriptionClient, to exercise the bookkeeping of the window of update requests
+        SubscriptionClient mClient;
+
         // The Trait instances
         TestATraitUpdatableDataSink mTestATraitUpdatableDataSink0;
 
@@ -176,18 +188,58 @@ class WdmUpdateEncoderTest {
         void InitEncoderContext(nlTestSuite *inSuite);
         void VerifyDataList(nlTestSuite *inSuite, PacketBuffer *aBuf, size_t aItemToStartFrom = 0);
 
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+        // The number of failed pending paths the SubscriptionClient reported to the application
+        size_t mNumPendingPathsFailed;
+
+        static void PendingPathEventCallback(void * const aAppState, SubscriptionClient::EventID aEvent,
+                                             const SubscriptionClient::InEventParam & aInParam,
+                                             SubscriptionClient::OutEventParam & aOutParam);
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+        // What the SubscriptionClient reported to the application
+        struct UpdateCompleteRecord
+        {
+            PropertyPathHandle mPropertyPathHandle;
+            WEAVE_ERROR mReason;
+            bool mWillRetry;
+        };
+        UpdateCompleteRecord mUpdateCompleteRecords[10];
+        size_t mNumUpdateComplete;
+        size_t mNumNoMorePendingUpdates;
+
+        // The binding the window of update requests is sent over
+        Binding *mBinding;
+
+        bool SetupUpdateWindow(nlTestSuite *inSuite, size_t aNumPaths, size_t aRequestSize);
+        void ResetUpdateWindow(void);
+        void SendUpdateResponse(nlTestSuite *inSuite, SubscriptionClient::UpdateRequestSlot &aSlot,
+                                uint16_t aStatusCode, const uint16_t *aPathStatusCodes, size_t aNumPaths);
+        bool WasUpdateCompleteReported(uint32_t aKey, WEAVE_ERROR aReason, bool aWillRetry);
+        static void ClientEventCallback(void * const aAppState, SubscriptionClient::EventID aEvent,
+                                        const SubscriptionClient::InEventParam & aInParam,
+                                        SubscriptionClient::OutEventParam & aOutParam);
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
 };
 
 WdmUpdateEncoderTest::WdmUpdateEncoderTest() :
     mBuf(NULL),
     mSinkCatalog(ResourceIdentifier(ResourceIdentifier::SELF_NODE_ID),
             mSinkCatalogStore, sizeof(mSinkCatalogStore) / sizeof(mSinkCatalogStore[0]))
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+    , mNumUpdateComplete(0),
+    mNumNoMorePendingUpdates(0),
+    mBinding(NULL)
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
 {
     mPathList.Init(mStorage, ArraySize(mStorage));
 
     mSinkCatalog.Add(0, &mTestATraitUpdatableDataSink0, mTraitHandleSet[kTestATraitSink0Index]);
 
     mTestATraitUpdatableDataSink0.SetUpdateEncoder(&mEncoder);
+
+    mClient.InitAsFree();
 }
 
 
@@ -1036,6 +1088,594 @@ void WdmUpdateEncoderTest::TestRemoveDictionaryItemsBetweenPayloads(nlTestSuite
     return;
 }
 
+/**
+ * Encodes an update of 10000 paths the way the SubscriptionClient does with a window of
+ * update requests: every payload is a complete UpdateRequest that starts from the first
+ * path the previous one could not fit. Checks that the DataList of every request maps
+ * back to the range of paths it was encoded from, and reports the encoding throughput.
+ * Only the encoder is exercised: a SubscriptionClient never has more paths in flight than
+ * fit in its in-progress list, which holds WDM_UPDATE_MAX_ITEMS_IN_TRAIT_DIRTY_PATH_STORE.
+ */
+void WdmUpdateEncoderTest::TestWindowedUpdateThroughput(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    enum { kNumPaths = 10000 };
+    static TraitPathStore::Record sStorage[kNumPaths];
+    static const PropertyPathHandle sLeaves[] = {
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaA),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaB),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaC),
+    };
+    uint64_t startTime;
+    uint64_t encodeTime = 0;
+    size_t numRequests = 0;
+    size_t numDataElements = 0;
+
+    PRINT_TEST_NAME();
+
+    mPathList.Init(sStorage, ArraySize(sStorage));
+
+    for (size_t i = 0; i < kNumPaths; i++)
+    {
+        mTP = {
+            mTraitHandleSet[kTestATraitSink0Index],
+            sLeaves[i % ArraySize(sLeaves)]
+        };
+
+        err = mPathList.AddItem(mTP);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    InitEncoderContext(inSuite);
+
+    while (mContext.mItemInProgress < mPathList.GetPathStoreSize())
+    {
+        size_t firstItem = mContext.mItemInProgress;
+
+        mBuf->SetDataLength(0);
+        mContext.mUpdateRequestIndex = 0;
+
+        startTime = System::Layer::GetClock_MonotonicHiRes();
+
+        err = mEncoder.EncodeRequest(mContext);
+
+        encodeTime += System::Layer::GetClock_MonotonicHiRes() - startTime;
+
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, mContext.mNumDataElementsAddedToPayload > 0);
+        NL_TEST_ASSERT(inSuite, kNullPropertyPathHandle == mContext.mNextDictionaryElementPathHandle);
+        VerifyOrExit(err == WEAVE_NO_ERROR && mContext.mNumDataElementsAddedToPayload > 0, );
+
+        VerifyDataList(inSuite, mBuf, firstItem);
+
+        numRequests++;
+        numDataElements += mContext.mNumDataElementsAddedToPayload;
+    }
+
+    NL_TEST_ASSERT(inSuite, kNumPaths == numDataElements);
+    NL_TEST_ASSERT(inSuite, kNumPaths == mPathList.GetNumItems());
+
+    printf("Encoded %zu paths in %zu UpdateRequests in %" PRIu64 " usec (%" PRIu64 " paths/sec)\n",
+           numDataElements, numRequests, encodeTime,
+           encodeTime > 0 ? (static_cast<uint64_t>(numDataElements) * 1000000) / encodeTime : 0);
+
+exit:
+    mPathList.Init(mStorage, ArraySize(mStorage));
+}
+
+/**
+ * Checks that compacting the in-progress list of a SubscriptionClient keeps
+ * the range of a request in flight and the position of the first path not
+ * sent yet pointing to the same paths.
+ */
+void WdmUpdateEncoderTest::TestCompactInProgressList(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TraitPathStore &list = mClient.mInProgressUpdateList;
+    SubscriptionClient::UpdateRequestSlot &slot = mClient.mUpdateWindow[0];
+    TraitPath traitPath;
+
+    PRINT_TEST_NAME();
+
+    VerifyOrExit(list.GetPathStoreSize() >= 9, printf("Skipped: the in-progress list is too small\n"));
+
+    list.Clear();
+
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        mTP = {
+            mTraitHandleSet[kTestATraitSink0Index],
+            CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, i)
+        };
+
+        err = list.AddItem(mTP);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    // A request for items [3, 6) is in flight, items [6, 9) have not been sent yet,
+    // and the request that carried [0, 3) has completed, along with item 4.
+    slot.Reset();
+    slot.mIsActive = true;
+    slot.mIsInFlight = true;
+    slot.mFirstItem = 3;
+    slot.mEndItem = 6;
+    mClient.mUpdateRequestContext.Reset();
+    mClient.mUpdateRequestContext.mItemInProgress = 6;
+
+    list.RemoveItemAt(0);
+    list.RemoveItemAt(1);
+    list.RemoveItemAt(2);
+    list.RemoveItemAt(4);
+
+    mClient.CompactInProgressList();
+
+    NL_TEST_ASSERT(inSuite, 5 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, 0 == slot.mFirstItem);
+    NL_TEST_ASSERT(inSuite, 2 == slot.mEndItem);
+    NL_TEST_ASSERT(inSuite, 2 == mClient.mUpdateRequestContext.mItemInProgress);
+
+    for (size_t i = 0; i < list.GetNumItems(); i++)
+    {
+        static const uint32_t sExpectedKeys[] = { 3, 5, 6, 7, 8 };
+
+        NL_TEST_ASSERT(inSuite, list.IsItemValid(i));
+        list.GetItemAt(i, traitPath);
+        NL_TEST_ASSERT(inSuite, traitPath.mPropertyPathHandle ==
+                CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, sExpectedKeys[i]));
+    }
+
+    NL_TEST_ASSERT(inSuite, mClient.HasUnsentUpdates());
+
+    // Compacting a list without holes changes nothing.
+    mClient.CompactInProgressList();
+
+    NL_TEST_ASSERT(inSuite, 0 == slot.mFirstItem);
+    NL_TEST_ASSERT(inSuite, 2 == slot.mEndItem);
+    NL_TEST_ASSERT(inSuite, 2 == mClient.mUpdateRequestContext.mItemInProgress);
+
+exit:
+    slot.Reset();
+    mClient.mUpdateRequestContext.Reset();
+    list.Clear();
+}
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+void WdmUpdateEncoderTest::PendingPathEventCallback(void * const aAppState, SubscriptionClient::EventID aEvent,
+                                                    const SubscriptionClient::InEventParam & aInParam,
+                                                    SubscriptionClient::OutEventParam & aOutParam)
+{
+    WdmUpdateEncoderTest *test = static_cast<WdmUpdateEncoderTest *>(aAppState);
+
+    if (aEvent == SubscriptionClient::kEvent_OnUpdateComplete)
+    {
+        test->mNumPendingPathsFailed++;
+    }
+    else
+    {
+        SubscriptionClient::DefaultEventHandler(aEvent, aInParam, aOutParam);
+    }
+}
+
+/**
+ * Adds more paths of a trait instance than the in-progress list can hold to the
+ * pending set of a SubscriptionClient. Checks that the paths outside of dictionaries
+ * are deduplicated in a pending path bitmap, that they are moved to the in-progress
+ * list over as many rounds as needed, and that failing them notifies the application
+ * once per path.
+ */
+void WdmUpdateEncoderTest::TestPendingPathBitmap(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    static const PropertyPathHandle sLeaves[] = {
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaA),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaB),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaC),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaD_SaA),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaD_SaB),
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaE),
+    };
+    TraitPathStore::Record inProgressStore[4];
+    TraitPathStore &list = mClient.mInProgressUpdateList;
+    TraitDataHandle dataHandle = mTraitHandleSet[kTestATraitSink0Index];
+    const TraitSchemaEngine *schemaEngine = mTestATraitUpdatableDataSink0.GetSchemaEngine();
+    TraitPath traitPath;
+
+    PRINT_TEST_NAME();
+
+    mClient.InitAsFree();
+    mClient.mAppState = this;
+    mClient.mEventCallback = PendingPathEventCallback;
+    mClient.mDataSinkCatalog = &mSinkCatalog;
+    list.Init(inProgressStore, ArraySize(inProgressStore));
+    mNumPendingPathsFailed = 0;
+
+    for (size_t i = 0; i < ArraySize(sLeaves); i++)
+    {
+        err = mClient.AddItemPendingUpdateSet(TraitPath(dataHandle, sLeaves[i]), schemaEngine);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    mTP = {
+        dataHandle,
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, 1)
+    };
+    err = mClient.AddItemPendingUpdateSet(mTP, schemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Only the dictionary item is in the store.
+    NL_TEST_ASSERT(inSuite, 1 == mClient.mPendingUpdateSet.GetNumItems());
+    NL_TEST_ASSERT(inSuite, mClient.mPendingUpdateSet.IsPresent(mTP));
+    NL_TEST_ASSERT(inSuite, ArraySize(sLeaves) + 1 == mClient.GetNumPendingPaths());
+    NL_TEST_ASSERT(inSuite, mClient.IsTraitPending(dataHandle));
+    NL_TEST_ASSERT(inSuite, mClient.IsPathPending(TraitPath(dataHandle, sLeaves[3])));
+
+    // TaD replaces its two fields; adding one of them again is a no-op.
+    err = mClient.AddItemPendingUpdateSet(TraitPath(dataHandle, CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaD)), schemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = mClient.AddItemPendingUpdateSet(TraitPath(dataHandle, sLeaves[3]), schemaEngine);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, 6 == mClient.GetNumPendingPaths());
+    NL_TEST_ASSERT(inSuite, false == mClient.IsPathPending(TraitPath(dataHandle, sLeaves[3])));
+    NL_TEST_ASSERT(inSuite, mClient.IsPathIncludedInPendingSet(TraitPath(dataHandle, sLeaves[3]), schemaEngine));
+
+    // The first round fills the in-progress list and leaves the rest pending.
+    mClient.SetPendingSetState(SubscriptionClient::kPendingSetReady);
+    mClient.MovePendingToInProgress();
+
+    NL_TEST_ASSERT(inSuite, 4 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, 2 == mClient.GetNumPendingPaths());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetReady == mClient.mPendingSetState);
+    for (size_t i = list.GetFirstValidItem(); i < list.GetPathStoreSize(); i = list.GetNextValidItem(i))
+    {
+        list.GetItemAt(i, traitPath);
+        NL_TEST_ASSERT(inSuite, false == mClient.IsPathPending(traitPath));
+    }
+
+    // The second round takes the rest.
+    list.Clear();
+    mClient.MovePendingToInProgress();
+
+    NL_TEST_ASSERT(inSuite, 2 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, mClient.IsPendingSetEmpty());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetEmpty == mClient.mPendingSetState);
+
+    // Failing the trait instance notifies every path of the bitmap.
+    list.Clear();
+    for (size_t i = 0; i < ArraySize(sLeaves); i++)
+    {
+        err = mClient.AddItemPendingUpdateSet(TraitPath(dataHandle, sLeaves[i]), schemaEngine);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+    mClient.SetPendingSetState(SubscriptionClient::kPendingSetReady);
+
+    mClient.SetFailedPendingTrait(dataHandle);
+    NL_TEST_ASSERT(inSuite, false == mClient.IsTraitPending(dataHandle));
+
+    {
+        size_t count;
+
+        mClient.PurgeAndNotifyFailedPaths(WEAVE_ERROR_WDM_VERSION_MISMATCH, mClient.mPendingUpdateSet, count);
+
+        NL_TEST_ASSERT(inSuite, ArraySize(sLeaves) == count);
+    }
+
+    NL_TEST_ASSERT(inSuite, ArraySize(sLeaves) == mNumPendingPathsFailed);
+    NL_TEST_ASSERT(inSuite, mClient.IsPendingSetEmpty());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetEmpty == mClient.mPendingSetState);
+
+    mClient.InitAsFree();
+}
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+void WdmUpdateEncoderTest::ClientEventCallback(void * const aAppState, SubscriptionClient::EventID aEvent,
+                                               const SubscriptionClient::InEventParam & aInParam,
+                                               SubscriptionClient::OutEventParam & aOutParam)
+{
+    WdmUpdateEncoderTest *test = static_cast<WdmUpdateEncoderTest *>(aAppState);
+
+    switch (aEvent)
+    {
+    case SubscriptionClient::kEvent_OnUpdateComplete:
+        if (test->mNumUpdateComplete < ArraySize(test->mUpdateCompleteRecords))
+        {
+            UpdateCompleteRecord &record = test->mUpdateCompleteRecords[test->mNumUpdateComplete];
+
+            record.mPropertyPathHandle = aInParam.mUpdateComplete.mPropertyPathHandle;
+            record.mReason = aInParam.mUpdateComplete.mReason;
+            record.mWillRetry = aInParam.mUpdateComplete.mWillRetry;
+        }
+        test->mNumUpdateComplete++;
+        break;
+
+    case SubscriptionClient::kEvent_OnNoMorePendingUpdates:
+        test->mNumNoMorePendingUpdates++;
+        break;
+
+    default:
+        SubscriptionClient::DefaultEventHandler(aEvent, aInParam, aOutParam);
+        break;
+    }
+}
+
+/**
+ * Puts the SubscriptionClient in the state it is in after sending a window of
+ * UpdateRequests: aNumPaths paths of a TaI dictionary, keyed 0 to aNumPaths - 1,
+ * are in progress, and every aRequestSize of them are carried by a request in flight.
+ */
+bool WdmUpdateEncoderTest::SetupUpdateWindow(nlTestSuite *inSuite, size_t aNumPaths, size_t aRequestSize)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    nl::Inet::IPAddress peerAddr;
+    TraitPathStore &list = mClient.mInProgressUpdateList;
+    size_t numRequests = (aNumPaths + aRequestSize - 1) / aRequestSize;
+
+    VerifyOrExit(list.GetPathStoreSize() >= aNumPaths && ArraySize(mClient.mUpdateWindow) >= numRequests,
+                 printf("Skipped: the in-progress list or the window is too small\n"));
+
+    nl::Inet::IPAddress::FromString("::1", peerAddr);
+
+    mBinding = ExchangeMgr.NewBinding();
+    NL_TEST_ASSERT(inSuite, mBinding != NULL);
+    VerifyOrExit(mBinding != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = mBinding->BeginConfiguration()
+              .Target_NodeId(1)
+              .TargetAddress_IP(peerAddr)
+              .Transport_UDP()
+              .Security_None()
+              .PrepareBinding();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, mBinding->IsReady());
+    SuccessOrExit(err);
+
+    mClient.InitAsFree();
+    mClient.mRefCount = 1;
+    mClient.mBinding = mBinding;
+    mClient.mAppState = this;
+    mClient.mEventCallback = ClientEventCallback;
+    mClient.mDataSinkCatalog = &mSinkCatalog;
+
+    mNumUpdateComplete = 0;
+    mNumNoMorePendingUpdates = 0;
+
+    for (uint32_t i = 0; i < aNumPaths; i++)
+    {
+        mTP = {
+            mTraitHandleSet[kTestATraitSink0Index],
+            CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, i)
+        };
+
+        err = list.AddItem(mTP);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    for (size_t i = 0; i < numRequests; i++)
+    {
+        SubscriptionClient::UpdateRequestSlot &slot = mClient.mUpdateWindow[i];
+
+        slot.mIsActive = true;
+        slot.mIsInFlight = true;
+        slot.mSequenceNumber = mClient.mUpdateSequenceNumber++;
+        slot.mFirstItem = i * aRequestSize;
+        slot.mEndItem = std::min(slot.mFirstItem + aRequestSize, aNumPaths);
+    }
+
+    mClient.mUpdateRequestContext.mItemInProgress = aNumPaths;
+
+exit:
+    return err == WEAVE_NO_ERROR && mBinding != NULL;
+}
+
+void WdmUpdateEncoderTest::ResetUpdateWindow(void)
+{
+    mClient.InitAsFree();
+
+    if (mBinding != NULL)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+}
+
+/**
+ * Completes a request of the window with a StatusReport carrying an UpdateResponse.
+ *
+ * @param[in] aStatusCode       The Common profile status of the whole request.
+ * @param[in] aPathStatusCodes  The Common profile status of every path carried by the request.
+ * @param[in] aNumPaths         The number of paths carried by the request.
+ */
+void WdmUpdateEncoderTest::SendUpdateResponse(nlTestSuite *inSuite, SubscriptionClient::UpdateRequestSlot &aSlot,
+                                              uint16_t aStatusCode, const uint16_t *aPathStatusCodes, size_t aNumPaths)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint8_t buf[256];
+    TLVWriter writer;
+    UpdateResponse::Builder builder;
+    ReferencedTLVData additionalInfo;
+    nl::Weave::Profiles::StatusReporting::StatusReport statusReport;
+
+    writer.Init(buf, sizeof(buf));
+
+    err = builder.Init(&writer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    VersionList::Builder &versionList = builder.CreateVersionListBuilder();
+    for (size_t i = 0; i < aNumPaths; i++)
+    {
+        versionList.AddVersion(i + 1);
+    }
+    versionList.EndOfVersionList();
+
+    StatusList::Builder &statusList = builder.CreateStatusListBuilder();
+    for (size_t i = 0; i < aNumPaths; i++)
+    {
+        statusList.AddStatus(nl::Weave::Profiles::kWeaveProfile_Common, aPathStatusCodes[i]);
+    }
+    statusList.EndOfStatusList();
+
+    builder.EndOfResponse();
+    NL_TEST_ASSERT(inSuite, builder.GetError() == WEAVE_NO_ERROR);
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    additionalInfo.init(static_cast<uint16_t>(writer.GetLengthWritten()), sizeof(buf), buf);
+
+    statusReport.init(nl::Weave::Profiles::kWeaveProfile_Common, aStatusCode, &additionalInfo);
+
+    mClient.OnUpdateResponse(aSlot, WEAVE_NO_ERROR, &statusReport);
+}
+
+bool WdmUpdateEncoderTest::WasUpdateCompleteReported(uint32_t aKey, WEAVE_ERROR aReason, bool aWillRetry)
+{
+    PropertyPathHandle handle = CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, aKey);
+
+    for (size_t i = 0; i < mNumUpdateComplete && i < ArraySize(mUpdateCompleteRecords); i++)
+    {
+        if (mUpdateCompleteRecords[i].mPropertyPathHandle == handle)
+        {
+            return mUpdateCompleteRecords[i].mReason == aReason && mUpdateCompleteRecords[i].mWillRetry == aWillRetry;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Completes a window of two UpdateRequests out of order: the second request
+ * succeeds first, then the publisher is busy with one of the paths of the first.
+ * Checks that every path is reported against the request that carried it, and
+ * that the busy path is put back in the pending set to be retried once the
+ * whole window has completed.
+ */
+void WdmUpdateEncoderTest::TestWindowOutOfOrderResponses(nlTestSuite *inSuite, void *inContext)
+{
+    static const uint16_t sAllSuccess[] = {
+        nl::Weave::Profiles::Common::kStatus_Success,
+        nl::Weave::Profiles::Common::kStatus_Success,
+        nl::Weave::Profiles::Common::kStatus_Success,
+    };
+    static const uint16_t sOneBusy[] = {
+        nl::Weave::Profiles::Common::kStatus_Success,
+        nl::Weave::Profiles::Common::kStatus_Busy,
+        nl::Weave::Profiles::Common::kStatus_Success,
+    };
+    TraitPathStore &list = mClient.mInProgressUpdateList;
+    SubscriptionClient::UpdateRequestSlot &first = mClient.mUpdateWindow[0];
+    SubscriptionClient::UpdateRequestSlot &second = mClient.mUpdateWindow[1];
+    TraitPath traitPath;
+
+    PRINT_TEST_NAME();
+
+    VerifyOrExit(SetupUpdateWindow(inSuite, 6, 3), );
+
+    // The second request completes first; the first one is left in flight
+    // and nothing else is sent.
+    SendUpdateResponse(inSuite, second, nl::Weave::Profiles::Common::kStatus_Success, sAllSuccess, ArraySize(sAllSuccess));
+
+    NL_TEST_ASSERT(inSuite, 3 == mNumUpdateComplete);
+    for (uint32_t key = 3; key < 6; key++)
+    {
+        NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(key, WEAVE_NO_ERROR, false));
+    }
+    NL_TEST_ASSERT(inSuite, 0 == mNumNoMorePendingUpdates);
+    NL_TEST_ASSERT(inSuite, first.mIsActive && first.mIsInFlight);
+    NL_TEST_ASSERT(inSuite, false == second.mIsActive);
+    NL_TEST_ASSERT(inSuite, 3 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, list.IsItemValid(0) && list.IsItemValid(1) && list.IsItemValid(2));
+    NL_TEST_ASSERT(inSuite, mClient.mPendingUpdateSet.IsEmpty());
+
+    // The first request completes; the publisher was busy with key 1.
+    SendUpdateResponse(inSuite, first, nl::Weave::Profiles::Common::kStatus_Busy, sOneBusy, ArraySize(sOneBusy));
+
+    NL_TEST_ASSERT(inSuite, 6 == mNumUpdateComplete);
+    NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(0, WEAVE_NO_ERROR, false));
+    NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(1, WEAVE_ERROR_STATUS_REPORT_RECEIVED, true));
+    NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(2, WEAVE_NO_ERROR, false));
+    NL_TEST_ASSERT(inSuite, 0 == mNumNoMorePendingUpdates);
+    NL_TEST_ASSERT(inSuite, mClient.IsUpdateWindowEmpty());
+    NL_TEST_ASSERT(inSuite, list.IsEmpty());
+
+    mTP = {
+        mTraitHandleSet[kTestATraitSink0Index],
+        CreatePropertyPathHandle(TestATrait::kPropertyHandle_TaI_Value, 1)
+    };
+
+    NL_TEST_ASSERT(inSuite, 1 == mClient.mPendingUpdateSet.GetNumItems());
+    NL_TEST_ASSERT(inSuite, mClient.mPendingUpdateSet.IsPresent(mTP));
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetReady == mClient.mPendingSetState);
+
+    // The retry starts a new window with the busy path only.
+    mClient.MovePendingToInProgress();
+
+    NL_TEST_ASSERT(inSuite, 1 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, list.IsItemValid(0));
+    list.GetItemAt(0, traitPath);
+    NL_TEST_ASSERT(inSuite, traitPath == mTP);
+    NL_TEST_ASSERT(inSuite, mClient.mPendingUpdateSet.IsEmpty());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetEmpty == mClient.mPendingSetState);
+
+exit:
+    ResetUpdateWindow();
+}
+
+/**
+ * Fails the first request of a window of two while the second is in flight.
+ * Checks that only the paths of the failed request are reported and put back
+ * in the pending set, and that the retry waits for the rest of the window.
+ */
+void WdmUpdateEncoderTest::TestWindowRequestFailure(nlTestSuite *inSuite, void *inContext)
+{
+    static const uint16_t sAllSuccess[] = {
+        nl::Weave::Profiles::Common::kStatus_Success,
+        nl::Weave::Profiles::Common::kStatus_Success,
+        nl::Weave::Profiles::Common::kStatus_Success,
+    };
+    TraitPathStore &list = mClient.mInProgressUpdateList;
+    SubscriptionClient::UpdateRequestSlot &first = mClient.mUpdateWindow[0];
+    SubscriptionClient::UpdateRequestSlot &second = mClient.mUpdateWindow[1];
+
+    PRINT_TEST_NAME();
+
+    VerifyOrExit(SetupUpdateWindow(inSuite, 6, 3), );
+
+    mClient.OnUpdateNoResponse(WEAVE_ERROR_TIMEOUT, &first);
+
+    NL_TEST_ASSERT(inSuite, 3 == mNumUpdateComplete);
+    for (uint32_t key = 0; key < 3; key++)
+    {
+        NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(key, WEAVE_ERROR_TIMEOUT, true));
+    }
+    NL_TEST_ASSERT(inSuite, 0 == mNumNoMorePendingUpdates);
+    NL_TEST_ASSERT(inSuite, false == first.mIsActive);
+    NL_TEST_ASSERT(inSuite, second.mIsActive && second.mIsInFlight);
+    NL_TEST_ASSERT(inSuite, 3 == list.GetNumItems());
+    NL_TEST_ASSERT(inSuite, list.IsItemValid(3) && list.IsItemValid(4) && list.IsItemValid(5));
+    NL_TEST_ASSERT(inSuite, 3 == mClient.mPendingUpdateSet.GetNumItems());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetReady == mClient.mPendingSetState);
+
+    SendUpdateResponse(inSuite, second, nl::Weave::Profiles::Common::kStatus_Success, sAllSuccess, ArraySize(sAllSuccess));
+
+    NL_TEST_ASSERT(inSuite, 6 == mNumUpdateComplete);
+    for (uint32_t key = 3; key < 6; key++)
+    {
+        NL_TEST_ASSERT(inSuite, WasUpdateCompleteReported(key, WEAVE_NO_ERROR, false));
+    }
+
+    // The failed paths are still waiting for their retry.
+    NL_TEST_ASSERT(inSuite, 0 == mNumNoMorePendingUpdates);
+    NL_TEST_ASSERT(inSuite, mClient.IsUpdateWindowEmpty());
+    NL_TEST_ASSERT(inSuite, list.IsEmpty());
+    NL_TEST_ASSERT(inSuite, 3 == mClient.mPendingUpdateSet.GetNumItems());
+    NL_TEST_ASSERT(inSuite, SubscriptionClient::kPendingSetReady == mClient.mPendingSetState);
+
+exit:
+    ResetUpdateWindow();
+}
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+
 } // WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
 }
 }
@@ -1111,6 +1751,35 @@ void WdmUpdateEncoderTest_RemoveDictionaryItemsBetweenPayloads(nlTestSuite *inSu
     gWdmUpdateEncoderTest.TestRemoveDictionaryItemsBetweenPayloads(inSuite, inContext);
 }
 
+void WdmUpdateEncoderTest_WindowedUpdateThroughput(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmUpdateEncoderTest.TestWindowedUpdateThroughput(inSuite, inContext);
+}
+
+void WdmUpdateEncoderTest_CompactInProgressList(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmUpdateEncoderTest.TestCompactInProgressList(inSuite, inContext);
+}
+
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+void WdmUpdateEncoderTest_PendingPathBitmap(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmUpdateEncoderTest.TestPendingPathBitmap(inSuite, inContext);
+}
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+void WdmUpdateEncoderTest_WindowOutOfOrderResponses(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmUpdateEncoderTest.TestWindowOutOfOrderResponses(inSuite, inContext);
+}
+
+void WdmUpdateEncoderTest_WindowRequestFailure(nlTestSuite *inSuite, void *inContext)
+{
+    gWdmUpdateEncoderTest.TestWindowRequestFailure(inSuite, inContext);
+}
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+
 // Test Suite
 
 /**
@@ -1130,6 +1799,15 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Fail to encode because of bad inputs",  WdmUpdateEncoderTest_BadInputs),
     NL_TEST_DEF("Fail to encode because the path store can't hold private paths",  WdmUpdateEncoderTest_StoreTooSmall),
     NL_TEST_DEF("Remove dictionary items between payloads",  WdmUpdateEncoderTest_RemoveDictionaryItemsBetweenPayloads),
+    NL_TEST_DEF("Encode 10000 paths in a window of requests",  WdmUpdateEncoderTest_WindowedUpdateThroughput),
+    NL_TEST_DEF("Compact the in-progress list under a window of requests",  WdmUpdateEncoderTest_CompactInProgressList),
+#if WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+    NL_TEST_DEF("Send more pending paths than the in-progress list holds",  WdmUpdateEncoderTest_PendingPathBitmap),
+#endif // WDM_UPDATE_NUM_PENDING_PATH_BITMAPS > 0
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+    NL_TEST_DEF("Complete a window of requests out of order",  WdmUpdateEncoderTest_WindowOutOfOrderResponses),
+    NL_TEST_DEF("Fail one request of a window of requests",  WdmUpdateEncoderTest_WindowRequestFailure),
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
 
     NL_TEST_SENTINEL()
 };
@@ -1139,6 +1817,13 @@ static const nlTest sTests[] = {
  */
 static int SuiteSetup(void *inContext)
 {
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+    // The tests of the window of update requests need a binding.
+    InitSystemLayer();
+    InitNetwork();
+    InitWeaveStack(false, true);
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+
     return 0;
 }
 
@@ -1147,6 +1832,12 @@ static int SuiteSetup(void *inContext)
  */
 static int SuiteTeardown(void *inContext)
 {
+#if WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+    ShutdownWeaveStack();
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+#endif // WDM_UPDATE_MAX_IN_FLIGHT_REQUESTS > 1
+
     return 0;
 }
 
@@ -40,6 +40,7 @@
 #define TEST_CONN_ATTEMPTS_BEFORE_RESET               (4)
 #define BACKOFF_RESET_IMMEDIATE_THRESHOLD_SECS        (1)
 #define BACKOFF_RESET_RANDOMIZED_THRESHOLD_SECS       (11)
+#define TEST_TUNNEL_BURST_NUM_PACKETS                 (8)
 
 #if WEAVE_CONFIG_ENABLE_TUNNELING
 using namespace ::nl::Inet;
@@ -82,6 +83,7 @@ enum
     kTestNum_TestTunnelNoStatusReportResetReconnectBackoff      = 26,
     kTestNum_TestTunnelRestrictedRoutingOnStandaloneTunnelOpen  = 27,
     kTestNum_TestTunnelTCPIdle                                  = 28,
+    kTestNum_TestTunnelBurstThroughput                          = 29,
 };
 
 #endif // WEAVE_CONFIG_ENABLE_TUNNELING
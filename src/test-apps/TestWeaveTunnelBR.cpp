@@ -103,6 +103,8 @@ uint8_t gConnAttemptsBeforeReset = 0;
 bool gReconnectResetArmed = false;
 uint64_t gReconnectResetArmTime = 0;
 bool gtestDataSent = false;
+uint8_t gBurstResponsesRcvd = 0;
+uint64_t gBurstStartTime = 0;
 
 #if WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
 bool gUseServiceDir = false;
@@ -1845,6 +1847,80 @@ exit:
     gTunAgent.Shutdown();
 }
 
+/**
+ * Test that a burst of packets written to the tunnel interface back to back
+ * is carried over the tunnel, and report the time taken to get all the
+ * responses back.
+ */
+static void TestTunnelBurstThroughput(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    Done = false;
+    gTestSucceeded = false;
+    gBurstResponsesRcvd = 0;
+    gMaxTestDurationMillisecs = DEFAULT_TEST_DURATION_MILLISECS;
+    gCurrTestNum = kTestNum_TestTunnelBurstThroughput;
+    gTestStartTime = Now();
+
+#if WEAVE_CONFIG_ENABLE_SERVICE_DIRECTORY
+    if (gUseServiceDir)
+    {
+        err = gTunAgent.Init(&Inet, &ExchangeMgr, gDestNodeId,
+                            gAuthMode, &gServiceMgr);
+    }
+    else
+#endif
+    {
+        err = gTunAgent.Init(&Inet, &ExchangeMgr, gDestNodeId, gDestAddr,
+                            gAuthMode);
+    }
+
+    gTunAgent.OnServiceTunStatusNotify = WeaveTunnelOnStatusNotifyHandlerCB;
+
+    SuccessOrExit(err);
+
+    err = gTunAgent.StartServiceTunnel();
+    SuccessOrExit(err);
+
+    while (!Done)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = TEST_SLEEP_TIME_WITHIN_LOOP_SECS;
+        sleepTime.tv_usec = TEST_SLEEP_TIME_WITHIN_LOOP_MICROSECS;
+
+        ServiceNetwork(sleepTime);
+
+        if (Now() < gTestStartTime + gMaxTestDurationMillisecs * System::kTimerFactor_micro_per_milli)
+        {
+            if (gTestSucceeded)
+            {
+                Done = true;
+            }
+            else
+            {
+                continue;
+            }
+        }
+        else // Time's up
+        {
+            gTestSucceeded = false;
+            Done = true;
+        }
+
+        if (Done)
+        {
+            gTunAgent.StopServiceTunnel(WEAVE_NO_ERROR);
+        }
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, gTestSucceeded == true);
+
+    gTunAgent.Shutdown();
+}
+
 /**
  * Test to ensure that the WeaveTunnelAgent queues data packets when it is tryng to
  * do fast reconnect attempts to the Service.
@@ -2035,8 +2111,13 @@ static void TestTunnelStatistics(nlTestSuite *inSuite, void *inContext)
     WeaveLogDetail(WeaveTunnel, "LastTunnelFailoverWeaveError = %u\n", tunnelStats.mLastTunnelFailoverError);
 #endif // WEAVE_CONFIG_TUNNEL_FAILOVER_SUPPORTED
     WeaveLogDetail(WeaveTunnel, "DroppedMessageCount = %u\n", tunnelStats.mDroppedMessagesCount);
+    WeaveLogDetail(WeaveTunnel, "QueuedMessageCount = %u\n", tunnelStats.mQueuedMessagesCount);
+    WeaveLogDetail(WeaveTunnel, "QueuedBytesCount = %u\n", tunnelStats.mQueuedBytesCount);
+    WeaveLogDetail(WeaveTunnel, "QueueDroppedMessageCount = %u\n", tunnelStats.mQueueDroppedMessagesCount);
+    WeaveLogDetail(WeaveTunnel, "ReceivePausedCount = %u\n", tunnelStats.mReceivePausedCount);
 
     NL_TEST_ASSERT(inSuite, tunnelStats.mPrimaryStats.mTunnelDownCount == 1);
+    NL_TEST_ASSERT(inSuite, tunnelStats.mQueuedMessagesCount == 0);
     NL_TEST_ASSERT(inSuite, tunnelStats.mPrimaryStats.mTunnelConnAttemptCount == 1);
     NL_TEST_ASSERT(inSuite, tunnelStats.mPrimaryStats.mTxMessagesToService == 1);
     NL_TEST_ASSERT(inSuite, tunnelStats.mPrimaryStats.mRxMessagesFromService == 1);
@@ -2745,6 +2826,26 @@ void HandleTunnelTestResponse(ExchangeContext *ec, const IPPacketInfo *pktInfo,
 
         break;
 
+      case kTestNum_TestTunnelBurstThroughput:
+        if (profileId == kWeaveProfile_Echo && msgType == kEchoMessageType_EchoResponse)
+        {
+            if (++gBurstResponsesRcvd == TEST_TUNNEL_BURST_NUM_PACKETS)
+            {
+                uint64_t elapsedMsecs = (Now() - gBurstStartTime) / System::kTimerFactor_micro_per_milli;
+
+                WeaveLogDetail(WeaveTunnel, "Burst of %u pings over tunnel completed in %" PRIu64 " ms\n",
+                               TEST_TUNNEL_BURST_NUM_PACKETS, elapsedMsecs);
+
+                gTestSucceeded = true;
+            }
+        }
+        else
+        {
+            gTestSucceeded = false;
+        }
+
+        break;
+
       case  kTestNum_TestTunnelStatistics:
         if (profileId == kWeaveProfile_Echo && msgType == kEchoMessageType_EchoResponse)
         {
@@ -2984,6 +3085,27 @@ WeaveTunnelOnStatusNotifyHandlerCB(WeaveTunnelConnectionMgr::TunnelConnNotifyRea
 
         break;
 
+      case kTestNum_TestTunnelBurstThroughput:
+        if (reason == WeaveTunnelConnectionMgr::kStatus_TunPrimaryUp)
+        {
+            // Send the pings back to back so that they are pending on the
+            // tunnel interface together.
+
+            gBurstStartTime = Now();
+
+            for (int i = 0; i < TEST_TUNNEL_BURST_NUM_PACKETS; i++)
+            {
+                err = SendWeavePingMessage();
+                SuccessOrExit(err);
+            }
+        }
+        else
+        {
+            gTestSucceeded = false;
+        }
+
+        break;
+
 #if WEAVE_SYSTEM_CONFIG_USE_SOCKETS && WEAVE_CONFIG_TUNNEL_TCP_USER_TIMEOUT_SUPPORTED && INET_CONFIG_OVERRIDE_SYSTEM_TCP_USER_TIMEOUT
       case kTestNum_TestTCPUserTimeoutOnAddrRemoval:
         if (reason == WeaveTunnelConnectionMgr::kStatus_TunPrimaryUp)
@@ -3273,6 +3395,7 @@ static const nlTest tunnelTests[] = {
     NL_TEST_DEF("TestWARMRouteDeleteWhenTunnelStopped", TestWARMRouteDeleteWhenTunnelStopped),
     NL_TEST_DEF("TestWeavePingOverTunnel", TestWeavePingOverTunnel),
     NL_TEST_DEF("TestQueueingOfTunneledPackets", TestQueueingOfTunneledPackets),
+    NL_TEST_DEF("TestTunnelBurstThroughput", TestTunnelBurstThroughput),
 #if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
     NL_TEST_DEF("TestTunnelStatistics", TestTunnelStatistics),
 #endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
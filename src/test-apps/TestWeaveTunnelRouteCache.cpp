@@ -0,0 +1,310 @@
+/*
+ *
+ *    Copyright (c) 2018 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests for the cache of next hop
+ *      decisions the Weave Tunnel Agent keeps for packets read from
+ *      the tunnel interface.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Profiles/weave-tunneling/WeaveTunnelAgent.h>
+
+#if WEAVE_CONFIG_ENABLE_TUNNELING && WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+
+using namespace nl::Inet;
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveTunnel {
+
+class TestWeaveTunnelRouteCache
+{
+public:
+    void SetupTest(void);
+
+    void TestMissThenHit(nlTestSuite *inSuite, void *inContext);
+    void TestCollidingDestinations(nlTestSuite *inSuite, void *inContext);
+    void TestInvalidateOnRoleChange(nlTestSuite *inSuite, void *inContext);
+    void TestInvalidateOnStateChange(nlTestSuite *inSuite, void *inContext);
+    void TestGenerationWrap(nlTestSuite *inSuite, void *inContext);
+
+private:
+    WeaveTunnelAgent mAgent;
+
+    static IPAddress MakeAddress(uint16_t subnet, uint64_t interfaceId);
+    IPAddress MakeCollidingAddress(const IPAddress &addr);
+
+    void VerifyLookup(nlTestSuite *inSuite, const IPAddress &destAddr, WeaveTunnelAgent::NextHop expectedNextHop,
+                      uint64_t expectedPeerId);
+    void VerifyCacheCounters(nlTestSuite *inSuite, uint32_t expectedHits, uint32_t expectedMisses);
+};
+
+static const uint64_t kTestGlobalId = 0x000000A1B2C3D4E5ULL;
+
+void TestWeaveTunnelRouteCache::SetupTest(void)
+{
+    mAgent.SetTunnelingDeviceRole(kClientRole_BorderGateway);
+
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    memset(&mAgent.mWeaveTunnelStats, 0, sizeof(mAgent.mWeaveTunnelStats));
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+}
+
+IPAddress TestWeaveTunnelRouteCache::MakeAddress(uint16_t subnet, uint64_t interfaceId)
+{
+    return IPAddress::MakeULA(kTestGlobalId, subnet, interfaceId);
+}
+
+/**
+ * Make a different address, on the same subnet, that falls in the same
+ * route cache entry as addr.
+ */
+IPAddress TestWeaveTunnelRouteCache::MakeCollidingAddress(const IPAddress &addr)
+{
+    uint64_t interfaceId = addr.InterfaceId();
+    IPAddress collidingAddr;
+
+    do
+    {
+        collidingAddr = MakeAddress(addr.Subnet(), ++interfaceId);
+    } while (&mAgent.GetRouteCacheEntry(collidingAddr) != &mAgent.GetRouteCacheEntry(addr));
+
+    return collidingAddr;
+}
+
+void TestWeaveTunnelRouteCache::VerifyLookup(nlTestSuite *inSuite, const IPAddress &destAddr,
+                                             WeaveTunnelAgent::NextHop expectedNextHop, uint64_t expectedPeerId)
+{
+    uint64_t peerId = 0;
+
+    NL_TEST_ASSERT(inSuite, mAgent.LookupNextHop(destAddr, peerId) == expectedNextHop);
+    NL_TEST_ASSERT(inSuite, peerId == expectedPeerId);
+}
+
+void TestWeaveTunnelRouteCache::VerifyCacheCounters(nlTestSuite *inSuite, uint32_t expectedHits, uint32_t expectedMisses)
+{
+#if WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+    NL_TEST_ASSERT(inSuite, mAgent.mWeaveTunnelStats.mRouteCacheHits == expectedHits);
+    NL_TEST_ASSERT(inSuite, mAgent.mWeaveTunnelStats.mRouteCacheMisses == expectedMisses);
+#endif // WEAVE_CONFIG_TUNNEL_ENABLE_STATISTICS
+}
+
+void TestWeaveTunnelRouteCache::TestMissThenHit(nlTestSuite *inSuite, void *inContext)
+{
+    const IPAddress serviceAddr = MakeAddress(kWeaveSubnetId_Service, 0x18B4300200000011ULL);
+    const IPAddress mobileAddr  = MakeAddress(kWeaveSubnetId_MobileDevice, 0x18B4300000000042ULL);
+
+    NL_TEST_ASSERT(inSuite, &mAgent.GetRouteCacheEntry(serviceAddr) != &mAgent.GetRouteCacheEntry(mobileAddr));
+
+    // The first packet to a destination resolves its next hop
+
+    VerifyLookup(inSuite, serviceAddr, WeaveTunnelAgent::kNextHop_Service, 0);
+    VerifyCacheCounters(inSuite, 0, 1);
+
+    // The next ones use the cached one, peer included
+
+    VerifyLookup(inSuite, serviceAddr, WeaveTunnelAgent::kNextHop_Service, 0);
+    VerifyCacheCounters(inSuite, 1, 1);
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyCacheCounters(inSuite, 1, 2);
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyLookup(inSuite, serviceAddr, WeaveTunnelAgent::kNextHop_Service, 0);
+    VerifyCacheCounters(inSuite, 3, 2);
+}
+
+void TestWeaveTunnelRouteCache::TestCollidingDestinations(nlTestSuite *inSuite, void *inContext)
+{
+    const IPAddress mobileAddr          = MakeAddress(kWeaveSubnetId_MobileDevice, 0x18B4300000000042ULL);
+    const IPAddress collidingMobileAddr = MakeCollidingAddress(mobileAddr);
+    const IPAddress threadAddr          = MakeAddress(kWeaveSubnetId_ThreadMesh, 0x18B4300000000042ULL);
+
+    NL_TEST_ASSERT(inSuite, collidingMobileAddr != mobileAddr);
+    NL_TEST_ASSERT(inSuite, collidingMobileAddr.InterfaceId() != mobileAddr.InterfaceId());
+
+    // Destinations sharing an entry evict each other, and never get the
+    // next hop of the other one
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyLookup(inSuite, collidingMobileAddr, WeaveTunnelAgent::kNextHop_Service, collidingMobileAddr.InterfaceId());
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyCacheCounters(inSuite, 0, 3);
+
+    // A border gateway does not route local packets: a miss that resolves to no next hop is cached too
+
+    VerifyLookup(inSuite, threadAddr, WeaveTunnelAgent::kNextHop_None, 0);
+    VerifyLookup(inSuite, threadAddr, WeaveTunnelAgent::kNextHop_None, 0);
+    VerifyCacheCounters(inSuite, 1, 4);
+}
+
+void TestWeaveTunnelRouteCache::TestInvalidateOnRoleChange(nlTestSuite *inSuite, void *inContext)
+{
+    const IPAddress mobileAddr = MakeAddress(kWeaveSubnetId_MobileDevice, 0x18B4300000000042ULL);
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyCacheCounters(inSuite, 1, 1);
+
+    // A standalone device does not forward packets on behalf of mobile
+    // devices: the cached next hop must not be used anymore
+
+    mAgent.SetTunnelingDeviceRole(kClientRole_StandaloneDevice);
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_None, 0);
+    VerifyCacheCounters(inSuite, 1, 2);
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_None, 0);
+    VerifyCacheCounters(inSuite, 2, 2);
+}
+
+void TestWeaveTunnelRouteCache::TestInvalidateOnStateChange(nlTestSuite *inSuite, void *inContext)
+{
+    const IPAddress serviceAddr = MakeAddress(kWeaveSubnetId_Service, 0x18B4300200000011ULL);
+
+    VerifyLookup(inSuite, serviceAddr, WeaveTunnelAgent::kNextHop_Service, 0);
+    VerifyCacheCounters(inSuite, 0, 1);
+
+    mAgent.SetState(WeaveTunnelAgent::kState_Initialized_NoTunnel);
+
+    VerifyLookup(inSuite, serviceAddr, WeaveTunnelAgent::kNextHop_Service, 0);
+    VerifyCacheCounters(inSuite, 0, 2);
+
+    mAgent.SetState(WeaveTunnelAgent::kState_NotInitialized);
+}
+
+void TestWeaveTunnelRouteCache::TestGenerationWrap(nlTestSuite *inSuite, void *inContext)
+{
+    const IPAddress mobileAddr = MakeAddress(kWeaveSubnetId_MobileDevice, 0x18B4300000000042ULL);
+
+    // Cache a next hop in generation 1
+
+    mAgent.mRouteCacheGeneration = 1;
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyCacheCounters(inSuite, 0, 1);
+
+    // Go through every other generation; on the wrap back to generation 1,
+    // the entry must not become valid again
+
+    mAgent.mRouteCacheGeneration = UINT16_MAX;
+    mAgent.InvalidateRouteCache();
+    NL_TEST_ASSERT(inSuite, mAgent.mRouteCacheGeneration == 1);
+
+    for (size_t i = 0; i < WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE; i++)
+    {
+        NL_TEST_ASSERT(inSuite, mAgent.mRouteCache[i].mGeneration == 0);
+    }
+
+    VerifyLookup(inSuite, mobileAddr, WeaveTunnelAgent::kNextHop_Service, mobileAddr.InterfaceId());
+    VerifyCacheCounters(inSuite, 0, 2);
+}
+
+} // namespace WeaveTunnel
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+using namespace nl::Weave::Profiles::WeaveTunnel;
+
+static TestWeaveTunnelRouteCache gTestWeaveTunnelRouteCache;
+
+static void TestMissThenHit(nlTestSuite *inSuite, void *inContext)
+{
+    gTestWeaveTunnelRouteCache.TestMissThenHit(inSuite, inContext);
+}
+
+static void TestCollidingDestinations(nlTestSuite *inSuite, void *inContext)
+{
+    gTestWeaveTunnelRouteCache.TestCollidingDestinations(inSuite, inContext);
+}
+
+static void TestInvalidateOnRoleChange(nlTestSuite *inSuite, void *inContext)
+{
+    gTestWeaveTunnelRouteCache.TestInvalidateOnRoleChange(inSuite, inContext);
+}
+
+static void TestInvalidateOnStateChange(nlTestSuite *inSuite, void *inContext)
+{
+    gTestWeaveTunnelRouteCache.TestInvalidateOnStateChange(inSuite, inContext);
+}
+
+static void TestGenerationWrap(nlTestSuite *inSuite, void *inContext)
+{
+    gTestWeaveTunnelRouteCache.TestGenerationWrap(inSuite, inContext);
+}
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Miss then hit",                    TestMissThenHit),
+    NL_TEST_DEF("Colliding destinations",           TestCollidingDestinations),
+    NL_TEST_DEF("Invalidate on role change",        TestInvalidateOnRoleChange),
+    NL_TEST_DEF("Invalidate on state change",       TestInvalidateOnStateChange),
+    NL_TEST_DEF("Generation wrap",                  TestGenerationWrap),
+
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up each test.
+ */
+static int TestSetup(void *inContext)
+{
+    gTestWeaveTunnelRouteCache.SetupTest();
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    nlTestSuite theSuite = {
+        "weave-tunnel-route-cache",
+        &sTests[0],
+        NULL,
+        NULL,
+        TestSetup,
+        NULL
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context
+    nlTestRunner(&theSuite, NULL);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // WEAVE_CONFIG_ENABLE_TUNNELING && WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_TUNNELING && WEAVE_CONFIG_TUNNELING_ROUTE_CACHE_SIZE > 0
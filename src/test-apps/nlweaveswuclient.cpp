@@ -38,6 +38,8 @@ SoftwareUpdateClient::SoftwareUpdateClient()
 {
     FabricState = NULL;
     ExchangeMgr = NULL;
+    ExchangeCtx = NULL;
+    OnImageQueryResponse = NULL;
 }
 
 SoftwareUpdateClient::~SoftwareUpdateClient()
@@ -199,7 +201,9 @@ void SoftwareUpdateClient::HandleImageQueryResponse(ExchangeContext *ec, const I
 
     //print the contents of the ImageQuery response
     ImageQueryResponse imageQueryResponse;
-    printf("err: %d\n", imageQueryResponse.parse(payloadImageQueryResponse, imageQueryResponse));
+    WEAVE_ERROR err = imageQueryResponse.parse(payloadImageQueryResponse, imageQueryResponse);
+    SuccessOrExit(err);
+
     printf("====\n");
     DumpMemory(payloadImageQueryResponse->Start(), payloadImageQueryResponse->DataLength(), "==> ", 16);
     printf("====\n");
@@ -214,15 +218,26 @@ void SoftwareUpdateClient::HandleImageQueryResponse(ExchangeContext *ec, const I
     printf("reportStatus: %d\n", imageQueryResponse.reportStatus);
     printf("====\n");
 
-    // Free the payload buffer.
-    PacketBuffer::Free(payloadImageQueryResponse);
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(SoftwareUpdate, "Failed to parse ImageQuery response: %s", ErrorStr(err));
+    }
 
     // Discard the exchange context.
     swuApp->ExchangeCtx->Close();
     swuApp->ExchangeCtx = NULL;
 
+    // The response refers to the payload, so hand it over before freeing that
+    if (err == WEAVE_NO_ERROR && swuApp->OnImageQueryResponse != NULL)
+        swuApp->OnImageQueryResponse(swuApp, imageQueryResponse);
+    else
+        Done = true;
+
+    // Free the payload buffer.
+    PacketBuffer::Free(payloadImageQueryResponse);
+
     printf("3 HandleImageQueryResponse exiting\n");
-    Done = true;
 }
 
 // Set the exchange context for the most recently started SWU exchange.
@@ -57,6 +57,11 @@ public:
 	uint8_t EncryptionType;                         // Encryption type to use during SWU
 	uint16_t KeyId;                                 // Encryption key to use during SWU
 
+	// Called with a parsed ImageQuery response. When set, the client leaves it to the
+	// callback to end the test (e.g., once the image has been downloaded).
+	typedef void (*ImageQueryResponseFunct)(SoftwareUpdateClient *client, ImageQueryResponse &response);
+	ImageQueryResponseFunct OnImageQueryResponse;
+
 	WEAVE_ERROR Init(WeaveExchangeManager *exchangeMgr);
 	WEAVE_ERROR Shutdown();
 
@@ -0,0 +1,716 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a downloader that fetches the software update
+ *      image named in an ImageQuery response over several parallel BDX
+ *      transfers, one per byte range of the image, and verifies it
+ *      against the IntegritySpec of the response.
+ *
+ */
+
+#define __STDC_FORMAT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#define WEAVE_CONFIG_BDX_NAMESPACE kWeaveManagedNamespace_Development
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ToolCommon.h"
+#include "nlweaveswudownloader.h"
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+
+using namespace nl::Weave::Profiles::SoftwareUpdate;
+using namespace nl::Weave::Profiles::BulkDataTransfer;
+using namespace nl::Weave::Profiles::StatusReporting;
+
+SoftwareUpdateImageDownloader::SoftwareUpdateImageDownloader()
+{
+    RangeSize = 64 * 1024;
+    MinParallelRanges = 1;
+    MaxParallelRanges = 4;
+    MaxBlockSize = 1024;
+    WindowSize = WEAVE_CONFIG_BDX_WINDOW_SIZE;
+    MaxRetries = 3;
+    OnDownloadComplete = NULL;
+    AppState = NULL;
+
+    mExchangeMgr = NULL;
+    mFd = -1;
+    mIsDownloading = false;
+    mBinding = NULL;
+    mCon = NULL;
+
+    Reset();
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::Init(WeaveExchangeManager *exchangeMgr)
+{
+    WEAVE_ERROR err;
+
+    // Error if already initialized.
+    if (mExchangeMgr != NULL)
+        return WEAVE_ERROR_INCORRECT_STATE;
+
+    err = mBdxClient.Init(exchangeMgr);
+    if (err != WEAVE_NO_ERROR)
+        return err;
+
+    mExchangeMgr = exchangeMgr;
+
+    return WEAVE_NO_ERROR;
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::Shutdown()
+{
+    if (mExchangeMgr == NULL)
+        return WEAVE_NO_ERROR;
+
+    mExchangeMgr->MessageLayer->SystemLayer->CancelTimer(HandleStartRanges, this);
+
+    // Drop an unfinished download without reporting it
+    OnDownloadComplete = NULL;
+    if (mIsDownloading)
+        CompleteDownload(WEAVE_ERROR_INCORRECT_STATE);
+
+    mBdxClient.Shutdown();
+    mExchangeMgr = NULL;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * Download the image named in an ImageQuery response over UDP.
+ *
+ * @param[in] nodeId        Node id of the server holding the image.
+ * @param[in] nodeAddr      Address of the server, or IPAddress::Any to derive it from the node id.
+ * @param[in] response      The ImageQuery response. It is only used during the call.
+ * @param[in] destPath      File the image is written to.
+ */
+WEAVE_ERROR SoftwareUpdateImageDownloader::StartDownload(uint64_t nodeId, IPAddress nodeAddr, const ImageQueryResponse &response,
+                                                         const char *destPath)
+{
+    WEAVE_ERROR err;
+
+    err = BeginDownload(response, destPath);
+    SuccessOrExit(err);
+
+    mBinding = mExchangeMgr->NewBinding(HandleBindingEvent, this);
+    VerifyOrExit(mBinding != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    {
+        Binding::Configuration bindingConfig = mBinding->BeginConfiguration()
+            .Target_NodeId(nodeId)
+            .Transport_UDP()
+            .Security_None();
+
+        if (nodeAddr != IPAddress::Any)
+            bindingConfig.TargetAddress_IP(nodeAddr);
+
+        // Ranges start once the binding is ready
+        err = bindingConfig.PrepareBinding();
+        SuccessOrExit(err);
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR && mIsDownloading)
+    {
+        OnDownloadComplete = NULL;
+        CompleteDownload(err);
+    }
+    return err;
+}
+
+/**
+ * Download the image named in an ImageQuery response over an established connection.
+ *
+ * @param[in] con           Connection to the server holding the image.
+ * @param[in] response      The ImageQuery response. It is only used during the call.
+ * @param[in] destPath      File the image is written to.
+ */
+WEAVE_ERROR SoftwareUpdateImageDownloader::StartDownload(WeaveConnection *con, const ImageQueryResponse &response, const char *destPath)
+{
+    WEAVE_ERROR err;
+
+    err = BeginDownload(response, destPath);
+    SuccessOrExit(err);
+
+    mCon = con;
+
+    err = StartRanges();
+    SuccessOrExit(err);
+
+exit:
+    if (err != WEAVE_NO_ERROR && mIsDownloading)
+    {
+        OnDownloadComplete = NULL;
+        CompleteDownload(err);
+    }
+    return err;
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::BeginDownload(const ImageQueryResponse &response, const char *destPath)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint16_t len = response.uri.theLength;
+
+    VerifyOrExit(mExchangeMgr != NULL && !mIsDownloading, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(RangeSize > 0 && MinParallelRanges > 0 && MinParallelRanges <= MaxParallelRanges && MaxParallelRanges <= kMaxRanges,
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    // The URI may be sent with its terminator
+    while (len > 0 && response.uri.theString[len - 1] == '\0')
+        len--;
+    VerifyOrExit(len > 0 && len < sizeof(mDesignator), err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    Reset();
+
+    memcpy(mDesignator, response.uri.theString, len);
+    mDesignator[len] = '\0';
+    mDesignatorLen = len;
+
+    mIntegrityType = response.integritySpec.type;
+    switch (mIntegrityType)
+    {
+    case kIntegrityType_SHA160:
+        memcpy(mExpectedDigest, response.integritySpec.value, Platform::Security::SHA1::kHashLength);
+        mSHA1.Begin();
+        break;
+    case kIntegrityType_SHA256:
+        memcpy(mExpectedDigest, response.integritySpec.value, Platform::Security::SHA256::kHashLength);
+        mSHA256.Begin();
+        break;
+    default:
+        ExitNow(err = WEAVE_ERROR_INVALID_INTEGRITY_TYPE);
+    }
+
+    // Ranges are written where they belong as they arrive, leaving holes until filled
+    mFd = open(destPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    VerifyOrExit(mFd >= 0, err = System::MapErrorPOSIX(errno));
+
+    mParallelRanges = MinParallelRanges;
+    mPeakParallelRanges = MinParallelRanges;
+    mStartTime = mSampleTime = System::Layer::GetClock_MonotonicMS();
+    mIsDownloading = true;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::StartRanges(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    while (GetNumActiveRanges() < mParallelRanges)
+    {
+        ImageRange *range = NULL;
+
+        // Restart failed ranges first, they hold up the verified prefix
+        for (int i = 0; i < kMaxRanges; i++)
+        {
+            if (mRanges[i].mState == kRangeState_Pending && (range == NULL || mRanges[i].mStart < range->mStart))
+                range = &mRanges[i];
+        }
+
+        if (range == NULL)
+        {
+            if (mNextOffset >= mImageSize)
+                break;
+
+            for (int i = 0; i < kMaxRanges && range == NULL; i++)
+            {
+                if (mRanges[i].mState == kRangeState_Idle)
+                    range = &mRanges[i];
+            }
+
+            if (range == NULL)
+                break;
+
+            range->mStart = mNextOffset;
+            range->mEnd = (mImageSize - mNextOffset > RangeSize) ? mNextOffset + RangeSize : mImageSize;
+            range->mReceived = 0;
+            range->mState = kRangeState_Pending;
+            mNextOffset = range->mEnd;
+        }
+
+        err = StartRange(*range);
+        SuccessOrExit(err);
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::StartRange(ImageRange &range)
+{
+    WEAVE_ERROR err;
+    BDXTransfer *xfer = NULL;
+    ReferencedString designator;
+    BDXHandlers handlers =
+    {
+        NULL,                   // SendAcceptHandler
+        HandleReceiveAccept,    // ReceiveAcceptHandler
+        HandleReject,           // RejectHandler
+        NULL,                   // GetBlockHandler
+        HandlePutBlock,         // PutBlockHandler
+        HandleXferError,        // XferErrorHandler
+        HandleXferDone,         // XferDoneHandler
+        HandleError             // ErrorHandler
+    };
+
+    designator.init(mDesignatorLen, mDesignator);
+
+    if (mCon != NULL)
+        err = mBdxClient.NewTransfer(mCon, handlers, designator, &range, xfer);
+    else
+        err = mBdxClient.NewTransfer(mBinding, handlers, designator, &range, xfer);
+    SuccessOrExit(err);
+
+    // Only ask for what is still missing; a restarted range keeps what it received
+    xfer->mMaxBlockSize = MaxBlockSize;
+    xfer->mMaxWindowSize = WindowSize;
+    xfer->mStartOffset = range.mStart + range.mReceived;
+    xfer->mLength = range.mEnd - xfer->mStartOffset;
+
+    // Windowing needs the sender to drive
+    err = mBdxClient.InitBdxReceive(*xfer, WindowSize <= 1, WindowSize > 1, false, NULL);
+    if (err != WEAVE_NO_ERROR)
+    {
+        BdxClient::ShutdownTransfer(xfer);
+        ExitNow();
+    }
+
+    range.mXfer = xfer;
+    range.mState = kRangeState_Active;
+
+exit:
+    return err;
+}
+
+void SoftwareUpdateImageDownloader::FinishRange(ImageRange &range)
+{
+    // A range that ended early holds the end of the image
+    if (range.mStart + range.mReceived < range.mEnd)
+        SetImageEnd(range.mStart + range.mReceived);
+
+    range.mXfer = NULL;
+    range.mState = kRangeState_Idle;
+}
+
+void SoftwareUpdateImageDownloader::RetryRange(ImageRange &range, WEAVE_ERROR err)
+{
+    range.mXfer = NULL;
+    range.mState = kRangeState_Pending;
+
+    if (++mNumRetries > MaxRetries && mPendingError == WEAVE_NO_ERROR)
+        mPendingError = err;
+}
+
+void SoftwareUpdateImageDownloader::SetImageEnd(uint64_t aImageSize)
+{
+    if (aImageSize >= mImageSize)
+        return;
+
+    mImageSize = aImageSize;
+    if (mNextOffset > aImageSize)
+        mNextOffset = aImageSize;
+
+    // Ranges past the end of the image have nothing left to receive. Those in
+    // flight are left to finish, the sender ends them right away.
+    for (int i = 0; i < kMaxRanges; i++)
+    {
+        ImageRange &range = mRanges[i];
+
+        if (range.mState == kRangeState_Idle || range.mEnd <= aImageSize)
+            continue;
+
+        range.mEnd = (range.mStart + range.mReceived > aImageSize) ? range.mStart + range.mReceived : aImageSize;
+        if (range.mState == kRangeState_Pending && range.mStart + range.mReceived >= range.mEnd)
+            range.mState = kRangeState_Idle;
+    }
+}
+
+void SoftwareUpdateImageDownloader::AdaptParallelism(void)
+{
+    uint64_t now = System::Layer::GetClock_MonotonicMS();
+    uint32_t throughput;
+    int newParallelRanges;
+
+    if (now == mSampleTime)
+        return;
+
+    throughput = (uint32_t)((mBytesReceived - mSampleBytes) * 1000 / (now - mSampleTime));
+
+    // Keep stepping the same way while throughput improves and turn around
+    // once it drops. Changes within 10% are treated as noise.
+    newParallelRanges = mParallelRanges;
+    if (throughput > mLastThroughput + mLastThroughput / 10)
+    {
+        newParallelRanges += mStepDirection;
+    }
+    else if (throughput + throughput / 10 < mLastThroughput)
+    {
+        mStepDirection = -mStepDirection;
+        newParallelRanges += mStepDirection;
+    }
+
+    if (newParallelRanges < MinParallelRanges)
+        newParallelRanges = MinParallelRanges;
+    if (newParallelRanges > MaxParallelRanges)
+        newParallelRanges = MaxParallelRanges;
+
+    if (newParallelRanges != mParallelRanges)
+    {
+        printf("Throughput %" PRIu32 " bytes/s with %d ranges, now using %d\n", throughput, mParallelRanges, newParallelRanges);
+        mParallelRanges = (uint8_t)newParallelRanges;
+        if (mParallelRanges > mPeakParallelRanges)
+            mPeakParallelRanges = mParallelRanges;
+    }
+
+    mLastThroughput = throughput;
+    mSampleTime = now;
+    mSampleBytes = mBytesReceived;
+}
+
+void SoftwareUpdateImageDownloader::HashData(const uint8_t *data, uint64_t len)
+{
+    while (len > 0)
+    {
+        uint16_t chunkLen = (len > UINT16_MAX) ? UINT16_MAX : (uint16_t)len;
+
+        if (mIntegrityType == kIntegrityType_SHA160)
+            mSHA1.AddData(data, chunkLen);
+        else
+            mSHA256.AddData(data, chunkLen);
+
+        data += chunkLen;
+        len -= chunkLen;
+    }
+}
+
+/**
+ * Fold the part of the image that has become contiguous since the last call
+ * into the digest, reading back ranges that completed ahead of the prefix.
+ */
+WEAVE_ERROR SoftwareUpdateImageDownloader::HashCompletedPrefix(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint64_t end = GetContiguousEnd();
+    uint8_t buf[4096];
+
+    while (mHashedOffset < end)
+    {
+        size_t len = (end - mHashedOffset > sizeof(buf)) ? sizeof(buf) : (size_t)(end - mHashedOffset);
+        ssize_t nread = pread(mFd, buf, len, mHashedOffset);
+
+        VerifyOrExit(nread > 0, err = (nread < 0) ? System::MapErrorPOSIX(errno) : WEAVE_ERROR_INTEGRITY_CHECK_FAILED);
+
+        HashData(buf, nread);
+        mHashedOffset += nread;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::VerifyDigest(void)
+{
+    uint8_t digest[Platform::Security::SHA256::kHashLength];
+    size_t digestLen;
+
+    if (mIntegrityType == kIntegrityType_SHA160)
+    {
+        mSHA1.Finish(digest);
+        digestLen = Platform::Security::SHA1::kHashLength;
+    }
+    else
+    {
+        mSHA256.Finish(digest);
+        digestLen = Platform::Security::SHA256::kHashLength;
+    }
+
+    return (memcmp(digest, mExpectedDigest, digestLen) == 0) ? WEAVE_NO_ERROR : WEAVE_ERROR_INTEGRITY_CHECK_FAILED;
+}
+
+/**
+ * The end of the prefix of the image that has been written to the file: the
+ * lowest offset still missing from a range, or the start of the ranges not
+ * handed out yet.
+ */
+uint64_t SoftwareUpdateImageDownloader::GetContiguousEnd(void)
+{
+    uint64_t end = (mNextOffset < mImageSize) ? mNextOffset : mImageSize;
+
+    for (int i = 0; i < kMaxRanges; i++)
+    {
+        const ImageRange &range = mRanges[i];
+        uint64_t missing = range.mStart + range.mReceived;
+
+        if (range.mState != kRangeState_Idle && missing < range.mEnd && missing < end)
+            end = missing;
+    }
+
+    return end;
+}
+
+uint8_t SoftwareUpdateImageDownloader::GetNumActiveRanges(void)
+{
+    uint8_t count = 0;
+
+    for (int i = 0; i < kMaxRanges; i++)
+    {
+        if (mRanges[i].mState == kRangeState_Active)
+            count++;
+    }
+
+    return count;
+}
+
+// BDX handlers run in the middle of processing a message for their transfer,
+// so the download is advanced from a timer once they have returned.
+void SoftwareUpdateImageDownloader::ScheduleStartRanges(void)
+{
+    mExchangeMgr->MessageLayer->SystemLayer->StartTimer(0, HandleStartRanges, this);
+}
+
+void SoftwareUpdateImageDownloader::CompleteDownload(WEAVE_ERROR err)
+{
+    DownloadCompleteFunct onDownloadComplete = OnDownloadComplete;
+
+    mEndTime = System::Layer::GetClock_MonotonicMS();
+    mExchangeMgr->MessageLayer->SystemLayer->CancelTimer(HandleStartRanges, this);
+
+    for (int i = 0; i < kMaxRanges; i++)
+    {
+        if (mRanges[i].mState == kRangeState_Active)
+            BdxClient::ShutdownTransfer(mRanges[i].mXfer);
+    }
+
+    if (mBinding != NULL)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+    mCon = NULL;
+
+    if (mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+
+    mIsDownloading = false;
+
+    if (onDownloadComplete != NULL)
+        onDownloadComplete(this, err);
+}
+
+void SoftwareUpdateImageDownloader::Reset(void)
+{
+    for (int i = 0; i < kMaxRanges; i++)
+    {
+        mRanges[i].mDownloader = this;
+        mRanges[i].mXfer = NULL;
+        mRanges[i].mStart = 0;
+        mRanges[i].mEnd = 0;
+        mRanges[i].mReceived = 0;
+        mRanges[i].mState = kRangeState_Idle;
+    }
+
+    mDesignator[0] = '\0';
+    mDesignatorLen = 0;
+    mIntegrityType = kIntegrityType_SHA256;
+    memset(mExpectedDigest, 0, sizeof(mExpectedDigest));
+
+    mImageSize = UINT64_MAX;
+    mNextOffset = 0;
+    mHashedOffset = 0;
+    mBytesReceived = 0;
+    mNumRetries = 0;
+    mPendingError = WEAVE_NO_ERROR;
+
+    mParallelRanges = 0;
+    mPeakParallelRanges = 0;
+    mStepDirection = 1;
+    mLastThroughput = 0;
+    mSampleTime = 0;
+    mSampleBytes = 0;
+    mStartTime = 0;
+    mEndTime = 0;
+}
+
+void SoftwareUpdateImageDownloader::HandleBindingEvent(void *const appState, const Binding::EventType event,
+                                                       const Binding::InEventParam &inParam, Binding::OutEventParam &outParam)
+{
+    SoftwareUpdateImageDownloader *downloader = static_cast<SoftwareUpdateImageDownloader *>(appState);
+
+    switch (event)
+    {
+    case Binding::kEvent_BindingReady:
+        downloader->ScheduleStartRanges();
+        break;
+    case Binding::kEvent_PrepareFailed:
+        downloader->CompleteDownload(inParam.PrepareFailed.Reason);
+        break;
+    default:
+        Binding::DefaultEventHandler(appState, event, inParam, outParam);
+    }
+}
+
+void SoftwareUpdateImageDownloader::HandleStartRanges(System::Layer *aSystemLayer, void *aAppState, System::Error aError)
+{
+    SoftwareUpdateImageDownloader *downloader = static_cast<SoftwareUpdateImageDownloader *>(aAppState);
+    WEAVE_ERROR err = downloader->mPendingError;
+
+    VerifyOrExit(downloader->mIsDownloading, );
+    SuccessOrExit(err);
+
+    err = downloader->HashCompletedPrefix();
+    SuccessOrExit(err);
+
+    if (downloader->mHashedOffset >= downloader->mImageSize)
+    {
+        err = downloader->VerifyDigest();
+        downloader->CompleteDownload(err);
+        ExitNow();
+    }
+
+    err = downloader->StartRanges();
+    SuccessOrExit(err);
+
+exit:
+    if (err != WEAVE_NO_ERROR && downloader->mIsDownloading)
+        downloader->CompleteDownload(err);
+}
+
+WEAVE_ERROR SoftwareUpdateImageDownloader::HandleReceiveAccept(BDXTransfer *aXfer, ReceiveAccept *aReceiveAcceptMsg)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    uint64_t requested = range->mEnd - (range->mStart + range->mReceived);
+
+    // The sender cuts the range at the end of the image
+    if (aXfer->mLength < requested)
+        range->mDownloader->SetImageEnd(range->mStart + range->mReceived + aXfer->mLength);
+
+    return WEAVE_NO_ERROR;
+}
+
+void SoftwareUpdateImageDownloader::HandleReject(BDXTransfer *aXfer, StatusReport *aReport)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    SoftwareUpdateImageDownloader *downloader = range->mDownloader;
+
+    // The range starts past the end of the image, an earlier one holds the end
+    if (aReport->mProfileId == kWeaveProfile_BDX && aReport->mStatusCode == kStatus_StartOffsetNotSupported && range->mStart > 0)
+    {
+        downloader->SetImageEnd(range->mStart + range->mReceived);
+    }
+    else
+    {
+        printf("Range at %" PRIu64 " rejected: %s\n", range->mStart, nl::StatusReportStr(aReport->mProfileId, aReport->mStatusCode));
+        if (downloader->mPendingError == WEAVE_NO_ERROR)
+            downloader->mPendingError = WEAVE_ERROR_STATUS_REPORT_RECEIVED;
+    }
+
+    range->mXfer = NULL;
+    range->mState = kRangeState_Idle;
+    aXfer->Shutdown();
+
+    downloader->ScheduleStartRanges();
+}
+
+void SoftwareUpdateImageDownloader::HandlePutBlock(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aIsLastBlock)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    SoftwareUpdateImageDownloader *downloader = range->mDownloader;
+    uint64_t offset = range->mStart + range->mReceived;
+    ssize_t written;
+
+    if (aLength > range->mEnd - offset)
+        aLength = range->mEnd - offset;
+
+    written = pwrite(downloader->mFd, aDataBlock, aLength, offset);
+    if (written != (ssize_t)aLength)
+    {
+        if (downloader->mPendingError == WEAVE_NO_ERROR)
+            downloader->mPendingError = (written < 0) ? System::MapErrorPOSIX(errno) : WEAVE_ERROR_NO_MEMORY;
+        downloader->ScheduleStartRanges();
+        return;
+    }
+
+    range->mReceived += aLength;
+    downloader->mBytesReceived += aLength;
+
+    // The block extends the verified prefix, so hash it while it is at hand
+    if (offset == downloader->mHashedOffset)
+    {
+        downloader->HashData(aDataBlock, aLength);
+        downloader->mHashedOffset += aLength;
+    }
+}
+
+void SoftwareUpdateImageDownloader::HandleXferError(BDXTransfer *aXfer, StatusReport *aXferError)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    SoftwareUpdateImageDownloader *downloader = range->mDownloader;
+
+    printf("Range at %" PRIu64 " failed: %s\n", range->mStart, nl::StatusReportStr(aXferError->mProfileId, aXferError->mStatusCode));
+
+    downloader->RetryRange(*range, WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+    aXfer->Shutdown();
+
+    downloader->ScheduleStartRanges();
+}
+
+void SoftwareUpdateImageDownloader::HandleXferDone(BDXTransfer *aXfer)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    SoftwareUpdateImageDownloader *downloader = range->mDownloader;
+
+    downloader->FinishRange(*range);
+    aXfer->Shutdown();
+
+    downloader->AdaptParallelism();
+    downloader->ScheduleStartRanges();
+}
+
+void SoftwareUpdateImageDownloader::HandleError(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode)
+{
+    ImageRange *range = static_cast<ImageRange *>(aXfer->mAppState);
+    SoftwareUpdateImageDownloader *downloader = range->mDownloader;
+
+    printf("Range at %" PRIu64 " failed: %s\n", range->mStart, nl::ErrorStr(aErrorCode));
+
+    downloader->RetryRange(*range, aErrorCode);
+    aXfer->Shutdown();
+
+    downloader->ScheduleStartRanges();
+}
+
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
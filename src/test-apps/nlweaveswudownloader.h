@@ -0,0 +1,174 @@
+/*
+ *
+ *    Copyright (c) 2018 Nest Labs, Inc.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines a downloader that fetches the software update
+ *      image named in an ImageQuery response over several parallel BDX
+ *      transfers, one per byte range of the image, and verifies it
+ *      against the IntegritySpec of the response.
+ *
+ */
+
+#ifndef SOFTWARE_UPDATE_DOWNLOADER_H_
+#define SOFTWARE_UPDATE_DOWNLOADER_H_
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Profiles/software-update/SoftwareUpdateProfile.h>
+#include <Weave/Profiles/bulk-data-transfer/Development/BulkDataTransfer.h>
+#include <Weave/Support/crypto/HashAlgos.h>
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+
+/**
+ * Downloads a software update image as a set of disjoint byte ranges, each
+ * fetched by its own BDX ReceiveInit with a start offset and length. Ranges
+ * are written in place into a sparse file, so they may complete in any order.
+ *
+ * The image size is not part of the ImageQuery response; ranges are handed out
+ * in image order and the first range the sender accepts short marks the end of
+ * the image. Ranges handed out past the end are rejected and simply dropped.
+ *
+ * The IntegritySpec digest covers the whole image, so the downloader hashes the
+ * image in order as it becomes contiguous: a block that extends the verified
+ * prefix is hashed straight from the receive buffer, and ranges that completed
+ * ahead of it are read back from the file once the gap before them is filled.
+ *
+ * The number of ranges downloaded at once starts at MinParallelRanges and is
+ * adjusted by hill climbing on the aggregate throughput measured each time a
+ * range completes, up to MaxParallelRanges.
+ */
+class SoftwareUpdateImageDownloader
+{
+public:
+    enum
+    {
+        kMaxRanges = WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS,
+    };
+
+    typedef void (*DownloadCompleteFunct)(SoftwareUpdateImageDownloader *downloader, WEAVE_ERROR err);
+
+    SoftwareUpdateImageDownloader();
+
+    WEAVE_ERROR Init(WeaveExchangeManager *exchangeMgr);
+    WEAVE_ERROR Shutdown();
+
+    WEAVE_ERROR StartDownload(uint64_t nodeId, Inet::IPAddress nodeAddr, const SoftwareUpdate::ImageQueryResponse &response,
+                              const char *destPath);
+    WEAVE_ERROR StartDownload(WeaveConnection *con, const SoftwareUpdate::ImageQueryResponse &response, const char *destPath);
+
+    uint64_t GetImageSize() const { return mImageSize; }
+    uint64_t GetElapsedTime() const { return mEndTime - mStartTime; }
+    uint8_t GetPeakParallelRanges() const { return mPeakParallelRanges; }
+
+    uint32_t RangeSize;                     // Bytes requested by each ReceiveInit
+    uint8_t MinParallelRanges;              // Ranges downloaded at once when the download starts
+    uint8_t MaxParallelRanges;              // Upper bound on ranges downloaded at once
+    uint16_t MaxBlockSize;                  // Proposed BDX block size
+    uint8_t WindowSize;                     // Proposed BDX window size, 1 for stop-and-wait
+    uint8_t MaxRetries;                     // Failed ranges restarted before the download fails
+    DownloadCompleteFunct OnDownloadComplete;
+    void *AppState;
+
+private:
+    enum
+    {
+        kRangeState_Idle                    = 0,    // Slot not in use
+        kRangeState_Pending                 = 1,    // Range waiting for a transfer
+        kRangeState_Active                  = 2,    // Range being downloaded
+    };
+
+    struct ImageRange
+    {
+        SoftwareUpdateImageDownloader *mDownloader;
+        BulkDataTransfer::BDXTransfer *mXfer;
+        uint64_t mStart;                    // Image offset of the first byte of the range
+        uint64_t mEnd;                      // Image offset just past the range
+        uint64_t mReceived;                 // Bytes of the range written to the file
+        uint8_t mState;
+    };
+
+    WeaveExchangeManager *mExchangeMgr;
+    BulkDataTransfer::BdxClient mBdxClient;
+    Binding *mBinding;
+    WeaveConnection *mCon;
+
+    ImageRange mRanges[kMaxRanges];
+    char mDesignator[256];
+    uint16_t mDesignatorLen;
+    int mFd;
+
+    uint8_t mIntegrityType;
+    uint8_t mExpectedDigest[Platform::Security::SHA256::kHashLength];
+    Platform::Security::SHA1 mSHA1;
+    Platform::Security::SHA256 mSHA256;
+
+    uint64_t mImageSize;                    // UINT64_MAX until the end of the image is found
+    uint64_t mNextOffset;                   // Start of the next range to hand out
+    uint64_t mHashedOffset;                 // End of the prefix of the image folded into the digest
+    uint64_t mBytesReceived;
+    uint8_t mNumRetries;
+    bool mIsDownloading;
+    WEAVE_ERROR mPendingError;              // Set by BDX handlers, ends the download once they return
+
+    // Parallelism control
+    uint8_t mParallelRanges;
+    uint8_t mPeakParallelRanges;
+    int8_t mStepDirection;
+    uint32_t mLastThroughput;
+    uint64_t mSampleTime;
+    uint64_t mSampleBytes;
+    uint64_t mStartTime;
+    uint64_t mEndTime;
+
+    WEAVE_ERROR BeginDownload(const SoftwareUpdate::ImageQueryResponse &response, const char *destPath);
+    WEAVE_ERROR StartRanges(void);
+    WEAVE_ERROR StartRange(ImageRange &range);
+    void FinishRange(ImageRange &range);
+    void RetryRange(ImageRange &range, WEAVE_ERROR err);
+    void SetImageEnd(uint64_t aImageSize);
+    void AdaptParallelism(void);
+    void HashData(const uint8_t *data, uint64_t len);
+    WEAVE_ERROR HashCompletedPrefix(void);
+    WEAVE_ERROR VerifyDigest(void);
+    uint64_t GetContiguousEnd(void);
+    uint8_t GetNumActiveRanges(void);
+    void ScheduleStartRanges(void);
+    void CompleteDownload(WEAVE_ERROR err);
+    void Reset(void);
+
+    static void HandleBindingEvent(void *const appState, const Binding::EventType event, const Binding::InEventParam &inParam,
+                                   Binding::OutEventParam &outParam);
+    static void HandleStartRanges(System::Layer *aSystemLayer, void *aAppState, System::Error aError);
+    static WEAVE_ERROR HandleReceiveAccept(BulkDataTransfer::BDXTransfer *aXfer, BulkDataTransfer::ReceiveAccept *aReceiveAcceptMsg);
+    static void HandleReject(BulkDataTransfer::BDXTransfer *aXfer, StatusReporting::StatusReport *aReport);
+    static void HandlePutBlock(BulkDataTransfer::BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBlock, bool aIsLastBlock);
+    static void HandleXferError(BulkDataTransfer::BDXTransfer *aXfer, StatusReporting::StatusReport *aXferError);
+    static void HandleXferDone(BulkDataTransfer::BDXTransfer *aXfer);
+    static void HandleError(BulkDataTransfer::BDXTransfer *aXfer, WEAVE_ERROR aErrorCode);
+
+    SoftwareUpdateImageDownloader(const SoftwareUpdateImageDownloader&);   // not defined
+};
+
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+#endif // SOFTWARE_UPDATE_DOWNLOADER_H_
@@ -83,7 +83,12 @@ uint32_t ConnectMaxTry = 3;
 uint64_t StartOffset = BDX_CLIENT_DEFAULT_START_OFFSET;
 uint64_t FileLength = BDX_CLIENT_DEFAULT_FILE_LENGTH;
 uint64_t MaxBlockSize = BDX_CLIENT_DEFAULT_MAX_BLOCK_SIZE;
+uint8_t WindowSize = WEAVE_CONFIG_BDX_WINDOW_SIZE;
 bool Upload = false; // download by default
+bool Resume = false; // resume interrupted downloads
+uint32_t ImageVersion = 0; // version of the image to resume, 0 if unknown
+uint32_t ImageCrc = 0; // expected CRC-32 of a resumed image
+bool HasImageCrc = false;
 bool UseTCP = true;
 const char *DestIPAddrStr = NULL;
 const char *RequestedFileName = NULL;
@@ -99,16 +104,26 @@ WeaveConnection *Con = NULL;
 nl::Weave::Binding *TheBinding = NULL;
 
 
+enum
+{
+    kToolOpt_ImageVersion                           = 1000,
+    kToolOpt_ImageCrc,
+};
+
 static OptionDef gToolOptionDefs[] =
 {
     { "requested-file", kArgumentRequired, 'r' },
     { "start-offset",   kArgumentRequired, 's' },
     { "length",         kArgumentRequired, 'l' },
     { "block-size",     kArgumentRequired, 'b' },
+    { "window-size",    kArgumentRequired, 'w' },
     { "dest-addr",      kArgumentRequired, 'D' },
     { "received-loc",   kArgumentRequired, 'R' },
     { "debug",          kArgumentRequired, 'd' },
     { "upload",         kNoArgument,       'p' },
+    { "resume",         kNoArgument,       'c' },
+    { "image-version",  kArgumentRequired, kToolOpt_ImageVersion },
+    { "image-crc",      kArgumentRequired, kToolOpt_ImageCrc },
     { "tcp",            kNoArgument,       't' },
     { "udp",            kNoArgument,       'u' },
     { "pretest",        kNoArgument,       'T' },
@@ -130,6 +145,11 @@ static const char *gToolOptionHelp =
     "  -b, --block-size <num>\n"
     "       Max block size to propose in a transfer. Defaults to 512.\n"
     "\n"
+    "  -w, --window-size <num>\n"
+    "       Max number of blocks to keep in flight when the peer supports windowed\n"
+    "       transfers. Downloads ask the server to drive so it can do the same.\n"
+    "       0 or 1 selects stop-and-wait transfers. Defaults to WEAVE_CONFIG_BDX_WINDOW_SIZE.\n"
+    "\n"
     "  -D, --dest-addr <ip-addr>\n"
     "       Send ReceiveInit requests to a specific address rather than one\n"
     "       derived from the destination node id.  <ip-addr> can be an IPv4 or IPv6 address.\n"
@@ -140,6 +160,19 @@ static const char *gToolOptionHelp =
     "  -p, --upload\n"
     "       Upload a file to the BDX server rather than download one from it, which is the default.\n"
     "\n"
+    "  -c, --resume\n"
+    "       Checkpoint the progress of a download and continue an interrupted download of the\n"
+    "       same file where it stopped. Only applies to downloads starting at offset 0.\n"
+    "       Requires WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT.\n"
+    "\n"
+    "  --image-version <num>\n"
+    "       Version or modification time of the requested file. A resumed download only\n"
+    "       continues a checkpoint of the same file, length and version.\n"
+    "\n"
+    "  --image-crc <hex>\n"
+    "       Expected CRC-32 of the requested file. A resumed download that doesn't match\n"
+    "       fails instead of completing.\n"
+    "\n"
     "  -t, --tcp\n"
     "       Use TCP to send BDX Requests. This is the default.\n"
     "\n"
@@ -325,6 +358,12 @@ int main(int argc, char *argv[])
             appState->mFile = NULL;
         }
 
+        if (appState->mSource)
+        {
+            ReleaseFileSource(appState->mSource);
+            appState->mSource = NULL;
+        }
+
         if (Con)
         {
             Con->Close();
@@ -450,6 +489,7 @@ void StartUDPUpload()
     }
 
     xfer->mMaxBlockSize = MaxBlockSize;
+    xfer->mMaxWindowSize = WindowSize;
     xfer->mStartOffset = StartOffset;
     xfer->mLength = FileLength;
 
@@ -516,10 +556,20 @@ void StartUDPDownload()
     }
 
     xfer->mMaxBlockSize = MaxBlockSize;
+    xfer->mMaxWindowSize = WindowSize;
     xfer->mStartOffset = StartOffset;
     xfer->mLength = FileLength;
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    // The partial file is saved from offset 0, so only whole downloads can resume
+    xfer->mIsResumable = Resume && (StartOffset == 0);
+    xfer->mImageLength = FileLength;
+    xfer->mImageVersion = ImageVersion;
+    xfer->mExpectedCrc = ImageCrc;
+    xfer->mHasExpectedCrc = HasImageCrc;
+#endif
 
-    err = BDXClient.InitBdxReceive(*xfer, true, false, false, NULL);
+    // Windowing needs the sender, i.e. the server, to drive
+    err = BDXClient.InitBdxReceive(*xfer, WindowSize <= 1, WindowSize > 1, false, NULL);
 
     if (err == WEAVE_NO_ERROR)
     {
@@ -564,6 +614,13 @@ bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *n
             return false;
         }
         break;
+    case 'w':
+        if (!ParseInt(arg, WindowSize))
+        {
+            PrintArgError("%s: Invalid value specified for window size: %s\n", progName, arg);
+            return false;
+        }
+        break;
     case 'R':
         ReceivedFileLocation = arg;
         SetReceivedFileLocation(ReceivedFileLocation);
@@ -571,6 +628,24 @@ bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *n
     case 'p':
         Upload = true;
         break;
+    case 'c':
+        Resume = true;
+        break;
+    case kToolOpt_ImageVersion:
+        if (!ParseInt(arg, ImageVersion))
+        {
+            PrintArgError("%s: Invalid value specified for image version: %s\n", progName, arg);
+            return false;
+        }
+        break;
+    case kToolOpt_ImageCrc:
+        if (!ParseInt(arg, ImageCrc, 16))
+        {
+            PrintArgError("%s: Invalid value specified for image CRC: %s\n", progName, arg);
+            return false;
+        }
+        HasImageCrc = true;
+        break;
     case 'T':
         Pretest = true;
         break;
@@ -709,6 +784,8 @@ void HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr)
 
             if (err == WEAVE_NO_ERROR)
             {
+                xfer->mMaxWindowSize = WindowSize;
+
                 // In the test-app, we need to make sure we only send the file name
                 // in the mFileDesignator.
                 WeaveLogDetail(BDX, "%s", refRequestedFileName.theString);
@@ -748,7 +825,16 @@ void HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr)
 
             if (err == WEAVE_NO_ERROR)
             {
-                err = BDXClient.InitBdxReceive(*xfer, true, false, false, NULL);
+                xfer->mMaxWindowSize = WindowSize;
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+                xfer->mIsResumable = Resume;
+                xfer->mImageVersion = ImageVersion;
+                xfer->mExpectedCrc = ImageCrc;
+                xfer->mHasExpectedCrc = HasImageCrc;
+#endif
+
+                // Windowing needs the sender, i.e. the server, to drive
+                err = BDXClient.InitBdxReceive(*xfer, WindowSize <= 1, WindowSize > 1, false, NULL);
             }
 #endif // WEAVE_CONFIG_BDX_CLIENT_RECEIVE_SUPPORT
         }
@@ -31,6 +31,9 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // This code uses DEVELOPMENT BDX namespace
 
@@ -38,6 +41,8 @@
 
 #include <Weave/Core/WeaveConfig.h>
 #include <Weave/Support/logging/WeaveLogging.h>
+#include <Weave/Support/LZ4Frame.h>
+#include <Weave/Profiles/data-management/Current/LogBDXUpload.h>
 
 #include "weave-bdx-common-development.h"
 
@@ -58,13 +63,32 @@ using namespace nl::Weave::Profiles;
 using namespace nl::Weave::Profiles::Common;
 using namespace nl::Weave::Profiles::BulkDataTransfer;
 using namespace nl::Weave::Logging;
+using namespace nl::Weave::TLV;
 
 namespace nl {
 namespace Weave {
 namespace Profiles {
 namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development) {
 
+enum
+{
+    kDecoderHistorySize = 64 * 1024, // enough for any LZ4 frame encoder
+    kDecoderMaxBlockSize = 64 * 1024, // the smallest maximum an LZ4 frame can declare
+};
+
+struct BdxDecoder
+{
+    LZ4FrameReader mReader;
+    uint64_t mDecodedBytes;
+    uint8_t mWindow[kDecoderHistorySize + kDecoderMaxBlockSize];
+    uint8_t mBlock[kDecoderMaxBlockSize];
+};
+
 static BdxAppState mAppStatePool[WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS];
+static BdxFileSource sFileSourcePool[WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS];
+
+// Number of windows of blocks to prefetch ahead of the one being sent
+static uint8_t sReadAheadWindows = 1;
 
 // curled files go here
 char TempFileLocation[FILENAME_MAX] = "/tmp/";
@@ -77,7 +101,8 @@ BdxAppState *NewAppState()
     for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
     {
         appState = &mAppStatePool[i];
-        if (appState->mFile != NULL || !appState->mDone || appState->mBuffer != NULL)
+        if (appState->mFile != NULL || !appState->mDone || appState->mBuffer != NULL || appState->mSource != NULL ||
+            appState->mDecoder != NULL)
         {
             continue;
         }
@@ -96,6 +121,8 @@ void ResetAppStates()
         mAppStatePool[i].mFile = NULL;
         mAppStatePool[i].mDone = true;
         mAppStatePool[i].mBuffer = NULL;
+        mAppStatePool[i].mSource = NULL;
+        mAppStatePool[i].mDecoder = NULL;
     }
 }
 
@@ -125,6 +152,159 @@ void SetTempLocation(const char *path)
     TempFileLocation[sizeof(TempFileLocation) - 1] = '\0';
 }
 
+/** Sets how many windows of blocks (a single block for stop-and-wait
+ * transfers) are prefetched from a file ahead of the block being sent.
+ * 0 disables read-ahead.
+ */
+void SetReadAheadWindows(uint8_t aNumWindows)
+{
+    sReadAheadWindows = aNumWindows;
+}
+
+/** Opens the file at aPath for sending, sharing the source with any ongoing
+ * transfer of the same unmodified file.  The file is memory-mapped when the
+ * platform allows it and read with pread() otherwise.
+ *
+ * @return the source, to be released with ReleaseFileSource(), or NULL if the
+ * file can't be opened or too many files are open.
+ */
+BdxFileSource *AcquireFileSource(const char *aPath)
+{
+    BdxFileSource *source = NULL;
+    struct stat st;
+    int fd;
+    void *map;
+
+    fd = open(aPath, O_RDONLY);
+    VerifyOrExit(fd >= 0, WeaveLogError(BDX, "Error opening file %s: %s", aPath, strerror(errno)));
+
+    VerifyOrExit(fstat(fd, &st) == 0 && S_ISREG(st.st_mode),
+                 WeaveLogError(BDX, "%s is not a regular file", aPath));
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        BdxFileSource &shared = sFileSourcePool[i];
+
+        if (shared.mRefCount > 0 &&
+            shared.mDev == static_cast<uint64_t>(st.st_dev) && shared.mIno == static_cast<uint64_t>(st.st_ino) &&
+            shared.mSize == static_cast<uint64_t>(st.st_size) && shared.mMTime == static_cast<int64_t>(st.st_mtime))
+        {
+            shared.mRefCount++;
+            source = &shared;
+            ExitNow();
+        }
+    }
+
+    for (int i = 0; i < WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS; i++)
+    {
+        if (sFileSourcePool[i].mRefCount == 0)
+        {
+            source = &sFileSourcePool[i];
+            break;
+        }
+    }
+
+    VerifyOrExit(source != NULL, WeaveLogError(BDX, "BDX: Ran out of file sources, maximum %d", WEAVE_CONFIG_BDX_MAX_NUM_TRANSFERS));
+
+    source->mMap = NULL;
+    source->mFd = -1;
+    source->mSize = st.st_size;
+    source->mDev = st.st_dev;
+    source->mIno = st.st_ino;
+    source->mMTime = st.st_mtime;
+    source->mRefCount = 1;
+
+    // Empty files and files too large for the address space can't be mapped
+    if (st.st_size > 0 && static_cast<uint64_t>(st.st_size) <= SIZE_MAX)
+    {
+        map = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            source->mMap = static_cast<uint8_t *>(map);
+            madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        }
+    }
+
+    if (source->mMap == NULL)
+    {
+        WeaveLogDetail(BDX, "Unable to map %s, reading it instead", aPath);
+        source->mFd = fd;
+        fd = -1;
+    }
+
+exit:
+    // A mapping stays valid after its file descriptor is closed
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return source;
+}
+
+/** Releases a source obtained from AcquireFileSource(), unmapping or closing
+ * the file once no transfer uses it anymore.
+ */
+void ReleaseFileSource(BdxFileSource *aSource)
+{
+    VerifyOrExit(aSource != NULL && aSource->mRefCount > 0, );
+
+    aSource->mRefCount--;
+    VerifyOrExit(aSource->mRefCount == 0, );
+
+    if (aSource->mMap != NULL)
+    {
+        munmap(aSource->mMap, static_cast<size_t>(aSource->mSize));
+        aSource->mMap = NULL;
+    }
+
+    if (aSource->mFd >= 0)
+    {
+        close(aSource->mFd);
+        aSource->mFd = -1;
+    }
+
+exit:
+    return;
+}
+
+/** Asks the OS to start reading the blocks the transfer will send next, so
+ * that they are in memory by the time the protocol asks for them.
+ */
+static void ReadAhead(BDXTransfer *aXfer, BdxAppState *aState)
+{
+    BdxFileSource *source = aState->mSource;
+    uint64_t blocks = sReadAheadWindows * ((aXfer->mIsWindowed && aXfer->mMaxWindowSize > 1) ? aXfer->mMaxWindowSize : 1);
+    uint64_t target = aState->mOffset + blocks * aXfer->mMaxBlockSize;
+    uint64_t start = (aState->mReadAheadOffset > aState->mOffset) ? aState->mReadAheadOffset : aState->mOffset;
+
+    if (target > aState->mEndOffset)
+    {
+        target = aState->mEndOffset;
+    }
+
+    VerifyOrExit(target > start, );
+
+    if (source->mMap != NULL)
+    {
+        // madvise() needs a page-aligned address
+        uint64_t pageStart = start - (start % sysconf(_SC_PAGESIZE));
+
+        madvise(source->mMap + pageStart, static_cast<size_t>(target - pageStart), MADV_WILLNEED);
+    }
+#ifdef POSIX_FADV_WILLNEED
+    else
+    {
+        posix_fadvise(source->mFd, start, target - start, POSIX_FADV_WILLNEED);
+    }
+#endif // POSIX_FADV_WILLNEED
+
+    aState->mReadAheadOffset = target;
+
+exit:
+    return;
+}
+
 /** Helper function for use by libcurl. */
 size_t WriteData(void *aPtr, size_t aSize, size_t aNmemb, FILE *aStream)
 {
@@ -251,6 +431,96 @@ int DownloadFile(char *aFileDesignator, size_t aFileDesignatorBufferSize)
 }
 #endif // HAVE_CURL_CURL_H && HAVE_CURL_EASY_H
 
+/** Returns true if the SendInit metadata offers an event log compressed into an LZ4 frame.
+ */
+static bool IsLZ4CompressionOffered(SendInit *aSendInitMsg)
+{
+    TLVReader reader;
+    TLVType container;
+    TLVType array;
+    uint8_t compression;
+
+    if (aSendInitMsg->mMetaData.isEmpty())
+    {
+        return false;
+    }
+
+    reader.Init(aSendInitMsg->mMetaData.theData, aSendInitMsg->mMetaData.theLength);
+
+    if (reader.Next(kTLVType_Structure, AnonymousTag) != WEAVE_NO_ERROR || reader.EnterContainer(container) != WEAVE_NO_ERROR)
+    {
+        return false;
+    }
+
+    while (reader.Next() == WEAVE_NO_ERROR)
+    {
+        if (reader.GetTag() != ContextTag(DataManagement::kTag_LogUploadCompression) || reader.GetType() != kTLVType_Array ||
+            reader.EnterContainer(array) != WEAVE_NO_ERROR)
+        {
+            continue;
+        }
+
+        while (reader.Next() == WEAVE_NO_ERROR)
+        {
+            if (reader.Get(compression) == WEAVE_NO_ERROR && compression == DataManagement::kLogUploadCompression_LZ4Frame)
+            {
+                return true;
+            }
+        }
+
+        reader.ExitContainer(array);
+    }
+
+    return false;
+}
+
+/** Writes the SendAccept metadata telling the sender to compress into an LZ4 frame.
+ */
+static void WriteLZ4CompressionAccept(TLVWriter &aWriter, void *aAppState)
+{
+    TLVType container;
+
+    aWriter.StartContainer(AnonymousTag, kTLVType_Structure, container);
+    aWriter.Put(ContextTag(DataManagement::kTag_LogUploadCompression),
+                static_cast<uint8_t>(DataManagement::kLogUploadCompression_LZ4Frame));
+    aWriter.EndContainer(container);
+    aWriter.Finalize();
+}
+
+static WEAVE_ERROR WriteDecodedData(void *aAppState, const uint8_t *aData, uint32_t aDataLen)
+{
+    BdxAppState *appState = static_cast<BdxAppState *>(aAppState);
+
+    appState->mDecoder->mDecodedBytes += aDataLen;
+
+    return (fwrite(aData, 1, aDataLen, appState->mFile) == aDataLen) ? WEAVE_NO_ERROR : WEAVE_ERROR_INCORRECT_STATE;
+}
+
+/** Reports the compression ratio of a decompressed file and frees its decoder.
+ */
+static void ReleaseDecoder(BdxAppState *aAppState)
+{
+    BdxDecoder *decoder = aAppState->mDecoder;
+
+    if (decoder == NULL)
+    {
+        return;
+    }
+
+    if (decoder->mReader.IsComplete() && aAppState->mReceivedBytes > 0)
+    {
+        WeaveLogProgress(BDX, "Decompressed %" PRIu64 " bytes from %" PRIu64 " bytes, ratio %.2f", decoder->mDecodedBytes,
+                         aAppState->mReceivedBytes, static_cast<double>(decoder->mDecodedBytes) / aAppState->mReceivedBytes);
+    }
+    else
+    {
+        WeaveLogError(BDX, "Compressed file ended after %" PRIu64 " bytes, before the end of its LZ4 frame", aAppState->mReceivedBytes);
+    }
+
+    free(decoder);
+    aAppState->mDecoder = NULL;
+}
+
 /** Example implementation of a SendInitHandler that opens the requested file if possible
  * (in a directory specified by ReceivedFileLocation) and sets up the BDXTransfer
  * by attaching our AppState to store the open file handle and setting the appropriate
@@ -289,6 +559,20 @@ uint16_t BdxSendInitHandler(BDXTransfer *aXfer, SendInit *aSendInitMsg)
     //TODO: shouldn't be using dynamic memory allocation, but how to do that with dynamically negotiated maxBlockSize???
     //perhaps just go ahead and allocate our maximum size since we know the transfer won't go above that?
     mAppState->mBuffer = (uint8_t *)malloc(aSendInitMsg->mMaxBlockSize);
+    mAppState->mReceivedBytes = 0;
+
+    // Take the file compressed if the sender offers to, and decompress it as it arrives
+    if (IsLZ4CompressionOffered(aSendInitMsg))
+    {
+        mAppState->mDecoder = (BdxDecoder *)malloc(sizeof(BdxDecoder));
+        VerifyOrExit(mAppState->mDecoder != NULL, err = kStatus_ServerBadState);
+
+        mAppState->mDecoder->mDecodedBytes = 0;
+        mAppState->mDecoder->mReader.Init(mAppState->mDecoder->mWindow, sizeof(mAppState->mDecoder->mWindow),
+                                          mAppState->mDecoder->mBlock, sizeof(mAppState->mDecoder->mBlock));
+
+        aXfer->mAcceptMetaData.init(WriteLZ4CompressionAccept, NULL);
+    }
 
     // All seems good, so accept the transfer and set the handlers
     aXfer->mIsAccepted = true;
@@ -310,14 +594,16 @@ exit:
 uint16_t BdxReceiveInitHandler(BDXTransfer *aXfer, ReceiveInit *aReceiveInit)
 {
     uint16_t err = kStatus_NoError;
-    int retval = 0;
-    long fileSize = 0;
+    uint64_t fileSize = 0;
     BdxAppState *mAppState;
     char *fileDesignator = NULL;
+#if HAVE_CURL_CURL_H && HAVE_CURL_EASY_H
+    int retval = 0;
+#endif
 #if !defined(HAVE_CURL_CURL_H) || !defined(HAVE_CURL_EASY_H)
     char *tempFileDesignator = NULL;
 #endif
-    FILE *targetFile = NULL;
+    BdxFileSource *source = NULL;
 
     BDXHandlers handlers =
     {
@@ -369,24 +655,12 @@ uint16_t BdxReceiveInitHandler(BDXTransfer *aXfer, ReceiveInit *aReceiveInit)
     aXfer->mAppState = mAppState;
 
     // The client already handles Setting transfer mode, max block size, and start sending
-    // We just need to open the file and allocate a buffer for reading blocks
-    targetFile = fopen(fileDesignator, "r");
-    VerifyOrExit(targetFile != NULL,
-                 err = kStatus_UnknownFile;
-                 WeaveLogError(BDX, "Error opening file %s", fileDesignator));
-    // Use fseek/ftell to find the size of the file.
-    fseek(targetFile, 0, SEEK_END);
-    // This will only work for files below 2 GB
-    fileSize = ftell(targetFile);
-    VerifyOrExit(fileSize >= 0, err = kStatus_Unknown);
-    VerifyOrExit(static_cast<uint64_t>(fileSize) >= aReceiveInit->mStartOffset, err = kStatus_StartOffsetNotSupported);
-
-    retval = fseek(targetFile, aReceiveInit->mStartOffset, SEEK_SET);
-    VerifyOrExit(retval == 0, err = kStatus_StartOffsetNotSupported);
+    // We just need to open the file; blocks are read straight from it, no buffer needed
+    source = AcquireFileSource(fileDesignator);
+    VerifyOrExit(source != NULL, err = kStatus_UnknownFile);
 
-    mAppState->mFile = targetFile;
-
-    targetFile = NULL;
+    fileSize = source->mSize;
+    VerifyOrExit(fileSize >= aReceiveInit->mStartOffset, err = kStatus_StartOffsetNotSupported);
 
     if (aReceiveInit->mLength == 0)
     {
@@ -394,12 +668,15 @@ uint16_t BdxReceiveInitHandler(BDXTransfer *aXfer, ReceiveInit *aReceiveInit)
     }
     else
     {
-        aXfer->mLength = (aReceiveInit->mLength + aReceiveInit->mStartOffset > static_cast<uint64_t>(fileSize)) ? (fileSize - aReceiveInit->mStartOffset) : (aReceiveInit->mLength);
+        aXfer->mLength = (aReceiveInit->mLength + aReceiveInit->mStartOffset > fileSize) ? (fileSize - aReceiveInit->mStartOffset) : (aReceiveInit->mLength);
     }
 
-    //TODO: shouldn't be using dynamic memory allocation, but how to do that with dynamically negotiated maxBlockSize???
-    //perhaps just go ahead and allocate our maximum size since we know the transfer won't go above that?
-    mAppState->mBuffer = (uint8_t *)malloc(aReceiveInit->mMaxBlockSize);
+    mAppState->mSource = source;
+    mAppState->mOffset = aReceiveInit->mStartOffset;
+    mAppState->mEndOffset = aReceiveInit->mStartOffset + aXfer->mLength;
+    mAppState->mReadAheadOffset = mAppState->mOffset;
+
+    source = NULL;
 
     // All seems good, so accept the transfer and set the handlers
     aXfer->mIsAccepted = true;
@@ -412,10 +689,10 @@ exit:
         free(fileDesignator);
     }
 
-    if (targetFile != NULL)
+    if (source != NULL)
     {
-        fclose(targetFile);
-        targetFile = NULL;
+        ReleaseFileSource(source);
+        source = NULL;
     }
 
     return err;
@@ -433,17 +710,21 @@ WEAVE_ERROR BdxSendAcceptHandler(BDXTransfer *aXfer, SendAccept *aSendAcceptMsg)
     WEAVE_ERROR error = WEAVE_NO_ERROR;
 
     // The client already handles Setting transfer mode, max block size, and start sending
-    // We just need to open the file and allocate a buffer for reading blocks
-    bdxState->mFile = fopen(aXfer->mFileDesignator.theString, "r");
-    if (!bdxState->mFile)
+    // We just need to open the file; blocks are read straight from it, no buffer needed
+    bdxState->mSource = AcquireFileSource(aXfer->mFileDesignator.theString);
+    if (!bdxState->mSource)
     {
         printf("Error opening file %s\n", aXfer->mFileDesignator.theString);
         exit(-1);
     }
 
-    //TODO: shouldn't be using dynamic memory allocation, but how to do that with dynamically negotiated maxBlockSize???
-    //perhaps just go ahead and allocate our maximum size since we know the transfer won't go above that?
-    bdxState->mBuffer = (uint8_t*)malloc(aSendAcceptMsg->mMaxBlockSize);
+    bdxState->mOffset = 0;
+    bdxState->mEndOffset = bdxState->mSource->mSize;
+    if (aXfer->mLength != 0 && aXfer->mLength < bdxState->mEndOffset)
+    {
+        bdxState->mEndOffset = aXfer->mLength;
+    }
+    bdxState->mReadAheadOffset = 0;
 
     return error;
 }
@@ -486,7 +767,20 @@ WEAVE_ERROR BdxReceiveAcceptHandler(BDXTransfer *aXfer, ReceiveAccept *aReceiveA
 
     WeaveLogDetail(BDX, "File being saved to: %s", fileDesignator);
 
-    bdxState->mFile = fopen(fileDesignator, "w");
+    // A resumed download continues the partial file where it stopped
+    if (aXfer->mStartOffset > 0)
+    {
+        bdxState->mFile = fopen(fileDesignator, "r+");
+        if (bdxState->mFile && fseek(bdxState->mFile, aXfer->mStartOffset, SEEK_SET) != 0)
+        {
+            fclose(bdxState->mFile);
+            bdxState->mFile = NULL;
+        }
+    }
+    else
+    {
+        bdxState->mFile = fopen(fileDesignator, "w");
+    }
     if (!bdxState->mFile)
     {
         WeaveLogDetail(BDX, "Error opening file %s\n", fileDesignator);
@@ -506,9 +800,10 @@ void BdxRejectHandler(BDXTransfer *aXfer, StatusReport *aReport)
     ((BdxAppState*)aXfer->mAppState)->mDone = true;
 }
 
-/** Example implementation of a GetBlockHandler that reads a block from the associated
- * open file handle, stores it in the AppState's buffer, and sets the parameters as
- * appropriate so the protocol can handle the block.
+/** Example implementation of a GetBlockHandler that takes the next block from the
+ * transfer's file source without an intermediate copy: a mapped file hands the block
+ * out in place, otherwise it is read straight into the buffer the protocol provides.
+ * The following blocks are prefetched while this one is sent.
  */
 void BdxGetBlockHandler(BDXTransfer *aXfer,
                         uint64_t *aLength,
@@ -516,22 +811,38 @@ void BdxGetBlockHandler(BDXTransfer *aXfer,
                         bool *aIsLastBlock)
 {
     BdxAppState* bdxState = static_cast<BdxAppState*>(aXfer->mAppState);
-    uint64_t blockSize = 0;
+    BdxFileSource *source = bdxState->mSource;
+    uint64_t blockSize = *aLength;
+    ssize_t nread;
 
-    if (aXfer->mLength != 0 && ((aXfer->mLength - aXfer->mBytesSent) < aXfer->mMaxBlockSize))
+    if (blockSize > aXfer->mMaxBlockSize)
     {
-        blockSize = aXfer->mLength - aXfer->mBytesSent;
+        blockSize = aXfer->mMaxBlockSize;
+    }
+
+    if (blockSize > bdxState->mEndOffset - bdxState->mOffset)
+    {
+        blockSize = bdxState->mEndOffset - bdxState->mOffset;
+    }
+
+    if (source->mMap != NULL)
+    {
+        *aDataBlock = source->mMap + bdxState->mOffset;
+        *aLength = blockSize;
     }
     else
     {
-        blockSize = aXfer->mMaxBlockSize;
+        nread = pread(source->mFd, *aDataBlock, blockSize, bdxState->mOffset);
+        *aLength = (nread > 0) ? nread : 0;
     }
 
-    *aLength = fread(bdxState->mBuffer, 1, blockSize, bdxState->mFile);
-    *aDataBlock = bdxState->mBuffer;
-    aXfer->mBytesSent += blockSize;
+    bdxState->mOffset += *aLength;
+    aXfer->mBytesSent += *aLength;
+
+    // A short read means the file was truncated under us, so end the transfer there
+    *aIsLastBlock = (bdxState->mOffset >= bdxState->mEndOffset) || (*aLength < blockSize);
 
-    *aIsLastBlock = (*aLength < aXfer->mMaxBlockSize) ? true : false;
+    ReadAhead(aXfer, bdxState);
 }
 
 /** Example implementation of a PutBlockHandler that dumps the block to stdout for
@@ -543,11 +854,33 @@ void BdxPutBlockHandler(BDXTransfer *aXfer, uint64_t aLength, uint8_t *aDataBloc
 
     DumpMemory(aDataBlock, aLength, "--> ", 16);
 
-    if (bdxState->mFile)
+    bdxState->mReceivedBytes += aLength;
+
+    if (bdxState->mFile && bdxState->mDecoder)
+    {
+        WEAVE_ERROR err = bdxState->mDecoder->mReader.Decode(aDataBlock, aLength, WriteDecodedData, bdxState);
+
+        // Keep a corrupt stream from being written any further
+        if (err != WEAVE_NO_ERROR)
+        {
+            WeaveLogError(BDX, "PutBlockHandler failed to decompress block: %s", ErrorStr(err));
+            fclose(bdxState->mFile);
+            bdxState->mFile = NULL;
+        }
+    }
+    else if (bdxState->mFile)
     {
         // Write bulk data to disk.
         int wtd = fwrite(aDataBlock, 1, aLength, bdxState->mFile);
         WeaveLogDetail(BDX, "PutBlockHandler wrote %d bytes to disk", wtd);
+
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+        // The block must be on disk before BDX may checkpoint past it
+        if (aXfer->mIsResumable)
+        {
+            fflush(bdxState->mFile);
+        }
+#endif
     }
 }
 
@@ -572,6 +905,14 @@ void BdxXferErrorHandler(BDXTransfer *aXfer, StatusReport *aXferError)
         appState->mFile = NULL;
     }
 
+    if (appState->mSource)
+    {
+        ReleaseFileSource(appState->mSource);
+        appState->mSource = NULL;
+    }
+
+    ReleaseDecoder(appState);
+
     appState->mDone = true;
 
     // app-defined state to tell main() to terminate client program
@@ -592,6 +933,15 @@ void BdxXferErrorHandler(BDXTransfer *aXfer, StatusReport *aXferError)
 void BdxXferDoneHandler(BDXTransfer *aXfer)
 {
     WeaveLogDetail(BDX, "Transfer complete!");
+    WeaveLogProgress(BDX, "Transferred %" PRIu64 " bytes at %" PRIu32 " bytes/s (%s), RTT avg %" PRIu32 " ms min %" PRIu32 " ms, %" PRIu32 " retransmits",
+                     aXfer->mBytesTransferred, aXfer->GetThroughput(), aXfer->mIsWindowed ? "windowed" : "stop-and-wait",
+                     aXfer->mSmoothedRTT, aXfer->mMinRTT, aXfer->mNumRetransmits);
+#if WEAVE_CONFIG_BDX_CHECKPOINT_SUPPORT
+    if (aXfer->mIsResumable)
+    {
+        WeaveLogProgress(BDX, "Received image CRC-32: 0x%08" PRIX32, aXfer->mIntegrityCrc);
+    }
+#endif
     BdxAppState *appState = (BdxAppState *)(aXfer->mAppState);
     if (appState->mFile)
     {
@@ -602,6 +952,14 @@ void BdxXferDoneHandler(BDXTransfer *aXfer)
         appState->mFile = NULL;
     }
 
+    if (appState->mSource)
+    {
+        ReleaseFileSource(appState->mSource);
+        appState->mSource = NULL;
+    }
+
+    ReleaseDecoder(appState);
+
     appState->mDone = true;
 
     // app-defined state to tell main() to terminate client program
@@ -633,6 +991,14 @@ void BdxErrorHandler(BDXTransfer *aXfer, WEAVE_ERROR aErrorCode)
         appState->mFile = NULL;
     }
 
+    if (appState->mSource)
+    {
+        ReleaseFileSource(appState->mSource);
+        appState->mSource = NULL;
+    }
+
+    ReleaseDecoder(appState);
+
     if (appState->mBuffer != NULL)
     {
         free(appState->mBuffer);
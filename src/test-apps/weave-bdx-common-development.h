@@ -40,6 +40,25 @@ namespace Weave {
 namespace Profiles {
 namespace WeaveMakeManagedNamespaceIdentifier(BDX, kWeaveManagedNamespaceDesignation_Development) {
 
+// A file being sent, shared by all transfers of the same (unmodified) file so
+// that an image server pushing one image to many devices maps it only once.
+// The file is memory-mapped when possible, in which case blocks are handed to
+// the protocol in place; otherwise they are read with pread() straight into
+// the PacketBuffer the protocol provides.
+struct BdxFileSource
+{
+    uint8_t *mMap; // NULL if the file could not be mapped
+    int mFd; // Used for pread() when the file is not mapped, -1 otherwise
+    uint64_t mSize;
+    uint64_t mDev; // Identity of the file, used to share the source
+    uint64_t mIno;
+    int64_t mMTime;
+    uint32_t mRefCount; // 0 if the source is free
+};
+
+// Decompresses a file the sender compresses into an LZ4 frame, such as an event log upload
+struct BdxDecoder;
+
 // AppState object for holding application-specific info that is passed around to handlers
 // This object is attached to a BDXTransfer via its mAppState member.
 struct BdxAppState
@@ -47,6 +66,12 @@ struct BdxAppState
     FILE *mFile;
     bool mDone;
     uint8_t *mBuffer; // buffer to store read blocks
+    BdxFileSource *mSource; // file being sent, NULL when receiving
+    uint64_t mOffset; // file offset of the next block to send
+    uint64_t mEndOffset; // file offset at which the transfer ends
+    uint64_t mReadAheadOffset; // end of the range already prefetched
+    BdxDecoder *mDecoder; // NULL unless the file being received is compressed
+    uint64_t mReceivedBytes; // bytes received, before decompression
 };
 
 // Returns a reference to a static BdxAppState so that handlers can grab one
@@ -57,6 +82,10 @@ void ResetAppStates();
 
 void SetReceivedFileLocation(const char *path);
 void SetTempLocation(const char *path);
+void SetReadAheadWindows(uint8_t aNumWindows);
+
+BdxFileSource *AcquireFileSource(const char *aPath);
+void ReleaseFileSource(BdxFileSource *aSource);
 
 // Helper functions
 size_t WriteData(void *aPtr, size_t aSize, size_t aNmemb, FILE *aStream);
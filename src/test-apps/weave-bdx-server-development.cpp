@@ -78,6 +78,7 @@ static OptionDef gToolOptionDefs[] =
 {
     { "received-loc", kArgumentRequired, 'R' },
     { "temp-loc",     kArgumentRequired, 'T' },
+    { "read-ahead",   kArgumentRequired, 'A' },
     { NULL }
 };
 
@@ -87,6 +88,10 @@ static const char *gToolOptionHelp =
     "\n"
     "  -T, --temp-loc <path>\n"
     "       Location to keep temporary files.\n"
+    "\n"
+    "  -A, --read-ahead <num>\n"
+    "       Number of windows of blocks to prefetch from a file being sent.\n"
+    "       0 disables read-ahead. Defaults to 1.\n"
     "\n";
 
 static OptionSet gToolOptions =
@@ -219,6 +224,18 @@ bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *n
         TempFileLocation = arg;
         SetTempLocation(TempFileLocation);
         break;
+    case 'A':
+    {
+        uint8_t readAheadWindows;
+
+        if (!ParseInt(arg, readAheadWindows))
+        {
+            PrintArgError("%s: Invalid value specified for read-ahead: %s\n", progName, arg);
+            return false;
+        }
+        SetReadAheadWindows(readAheadWindows);
+        break;
+    }
     default:
         PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
         return false;
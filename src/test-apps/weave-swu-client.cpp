@@ -32,6 +32,7 @@
 #include <Weave/Core/WeaveSecurityMgr.h>
 #include <Weave/Profiles/security/WeaveSecurity.h>
 #include "nlweaveswuclient.h"
+#include "nlweaveswudownloader.h"
 #include "MockIAServer.h"
 
 using nl::StatusReportStr;
@@ -46,6 +47,8 @@ static void HandleConnectionReceived(WeaveMessageLayer *msgLayer, WeaveConnectio
 static void StartClientConnection();
 static void HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr);
 static void HandleConnectionClosed(WeaveConnection *con, WEAVE_ERROR conErr);
+static void HandleImageQueryResponse(SoftwareUpdateClient *client, ImageQueryResponse &response);
+static void HandleDownloadComplete(SoftwareUpdateImageDownloader *downloader, WEAVE_ERROR err);
 
 bool Listening = false;
 bool UseTCP = true;
@@ -53,7 +56,9 @@ bool Debug = false;
 const char *DestIPAddrStr = NULL;
 uint16_t DestPort; // only used for UDP
 SoftwareUpdateClient SWUClient;
+SoftwareUpdateImageDownloader SWUDownloader;
 MockImageAnnounceServer MIAServer;
+const char *ImageFileName = NULL;
 
 //Globals used by SWU-client
 bool WaitingForSWUResp = false;
@@ -68,6 +73,9 @@ static OptionDef gToolOptionDefs[] =
     { "debug",      kArgumentRequired, 'd' },
     { "tcp",        kNoArgument,       't' },
     { "udp",        kNoArgument,       'u' },
+    { "image-file", kArgumentRequired, 'f' },
+    { "max-ranges", kArgumentRequired, 'p' },
+    { "range-size", kArgumentRequired, 'r' },
     { NULL }
 };
 
@@ -92,6 +100,18 @@ static const char *gToolOptionHelp =
     "\n"
     "  -d, --debug\n"
     "       Enable debug messages.\n"
+    "\n"
+    "  -f, --image-file <path>\n"
+    "       Download the image offered in the ImageQuery response to <path> and\n"
+    "       verify it against the response's integrity spec.\n"
+    "\n"
+    "  -p, --max-ranges <num>\n"
+    "       Maximum number of byte ranges of the image downloaded in parallel.\n"
+    "       The number in use is adapted to the observed throughput. Defaults to 4;\n"
+    "       1 downloads the image as a single sequential stream.\n"
+    "\n"
+    "  -r, --range-size <bytes>\n"
+    "       Size of each byte range of the image. Defaults to 65536.\n"
     "\n";
 
 static OptionSet gToolOptions =
@@ -199,6 +219,18 @@ int main(int argc, char *argv[])
         exit(-1);
     }
 
+    if (ImageFileName != NULL)
+    {
+        err = SWUDownloader.Init(&ExchangeMgr);
+        if (err != WEAVE_NO_ERROR)
+        {
+            printf("SoftwareUpdateImageDownloader::Init failed: %s\n", ErrorStr(err));
+            exit(-1);
+        }
+        SWUDownloader.OnDownloadComplete = HandleDownloadComplete;
+        SWUClient.OnImageQueryResponse = HandleImageQueryResponse;
+    }
+
     err = MIAServer.Init(&ExchangeMgr);
     if (err != WEAVE_NO_ERROR)
     {
@@ -246,6 +278,7 @@ int main(int argc, char *argv[])
     }
 
     MIAServer.Shutdown();
+    SWUDownloader.Shutdown();
     SWUClient.Shutdown();
     printf("Completed the SWU interactive protocol test!\n");
     ShutdownWeaveStack();
@@ -317,6 +350,24 @@ bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *n
     case 'D':
         DestIPAddrStr = arg;
         break;
+    case 'f':
+        ImageFileName = arg;
+        break;
+    case 'p':
+        if (!ParseInt(arg, SWUDownloader.MaxParallelRanges) || SWUDownloader.MaxParallelRanges < 1 ||
+            SWUDownloader.MaxParallelRanges > SoftwareUpdateImageDownloader::kMaxRanges)
+        {
+            PrintArgError("%s: Invalid value specified for max ranges: %s\n", progName, arg);
+            return false;
+        }
+        break;
+    case 'r':
+        if (!ParseInt(arg, SWUDownloader.RangeSize) || SWUDownloader.RangeSize == 0)
+        {
+            PrintArgError("%s: Invalid value specified for range size: %s\n", progName, arg);
+            return false;
+        }
+        break;
     default:
         PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
         return false;
@@ -445,3 +496,39 @@ void HandleConnectionClosed(WeaveConnection *con, WEAVE_ERROR conErr)
         Con = NULL;
     }
 }
+
+void HandleImageQueryResponse(SoftwareUpdateClient *client, ImageQueryResponse &response)
+{
+    WEAVE_ERROR err;
+
+    printf("Downloading image to %s with up to %u parallel ranges\n", ImageFileName, SWUDownloader.MaxParallelRanges);
+
+    if (Con != NULL)
+        err = SWUDownloader.StartDownload(Con, response, ImageFileName);
+    else
+        err = SWUDownloader.StartDownload(DestNodeId, DestIPAddr, response, ImageFileName);
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        printf("SoftwareUpdateImageDownloader::StartDownload failed: %s\n", ErrorStr(err));
+        Done = true;
+    }
+}
+
+void HandleDownloadComplete(SoftwareUpdateImageDownloader *downloader, WEAVE_ERROR err)
+{
+    uint64_t elapsed = downloader->GetElapsedTime();
+
+    if (err == WEAVE_NO_ERROR)
+    {
+        printf("Image verified: %" PRIu64 " bytes in %" PRIu64 " ms (%" PRIu64 " bytes/s), peak of %u parallel ranges\n",
+               downloader->GetImageSize(), elapsed, (elapsed > 0) ? downloader->GetImageSize() * 1000 / elapsed : 0,
+               downloader->GetPeakParallelRanges());
+    }
+    else
+    {
+        printf("Image download failed: %s\n", ErrorStr(err));
+    }
+
+    Done = true;
+}
@@ -26,6 +26,8 @@
 #define __STDC_FORMAT_MACROS
 #define __STDC_LIMIT_MACROS
 
+#define WEAVE_CONFIG_BDX_NAMESPACE kWeaveManagedNamespace_Development
+
 #include <inttypes.h>
 #include <stdlib.h>
 
@@ -33,9 +35,11 @@
 #include <Weave/Core/WeaveSecurityMgr.h>
 #include <Weave/Profiles/security/WeaveSecurity.h>
 #include "MockSWUServer.h"
+#include "weave-bdx-common-development.h"
 
 using namespace nl::Weave;
 using namespace nl::Inet;
+using namespace nl::Weave::Profiles::BulkDataTransfer;
 
 #define TOOL_NAME "weave-swu-server"
 
@@ -48,8 +52,12 @@ static void HandleConnectionClosed(WeaveConnection *con, WEAVE_ERROR conErr);
 static void GenerateReferenceImageQuery(ImageQuery *aImageQuery);
 static void HandleConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr);
 static void StartServerConnection();
+#if WEAVE_CONFIG_BDX_SERVER_SUPPORT
+static uint16_t HandleImageReceiveInit(BDXTransfer *aXfer, ReceiveInit *aReceiveInit);
+#endif
 
 MockSoftwareUpdateServer MockSWUServer;
+BdxServer BDXServer;
 
 uint16_t ProductId              = 1;
 uint16_t ProductRev             = 1;
@@ -267,6 +275,62 @@ void GenerateReferenceImageQuery(ImageQuery *aImageQuery)
                     NULL /*package*/, NULL /*locale*/, 0 /*target node id*/, NULL /*metadata*/);
 }
 
+#if WEAVE_CONFIG_BDX_SERVER_SUPPORT
+/** Accept a request for all or part of the image offered in ImageQuery responses.
+ * Clients may download several ranges of the image at once; those transfers all
+ * read from the same mapping of the file.
+ */
+uint16_t HandleImageReceiveInit(BDXTransfer *aXfer, ReceiveInit *aReceiveInit)
+{
+    uint16_t status = kStatus_NoError;
+    BdxAppState *appState;
+    BdxFileSource *source = NULL;
+    size_t len = aReceiveInit->mFileDesignator.theLength;
+    BDXHandlers handlers =
+    {
+        NULL, NULL, NULL, BdxGetBlockHandler,
+        NULL, BdxXferErrorHandler, BdxXferDoneHandler, BdxErrorHandler
+    };
+
+    // Nothing but the offered image is served
+    VerifyOrExit(len == strlen(gFileDesignator) && memcmp(aReceiveInit->mFileDesignator.theString, gFileDesignator, len) == 0,
+                 status = kStatus_UnknownFile);
+
+    appState = NewAppState();
+    VerifyOrExit(appState != NULL, status = kStatus_ServerBadState);
+
+    source = AcquireFileSource(gFileDesignator);
+    VerifyOrExit(source != NULL, status = kStatus_UnknownFile);
+    VerifyOrExit(aReceiveInit->mStartOffset <= source->mSize, status = kStatus_StartOffsetNotSupported);
+
+    // Cut the range at the end of the image; the client learns the image size from this
+    aXfer->mLength = source->mSize - aReceiveInit->mStartOffset;
+    if (aReceiveInit->mLength != 0 && aReceiveInit->mLength < aXfer->mLength)
+    {
+        aXfer->mLength = aReceiveInit->mLength;
+    }
+
+    appState->mSource = source;
+    appState->mOffset = aReceiveInit->mStartOffset;
+    appState->mEndOffset = aReceiveInit->mStartOffset + aXfer->mLength;
+    appState->mReadAheadOffset = appState->mOffset;
+    source = NULL;
+
+    aXfer->mAppState = appState;
+    aXfer->mIsAccepted = true;
+    aXfer->mTransferMode = aReceiveInit->mReceiverDriveSupported ? kMode_ReceiverDrive : kMode_SenderDrive;
+    aXfer->SetHandlers(handlers);
+
+exit:
+    if (source != NULL)
+    {
+        ReleaseFileSource(source);
+    }
+
+    return status;
+}
+#endif // WEAVE_CONFIG_BDX_SERVER_SUPPORT
+
 void StartServerConnection()
 {
     printf("0 StartClientConnection entering (Con: %p)\n", Con);
@@ -385,6 +449,18 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    // Serve the image over BDX so clients can download it from this node
+    ResetAppStates();
+    err = BDXServer.Init(&ExchangeMgr);
+    if (err != WEAVE_NO_ERROR)
+    {
+        printf("BdxServer::Init failed: %s\n", ErrorStr(err));
+        exit(EXIT_FAILURE);
+    }
+#if WEAVE_CONFIG_BDX_SERVER_SUPPORT
+    BDXServer.AwaitBdxReceiveInit(HandleImageReceiveInit);
+#endif
+
     if (gListening)
     {
         printf("Listening for Software Update requests...\n");
@@ -416,6 +492,7 @@ int main(int argc, char *argv[])
         ServiceNetwork(sleepTime);
     }
 
+    BDXServer.Shutdown();
     MockSWUServer.Shutdown();
     ShutdownWeaveStack();
     ShutdownNetwork();